@@ -86,6 +86,12 @@
 #ifndef NDEF_FEATURE_T5T
 #define NDEF_FEATURE_T5T           RFAL_FEATURE_NFCV      /*!< T5T Support control */
 #endif
+#ifndef NDEF_FEATURE_T3T_CE
+#define NDEF_FEATURE_T3T_CE        false                  /*!< T3T Card Emulation Support control */
+#endif
+#ifndef NDEF_FEATURE_T4T_CE
+#define NDEF_FEATURE_T4T_CE        false                  /*!< T4T Card Emulation Support control */
+#endif
 
 
 #ifndef NDEF_FEATURE_FULL_API
@@ -140,6 +146,8 @@
 #define NDEF_FEATURE_T3T          RFAL_FEATURE_NFCF       /*!< T3T Support control */
 #define NDEF_FEATURE_T4T          RFAL_FEATURE_T4T        /*!< T4T Support control */
 #define NDEF_FEATURE_T5T          RFAL_FEATURE_NFCV       /*!< T5T Support control */
+#define NDEF_FEATURE_T3T_CE       RFAL_FEATURE_NFCF       /*!< T3T Card Emulation Support control */
+#define NDEF_FEATURE_T4T_CE       RFAL_FEATURE_T4T        /*!< T4T Card Emulation Support control */
 
 
 #define NDEF_FEATURE_FULL_API                  true       /*!< Support Write, Format, Check Presence, set Read-only in addition to the Read feature */
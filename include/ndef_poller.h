@@ -100,6 +100,9 @@
 #define NDEF_T5T_TxRx_BUFF_SIZE               \
           (32U +  NDEF_T5T_TxRx_BUFF_HEADER_SIZE + NDEF_T5T_TxRx_BUFF_FOOTER_SIZE)     /*!< T5T working buffer size                                      */
 
+#define NDEF_PROVISION_HEADER_LEN    4U                                                /*!< Provisioning image room for the longest length field         */
+#define NDEF_PROVISION_OVERHEAD     (NDEF_PROVISION_HEADER_LEN + NDEF_TERMINATOR_TLV_LEN) /*!< Provisioning image buffer length beyond the message        */
+
 /*
  ******************************************************************************
  * GLOBAL MACROS
@@ -313,10 +316,53 @@ typedef struct {
     uint8_t                      cacheBuf[NDEF_T5T_TxRx_BUFF_SIZE];/*!< Cache buffer                                   */
     uint32_t                     cacheBlock;                   /*!< Block number of cached buffer                      */
     bool                         useMultipleBlockRead;         /*!< Access multiple block read                         */
+    uint8_t                      writeMultipleMax;             /*!< Blocks per Write Multiple, 0: Write Single Block    */
     bool                         stDevice;                     /*!< ST device                                          */
 } ndefT5TContext;
 #endif
 
+/*! NDEF poller retry error classes */
+typedef enum {
+    NDEF_RETRY_CLASS_TRANSMISSION = 0x00U,                     /*!< CRC, parity or framing error: response corrupted   */
+    NDEF_RETRY_CLASS_TIMEOUT      = 0x01U,                     /*!< No response                                        */
+    NDEF_RETRY_CLASS_COLLISION    = 0x02U,                     /*!< Collision: more than one response                  */
+    NDEF_RETRY_CLASS_NUM          = 0x03U,                     /*!< Number of error classes                            */
+} ndefRetryClass;
+
+/*! NDEF poller retry remedial actions */
+typedef enum {
+    NDEF_RETRY_ACTION_NONE        = 0x00U,                     /*!< Retry the command as is                            */
+    NDEF_RETRY_ACTION_RESELECT    = 0x01U,                     /*!< Wake up and select the tag again before the retry  */
+} ndefRetryAction;
+
+/*! NDEF poller retry policy of one error class */
+typedef struct {
+    uint8_t                      budget;                       /*!< Retries of a command                               */
+    uint8_t                      sessionBudget;                /*!< Retries over the session, then no more retries     */
+    uint8_t                      backoff;                      /*!< Wait before the 1st retry [ms], doubled on each retry, 0: none */
+    uint8_t                      backoffMax;                   /*!< Longest wait before a retry [ms]                   */
+    ndefRetryAction              action;                       /*!< Remedial action taken before a retry               */
+    uint8_t                      actionFrom;                   /*!< Retry (1..budget) from which the action is taken   */
+} ndefRetryPolicy;
+
+/*! NDEF poller retry statistics of a session */
+typedef struct {
+    uint16_t                     errCnt[NDEF_RETRY_CLASS_NUM]; /*!< Errors per class                                   */
+    uint16_t                     retryCnt[NDEF_RETRY_CLASS_NUM]; /*!< Retries per class                                */
+    uint16_t                     recoveredCnt;                 /*!< Commands succeeding on a retry                     */
+    uint16_t                     failedCnt;                    /*!< Commands failing with a retryable error            */
+    uint16_t                     actionCnt;                    /*!< Remedial actions taken                             */
+    uint32_t                     backoffTime;                  /*!< Time waited before retries [ms]                    */
+} ndefRetryStats;
+
+/*! NDEF poller retry context */
+typedef struct {
+    const ndefRetryPolicy*       policy;                       /*!< Policy per error class (NDEF_RETRY_CLASS_NUM), NULL: no retry */
+    uint8_t                      sessionLeft[NDEF_RETRY_CLASS_NUM]; /*!< Retries left over the session                 */
+    uint8_t                      cmdRetry[NDEF_RETRY_CLASS_NUM]; /*!< Retries done on the ongoing command              */
+    ndefRetryStats               stats;                        /*!< Session statistics                                 */
+} ndefRetryContext;
+
 /*! NDEF context structure */
 typedef struct {
     ndefDeviceType               type;                         /*!< NDEF Device type                                   */
@@ -329,6 +375,7 @@ typedef struct {
     uint8_t                      ccBuf[NDEF_CC_BUF_LEN];       /*!< buffer for CC                                      */
     const struct ndefPollerWrapperStruct*
                                  ndefPollWrapper;              /*!< pointer to array of function for wrapper           */
+    ndefRetryContext             retry;                        /*!< Retry policy and statistics                        */
     union {
 #if NDEF_FEATURE_T1T
         ndefT1TContext t1t;                                    /*!< T1T context                                        */
@@ -368,6 +415,20 @@ typedef struct ndefPollerWrapperStruct
 #endif /* NDEF_FEATURE_FULL_API */
 } ndefPollerWrapper;
 
+/*! NDEF provisioning image: message encoded once, written to every tag of a batch */
+typedef struct {
+    uint8_t*                     buffer;                       /*!< Length field room, message, Terminator TLV room    */
+    uint32_t                     bufferLen;                    /*!< Buffer length                                      */
+    uint32_t                     messageLen;                   /*!< Encoded message length                             */
+} ndefProvisionImage;
+
+/*! NDEF differential write statistics */
+typedef struct {
+    uint32_t                     blocks;                       /*!< Blocks holding the new message and its L-field     */
+    uint32_t                     written;                      /*!< Blocks written, L-field updates included           */
+    bool                         full;                         /*!< Written as ndefPollerWriteRawMessage() does        */
+} ndefDiffStats;
+
 
 /*
  ******************************************************************************
@@ -663,6 +724,200 @@ ndefStatus ndefPollerEndWriteMessage(ndefContext *ctx, uint32_t messageLen);
 ndefStatus ndefPollerSetReadOnly(ndefContext *ctx);
 
 
+/*!
+ *****************************************************************************
+ * \brief Set Retry Policy
+ *
+ * Overrides the default retry policy of the tag type (T2T and T5T) for the
+ * rest of the session. The session budgets are reloaded.
+ * To be called after ndefPollerContextInitialization(), which restores the
+ * default policy.
+ *
+ * \param[in]   ctx       : ndef Context
+ * \param[in]   policy    : policy per error class, NDEF_RETRY_CLASS_NUM entries
+ *                          indexed by ndefRetryClass, NULL: no retry
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerSetRetryPolicy(ndefContext *ctx, const ndefRetryPolicy *policy);
+
+
+/*!
+ *****************************************************************************
+ * \brief Get Retry Statistics
+ *
+ * Returns the retry statistics since ndefPollerContextInitialization()
+ *
+ * \param[in]   ctx       : ndef Context
+ * \param[out]  stats     : retry statistics
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerGetRetryStats(const ndefContext *ctx, ndefRetryStats *stats);
+
+
+/*!
+ *****************************************************************************
+ * \brief Retry Initialization
+ *
+ * Installs the default retry policy of the tag type and clears the session
+ * budgets and statistics. Used by the tag type context initializations
+ *
+ * \param[in]   ctx       : ndef Context
+ * \param[in]   policy    : policy per error class, NULL: no retry
+ *****************************************************************************
+ */
+void ndefPollerRetryInit(ndefContext *ctx, const ndefRetryPolicy *policy);
+
+
+/*!
+ *****************************************************************************
+ * \brief Retry Start
+ *
+ * Starts the retry accounting of a new command. Used by the tag type pollers
+ *
+ * \param[in]   ctx       : ndef Context
+ *****************************************************************************
+ */
+void ndefPollerRetryStart(ndefContext *ctx);
+
+
+/*!
+ *****************************************************************************
+ * \brief Retry Check
+ *
+ * Classifies the outcome of a command attempt and tells whether the command
+ * is to be retried: the error class must have a command and a session retry
+ * left. Waits the backoff of the class before returning. Used by the tag type
+ * pollers after each attempt
+ *
+ * \param[in]   ctx       : ndef Context
+ * \param[in]   err       : outcome of the attempt
+ * \param[out]  action    : remedial action to take before the retry
+ *
+ * \return true  : retry the command
+ * \return false : done, err is the outcome of the command
+ *****************************************************************************
+ */
+bool ndefPollerRetryCheck(ndefContext *ctx, ReturnCode err, ndefRetryAction *action);
+
+
+/*!
+ *****************************************************************************
+ * \brief Provisioning Image Initialization
+ *
+ * Encodes the message once into buf, to be written to a batch of tags with
+ * ndefPollerProvisionWrite(). buf must hold the message and
+ * NDEF_PROVISION_OVERHEAD bytes for the length field and the Terminator TLV
+ *
+ * \param[out]  image     : provisioning image
+ * \param[in]   buf       : image buffer, kept by the image
+ * \param[in]   bufLen    : image buffer length
+ * \param[in]   message   : message to encode
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NOMEM        : buf too short for the message
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerProvisionInit(ndefProvisionImage *image, uint8_t *buf, uint32_t bufLen, const ndefMessage *message);
+
+
+/*!
+ *****************************************************************************
+ * \brief Provisioning Image Find
+ *
+ * Finds the offset in the encoded message of a placeholder of a templated
+ * field (e.g. serial number, UID in an URI), to be patched per tag
+ *
+ * \param[in]   image     : provisioning image
+ * \param[in]   pattern   : placeholder
+ * \param[in]   len       : placeholder length
+ * \param[out]  offset    : offset of the first match in the message
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NOTFOUND     : placeholder not found
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerProvisionFind(const ndefProvisionImage *image, const uint8_t *pattern, uint32_t len, uint32_t *offset);
+
+
+/*!
+ *****************************************************************************
+ * \brief Provisioning Image Patch
+ *
+ * Overwrites len bytes of the encoded message at offset, e.g. the per tag
+ * value of a templated field. The message length is unchanged
+ *
+ * \param[in]   image     : provisioning image
+ * \param[in]   offset    : offset in the message
+ * \param[in]   data      : field value
+ * \param[in]   len       : field length
+ *
+ * \return ERR_PARAM        : Invalid parameter or beyond the message
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerProvisionPatch(ndefProvisionImage *image, uint32_t offset, const uint8_t *data, uint32_t len);
+
+
+/*!
+ *****************************************************************************
+ * \brief Provisioning Write
+ *
+ * Writes the image to the tag after the NDEF Detect procedure. T2T, T4T and
+ * T5T: the length field is built in front of the message and the image is
+ * written in full write commands, L-field reset first and set last.
+ * T3T, T2T with reserved areas in the way and empty messages: written as
+ * ndefPollerWriteRawMessage() does
+ *
+ * \param[in]   ctx       : ndef Context
+ * \param[in]   image     : provisioning image
+ *
+ * \return ERR_WRONG_STATE  : Library not initialized or mode not set
+ * \return ERR_PARAM        : Invalid parameter or not enough space
+ * \return ERR_NOTSUPP      : Not supported by the tag type
+ * \return ERR_PROTO        : Protocol error
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerProvisionWrite(ndefContext *ctx, ndefProvisionImage *image);
+
+
+/*!
+ *****************************************************************************
+ * \brief Differential Raw Message Write
+ *
+ * Writes a raw NDEF message over the message found by the NDEF Detect
+ * procedure, writing only the blocks (T4T: 16-byte units) that differ.
+ * The current message is taken from cur when curLen matches the detected
+ * length, read from the tag otherwise. Before the first block written the
+ * L-field is reset, and it is set after the last one.
+ * Written as ndefPollerWriteRawMessage() does when there is no message to
+ * compare with, the L-field changes size, or a T2T reserved area is in the way
+ *
+ * \param[in]   ctx       : ndef Context
+ * \param[in]   buf       : new raw message
+ * \param[in]   bufLen    : new raw message length
+ * \param[in]   cur       : current raw message, or NULL
+ * \param[in]   curLen    : current raw message length
+ * \param[out]  stats     : blocks of the message and blocks written, or NULL
+ *
+ * \return ERR_WRONG_STATE  : Library not initialized or mode not set
+ * \return ERR_PARAM        : Invalid parameter or not enough space
+ * \return ERR_NOTSUPP      : Not supported by the tag type
+ * \return ERR_PROTO        : Protocol error
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefPollerWriteRawMessageDiff(ndefContext *ctx, const uint8_t *buf, uint32_t bufLen, const uint8_t *cur, uint32_t curLen, ndefDiffStats *stats);
+
+
 #endif /* NDEF_POLLER_H */
 
 /**
@@ -0,0 +1,171 @@
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Provides a NFC Forum T3T Card Emulation NDEF server
+ *
+ *  The T3T Card Emulation answers the CHECK and UPDATE commands of a
+ *  Reader/Writer from a block-indexed image: block 0 holds the Attribute
+ *  Information Block (AIB), blocks 1..NmaxB the NDEF message.
+ *
+ *  The response headers (code, NFCID2, status flags) are precomputed on
+ *  ndefT3TCeInit(). A CHECK is answered by copying, for each element of
+ *  the Block List, the 16 bytes at blockNum * 16 of the image after the
+ *  precomputed header: no state is kept between requests and nothing is
+ *  decoded from the image, so the response is ready within the MRT of a
+ *  424 kbps Reader/Writer.
+ *
+ *  The module is transport agnostic: it processes one request frame into
+ *  one response frame, so it can equally be driven by the Listen mode data
+ *  exchange or locally by the frames of the T3T Poller.
+ *
+ *  The most common interfaces are
+ *    <br>&nbsp; ndefT3TCeInit()
+ *    <br>&nbsp; ndefT3TCeSetMessage()
+ *    <br>&nbsp; ndefT3TCeProcess()
+ *
+ *  This implementation was based on the following specs:
+ *    - NFC Forum Type 3 Tag Technical Specification 1.0
+ *
+ * \addtogroup NDEF
+ * @{
+ *
+ */
+
+
+#ifndef NDEF_T3T_CE_H
+#define NDEF_T3T_CE_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_config.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_T3T_CE_BLOCK_LEN             16U     /*!< T3T block length                                     */
+#define NDEF_T3T_CE_NFCID2_LEN             8U     /*!< NFCID2 length                                        */
+#define NDEF_T3T_CE_NBR                   15U     /*!< Nbr announced: max blocks per CHECK                  */
+#define NDEF_T3T_CE_NBW                   13U     /*!< Nbw announced: max blocks per UPDATE                 */
+#define NDEF_T3T_CE_HDR_LEN               11U     /*!< Response code | NFCID2 | Status Flag 1 | 2           */
+#define NDEF_T3T_CE_RSP_MAX_LEN  (NDEF_T3T_CE_HDR_LEN + 1U + (NDEF_T3T_CE_NBR * NDEF_T3T_CE_BLOCK_LEN)) /*!< Longest response (CHECK of Nbr blocks), LEN byte excluded */
+#define NDEF_T3T_CE_MIN_BLOCKS             2U     /*!< AIB + one NDEF block                                 */
+#define NDEF_T3T_CE_MAX_BLOCKS        0xFFFFU     /*!< Block number range (AIB + NmaxB)                     */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! T3T Card Emulation statistics */
+typedef struct
+{
+    uint32_t          cmdCnt;                     /*!< Requests processed                                   */
+    uint32_t          checkCnt;                   /*!< CHECK commands answered                              */
+    uint32_t          checkBlocks;                /*!< Blocks answered on CHECK                             */
+    uint32_t          updateCnt;                  /*!< UPDATE commands done                                 */
+    uint32_t          updateBlocks;               /*!< Blocks written by UPDATE                             */
+    uint32_t          errCnt;                     /*!< Requests answered with an error status               */
+    uint32_t          ignoredCnt;                 /*!< Requests not answered (other NFCID2, not T3T)        */
+} ndefT3tCeStats;
+
+
+/*! T3T Card Emulation context */
+typedef struct
+{
+    uint8_t          *image;                      /*!< Block-indexed image: AIB followed by the NDEF blocks */
+    uint16_t          nBlocks;                    /*!< Blocks on the image (AIB included)                   */
+    bool              readOnly;                   /*!< UPDATE refused (image may be in Flash)               */
+    uint8_t           checkHdr[NDEF_T3T_CE_HDR_LEN];  /*!< Precomputed CHECK response header, status success  */
+    uint8_t           updateRsp[NDEF_T3T_CE_HDR_LEN]; /*!< Precomputed UPDATE response, status success         */
+    ndefT3tCeStats    stats;                      /*!< Statistics                                           */
+} ndefT3tCeContext;
+
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief T3T Card Emulation Initialization
+ *
+ * Initializes the context over the given block-indexed image and precomputes
+ * the response headers for the given NFCID2 (the one on the SENSF_RES)
+ *
+ * \param[out]  ctx      : T3T Card Emulation context
+ * \param[in]   image    : image, nBlocks * NDEF_T3T_CE_BLOCK_LEN bytes
+ * \param[in]   nBlocks  : blocks on the image, AIB included
+ * \param[in]   nfcid2   : NFCID2 of the emulated tag
+ * \param[in]   readOnly : true to refuse UPDATE (image not writable)
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefT3TCeInit(ndefT3tCeContext *ctx, uint8_t *image, uint16_t nBlocks, const uint8_t *nfcid2, bool readOnly);
+
+
+/*!
+ *****************************************************************************
+ * \brief T3T Card Emulation Set NDEF message
+ *
+ * Places the NDEF message on a RAM image and writes the AIB announcing it
+ *
+ * \param[in]   ctx     : T3T Card Emulation context
+ * \param[in]   msg     : raw NDEF message
+ * \param[in]   msgLen  : raw NDEF message length
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NOMEM        : Message does not fit the image
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefT3TCeSetMessage(ndefT3tCeContext *ctx, const uint8_t *msg, uint32_t msgLen);
+
+
+/*!
+ *****************************************************************************
+ * \brief T3T Card Emulation Process request
+ *
+ * Answers one request received from the Reader/Writer. Requests to another
+ * NFCID2 and non T3T commands are not answered (rspLen 0), wrong CHECK or
+ * UPDATE parameters are answered with an error status.
+ *
+ * \param[in]   ctx       : T3T Card Emulation context
+ * \param[in]   req       : request as received, starting with the LEN byte
+ * \param[in]   reqLen    : request length
+ * \param[out]  rsp       : buffer to compose the response, LEN byte excluded
+ * \param[in]   rspBufLen : response buffer length, NDEF_T3T_CE_RSP_MAX_LEN
+ *                          fits any response
+ * \param[out]  rspLen    : response length, 0 if not to be answered
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NONE         : Request processed
+ *****************************************************************************
+ */
+ndefStatus ndefT3TCeProcess(ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint8_t *rsp, uint16_t rspBufLen, uint16_t *rspLen);
+
+
+#endif /* NDEF_T3T_CE_H */
+
+/**
+  * @}
+  *
+  */
@@ -0,0 +1,189 @@
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Provides a NFC Forum T4T Card Emulation NDEF server
+ *
+ *  The T4T Card Emulation answers the T4T NDEF commands of a Reader/Writer
+ *  (SELECT, ReadBinary, UpdateBinary) from an NDEF file image held in RAM
+ *  or memory-mapped (read-only) Flash.
+ *
+ *  The CC file and the status words are precomputed on ndefT4TCeInit(),
+ *  each C-APDU is answered with a constant time lookup and the ReadBinary
+ *  body is copied once, from the image straight into the R-APDU buffer.
+ *  Passing the buffer provided by rfalNfcDataExchangeGetTxBuf() as R-APDU
+ *  buffer, the response is composed where the ISO-DEP layer sends it from.
+ *
+ *  The module is transport agnostic: it processes one C-APDU into one
+ *  R-APDU, so it can equally be driven by the Listen mode data exchange
+ *  or locally by the T4T Poller APDU composers.
+ *
+ *  The most common interfaces are
+ *    <br>&nbsp; ndefT4TCeInit()
+ *    <br>&nbsp; ndefT4TCeSetMessage()
+ *    <br>&nbsp; ndefT4TCeReset()
+ *    <br>&nbsp; ndefT4TCeProcess()
+ *
+ *  This implementation was based on the following specs:
+ *    - NFC Forum Type 4 Tag Technical Specification 1.0  (mapping version 2.0)
+ *
+ * \addtogroup NDEF
+ * @{
+ *
+ */
+
+
+#ifndef NDEF_T4T_CE_H
+#define NDEF_T4T_CE_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_config.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_T4T_CE_CCFILE_LEN            15U     /*!< CC file length, mapping version 2.0                  */
+#define NDEF_T4T_CE_NLEN_LEN               2U     /*!< NLEN length                                          */
+#define NDEF_T4T_CE_SW_LEN                 2U     /*!< SW1 SW2 length                                       */
+#define NDEF_T4T_CE_NDEF_FID          0xE104U     /*!< NDEF file identifier announced on the CC file        */
+#define NDEF_T4T_CE_MLE                 255U      /*!< Max ReadBinary data (MLe) announced, short field coding */
+#define NDEF_T4T_CE_MLC                 255U      /*!< Max UpdateBinary data (MLc) announced                */
+#define NDEF_T4T_CE_NDEF_FILE_MAX    0x7FFFU      /*!< Max NDEF file size, ReadBinary offset range          */
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! T4T Card Emulation file selected */
+typedef enum
+{
+    NDEF_T4T_CE_SEL_NONE,                         /*!< Nothing selected                                     */
+    NDEF_T4T_CE_SEL_APP,                          /*!< NDEF Tag Application selected                        */
+    NDEF_T4T_CE_SEL_CC,                           /*!< CC file selected                                     */
+    NDEF_T4T_CE_SEL_NDEF                          /*!< NDEF file selected                                   */
+} ndefT4tCeSelect;
+
+
+/*! T4T Card Emulation statistics */
+typedef struct
+{
+    uint32_t          cmdCnt;                     /*!< C-APDUs processed                                    */
+    uint32_t          readCnt;                    /*!< ReadBinary commands answered                         */
+    uint32_t          readBytes;                  /*!< Bytes answered on ReadBinary                         */
+    uint32_t          updateCnt;                  /*!< UpdateBinary commands done                           */
+    uint32_t          updateBytes;                /*!< Bytes written by UpdateBinary                        */
+    uint32_t          errCnt;                     /*!< C-APDUs answered with an error status word           */
+} ndefT4tCeStats;
+
+
+/*! T4T Card Emulation context */
+typedef struct
+{
+    uint8_t          *ndefFile;                   /*!< NDEF file image: NLEN + NDEF message                 */
+    uint16_t          ndefFileLen;                /*!< NDEF file size                                       */
+    bool              readOnly;                   /*!< UpdateBinary refused (image may be in Flash)         */
+    ndefT4tCeSelect   selected;                   /*!< Current selection                                    */
+    uint8_t           ccRsp[NDEF_T4T_CE_CCFILE_LEN + NDEF_T4T_CE_SW_LEN]; /*!< Precomputed CC file, followed by SW 9000 */
+    ndefT4tCeStats    stats;                      /*!< Statistics                                           */
+} ndefT4tCeContext;
+
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief T4T Card Emulation Initialization
+ *
+ * Initializes the context over the given NDEF file image and precomputes
+ * the CC file announcing its size and access conditions
+ *
+ * \param[out]  ctx         : T4T Card Emulation context
+ * \param[in]   ndefFile    : NDEF file image (NLEN followed by the NDEF message)
+ * \param[in]   ndefFileLen : NDEF file size, at least NLEN + 3 bytes
+ * \param[in]   readOnly    : true to refuse UpdateBinary (image not writable)
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefT4TCeInit(ndefT4tCeContext *ctx, uint8_t *ndefFile, uint16_t ndefFileLen, bool readOnly);
+
+
+/*!
+ *****************************************************************************
+ * \brief T4T Card Emulation Set NDEF message
+ *
+ * Places the NDEF message on a RAM NDEF file image and updates its NLEN
+ *
+ * \param[in]   ctx     : T4T Card Emulation context
+ * \param[in]   msg     : raw NDEF message
+ * \param[in]   msgLen  : raw NDEF message length
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NOMEM        : Message does not fit the NDEF file
+ * \return ERR_NONE         : No error
+ *****************************************************************************
+ */
+ndefStatus ndefT4TCeSetMessage(ndefT4tCeContext *ctx, const uint8_t *msg, uint16_t msgLen);
+
+
+/*!
+ *****************************************************************************
+ * \brief T4T Card Emulation Reset
+ *
+ * Clears the selection, to be called on every activation by a Reader/Writer
+ *
+ * \param[in]   ctx     : T4T Card Emulation context
+ *****************************************************************************
+ */
+void ndefT4TCeReset(ndefT4tCeContext *ctx);
+
+
+/*!
+ *****************************************************************************
+ * \brief T4T Card Emulation Process C-APDU
+ *
+ * Answers one C-APDU received from the Reader/Writer. Unsupported commands
+ * and wrong parameters are answered with the ISO 7816-4 status word.
+ * The R-APDU buffer must not overlap the C-APDU
+ *
+ * \param[in]   ctx       : T4T Card Emulation context
+ * \param[in]   cApdu     : C-APDU received
+ * \param[in]   cApduLen  : C-APDU length
+ * \param[out]  rApdu     : buffer to compose the R-APDU
+ * \param[in]   rApduBufLen : R-APDU buffer length, at least NDEF_T4T_CE_SW_LEN
+ * \param[out]  rApduLen  : R-APDU length
+ *
+ * \return ERR_PARAM        : Invalid parameter
+ * \return ERR_NONE         : R-APDU composed (may carry an error status word)
+ *****************************************************************************
+ */
+ndefStatus ndefT4TCeProcess(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen, uint8_t *rApdu, uint16_t rApduBufLen, uint16_t *rApduLen);
+
+
+#endif /* NDEF_T4T_CE_H */
+
+/**
+  * @}
+  *
+  */
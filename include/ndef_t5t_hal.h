@@ -114,6 +114,16 @@ bool ndefT5TisSTDevice(const ndefDevice *dev);
 bool ndefT5TisT5TDevice(const ndefDevice *dev);
 
 
+/*!
+ *****************************************************************************
+ * \brief Return the T5T default retry policy
+ *
+ * \return the policy per error class, indexed by ndefRetryClass
+ *****************************************************************************
+ */
+const ndefRetryPolicy* ndefT5TGetRetryPolicy(void);
+
+
 /*!
  *****************************************************************************
  * \brief Set T5T device access mode
@@ -132,6 +132,13 @@
 #endif /* RFAL_FEATURE_NFCV */
 
 
+#ifndef RFAL_FEATURE_NFCA_UID_CACHE_LEN
+    #if RFAL_FEATURE_NFCA
+        #define RFAL_FEATURE_NFCA_UID_CACHE_LEN     8U         /*!< NFC-A anticollision UID prefix cache entries. 0 disables seeding          */
+    #endif /* RFAL_FEATURE_NFCA */
+#endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
+
+
 #ifndef RFAL_FEATURE_ISO_DEP
     #if RFAL_SUPPORT_MODE_POLL_NFCA || RFAL_SUPPORT_MODE_POLL_NFCB || RFAL_SUPPORT_CE
         #define RFAL_FEATURE_ISO_DEP                true       /*!< Enable RFAL support for ISO-DEP (ISO14443-4)                      */
@@ -167,6 +174,55 @@
 #endif /* RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN */
 
 
+#ifndef RFAL_FEATURE_ISO_DEP_RATE_WINDOW
+    #if RFAL_FEATURE_ISO_DEP_POLL
+        #define RFAL_FEATURE_ISO_DEP_RATE_WINDOW    16U        /*!< ISO-DEP adaptive bit rate: I-Block exchanges per error rate window        */
+    #endif /* RFAL_FEATURE_ISO_DEP_POLL */
+#endif /* RFAL_FEATURE_ISO_DEP_RATE_WINDOW */
+
+
+#ifndef RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS
+    #if RFAL_FEATURE_ISO_DEP_POLL
+        #define RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS 3U         /*!< ISO-DEP adaptive bit rate: CRC/timeout errors in a window to step down    */
+    #endif /* RFAL_FEATURE_ISO_DEP_POLL */
+#endif /* RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS */
+
+
+#ifndef RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS
+    #if RFAL_FEATURE_ISO_DEP_POLL
+        #define RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS 4U        /*!< ISO-DEP adaptive bit rate: error free windows to step back up             */
+    #endif /* RFAL_FEATURE_ISO_DEP_POLL */
+#endif /* RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS */
+
+
+#ifndef RFAL_FEATURE_DPO_WINDOW
+    #if RFAL_FEATURE_DPO
+        #define RFAL_FEATURE_DPO_WINDOW             16U        /*!< DPO closed loop: frames per error rate window                             */
+    #endif /* RFAL_FEATURE_DPO */
+#endif /* RFAL_FEATURE_DPO_WINDOW */
+
+
+#ifndef RFAL_FEATURE_DPO_UP_ERRS
+    #if RFAL_FEATURE_DPO
+        #define RFAL_FEATURE_DPO_UP_ERRS            2U         /*!< DPO closed loop: CRC/timeout errors in a window to raise the power        */
+    #endif /* RFAL_FEATURE_DPO */
+#endif /* RFAL_FEATURE_DPO_UP_ERRS */
+
+
+#ifndef RFAL_FEATURE_DPO_DOWN_WINDOWS
+    #if RFAL_FEATURE_DPO
+        #define RFAL_FEATURE_DPO_DOWN_WINDOWS       4U         /*!< DPO closed loop: error free windows to try a lower power                  */
+    #endif /* RFAL_FEATURE_DPO */
+#endif /* RFAL_FEATURE_DPO_DOWN_WINDOWS */
+
+
+#ifndef RFAL_FEATURE_DPO_LEARN_MIN
+    #if RFAL_FEATURE_DPO
+        #define RFAL_FEATURE_DPO_LEARN_MIN          8U         /*!< DPO closed loop: frames on a measurement bin before it is trusted         */
+    #endif /* RFAL_FEATURE_DPO */
+#endif /* RFAL_FEATURE_DPO_LEARN_MIN */
+
+
 #ifndef RFAL_FEATURE_NFC_DEP
     #if RFAL_SUPPORT_MODE_POLL_NFCA && RFAL_SUPPORT_MODE_POLL_NFCF
         #define RFAL_FEATURE_NFC_DEP                true       /*!< Enable RFAL support for NFC-DEP (NFCIP1/P2P)                              */
@@ -187,16 +243,59 @@
 #endif /* RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN */
 
 
+#ifndef RFAL_FEATURE_LLCP_MIU
+    #if RFAL_FEATURE_LLCP
+        #define RFAL_FEATURE_LLCP_MIU               (RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN - 3U) /*!< LLCP MIU announced (MIUX), largest I PDU the NFC-DEP PDU holds */
+    #endif /* RFAL_FEATURE_LLCP */
+#endif /* RFAL_FEATURE_LLCP_MIU */
+
+
+#ifndef RFAL_FEATURE_LLCP_RW
+    #if RFAL_FEATURE_LLCP
+        #define RFAL_FEATURE_LLCP_RW                4U         /*!< LLCP receive window announced on CONNECT/CC. Allowed values: 0..15        */
+    #endif /* RFAL_FEATURE_LLCP */
+#endif /* RFAL_FEATURE_LLCP_RW */
+
+
+#ifndef RFAL_FEATURE_LLCP_LTO
+    #if RFAL_FEATURE_LLCP
+        #define RFAL_FEATURE_LLCP_LTO               500U       /*!< LLCP link timeout announced [ms]. Multiple of 10, up to 2550              */
+    #endif /* RFAL_FEATURE_LLCP */
+#endif /* RFAL_FEATURE_LLCP_LTO */
+
+
+#ifndef RFAL_FEATURE_LLCP_LINKS
+    #if RFAL_FEATURE_LLCP
+        #define RFAL_FEATURE_LLCP_LINKS             2U         /*!< LLCP data links (connections) handled concurrently                        */
+    #endif /* RFAL_FEATURE_LLCP */
+#endif /* RFAL_FEATURE_LLCP_LINKS */
+
+
+#ifndef RFAL_FEATURE_LLCP_SERVICES
+    #if RFAL_FEATURE_LLCP
+        #define RFAL_FEATURE_LLCP_SERVICES          2U         /*!< LLCP services that can be registered                                      */
+    #endif /* RFAL_FEATURE_LLCP */
+#endif /* RFAL_FEATURE_LLCP_SERVICES */
+
+
 #ifndef RFAL_FEATURE_NFC_RF_BUF_LEN
     #define RFAL_FEATURE_NFC_RF_BUF_LEN             258U       /*!< RF buffer length used by RFAL NFC layer                                   */
 #endif /* RFAL_FEATURE_NFC_RF_BUF_LEN */
 
 
+#ifndef RFAL_FEATURE_INSTANCES
+    #define RFAL_FEATURE_INSTANCES                  1U         /*!< Number of ST25R391x driven by RFAL, each with its own RFAL instance       */
+#endif /* RFAL_FEATURE_INSTANCES */
+
+
 /**************************************
     Disabled by default/omission:
         - RFAL_FEATURE_ST25xV
         - RFAL_FEATURE_DYNAMIC_ANALOG_CONFIG
         - RFAL_FEATURE_DPO
+        - RFAL_FEATURE_LLCP
+        - RFAL_FEATURE_STATS
+        - RFAL_FEATURE_TRACE
  */
 
  
@@ -222,6 +321,14 @@
     #define platformUnprotectWorker()                  /*!< Unprotect RFAL Worker/Task/Process from concurrent execution on multi thread platforms */
 #endif /* platformUnprotectWorker */
 
+#ifndef platformSetInstance
+    #define platformSetInstance( inst )                (gRfalInstance = (inst))   /*!< Select the RFAL instance of the calling thread - global var on a single thread environment ; per thread on a multi thread environment */
+#endif /* platformSetInstance */
+
+#ifndef platformGetInstance
+    #define platformGetInstance()                      (gRfalInstance)            /*!< RFAL instance selected by the calling thread                                                                                          */
+#endif /* platformGetInstance */
+
 #ifndef platformIrqST25RPinInitialize
     #define platformIrqST25RPinInitialize()            /*!< Initializes ST25R IRQ pin                     */
 #endif /* platformIrqST25RPinInitialize */                                                                
@@ -251,6 +358,10 @@
     #define platformGetSysTick()                       /*!< Get System Tick ( 1 tick = 1 ms)              */
 #endif /* platformGetSysTick */                                                                           
 
+#ifndef platformGetSysTickUs
+    #define platformGetSysTickUs()                     (platformGetSysTick() * 1000U) /*!< Get System Tick in microseconds, for the instrumentation */
+#endif /* platformGetSysTickUs */
+
 #ifndef platformTimerDestroy                                                                              
     #define platformTimerDestroy( timer )              /*!< Stops and released the given timer            */
 #endif /* platformTimerDestroy */                                                                         
@@ -29,6 +29,14 @@
  *  
  *  This module provides an interface to perform the power adjustment dynamically 
  *  
+ *  Besides the reference measurement thresholds of the table, the power 
+ *  is adjusted in closed loop on the link quality: while a device is 
+ *  activated every frame is accounted, together with the last reference 
+ *  measurement, on the current table entry. Link errors step the power up, 
+ *  error free windows step it down to the lowest level the statistics 
+ *  show to be reliable, and the table thresholds are learnt from those 
+ *  statistics at the end of each session.
+ *  
  *  
  * \addtogroup RFAL
  * @{
@@ -64,6 +72,9 @@
 
 #define RFAL_DPO_TABLE_SIZE_MAX      15U   /*!< Max DPO table size */
 #define RFAL_DPO_TABLE_PARAMETER     3U    /*!< DPO table Parameter length */
+#define RFAL_DPO_TABLE_ENTRIES_MAX   (RFAL_DPO_TABLE_SIZE_MAX / RFAL_DPO_TABLE_PARAMETER) /*!< Max DPO table entries */
+#define RFAL_DPO_MEAS_BINS           16U   /*!< Measurement bins the link statistics are kept on */
+#define RFAL_DPO_MEAS_BIN_SHIFT      4U    /*!< Measurement to bin shift: 16 measurement values per bin */
 
 /*
 ******************************************************************************
@@ -81,6 +92,23 @@ typedef struct {
 /*! Function pointer to methode doing the reference measurement */
 typedef ReturnCode (*rfalDpoMeasureFunc)(uint8_t*);
 
+/*! DPO link statistics of a single table entry */
+typedef struct {
+    uint16_t okCnt[RFAL_DPO_MEAS_BINS];   /*!< Frames received, per reference measurement bin    */
+    uint16_t errCnt[RFAL_DPO_MEAS_BINS];  /*!< Frames corrupted or lost, per measurement bin     */
+}rfalDpoEntryStats;
+
+/*! DPO closed loop statistics */
+typedef struct {
+    rfalDpoEntryStats entry[RFAL_DPO_TABLE_ENTRIES_MAX]; /*!< Statistics per table entry         */
+    uint32_t          frameCnt;                 /*!< Frames accounted                            */
+    uint32_t          errCnt;                   /*!< CRC, parity, framing errors and timeouts    */
+    uint16_t          stepUpCnt;                /*!< Power raised on link errors                 */
+    uint16_t          stepDownCnt;              /*!< Power lowered after error free windows      */
+    uint16_t          learnCnt;                 /*!< Table thresholds learnt                     */
+    uint8_t           lastMeas;                 /*!< Last reference measurement                  */
+}rfalDpoStats;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -204,6 +232,91 @@ void rfalDpoSetEnabled( bool enable );
  */
 bool rfalDpoIsEnabled(void);
 
+/*! 
+ *****************************************************************************
+ * \brief  Dynamic power Link monitor
+ *  
+ * Starts/stops accounting the frames on the link statistics, to be enabled 
+ * while a device is activated (frames of the polling and of the 
+ * deactivation do not reflect the link quality). Stopping it learns the
+ * table thresholds from the statistics
+ *
+ * \param[in] enable : true when a device got activated, false on deactivation
+ *
+ *****************************************************************************
+ */
+void rfalDpoSetLinkMonitor( bool enable );
+
+/*! 
+ *****************************************************************************
+ * \brief  Dynamic power Link monitor pause
+ *  
+ * Pauses/resumes accounting the frames on the link statistics, e.g. around
+ * an SLP_REQ or a presence check: they end in a timeout whenever the device
+ * does not answer on purpose or has left, which is no link error. Unlike
+ * rfalDpoSetLinkMonitor() the windows and the statistics are kept. Pauses
+ * nest: the frames are accounted again once each pause has been resumed
+ *
+ * \param[in] pause : true to pause, false to resume
+ *
+ *****************************************************************************
+ */
+void rfalDpoPauseLinkMonitor( bool pause );
+
+/*! 
+ *****************************************************************************
+ * \brief  Dynamic power Report result
+ *  
+ * Accounts the outcome of a frame reception on the current table entry and 
+ * measurement bin. Errors within a window raise the power, consecutive 
+ * error free windows lower it if the lower level is reliable on the current 
+ * measurement bin. Called by the RF layer on every reception
+ *
+ * \param[in] err : transceive outcome
+ *
+ *****************************************************************************
+ */
+void rfalDpoReportResult( ReturnCode err );
+
+/*! 
+ *****************************************************************************
+ * \brief  Dynamic power Table learn
+ *  
+ * Sets the table thresholds from the link statistics: the increment 
+ * threshold of an entry at the first measurement bin where it is not 
+ * reliable, the decrement threshold at the last bin up to which the next 
+ * (lower power) entry is reliable. Thresholds of entries without enough 
+ * frames are kept. As the table, it assumes higher measurements require 
+ * higher power
+ * 
+ * \return RFAL_ERR_NONE     : Thresholds updated
+ * \return RFAL_ERR_NOMSG    : Not enough frames to learn any threshold
+ * \return RFAL_ERR_PARAM    : Invalid table
+ *****************************************************************************
+ */
+ReturnCode rfalDpoTableLearn( void );
+
+/*! 
+ *****************************************************************************
+ * \brief  Dynamic power Get statistics
+ *
+ * \param[out] stats : location to place the statistics
+ *  
+ * \return RFAL_ERR_NONE     : No error
+ * \return RFAL_ERR_PARAM    : Invalid parameter
+ *****************************************************************************
+ */
+ReturnCode rfalDpoGetStats( rfalDpoStats *stats );
+
+/*! 
+ *****************************************************************************
+ * \brief  Dynamic power Clear statistics
+ *  
+ * Clears the link statistics, forgetting what was learnt on the link
+ *****************************************************************************
+ */
+void rfalDpoClearStats( void );
+
 #endif /* RFAL_DPO_H */
 
 /**
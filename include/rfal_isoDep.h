@@ -168,6 +168,8 @@
 #define RFAL_ISODEP_MAX_WTX_RETRYS_ULTD         (255U)   /*!< Use unlimited number of overall S(WTX)                                      */
 #define RFAL_ISODEP_MAX_DSL_RETRYS              (0U)     /*!< Number of retries for a S(DESELECT) Digital 2.0 B9 - nRETRY DESELECT: [0,5] */
 #define RFAL_ISODEP_RATS_RETRIES                (1U)     /*!< RATS retries upon fail              Digital 2.0 B7 - nRETRY RATS [0,1]      */
+
+#define RFAL_ISODEP_LINK_RATES                  (4U)     /*!< Bit rates tracked by the link rate manager: 106, 212, 424 and 848 kbit/s */
  
 
 /*! Frame Size for Proximity Card Integer definitions                                                               */
@@ -185,7 +187,8 @@ typedef enum
       RFAL_ISODEP_FSXI_512  =  9,  /*!< Frame Size for Proximity Card Integer with 512 bytes   ISO14443-3 Amd2 2012 */
       RFAL_ISODEP_FSXI_1024 = 10,  /*!< Frame Size for Proximity Card Integer with 1024 bytes  ISO14443-3 Amd2 2012 */
       RFAL_ISODEP_FSXI_2048 = 11,  /*!< Frame Size for Proximity Card Integer with 2048 bytes  ISO14443-3 Amd2 2012 */
-      RFAL_ISODEP_FSXI_4096 = 12   /*!< Frame Size for Proximity Card Integer with 4096 bytes  ISO14443-3 Amd2 2012 */
+      RFAL_ISODEP_FSXI_4096 = 12,  /*!< Frame Size for Proximity Card Integer with 4096 bytes  ISO14443-3 Amd2 2012 */
+      RFAL_ISODEP_FSXI_AUTO = 0xFF /*!< Largest Frame Size the I-Block buffers can hold     \see rfalIsoDepGetMaxFSxI() */
 } rfalIsoDepFSxI;
 
 /*! Frame Size for Proximity Card  definitions                                                             */
@@ -420,6 +423,58 @@ typedef struct
     uint8_t                  DID;                      /*!< Device ID (RFAL_ISODEP_NO_DID if no DID) */
 } rfalIsoDepApduTxRxParam;
 
+
+/*! Scatter/gather segment of an APDU to be transmitted */
+typedef struct
+{
+    const uint8_t            *buf;                     /*!< Segment data                             */
+    uint16_t                 len;                      /*!< Segment length in Bytes                  */
+} rfalIsoDepSgSeg;
+
+
+/*! Structure of parameters used on ISO DEP scatter/gather APDU Transceive */
+typedef struct
+{
+    const rfalIsoDepSgSeg    *txSeg;                   /*!< Segments forming the APDU to transmit    */
+    uint8_t                  txSegCnt;                 /*!< Number of Tx segments                    */
+    uint8_t                  *rxBuf;                   /*!< Receive buffer, preceded by RFAL_ISODEP_PROLOGUE_SIZE Bytes */
+    uint16_t                 rxBufLen;                 /*!< Receive buffer length in Bytes           */
+    uint16_t                 *rxLen;                   /*!< Received APDU length in Bytes            */
+    rfalIsoDepBufFormat      *tmpBuf;                  /*!< Temp buffer for Tx I-Blocks (internal)   */
+    uint32_t                 FWT;                      /*!< FWT to be used                           */
+    uint32_t                 dFWT;                     /*!< Delta FWT to be used                     */
+    uint16_t                 FSx;                      /*!< Other device Frame Size (FSC)            */
+    uint16_t                 ourFSx;                   /*!< Our device Frame Size (FSD)              */
+    uint8_t                  DID;                      /*!< Device ID (RFAL_ISODEP_NO_DID if no DID) */
+} rfalIsoDepSgApduTxRxParam;
+
+
+/*! ISO-DEP link statistics of a single bit rate */
+typedef struct
+{
+    uint32_t                 txBytes;                  /*!< INF bytes sent at this bit rate          */
+    uint32_t                 rxBytes;                  /*!< INF bytes received at this bit rate      */
+    uint32_t                 xchgCnt;                  /*!< I-Block exchanges completed              */
+    uint32_t                 xchgTime;                 /*!< Time spent on those exchanges [ms]       */
+    uint16_t                 crcErrCnt;                /*!< CRC, parity and framing errors           */
+    uint16_t                 toErrCnt;                 /*!< Timeouts                                 */
+} rfalIsoDepRateStats;
+
+
+/*! ISO-DEP link rate manager statistics */
+typedef struct
+{
+    rfalIsoDepRateStats      rate[RFAL_ISODEP_LINK_RATES]; /*!< Statistics per bit rate, indexed by rfalBitRate */
+    uint16_t                 stepDownCnt;              /*!< Number of times the bit rate was lowered */
+    uint16_t                 stepUpCnt;                /*!< Number of times the bit rate was raised  */
+    rfalBitRate              maxBR;                    /*!< Current max bit rate allowed on the link */
+    uint32_t                 iBlockTxCnt;              /*!< I-Blocks sent                            */
+    uint32_t                 iBlockRxCnt;              /*!< I-Blocks received                        */
+    uint32_t                 roundTripCnt;             /*!< Blocks sent awaiting a response (I, R, S)*/
+    uint16_t                 fsd;                      /*!< FSD used on the last exchange            */
+    uint16_t                 fsc;                      /*!< FSC used on the last exchange            */
+} rfalIsoDepLinkStats;
+
 /*
  ******************************************************************************
  * GLOBAL FUNCTION PROTOTYPES
@@ -495,6 +550,21 @@ void rfalIsoDepInitializeWithParams( rfalComplianceMode compMode,
 uint16_t rfalIsoDepFSxI2FSx( uint8_t FSxI );
 
 
+/*!
+ *****************************************************************************
+ *  \brief  Get max FSxI
+ *
+ *  Returns the largest Frame Size Integer whose Frame Size fits the 
+ *  configured I-Block buffers (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN), 
+ *  bounded by the current compliance mode
+ *  
+ *  \return FSxI : largest FSDI/FSCI supported
+ *
+ *****************************************************************************
+ */
+rfalIsoDepFSxI rfalIsoDepGetMaxFSxI( void );
+
+
 /*! 
  *****************************************************************************
  *  \brief  FWI to FWT
@@ -706,6 +776,48 @@ ReturnCode rfalIsoDepStartApduTransceive( rfalIsoDepApduTxRxParam param );
  */
 ReturnCode rfalIsoDepGetApduTransceiveStatus( void );
 
+
+/*!
+ *****************************************************************************
+ *  \brief ISO-DEP Start scatter/gather APDU Transceive 
+ *  
+ *  This method triggers a ISO-DEP Transceive of a complete APDU given as a
+ *  list of segments (e.g. command header and user data) and receives the 
+ *  response APDU directly into the caller's buffer. 
+ *  Each received I-Block INF is placed at its final offset in param.rxBuf,
+ *  no intermediate copy of the response is done
+ *  
+ *  The Tx segments are only read, each Tx I-Block is gathered on param.tmpBuf
+ *  
+ *  \warning the RFAL_ISODEP_PROLOGUE_SIZE Bytes before param.rxBuf must be 
+ *           writable, they are used for the I-Block header and restored 
+ *  \warning only supported on Poller mode
+ *  
+ *  \param[in] param: reference parameters to be used for the Transceive
+ *                     
+ *  \return RFAL_ERR_PARAM       : Bad request
+ *  \return RFAL_ERR_NOTSUPP     : Not in Poller mode
+ *  \return RFAL_ERR_NONE        : The Transceive request has been started
+ *****************************************************************************
+ */
+ReturnCode rfalIsoDepStartSgApduTransceive( rfalIsoDepSgApduTxRxParam param );
+
+
+/*!
+ *****************************************************************************
+ *  \brief Get the scatter/gather APDU Transceive status
+ *  
+ *  \return RFAL_ERR_NONE        : if Transceive has been completed successfully
+ *  \return RFAL_ERR_BUSY        : if Transceive is ongoing
+ *  \return RFAL_ERR_WRONG_STATE : if no scatter/gather Transceive was started
+ *  \return RFAL_ERR_PROTO       : if a protocol error occurred
+ *  \return RFAL_ERR_TIMEOUT     : if a timeout error occurred
+ *  \return RFAL_ERR_NOMEM       : if the received APDU does not fit into the 
+ *                                 receive buffer
+ *****************************************************************************
+ */
+ReturnCode rfalIsoDepGetSgApduTransceiveStatus( void );
+
 /*! 
  *****************************************************************************
  *  \brief  ISO-DEP Send RATS
@@ -924,6 +1036,59 @@ ReturnCode rfalIsoDepPollBHandleActivation( rfalIsoDepFSxI FSDI, uint8_t DID, rf
 ReturnCode rfalIsoDepPollHandleSParameters( rfalIsoDepDevice *rfalIsoDepDev, rfalBitRate maxTxBR, rfalBitRate maxRxBR );
 
 
+/*! 
+ *****************************************************************************
+ *  \brief  ISO-DEP Poller Set Adaptive Bit Rate
+ *   
+ *  When enabled, the bit rate negotiated at activation (PPS, ATTRIB or 
+ *  S(PARAMETERS)) is bounded by a link max bit rate which follows the 
+ *  CRC/timeout errors observed on the I-Block exchanges.
+ *  Whenever RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS errors are seen within a 
+ *  window of RFAL_FEATURE_ISO_DEP_RATE_WINDOW exchanges, or an exchange fails,
+ *  the link max bit rate is lowered one step. After 
+ *  RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS error free windows it is raised 
+ *  one step again, up to the maxBR given at activation.
+ *  
+ *  If the bit rate was set with S(PARAMETERS) the new bit rate is applied 
+ *  before the next APDU, otherwise (PPS/ATTRIB may only be issued during 
+ *  activation) it is applied on the next activation.
+ *  A block in error is recovered by R(NAK) at the current bit rate: the 
+ *  S(PARAMETERS) exchange is blocking, it is never issued from within an 
+ *  ongoing transceive.
+ *
+ *  \param[in]  enable : true to enable the adaptive bit rate
+ *****************************************************************************
+ */
+void rfalIsoDepPollSetAdaptiveBitRate( bool enable );
+
+
+/*! 
+ *****************************************************************************
+ *  \brief  ISO-DEP Poller Get Link statistics
+ *   
+ *  Retrieves the per bit rate throughput and error counters of the 
+ *  ISO-DEP link together with the current link max bit rate, the I-Blocks
+ *  and round-trips used and the frame sizes of the last exchange
+ *
+ *  \param[out] stats : location to place the statistics
+ *
+ *  \return RFAL_ERR_PARAM        : Invalid parameters
+ *  \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalIsoDepPollGetLinkStats( rfalIsoDepLinkStats *stats );
+
+
+/*! 
+ *****************************************************************************
+ *  \brief  ISO-DEP Poller Clear Link statistics
+ *   
+ *  Clears the link statistics and restores the link max bit rate
+ *****************************************************************************
+ */
+void rfalIsoDepPollClearLinkStats( void );
+
+
 /*!
  *****************************************************************************
  *  \brief  ISO-DEP Poller Start NFC-A Activation 
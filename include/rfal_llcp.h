@@ -0,0 +1,365 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_llcp.h
+ *
+ *  \brief Provides an LLCP (Logical Link Control Protocol) link on top of NFC-DEP
+ *
+ *  This module implements the LLCP link layer used by peer-to-peer NFC
+ *  applications (e.g. SNEP) on top of an activated NFC-DEP device,
+ *  as Initiator or Target.
+ *
+ *  It supports:
+ *    - MAC link activation through the ATR_REQ/ATR_RES General Bytes
+ *    - Connectionless transport (UI PDUs)
+ *    - Connection-oriented transport with a negotiated MIU (MIUX) and receive
+ *      window (RW), I PDUs are sent back to back as long as the remote window
+ *      is open and acknowledged without extra round-trips
+ *    - Service name lookup by CONNECT to the SDP and by SNL
+ *
+ *  The link is symmetric: each call to rfalLlcpWorker() performs one NFC-DEP
+ *  exchange, sending the next pending PDU (or SYMM) and processing the
+ *  received one. Data is sent straight from the caller's buffers and
+ *  received data is handed to the callbacks straight from the RF buffer.
+ *
+ *  This implementation was based on the following specs:
+ *    - NFC Forum Logical Link Control Protocol 1.3  2016-01-06
+ *
+ * \addtogroup RFAL
+ * @{
+ *
+ * \addtogroup RFAL-AL
+ * \brief RFAL Abstraction Layer
+ * @{
+ *
+ * \addtogroup LLCP
+ * \brief RFAL LLCP Module
+ * @{
+ *
+ */
+
+
+#ifndef RFAL_LLCP_H
+#define RFAL_LLCP_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_platform/rfal_platform.h"
+#include "rfal_utils.h"
+#include "rfal_nfcDep.h"
+#include "rfal_defConfig.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_LLCP_MIU_DEFAULT                  128U     /*!< Default MIU, extended by MIUX               LLCP 1.3  5.2.2  */
+#define RFAL_LLCP_GB_MAX_LEN                    32U     /*!< Max General Bytes length built for ATR_REQ/ATR_RES           */
+
+#define RFAL_LLCP_SAP_SDP                     0x01U     /*!< Service Discovery Protocol SAP              LLCP 1.3  5.6    */
+#define RFAL_LLCP_SAP_SNEP                    0x04U     /*!< SNEP well known SAP                         LLCP 1.3  Table 21 */
+#define RFAL_LLCP_SN_SDP            "urn:nfc:sn:sdp"    /*!< Service Discovery Protocol service name                      */
+#define RFAL_LLCP_SN_SNEP          "urn:nfc:sn:snep"    /*!< SNEP service name                                            */
+
+#define RFAL_LLCP_LINK_INVALID                0xFFU     /*!< Invalid data link handle                                     */
+
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! LLCP data link (connection) states */
+typedef enum
+{
+    RFAL_LLCP_LINK_CLOSED        = 0,                   /*!< No connection                                */
+    RFAL_LLCP_LINK_CONNECTING    = 1,                   /*!< CONNECT sent, waiting for CC/DM              */
+    RFAL_LLCP_LINK_CONNECTED     = 2,                   /*!< Connection established                       */
+    RFAL_LLCP_LINK_DISCONNECTING = 3                    /*!< DISC sent, waiting for DM                    */
+} rfalLlcpLinkState;
+
+
+/*! Connection-oriented data received on a data link (INF straight from the RF buffer) */
+typedef void (* rfalLlcpRxCallback)( uint8_t link, const uint8_t *data, uint16_t dataLen );
+
+/*! Data link state changed */
+typedef void (* rfalLlcpStateCallback)( uint8_t link, rfalLlcpLinkState state );
+
+/*! Incoming connection on a service, return true to accept it */
+typedef bool (* rfalLlcpConnectCallback)( uint8_t link );
+
+/*! Connectionless data received on a service */
+typedef void (* rfalLlcpUiCallback)( uint8_t ssap, const uint8_t *data, uint16_t dataLen );
+
+
+/*! LLCP service, bound to a SAP and optionally to a service name */
+typedef struct
+{
+    uint8_t                  sap;                       /*!< Local SAP the service is bound to            */
+    const char               *sn;                       /*!< Service name (NULL if none)                  */
+    rfalLlcpConnectCallback  connectCb;                 /*!< Incoming connection (NULL: connectionless)   */
+    rfalLlcpRxCallback       rxCb;                      /*!< Data received on accepted connections        */
+    rfalLlcpStateCallback    stateCb;                   /*!< State changes on accepted connections        */
+    rfalLlcpUiCallback       uiCb;                      /*!< Connectionless data received (NULL if none)  */
+} rfalLlcpService;
+
+
+/*! LLCP link statistics */
+typedef struct
+{
+    uint32_t                 xchgCnt;                   /*!< NFC-DEP exchanges (one PDU each way)         */
+    uint32_t                 iTxCnt;                    /*!< I PDUs sent                                  */
+    uint32_t                 iRxCnt;                    /*!< I PDUs received                              */
+    uint32_t                 symmTxCnt;                 /*!< SYMM PDUs sent (nothing else to send)        */
+    uint32_t                 rrTxCnt;                   /*!< RR PDUs sent                                 */
+    uint32_t                 winFullCnt;                /*!< Turns with data pending but remote window full */
+    uint32_t                 txBytes;                   /*!< Information bytes sent (I and UI)            */
+    uint32_t                 rxBytes;                   /*!< Information bytes received (I and UI)        */
+    uint32_t                 ltoExpCnt;                 /*!< Links dropped on the remote LTO expiring     */
+    uint16_t                 remoteMIU;                 /*!< Link MIU announced by the remote             */
+    uint16_t                 remoteLTO;                 /*!< Link timeout announced by the remote [ms]    */
+} rfalLlcpStats;
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Get General Bytes
+ *
+ * Builds the LLCP magic number and parameters (VERSION, MIUX, WKS, LTO, OPT)
+ * to be placed on the ATR_REQ/ATR_RES General Bytes
+ *
+ * \param[out] gb    : buffer (RFAL_LLCP_GB_MAX_LEN) to place the General Bytes
+ * \param[out] gbLen : General Bytes length
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpGetGeneralBytes( uint8_t *gb, uint8_t *gbLen );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Register Service
+ *
+ * Binds a service to its SAP, it will be reachable by SAP and service name
+ * while the link is up. The service struct must remain valid.
+ *
+ * \param[in] service : service to be registered
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_NOMEM        : No more services can be registered
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpRegisterService( const rfalLlcpService *service );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Link Activation
+ *
+ * Performs the LLCP MAC link activation with the General Bytes received from
+ * the remote device (ATR_RES as Initiator, ATR_REQ as Target)
+ *
+ * \param[in] remoteGB    : remote device General Bytes
+ * \param[in] remoteGBLen : remote device General Bytes length
+ * \param[in] isInitiator : true if the local device is the NFC-DEP Initiator
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_PROTO        : Remote device does not support LLCP
+ * \return RFAL_ERR_NONE         : Link activated
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpStart( const uint8_t *remoteGB, uint8_t remoteGBLen, bool isInitiator );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Link Deactivation
+ *
+ * Closes all data links and deactivates the LLCP link
+ *****************************************************************************
+ */
+void rfalLlcpStop( void );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Worker
+ *
+ * Performs one symmetric NFC-DEP exchange: sends the next pending PDU
+ * (or SYMM) and processes the PDU received. It blocks until the exchange
+ * completes or the remote LTO expires without an answer.
+ *
+ * \return RFAL_ERR_WRONG_STATE  : Link not active
+ * \return RFAL_ERR_LINK_LOSS    : NFC-DEP link lost or remote LTO expired, LLCP link deactivated
+ * \return RFAL_ERR_NONE         : Exchange done
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpWorker( void );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Is Link Active
+ *
+ * \return true if the LLCP link is active
+ *****************************************************************************
+ */
+bool rfalLlcpIsActive( void );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Connect
+ *
+ * Requests a connection to a remote service, by service name (sent to the SDP)
+ * or by SAP. The connection is established on the next rfalLlcpWorker() calls
+ *
+ * \param[in]  dsap    : remote SAP, ignored if sn is given
+ * \param[in]  sn      : remote service name or NULL
+ * \param[in]  rxCb    : data received callback
+ * \param[in]  stateCb : state change callback (may be NULL)
+ * \param[out] link    : data link handle
+ *
+ * \return RFAL_ERR_WRONG_STATE  : Link not active
+ * \return RFAL_ERR_NOMEM        : No data link available
+ * \return RFAL_ERR_NONE         : Connection requested
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpConnect( uint8_t dsap, const char *sn, rfalLlcpRxCallback rxCb, rfalLlcpStateCallback stateCb, uint8_t *link );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Send
+ *
+ * Queues a SDU on a connected data link. It is sent as hdr followed by data,
+ * segmented in I PDUs of up to the remote MIU. No copy is done, both buffers
+ * must remain valid until rfalLlcpIsSendDone()
+ *
+ * \param[in] link    : data link handle
+ * \param[in] hdr     : first part of the SDU (may be NULL)
+ * \param[in] hdrLen  : first part length
+ * \param[in] data    : second part of the SDU (may be NULL)
+ * \param[in] dataLen : second part length
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_WRONG_STATE  : Data link not connected
+ * \return RFAL_ERR_BUSY         : Previous send still ongoing
+ * \return RFAL_ERR_NONE         : Send queued
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpSend( uint8_t link, const uint8_t *hdr, uint16_t hdrLen, const uint8_t *data, uint32_t dataLen );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Is Send Done
+ *
+ * \param[in] link : data link handle
+ *
+ * \return true if all queued data has been sent
+ *****************************************************************************
+ */
+bool rfalLlcpIsSendDone( uint8_t link );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Send UI
+ *
+ * Queues a connectionless SDU (UI PDU), up to the remote link MIU. No copy
+ * is done, data must remain valid until sent (next rfalLlcpWorker())
+ *
+ * \param[in] dsap    : remote SAP
+ * \param[in] ssap    : local SAP
+ * \param[in] data    : data to send
+ * \param[in] dataLen : data length
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter or larger than MIU
+ * \return RFAL_ERR_BUSY         : Previous UI not sent yet
+ * \return RFAL_ERR_NONE         : UI queued
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpSendUI( uint8_t dsap, uint8_t ssap, const uint8_t *data, uint16_t dataLen );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Disconnect
+ *
+ * Requests the disconnection of a data link
+ *
+ * \param[in] link : data link handle
+ *
+ * \return RFAL_ERR_PARAM        : Invalid data link
+ * \return RFAL_ERR_NONE         : Disconnection requested
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpDisconnect( uint8_t link );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Get data link State
+ *
+ * \param[in] link : data link handle
+ *
+ * \return data link state
+ *****************************************************************************
+ */
+rfalLlcpLinkState rfalLlcpGetLinkState( uint8_t link );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Get data link remote MIU
+ *
+ * \param[in] link : data link handle
+ *
+ * \return MIU announced by the remote for this data link
+ *****************************************************************************
+ */
+uint16_t rfalLlcpGetLinkMIU( uint8_t link );
+
+
+/*!
+ *****************************************************************************
+ * \brief  LLCP Get statistics
+ *
+ * \param[out] stats : location to place the statistics
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalLlcpGetStats( rfalLlcpStats *stats );
+
+
+#endif /* RFAL_LLCP_H */
+
+/**
+  * @}
+  *
+  * @}
+  *
+  * @}
+  */
@@ -89,6 +89,11 @@
 #define RFAL_NFC_LISTEN_TECH_F           0x4000U  /*!< Listen NFC-F technology Flag      */
 #define RFAL_NFC_LISTEN_TECH_AP2P        0x8000U  /*!< Listen AP2P technology Flag       */
 
+#define RFAL_NFC_SCHED_TECH_NUM          6U       /*!< Number of passive poll technologies handled by the poll scheduler */
+#define RFAL_NFC_SCHED_SCORE_MAX         252U     /*!< Poll scheduler hit score of a technology found on every cycle     */
+#define RFAL_NFC_SCHED_PROBE_PERIOD_DFLT 8U       /*!< Default max cycles a rare technology may be skipped               */
+#define RFAL_NFC_SCHED_MIN_SCORE_DFLT    16U      /*!< Default hit score below which a technology is considered rare     */
+
 
 /*
 ******************************************************************************
@@ -116,16 +121,19 @@
                                         ((rfalNfcDiscoverParam*)(dp))->nfcfBR                 = RFAL_BR_212;              \
                                         ((rfalNfcDiscoverParam*)(dp))->ap2pBR                 = RFAL_BR_424;              \
                                         ((rfalNfcDiscoverParam*)(dp))->maxBR                  = RFAL_BR_KEEP;             \
-                                        ((rfalNfcDiscoverParam*)(dp))->isoDepFS               = RFAL_ISODEP_FSXI_256;     \
-                                        ((rfalNfcDiscoverParam*)(dp))->nfcDepLR               = RFAL_NFCDEP_LR_254;       \
+                                        ((rfalNfcDiscoverParam*)(dp))->isoDepFS               = RFAL_ISODEP_FSXI_AUTO;    \
+                                        ((rfalNfcDiscoverParam*)(dp))->nfcDepLR               = RFAL_NFCDEP_LR_AUTO;      \
                                         ((rfalNfcDiscoverParam*)(dp))->GBLen                  = 0U;                       \
                                         ((rfalNfcDiscoverParam*)(dp))->p2pNfcaPrio            = false;                    \
                                         ((rfalNfcDiscoverParam*)(dp))->wakeupEnabled          = false;                    \
                                         ((rfalNfcDiscoverParam*)(dp))->wakeupConfigDefault    = true;                     \
                                         ((rfalNfcDiscoverParam*)(dp))->wakeupNPolls           = 1U;                       \
+                                        ((rfalNfcDiscoverParam*)(dp))->wakeupCdConfirm        = false;                    \
                                         ((rfalNfcDiscoverParam*)(dp))->totalDuration          = 1000U;                    \
                                         ((rfalNfcDiscoverParam*)(dp))->techs2Find             = RFAL_NFC_TECH_NONE;       \
                                         ((rfalNfcDiscoverParam*)(dp))->techs2Bail             = RFAL_NFC_TECH_NONE;       \
+                                        ((rfalNfcDiscoverParam*)(dp))->pollSched.policy       = RFAL_NFC_POLL_SCHED_FIXED;\
+                                        ((rfalNfcDiscoverParam*)(dp))->hotReacquire           = false;                    \
                                         }
 
 /*
@@ -146,6 +154,8 @@ typedef enum{
     RFAL_NFC_STATE_IDLE                     =  1,   /*!< Initialize state            */
     RFAL_NFC_STATE_START_DISCOVERY          =  2,   /*!< Start Discovery loop state  */
     RFAL_NFC_STATE_WAKEUP_MODE              =  3,   /*!< Wake-Up state               */
+    RFAL_NFC_STATE_WAKEUP_CD                =  4,   /*!< Wake-Up Card Detection state*/
+    RFAL_NFC_STATE_POLL_REACQUIRE           =  9,   /*!< Last device reacquire state */
     RFAL_NFC_STATE_POLL_TECHDETECT          =  10,  /*!< Technology Detection state  */
     RFAL_NFC_STATE_POLL_COLAVOIDANCE        =  11,  /*!< Collision Avoidance state   */
     RFAL_NFC_STATE_POLL_SELECT              =  12,  /*!< Wait for Selection state    */
@@ -216,6 +226,48 @@ typedef struct{
 }rfalNfcDevice;
 
 
+/*! Technology Detection poll scheduling policy                                                          */
+typedef enum{
+    RFAL_NFC_POLL_SCHED_FIXED               = 0,    /*!< Poll all technologies in the fixed Activity order (default)   */
+    RFAL_NFC_POLL_SCHED_ORDERED             = 1,    /*!< Poll all technologies, most frequently found ones first       */
+    RFAL_NFC_POLL_SCHED_WEIGHTED            = 2     /*!< Poll ordered and skip rare technologies except on probe cycles */
+}rfalNfcPollSchedPolicy;
+
+
+/*! Technology Detection poll scheduler configuration                                                    */
+typedef struct{
+    rfalNfcPollSchedPolicy policy;                  /*!< Scheduling policy                                            */
+    uint8_t                probePeriod;             /*!< Max consecutive cycles a rare technology is skipped (0: default) */
+    uint8_t                minScore;                /*!< Hit score below which a technology is rare (0: default)      */
+}rfalNfcPollSchedParam;
+
+
+/*! Technology Detection poll scheduler statistics                                                       */
+typedef struct{
+    uint32_t               cycles;                             /*!< Technology Detection cycles performed             */
+    uint32_t               detectCnt;                          /*!< Cycles in which a technology was found            */
+    uint32_t               detectTimeSum;                      /*!< Sum of cycle start to first detection times (ms)  */
+    uint32_t               pollTimeSum;                        /*!< Sum of all Technology Detection durations (ms)    */
+    uint16_t               techs[RFAL_NFC_SCHED_TECH_NUM];     /*!< Technology flag of each entry below               */
+    uint32_t               polls[RFAL_NFC_SCHED_TECH_NUM];     /*!< Number of times each technology has been polled   */
+    uint32_t               hits[RFAL_NFC_SCHED_TECH_NUM];      /*!< Number of times each technology has been found    */
+    uint8_t                score[RFAL_NFC_SCHED_TECH_NUM];     /*!< Current hit score (0 .. RFAL_NFC_SCHED_SCORE_MAX) */
+}rfalNfcPollSchedStats;
+
+
+/*! Low power Wake-Up statistics                                                                       */
+typedef struct{
+    uint32_t               elapsed;                            /*!< Time since initialization or the last reset (ms)  */
+    uint32_t               wuTime;                             /*!< Time spent in Wake-Up mode, RF field off (ms)     */
+    uint32_t               wakeCnt;                            /*!< Wake-Ups signalled by the RF chip                 */
+    uint32_t               cdFalseCnt;                         /*!< Wake-Ups not confirmed by Card Detection          */
+    uint32_t               wakeActCnt;                         /*!< Wake-Ups followed by a device activation          */
+    uint32_t               wakeActTimeSum;                     /*!< Sum of Wake-Up to activation times (ms)           */
+    uint32_t               lastWake;                           /*!< System tick of the last Wake-Up                   */
+    bool                   lastActWoken;                       /*!< Last device activation followed a Wake-Up         */
+}rfalNfcWakeUpStats;
+
+
 /*! Callbacks for Proprietary|Other Technology      Activity 2.1   &   EMVCo 3.0  9.2 */
 typedef ReturnCode (* rfalNfcPropCallback)(void);
 
@@ -249,8 +301,8 @@ typedef struct{
     rfalNfcPropCallbacks   propNfc;                          /*!< Proprietary Technlogy callbacks                                    */
                                                                                                                                     
                                                                                                                                     
-    rfalIsoDepFSxI         isoDepFS;                         /*!< ISO-DEP Poller announced maximum frame size   Digital 2.2 Table 60 */
-    uint8_t                nfcDepLR;                         /*!< NFC-DEP Poller & Listener maximum frame size  Digital 2.2 Table 90 */
+    rfalIsoDepFSxI         isoDepFS;                         /*!< ISO-DEP Poller announced maximum frame size   Digital 2.2 Table 60, RFAL_ISODEP_FSXI_AUTO: from buffer sizes */
+    uint8_t                nfcDepLR;                         /*!< NFC-DEP Poller & Listener maximum frame size  Digital 2.2 Table 90, RFAL_NFCDEP_LR_AUTO: from buffer sizes */
                                                                                                                                     
     rfalLmConfPA           lmConfigPA;                       /*!< Configuration for Passive Listen mode NFC-A                        */
     rfalLmConfPF           lmConfigPF;                       /*!< Configuration for Passive Listen mode NFC-A                        */
@@ -261,6 +313,9 @@ typedef struct{
     bool                   wakeupConfigDefault;              /*!< Wake-Up mode default configuration                                 */
     rfalWakeUpConfig       wakeupConfig;                     /*!< Wake-Up mode configuration                                         */
     uint16_t               wakeupNPolls;                     /*!< Number of polling cycles before entering Wake-up                   */
+    bool                   wakeupCdConfirm;                  /*!< Confirm a Wake-Up with Card Detection before Technology Detection  */
+    rfalNfcPollSchedParam  pollSched;                        /*!< Technology Detection poll scheduler configuration                  */
+    bool                   hotReacquire;                     /*!< Try to wake the last activated device before Technology Detection  */
 }rfalNfcDiscoverParam;
 
 
@@ -448,6 +503,27 @@ ReturnCode rfalNfcDataExchangeStart( uint8_t *txData, uint16_t txDataLen, uint8_
 ReturnCode rfalNfcDataExchangeGetStatus( void );
 
 
+/*! 
+ *****************************************************************************
+ * \brief  RFAL NFC Get Data Exchange Tx buffer
+ *  
+ * Provides the buffer the active ISO-DEP or NFC-DEP interface transmits
+ * from, so that the data to be sent can be composed in place (e.g. a
+ * response built straight from a tag image in Listen mode).
+ * rfalNfcDataExchangeStart() does not copy txData when it is this buffer
+ *
+ * \param[out] txBuf    : location of the Tx buffer
+ * \param[out] txBufLen : Tx buffer length in bytes
+ *
+ * \return RFAL_ERR_WRONG_STATE  : No device activated
+ * \return RFAL_ERR_NOTSUPP      : RF interface has no Tx buffer (data sent from txData)
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcDataExchangeGetTxBuf( uint8_t **txBuf, uint16_t *txBufLen );
+
+
 /*! 
  *****************************************************************************
  * \brief  RFAL NFC Deactivate
@@ -469,6 +545,83 @@ ReturnCode rfalNfcDataExchangeGetStatus( void );
  */
 ReturnCode rfalNfcDeactivate( rfalNfcDeactivateType deactType );
 
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL NFC Get Poll Scheduler Statistics
+ *  
+ * It retrieves the hit statistics gathered by the Technology Detection 
+ * poll scheduler since initialization (or the last reset).
+ * The mean time-to-detect is given by detectTimeSum / detectCnt.
+ *
+ * \param[out]  stats            : location to copy the statistics to
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcGetPollSchedStats( rfalNfcPollSchedStats *stats );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL NFC Reset Poll Scheduler
+ *  
+ * It clears the learned technology mix and the statistics, all 
+ * technologies are considered equally likely afterwards.
+ *****************************************************************************
+ */
+void rfalNfcResetPollSched( void );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL NFC Get Wake-Up Statistics
+ *  
+ * It retrieves the low power Wake-Up statistics since initialization 
+ * (or the last reset).
+ * The RF field-on duty cycle is given by 1 - (wuTime / elapsed) and the 
+ * mean Wake-Up to activation latency by wakeActTimeSum / wakeActCnt.
+ * The times are 32 bit milliseconds: elapsed wraps after ~49 days, so the
+ * statistics are best reset on each report.
+ *
+ * \param[out]  stats            : location to copy the statistics to
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcGetWakeUpStats( rfalNfcWakeUpStats *stats );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL NFC Reset Wake-Up Statistics
+ *****************************************************************************
+ */
+void rfalNfcResetWakeUpStats( void );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL NFC Forget Last Device
+ *  
+ * It discards the last activated device so that the next discovery cycle 
+ * performs a full Technology Detection and Collision Resolution even if 
+ * hotReacquire is enabled. 
+ * 
+ * Hot reacquire: when enabled on the discovery parameters, each discovery 
+ * cycle first attempts a targeted wake-up of the last activated device 
+ * (NFC-A WUPA + SELECT by the cached NFCID1, NFC-V INVENTORY masked with the 
+ * cached UID, NFC-F SENSF_REQ with the cached System Code and NFCID2 check). 
+ * It is tried ahead of the Wake-Up mode, which a device left in the field 
+ * would not wake. On a hit the device goes straight to activation, on a 
+ * miss the cached device is forgotten and a full Technology Detection 
+ * follows.
+ *****************************************************************************
+ */
+void rfalNfcForgetLastDevice( void );
+
 #endif /* RFAL_NFC_H */
 
 
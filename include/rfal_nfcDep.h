@@ -224,7 +224,8 @@ enum{
     RFAL_NFCDEP_LR_64  = 0x00,              /*!< Maximum payload size is  64 bytes    */
     RFAL_NFCDEP_LR_128 = 0x01,              /*!< Maximum payload size is 128 bytes    */
     RFAL_NFCDEP_LR_192 = 0x02,              /*!< Maximum payload size is 192 bytes    */
-    RFAL_NFCDEP_LR_254 = 0x03               /*!< Maximum payload size is 254 bytes    */
+    RFAL_NFCDEP_LR_254 = 0x03,              /*!< Maximum payload size is 254 bytes    */
+    RFAL_NFCDEP_LR_AUTO = 0xFF              /*!< Largest LR the block buffers can hold  \see rfalNfcDepGetMaxLR() */
 };
 
 /*
@@ -436,7 +437,7 @@ typedef struct
     uint16_t                 txBufLen;  /*!< Transmit Buffer INF field length in Bytes*/
     rfalNfcDepPduBufFormat   *rxBuf;    /*!< Receive Buffer struct reference in Bytes */
     uint16_t                 *rxLen;    /*!< Received INF data length in Bytes        */
-    rfalNfcDepBufFormat      *tmpBuf;   /*!< Temp buffer for single PDUs (internal)   */
+    rfalNfcDepBufFormat      *tmpBuf;   /*!< Buffer for control PDUs received between PDU Transceives (internal) */
     uint32_t                 FWT;       /*!< FWT to be used (ignored in Listen Mode)  */
     uint32_t                 dFWT;      /*!< Delta FWT to be used                     */
     uint16_t                 FSx;       /*!< Other device Frame Size (FSD or FSC)     */
@@ -444,6 +445,25 @@ typedef struct
 } rfalNfcDepPduTxRxParam;
 
 
+/*! NFC-DEP session statistics, cleared on every activation */
+typedef struct
+{
+    uint32_t                 pduCnt;    /*!< PDU Transceives completed                */
+    uint32_t                 txBytes;   /*!< PDU bytes sent                           */
+    uint32_t                 rxBytes;   /*!< PDU bytes received                       */
+    uint32_t                 xchgTime;  /*!< Time spent on those PDU Transceives [ms] */
+    uint32_t                 bytesPerSec; /*!< Throughput of tx and rx bytes over xchgTime [bytes/s] */
+    uint32_t                 iTxCnt;    /*!< I-PDUs (blocks) sent                     */
+    uint32_t                 iRxCnt;    /*!< I-PDUs (blocks) received                 */
+    uint16_t                 ackTxCnt;  /*!< ACKs sent (chaining on reception)        */
+    uint16_t                 ackRxCnt;  /*!< ACKs received (chaining on transmission) */
+    uint16_t                 nackTxCnt; /*!< NACKs sent                               */
+    uint16_t                 nackRxCnt; /*!< NACKs received                           */
+    uint16_t                 atnCnt;    /*!< ATNs sent                                */
+    uint16_t                 rtoxCnt;   /*!< RTOX requests/responses sent             */
+} rfalNfcDepStats;
+
+
 /*
  * *****************************************************************************
  * GLOBAL VARIABLE DECLARATIONS
@@ -739,9 +759,14 @@ ReturnCode rfalNfcDepGetTransceiveStatus( void );
  * 
  * The txBuf  contains a complete PDU to be transmitted 
  * The Prologue field will be manipulated by the Transceive
+ * 
+ * Every block is sent and received in place: a chained block is received
+ * straight after the data received so far on the rxBuf, no copy of the
+ * PDU data is done. The header of each block lands over the last bytes of
+ * the previous one, which are restored once the block is received
  *  
  * \warning the txBuf will be modified during the transmission
- * \warning the maximum RF frame which can be received is limited by param.tmpBuf
+ * \warning the rxBuf contents are only valid once the PDU Transceive is done
  * 
  * \param[in] param: reference parameters to be used for the Transceive
  *                    
@@ -773,6 +798,35 @@ ReturnCode rfalNfcDepStartPduTransceive( rfalNfcDepPduTxRxParam param );
  */
 ReturnCode rfalNfcDepGetPduTransceiveStatus( void );
 
+
+/*!
+ *****************************************************************************
+ * \brief Get max LR
+ *
+ * Returns the largest Length Reduction whose Frame Size fits the
+ * configured block buffers (RFAL_FEATURE_NFC_DEP_BLOCK_MAX_LEN)
+ * 
+ * \return LR : largest LR supported (RFAL_NFCDEP_LR_254 on the default config)
+ *****************************************************************************
+ */
+uint8_t rfalNfcDepGetMaxLR( void );
+
+
+/*!
+ *****************************************************************************
+ * \brief Get session statistics
+ *
+ * Retrieves the PDU throughput and the control PDU counters of the current
+ * NFC-DEP session. The statistics are cleared on every activation
+ * 
+ * \param[out] stats : location to place the statistics
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcDepGetStats( rfalNfcDepStats *stats );
+
 #endif /* RFAL_NFCDEP_H_ */
 
 /**
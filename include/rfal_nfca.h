@@ -186,6 +186,21 @@ typedef struct
     bool                     isSleep;                             /*!< Device sleeping flag                                                       */
 } rfalNfcaListenDevice;
 
+
+/*! NFC-A Collision Resolution statistics */
+typedef struct
+{
+    uint32_t                 sddReqCnt;                           /*!< SDD_REQ (anticollision) frames sent                                        */
+    uint32_t                 selReqCnt;                           /*!< SEL_REQ (select) frames sent                                               */
+    uint32_t                 seedHitCnt;                          /*!< Collisions resolved at once by a cached UID prefix                         */
+    uint32_t                 seedMissCnt;                         /*!< Cached UID prefixes tried with no answer                                   */
+    uint32_t                 devCnt;                              /*!< Devices resolved                                                           */
+} rfalNfcaColResStats;
+
+
+/*! NFC-A streaming Collision Resolution device found callback. Return false to stop the resolution */
+typedef bool (* rfalNfcaDevFoundCb)( const rfalNfcaListenDevice *nfcaDev );
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -549,6 +564,66 @@ ReturnCode rfalNfcaPollerStartFullCollisionResolution( rfalComplianceMode compMo
 ReturnCode rfalNfcaPollerGetFullCollisionResolutionStatus( void );
 
 
+/*!
+ *****************************************************************************
+ * \brief  NFC-A Poller Streaming Collision Resolution
+ *  
+ * Performs a Collision Resolution similar to rfalNfcaPollerSleepFullCollisionResolution
+ * but without a device list: each resolved device is put to Sleep and 
+ * reported through devFoundCb, so the number of devices is not bound to 
+ * a caller provided list (e.g. RFAL_NFC_MAX_DEVICES).
+ * 
+ * The callback is executed within the resolution loop and shall not 
+ * perform any RF communication.
+ * 
+ * Resolution stops once no more devices answer or the callback returns false.
+ *
+ * \param[in]  compMode    : compliance mode to be used on the first round
+ * \param[in]  devFoundCb  : callback to be executed for each device resolved
+ * \param[out] devCnt      : number of devices resolved
+ *
+ * \return RFAL_ERR_WRONG_STATE  : RFAL not initialized or mode not set
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_IO           : Generic internal error
+ * \return RFAL_ERR_NONE         : No error, at least one device resolved
+ *****************************************************************************
+ */
+ReturnCode rfalNfcaPollerStreamCollisionResolution( rfalComplianceMode compMode, rfalNfcaDevFoundCb devFoundCb, uint16_t *devCnt );
+
+
+/*!
+ *****************************************************************************
+ * \brief  NFC-A Get Collision Resolution statistics
+ *  
+ * Retrieves the counters of the Collision Resolution. 
+ * 
+ * When a collision is detected and RFAL_FEATURE_NFCA_UID_CACHE_LEN is 
+ * greater than zero, the UIDs of recently selected devices sharing the 
+ * bits already received are tried first: their complete cascade level is 
+ * sent within a single SDD_REQ, selecting a known device without walking 
+ * the remaining collision bits one by one. Only cascade levels that met a 
+ * collision are cached, and a device selected since the last ALL_REQ is 
+ * not tried again until the next ALL_REQ wakes it up.
+ *
+ * \param[out] stats : location to place the statistics
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcaPollerGetColResStats( rfalNfcaColResStats *stats );
+
+
+/*!
+ *****************************************************************************
+ * \brief  NFC-A Clear UID cache
+ *  
+ * Clears the UID prefix cache and the Collision Resolution statistics
+ *****************************************************************************
+ */
+void rfalNfcaPollerClearUidCache( void );
+
+
 /*!
  *****************************************************************************
  * \brief NFC-A Listener is SLP_REQ 
@@ -99,6 +99,7 @@
 #define RFAL_NFCF_SYSTEMCODE_LEN                 2U      /*!< SENSF_RES System Code length             Digital 2.3 8.6.1   */
 
 #define RFAL_NFCF_BLOCK_LEN                      16U     /*!< NFCF T3T Block size                        T3T 1.0  4.1      */
+#define RFAL_NFCF_CHECK_REQ_MAX_LEN              86U     /*!< Max length of a Check request              T3T 1.0  Table 7  */
 #define RFAL_NFCF_CHECKUPDATE_RES_ST1_POS        9U      /*!< Check|Update Res Status Flag 1 position    T3T 1.0  Table 8  */
 #define RFAL_NFCF_CHECKUPDATE_RES_ST2_POS        10U     /*!< Check|Update Res Status Flag 2 position    T3T 1.0  Table 8  */
 #define RFAL_NFCF_CHECKUPDATE_RES_NOB_POS        11U     /*!< Check|Update Res Number of Blocks position T3T 1.0  Table 8  */
@@ -179,6 +180,17 @@ typedef struct
     rfalNfcfSensfRes  sensfRes;                 /*!< SENF_RES           */
 } rfalNfcfListenDevice;
 
+
+/*! NFC-F Collision Resolution polling statistics */
+typedef struct
+{
+    uint32_t            pollCnt;                /*!< SENSF_REQ sent during Collision Resolution      */
+    uint32_t            slotCnt;                /*!< Sum of the Time Slots opened by those SENSF_REQ */
+    uint32_t            resCnt;                 /*!< SENSF_RES received                              */
+    uint32_t            collCnt;                /*!< Time Slots with a collision                     */
+    rfalFeliCaPollSlots slots;                  /*!< Time Slots to be used on the next SENSF_REQ     */
+} rfalNfcfPollStats;
+
 typedef  uint16_t rfalNfcfServ;                 /*!< NFC-F Service Code */
 
 /*! NFC-F Block List Element (2 or 3 bytes element)       T3T 1.0 5.6.1 */
@@ -366,6 +378,95 @@ ReturnCode rfalNfcfPollerStartCollisionResolution( rfalComplianceMode compMode,
 ReturnCode rfalNfcfPollerGetCollisionResolutionStatus( void );
 
 
+/*! 
+ *****************************************************************************
+ * \brief  NFC-F Poller Set Adaptive Time Slots
+ *  
+ * By default the Collision Resolution opens 16 Time Slots on every SENSF_REQ.
+ * When enabled, the number of Time Slots (1/2/4/8/16) is instead chosen 
+ * from the devices and collisions observed on the previous SENSF_REQ, the
+ * first one of a Collision Resolution being sized from the Technology 
+ * Detection poll:
+ *  - on a collision the population is unknown: the most Time Slots 
+ *    allowed by maxPollTime are opened at once
+ *  - when every device answered alone, about two Time Slots per device
+ *    are kept, a single card being polled with 1 slot; the count shrinks
+ *    one step per SENSF_REQ
+ * 
+ * maxPollTime bounds all the SENSF_REQs of a Collision Resolution (incl. 
+ * the one with RC=SC for NFC-DEP devices), each taking 2417us plus 1208us
+ * per Time Slot. A SENSF_REQ not fitting in what is left is sent with 
+ * fewer slots, or not at all. Below 21745us the Time Slots stay under 16 
+ * and collide more often than the default.
+ *
+ * \param[in]  enable      : true to enable adaptive Time Slots
+ * \param[in]  maxPollTime : max duration of the SENSF_REQs of a Collision Resolution [us]
+ *
+ * \return RFAL_ERR_PARAM        : maxPollTime too short for a single slot
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcfPollerSetAdaptiveSlots( bool enable, uint16_t maxPollTime );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  NFC-F Poller Get Poll statistics
+ *  
+ * Retrieves the Collision Resolution polling statistics
+ *
+ * \param[out] stats : location to place the statistics
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcfPollerGetPollStats( rfalNfcfPollStats *stats );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  NFC-F Poller Compose Check/Read
+ *  
+ * Composes the Check / Read command sent by rfalNfcfPollerCheck() 
+ * (LEN byte excluded, added on transmission)
+ *
+ * \param[in]  nfcid2      : nfcid2 of the device
+ * \param[in]  servBlock   : parameter containing the list of Services and
+ *                           Blocks to be addressed by this command
+ * \param[out] txBuf       : buffer where the request will be composed
+ * \param[in]  txBufLen    : size of txBuf, at least RFAL_NFCF_CHECK_REQ_MAX_LEN
+ * \param[out] txLen       : length of the request composed
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcfPollerComposeCheck( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock, uint8_t *txBuf, uint16_t txBufLen, uint16_t *txLen );
+
+
+/*! 
+ *****************************************************************************
+ * \brief  NFC-F Poller Compose Update/Write
+ *  
+ * Composes the Update / Write command sent by rfalNfcfPollerUpdate() 
+ * (LEN byte excluded, added on transmission)
+ *
+ * \param[in]  nfcid2      : nfcid2 of the device
+ * \param[in]  servBlock   : parameter containing the list of Services and
+ *                           Blocks to be addressed by this command
+ * \param[in]  blockData   : data to written on the given block(s)
+ * \param[out] txBuf       : buffer where the request will be composed
+ * \param[in]  txBufLen    : size of txBuf
+ * \param[out] txLen       : length of the request composed
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcfPollerComposeUpdate( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock, const uint8_t *blockData, uint8_t *txBuf, uint16_t txBufLen, uint16_t *txLen );
+
+
 /*! 
  *****************************************************************************
  * \brief  NFC-F Poller Check/Read
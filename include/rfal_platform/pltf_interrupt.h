@@ -5,6 +5,13 @@
 extern "C" {
 #endif
 
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include <stdint.h>
+
 /*! 
  *****************************************************************************
  * \brief  This function setups the Interrupt for the RFAL
@@ -14,6 +21,17 @@ extern "C" {
  */
 void interrupt_init(void);
 
+
+/*! 
+ *****************************************************************************
+ * \brief  IRQ pin of a reader
+ *  
+ * Returns the IRQ pin of the ST25R3911 driven by the given RFAL instance
+ * 
+ *****************************************************************************
+ */
+uint8_t pltf_irq_pin(uint8_t inst);
+
 /*! 
  *****************************************************************************
  * \brief  To protect interrupt status variable  of RFAL 
@@ -41,9 +41,9 @@ void spi_init(void);
 /* function for full duplex SPI communication */
 void spiTxRx(const uint8_t *txData, uint8_t *rxData, uint8_t length);
 
-void pltf_cs_select(void);
+void pltf_cs_select(uint8_t inst);
 
-void pltf_cs_deselect(void);
+void pltf_cs_deselect(uint8_t inst);
 
 /*! 
  *****************************************************************************
@@ -66,6 +66,31 @@ void pltf_protect_com(void);
  */
 void pltf_unprotect_com(void); 
 
+
+/*! 
+ *****************************************************************************
+ * \brief  To select the RFAL instance of the calling task
+ *  
+ * This method records the instance the calling task drives, so that 
+ * several tasks drive their readers concurrently, each SPI transaction 
+ * being serialized by pltf_protect_com.
+ * 
+ *****************************************************************************
+ */
+void pltf_set_instance(uint8_t inst);
+
+
+/*! 
+ *****************************************************************************
+ * \brief  RFAL instance of the calling task
+ *  
+ * This method returns the instance selected with pltf_set_instance by the 
+ * calling task, 0 if it selected none.
+ * 
+ *****************************************************************************
+ */
+uint8_t pltf_get_instance(void);
+
 #ifdef __cplusplus
 }
 #endif
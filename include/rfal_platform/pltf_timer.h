@@ -56,6 +56,7 @@ extern "C" {
 ******************************************************************************
 */
 uint32_t platformGetSysTick_esp32();
+uint32_t platformGetSysTickUs_esp32();
  
  /*! 
  *****************************************************************************
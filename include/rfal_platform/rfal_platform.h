@@ -38,7 +38,9 @@ extern "C" {
 
 #define ST25R3911
 
-#define ST25R_INT_PIN                     IRQ_PIN                   /*!< GPIO pin used for ST25R3911 External Interrupt */
+#define RFAL_FEATURE_INSTANCES            1U                        /*!< Number of ST25R3911 on the SPI bus, CS/IRQ pins of each in config.h (READER_SS_PINS/READER_IRQ_PINS) */
+
+#define ST25R_INT_PIN                     pltf_irq_pin(rfalInstance())  /*!< GPIO pin used for ST25R3911 External Interrupt of the selected instance */
 #define ST25R_INT_PORT                    0                         /*!< GPIO port used for ST25R3911 External Interrupt */
 
 /*
@@ -52,10 +54,17 @@ extern "C" {
 #define platformUnprotectST25RComm()          pltf_unprotect_com()
 
 #define platformIrqST25RPinInitialize()       interrupt_init();
+#if RFAL_FEATURE_INSTANCES > 1U
+#define platformIrqST25RSetCallback(cb)                                 /*!< Several readers: IRQ lines are polled by the selected instance, no ISR */
+#else
 #define platformIrqST25RSetCallback(cb)       attachInterrupt(digitalPinToInterrupt(ST25R_INT_PIN), cb, RISING)
+#endif /* RFAL_FEATURE_INSTANCES */
+
+#define platformSpiSelect()                   pltf_cs_select(rfalInstance())   /*!< SPI SS\CS: Chip|Slave Select of the selected instance   */
+#define platformSpiDeselect()                 pltf_cs_deselect(rfalInstance()) /*!< SPI SS\CS: Chip|Slave Deselect of the selected instance */
 
-#define platformSpiSelect()                   pltf_cs_select()       /*!< SPI SS\CS: Chip|Slave Select */
-#define platformSpiDeselect()                 pltf_cs_deselect()     /*!< SPI SS\CS: Chip|Slave Deselect */
+#define platformSetInstance(inst)             pltf_set_instance(inst)   /*!< Select the RFAL instance of the calling task */
+#define platformGetInstance()                 pltf_get_instance()       /*!< RFAL instance selected by the calling task   */
 
 #define platformProtectST25RIrqStatus()       pltf_protect_interrupt_status()   /*!< Acquire the lock for safe access of RFAL interrupt status variable */
 #define platformUnprotectST25RIrqStatus()     pltf_unprotect_interrupt_status() /*!< Release the lock aquired for safe accessing of RFAL interrupt status variable */
@@ -67,6 +76,7 @@ extern "C" {
 #define platformTimerIsExpired(timer)         timerIsExpired(timer)     /*!< Checks if the given timer is expired        */
 #define platformDelay(t)                      timerDelay(t)             /*!< Performs a delay for the given time (ms)    */
 #define platformGetSysTick()                  platformGetSysTick_esp32()/*!< Get System Tick ( 1 tick = 1 ms)            */
+#define platformGetSysTickUs()                platformGetSysTickUs_esp32()/*!< Get System Tick in microseconds (instrumentation) */
 
 #define platformSpiTxRx(txBuf, rxBuf, len)    spiTxRx(txBuf, rxBuf, len)/*!< SPI transceive */
 
@@ -94,13 +104,17 @@ extern "C" {
 
 #define RFAL_FEATURE_ST25TB                     false                   /*!< Enable/Disable RFAL support for ST25TB                                    */
 #define RFAL_FEATURE_DYNAMIC_ANALOG_CONFIG      true                    /*!< Enable/Disable Analog Configs to be dynamically updated (RAM)             */
-#define RFAL_FEATURE_DYNAMIC_POWER              false                   /*!< Enable/Disable RFAL dynamic power support                                 */
+#define RFAL_FEATURE_DPO                        true                    /*!< Enable/Disable RFAL dynamic power support                                 */
 #define RFAL_FEATURE_ISO_DEP                    true                   /*!< Enable/Disable RFAL support for ISO-DEP (ISO14443-4)                      */
 #define RFAL_FEATURE_NFC_DEP                    true                   /*!< Enable/Disable RFAL support for NFC-DEP (NFCIP1/P2P)                     */
+#define RFAL_FEATURE_LLCP                       true                    /*!< Enable/Disable RFAL support for LLCP/SNEP over NFC-DEP                    */
+#define RFAL_FEATURE_STATS                      true                    /*!< Enable/Disable RFAL timing and throughput instrumentation                 */
+#define RFAL_FEATURE_TRACE                      true                    /*!< Enable/Disable RFAL RF frame capture (records only once started)          */
 
 #define RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN     256                     /*!< ISO-DEP I-Block max length. Please use values as defined by rfalIsoDepFSx */
-#define RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN       1024                    /*!< ISO-DEP APDU max length. Please use multiples of I-Block max length       */
+#define RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN       512                     /*!< ISO-DEP APDU max length. Please use multiples of I-Block max length       */
 #define RFAL_FEATURE_NFC_RF_BUF_LEN             258U                    /*!< RF buffer length used by RFAL NFC layer                                   */
+#define RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN        2051U                   /*!< NFC-DEP PDU max length: one LLCP I PDU with a 2048 bytes MIU              */
 
 #ifdef __cplusplus
 }
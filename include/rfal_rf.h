@@ -133,6 +133,13 @@
 ******************************************************************************
 */
 
+/*! Returns the RFAL instance selected by the calling thread, the one all RFAL layers operate on */
+#if RFAL_FEATURE_INSTANCES > 1U
+    #define rfalInstance()                   ((uint8_t)platformGetInstance())
+#else
+    #define rfalInstance()                   (0U)
+#endif /* RFAL_FEATURE_INSTANCES */
+
 /*! Returns the maximum supported bit rate for RW mode. Caller must check if mode is supported before, as even if mode is not supported will return the min  */
 #define rfalGetMaxBrRW()                     ( ((RFAL_SUPPORT_BR_RW_6780)  ? RFAL_BR_6780 : ((RFAL_SUPPORT_BR_RW_3390)  ? RFAL_BR_3390 : ((RFAL_SUPPORT_BR_RW_1695)  ? RFAL_BR_1695 : ((RFAL_SUPPORT_BR_RW_848)  ? RFAL_BR_848 : ((RFAL_SUPPORT_BR_RW_424)  ? RFAL_BR_424 : ((RFAL_SUPPORT_BR_RW_212)  ? RFAL_BR_212 : RFAL_BR_106 ) ) ) ) ) ) )
 
@@ -553,6 +560,16 @@ typedef enum
 
 /*******************************************************************************/
 
+/*
+******************************************************************************
+* GLOBAL VARIABLES
+******************************************************************************
+*/
+#if RFAL_FEATURE_INSTANCES > 1U
+extern uint8_t gRfalInstance;           /*!< Selected RFAL instance when the platform keeps none per thread, use rfalInstance() */
+#endif /* RFAL_FEATURE_INSTANCES */
+
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -560,6 +577,33 @@ typedef enum
 */
 
 
+/*! 
+ *****************************************************************************
+ * \brief  RFAL Select Instance
+ *  
+ * Selects the RFAL instance (one per ST25R391x) all subsequent RFAL 
+ * calls of the calling thread, from every layer, operate on.
+ * 
+ * With RFAL_FEATURE_INSTANCES greater than 1, each ST25R391x has its own 
+ * state on every RFAL layer and its own CS and IRQ lines on the platform. 
+ * A thread driving a reader selects its instance once, before its first 
+ * RFAL call. The platform keeps the selection per thread 
+ * (platformSetInstance()/platformGetInstance()), so several readers run 
+ * their discovery loops on concurrent threads; only each SPI transaction 
+ * is serialized, by platformProtectST25RComm().
+ * 
+ * With a single instance, this call is not needed: instance 0 is always 
+ * selected and the RFAL API behaves as before.
+ *
+ * \param[in]  inst : RFAL instance to select [0, RFAL_FEATURE_INSTANCES[
+ *
+ * \return RFAL_ERR_PARAM        : Invalid instance
+ * \return RFAL_ERR_NONE         : No error, instance selected
+ *****************************************************************************
+ */
+ReturnCode rfalSelectInstance( uint8_t inst );
+
+
 /*! 
  *****************************************************************************
  * \brief  RFAL Initialize
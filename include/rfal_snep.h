@@ -0,0 +1,212 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_snep.h
+ *
+ *  \brief Provides a SNEP (Simple NDEF Exchange Protocol) client and server
+ *
+ *  SNEP exchanges NDEF messages between peer devices over an LLCP
+ *  connection-oriented data link. Messages larger than the data link MIU
+ *  are fragmented: the first fragment is sent, and once the receiver
+ *  answers CONTINUE the remaining fragments are sent back to back within
+ *  the LLCP receive window.
+ *
+ *  The server is registered on the SNEP well-known SAP and service name,
+ *  it reassembles PUT requests on the buffer given by the caller.
+ *  The client calls are blocking, they drive rfalLlcpWorker() until the
+ *  response is received.
+ *
+ *  This implementation was based on the following specs:
+ *    - NFC Forum Simple NDEF Exchange Protocol 1.0  2011-08-31
+ *
+ * \addtogroup RFAL
+ * @{
+ *
+ * \addtogroup RFAL-AL
+ * \brief RFAL Abstraction Layer
+ * @{
+ *
+ * \addtogroup SNEP
+ * \brief RFAL SNEP Module
+ * @{
+ *
+ */
+
+
+#ifndef RFAL_SNEP_H
+#define RFAL_SNEP_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_platform/rfal_platform.h"
+#include "rfal_utils.h"
+#include "rfal_llcp.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_SNEP_HDR_LEN                       6U      /*!< Version | Request/Response | Length          SNEP 1.0  2.1 */
+#define RFAL_SNEP_RSP_TIMEOUT                2000U      /*!< Client: max time waiting for the connection and the response [ms] */
+
+#define RFAL_SNEP_RSP_CONTINUE                0x80U     /*!< Continue                                                  */
+#define RFAL_SNEP_RSP_SUCCESS                 0x81U     /*!< Success                                                   */
+#define RFAL_SNEP_RSP_NOT_FOUND               0xC0U     /*!< Not Found                                                 */
+#define RFAL_SNEP_RSP_EXCESS_DATA             0xC1U     /*!< Excess Data                                               */
+#define RFAL_SNEP_RSP_BAD_REQUEST             0xC2U     /*!< Bad Request                                               */
+#define RFAL_SNEP_RSP_NOT_IMPLEMENTED         0xE0U     /*!< Not Implemented                                           */
+#define RFAL_SNEP_RSP_UNSUPPORTED_VER         0xE1U     /*!< Unsupported Version                                       */
+#define RFAL_SNEP_RSP_REJECT                  0xFFU     /*!< Reject                                                    */
+
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Server: NDEF message received on a PUT request (complete, on the server buffer) */
+typedef void (* rfalSnepPutCallback)( const uint8_t *ndef, uint32_t ndefLen );
+
+/*! Server: GET request received, returns the response code and the NDEF message to send (must remain valid until sent) */
+typedef uint8_t (* rfalSnepGetCallback)( const uint8_t *ndefReq, uint32_t ndefReqLen, const uint8_t **ndefRsp, uint32_t *ndefRspLen );
+
+
+/*! SNEP statistics */
+typedef struct
+{
+    uint32_t                 putCnt;                    /*!< Server: PUT requests completed               */
+    uint32_t                 getCnt;                    /*!< Server: GET requests answered                */
+    uint32_t                 rejectCnt;                 /*!< Server: requests rejected (too large)        */
+    uint32_t                 fragRxCnt;                 /*!< Fragments received                           */
+    uint32_t                 fragTxCnt;                 /*!< Messages sent in more than one fragment      */
+} rfalSnepStats;
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+/*!
+ *****************************************************************************
+ * \brief  SNEP Server Start
+ *
+ * Registers the SNEP default server on the LLCP SNEP SAP/service name.
+ * Shall be called before rfalLlcpGetGeneralBytes() so that the SNEP SAP
+ * is announced on the Well-Known Service list
+ *
+ * \param[in] buf    : buffer where PUT requests are reassembled
+ * \param[in] bufLen : buffer length, larger requests are rejected
+ * \param[in] putCb  : NDEF message received callback
+ * \param[in] getCb  : GET request callback (NULL: GET not implemented)
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_NOMEM        : No more LLCP services can be registered
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalSnepServerStart( uint8_t *buf, uint32_t bufLen, rfalSnepPutCallback putCb, rfalSnepGetCallback getCb );
+
+
+/*!
+ *****************************************************************************
+ * \brief  SNEP Client PUT
+ *
+ * Connects to the remote SNEP server (if not connected yet) and sends the
+ * NDEF message on a PUT request. Blocks driving rfalLlcpWorker() until the
+ * server responds. No copy of the NDEF message is done.
+ *
+ * \param[in] ndef    : NDEF message
+ * \param[in] ndefLen : NDEF message length
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_WRONG_STATE  : LLCP link not active
+ * \return RFAL_ERR_NOTFOUND     : No SNEP server on the remote device
+ * \return RFAL_ERR_TIMEOUT      : No connection or response from the server
+ * \return RFAL_ERR_LINK_LOSS    : Data link or LLCP link lost
+ * \return RFAL_ERR_REQUEST      : Server refused the request (see rfalSnepClientGetLastRsp())
+ * \return RFAL_ERR_NONE         : NDEF message accepted by the server
+ *****************************************************************************
+ */
+ReturnCode rfalSnepClientPut( const uint8_t *ndef, uint32_t ndefLen );
+
+
+/*!
+ *****************************************************************************
+ * \brief  SNEP Client GET
+ *
+ * Connects to the remote SNEP server (if not connected yet) and requests
+ * an NDEF message. Blocks driving rfalLlcpWorker() until the response is
+ * completely received.
+ *
+ * \param[in]  ndefReq    : NDEF request message
+ * \param[in]  ndefReqLen : NDEF request message length
+ * \param[out] rxBuf      : buffer to place the NDEF message received
+ * \param[in]  rxBufLen   : buffer length (announced as Acceptable Length)
+ * \param[out] rcvdLen    : NDEF message length
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_WRONG_STATE  : LLCP link not active
+ * \return RFAL_ERR_NOTFOUND     : No SNEP server on the remote device
+ * \return RFAL_ERR_TIMEOUT      : No connection or response from the server
+ * \return RFAL_ERR_LINK_LOSS    : Data link or LLCP link lost
+ * \return RFAL_ERR_REQUEST      : Server refused the request (see rfalSnepClientGetLastRsp())
+ * \return RFAL_ERR_NONE         : NDEF message received
+ *****************************************************************************
+ */
+ReturnCode rfalSnepClientGet( const uint8_t *ndefReq, uint32_t ndefReqLen, uint8_t *rxBuf, uint32_t rxBufLen, uint32_t *rcvdLen );
+
+
+/*!
+ *****************************************************************************
+ * \brief  SNEP Client Get Last Response
+ *
+ * \return Response code of the last client request
+ *****************************************************************************
+ */
+uint8_t rfalSnepClientGetLastRsp( void );
+
+
+/*!
+ *****************************************************************************
+ * \brief  SNEP Client Close
+ *
+ * Disconnects the client data link, if connected
+ *****************************************************************************
+ */
+void rfalSnepClientClose( void );
+
+
+/*!
+ *****************************************************************************
+ * \brief  SNEP Get statistics
+ *
+ * \param[out] stats : location to place the statistics
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalSnepGetStats( rfalSnepStats *stats );
+
+
+#endif /* RFAL_SNEP_H */
+
+/**
+  * @}
+  *
+  * @}
+  *
+  * @}
+  */
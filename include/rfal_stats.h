@@ -0,0 +1,274 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_stats.h
+ *
+ *  \brief RF timing and throughput instrumentation
+ *
+ *  This module keeps, in a fixed size block per RFAL instance, where the
+ *  time of a tap goes across the RFAL layers:
+ *    - time spent in each state of the rfalNfcWorker() state machine
+ *    - per transceive: bytes, duration, FIFO water level refills/reads
+ *      and errors by type
+ *    - SPI transactions and bytes exchanged with the ST25R3911
+ *    - latency histograms of the NDEF operations
+ *
+ *  The hooks are placed by the layers themselves under RFAL_FEATURE_STATS:
+ *  compiled out they cost nothing. Enabled, each hook is a few counter
+ *  updates and at most one microsecond time stamp.
+ *
+ *  The block is read with rfalStatsGet() and may be dumped by the
+ *  application (e.g. as JSON), the module itself does no formatting.
+ *  Clearing it after each dump with rfalStatsClear() reports intervals.
+ *
+ *
+ * \addtogroup RFAL
+ * @{
+ *
+ * \addtogroup RFAL-HAL
+ * \brief RFAL Hardware Abstraction Layer
+ * @{
+ *
+ * \addtogroup STATS
+ * \brief RFAL Timing and Throughput Instrumentation
+ * @{
+ *
+ */
+
+
+#ifndef RFAL_STATS_H
+#define RFAL_STATS_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_platform/rfal_platform.h"
+#include "rfal_utils.h"
+#include "rfal_defConfig.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_STATS_NFC_STATES        35U   /*!< rfalNfcState values accounted, up to RFAL_NFC_STATE_DEACTIVATION */
+#define RFAL_STATS_HIST_BUCKETS      11U   /*!< Latency histogram buckets: 0, 1, 2-3, 4-7 .. 256-511, 512+ ms  */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Transceive outcome, as accounted */
+typedef enum {
+    RFAL_STATS_ERR_TIMEOUT,                 /*!< No response within FWT                      */
+    RFAL_STATS_ERR_CRC,                     /*!< CRC error                                   */
+    RFAL_STATS_ERR_PAR,                     /*!< Parity error                                */
+    RFAL_STATS_ERR_FRAMING,                 /*!< Framing error, incomplete byte              */
+    RFAL_STATS_ERR_COLLISION,               /*!< Collision on the response                   */
+    RFAL_STATS_ERR_NOMEM,                   /*!< Response larger than the Rx buffer          */
+    RFAL_STATS_ERR_LINK_LOSS,               /*!< External field lost (Listen / AP2P)         */
+    RFAL_STATS_ERR_OTHER,                   /*!< Any other error                             */
+    RFAL_STATS_ERR_NUM                      /*!< Number of error types                       */
+}rfalStatsErr;
+
+/*! Operations with a latency histogram */
+typedef enum {
+    RFAL_STATS_OP_NDEF_DETECT,              /*!< ndefPollerNdefDetect()                      */
+    RFAL_STATS_OP_NDEF_READ,                /*!< ndefPollerReadRawMessage()                  */
+    RFAL_STATS_OP_NDEF_WRITE,               /*!< ndefPollerWriteRawMessage()                 */
+    RFAL_STATS_OP_NUM                       /*!< Number of operations                        */
+}rfalStatsOp;
+
+/*! Time spent in a state of the rfalNfcWorker() state machine */
+typedef struct {
+    uint32_t          enterCnt;             /*!< Times the state was entered                 */
+    uint32_t          time;                 /*!< Total time in the state [us]                */
+    uint32_t          maxTime;              /*!< Longest stay in the state [us]              */
+}rfalStatsNfcState;
+
+/*! Transceive counters */
+typedef struct {
+    uint32_t          cnt;                  /*!< Transceives completed                       */
+    uint32_t          txBytes;              /*!< Bytes transmitted                           */
+    uint32_t          rxBytes;              /*!< Bytes received                              */
+    uint32_t          time;                 /*!< Total duration, start to Rx/Tx end [us]     */
+    uint32_t          maxTime;              /*!< Longest transceive [us]                     */
+    uint32_t          txFifoRefills;        /*!< Tx FIFO reloads on water level              */
+    uint32_t          rxFifoReads;          /*!< Rx FIFO reads on water level                */
+    uint32_t          errCnt[RFAL_STATS_ERR_NUM]; /*!< Transceives failed, per error type    */
+}rfalStatsTxRx;
+
+/*! SPI counters */
+typedef struct {
+    uint32_t          xferCnt;              /*!< SPI transactions (chip selects)             */
+    uint32_t          bytes;                /*!< Bytes clocked, command bytes included       */
+}rfalStatsCom;
+
+/*! Latency histogram of an operation */
+typedef struct {
+    uint32_t          cnt;                  /*!< Operations done                             */
+    uint32_t          errCnt;               /*!< Operations failed                           */
+    uint32_t          time;                 /*!< Total latency [us]                          */
+    uint32_t          maxTime;              /*!< Longest operation [us]                      */
+    uint32_t          bucket[RFAL_STATS_HIST_BUCKETS]; /*!< Operations per latency bucket    */
+}rfalStatsHist;
+
+/*! Instrumentation block */
+typedef struct {
+    uint32_t          since;                /*!< Time stamp of the last clear [us]           */
+    rfalStatsNfcState nfc[RFAL_STATS_NFC_STATES]; /*!< Per rfalNfcState                      */
+    rfalStatsTxRx     txRx;                 /*!< Transceives                                 */
+    rfalStatsCom      com;                  /*!< ST25R3911 communication                     */
+    rfalStatsHist     op[RFAL_STATS_OP_NUM]; /*!< Per operation latency                      */
+}rfalStats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Initialize
+ *
+ * Clears the instrumentation block of the selected RFAL instance and stops
+ * timing any state or transceive. Called by rfalInitialize()
+ *****************************************************************************
+ */
+void rfalStatsInitialize( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Clear
+ *
+ * Clears the counters of the selected RFAL instance and starts a new period.
+ * A state or transceive being timed is kept, and accounted to the new period
+ *
+ * The times are 32 bit microseconds, as the time stamps: totals and the
+ * elapsed time since the clear wrap after about 71 min. Clear at least that
+ * often, e.g. after each report of the counters
+ *****************************************************************************
+ */
+void rfalStatsClear( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Get
+ *
+ * Copies the instrumentation block of the selected RFAL instance
+ *
+ * \param[out] stats : location to place the instrumentation block
+ *
+ * \return RFAL_ERR_NONE     : No error
+ * \return RFAL_ERR_PARAM    : Invalid parameter
+ *****************************************************************************
+ */
+ReturnCode rfalStatsGet( rfalStats *stats );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation NFC state hook
+ *
+ * Called by rfalNfcWorker() before and after each step with the current
+ * state: time is accounted to the previous state when it changed. States
+ * are timed at the worker call granularity, a state entered and left
+ * within one step is not seen
+ *
+ * \param[in]  state : current rfalNfcState
+ *****************************************************************************
+ */
+void rfalStatsNfcStateUpdate( uint8_t state );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Transceive start hook
+ *
+ * \param[in]  txBytes : bytes to be transmitted
+ *****************************************************************************
+ */
+void rfalStatsTxRxStart( uint16_t txBytes );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Transceive end hook
+ *
+ * Accounts the transceive started last, if any
+ *
+ * \param[in]  status  : transceive outcome
+ * \param[in]  rxBytes : bytes received
+ *****************************************************************************
+ */
+void rfalStatsTxRxEnd( ReturnCode status, uint16_t rxBytes );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Tx FIFO reload hook
+ *****************************************************************************
+ */
+void rfalStatsTxFifoRefill( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Rx FIFO water level read hook
+ *****************************************************************************
+ */
+void rfalStatsRxFifoRead( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation SPI transaction hook
+ *****************************************************************************
+ */
+void rfalStatsComXfer( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation SPI bytes hook
+ *
+ * \param[in]  len : bytes clocked
+ *****************************************************************************
+ */
+void rfalStatsComBytes( uint16_t len );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Operation start
+ *
+ * \return time stamp to be passed to rfalStatsOpEnd()
+ *****************************************************************************
+ */
+uint32_t rfalStatsOpStart( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Instrumentation Operation end
+ *
+ * Accounts the operation latency on its histogram
+ *
+ * \param[in]  op    : operation
+ * \param[in]  start : time stamp returned by rfalStatsOpStart()
+ * \param[in]  ok    : false if the operation failed
+ *****************************************************************************
+ */
+void rfalStatsOpEnd( rfalStatsOp op, uint32_t start, bool ok );
+
+#endif /* RFAL_STATS_H */
+
+/**
+  * @}
+  *
+  * @}
+  *
+  * @}
+  */
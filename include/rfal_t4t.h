@@ -349,6 +349,51 @@ ReturnCode rfalT4TPollerComposeWriteData( rfalIsoDepApduBufFormat *cApduBuf, uin
  */
 ReturnCode rfalT4TPollerComposeWriteDataODO( rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, const uint8_t* data, uint8_t dataLen, uint16_t *cApduLen );
 
+/*! 
+ *****************************************************************************
+ * \brief  T4T Compose Write Data APDU header
+ *  
+ * This method computes only the header of a Write Data APDU (up to and 
+ * including Lc). The data is to be appended as a separate segment on 
+ * the scatter/gather transceive, avoiding copying it into cApduBuf
+ *
+ * \see rfalIsoDepStartSgApduTransceive()
+ * \see rfalIsoDepGetSgApduTransceiveStatus()
+ * 
+ * \param[out]     cApduBuf : buffer where the C-APDU header will be placed
+ * \param[in]      offset   : File offset
+ * \param[in]      dataLen  : Data length to be written (Lc)
+ * \param[out]     cApduLen : Composed C-APDU header length
+ * 
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT4TPollerComposeWriteDataHdr( rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, uint8_t dataLen, uint16_t *cApduLen );
+
+/*! 
+ *****************************************************************************
+ * \brief  T4T Compose Write Data ODO APDU header
+ *  
+ * This method computes only the header of a Write Data ODO APDU (up to and
+ * including the data BER-TLV length). The data is to be appended as a 
+ * separate segment on the scatter/gather transceive
+ *
+ * \see rfalIsoDepStartSgApduTransceive()
+ * \see rfalIsoDepGetSgApduTransceiveStatus()
+ * 
+ * \param[out]     cApduBuf : buffer where the C-APDU header will be placed
+ * \param[in]      offset   : File offset
+ * \param[in]      dataLen  : Data length to be written
+ * \param[out]     cApduLen : Composed C-APDU header length
+ * 
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_NOMEM        : Data does not fit on a short Lc
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT4TPollerComposeWriteDataODOHdr( rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, uint8_t dataLen, uint16_t *cApduLen );
+
 #endif /* RFAL_T4T_H */
 
 /**
@@ -0,0 +1,182 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_trace.h
+ *
+ *  \brief RF frame capture
+ *
+ *  This module records every frame crossing rfalStartTransceive() (and so
+ *  rfalTransceiveBlockingTxRx()) into a compact append-only binary trace,
+ *  on a buffer provided by the application. A trace holds, in order:
+ *    - a header: magic "RFTR", version, 3 reserved bytes
+ *    - a TX entry per transceive started: time stamp, mode, bit rates,
+ *      flags, FWT and the frame transmitted
+ *    - an RX entry per transceive completed: time stamp, status and the
+ *      frame received
+ *    - a DEVICE entry per device activated by rfalNfcWorker(): type,
+ *      NFCID and the ISO-DEP parameters the NDEF layer takes from it
+ *
+ *  All fields are little endian, frame lengths are in bits. The RX frame is
+ *  stored up to the Rx buffer of the caller (len bytes), lenBits being the
+ *  received length as reported to the caller:
+ *
+ *    TX     : 0x01 | time(4) | mode(1) | txBR(1) | rxBR(1) | flags(4) | fwt(4) | lenBits(2) | frame
+ *    RX     : 0x02 | time(4) | status(2) | lenBits(2) | len(2) | frame
+ *    DEVICE : 0x03 | time(4) | type(1) | subType(1) | nfcidLen(1) | nfcid | DID(1) | FSx(2) | FWT(4) | dFWT(4)
+ *
+ *  An entry either fits entirely or is dropped, together with all the ones
+ *  after it: the trace is always a consistent prefix of the session, which
+ *  tools/rf_replay feeds back to the NDEF stack on a host. Started per
+ *  device, the trace is rewound on each activation so that polling with no
+ *  device in the field does not use up the buffer before the tap.
+ *
+ *
+ * \addtogroup RFAL
+ * @{
+ *
+ * \addtogroup RFAL-HAL
+ * \brief RFAL Hardware Abstraction Layer
+ * @{
+ *
+ * \addtogroup TRACE
+ * \brief RFAL RF Frame Capture
+ * @{
+ *
+ */
+
+
+#ifndef RFAL_TRACE_H
+#define RFAL_TRACE_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_platform/rfal_platform.h"
+#include "rfal_utils.h"
+#include "rfal_defConfig.h"
+#include "rfal_rf.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_TRACE_VERSION           1U    /*!< Trace format version                          */
+#define RFAL_TRACE_HDR_LEN           8U    /*!< Trace header length                           */
+#define RFAL_TRACE_NFCID_MAX_LEN    10U    /*!< Longest NFCID on a DEVICE entry (NFCID1 10)    */
+
+#define RFAL_TRACE_ENTRY_TX       0x01U    /*!< Transceive started                            */
+#define RFAL_TRACE_ENTRY_RX       0x02U    /*!< Transceive completed                          */
+#define RFAL_TRACE_ENTRY_DEVICE   0x03U    /*!< Device activated                              */
+
+#define RFAL_TRACE_TX_HDR_LEN       18U    /*!< TX entry length, frame excluded               */
+#define RFAL_TRACE_RX_HDR_LEN       11U    /*!< RX entry length, frame excluded               */
+#define RFAL_TRACE_DEVICE_HDR_LEN   19U    /*!< DEVICE entry length, NFCID excluded           */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Activated device, as recorded on a DEVICE entry */
+typedef struct {
+    uint8_t           type;                 /*!< rfalNfcDevType                                       */
+    uint8_t           subType;              /*!< NFC-A: rfalNfcaListenDeviceType, otherwise 0         */
+    uint8_t           nfcidLen;             /*!< NFCID length                                         */
+    uint8_t           nfcid[RFAL_TRACE_NFCID_MAX_LEN]; /*!< NFCID1/NFCID0/NFCID2/UID               */
+    uint8_t           DID;                  /*!< ISO-DEP Device ID                                    */
+    uint16_t          FSx;                  /*!< ISO-DEP Frame Size Card                              */
+    uint32_t          FWT;                  /*!< ISO-DEP Frame Waiting Time (1/fc)                    */
+    uint32_t          dFWT;                 /*!< ISO-DEP Delta Frame Waiting Time (1/fc)              */
+}rfalTraceDevice;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+
+/*!
+ *****************************************************************************
+ * \brief  Trace Start
+ *
+ * Starts recording on the selected RFAL instance. The header is written at
+ * the start of the given buffer, any previous trace is discarded.
+ *
+ * \param[in]  buf       : buffer to record on, kept until rfalTraceStop()
+ * \param[in]  bufLen    : buffer length
+ * \param[in]  perDevice : true to restart the trace on each device activated,
+ *                         keeping the DEVICE entry and the frames after it
+ *
+ * \return RFAL_ERR_NONE     : No error
+ * \return RFAL_ERR_PARAM    : Invalid parameter
+ *****************************************************************************
+ */
+ReturnCode rfalTraceStart( uint8_t *buf, uint32_t bufLen, bool perDevice );
+
+/*!
+ *****************************************************************************
+ * \brief  Trace Stop
+ *
+ * Stops recording on the selected RFAL instance
+ *
+ * \param[out] dropped : entries that did not fit the buffer, may be NULL
+ *
+ * \return trace length, header included. 0 if not recording
+ *****************************************************************************
+ */
+uint32_t rfalTraceStop( uint32_t *dropped );
+
+/*!
+ *****************************************************************************
+ * \brief  Trace TX hook
+ *
+ * Called by rfalStartTransceive() once the transceive is accepted. Mode
+ * and bit rates are taken from the RFAL.
+ *
+ * \param[in]  ctx : transceive context as given by the caller
+ *****************************************************************************
+ */
+void rfalTraceTx( const rfalTransceiveContext *ctx );
+
+/*!
+ *****************************************************************************
+ * \brief  Trace RX hook
+ *
+ * Called when the transceive started last completes, ignored if it was not
+ * recorded. The frame is taken from the Rx buffer and received length of
+ * the context, as returned to the caller.
+ *
+ * \param[in]  status : transceive outcome
+ * \param[in]  ctx    : transceive context as given by the caller
+ *****************************************************************************
+ */
+void rfalTraceRx( ReturnCode status, const rfalTransceiveContext *ctx );
+
+/*!
+ *****************************************************************************
+ * \brief  Trace DEVICE hook
+ *
+ * \param[in]  dev : device activated
+ *****************************************************************************
+ */
+void rfalTraceDev( const rfalTraceDevice *dev );
+
+#endif /* RFAL_TRACE_H */
+
+/**
+  * @}
+  *
+  * @}
+  *
+  * @}
+  */
@@ -35,5 +35,15 @@
     #define MCU_LED5    (uint8_t)9
   #endif
 
+/**
+ * @brief CS and IRQ pins of each ST25R3911 on the SPI bus, in RFAL instance order (see RFAL_FEATURE_INSTANCES).
+ */
+#ifndef READER_SS_PINS
+  #define READER_SS_PINS    { SPI_SS }
+#endif
+#ifndef READER_IRQ_PINS
+  #define READER_IRQ_PINS   { IRQ_PIN }
+#endif
+
 
 #endif
@@ -18,13 +18,24 @@ extern "C" {
 #include "utils.h"
 #include "rfal_utils.h"
 #include "rfal_nfc.h"             // Includes all of "rfal_nfc[a|b|f|v].h", "rfal_isoDep.h" and "rfal_nfcDep.h".
+#include "rfal_llcp.h"
+#include "rfal_snep.h"
+#include "rfal_dpo.h"
+#include "rfal_stats.h"
+#include "rfal_trace.h"
 #include "ndef_poller.h"
 #include "ndef_message.h"
 #include "ndef_types.h"
+#include "ndef_t3t_ce.h"
+#include "ndef_t4t_ce.h"
 
 //#include "ndef_dump.h"
 }
 
+#include "tag_session.h"
+#include "ndef_queue.h"
+#include "rf_log.h"
+
 
 // REFERENCE: https://www.st.com/resource/en/user_manual/um2890-rfnfc-abstraction-layer-rfal-stmicroelectronics.pdf
 // ISO 15693
@@ -74,6 +85,33 @@ extern "C" {
 
 #define NDEF_MESSAGE_BUF_LEN     8192
 
+#define DEMO_T4T_CE              false /* Be a T4T that phones can tap (needs a front end with passive Listen NFC-A, not the ST25R3911) */
+#define DEMO_T4T_CE_FILE_LEN     1024U /* Emulated T4T NDEF file size */
+
+#define DEMO_T3T_CE              false /* Be a T3T that phones can tap (needs a front end with passive Listen NFC-F, not the ST25R3911) */
+#define DEMO_T3T_CE_BLOCKS       64U   /* Emulated T3T blocks, AIB included */
+
+#define DEMO_P2P_TIMEOUT         5000  /* Max time [ms] a P2P device is served, waiting for an NDEF message pushed over SNEP */
+
+#define DEMO_WAKEUP              true  /* Sleep in low power Wake-Up between taps, confirmed by Card Detection before polling */
+
+#define DEMO_DPO                 true  /* Adjust the field strength in closed loop on the link errors, learning the DPO table */
+
+#define DEMO_NFCF_POLL_TIME      43500 /* Time [us] of the FeliCa SENSF_REQs of a collision resolution: 16 slots for the poll and for the RC=SC one */
+
+#define DEMO_PRESENCE_INTERVAL   30    /* Time [ms] between two presence checks of a tag left in the field */
+#define DEMO_DEPARTURE_DEBOUNCE  100   /* Time [ms] a tag must stay unseen to be reported gone */
+
+#define NFC_RF_CORE              0     /* Core running discovery and the raw NDEF reads */
+#define NFC_READER_REPEAT        1000  /* Time [ms] a tag must stay unseen by an additional reader to be read again */
+#define NFC_DECODE_CORE          1     /* Core running NDEF decoding and output, along with loop() */
+#define SERIAL_TX_BUF_LEN        4096  /* UART Tx buffer: the RF log and NDEF output do not wait on the UART */
+#define RF_LOG_BINARY            false /* Drain the RF log as binary frames, to be decoded on the host by tools/rf_log_decode */
+#define RF_LOG_DRAIN_PERIOD      20    /* Time [ms] between two drains of the RF log */
+#define DEMO_RF_TRACE            false /* Capture the frames of each tap and print them as "T:" hex lines, replayed on the host by tools/rf_replay */
+#define DEMO_RF_TRACE_BUF_LEN    4096  /* RF trace buffer: frames beyond it are dropped, the trace stays replayable up to there */
+#define DEMO_RF_TRACE_LINE_LEN   32    /* Trace bytes per "T:" line */
+
 
 /*
  ******************************************************************************
@@ -86,10 +124,8 @@ static uint8_t                 t3tCheckReq[]   = { 0x06, 0x11, 0x22, 0x33, 0x44,
 static uint8_t                 t4tSelectReq[]  = { 0x00, 0xA4, 0x00, 0x00, 0x00 };                                                               /* T4T Select MF, DF or EF APDU  */
 static uint8_t                 t5tSysInfoReq[] = { 0x02, 0x2B };                                                                                 /* NFC-V Get SYstem Information command*/
 static uint8_t                 nfcbReq[]       = { 0x00 };                                                                                       /* NFC-B proprietary command */
-static uint8_t                 llcpSymm[]      = { 0x00, 0x00 };                                                                                 /* LLCP SYMM command */
 
 static uint8_t                 gNfcid3[]       = {0x01, 0xFE, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A };                                  /* NFCID3 used for ATR_REQ */
-static uint8_t                 gGenBytes[]     = { 0x46, 0x66, 0x6d, 0x01, 0x01, 0x11, 0x02, 0x02, 0x07, 0x80, 0x03, 0x02, 0x00, 0x03, 0x04, 0x01, 0x32, 0x07, 0x01, 0x03 }; /* P2P General Bytes: LCCP Connect */
 
 /*! Main state                                                                          */
 typedef enum{
@@ -147,7 +183,7 @@ static rfalNfcDiscoverParam discParam = {
 		.techs2Bail = RFAL_NFC_TECH_NONE, 
 		.totalDuration = 1000U, 
 		.devLimit = 1U,                         // NOTE: only communicates w. ONE, single tag at the time!!
-         // maxBR --> Max bitrate NOT set ...
+        .maxBR = RFAL_BR_848,                   // ISO-DEP: highest common bit rate, lowered/raised by the adaptive bit rate.
 		.nfcfBR = RFAL_BR_212, 
         .nfcid3 = {0}, 
 		.GB = {0}, 
@@ -155,20 +191,64 @@ static rfalNfcDiscoverParam discParam = {
 		.ap2pBR = RFAL_BR_424, 
         // p2pNfcaPrio NOT set ...
         // propNfc NOT set ...        
-        // isoDepFS NOT set ...  
-        // nfcDepLR NOT set ...       
+        .isoDepFS = RFAL_ISODEP_FSXI_AUTO,      // ISO-DEP: largest FSD the I-Block buffers hold (256 bytes).
+        .nfcDepLR = RFAL_NFCDEP_LR_AUTO,        // NFC-DEP: largest LR the block buffers hold (LR 254).
         // lmConfigPA NOT set ...
         // lmConfigPF NOT set ...
 		.notifyCb = NULL, 
-		.wakeupEnabled = false, 
-		.wakeupConfigDefault = true,		
+		.wakeupEnabled = DEMO_WAKEUP,           // Field off between taps: the ST25R3911 measures the antenna every period instead.
+		.wakeupConfigDefault = false,		
+        .wakeupConfig = {
+            .period = RFAL_WUM_PERIOD_200MS,    // Worst case tap-to-poll latency, vs. ~5x lower duty than polling.
+            .irqTout = false,
+            .indAmp = { .enabled = true, .delta = 2U, .reference = RFAL_WUM_REFERENCE_AUTO, .autoAvg = true, .aaInclMeas = true, .aaWeight = RFAL_WUM_AA_WEIGHT_16 },
+            .indPha = { .enabled = true, .delta = 2U, .reference = RFAL_WUM_REFERENCE_AUTO, .autoAvg = true, .aaInclMeas = true, .aaWeight = RFAL_WUM_AA_WEIGHT_16 },
+            .cap    = { .enabled = false, .delta = 0U, .reference = 0U, .autoAvg = false, .aaInclMeas = false, .aaWeight = RFAL_WUM_AA_WEIGHT_4 },
+        },                                      // Auto reference, averaged by HW: slow drift (temperature, nearby metal) does not wake.
+        .wakeupNPolls = 1U,                     // Nothing after one poll cycle --> back to sleep.
+        .wakeupCdConfirm = true,                // Wake-Up on e.g. a hand --> a short Card Detection sends it back to sleep, no full poll.
+        .pollSched = {
+            .policy = RFAL_NFC_POLL_SCHED_WEIGHTED,    // Our sites only see NFC-A/V tags --> poll those first, probe B/F now and then.
+            .probePeriod = 8U,
+            .minScore = 16U,
+        },
+        .hotReacquire = true,                       // Same tag is usually re-presented --> try it first, skipping anticollision.
 };
 
 static uint8_t rawMessageBuf[NDEF_MESSAGE_BUF_LEN];
 
+static ndefQueue ndefRxQueue;           // Raw NDEF messages read by the RF task, decoded by the decode task.
+static TaskHandle_t decodeTask;
+
 static rfalNfcDevice *nfcDevice;        // NFC-device handle --> allocated and returned by API.
 static ndefContext ndefCtx;             // NDEF-context handle --> allocated here, to be populated by API.
 
+#if RFAL_FEATURE_INSTANCES > 1U
+// Readers 1..N-1: each polled by its own task, concurrently with reader 0 which runs the full demo.
+typedef struct {
+    uint8_t      inst;                      // RFAL instance of the reader
+    ndefContext  ndefCtx;                   // NDEF context of the tag on this reader
+    ndefQueue    rxQueue;                   // Raw NDEF messages of this reader: a single producer per queue
+    uint8_t      uid[NDEF_QUEUE_UID_LEN];   // Last tag read, not read again while it stays in the field
+    uint8_t      uidLen;
+    uint32_t     lastSeen;                  // Time [ms] the last tag read was last activated
+} nfcReader;
+
+static nfcReader nfcReaders[RFAL_FEATURE_INSTANCES - 1U];
+static rfalNfcDiscoverParam readerDiscParam;   // Poll techs of discParam only: no P2P or card emulation on readers 1..N-1
+#endif
+
+#if DEMO_T4T_CE
+static ndefT4tCeContext t4tCe;                       // Emulated T4T, answering from the NDEF file image below.
+static uint8_t t4tCeFile[DEMO_T4T_CE_FILE_LEN];      // Emulated T4T NDEF file: NLEN + NDEF message.
+#endif
+#if DEMO_T3T_CE
+static ndefT3tCeContext t3tCe;                       // Emulated T3T, answering from the block image below.
+static uint8_t t3tCeImage[DEMO_T3T_CE_BLOCKS * NDEF_T3T_CE_BLOCK_LEN];   // Emulated T3T blocks: AIB + NDEF message.
+static const uint8_t t3tCeNfcid2[NDEF_T3T_CE_NFCID2_LEN] = { DEMO_LM_NFCID2_BYTE1, 0xFE, 0x08, 0x5A, 0xC3, 0x17, 0x9E, 0x24 };   // NFCID2 on the SENSF_RES
+#endif
+static const uint8_t t4tCeMessage[] = { 0xD1, 0x01, 0x07, 'U', NDEF_URI_PREFIX_HTTPS_WWW, 's', 't', '.', 'c', 'o', 'm' };   // URI record "https://www.st.com"
+
 
 // static uint8_t                 gDevCnt;                                 /* Number of devices found                         */
 // static RfalPollerDevice         gDevList[RFAL_POLLER_DEVICES];                  /* Device List                                     */
@@ -181,12 +261,26 @@ static ndefContext ndefCtx;             // NDEF-context handle --> allocated her
 
 /************************************ LOCAL FUNCTION PROTOTYPES ************************************/
 
-static char *hex2str(uint8_t *number, uint8_t length);
-static String state_description(rfalNfcState rfalState);
+static const char *state_description(rfalNfcState rfalState);
 static void ndefParseMessage(uint8_t *rawMsgBuf, uint32_t rawMsgLen);
 static void ndefParseRecord(ndefRecord *record);
 static void ndefPrintString(const uint8_t *str, uint32_t strLen);
 static void check_discover_retval(const ndefStatus err);
+static void print_poll_sched_stats(void);
+static void print_wakeup_stats(void);
+static void print_dpo_stats(void);
+static void print_ndef_retry_stats(void);
+static void tag_session_event(const tagSessionEvent *evt);
+static void publish_ndef_message(ndefQueue *q, ndefQueueSlot *slot, const rfalNfcDevice *dev, uint32_t len, uint32_t start);
+static void print_isodep_link_stats(void);
+static void print_rf_stats_json(void);
+static uint32_t decode_queue(ndefQueue *q);
+static void start_rf_trace(void);
+static void dump_rf_trace(void);
+static void snep_put_received(const uint8_t *ndef, uint32_t ndefLen);
+static void demoP2P(void);
+static void demo_t4t_ce(void);
+static void demo_t3t_ce(void);
 
 
 /*
@@ -195,49 +289,13 @@ static void check_discover_retval(const ndefStatus err);
 ******************************************************************************
 */
 
-static char UID_hex_string[40] = {0};       // Safely hold up to NFCID3 values, i.e. 10-byte (requires 21-byte char-arr)
-
-static char *hex2str(uint8_t *number, uint8_t length)
-{
-	uint8_t aux_1 = 0;
-	uint8_t aux_2 = 0;
-
-	for (uint8_t i=0; i < length; i++)
-	{
-		aux_1 = number[i] / 16;
-		aux_2 = number[i] % 16;
-
-		if (aux_1 < 10)
-		{
-			UID_hex_string[2*i] = aux_1 + '0';
-		}
-		else
-        {
-			UID_hex_string[2*i] = aux_1 + ('A' - 10);
-		}
-
-		if (aux_2 < 10)
-        {
-			UID_hex_string[2*i+1] = aux_2 + '0';
-		}
-		else
-        {
-			UID_hex_string[2*i+1] = aux_2 + ('A' - 10);
-		}
-	} 
-
-	UID_hex_string[length*2] = '\0';
-
-    return((char *)UID_hex_string);
-}
-
 struct rfalStateToDescription
 {
     rfalNfcState state;
-    String desc;
+    const char *desc;
 };
 
-#define NUM_RFAL_NFC_STATES     16
+#define NUM_RFAL_NFC_STATES     18
 
 static const struct rfalStateToDescription stateToDesc[NUM_RFAL_NFC_STATES] = 
 {
@@ -257,6 +315,14 @@ static const struct rfalStateToDescription stateToDesc[NUM_RFAL_NFC_STATES] =
         .state = RFAL_NFC_STATE_WAKEUP_MODE,
         .desc = "WKUP_MODE",
     },
+    {
+        .state = RFAL_NFC_STATE_WAKEUP_CD,
+        .desc = "WKUP_CD",
+    },
+    {
+        .state = RFAL_NFC_STATE_POLL_REACQUIRE,
+        .desc = "POLL_REACQUIRE",
+    },
     {
         .state = RFAL_NFC_STATE_POLL_TECHDETECT,
         .desc = "POLL_TECH_DETECT",
@@ -307,23 +373,19 @@ static const struct rfalStateToDescription stateToDesc[NUM_RFAL_NFC_STATES] =
     },
 };
 
-static const String nonStateDesc = "<invalid state>";
+static const char nonStateDesc[] = "<invalid state>";
 
-static String state_description(rfalNfcState rfalState)
+static const char *state_description(rfalNfcState rfalState)
 {
-    String stateDesc = nonStateDesc;
-
     for (int i = 0; i < NUM_RFAL_NFC_STATES; i++)
     {
-        struct rfalStateToDescription *entry = (struct rfalStateToDescription *)&stateToDesc[i];
-
-        if (rfalState == entry->state)
+        if (rfalState == stateToDesc[i].state)
         {
-            stateDesc = entry->desc;
+            return(stateToDesc[i].desc);
         }
     }
 
-    return(stateDesc);
+    return(nonStateDesc);
 }
 
 
@@ -437,6 +499,489 @@ static void check_discover_retval(const ndefStatus err)
 }
 
 
+static void print_poll_sched_stats(void)
+{
+    rfalNfcPollSchedStats stats;
+
+    if ( (rfalNfcGetPollSchedStats(&stats) != RFAL_ERR_NONE) || (stats.detectCnt == 0) )
+    {
+        return;
+    }
+
+    rf_log(RF_LOG_EVT_POLL_SCHED, (stats.detectTimeSum / stats.detectCnt), stats.detectCnt, stats.cycles);
+}
+
+
+static void tag_session_event(const tagSessionEvent *evt)
+{
+    uint8_t uid[RFAL_NFCV_UID_LEN];
+    uint8_t uidLen = MIN(evt->dev->nfcidLen, (uint8_t)sizeof(uid));
+
+    ST_MEMCPY(uid, evt->dev->nfcid, uidLen);
+    if (evt->dev->type == RFAL_NFC_LISTEN_TYPE_NFCV)
+    {
+        REVERSE_BYTES(uid, uidLen);     /* Reverse the UID for display purposes */
+    }
+
+    if (evt->type == TAG_SESSION_EVT_ARRIVAL)
+    {
+        rf_log_bytes(RF_LOG_EVT_TAG_ARRIVAL, uid, uidLen);
+    }
+    else
+    {
+        rf_log_bytes(RF_LOG_EVT_TAG_DEPARTURE, uid, uidLen, evt->dwell, evt->checks);
+    }
+}
+
+
+static void print_wakeup_stats(void)
+{
+    rfalNfcWakeUpStats stats;
+
+    if (rfalNfcGetWakeUpStats(&stats) != RFAL_ERR_NONE)
+    {
+        return;
+    }
+
+    if ((stats.wakeCnt != 0) && (stats.elapsed != 0))
+    {
+        // Wake-to-NDEF only when this tag was woken for: lastWake may otherwise be any earlier Wake-Up
+        if (stats.lastActWoken)
+        {
+            rf_log(RF_LOG_EVT_WAKEUP_LATENCY, (platformGetSysTick() - stats.lastWake), ((stats.wakeActCnt != 0) ? (stats.wakeActTimeSum / stats.wakeActCnt) : 0));
+        }
+        rf_log(RF_LOG_EVT_WAKEUP_DUTY, (uint32_t)(100U - (((uint64_t)stats.wuTime * 100U) / stats.elapsed)), stats.wakeCnt, stats.cdFalseCnt);
+    }
+
+    // Statistics per report: the millisecond counters never run long enough to wrap
+    rfalNfcResetWakeUpStats();
+}
+
+
+static void print_ndef_retry_stats(void)
+{
+    ndefRetryStats stats;
+    uint32_t       errCnt = 0;
+
+    if (ndefPollerGetRetryStats(&ndefCtx, &stats) != ERR_NONE)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < NDEF_RETRY_CLASS_NUM; i++)
+    {
+        errCnt += stats.errCnt[i];
+    }
+    if (errCnt == 0)
+    {
+        return;     // Clean tag: nothing to report
+    }
+
+    for (uint8_t i = 0; i < NDEF_RETRY_CLASS_NUM; i++)
+    {
+        rf_log(RF_LOG_EVT_NDEF_RETRY_CLASS, i, stats.retryCnt[i], stats.errCnt[i]);
+    }
+    rf_log(RF_LOG_EVT_NDEF_RETRY, stats.recoveredCnt, stats.failedCnt, stats.actionCnt, stats.backoffTime);
+}
+
+
+static void print_dpo_stats(void)
+{
+    rfalDpoStats stats;
+    rfalDpoEntry table[RFAL_DPO_TABLE_ENTRIES_MAX];
+    uint8_t      tableEntries;
+
+    if ( (!rfalDpoIsEnabled()) || (rfalDpoGetStats(&stats) != RFAL_ERR_NONE) || (stats.frameCnt == 0) )
+    {
+        return;
+    }
+
+    rf_log(RF_LOG_EVT_DPO, rfalDpoGetCurrentTableIndex(), stats.lastMeas, stats.errCnt, stats.frameCnt, stats.stepUpCnt, stats.stepDownCnt);
+
+    if (rfalDpoTableRead(table, RFAL_DPO_TABLE_ENTRIES_MAX, &tableEntries) != RFAL_ERR_NONE)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < tableEntries; i++)
+    {
+        rf_log(RF_LOG_EVT_DPO_ENTRY, i, table[i].inc, table[i].dec);
+    }
+}
+
+
+static void print_isodep_link_stats(void)
+{
+    rfalIsoDepLinkStats stats;
+
+    if (rfalIsoDepPollGetLinkStats(&stats) != RFAL_ERR_NONE)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < RFAL_ISODEP_LINK_RATES; i++)
+    {
+        if ( (stats.rate[i].xchgCnt == 0) && (stats.rate[i].crcErrCnt == 0) && (stats.rate[i].toErrCnt == 0) )
+        {
+            continue;
+        }
+
+        rf_log(RF_LOG_EVT_ISODEP_RATE, i, stats.rate[i].xchgCnt, (stats.rate[i].txBytes + stats.rate[i].rxBytes),
+               stats.rate[i].xchgTime, stats.rate[i].crcErrCnt, stats.rate[i].toErrCnt);
+    }
+    rf_log(RF_LOG_EVT_ISODEP_LINK, stats.fsd, stats.fsc, stats.iBlockTxCnt, stats.iBlockRxCnt, stats.roundTripCnt);
+    rf_log(RF_LOG_EVT_ISODEP_BR, stats.maxBR, stats.stepDownCnt, stats.stepUpCnt);
+}
+
+
+// RFAL instrumentation of the last interval as one JSON line, then cleared: the 32 bit microsecond
+// totals would wrap after about 71 min. Read from the decode core while the RF task runs: counters
+// of an operation in progress may be partly updated, which is fine for a dump.
+static void print_rf_stats_json(void)
+{
+#if RFAL_FEATURE_STATS
+    static const char *errToDesc[RFAL_STATS_ERR_NUM] = { "timeout", "crc", "parity", "framing", "collision", "overflow", "link_loss", "other" };
+    static const char *opToDesc[RFAL_STATS_OP_NUM]   = { "detect", "read", "write" };
+    static rfalStats   stats;       // Too large for the loop() stack
+    bool               first = true;
+
+    if (rfalStatsGet(&stats) != RFAL_ERR_NONE)
+    {
+        return;
+    }
+
+    Serial0.print("{\"interval_us\":");
+    Serial0.print(platformGetSysTickUs() - stats.since);
+
+    Serial0.print(",\"nfc_states\":{");
+    for (uint8_t i = 0; i < RFAL_STATS_NFC_STATES; i++)
+    {
+        if (stats.nfc[i].enterCnt == 0)
+        {
+            continue;
+        }
+        Serial0.print(first ? "\"" : ",\"");
+        Serial0.print(state_description((rfalNfcState)i));
+        Serial0.print("\":{\"n\":");
+        Serial0.print(stats.nfc[i].enterCnt);
+        Serial0.print(",\"us\":");
+        Serial0.print(stats.nfc[i].time);
+        Serial0.print(",\"max_us\":");
+        Serial0.print(stats.nfc[i].maxTime);
+        Serial0.print("}");
+        first = false;
+    }
+
+    Serial0.print("},\"txrx\":{\"n\":");
+    Serial0.print(stats.txRx.cnt);
+    Serial0.print(",\"tx_bytes\":");
+    Serial0.print(stats.txRx.txBytes);
+    Serial0.print(",\"rx_bytes\":");
+    Serial0.print(stats.txRx.rxBytes);
+    Serial0.print(",\"us\":");
+    Serial0.print(stats.txRx.time);
+    Serial0.print(",\"max_us\":");
+    Serial0.print(stats.txRx.maxTime);
+    Serial0.print(",\"tx_fifo_refills\":");
+    Serial0.print(stats.txRx.txFifoRefills);
+    Serial0.print(",\"rx_fifo_reads\":");
+    Serial0.print(stats.txRx.rxFifoReads);
+    Serial0.print(",\"errors\":{");
+    for (uint8_t i = 0; i < RFAL_STATS_ERR_NUM; i++)
+    {
+        Serial0.print((i == 0) ? "\"" : ",\"");
+        Serial0.print(errToDesc[i]);
+        Serial0.print("\":");
+        Serial0.print(stats.txRx.errCnt[i]);
+    }
+
+    Serial0.print("}},\"spi\":{\"xfers\":");
+    Serial0.print(stats.com.xferCnt);
+    Serial0.print(",\"bytes\":");
+    Serial0.print(stats.com.bytes);
+
+    Serial0.print("},\"ndef\":{");
+    for (uint8_t i = 0; i < RFAL_STATS_OP_NUM; i++)
+    {
+        Serial0.print((i == 0) ? "\"" : ",\"");
+        Serial0.print(opToDesc[i]);
+        Serial0.print("\":{\"n\":");
+        Serial0.print(stats.op[i].cnt);
+        Serial0.print(",\"errors\":");
+        Serial0.print(stats.op[i].errCnt);
+        Serial0.print(",\"us\":");
+        Serial0.print(stats.op[i].time);
+        Serial0.print(",\"max_us\":");
+        Serial0.print(stats.op[i].maxTime);
+        Serial0.print(",\"hist_ms\":[");     // Buckets: <1, 1, 2-3, 4-7 .. 256-511, 512+ ms
+        for (uint8_t b = 0; b < RFAL_STATS_HIST_BUCKETS; b++)
+        {
+            Serial0.print((b == 0) ? "" : ",");
+            Serial0.print(stats.op[i].bucket[b]);
+        }
+        Serial0.print("]}");
+    }
+    Serial0.print("}}\r\n");
+
+    rfalStatsClear();
+#endif /* RFAL_FEATURE_STATS */
+}
+
+
+#if DEMO_RF_TRACE
+static uint8_t rfTraceBuf[DEMO_RF_TRACE_BUF_LEN];   // Frames of the current tap, from its activation on.
+#endif
+
+static void start_rf_trace(void)
+{
+#if DEMO_RF_TRACE
+    (void)rfalTraceStart(rfTraceBuf, sizeof(rfTraceBuf), true);
+#endif
+}
+
+
+// Prints the trace of the tap just done. Called once the tag is served, so the printing delays no exchange.
+static void dump_rf_trace(void)
+{
+#if DEMO_RF_TRACE
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char              line[3 + (2 * DEMO_RF_TRACE_LINE_LEN) + 3];
+    uint32_t          dropped;
+    uint32_t          len;
+    uint32_t          i;
+    uint32_t          pos;
+
+    len = rfalTraceStop(&dropped);
+    for (i = 0; i < len; i += DEMO_RF_TRACE_LINE_LEN)
+    {
+        pos = 0;
+        line[pos++] = 'T';
+        line[pos++] = ':';
+        for (uint32_t j = i; (j < len) && (j < (i + DEMO_RF_TRACE_LINE_LEN)); j++)
+        {
+            line[pos++] = hexDigits[rfTraceBuf[j] >> 4];
+            line[pos++] = hexDigits[rfTraceBuf[j] & 0x0F];
+        }
+        line[pos++] = '\r';
+        line[pos++] = '\n';
+        line[pos]   = '\0';
+        Serial0.print(line);        // One write per line: not split by the RF log drained from the other core
+    }
+    if (dropped != 0)
+    {
+        Serial0.print("T:dropped ");
+        Serial0.print(dropped);
+        Serial0.print("\r\n");
+    }
+#endif
+}
+
+
+static uint32_t snepRxLen;   // Length of the NDEF message pushed by the P2P device, 0 if none yet.
+
+static void snep_put_received(const uint8_t *ndef, uint32_t ndefLen)
+{
+    // Called from within rfalLlcpWorker() - message is already on rawMessageBuf, parse it once the link is done.
+    snepRxLen = ndefLen;
+}
+
+
+static void demoP2P(void)
+{
+    rfalLlcpStats   llcpStats;
+    rfalNfcDepStats depStats;
+    uint32_t        start;
+
+    if (rfalLlcpStart(nfcDevice->proto.nfcDep.activation.Target.ATR_RES.GBt, nfcDevice->proto.nfcDep.info.GBLen, true) != RFAL_ERR_NONE)
+    {
+        Serial0.print("P2P device does not support LLCP\r\n");
+        return;
+    }
+
+    // Symmetric LLCP exchanges until the device pushes an NDEF message, one more to send the SNEP SUCCESS back.
+    snepRxLen = 0;
+    start = millis();
+    while ( (rfalLlcpWorker() == RFAL_ERR_NONE) && (snepRxLen == 0) && ((millis() - start) < DEMO_P2P_TIMEOUT) )
+    {
+    }
+    if (snepRxLen != 0)
+    {
+        rfalLlcpWorker();
+    }
+
+    rfalLlcpGetStats(&llcpStats);
+    rfalNfcDepGetStats(&depStats);
+    rfalLlcpStop();
+
+    Serial0.print("LLCP: ");
+    Serial0.print(llcpStats.xchgCnt);
+    Serial0.print(" exchanges, I-PDUs sent/received: ");
+    Serial0.print(llcpStats.iTxCnt);
+    Serial0.print("/");
+    Serial0.print(llcpStats.iRxCnt);
+    Serial0.print(", ");
+    Serial0.print(llcpStats.rxBytes);
+    Serial0.print(" bytes received, remote MIU: ");
+    Serial0.print(llcpStats.remoteMIU);
+    if (llcpStats.ltoExpCnt != 0)
+    {
+        Serial0.print(", link dropped: remote LTO ");
+        Serial0.print(llcpStats.remoteLTO);
+        Serial0.print(" ms expired");
+    }
+    Serial0.print("\r\n");
+
+    Serial0.print("NFC-DEP: FS ");
+    Serial0.print(rfalNfcDepLR2FS(nfcDevice->proto.nfcDep.info.LR));
+    Serial0.print(", ");
+    Serial0.print(depStats.bytesPerSec);
+    Serial0.print(" bytes/s, I-PDUs sent/received: ");
+    Serial0.print(depStats.iTxCnt);
+    Serial0.print("/");
+    Serial0.print(depStats.iRxCnt);
+    Serial0.print(", ACK sent/received: ");
+    Serial0.print(depStats.ackTxCnt);
+    Serial0.print("/");
+    Serial0.print(depStats.ackRxCnt);
+    Serial0.print(", NACK sent/received: ");
+    Serial0.print(depStats.nackTxCnt);
+    Serial0.print("/");
+    Serial0.print(depStats.nackRxCnt);
+    Serial0.print(", RTOX: ");
+    Serial0.print(depStats.rtoxCnt);
+    Serial0.print("\r\n");
+
+    if (snepRxLen != 0)
+    {
+        ndefQueueSlot *slot = ndef_queue_acquire(&ndefRxQueue);
+
+        if (slot != NULL)
+        {
+            // SNEP receives on its own buffer: the one copy made to hand the message over.
+            ST_MEMCPY(slot->data, rawMessageBuf, MIN(snepRxLen, (uint32_t)sizeof(slot->data)));
+            publish_ndef_message(&ndefRxQueue, slot, nfcDevice, MIN(snepRxLen, (uint32_t)sizeof(slot->data)), start);
+        }
+    }
+}
+
+
+#if DEMO_T4T_CE
+static uint32_t t4tCeMaxProcTime;   // Longest C-APDU processing time seen [us], to be kept well inside FWT.
+
+static uint16_t t4t_ce_xchg(const uint8_t *cApdu, uint16_t cApduLen, uint8_t *rApdu, uint16_t rApduBufLen, uint16_t *rApduLen)
+{
+    uint32_t start = micros();
+
+    ndefT4TCeProcess(&t4tCe, cApdu, cApduLen, rApdu, rApduBufLen, rApduLen);
+    t4tCeMaxProcTime = MAX(t4tCeMaxProcTime, (uint32_t)(micros() - start));
+
+    // Status word, 0 if not even SW1SW2 was answered.
+    return ((*rApduLen >= NDEF_T4T_CE_SW_LEN) ? GETU16(&rApdu[*rApduLen - NDEF_T4T_CE_SW_LEN]) : 0U);
+}
+#endif
+
+
+static void demo_t4t_ce(void)
+{
+#if DEMO_T4T_CE
+    ReturnCode err;
+    uint8_t   *rxData;
+    uint16_t  *rcvLen;
+    uint8_t   *txBuf;
+    uint16_t   txBufLen;
+    uint16_t   txLen;
+
+    // Listen mode: the Reader/Writer sends first, each C-APDU is answered straight on the ISO-DEP Tx buffer.
+    ndefT4TCeReset(&t4tCe);
+    err = rfalNfcDataExchangeStart(NULL, 0, &rxData, &rcvLen, RFAL_FWT_NONE);
+    while (err == RFAL_ERR_NONE)
+    {
+        do
+        {
+            rfalNfcWorker();
+            err = rfalNfcDataExchangeGetStatus();
+        } while (err == RFAL_ERR_BUSY);
+
+        if ((err != RFAL_ERR_NONE) || (rfalNfcDataExchangeGetTxBuf(&txBuf, &txBufLen) != RFAL_ERR_NONE))
+        {
+            break;
+        }
+
+        t4t_ce_xchg(rxData, *rcvLen, txBuf, txBufLen, &txLen);
+        err = rfalNfcDataExchangeStart(txBuf, txLen, &rxData, &rcvLen, RFAL_FWT_NONE);
+    }
+
+    Serial0.print("T4T CE: ");
+    Serial0.print(t4tCe.stats.cmdCnt);
+    Serial0.print(" C-APDUs, ");
+    Serial0.print(t4tCe.stats.readBytes);
+    Serial0.print(" bytes read, ");
+    Serial0.print(t4tCe.stats.updateBytes);
+    Serial0.print(" bytes written, longest processing: ");
+    Serial0.print(t4tCeMaxProcTime);
+    Serial0.print(" us\r\n");
+#endif
+}
+
+
+#if DEMO_T3T_CE
+static uint32_t t3tCeMaxProcTime;   // Longest request processing time seen [us], to be kept well inside the announced MRT.
+
+static uint16_t t3t_ce_xchg(uint8_t *req, uint16_t reqLen, uint8_t *rsp, uint16_t rspBufLen)
+{
+    uint32_t start = micros();
+    uint16_t rspLen;
+
+    ndefT3TCeProcess(&t3tCe, req, reqLen, rsp, rspBufLen, &rspLen);
+    t3tCeMaxProcTime = MAX(t3tCeMaxProcTime, (uint32_t)(micros() - start));
+
+    return rspLen;
+}
+#endif
+
+
+static void demo_t3t_ce(void)
+{
+#if DEMO_T3T_CE
+    static uint8_t rsp[NDEF_T3T_CE_RSP_MAX_LEN];
+    ReturnCode     err;
+    uint8_t       *rxData;
+    uint16_t      *rcvLen;
+    uint16_t       rspLen;
+
+    // Listen mode, RF interface: the first request is already received, each one answered from the block image (lengths in bits).
+    err = rfalNfcDataExchangeStart(NULL, 0, &rxData, &rcvLen, RFAL_FWT_NONE);
+    while (err == RFAL_ERR_NONE)
+    {
+        do
+        {
+            rfalNfcWorker();
+            err = rfalNfcDataExchangeGetStatus();
+        } while (err == RFAL_ERR_BUSY);
+
+        if (err != RFAL_ERR_NONE)
+        {
+            break;
+        }
+
+        rspLen = t3t_ce_xchg(rxData, (uint16_t)rfalConvBitsToBytes(*rcvLen), rsp, sizeof(rsp));
+        err = rfalNfcDataExchangeStart(((rspLen > 0U) ? rsp : NULL), (uint16_t)rfalConvBytesToBits(rspLen), &rxData, &rcvLen, RFAL_FWT_NONE);
+    }
+
+    Serial0.print("T3T CE: ");
+    Serial0.print(t3tCe.stats.checkCnt);
+    Serial0.print(" CHECK (");
+    Serial0.print(t3tCe.stats.checkBlocks);
+    Serial0.print(" blocks), ");
+    Serial0.print(t3tCe.stats.updateCnt);
+    Serial0.print(" UPDATE (");
+    Serial0.print(t3tCe.stats.updateBlocks);
+    Serial0.print(" blocks), longest processing: ");
+    Serial0.print(t3tCeMaxProcTime);
+    Serial0.print(" us\r\n");
+#endif
+}
+
+
 static void ndefDumpSysInfo()
 {
   ndefSystemInformation *sysInfo;
@@ -552,14 +1097,18 @@ static void ndefDumpSysInfo()
 
 static const bool verbose = false;
 
-/* State-to-descriptive-text: */
-static uint8_t *ndefStates[] = 
+static void publish_ndef_message(ndefQueue *q, ndefQueueSlot *slot, const rfalNfcDevice *dev, uint32_t len, uint32_t start)
 {
-  (uint8_t *)"INVALID",
-  (uint8_t *)"INITIALIZED",
-  (uint8_t *)"READ/WRITE",
-  (uint8_t *)"READ-ONLY"
-};
+    slot->devType   = (uint8_t)dev->type;
+    slot->uidLen    = MIN(dev->nfcidLen, (uint8_t)NDEF_QUEUE_UID_LEN);
+    ST_MEMCPY(slot->uid, dev->nfcid, slot->uidLen);
+    slot->timestamp = millis();
+    slot->readTime  = (slot->timestamp - start);
+    slot->len       = len;
+
+    ndef_queue_publish(q);
+    xTaskNotifyGive(decodeTask);
+}
 
 
 static void read_ndef_data(rfalNfcDevice *pNfcDevice)
@@ -583,15 +1132,16 @@ static void read_ndef_data(rfalNfcDevice *pNfcDevice)
     ndefConstBuffer bufUri;
     ndefConstBuffer bufAndroidPackName;
 
+    ndefQueueSlot   *slot;
+    uint32_t         readStart = millis();
+
 
     /*
     * Perform NDEF Context Initialization
     */
     err = ndefPollerContextInitialization(&ndefCtx, pNfcDevice);
     if (err != ERR_NONE) {
-        Serial0.print("NDEF NOT DETECTED (ndefPollerContextInitialization returns ");
-        Serial0.print(err);
-        Serial0.print(")\r\n");
+        rf_log(RF_LOG_EVT_NDEF_INIT_ERR, err);
 
         return;
     }
@@ -607,16 +1157,13 @@ static void read_ndef_data(rfalNfcDevice *pNfcDevice)
     err = ndefPollerNdefDetect(&ndefCtx, &info);
     if (err != ERR_NONE) 
     {
-        Serial0.print("NDEF NOT DETECTED (ndefPollerNdefDetect returns ");
-        Serial0.print(err);
-        Serial0.print(")\r\n");
+        rf_log(RF_LOG_EVT_NDEF_DETECT_ERR, err);
 
         return;
     }
     else 
     {
-        Serial0.print((char *)ndefStates[info.state]);
-        Serial0.print(" NDEF detected.\r\n");
+        rf_log(RF_LOG_EVT_NDEF_DETECTED, info.state);
         //ndefCCDump(&ndefCtx);
 
         // if (verbose) 
@@ -631,33 +1178,44 @@ static void read_ndef_data(rfalNfcDevice *pNfcDevice)
 
        if (info.state == NDEF_STATE_INITIALIZED) 
        {
-            Serial0.println("NDEF-state = INITIALIZED --> nothing to READ ...");
             /* Nothing to read... */
             return;
         }
 
-    err = ndefPollerReadRawMessage(&ndefCtx, rawMessageBuf, sizeof(rawMessageBuf), &rawMessageLen, true);   // Last (BOOL-)-arg means 'read SINGLE NDEF-msg'.
+    /* Raw message read straight into a queue slot, decoded on the other core */
+    slot = ndef_queue_acquire(&ndefRxQueue);
+    if (slot == NULL)
+    {
+        rf_log(RF_LOG_EVT_NDEF_DROPPED);
+        return;     // Decoding lags behind: message dropped, counted by the queue
+    }
+
+    err = ndefPollerReadRawMessage(&ndefCtx, slot->data, sizeof(slot->data), &rawMessageLen, true);   // Last (BOOL-)-arg means 'read SINGLE NDEF-msg'.
     if (err != ERR_NONE) 
     {
-        Serial0.print("NDEF message cannot be read (ndefPollerReadRawMessage returns ");
-        Serial0.print(err);
-        Serial0.print(")\r\n");
+        rf_log(RF_LOG_EVT_NDEF_READ_ERR, err);
+        print_ndef_retry_stats();
 
         return;
     }
 
     if (verbose) 
     {
-        bufRawMessage.buffer = rawMessageBuf;
+        bufRawMessage.buffer = slot->data;
         bufRawMessage.length = rawMessageLen;
         //ndefBufferDump(" NDEF Content", (ndefConstBuffer *)&bufRawMessage, verbose);
 
     }
 
-    bufConstRawMessage.buffer = rawMessageBuf;
+    bufConstRawMessage.buffer = slot->data;
     bufConstRawMessage.length = rawMessageLen;
 
-    ndefParseMessage(rawMessageBuf, rawMessageLen);
+    rf_log(RF_LOG_EVT_NDEF_READ, rawMessageLen, (millis() - readStart));
+    publish_ndef_message(&ndefRxQueue, slot, pNfcDevice, rawMessageLen, readStart);
+
+    print_wakeup_stats();
+    print_dpo_stats();
+    print_ndef_retry_stats();
 
     // err = ndefMessageDecode(&bufConstRawMessage, &message);
     // if (err != ERR_NONE) 
@@ -690,6 +1248,9 @@ static void read_ndef_data(rfalNfcDevice *pNfcDevice)
 #define NFC_POLL_STATE_NOTINIT               0  
 #define NFC_POLL_STATE_START_DISCOVERY       1  
 #define NFC_POLL_STATE_DISCOVERY             2  
+#define NFC_POLL_STATE_PRESENCE              3  
+
+#define NFC_POLL_TASK_PERIOD                10      // [ms] between two steps of the discovery / presence checks
 
 static int nfcCurrentState = NFC_POLL_STATE_NOTINIT;
 
@@ -701,19 +1262,10 @@ void poll_for_nfc_tags(void * parameter)
     static bool found = false;
     uint32_t rawMessageLen;
 
-    rfalNfcaSensRes       sensRes;
-    rfalNfcaSelRes        selRes;
-    rfalFeliCaPollRes     cardList[1];
-
-    rfalNfcbSensbRes      sensbRes;
-    uint8_t               sensbResLen;
-
+    rfalNfcDevice        *devList;
     uint8_t               devCnt = 0;
-    uint8_t               collisions = 0U;
-    rfalNfcfSensfRes     *sensfRes;
 
-    rfalNfcvInventoryRes  invRes;
-    uint16_t              rcvdLen;
+    rfalSelectInstance(0);      // Reader 0, for this task only (the only reader with a single instance)
 
     for(;;)
     { 
@@ -724,6 +1276,7 @@ void poll_for_nfc_tags(void * parameter)
             /*******************************************************************************/
             case NFC_POLL_STATE_START_DISCOVERY:
                 rfalNfcDeactivate(RFAL_NFC_DEACTIVATE_IDLE);
+                start_rf_trace();
                 rfalNfcDiscover(&discParam);
 
                 nfcCurrentState = NFC_POLL_STATE_DISCOVERY;
@@ -735,7 +1288,14 @@ void poll_for_nfc_tags(void * parameter)
                 {
                     rfalNfcGetActiveDevice(&nfcDevice);
 
-                    delay(50);
+                    /* Follow every tag found, the active one being processed below */
+                    rfalNfcGetDevicesFound(&devList, &devCnt);
+                    for (uint8_t i = 0; i < devCnt; i++)
+                    {
+                        tag_session_arrival(&devList[i]);
+                    }
+
+                    print_poll_sched_stats();
 
                     switch (nfcDevice->type) {
                     /*******************************************************************************/
@@ -744,79 +1304,46 @@ void poll_for_nfc_tags(void * parameter)
                         switch (nfcDevice->dev.nfca.type) 
                         {
                         case RFAL_NFCA_T1T:
-                            Serial0.print("ISO14443A/Topaz (NFC-A T1T) TAG found. UID: ");
-                            Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                            Serial0.print("\r\n");
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCA_T1T);
                             rfalNfcaPollerSleep();
                             break;
 
                         case RFAL_NFCA_T4T:
-                            Serial0.print("NFCA Passive ISO-DEP device found. UID: ");
-                            Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                            Serial0.print("\r\n");
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCA_ISODEP);
                             read_ndef_data(nfcDevice);
                             rfalIsoDepDeselect();
+                            print_isodep_link_stats();
                             break;
 
                         case RFAL_NFCA_T4T_NFCDEP:
                         case RFAL_NFCA_NFCDEP:
-                            Serial0.print("NFCA Passive P2P device found. NFCID: ");
-                            Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                            Serial0.print("\r\n");
-                            //demoP2P();
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCA_P2P);
+                            demoP2P();
                             break;
 
                         default:
-                            Serial0.print("ISO14443A/NFC-A card found. UID: ");
-                            Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                            Serial0.print("\r\n");
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCA);
                             read_ndef_data(nfcDevice);
                             rfalNfcaPollerSleep();
                             break;
                         }
-                        /* Loop until tag is removed from the field */
-                        Serial0.print("Operation completed\r\nTag can be removed from the field\r\n");
-                        rfalNfcaPollerInitialize();
-                        while (rfalNfcaPollerCheckPresence(RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes) == ERR_NONE) 
-                        {
-                            if (((nfcDevice->dev.nfca.type == RFAL_NFCA_T1T) && (!rfalNfcaIsSensResT1T(&sensRes))) ||
-                                ((nfcDevice->dev.nfca.type != RFAL_NFCA_T1T) && (rfalNfcaPollerSelect(nfcDevice->dev.nfca.nfcId1, nfcDevice->dev.nfca.nfcId1Len, &selRes) != ERR_NONE))) 
-                            {
-                                break;
-                            }
-                            rfalNfcaPollerSleep();
-                            delay(130);
-                        }
                         break;
 
                     /*******************************************************************************/
                     case RFAL_NFC_LISTEN_TYPE_NFCB:
                         // TODO: check - is this relevant??
-                        Serial0.print("ISO14443B/NFC-B card found. UID: ");
-                        Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                        Serial0.print("\r\n");
+                        rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCB);
 
                         if (rfalNfcbIsIsoDepSupported(&nfcDevice->dev.nfcb)) 
                         {
                             read_ndef_data(nfcDevice);
                             rfalIsoDepDeselect();
+                            print_isodep_link_stats();
                         } 
                         else 
                         {
                             rfalNfcbPollerSleep(nfcDevice->dev.nfcb.sensbRes.nfcid0);
                         }
-                        /* Loop until tag is removed from the field */
-                        Serial0.print("Operation completed\r\nTag can be removed from the field\r\n");
-                        rfalNfcbPollerInitialize();
-                        while (rfalNfcbPollerCheckPresence(RFAL_NFCB_SENS_CMD_ALLB_REQ, RFAL_NFCB_SLOT_NUM_1, &sensbRes, &sensbResLen) == ERR_NONE) 
-                        {
-                            if (ST_BYTECMP(sensbRes.nfcid0, nfcDevice->dev.nfcb.sensbRes.nfcid0, RFAL_NFCB_NFCID0_LEN) != 0) 
-                            {
-                                break;
-                            }
-                            rfalNfcbPollerSleep(nfcDevice->dev.nfcb.sensbRes.nfcid0);
-                            delay(130);
-                        }
                         break;
 
                     /*******************************************************************************/
@@ -824,31 +1351,14 @@ void poll_for_nfc_tags(void * parameter)
 
                         if (rfalNfcfIsNfcDepSupported(&nfcDevice->dev.nfcf)) 
                         {
-                            Serial0.print("NFCF Passive P2P device found. NFCID: ");
-                            Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                            Serial0.print("\r\n");
-                            // demoP2P();   // NOPE ...
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCF_P2P);
+                            demoP2P();
                         } 
                         else 
                         {
-                            Serial0.print("Felica/NFC-F card found. UID: ");
-                            Serial0.print(hex2str(nfcDevice->nfcid, nfcDevice->nfcidLen));
-                            Serial0.print("\r\n");
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, nfcDevice->nfcid, nfcDevice->nfcidLen, RF_LOG_TAG_NFCF);
                             read_ndef_data(nfcDevice);
                         }
-
-                        /* Loop until tag is removed from the field */
-                        Serial0.print("Operation completed\r\nTag can be removed from the field\r\n");
-                        devCnt = 1;
-                        rfalNfcfPollerInitialize(RFAL_BR_212);
-                        while (rfalNfcfPollerPoll(RFAL_FELICA_1_SLOT, RFAL_NFCF_SYSTEMCODE, RFAL_FELICA_POLL_RC_NO_REQUEST, cardList, &devCnt, &collisions) == ERR_NONE) {
-                        /* Skip the length field byte */
-                        sensfRes = (rfalNfcfSensfRes *) & ((uint8_t *)cardList)[1];
-                        if (ST_BYTECMP(sensfRes->NFCID2, nfcDevice->dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN) != 0) {
-                            break;
-                        }
-                        delay(130);
-                        }
                         break;
 
                     /*******************************************************************************/
@@ -858,40 +1368,207 @@ void poll_for_nfc_tags(void * parameter)
 
                             ST_MEMCPY(devUID, nfcDevice->nfcid, nfcDevice->nfcidLen);     /* Copy the UID into local var */
                             REVERSE_BYTES(devUID, RFAL_NFCV_UID_LEN);                   /* Reverse the UID for display purposes */
-                            Serial0.print("ISO15693/NFC-V card found. UID: ");
-                            Serial0.print(hex2str(devUID, RFAL_NFCV_UID_LEN));
-                            Serial0.print("\r\n");
+                            rf_log_bytes(RF_LOG_EVT_TAG_FOUND, devUID, RFAL_NFCV_UID_LEN, RF_LOG_TAG_NFCV);
 
                             read_ndef_data(nfcDevice);
-
-                            /* Loop until tag is removed from the field */
-                            Serial0.print("Operation completed\r\nTag can be removed from the field\r\n");
-                            rfalNfcvPollerInitialize();
-                            while (rfalNfcvPollerInventory(RFAL_NFCV_NUM_SLOTS_1, RFAL_NFCV_UID_LEN * 8U, nfcDevice->dev.nfcv.InvRes.UID, &invRes, &rcvdLen) == ERR_NONE) 
-                            {
-                                delay(130);
-                            }
                         }
                         break;
 
+#if DEMO_T3T_CE
+                    /*******************************************************************************/
+                    case RFAL_NFC_POLL_TYPE_NFCF:
+                        Serial0.print("Activated as T3T by a Reader/Writer\r\n");
+                        demo_t3t_ce();
+                        break;
+#endif
+
+#if DEMO_T4T_CE
+                    /*******************************************************************************/
+                    case RFAL_NFC_POLL_TYPE_NFCA:
+                        Serial0.print("Activated as T4T by a Reader/Writer\r\n");
+                        demo_t4t_ce();
+                        break;
+#endif
+
                     /*******************************************************************************/
                     default:
                         break;
                     }
 
-                    rfalNfcDeactivate(RFAL_NFC_DEACTIVATE_IDLE);
-                    delay(500);
-                    nfcCurrentState = NFC_POLL_STATE_START_DISCOVERY;
+                    dump_rf_trace();
+
+                    if (tag_session_count() != 0)
+                    {
+                        /* Field kept on: presence checked between other work, until the tag(s) leave */
+                        rf_log(RF_LOG_EVT_TAG_DONE, tag_session_count());
+                        nfcCurrentState = NFC_POLL_STATE_PRESENCE;
+                    }
+                    else
+                    {
+                        nfcCurrentState = NFC_POLL_STATE_START_DISCOVERY;
+                    }
                 }
             break;  // CASE NFC_POLL_STATE_DISCOVERY
 
+            /*******************************************************************************/
+            case NFC_POLL_STATE_PRESENCE:
+                tag_session_service();
+
+                if (tag_session_count() == 0)
+                {
+                    /* All gone: discovery again right away, ready for the next tap */
+                    nfcCurrentState = NFC_POLL_STATE_START_DISCOVERY;
+                }
+            break;
+
             /*******************************************************************************/
             case NFC_POLL_STATE_NOTINIT:   // Fall-through ...
             default: break;
         }
 
-        // Pause the task for 100msec:
-        vTaskDelay(100 / portTICK_PERIOD_MS);   // NOTE: up to 500ms is OK - but if the total(=incl. 500ms delay above) goes beyond scan period(=1sec), scan may seem to fail(?).
+        // Pause the task between two steps, leaving the CPU to the other tasks:
+        vTaskDelay(NFC_POLL_TASK_PERIOD / portTICK_PERIOD_MS);
+    }
+}
+
+
+#if RFAL_FEATURE_INSTANCES > 1U
+// Poll task of readers 1..N-1: discovery and raw NDEF reads only, running concurrently with reader 0.
+void poll_reader(void * parameter)
+{
+    nfcReader     *reader = (nfcReader *)parameter;
+    rfalNfcDevice *dev;
+    ndefInfo       info;
+    ndefQueueSlot *slot;
+    uint32_t       rawMessageLen;
+    uint32_t       readStart;
+
+    // Selected for this task only: all its RFAL calls drive this reader, the SPI bus is locked per transaction.
+    rfalSelectInstance(reader->inst);
+    rfalNfcDiscover(&readerDiscParam);
+
+    for(;;)
+    {
+        rfalNfcWorker();
+
+        if (rfalNfcIsDevActivated(rfalNfcGetState()))
+        {
+            rfalNfcGetActiveDevice(&dev);
+            readStart = millis();
+
+            // A tag left on the reader is read once, not on every discovery round
+            if ( (dev->nfcidLen != reader->uidLen) || (ST_BYTECMP(dev->nfcid, reader->uid, reader->uidLen) != 0) ||
+                 ((readStart - reader->lastSeen) > NFC_READER_REPEAT) )
+            {
+                if ( (ndefPollerContextInitialization(&reader->ndefCtx, dev) == ERR_NONE) &&
+                     (ndefPollerNdefDetect(&reader->ndefCtx, &info) == ERR_NONE)          &&
+                     (info.state != NDEF_STATE_INITIALIZED)                                &&
+                     ((slot = ndef_queue_acquire(&reader->rxQueue)) != NULL)              &&
+                     (ndefPollerReadRawMessage(&reader->ndefCtx, slot->data, sizeof(slot->data), &rawMessageLen, true) == ERR_NONE) )
+                {
+                    // Errors not logged: the RF log has reader 0 as its single producer
+                    publish_ndef_message(&reader->rxQueue, slot, dev, rawMessageLen, readStart);
+                }
+
+                reader->uidLen = MIN(dev->nfcidLen, (uint8_t)NDEF_QUEUE_UID_LEN);
+                ST_MEMCPY(reader->uid, dev->nfcid, reader->uidLen);
+            }
+            reader->lastSeen = millis();
+
+            rfalNfcDeactivate(RFAL_NFC_DEACTIVATE_DISCOVERY);
+        }
+
+        vTaskDelay(NFC_POLL_TASK_PERIOD / portTICK_PERIOD_MS);
+    }
+}
+#endif
+
+
+// Decodes and prints the raw NDEF messages of one queue, returns the messages dropped on it so far.
+static uint32_t decode_queue(ndefQueue *q)
+{
+    ndefQueueSlot *slot;
+
+    while ((slot = ndef_queue_peek(q)) != NULL)
+    {
+        Serial0.print("[");
+        Serial0.print(slot->timestamp);
+        Serial0.print("ms] NDEF message from ");
+        for (uint8_t i = 0; i < slot->uidLen; i++)
+        {
+            if (slot->uid[i] < 0x10)
+            {
+                Serial0.print("0");
+            }
+            Serial0.print(slot->uid[i], HEX);
+        }
+        Serial0.print(", ");
+        Serial0.print(slot->len);
+        Serial0.print(" bytes read in ");
+        Serial0.print(slot->readTime);
+        Serial0.print("ms\r\n");
+
+        ndefParseMessage(slot->data, slot->len);
+        ndef_queue_release(q);
+    }
+
+    return q->dropCnt.load();
+}
+
+
+// Decode task: decodes and prints the raw NDEF messages queued by the RF task(s), on the other core.
+void decode_ndef_messages(void * parameter)
+{
+    uint32_t       dropCnt = 0;
+    uint32_t       drops;
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        drops = decode_queue(&ndefRxQueue);
+#if RFAL_FEATURE_INSTANCES > 1U
+        for (uint8_t i = 0; i < (RFAL_FEATURE_INSTANCES - 1U); i++)
+        {
+            drops += decode_queue(&nfcReaders[i].rxQueue);
+        }
+#endif
+
+        if (drops != dropCnt)
+        {
+            dropCnt = drops;
+            Serial0.print("NDEF queue full: ");
+            Serial0.print(dropCnt);
+            Serial0.print(" messages dropped so far\r\n");
+        }
+    }
+}
+
+
+// Drain task: prints the RF log at low priority, as text or as binary frames for tools/rf_log_decode.
+void drain_rf_log(void * parameter)
+{
+    rfLogEntry entry;
+#if RF_LOG_BINARY
+    uint8_t    frame[RF_LOG_FRAME_LEN];
+#else
+    char       line[160];
+#endif
+
+    for(;;)
+    {
+        while (rf_log_read(&entry))
+        {
+#if RF_LOG_BINARY
+            rf_log_frame(&entry, frame);
+            Serial0.write(frame, sizeof(frame));
+#else
+            rf_log_format(&entry, line, sizeof(line));
+            Serial0.println(line);
+#endif
+        }
+
+        vTaskDelay(RF_LOG_DRAIN_PERIOD / portTICK_PERIOD_MS);
     }
 }
 
@@ -900,6 +1577,7 @@ void poll_for_nfc_tags(void * parameter)
 
 void setup(void) 
 {
+    Serial0.setTxBufferSize(SERIAL_TX_BUF_LEN);
     Serial0.begin(115200);
     Serial0.println("Init ...");
     
@@ -920,22 +1598,154 @@ void setup(void)
 
     Serial0.println("NFC subsystem initialized OK ...");
 
+    // DPO: default table, tuned on the link statistics of each session.
+    rfalDpoInitialize();
+    rfalDpoSetEnabled(DEMO_DPO);
+
+    // P2P: SNEP server on LLCP, receiving into the NDEF buffer - registered first so that the ATR General Bytes announce it.
+    rfalSnepServerStart(rawMessageBuf, sizeof(rawMessageBuf), snep_put_received, NULL);
+    rfalLlcpGetGeneralBytes(discParam.GB, &discParam.GBLen);
+
+#if DEMO_T4T_CE
+    // T4T card emulation: NDEF file image in RAM, writable by the Reader/Writer (host test: tools/ndef_ce_test).
+    ndefT4TCeInit(&t4tCe, t4tCeFile, sizeof(t4tCeFile), false);
+    ndefT4TCeSetMessage(&t4tCe, t4tCeMessage, sizeof(t4tCeMessage));
+  #if !RFAL_SUPPORT_MODE_LISTEN_NFCA
+    #error "DEMO_T4T_CE: the RF front end does not support passive Listen NFC-A"
+  #endif
+    discParam.techs2Find |= RFAL_NFC_LISTEN_TECH_A;
+    discParam.lmConfigPA.nfcidLen = RFAL_LM_NFCID_LEN_04;
+    discParam.lmConfigPA.nfcid[0] = 0x08;                     // Random NFCID1 (08h prefix)
+    discParam.lmConfigPA.nfcid[1] = 0x5A;
+    discParam.lmConfigPA.nfcid[2] = 0xC3;
+    discParam.lmConfigPA.nfcid[3] = 0x17;
+    discParam.lmConfigPA.SENS_RES[0] = 0x04;
+    discParam.lmConfigPA.SENS_RES[1] = 0x00;
+    discParam.lmConfigPA.SEL_RES = DEMO_LM_SEL_RES;           // Type 4A Tag Platform
+#endif
+
+#if DEMO_T3T_CE
+    // T3T card emulation: block image in RAM, writable by the Reader/Writer (host test: tools/ndef_ce_test).
+    ndefT3TCeInit(&t3tCe, t3tCeImage, DEMO_T3T_CE_BLOCKS, t3tCeNfcid2, false);
+    ndefT3TCeSetMessage(&t3tCe, t4tCeMessage, sizeof(t4tCeMessage));
+  #if !RFAL_SUPPORT_MODE_LISTEN_NFCF
+    #error "DEMO_T3T_CE: the RF front end does not support passive Listen NFC-F"
+  #endif
+    discParam.techs2Find |= RFAL_NFC_LISTEN_TECH_F;
+    discParam.lmConfigPF.SC[0] = DEMO_LM_SC_BYTE1;
+    discParam.lmConfigPF.SC[1] = DEMO_LM_SC_BYTE2;
+    ST_MEMSET(discParam.lmConfigPF.SENSF_RES, 0x00, sizeof(discParam.lmConfigPF.SENSF_RES));
+    discParam.lmConfigPF.SENSF_RES[RFAL_NFCF_CMD_POS] = RFAL_NFCF_SENSF_RES_BYTE1;
+    ST_MEMCPY(&discParam.lmConfigPF.SENSF_RES[RFAL_NFCF_CMD_LEN], t3tCeNfcid2, NDEF_T3T_CE_NFCID2_LEN);
+    discParam.lmConfigPF.SENSF_RES[RFAL_NFCF_CMD_LEN + NDEF_T3T_CE_NFCID2_LEN] = DEMO_LM_PAD0;        // PAD0
+    discParam.lmConfigPF.SENSF_RES[RFAL_NFCF_CMD_LEN + NDEF_T3T_CE_NFCID2_LEN + 1U] = DEMO_LM_PAD0;
+    discParam.lmConfigPF.SENSF_RES[14] = 0x7F;                // MRTIcheck
+    discParam.lmConfigPF.SENSF_RES[15] = 0x7F;                // MRTIupdate
+    discParam.lmConfigPF.SENSF_RES[17] = DEMO_LM_SC_BYTE1;    // RD: System Code
+    discParam.lmConfigPF.SENSF_RES[18] = DEMO_LM_SC_BYTE2;
+#endif
+
+    // FeliCa: size SENSF_REQ time slots from previous polls - 1 slot for a single card, 16 on a collision.
+    rfalNfcfPollerSetAdaptiveSlots(true, DEMO_NFCF_POLL_TIME);
+
+    // ISO-DEP: step the bit rate down on CRC errors/timeouts, and back up once the link is clean again.
+    rfalIsoDepPollSetAdaptiveBitRate(true);
+
+    // Tag session: follow the tags left in the field without blocking the poll task.
+    static const tagSessionConfig sessionConfig = { DEMO_PRESENCE_INTERVAL, DEMO_DEPARTURE_DEBOUNCE };
+    tag_session_init(&sessionConfig, tag_session_event);
+
+#if RFAL_FEATURE_INSTANCES > 1U
+    // Readers 1..N-1: same RF settings as reader 0, polling for tags only.
+    readerDiscParam = discParam;
+    readerDiscParam.techs2Find &= (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F | RFAL_NFC_POLL_TECH_V);
+    readerDiscParam.GBLen = 0;
+
+    for (uint8_t i = 0; i < (RFAL_FEATURE_INSTANCES - 1U); i++)
+    {
+        nfcReaders[i].inst = (i + 1U);
+        ndef_queue_init(&nfcReaders[i].rxQueue);
+
+        rfalSelectInstance(nfcReaders[i].inst);
+        ret = rfalNfcInitialize();
+        if (RFAL_ERR_NONE != ret)
+        {
+            Serial0.print("ERROR: NFC reader ");
+            Serial0.print(nfcReaders[i].inst);
+            Serial0.print(" init failed, return code: ");
+            Serial0.println(ret);
+            while(1)
+            {
+                vTaskDelay(1000);
+            }
+        }
+
+        rfalDpoInitialize();
+        rfalDpoSetEnabled(DEMO_DPO);
+        rfalNfcfPollerSetAdaptiveSlots(true, DEMO_NFCF_POLL_TIME);
+        rfalIsoDepPollSetAdaptiveBitRate(true);
+    }
+    rfalSelectInstance(0);
+#endif
+
     nfcCurrentState = NFC_POLL_STATE_START_DISCOVERY;
 
-    xTaskCreate(
+    // RF and decoding on separate cores, raw NDEF messages handed over through the queue.
+    ndef_queue_init(&ndefRxQueue);
+    rf_log_init();
+
+    xTaskCreatePinnedToCore(
+        drain_rf_log,    // Function that should be called
+        "RF-Log",        // Name of the task (for debugging)
+        4096,            // Stack size (bytes)
+        NULL,            // Parameter to pass
+        0,               // Task priority: below the RF and decode tasks
+        NULL,            // Task handle
+        NFC_DECODE_CORE  // Core
+    );
+
+    xTaskCreatePinnedToCore(
+        decode_ndef_messages, // Function that should be called
+        "NDEF-Decode",     // Name of the task (for debugging)
+        4096,            // Stack size (bytes)
+        NULL,            // Parameter to pass
+        1,               // Task priority
+        &decodeTask,     // Task handle
+        NFC_DECODE_CORE  // Core
+    );
+
+    xTaskCreatePinnedToCore(
         poll_for_nfc_tags,    // Function that should be called
         "NFC-Poll ",       // Name of the task (for debugging)
         4096,            // Stack size (bytes)
         NULL,            // Parameter to pass
         1,               // Task priority
-        NULL             // Task handle
+        NULL,            // Task handle
+        NFC_RF_CORE      // Core
     );
+
+#if RFAL_FEATURE_INSTANCES > 1U
+    // One poll task per additional reader, all readers polling concurrently.
+    for (uint8_t i = 0; i < (RFAL_FEATURE_INSTANCES - 1U); i++)
+    {
+        xTaskCreatePinnedToCore(
+            poll_reader,      // Function that should be called
+            "NFC-Poll-N",     // Name of the task (for debugging)
+            4096,             // Stack size (bytes)
+            &nfcReaders[i],   // Parameter to pass: the reader polled
+            1,                // Task priority
+            NULL,             // Task handle
+            NFC_RF_CORE       // Core
+        );
+    }
+#endif
 }
 
 
 void loop(void) 
 {
     Serial0.println("\r\nALIVE ...\r\n");
+    print_rf_stats_json();
 
     vTaskDelay(10000);
 }
@@ -0,0 +1,383 @@
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Provides a NFC Forum T3T Card Emulation NDEF server
+ *
+ *  This module answers, as a Type 3 Tag, the CHECK and UPDATE commands
+ *  of a NFC Reader/Writer from a block-indexed image
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_t3t_ce.h"
+#include "rfal_nfcf.h"
+#include "utils.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#ifndef NDEF_FEATURE_T3T_CE
+    #error " NDEF: Module configuration missing. Please enable/disable T3T Card Emulation module by setting: NDEF_FEATURE_T3T_CE"
+#endif
+
+#if NDEF_FEATURE_T3T_CE
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_T3T_CE_LEN_POS                 0U    /*!< LEN byte position in the request                     */
+#define NDEF_T3T_CE_CMD_POS                 1U    /*!< Command code position in the request                 */
+#define NDEF_T3T_CE_NFCID2_POS              2U    /*!< NFCID2 position in the request                       */
+#define NDEF_T3T_CE_NOS_POS                10U    /*!< Number of Services position in the request           */
+#define NDEF_T3T_CE_SC_LEN                  2U    /*!< Service Code length                                  */
+#define NDEF_T3T_CE_MAX_SERV               15U    /*!< Max Number of Services           T3T 1.0  5.4.1.5    */
+
+#define NDEF_T3T_CE_ST1_POS                 9U    /*!< Status Flag 1 position in the response               */
+#define NDEF_T3T_CE_ST2_POS                10U    /*!< Status Flag 2 position in the response               */
+#define NDEF_T3T_CE_NOB_RSP_POS            11U    /*!< Number of Blocks position in the CHECK response      */
+
+#define NDEF_T3T_CE_ST2_ILLEGAL_NOS      0xA1U    /*!< Status Flag 2: illegal Number of Services            */
+#define NDEF_T3T_CE_ST2_ILLEGAL_NOB      0xA2U    /*!< Status Flag 2: illegal Number of Blocks              */
+#define NDEF_T3T_CE_ST2_ILLEGAL_SC       0xA6U    /*!< Status Flag 2: illegal Service Code (list)           */
+#define NDEF_T3T_CE_ST2_ILLEGAL_BLOCK    0xA8U    /*!< Status Flag 2: illegal Block Number                  */
+
+#define NDEF_T3T_CE_BLE_SCO_MASK         0x0FU    /*!< Block List Element: Service Code List Order          */
+#define NDEF_T3T_CE_BLE_ACCESS_MASK      0x70U    /*!< Block List Element: Access Mode, only 000b defined   */
+
+#define NDEF_T3T_CE_AIB_VERSION          0x10U    /*!< Attribute Information Block version 1.0              */
+#define NDEF_T3T_CE_AIB_CHECKSUM_LEN       14U    /*!< AIB bytes summed on the checksum                     */
+#define NDEF_T3T_CE_AIB_WRITEF_OFF       0x00U    /*!< AIB WriteFlag OFF                                    */
+#define NDEF_T3T_CE_AIB_RWF_RW           0x01U    /*!< AIB RWFlag: read/write                               */
+#define NDEF_T3T_CE_AIB_RWF_RO           0x00U    /*!< AIB RWFlag: read only                                */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+static uint8_t  ndefT3TCeCheckServices(const ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, bool update, uint16_t *pos);
+static uint8_t  ndefT3TCeGetBlockNum(const ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint16_t *pos, uint16_t *blockNum);
+static uint16_t ndefT3TCeCheck(ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint8_t *rsp, uint16_t rspBufLen);
+static uint16_t ndefT3TCeUpdate(ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint8_t *rsp);
+static uint16_t ndefT3TCeError(ndefT3tCeContext *ctx, uint8_t respCode, uint8_t st2, uint8_t *rsp);
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+ndefStatus ndefT3TCeInit(ndefT3tCeContext *ctx, uint8_t *image, uint16_t nBlocks, const uint8_t *nfcid2, bool readOnly)
+{
+    if( (ctx == NULL) || (image == NULL) || (nfcid2 == NULL) || (nBlocks < NDEF_T3T_CE_MIN_BLOCKS) )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(ctx, 0x00, sizeof(ndefT3tCeContext));
+    ctx->image    = image;
+    ctx->nBlocks  = nBlocks;
+    ctx->readOnly = readOnly;
+
+    /* Response headers    T3T 1.0  Table 8 */
+    ctx->checkHdr[0] = (uint8_t)RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION_RES;
+    ST_MEMCPY(&ctx->checkHdr[1], nfcid2, NDEF_T3T_CE_NFCID2_LEN);
+    ctx->checkHdr[NDEF_T3T_CE_ST1_POS] = RFAL_NFCF_STATUS_FLAG_SUCCESS;
+    ctx->checkHdr[NDEF_T3T_CE_ST2_POS] = RFAL_NFCF_STATUS_FLAG_SUCCESS;
+
+    ST_MEMCPY(ctx->updateRsp, ctx->checkHdr, NDEF_T3T_CE_HDR_LEN);
+    ctx->updateRsp[0] = (uint8_t)RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION_RES;
+
+    return ndefT3TCeSetMessage(ctx, NULL, 0U);
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefT3TCeSetMessage(ndefT3tCeContext *ctx, const uint8_t *msg, uint32_t msgLen)
+{
+    uint8_t *aib;
+    uint16_t nMaxB;
+    uint16_t checksum;
+    uint8_t  i;
+
+    if( (ctx == NULL) || (ctx->image == NULL) || ((msg == NULL) && (msgLen > 0U)) )
+    {
+        return ERR_PARAM;
+    }
+
+    nMaxB = (uint16_t)(ctx->nBlocks - 1U);
+    if( msgLen > ((uint32_t)nMaxB * NDEF_T3T_CE_BLOCK_LEN) )
+    {
+        return ERR_NOMEM;
+    }
+
+    if( msgLen > 0U )
+    {
+        ST_MEMCPY(&ctx->image[NDEF_T3T_CE_BLOCK_LEN], msg, msgLen);
+    }
+
+    /* Attribute Information Block    T3T 1.0  7.2.1 Table 12 */
+    aib = ctx->image;
+    ST_MEMSET(aib, 0x00, NDEF_T3T_CE_BLOCK_LEN);
+    aib[0]  = NDEF_T3T_CE_AIB_VERSION;                                   /* Ver                */
+    aib[1]  = NDEF_T3T_CE_NBR;                                           /* Nbr                */
+    aib[2]  = NDEF_T3T_CE_NBW;                                           /* Nbw                */
+    aib[3]  = (uint8_t)(nMaxB >> 8U);                                    /* NmaxB              */
+    aib[4]  = (uint8_t)(nMaxB & 0xFFU);
+    aib[9]  = NDEF_T3T_CE_AIB_WRITEF_OFF;                                /* WriteFlag          */
+    aib[10] = (ctx->readOnly ? NDEF_T3T_CE_AIB_RWF_RO : NDEF_T3T_CE_AIB_RWF_RW); /* RWFlag     */
+    aib[11] = (uint8_t)(msgLen >> 16U);                                  /* Ln                 */
+    aib[12] = (uint8_t)(msgLen >> 8U);
+    aib[13] = (uint8_t)(msgLen & 0xFFU);
+
+    checksum = 0U;
+    for( i = 0U; i < NDEF_T3T_CE_AIB_CHECKSUM_LEN; i++ )
+    {
+        checksum += aib[i];
+    }
+    aib[14] = (uint8_t)(checksum >> 8U);                                 /* Checksum           */
+    aib[15] = (uint8_t)(checksum & 0xFFU);
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefT3TCeProcess(ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint8_t *rsp, uint16_t rspBufLen, uint16_t *rspLen)
+{
+    if( (ctx == NULL) || (ctx->image == NULL) || (req == NULL) || (rsp == NULL) || (rspLen == NULL) || (rspBufLen < (NDEF_T3T_CE_HDR_LEN + 1U)) )
+    {
+        return ERR_PARAM;
+    }
+
+    ctx->stats.cmdCnt++;
+    *rspLen = 0U;
+
+    /* Only CHECK/UPDATE to this NFCID2, anything else is not answered    T3T 1.0  5.4.2.3 */
+    if( (reqLen <= NDEF_T3T_CE_NOS_POS) || (req[NDEF_T3T_CE_LEN_POS] != reqLen) ||
+        (!rfalNfcfListenerIsT3TReq(&req[NDEF_T3T_CE_CMD_POS], (uint16_t)(reqLen - RFAL_NFCF_LENGTH_LEN), NULL)) ||
+        (ST_BYTECMP(&req[NDEF_T3T_CE_NFCID2_POS], &ctx->checkHdr[1], NDEF_T3T_CE_NFCID2_LEN) != 0) )
+    {
+        ctx->stats.ignoredCnt++;
+        return ERR_NONE;
+    }
+
+    if( req[NDEF_T3T_CE_CMD_POS] == (uint8_t)RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION )
+    {
+        *rspLen = ndefT3TCeCheck(ctx, req, reqLen, rsp, rspBufLen);
+    }
+    else
+    {
+        *rspLen = ndefT3TCeUpdate(ctx, req, reqLen, rsp);
+    }
+
+    return ERR_NONE;
+}
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static uint8_t ndefT3TCeCheckServices(const ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, bool update, uint16_t *pos)
+{
+    uint8_t  nos;
+    uint8_t  i;
+    uint16_t sc;
+
+    nos = req[NDEF_T3T_CE_NOS_POS];
+    if( (nos == 0U) || (nos > NDEF_T3T_CE_MAX_SERV) || (reqLen < (NDEF_T3T_CE_NOS_POS + 1U + ((uint16_t)nos * NDEF_T3T_CE_SC_LEN) + 1U)) )
+    {
+        return NDEF_T3T_CE_ST2_ILLEGAL_NOS;
+    }
+
+    /* NDEF services only: RW (UPDATE and CHECK) unless read only, RO (CHECK)    T3T 1.0  7.2.1 */
+    for( i = 0U; i < nos; i++ )
+    {
+        sc = (uint16_t)req[NDEF_T3T_CE_NOS_POS + 1U + ((uint16_t)i * NDEF_T3T_CE_SC_LEN)] | ((uint16_t)req[NDEF_T3T_CE_NOS_POS + 2U + ((uint16_t)i * NDEF_T3T_CE_SC_LEN)] << 8U);
+        if( !( ((sc == RFAL_NFCF_SERVICECODE_RDWR) && !ctx->readOnly) || ((sc == RFAL_NFCF_SERVICECODE_RDONLY) && !update) ) )
+        {
+            return NDEF_T3T_CE_ST2_ILLEGAL_SC;
+        }
+    }
+
+    *pos = (uint16_t)(NDEF_T3T_CE_NOS_POS + 1U + ((uint16_t)nos * NDEF_T3T_CE_SC_LEN));
+    return RFAL_NFCF_STATUS_FLAG_SUCCESS;
+}
+
+
+/*******************************************************************************/
+static uint8_t ndefT3TCeGetBlockNum(const ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint16_t *pos, uint16_t *blockNum)
+{
+    uint8_t conf;
+
+    if( *pos >= reqLen )
+    {
+        return NDEF_T3T_CE_ST2_ILLEGAL_NOB;
+    }
+    conf = req[*pos];
+
+    /* Single service image: every Service Code List Order points to an NDEF service already checked */
+    if( ((conf & NDEF_T3T_CE_BLE_ACCESS_MASK) != 0U) || ((conf & NDEF_T3T_CE_BLE_SCO_MASK) >= req[NDEF_T3T_CE_NOS_POS]) )
+    {
+        return NDEF_T3T_CE_ST2_ILLEGAL_SC;
+    }
+
+    if( (conf & RFAL_NFCF_BLOCKLISTELEM_LEN_BIT) != 0U )
+    {
+        if( (*pos + 2U) > reqLen )
+        {
+            return NDEF_T3T_CE_ST2_ILLEGAL_NOB;
+        }
+        *blockNum = req[*pos + 1U];
+        *pos     += 2U;
+    }
+    else
+    {
+        if( (*pos + 3U) > reqLen )
+        {
+            return NDEF_T3T_CE_ST2_ILLEGAL_NOB;
+        }
+        *blockNum = (uint16_t)req[*pos + 1U] | ((uint16_t)req[*pos + 2U] << 8U);
+        *pos     += 3U;
+    }
+
+    return ( (*blockNum < ctx->nBlocks) ? RFAL_NFCF_STATUS_FLAG_SUCCESS : NDEF_T3T_CE_ST2_ILLEGAL_BLOCK );
+}
+
+
+/*******************************************************************************/
+static uint16_t ndefT3TCeCheck(ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint8_t *rsp, uint16_t rspBufLen)
+{
+    uint16_t pos;
+    uint16_t blockNum;
+    uint16_t rspLen;
+    uint8_t  nob;
+    uint8_t  st2;
+    uint8_t  i;
+
+    st2 = ndefT3TCeCheckServices(ctx, req, reqLen, false, &pos);
+    if( st2 != RFAL_NFCF_STATUS_FLAG_SUCCESS )
+    {
+        return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION_RES, st2, rsp);
+    }
+
+    nob = req[pos++];
+    if( (nob == 0U) || (nob > NDEF_T3T_CE_NBR) || (rspBufLen < (NDEF_T3T_CE_HDR_LEN + 1U + ((uint16_t)nob * NDEF_T3T_CE_BLOCK_LEN))) )
+    {
+        return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION_RES, NDEF_T3T_CE_ST2_ILLEGAL_NOB, rsp);
+    }
+
+    /* Precomputed header, then each block straight from the image */
+    ST_MEMCPY(rsp, ctx->checkHdr, NDEF_T3T_CE_HDR_LEN);
+    rsp[NDEF_T3T_CE_NOB_RSP_POS] = nob;
+    rspLen = (NDEF_T3T_CE_HDR_LEN + 1U);
+
+    for( i = 0U; i < nob; i++ )
+    {
+        st2 = ndefT3TCeGetBlockNum(ctx, req, reqLen, &pos, &blockNum);
+        if( st2 != RFAL_NFCF_STATUS_FLAG_SUCCESS )
+        {
+            return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION_RES, st2, rsp);
+        }
+        ST_MEMCPY(&rsp[rspLen], &ctx->image[(uint32_t)blockNum * NDEF_T3T_CE_BLOCK_LEN], NDEF_T3T_CE_BLOCK_LEN);
+        rspLen += NDEF_T3T_CE_BLOCK_LEN;
+    }
+
+    ctx->stats.checkCnt++;
+    ctx->stats.checkBlocks += nob;
+
+    return rspLen;
+}
+
+
+/*******************************************************************************/
+static uint16_t ndefT3TCeUpdate(ndefT3tCeContext *ctx, const uint8_t *req, uint16_t reqLen, uint8_t *rsp)
+{
+    uint16_t pos;
+    uint16_t dataPos;
+    uint16_t blockNum;
+    uint8_t  nob;
+    uint8_t  st2;
+    uint8_t  i;
+
+    st2 = ndefT3TCeCheckServices(ctx, req, reqLen, true, &pos);
+    if( st2 != RFAL_NFCF_STATUS_FLAG_SUCCESS )
+    {
+        return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION_RES, st2, rsp);
+    }
+
+    nob = req[pos++];
+    if( (nob == 0U) || (nob > NDEF_T3T_CE_NBW) )
+    {
+        return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION_RES, NDEF_T3T_CE_ST2_ILLEGAL_NOB, rsp);
+    }
+
+    /* Whole Block List validated and the Block Data length checked before anything is written */
+    dataPos = pos;
+    for( i = 0U; i < nob; i++ )
+    {
+        st2 = ndefT3TCeGetBlockNum(ctx, req, reqLen, &dataPos, &blockNum);
+        if( st2 != RFAL_NFCF_STATUS_FLAG_SUCCESS )
+        {
+            return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION_RES, st2, rsp);
+        }
+    }
+    if( reqLen != (dataPos + ((uint16_t)nob * NDEF_T3T_CE_BLOCK_LEN)) )
+    {
+        return ndefT3TCeError(ctx, (uint8_t)RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION_RES, NDEF_T3T_CE_ST2_ILLEGAL_NOB, rsp);
+    }
+
+    /* AIB written as any other block: the Reader/Writer owns WriteFlag, Ln and the checksum */
+    for( i = 0U; i < nob; i++ )
+    {
+        (void)ndefT3TCeGetBlockNum(ctx, req, reqLen, &pos, &blockNum);
+        ST_MEMCPY(&ctx->image[(uint32_t)blockNum * NDEF_T3T_CE_BLOCK_LEN], &req[dataPos], NDEF_T3T_CE_BLOCK_LEN);
+        dataPos += NDEF_T3T_CE_BLOCK_LEN;
+    }
+
+    ctx->stats.updateCnt++;
+    ctx->stats.updateBlocks += nob;
+
+    ST_MEMCPY(rsp, ctx->updateRsp, NDEF_T3T_CE_HDR_LEN);
+    return NDEF_T3T_CE_HDR_LEN;
+}
+
+
+/*******************************************************************************/
+static uint16_t ndefT3TCeError(ndefT3tCeContext *ctx, uint8_t respCode, uint8_t st2, uint8_t *rsp)
+{
+    ctx->stats.errCnt++;
+
+    /* Error: Status Flags only, no Block Data    T3T 1.0  5.4.2.2 */
+    ST_MEMCPY(rsp, ctx->checkHdr, NDEF_T3T_CE_HDR_LEN);
+    rsp[0]                   = respCode;
+    rsp[NDEF_T3T_CE_ST1_POS] = RFAL_NFCF_STATUS_FLAG_ERROR;
+    rsp[NDEF_T3T_CE_ST2_POS] = st2;
+
+    return NDEF_T3T_CE_HDR_LEN;
+}
+
+#endif /* NDEF_FEATURE_T3T_CE */
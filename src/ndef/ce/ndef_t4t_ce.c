@@ -0,0 +1,411 @@
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Provides a NFC Forum T4T Card Emulation NDEF server
+ *
+ *  This module answers, as a Type 4 Tag, the NDEF commands of a
+ *  NFC Reader/Writer from an NDEF file image
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_t4t_ce.h"
+#include "utils.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#ifndef NDEF_FEATURE_T4T_CE
+    #error " NDEF: Module configuration missing. Please enable/disable T4T Card Emulation module by setting: NDEF_FEATURE_T4T_CE"
+#endif
+
+#if NDEF_FEATURE_T4T_CE
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_T4T_CE_CLA                   0x00U   /*!< Class byte, no secure messaging                      */
+#define NDEF_T4T_CE_INS_SELECT            0xA4U   /*!< SELECT                                               */
+#define NDEF_T4T_CE_INS_READ_BINARY       0xB0U   /*!< ReadBinary                                           */
+#define NDEF_T4T_CE_INS_UPDATE_BINARY     0xD6U   /*!< UpdateBinary                                         */
+#define NDEF_T4T_CE_P1_SELECT_BY_NAME     0x04U   /*!< SELECT by DF name (AID)                              */
+#define NDEF_T4T_CE_P1_SELECT_BY_FID      0x00U   /*!< SELECT by file identifier                            */
+
+#define NDEF_T4T_CE_CLA_POS                 0U    /*!< CLA position in the C-APDU                           */
+#define NDEF_T4T_CE_INS_POS                 1U    /*!< INS position in the C-APDU                           */
+#define NDEF_T4T_CE_P1_POS                  2U    /*!< P1 position in the C-APDU                            */
+#define NDEF_T4T_CE_LC_POS                  4U    /*!< Lc (or Le) position in the C-APDU                    */
+#define NDEF_T4T_CE_DATA_POS                5U    /*!< Data position in the C-APDU                          */
+#define NDEF_T4T_CE_HDR_LEN                 4U    /*!< CLA INS P1 P2                                        */
+
+#define NDEF_T4T_CE_FID_CC            0xE103U     /*!< CC file identifier                 T4T 1.0  4.2      */
+#define NDEF_T4T_CE_FID_LEN                 2U    /*!< File identifier length                               */
+#define NDEF_T4T_CE_OFFSET_MASK       0x7FFFU     /*!< ReadBinary/UpdateBinary offset range                 */
+#define NDEF_T4T_CE_LE_MAX               256U     /*!< Le 00h: 256 bytes expected                           */
+
+#define NDEF_T4T_CE_MAPPING_VERSION      0x20U    /*!< Mapping version 2.0                                  */
+#define NDEF_T4T_CE_NDEF_CTLV_T          0x04U    /*!< NDEF-File_Ctrl_TLV T field                           */
+#define NDEF_T4T_CE_NDEF_CTLV_L          0x06U    /*!< NDEF-File_Ctrl_TLV L field                           */
+#define NDEF_T4T_CE_ACCESS_GRANTED       0x00U    /*!< Read/Write access granted                            */
+#define NDEF_T4T_CE_ACCESS_DENIED        0xFFU    /*!< Write access denied                                  */
+#define NDEF_T4T_CE_MIN_NLEN                3U    /*!< Room for the smallest NDEF message                   */
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+/*! Precomputed status words   ISO 7816-4 */
+static const uint8_t ndefT4TCeSwOk[]            = { 0x90, 0x00 };   /*!< Command completed                       */
+static const uint8_t ndefT4TCeSwWrongLength[]   = { 0x67, 0x00 };   /*!< Wrong length                            */
+static const uint8_t ndefT4TCeSwSecurity[]      = { 0x69, 0x82 };   /*!< Security status not satisfied           */
+static const uint8_t ndefT4TCeSwNoCurrentEF[]   = { 0x69, 0x86 };   /*!< Command not allowed, no current EF      */
+static const uint8_t ndefT4TCeSwNotFound[]      = { 0x6A, 0x82 };   /*!< File or application not found           */
+static const uint8_t ndefT4TCeSwWrongP1P2[]     = { 0x6A, 0x86 };   /*!< Incorrect P1 P2                         */
+static const uint8_t ndefT4TCeSwWrongOffset[]   = { 0x6B, 0x00 };   /*!< Offset outside the file                 */
+static const uint8_t ndefT4TCeSwInsNotSupp[]    = { 0x6D, 0x00 };   /*!< Instruction not supported               */
+static const uint8_t ndefT4TCeSwClaNotSupp[]    = { 0x6E, 0x00 };   /*!< Class not supported                     */
+
+static const uint8_t ndefT4TCeAidNdef[]         = { 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01 };  /*!< AID_NDEF v2.0 or higher   T4T 1.0  4.3.3 */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+
+static const uint8_t *ndefT4TCeSelect(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen);
+static const uint8_t *ndefT4TCeReadBinary(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen, uint8_t *rApdu, uint16_t rApduBufLen, uint16_t *rApduLen);
+static const uint8_t *ndefT4TCeUpdateBinary(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen);
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+ndefStatus ndefT4TCeInit(ndefT4tCeContext *ctx, uint8_t *ndefFile, uint16_t ndefFileLen, bool readOnly)
+{
+    uint8_t *cc;
+
+    if( (ctx == NULL) || (ndefFile == NULL) || (ndefFileLen < (NDEF_T4T_CE_NLEN_LEN + NDEF_T4T_CE_MIN_NLEN)) || (ndefFileLen > NDEF_T4T_CE_NDEF_FILE_MAX) )
+    {
+        return ERR_PARAM;
+    }
+
+    ST_MEMSET(ctx, 0x00, sizeof(ndefT4tCeContext));
+    ctx->ndefFile    = ndefFile;
+    ctx->ndefFileLen = ndefFileLen;
+    ctx->readOnly    = readOnly;
+    ctx->selected    = NDEF_T4T_CE_SEL_NONE;
+
+    /* CC file    T4T 1.0  5.1 Table 4, answered as is on ReadBinary */
+    cc     = ctx->ccRsp;
+    cc[0]  = 0x00U;                                              /* CCLEN                  */
+    cc[1]  = (uint8_t)NDEF_T4T_CE_CCFILE_LEN;
+    cc[2]  = NDEF_T4T_CE_MAPPING_VERSION;                        /* Mapping Version        */
+    cc[3]  = (uint8_t)(NDEF_T4T_CE_MLE >> 8U);                   /* MLe                    */
+    cc[4]  = (uint8_t)(NDEF_T4T_CE_MLE & 0xFFU);
+    cc[5]  = (uint8_t)(NDEF_T4T_CE_MLC >> 8U);                   /* MLc                    */
+    cc[6]  = (uint8_t)(NDEF_T4T_CE_MLC & 0xFFU);
+    cc[7]  = NDEF_T4T_CE_NDEF_CTLV_T;                            /* NDEF-File_Ctrl_TLV     */
+    cc[8]  = NDEF_T4T_CE_NDEF_CTLV_L;
+    cc[9]  = (uint8_t)(NDEF_T4T_CE_NDEF_FID >> 8U);              /* NDEF File Identifier   */
+    cc[10] = (uint8_t)(NDEF_T4T_CE_NDEF_FID & 0xFFU);
+    cc[11] = (uint8_t)(ndefFileLen >> 8U);                       /* Max NDEF File Size     */
+    cc[12] = (uint8_t)(ndefFileLen & 0xFFU);
+    cc[13] = NDEF_T4T_CE_ACCESS_GRANTED;                         /* Read Access            */
+    cc[14] = (readOnly ? NDEF_T4T_CE_ACCESS_DENIED : NDEF_T4T_CE_ACCESS_GRANTED); /* Write Access */
+    ST_MEMCPY(&cc[NDEF_T4T_CE_CCFILE_LEN], ndefT4TCeSwOk, NDEF_T4T_CE_SW_LEN);
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefT4TCeSetMessage(ndefT4tCeContext *ctx, const uint8_t *msg, uint16_t msgLen)
+{
+    if( (ctx == NULL) || (ctx->ndefFile == NULL) || ctx->readOnly || ((msg == NULL) && (msgLen > 0U)) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( ((uint32_t)msgLen + NDEF_T4T_CE_NLEN_LEN) > ctx->ndefFileLen )
+    {
+        return ERR_NOMEM;
+    }
+
+    /* Same order as a Reader/Writer: NLEN cleared, message, NLEN    T4T 1.0  7.5.1 */
+    ctx->ndefFile[0] = 0x00U;
+    ctx->ndefFile[1] = 0x00U;
+    if( msgLen > 0U )
+    {
+        ST_MEMCPY(&ctx->ndefFile[NDEF_T4T_CE_NLEN_LEN], msg, msgLen);
+    }
+    ctx->ndefFile[0] = (uint8_t)(msgLen >> 8U);
+    ctx->ndefFile[1] = (uint8_t)(msgLen & 0xFFU);
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void ndefT4TCeReset(ndefT4tCeContext *ctx)
+{
+    if( ctx != NULL )
+    {
+        ctx->selected = NDEF_T4T_CE_SEL_NONE;
+    }
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefT4TCeProcess(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen, uint8_t *rApdu, uint16_t rApduBufLen, uint16_t *rApduLen)
+{
+    const uint8_t *sw;
+
+    if( (ctx == NULL) || (ctx->ndefFile == NULL) || (cApdu == NULL) || (rApdu == NULL) || (rApduLen == NULL) || (rApduBufLen < NDEF_T4T_CE_SW_LEN) )
+    {
+        return ERR_PARAM;
+    }
+
+    ctx->stats.cmdCnt++;
+    *rApduLen = 0U;
+
+    if( cApduLen < NDEF_T4T_CE_HDR_LEN )
+    {
+        sw = ndefT4TCeSwWrongLength;
+    }
+    else if( cApdu[NDEF_T4T_CE_CLA_POS] != NDEF_T4T_CE_CLA )
+    {
+        sw = ndefT4TCeSwClaNotSupp;
+    }
+    else
+    {
+        switch( cApdu[NDEF_T4T_CE_INS_POS] )
+        {
+            case NDEF_T4T_CE_INS_SELECT:
+                sw = ndefT4TCeSelect(ctx, cApdu, cApduLen);
+                break;
+
+            case NDEF_T4T_CE_INS_READ_BINARY:
+                sw = ndefT4TCeReadBinary(ctx, cApdu, cApduLen, rApdu, rApduBufLen, rApduLen);
+                break;
+
+            case NDEF_T4T_CE_INS_UPDATE_BINARY:
+                sw = ndefT4TCeUpdateBinary(ctx, cApdu, cApduLen);
+                break;
+
+            default:
+                sw = ndefT4TCeSwInsNotSupp;
+                break;
+        }
+    }
+
+    /* No status word to add: the precomputed response already carries it */
+    if( sw != NULL )
+    {
+        if( sw != ndefT4TCeSwOk )
+        {
+            ctx->stats.errCnt++;
+        }
+        rApdu[*rApduLen]      = sw[0];
+        rApdu[*rApduLen + 1U] = sw[1];
+        *rApduLen            += NDEF_T4T_CE_SW_LEN;
+    }
+
+    return ERR_NONE;
+}
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static const uint8_t *ndefT4TCeSelect(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen)
+{
+    uint8_t  lc;
+    uint16_t fid;
+
+    if( cApduLen < NDEF_T4T_CE_DATA_POS )
+    {
+        return ndefT4TCeSwWrongLength;
+    }
+
+    lc = cApdu[NDEF_T4T_CE_LC_POS];
+    if( cApduLen < ((uint16_t)NDEF_T4T_CE_DATA_POS + lc) )
+    {
+        return ndefT4TCeSwWrongLength;
+    }
+
+    switch( cApdu[NDEF_T4T_CE_P1_POS] )
+    {
+        /*******************************************************************************/
+        case NDEF_T4T_CE_P1_SELECT_BY_NAME:
+            if( (lc == sizeof(ndefT4TCeAidNdef)) && (ST_BYTECMP(&cApdu[NDEF_T4T_CE_DATA_POS], ndefT4TCeAidNdef, sizeof(ndefT4TCeAidNdef)) == 0) )
+            {
+                ctx->selected = NDEF_T4T_CE_SEL_APP;
+                return ndefT4TCeSwOk;
+            }
+            /* Unknown application: the current one is kept   ISO 7816-4 */
+            return ndefT4TCeSwNotFound;
+
+        /*******************************************************************************/
+        case NDEF_T4T_CE_P1_SELECT_BY_FID:
+            if( lc != NDEF_T4T_CE_FID_LEN )
+            {
+                return ndefT4TCeSwWrongLength;
+            }
+            if( ctx->selected == NDEF_T4T_CE_SEL_NONE )
+            {
+                return ndefT4TCeSwNotFound;
+            }
+
+            fid = GETU16(&cApdu[NDEF_T4T_CE_DATA_POS]);
+            if( fid == NDEF_T4T_CE_FID_CC )
+            {
+                ctx->selected = NDEF_T4T_CE_SEL_CC;
+                return ndefT4TCeSwOk;
+            }
+            if( fid == NDEF_T4T_CE_NDEF_FID )
+            {
+                ctx->selected = NDEF_T4T_CE_SEL_NDEF;
+                return ndefT4TCeSwOk;
+            }
+            return ndefT4TCeSwNotFound;
+
+        /*******************************************************************************/
+        default:
+            return ndefT4TCeSwWrongP1P2;
+    }
+}
+
+
+/*******************************************************************************/
+static const uint8_t *ndefT4TCeReadBinary(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen, uint8_t *rApdu, uint16_t rApduBufLen, uint16_t *rApduLen)
+{
+    const uint8_t *file;
+    uint16_t       fileLen;
+    uint16_t       offset;
+    uint16_t       le;
+    uint16_t       len;
+
+    if( cApduLen != NDEF_T4T_CE_DATA_POS )
+    {
+        return ndefT4TCeSwWrongLength;
+    }
+
+    if( ctx->selected == NDEF_T4T_CE_SEL_CC )
+    {
+        file    = ctx->ccRsp;
+        fileLen = NDEF_T4T_CE_CCFILE_LEN;
+    }
+    else if( ctx->selected == NDEF_T4T_CE_SEL_NDEF )
+    {
+        file    = ctx->ndefFile;
+        fileLen = ctx->ndefFileLen;
+    }
+    else
+    {
+        return ndefT4TCeSwNoCurrentEF;
+    }
+
+    offset = GETU16(&cApdu[NDEF_T4T_CE_P1_POS]);
+    if( (offset > NDEF_T4T_CE_OFFSET_MASK) || (offset > fileLen) )
+    {
+        return ndefT4TCeSwWrongOffset;
+    }
+
+    le  = ( (cApdu[NDEF_T4T_CE_LC_POS] == 0U) ? NDEF_T4T_CE_LE_MAX : (uint16_t)cApdu[NDEF_T4T_CE_LC_POS] );
+    len = MIN( le, (fileLen - offset) );
+    len = MIN( len, (rApduBufLen - NDEF_T4T_CE_SW_LEN) );
+
+    ctx->stats.readCnt++;
+    ctx->stats.readBytes += len;
+
+    /* Whole CC file: the precomputed response includes the status word */
+    if( (file == ctx->ccRsp) && (offset == 0U) && (len == NDEF_T4T_CE_CCFILE_LEN) )
+    {
+        ST_MEMCPY(rApdu, ctx->ccRsp, sizeof(ctx->ccRsp));
+        *rApduLen = (uint16_t)sizeof(ctx->ccRsp);
+        return NULL;
+    }
+
+    /* Body copied once, from the image straight into the R-APDU */
+    if( len > 0U )
+    {
+        ST_MEMCPY(rApdu, &file[offset], len);
+    }
+    *rApduLen = len;
+
+    return ndefT4TCeSwOk;
+}
+
+
+/*******************************************************************************/
+static const uint8_t *ndefT4TCeUpdateBinary(ndefT4tCeContext *ctx, const uint8_t *cApdu, uint16_t cApduLen)
+{
+    uint16_t offset;
+    uint8_t  lc;
+
+    if( ctx->selected != NDEF_T4T_CE_SEL_NDEF )
+    {
+        return ( (ctx->selected == NDEF_T4T_CE_SEL_CC) ? ndefT4TCeSwSecurity : ndefT4TCeSwNoCurrentEF );
+    }
+
+    if( ctx->readOnly )
+    {
+        return ndefT4TCeSwSecurity;
+    }
+
+    if( cApduLen < NDEF_T4T_CE_DATA_POS )
+    {
+        return ndefT4TCeSwWrongLength;
+    }
+
+    lc = cApdu[NDEF_T4T_CE_LC_POS];
+    if( cApduLen < ((uint16_t)NDEF_T4T_CE_DATA_POS + lc) )
+    {
+        return ndefT4TCeSwWrongLength;
+    }
+
+    offset = GETU16(&cApdu[NDEF_T4T_CE_P1_POS]);
+    if( (offset > NDEF_T4T_CE_OFFSET_MASK) || (((uint32_t)offset + lc) > ctx->ndefFileLen) )
+    {
+        return ndefT4TCeSwWrongOffset;
+    }
+
+    if( lc > 0U )
+    {
+        ST_MEMCPY(&ctx->ndefFile[offset], &cApdu[NDEF_T4T_CE_DATA_POS], lc);
+    }
+
+    ctx->stats.updateCnt++;
+    ctx->stats.updateBytes += lc;
+
+    return ndefT4TCeSwOk;
+}
+
+#endif /* NDEF_FEATURE_T4T_CE */
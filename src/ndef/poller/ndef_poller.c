@@ -42,6 +42,7 @@
 #include "ndef_t5t_hal.h"
 #include "ndef_t5t.h"
 #include "utils.h"
+#include "rfal_stats.h"
 
 /*
  ******************************************************************************
@@ -247,6 +248,9 @@ ndefStatus ndefPollerContextInitialization(ndefContext *ctx, const ndefDevice *d
 
     ctx->ndefPollWrapper = ndefPollerWrappers[type];
 
+    /* No retry unless the tag type installs its default policy */
+    ndefPollerRetryInit(ctx, NULL);
+
     /* ndefPollWrapper is NULL when support of a given tag type is not enabled */
     if( (ctx->ndefPollWrapper == NULL) || (ctx->ndefPollWrapper->pollerContextInitialization == NULL) )
     {
@@ -274,7 +278,17 @@ ndefStatus ndefPollerNdefDetect(ndefContext *ctx, ndefInfo *info)
         return ERR_NOTSUPP;
     }
 
+#if RFAL_FEATURE_STATS
+    {
+        uint32_t   start = rfalStatsOpStart();
+        ndefStatus ret   = (ctx->ndefPollWrapper->pollerNdefDetect)(ctx, info);
+
+        rfalStatsOpEnd(RFAL_STATS_OP_NDEF_DETECT, start, (ret == ERR_NONE));
+        return ret;
+    }
+#else
     return (ctx->ndefPollWrapper->pollerNdefDetect)(ctx, info);
+#endif /* RFAL_FEATURE_STATS */
 }
 
 /*******************************************************************************/
@@ -295,7 +309,17 @@ ndefStatus ndefPollerReadRawMessage(ndefContext *ctx, uint8_t *buf, uint32_t buf
         return ERR_NOTSUPP;
     }
 
+#if RFAL_FEATURE_STATS
+    {
+        uint32_t   start = rfalStatsOpStart();
+        ndefStatus ret   = (ctx->ndefPollWrapper->pollerReadRawMessage)(ctx, buf, bufLen, rcvdLen, single);
+
+        rfalStatsOpEnd(RFAL_STATS_OP_NDEF_READ, start, (ret == ERR_NONE));
+        return ret;
+    }
+#else
     return (ctx->ndefPollWrapper->pollerReadRawMessage)(ctx, buf, bufLen, rcvdLen, single);
+#endif /* RFAL_FEATURE_STATS */
 }
 
 /*******************************************************************************/
@@ -339,7 +363,17 @@ ndefStatus ndefPollerWriteRawMessage(ndefContext *ctx, const uint8_t *buf, uint3
         return ERR_NOTSUPP;
     }
 
+#if RFAL_FEATURE_STATS
+    {
+        uint32_t   start = rfalStatsOpStart();
+        ndefStatus ret   = (ctx->ndefPollWrapper->pollerWriteRawMessage)(ctx, buf, bufLen);
+
+        rfalStatsOpEnd(RFAL_STATS_OP_NDEF_WRITE, start, (ret == ERR_NONE));
+        return ret;
+    }
+#else
     return (ctx->ndefPollWrapper->pollerWriteRawMessage)(ctx, buf, bufLen);
+#endif /* RFAL_FEATURE_STATS */
 }
 
 /*******************************************************************************/
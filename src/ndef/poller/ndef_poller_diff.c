@@ -0,0 +1,477 @@
+/******************************************************************************
+  * @attention
+  *
+  * COPYRIGHT 2019 STMicroelectronics, all rights reserved
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Provides NDEF methods and definitions to access NFC Forum Tags
+ *
+ *  This module provides the differential write of a raw NDEF message: the
+ *  new message is compared block by block with the message on the tag (a
+ *  copy cached by the application, or read from the tag) and only the
+ *  blocks that differ are written, contiguous blocks in one write call.
+ *  The L-field (T2T/T5T TLV, T4T NLEN/ENLEN, T3T WriteFlag and Ln) is reset
+ *  before the first block written and set after the last one, so a reader
+ *  sees either the old message, an empty one, or the new one.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_poller.h"
+#include "utils.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_DIFF_TLV_T_LEN             1U     /*!< NDEF Message TLV T length                         */
+#define NDEF_DIFF_TLV_L_3_BYTES      0xFFU     /*!< First byte of a 3-byte L-field                    */
+#define NDEF_DIFF_T2T_BLOCK_LEN         4U     /*!< T2T block length                                  */
+#define NDEF_DIFF_T3T_BLOCK_LEN        16U     /*!< T3T block length                                  */
+#define NDEF_DIFF_T4T_BLOCK_LEN        16U     /*!< T4T compare unit: no blocks, a common EEPROM page */
+#define NDEF_DIFF_HEAD_LEN             64U     /*!< Blocks holding the TLV header: two T5T blocks max */
+#define NDEF_DIFF_CHUNK_LEN            64U     /*!< Tag bytes read per compare step                   */
+
+/*
+ *****************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Differential write state */
+typedef struct {
+    ndefContext*                 ctx;                          /*!< ndef Context                                       */
+    ndefDiffStats*               stats;                        /*!< Statistics of the write                            */
+    const uint8_t*               buf;                          /*!< New message                                        */
+    uint32_t                     len;                          /*!< New message length                                 */
+    const uint8_t*               cur;                          /*!< Cached current message, NULL: read from the tag    */
+    uint32_t                     curLen;                       /*!< Cached current message length                      */
+    uint32_t                     unit;                         /*!< Block length                                       */
+    uint32_t                     msgOffset;                    /*!< Message offset on the tag                          */
+    uint32_t                     end;                          /*!< End of the message and of its Terminator TLV       */
+    bool                         term;                         /*!< Terminator TLV after the message                   */
+    bool                         tlv;                          /*!< L-field in a TLV header (T2T, T5T)                 */
+    bool                         lReset;                       /*!< L-field reset done                                 */
+    uint32_t                     headStart;                    /*!< TLV: first block holding the header                */
+    uint32_t                     headLen;                      /*!< TLV: length of the blocks holding the header       */
+    uint8_t                      head[NDEF_DIFF_HEAD_LEN];     /*!< TLV: blocks holding the header, new content        */
+    uint32_t                     chunkStart;                   /*!< Offset of the tag bytes read                       */
+    uint32_t                     chunkLen;                     /*!< Length of the tag bytes read                       */
+    uint8_t                      chunk[NDEF_DIFF_CHUNK_LEN];   /*!< Tag bytes read                                     */
+} ndefDiffContext;
+
+/*
+ ******************************************************************************
+ * GLOBAL MACROS
+ ******************************************************************************
+ */
+
+#define ndefDiffAlignDown(v, u)   (((v) / (u)) * (u))                         /*!< Round down to a block start */
+#define ndefDiffAlignUp(v, u)     (((((v) + (u)) - 1U) / (u)) * (u))          /*!< Round up to a block start   */
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+#if NDEF_FEATURE_FULL_API
+static ndefStatus ndefPollerDiffWrite(ndefDiffContext *dc, uint32_t offset, const uint8_t *buf, uint32_t len, bool pad, bool writeTerminator);
+static ndefStatus ndefPollerDiffResetL(ndefDiffContext *dc);
+static ndefStatus ndefPollerDiffCompare(ndefDiffContext *dc, uint32_t start, uint32_t end, bool *differs);
+static ndefStatus ndefPollerDiffFlush(ndefDiffContext *dc, uint32_t start, uint32_t end);
+#endif /* NDEF_FEATURE_FULL_API */
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+#if NDEF_FEATURE_FULL_API
+
+/*******************************************************************************/
+static uint8_t ndefPollerDiffNewByte(const ndefDiffContext *dc, uint32_t offset)
+{
+    return ( (offset < (dc->msgOffset + dc->len)) ? dc->buf[offset - dc->msgOffset] : NDEF_TERMINATOR_TLV_T );
+}
+
+
+/*******************************************************************************/
+static ndefStatus ndefPollerDiffWrite(ndefDiffContext *dc, uint32_t offset, const uint8_t *buf, uint32_t len, bool pad, bool writeTerminator)
+{
+    uint32_t last = offset + len + (writeTerminator ? NDEF_TERMINATOR_TLV_LEN : 0U);
+
+    dc->stats->written += ( (ndefDiffAlignUp(last, dc->unit) - ndefDiffAlignDown(offset, dc->unit)) / dc->unit );
+    return (dc->ctx->ndefPollWrapper->pollerWriteBytes)(dc->ctx, offset, buf, len, pad, writeTerminator);
+}
+
+
+/*******************************************************************************/
+static ndefStatus ndefPollerDiffResetL(ndefDiffContext *dc)
+{
+    ndefStatus err;
+    uint8_t    zeroHead[NDEF_DIFF_HEAD_LEN];
+    uint32_t   lOffset;
+
+    if( dc->lReset )
+    {
+        return ERR_NONE;
+    }
+    dc->lReset = true;
+
+    if( !dc->tlv )
+    {
+        /* T3T WriteFlag ON, T4T NLEN (resp. ENLEN) to 0 */
+        dc->stats->written++;
+        return ndefPollerBeginWriteMessage(dc->ctx, dc->len);
+    }
+
+    /* Header blocks with L = 0 and a Terminator TLV right after it, new message bytes */
+    (void)ST_MEMCPY(zeroHead, dc->head, dc->headLen);
+    lOffset = (dc->msgOffset - ((dc->len > NDEF_SHORT_VFIELD_MAX_LEN) ? 3U : 1U)) - dc->headStart;
+    (void)ST_MEMSET(&zeroHead[lOffset], 0x00, (dc->msgOffset - dc->headStart) - lOffset);
+    if( (lOffset + 1U) < dc->headLen )
+    {
+        zeroHead[lOffset + 1U] = NDEF_TERMINATOR_TLV_T;
+    }
+    err = ndefPollerDiffWrite(dc, dc->headStart, zeroHead, dc->headLen, false, false);
+    return err;
+}
+
+
+/*******************************************************************************/
+static ndefStatus ndefPollerDiffCompare(ndefDiffContext *dc, uint32_t start, uint32_t end, bool *differs)
+{
+    ndefStatus err;
+    uint32_t   offset;
+    uint32_t   rcvdLen;
+    uint8_t    cur;
+
+    *differs = false;
+    for( offset = start; offset < end; offset++ )
+    {
+        if( dc->cur != NULL )
+        {
+            if( offset < (dc->msgOffset + dc->curLen) )
+            {
+                cur = dc->cur[offset - dc->msgOffset];
+            }
+            else if( (offset == (dc->msgOffset + dc->curLen)) && (dc->curLen == dc->len) )
+            {
+                /* Same length: the Terminator TLV, if any, is where it was */
+                continue;
+            }
+            else
+            {
+                *differs = true;
+                return ERR_NONE;
+            }
+        }
+        else
+        {
+            if( (offset < dc->chunkStart) || (offset >= (dc->chunkStart + dc->chunkLen)) )
+            {
+                dc->chunkStart = ndefDiffAlignDown(offset, dc->unit);
+                dc->chunkLen   = MIN( ndefDiffAlignDown(NDEF_DIFF_CHUNK_LEN, dc->unit), ndefDiffAlignUp(dc->end, dc->unit) - dc->chunkStart );
+                rcvdLen        = 0U;
+                err = (dc->ctx->ndefPollWrapper->pollerReadBytes)(dc->ctx, dc->chunkStart, dc->chunkLen, dc->chunk, &rcvdLen);
+                if( err != ERR_NONE )
+                {
+                    return err;
+                }
+                dc->chunkLen = MIN( dc->chunkLen, rcvdLen );
+                if( offset >= (dc->chunkStart + dc->chunkLen) )
+                {
+                    *differs = true;
+                    return ERR_NONE;
+                }
+            }
+            cur = dc->chunk[offset - dc->chunkStart];
+        }
+
+        if( cur != ndefPollerDiffNewByte(dc, offset) )
+        {
+            *differs = true;
+            return ERR_NONE;
+        }
+    }
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ndefStatus ndefPollerDiffFlush(ndefDiffContext *dc, uint32_t start, uint32_t end)
+{
+    ndefStatus err;
+    uint32_t   dataEnd = MIN( end, dc->msgOffset + dc->len );
+    bool       last    = (end >= dc->end);
+    uint8_t    termBuf = NDEF_TERMINATOR_TLV_T;
+
+    err = ndefPollerDiffResetL(dc);
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    if( dataEnd > start )
+    {
+        /* Last blocks padded (no read), Terminator TLV placed after the message */
+        return ndefPollerDiffWrite(dc, start, &dc->buf[start - dc->msgOffset], dataEnd - start, last, (last && dc->term));
+    }
+    /* Only the Terminator TLV, first byte of its block */
+    return ndefPollerDiffWrite(dc, start, &termBuf, NDEF_TERMINATOR_TLV_LEN, true, false);
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerWriteRawMessageDiff(ndefContext *ctx, const uint8_t *buf, uint32_t bufLen, const uint8_t *cur, uint32_t curLen, ndefDiffStats *stats)
+{
+    ndefStatus      err       = ERR_NONE;
+    ndefDiffContext dc;
+    ndefDiffStats   lStats;
+    uint8_t         curHead[NDEF_DIFF_HEAD_LEN];
+    uint32_t        tlvOffset = 0U;
+    uint32_t        bodyStart;
+    uint32_t        blockStart;
+    uint32_t        runStart  = 0U;
+    uint32_t        runEnd    = 0U;
+    uint32_t        rcvdLen   = 0U;
+    uint32_t        offset;
+    uint32_t        i;
+    bool            run       = false;
+    bool            differs;
+    bool            full      = false;
+
+    if( (ctx == NULL) || ((buf == NULL) && (bufLen != 0U)) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( (ctx->ndefPollWrapper == NULL) || ((ctx->state != NDEF_STATE_INITIALIZED) && (ctx->state != NDEF_STATE_READWRITE)) )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    if( (ctx->ndefPollWrapper->pollerWriteBytes == NULL) || (ctx->ndefPollWrapper->pollerReadBytes == NULL) )
+    {
+        return ERR_NOTSUPP;
+    }
+
+    (void)ST_MEMSET(&dc, 0x00, sizeof(dc));
+    dc.stats = ( (stats != NULL) ? stats : &lStats );
+    (void)ST_MEMSET(dc.stats, 0x00, sizeof(ndefDiffStats));
+    dc.ctx    = ctx;
+    dc.buf    = buf;
+    dc.len    = bufLen;
+    dc.cur    = ( (curLen == ctx->messageLen) ? cur : NULL );   /* A stale cache is not used */
+    dc.curLen = curLen;
+
+    if( ndefPollerCheckAvailableSpace(ctx, bufLen) != ERR_NONE )
+    {
+        return ERR_PARAM;
+    }
+
+    switch( ctx->type )
+    {
+#if NDEF_FEATURE_T2T
+        case NDEF_DEV_T2T:
+            dc.unit   = NDEF_DIFF_T2T_BLOCK_LEN;
+            dc.tlv    = true;
+            tlvOffset = ctx->subCtx.t2t.offsetNdefTLV;
+            break;
+#endif
+#if NDEF_FEATURE_T3T
+        case NDEF_DEV_T3T:
+            dc.unit   = NDEF_DIFF_T3T_BLOCK_LEN;
+            break;
+#endif
+#if NDEF_FEATURE_T4T
+        case NDEF_DEV_T4T:
+            dc.unit   = NDEF_DIFF_T4T_BLOCK_LEN;
+            break;
+#endif
+#if NDEF_FEATURE_T5T
+        case NDEF_DEV_T5T:
+            dc.unit   = ctx->subCtx.t5t.blockLen;
+            dc.tlv    = true;
+            tlvOffset = ctx->subCtx.t5t.TlvNDEFOffset;
+            break;
+#endif
+        default:
+            full = true;
+            break;
+    }
+
+    /* No message to compare with, or a longer/shorter L-field moving the message */
+    if( (ctx->state != NDEF_STATE_READWRITE) || (bufLen == 0U) || (dc.unit == 0U) ||
+        (dc.tlv && ((bufLen > NDEF_SHORT_VFIELD_MAX_LEN) != (ctx->messageLen > NDEF_SHORT_VFIELD_MAX_LEN))) )
+    {
+        full = true;
+    }
+
+    dc.msgOffset = ctx->messageOffset;
+    dc.term      = ( dc.tlv && (ndefPollerCheckAvailableSpace(ctx, bufLen + NDEF_TERMINATOR_TLV_LEN) == ERR_NONE) );
+    dc.end       = dc.msgOffset + bufLen + (dc.term ? NDEF_TERMINATOR_TLV_LEN : 0U);
+
+#if NDEF_FEATURE_T2T
+    if( !full && (ctx->type == NDEF_DEV_T2T) )
+    {
+        /* Offsets are physical only up to the first reserved area (lock or memory control) */
+        for( i = 0U; i < ctx->subCtx.t2t.nbrRsvdAreas; i++ )
+        {
+            if( ctx->subCtx.t2t.rsvdAreaFirstByteAddr[i] < ndefDiffAlignUp(dc.end, dc.unit) )
+            {
+                full = true;
+            }
+        }
+    }
+#endif
+
+    if( full )
+    {
+        /* Tag type raw message write: every block of the message */
+        if( dc.unit != 0U )
+        {
+            dc.stats->blocks  = (ndefDiffAlignUp(ctx->messageOffset + bufLen, dc.unit) - ndefDiffAlignDown(ctx->messageOffset, dc.unit)) / dc.unit;
+            dc.stats->written = dc.stats->blocks;
+        }
+        dc.stats->full = true;
+        return ndefPollerWriteRawMessage(ctx, buf, bufLen);
+    }
+
+    bodyStart = dc.msgOffset;
+    if( dc.tlv )
+    {
+        /* Blocks holding T and L: read, then built with the new L-field and message bytes */
+        dc.headStart = ndefDiffAlignDown(tlvOffset, dc.unit);
+        dc.headLen   = ndefDiffAlignUp(dc.msgOffset, dc.unit) - dc.headStart;
+        if( dc.headLen > NDEF_DIFF_HEAD_LEN )
+        {
+            return ERR_NOTSUPP;
+        }
+        err = (ctx->ndefPollWrapper->pollerReadBytes)(ctx, dc.headStart, dc.headLen, curHead, &rcvdLen);
+        if( (err != ERR_NONE) || (rcvdLen != dc.headLen) )
+        {
+            return ( (err != ERR_NONE) ? err : ERR_PROTO );
+        }
+        (void)ST_MEMCPY(dc.head, curHead, dc.headLen);
+        offset = dc.msgOffset - dc.headStart;
+        if( bufLen > NDEF_SHORT_VFIELD_MAX_LEN )
+        {
+            dc.head[offset - 3U] = NDEF_DIFF_TLV_L_3_BYTES;
+            dc.head[offset - 2U] = (uint8_t)(bufLen >> 8U);
+        }
+        dc.head[offset - 1U] = (uint8_t)bufLen;
+        for( i = dc.msgOffset; (i < (dc.headStart + dc.headLen)) && (i < dc.end); i++ )
+        {
+            dc.head[i - dc.headStart] = ndefPollerDiffNewByte(&dc, i);
+        }
+        bodyStart = dc.headStart + dc.headLen;
+    }
+    dc.stats->blocks = (ndefDiffAlignUp(dc.end, dc.unit) - ndefDiffAlignDown((dc.tlv ? dc.headStart : dc.msgOffset), dc.unit)) / dc.unit;
+
+    /* Message blocks: contiguous differing blocks written in one call */
+    for( blockStart = ndefDiffAlignDown(bodyStart, dc.unit); blockStart < dc.end; blockStart += dc.unit )
+    {
+        offset = MAX( blockStart, bodyStart );
+        err    = ndefPollerDiffCompare(&dc, offset, MIN( blockStart + dc.unit, dc.end ), &differs);
+        if( err != ERR_NONE )
+        {
+            break;
+        }
+        if( differs )
+        {
+            runStart = ( run ? runStart : offset );
+            runEnd   = MIN( blockStart + dc.unit, dc.end );
+            run      = true;
+        }
+        else if( run )
+        {
+            err = ndefPollerDiffFlush(&dc, runStart, runEnd);
+            run = false;
+            if( err != ERR_NONE )
+            {
+                break;
+            }
+        }
+        else
+        {
+            /* MISRA 15.7 - Empty else */
+        }
+    }
+    if( (err == ERR_NONE) && run )
+    {
+        err = ndefPollerDiffFlush(&dc, runStart, runEnd);
+    }
+
+    /* L-field value last; nothing at all when the message is the same */
+    if( (err == ERR_NONE) && (dc.lReset || (bufLen != ctx->messageLen) || (dc.tlv && (ST_BYTECMP(dc.head, curHead, dc.headLen) != 0))) )
+    {
+        err = ndefPollerDiffResetL(&dc);
+        if( err == ERR_NONE )
+        {
+            if( dc.tlv )
+            {
+                err = ndefPollerDiffWrite(&dc, dc.headStart, dc.head, dc.headLen, false, false);
+            }
+            else
+            {
+                /* T3T Ln and WriteFlag OFF, T4T NLEN (resp. ENLEN) */
+                dc.stats->written++;
+                err = ndefPollerEndWriteMessage(ctx, bufLen);
+            }
+        }
+    }
+
+    if( err != ERR_NONE )
+    {
+        /* Conclude procedure */
+        ctx->state = ( dc.lReset ? NDEF_STATE_INVALID : ctx->state );
+        return err;
+    }
+
+    /* Procedure complete: Set Read/Write state */
+    ctx->messageLen = bufLen;
+    ctx->state      = NDEF_STATE_READWRITE;
+
+    return ERR_NONE;
+}
+
+#endif /* NDEF_FEATURE_FULL_API */
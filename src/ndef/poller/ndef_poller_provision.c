@@ -0,0 +1,394 @@
+/******************************************************************************
+  * @attention
+  *
+  * COPYRIGHT 2019 STMicroelectronics, all rights reserved
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief Provides NDEF methods and definitions to access NFC Forum Tags
+ *
+ *  This module provides the batch provisioning of tags: the NDEF message is
+ *  encoded once into an image, the per tag fields are patched in place, and
+ *  the image is written with its length field (TLV header for T2T/T5T, NLEN
+ *  or ENLEN for T4T) as one stream of full write commands.
+ *  The L-field is first written to 0 along with the first bytes of the
+ *  image, then the rest of the image, then the L-field value: the order of
+ *  the tag type write procedures, without their read-modify-write of the
+ *  blocks holding the L-field.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_poller.h"
+#include "ndef_t4t.h"
+#include "utils.h"
+#include "rfal_stats.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_PROVISION_TLV_T           0x03U     /*!< NDEF Message TLV T                                */
+#define NDEF_PROVISION_TLV_T_LEN          1U     /*!< NDEF Message TLV T length                         */
+#define NDEF_PROVISION_TLV_L_3_BYTES   0xFFU     /*!< First byte of a 3-byte L-field                    */
+#define NDEF_PROVISION_T2T_BLOCK_LEN      4U     /*!< T2T block length                                  */
+#define NDEF_PROVISION_T4T_NLEN_LEN       2U     /*!< NLEN length (mapping version 2.0)                 */
+#define NDEF_PROVISION_T4T_ENLEN_LEN      4U     /*!< ENLEN length (mapping version 3.0)                */
+
+/*
+ *****************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*! Layout of an image on the tag in the field */
+typedef struct {
+    uint8_t*                     image;                        /*!< Image start in the image buffer                    */
+    uint32_t                     imageLen;                     /*!< Image length: header, message, terminator TLV      */
+    uint32_t                     start;                        /*!< Offset of the image on the tag                     */
+    uint32_t                     lOffset;                      /*!< Offset of the L-field in the image                 */
+    uint32_t                     lLen;                         /*!< L-field length                                     */
+    uint32_t                     headLen;                      /*!< Image bytes written with the L-field set to 0      */
+    uint32_t                     hdrLen;                       /*!< Header length: message offset in the image         */
+} ndefProvisionLayout;
+
+/*
+ ******************************************************************************
+ * GLOBAL MACROS
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+#if NDEF_FEATURE_FULL_API
+static bool ndefPollerProvisionLayout(const ndefContext *ctx, ndefProvisionImage *image, ndefProvisionLayout *lay);
+static ndefStatus ndefPollerProvisionStream(ndefContext *ctx, ndefProvisionLayout *lay);
+#endif /* NDEF_FEATURE_FULL_API */
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+#if NDEF_FEATURE_FULL_API
+
+/*******************************************************************************/
+static uint32_t ndefPollerProvisionRoundUp(uint32_t value, uint32_t unit)
+{
+    return (((value + unit) - 1U) / unit) * unit;
+}
+
+
+/*******************************************************************************/
+static bool ndefPollerProvisionLayout(const ndefContext *ctx, ndefProvisionImage *image, ndefProvisionLayout *lay)
+{
+    uint8_t* buf = image->buffer;
+    uint32_t len = image->messageLen;
+    uint32_t unit;
+    uint32_t i;
+
+    switch( ctx->type )
+    {
+#if NDEF_FEATURE_T2T
+        case NDEF_DEV_T2T:
+            lay->start = ctx->subCtx.t2t.offsetNdefTLV;
+            unit       = NDEF_PROVISION_T2T_BLOCK_LEN;
+            break;
+#endif
+#if NDEF_FEATURE_T5T
+        case NDEF_DEV_T5T:
+            lay->start = ctx->subCtx.t5t.TlvNDEFOffset;
+            unit       = ctx->subCtx.t5t.blockLen;
+            break;
+#endif
+#if NDEF_FEATURE_T4T
+        case NDEF_DEV_T4T:
+            /* NLEN (resp. ENLEN) then the message: the first UPDATE BINARY also carries the first message bytes */
+            lay->lLen     = ( ndefMajorVersion(ctx->cc.t4t.vNo) == ndefMajorVersion(NDEF_T4T_MAPPING_VERSION_3_0) ) ? NDEF_PROVISION_T4T_ENLEN_LEN : NDEF_PROVISION_T4T_NLEN_LEN;
+            lay->hdrLen   = lay->lLen;
+            lay->lOffset  = 0U;
+            lay->start    = 0U;
+            lay->image    = &buf[NDEF_PROVISION_HEADER_LEN - lay->hdrLen];
+            lay->imageLen = lay->hdrLen + len;
+            lay->headLen  = MIN( (uint32_t)ctx->subCtx.t4t.curMLc, lay->imageLen );
+            for( i = 0U; i < lay->lLen; i++ )
+            {
+                lay->image[i] = (uint8_t)(len >> (8U * (lay->lLen - 1U - i)));
+            }
+            return true;
+#endif
+        default:
+            /* T3T: Ln is in the Attribute Information Block, the raw message write already streams Nbw blocks */
+            return false;
+    }
+
+    if( unit == 0U )
+    {
+        return false;
+    }
+
+    /* T2T/T5T: NDEF Message TLV, then Terminator TLV if room for it */
+    lay->lOffset = NDEF_PROVISION_TLV_T_LEN;
+    if( len <= NDEF_SHORT_VFIELD_MAX_LEN )
+    {
+        lay->lLen = 1U;
+        buf[NDEF_PROVISION_HEADER_LEN - 1U] = (uint8_t)len;
+    }
+    else
+    {
+        lay->lLen = 3U;
+        buf[NDEF_PROVISION_HEADER_LEN - 3U] = NDEF_PROVISION_TLV_L_3_BYTES;
+        buf[NDEF_PROVISION_HEADER_LEN - 2U] = (uint8_t)(len >> 8U);
+        buf[NDEF_PROVISION_HEADER_LEN - 1U] = (uint8_t)len;
+    }
+    lay->hdrLen   = lay->lOffset + lay->lLen;
+    lay->image    = &buf[NDEF_PROVISION_HEADER_LEN - lay->hdrLen];
+    lay->image[0] = NDEF_PROVISION_TLV_T;
+    lay->imageLen = lay->hdrLen + len;
+    if( ndefPollerCheckAvailableSpace(ctx, len + NDEF_TERMINATOR_TLV_LEN) == ERR_NONE )
+    {
+        buf[NDEF_PROVISION_HEADER_LEN + len] = NDEF_TERMINATOR_TLV_T;
+        lay->imageLen++;
+    }
+
+    /* Blocks holding the TLV header: written first with L = 0, rewritten last */
+    lay->headLen = MIN( ndefPollerProvisionRoundUp(lay->start + lay->hdrLen, unit) - lay->start, lay->imageLen );
+
+#if NDEF_FEATURE_T2T
+    if( ctx->type == NDEF_DEV_T2T )
+    {
+        /* Offsets are physical only up to the first reserved area (lock or memory control) */
+        for( i = 0U; i < ctx->subCtx.t2t.nbrRsvdAreas; i++ )
+        {
+            if( ctx->subCtx.t2t.rsvdAreaFirstByteAddr[i] < (lay->start + lay->imageLen) )
+            {
+                return false;
+            }
+        }
+    }
+#endif
+
+    return true;
+}
+
+
+/*******************************************************************************/
+static ndefStatus ndefPollerProvisionStream(ndefContext *ctx, ndefProvisionLayout *lay)
+{
+    ndefStatus err;
+    uint8_t    lField[NDEF_PROVISION_HEADER_LEN];
+    uint8_t    next;
+    uint32_t   lastLen;
+    bool       tlv  = (ctx->type != NDEF_DEV_T4T);
+
+    /* L-field to 0 along with the first bytes; a TLV also gets a Terminator TLV right after it */
+    next = lay->image[lay->lOffset + 1U];
+    (void)ST_MEMCPY(lField, &lay->image[lay->lOffset], lay->lLen);
+    (void)ST_MEMSET(&lay->image[lay->lOffset], 0x00, lay->lLen);
+    if( tlv && ((lay->lOffset + 1U) < lay->headLen) )
+    {
+        lay->image[lay->lOffset + 1U] = NDEF_TERMINATOR_TLV_T;
+    }
+    err = (ctx->ndefPollWrapper->pollerWriteBytes)(ctx, lay->start, lay->image, lay->headLen, (lay->headLen == lay->imageLen), false);
+    lay->image[lay->lOffset + 1U] = next;
+    (void)ST_MEMCPY(&lay->image[lay->lOffset], lField, lay->lLen);
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    if( lay->headLen < lay->imageLen )
+    {
+        err = (ctx->ndefPollWrapper->pollerWriteBytes)(ctx, lay->start + lay->headLen, &lay->image[lay->headLen], lay->imageLen - lay->headLen, true, false);
+        if( err != ERR_NONE )
+        {
+            return err;
+        }
+    }
+
+    /* L-field value: the whole blocks of the TLV header, NLEN alone */
+    lastLen = ( tlv ? lay->headLen : (lay->lOffset + lay->lLen) );
+    return (ctx->ndefPollWrapper->pollerWriteBytes)(ctx, lay->start, lay->image, lastLen, (lastLen == lay->imageLen), false);
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerProvisionInit(ndefProvisionImage *image, uint8_t *buf, uint32_t bufLen, const ndefMessage *message)
+{
+    ndefStatus      err;
+    ndefMessageInfo info;
+    ndefBuffer      bufPayload;
+
+    if( (image == NULL) || (buf == NULL) || (message == NULL) || (bufLen < NDEF_PROVISION_OVERHEAD) )
+    {
+        return ERR_PARAM;
+    }
+
+    (void)ndefMessageGetInfo(message, &info);
+    if( info.length > (bufLen - NDEF_PROVISION_OVERHEAD) )
+    {
+        return ERR_NOMEM;
+    }
+
+    bufPayload.buffer = &buf[NDEF_PROVISION_HEADER_LEN];
+    bufPayload.length = bufLen - NDEF_PROVISION_OVERHEAD;
+    err = ndefMessageEncode(message, &bufPayload);
+    if( err != ERR_NONE )
+    {
+        return err;
+    }
+
+    image->buffer     = buf;
+    image->bufferLen  = bufLen;
+    image->messageLen = bufPayload.length;
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerProvisionFind(const ndefProvisionImage *image, const uint8_t *pattern, uint32_t len, uint32_t *offset)
+{
+    const uint8_t* msg;
+    uint32_t       i;
+
+    if( (image == NULL) || (image->buffer == NULL) || (pattern == NULL) || (len == 0U) || (offset == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    msg = &image->buffer[NDEF_PROVISION_HEADER_LEN];
+    for( i = 0U; (i + len) <= image->messageLen; i++ )
+    {
+        if( ST_BYTECMP(&msg[i], pattern, len) == 0 )
+        {
+            *offset = i;
+            return ERR_NONE;
+        }
+    }
+
+    return ERR_NOTFOUND;
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerProvisionPatch(ndefProvisionImage *image, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if( (image == NULL) || (image->buffer == NULL) || (data == NULL) || (offset > image->messageLen) || (len > (image->messageLen - offset)) )
+    {
+        return ERR_PARAM;
+    }
+
+    (void)ST_MEMCPY(&image->buffer[NDEF_PROVISION_HEADER_LEN + offset], data, len);
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerProvisionWrite(ndefContext *ctx, ndefProvisionImage *image)
+{
+    ndefStatus          err;
+    ndefProvisionLayout lay;
+#if RFAL_FEATURE_STATS
+    uint32_t            start;
+#endif /* RFAL_FEATURE_STATS */
+
+    if( (ctx == NULL) || (image == NULL) || (image->buffer == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    if( ctx->ndefPollWrapper == NULL )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    if( ctx->ndefPollWrapper->pollerWriteBytes == NULL )
+    {
+        return ERR_NOTSUPP;
+    }
+
+    if( (ctx->state != NDEF_STATE_INITIALIZED) && (ctx->state != NDEF_STATE_READWRITE) )
+    {
+        return ERR_WRONG_STATE;
+    }
+
+    if( (image->messageLen == 0U) || !ndefPollerProvisionLayout(ctx, image, &lay) )
+    {
+        /* Empty message, T3T, T2T with reserved areas: tag type raw message write */
+        return ndefPollerWriteRawMessage(ctx, &image->buffer[NDEF_PROVISION_HEADER_LEN], image->messageLen);
+    }
+
+    /* Verify length of the NDEF message */
+    if( ndefPollerCheckAvailableSpace(ctx, image->messageLen) != ERR_NONE )
+    {
+        return ERR_PARAM;
+    }
+
+#if RFAL_FEATURE_STATS
+    start = rfalStatsOpStart();
+#endif /* RFAL_FEATURE_STATS */
+
+    err = ndefPollerProvisionStream(ctx, &lay);
+
+#if RFAL_FEATURE_STATS
+    rfalStatsOpEnd(RFAL_STATS_OP_NDEF_WRITE, start, (err == ERR_NONE));
+#endif /* RFAL_FEATURE_STATS */
+
+    if( err != ERR_NONE )
+    {
+        /* Conclude procedure */
+        ctx->state = NDEF_STATE_INVALID;
+        return err;
+    }
+
+    /* Procedure complete: Set Read/Write state */
+    ctx->messageOffset = lay.start + lay.hdrLen;
+    ctx->messageLen    = image->messageLen;
+    ctx->state         = NDEF_STATE_READWRITE;
+
+    return ERR_NONE;
+}
+
+#endif /* NDEF_FEATURE_FULL_API */
@@ -0,0 +1,250 @@
+/******************************************************************************
+  * @attention
+  *
+  * COPYRIGHT 2019 STMicroelectronics, all rights reserved
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*
+ *      PROJECT:   NDEF firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file
+ *
+ *  \author
+ *
+ *  \brief NDEF poller retry policy on link errors
+ *
+ *  This module provides the retry policy shared by the tag type pollers.
+ *  A failed command attempt is classified (transmission error, timeout,
+ *  collision) and retried while its class has a retry left on both the
+ *  command budget and the session budget, after the backoff of the class
+ *  and the remedial action the tag type poller is asked to take.
+ *  The session budget bounds the time a flaky tag takes from the discovery
+ *  window; a clean tag does not pay anything as the policy only applies on
+ *  errors.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_poller.h"
+#include "utils.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+/*
+ *****************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * GLOBAL MACROS
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+static ndefRetryClass ndefPollerRetryClassify(ReturnCode err);
+static void ndefPollerRetryReload(ndefRetryContext *rc);
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+void ndefPollerRetryInit(ndefContext *ctx, const ndefRetryPolicy *policy)
+{
+    (void)ST_MEMSET(&ctx->retry, 0x00, sizeof(ctx->retry));
+
+    ctx->retry.policy = policy;
+    ndefPollerRetryReload(&ctx->retry);
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerSetRetryPolicy(ndefContext *ctx, const ndefRetryPolicy *policy)
+{
+    if( ctx == NULL )
+    {
+        return ERR_PARAM;
+    }
+
+    ctx->retry.policy = policy;
+    ndefPollerRetryReload(&ctx->retry);
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ndefStatus ndefPollerGetRetryStats(const ndefContext *ctx, ndefRetryStats *stats)
+{
+    if( (ctx == NULL) || (stats == NULL) )
+    {
+        return ERR_PARAM;
+    }
+
+    (void)ST_MEMCPY(stats, &ctx->retry.stats, sizeof(ndefRetryStats));
+
+    return ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void ndefPollerRetryStart(ndefContext *ctx)
+{
+    (void)ST_MEMSET(ctx->retry.cmdRetry, 0x00, sizeof(ctx->retry.cmdRetry));
+}
+
+
+/*******************************************************************************/
+bool ndefPollerRetryCheck(ndefContext *ctx, ReturnCode err, ndefRetryAction *action)
+{
+    ndefRetryContext      *rc = &ctx->retry;
+    const ndefRetryPolicy *pol;
+    ndefRetryClass         cls;
+    uint32_t               backoff;
+    uint32_t               retries;
+    uint32_t               i;
+
+    *action = NDEF_RETRY_ACTION_NONE;
+    cls     = ndefPollerRetryClassify(err);
+
+    if( cls == NDEF_RETRY_CLASS_NUM )
+    {
+        if( err == RFAL_ERR_NONE )
+        {
+            retries = 0U;
+            for( i = 0U; i < (uint32_t)NDEF_RETRY_CLASS_NUM; i++ )
+            {
+                retries += rc->cmdRetry[i];
+            }
+            if( retries != 0U )
+            {
+                rc->stats.recoveredCnt++;
+            }
+        }
+        return false;
+    }
+
+    rc->stats.errCnt[cls]++;
+
+    if( rc->policy == NULL )
+    {
+        rc->stats.failedCnt++;
+        return false;
+    }
+
+    pol = &rc->policy[cls];
+
+    /* Command budget, then session budget: a flaky tag stops being retried */
+    if( (rc->cmdRetry[cls] >= pol->budget) || (rc->sessionLeft[cls] == 0U) )
+    {
+        rc->stats.failedCnt++;
+        return false;
+    }
+
+    rc->cmdRetry[cls]++;
+    rc->sessionLeft[cls]--;
+    rc->stats.retryCnt[cls]++;
+
+    /* Exponential backoff: leaves time for a transient disturbance to go */
+    if( pol->backoff != 0U )
+    {
+        backoff = pol->backoff;
+        for( i = 1U; (i < rc->cmdRetry[cls]) && (backoff < pol->backoffMax); i++ )
+        {
+            backoff <<= 1U;
+        }
+        backoff = MIN( backoff, MAX( (uint32_t)pol->backoff, (uint32_t)pol->backoffMax ) );
+
+        platformDelay( backoff );
+        rc->stats.backoffTime += backoff;
+    }
+
+    if( (pol->action != NDEF_RETRY_ACTION_NONE) && (pol->actionFrom != 0U) && (rc->cmdRetry[cls] >= pol->actionFrom) )
+    {
+        *action = pol->action;
+        rc->stats.actionCnt++;
+    }
+
+    return true;
+}
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static ndefRetryClass ndefPollerRetryClassify(ReturnCode err)
+{
+    switch( err )
+    {
+        case RFAL_ERR_CRC:
+        case RFAL_ERR_PAR:
+        case RFAL_ERR_FRAMING:
+            return NDEF_RETRY_CLASS_TRANSMISSION;
+
+        case RFAL_ERR_TIMEOUT:
+            return NDEF_RETRY_CLASS_TIMEOUT;
+
+        case RFAL_ERR_RF_COLLISION:
+            return NDEF_RETRY_CLASS_COLLISION;
+
+        default:
+            /* Success or not a link error: never retried */
+            return NDEF_RETRY_CLASS_NUM;
+    }
+}
+
+
+/*******************************************************************************/
+static void ndefPollerRetryReload(ndefRetryContext *rc)
+{
+    uint32_t i;
+
+    for( i = 0U; i < (uint32_t)NDEF_RETRY_CLASS_NUM; i++ )
+    {
+        rc->sessionLeft[i] = ((rc->policy != NULL) ? rc->policy[i].sessionBudget : 0U);
+        rc->cmdRetry[i]    = 0U;
+    }
+}
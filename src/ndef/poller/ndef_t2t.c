@@ -111,6 +111,8 @@
 
 #define NDEF_T2T_DYN_LOCK_BYTES_MAX   32U         /*!< Max number of Dyn Lock Bytes                      */
 
+#define NDEF_T2T_RESELECT_WUPA_N       2U         /*!< WUPA sent on re-select: a tag still ACTIVE goes IDLE silently on the 1st one */
+
 /*
  ******************************************************************************
  * GLOBAL TYPES
@@ -129,8 +131,6 @@
 #define ndefT2TIsReadOnlyAccessGranted(ctx)  (((ctx)->cc.t2t.readAccess == 0x0U) && ((ctx)->cc.t2t.writeAccess == NDEF_T2T_WR_ACCESS_NONE))
 #define ndefT2TIsReadWriteAccessGranted(ctx) (((ctx)->cc.t2t.readAccess == 0x0U) && ((ctx)->cc.t2t.writeAccess == NDEF_T2T_WR_ACCESS_GRANTED))
 
-#define rfalT2TIsTransmissionError(err)      ( ((err) == RFAL_ERR_FRAMING) || ((err) == RFAL_ERR_CRC) || ((err) == RFAL_ERR_PAR) )
-
 #define ndefT2TLogD(...)                                                                                  /*!< Macro for the debug log method                  */
 /*
  ******************************************************************************
@@ -138,12 +138,23 @@
  ******************************************************************************
  */
 
+/*! T2T default retry policy, indexed by ndefRetryClass */
+static const ndefRetryPolicy ndefT2TRetryPolicy[NDEF_RETRY_CLASS_NUM] =
+{
+    /* budget,                 session, backoff, backoffMax, action,                     actionFrom */
+    { NDEF_T2T_N_RETRY_ERROR,  8U,      0U,      0U,         NDEF_RETRY_ACTION_NONE,     0U },  /* TRANSMISSION */
+    { 1U,                      2U,      2U,      2U,         NDEF_RETRY_ACTION_RESELECT, 1U },  /* TIMEOUT      */
+    { 1U,                      2U,      1U,      1U,         NDEF_RETRY_ACTION_RESELECT, 1U },  /* COLLISION    */
+};
+
 /*
  ******************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  ******************************************************************************
  */
 static ndefStatus ndefT2TPollerReadBlock(ndefContext *ctx, uint16_t blockAddr, uint8_t *buf);
+static bool ndefT2TPollerRetry(ndefContext *ctx, ReturnCode err, uint8_t secNo);
+static ReturnCode ndefT2TPollerReselect(ndefContext *ctx, uint8_t secNo);
 
 #if NDEF_FEATURE_FULL_API
 static ndefStatus ndefT2TPollerWriteBlock(ndefContext *ctx, uint16_t blockAddr, const uint8_t *buf);
@@ -155,6 +166,65 @@ static ndefStatus ndefT2TPollerWriteBlock(ndefContext *ctx, uint16_t blockAddr,
  ******************************************************************************
  */
 
+/*******************************************************************************/
+static ReturnCode ndefT2TPollerReselect(ndefContext *ctx, uint8_t secNo)
+{
+    ReturnCode      ret;
+    rfalNfcaSensRes sensRes;
+    rfalNfcaSelRes  selRes;
+    uint32_t        i;
+
+    ret = RFAL_ERR_TIMEOUT;
+    for( i = 0U; (i < NDEF_T2T_RESELECT_WUPA_N) && (ret != RFAL_ERR_NONE); i++ )
+    {
+        ret = rfalNfcaPollerCheckPresence(RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes);
+    }
+    if( ret != RFAL_ERR_NONE )
+    {
+        /* Tag may still be ACTIVE: the retry tells */
+        return ret;
+    }
+
+    ret = rfalNfcaPollerSelect(ctx->device.dev.nfca.nfcId1, ctx->device.dev.nfca.nfcId1Len, &selRes);
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+
+    /* Selection brings the tag back to sector 0 */
+    ctx->subCtx.t2t.currentSecNo = 0U;
+    if( secNo != 0U )
+    {
+        ret = rfalT2TPollerSectorSelect(secNo);
+        if( ret == RFAL_ERR_NONE )
+        {
+            ctx->subCtx.t2t.currentSecNo = secNo;
+        }
+    }
+
+    return ret;
+}
+
+
+/*******************************************************************************/
+static bool ndefT2TPollerRetry(ndefContext *ctx, ReturnCode err, uint8_t secNo)
+{
+    ndefRetryAction action;
+
+    if( !ndefPollerRetryCheck(ctx, err, &action) )
+    {
+        return false;
+    }
+
+    if( action == NDEF_RETRY_ACTION_RESELECT )
+    {
+        (void)ndefT2TPollerReselect(ctx, secNo);
+    }
+
+    return true;
+}
+
+
 /*******************************************************************************/
 static ndefStatus ndefT2TPollerReadBlock(ndefContext *ctx, uint16_t blockAddr, uint8_t *buf)
 {
@@ -162,7 +232,6 @@ static ndefStatus ndefT2TPollerReadBlock(ndefContext *ctx, uint16_t blockAddr, u
     uint8_t              secNo;
     uint8_t              blNo;
     uint16_t             rcvdLen;
-    uint32_t             retry;
 
     ndefT2TLogD("ndefT2TPollerReadBlock 0x%2.2x\r\n", blockAddr);
 
@@ -184,12 +253,12 @@ static ndefStatus ndefT2TPollerReadBlock(ndefContext *ctx, uint16_t blockAddr, u
         ctx->subCtx.t2t.currentSecNo = secNo;
     }
 
-    retry = NDEF_T2T_N_RETRY_ERROR;
-    do 
+    ndefPollerRetryStart(ctx);
+    do
     {
         ret = rfalT2TPollerRead(blNo, buf, NDEF_T2T_READ_RESP_SIZE, &rcvdLen);
     }
-    while ( (retry-- != 0U) && rfalT2TIsTransmissionError(ret) );
+    while( ndefT2TPollerRetry(ctx, ret, secNo) );
 
     if( (ret == RFAL_ERR_NONE) && (rcvdLen != NDEF_T2T_READ_RESP_SIZE) )
     {
@@ -440,6 +509,7 @@ ndefStatus ndefT2TPollerContextInitialization(ndefContext *ctx, const ndefDevice
     ctx->state                   = NDEF_STATE_INVALID;
     ctx->subCtx.t2t.currentSecNo = 0U;
     ndefT2TInvalidateCache(ctx);
+    ndefPollerRetryInit(ctx, ndefT2TRetryPolicy);
 
    return ERR_NONE;
 }
@@ -756,7 +826,6 @@ static ndefStatus ndefT2TPollerWriteBlock(ndefContext *ctx, uint16_t blockAddr,
     ReturnCode ret;
     uint8_t    secNo;
     uint8_t    blNo;
-    uint32_t   retry;
 
     if( (ctx == NULL) || (ctx->type != NDEF_DEV_T2T) || (buf == NULL) )
     {
@@ -776,12 +845,12 @@ static ndefStatus ndefT2TPollerWriteBlock(ndefContext *ctx, uint16_t blockAddr,
         ctx->subCtx.t2t.currentSecNo = secNo;
     }
 
-    retry = NDEF_T2T_N_RETRY_ERROR;
+    ndefPollerRetryStart(ctx);
     do
     {
         ret = rfalT2TPollerWrite(blNo, buf);
     }
-    while ( (retry-- != 0U) && rfalT2TIsTransmissionError(ret) );
+    while( ndefT2TPollerRetry(ctx, ret, secNo) );
 
     return (ret == RFAL_ERR_NONE ? ERR_NONE : ERR_REQUEST);
 }
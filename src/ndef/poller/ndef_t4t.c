@@ -93,6 +93,8 @@
 
 #define NDEF_T4T_MV2_MAX_OFSSET   0x7FFFU        /*!< ReadBinary maximum Offset (offset range 0000-7FFFh)*/
 
+#define NDEF_T4T_DIRECT_RX_TAILROOM    4U        /*!< Room after a direct ReadBinary body: SW1SW2 and CRC */
+
 #if NDEF_T4T_MAX_RAPDU_BODY_LEN >= 255U
 #define NDEF_T4T_MAX_MLE             255U        /*!< Maximum MLe value supported in this implementation (short field coding). Le=0 (MLe=256) not supported by some tag. */
 #else
@@ -132,6 +134,8 @@
  */
 static void ndefT4TInitializeIsoDepTxRxParam(ndefContext *ctx, rfalIsoDepApduTxRxParam *isoDepAPDU);
 static ndefStatus ndefT4TTransceiveTxRx(ndefContext *ctx, rfalIsoDepApduTxRxParam *isoDepAPDU);
+static ndefStatus ndefT4TTransceiveSg(ndefContext *ctx, const rfalIsoDepApduTxRxParam *isoDepAPDU, const uint8_t *txData, uint8_t txDataLen, uint8_t *rxBuf, uint16_t rxBufLen);
+static ndefStatus ndefT4TReadBinaryDirect(ndefContext *ctx, uint32_t offset, uint8_t len, uint8_t *rxBuf, uint16_t rxBufLen);
 static ndefStatus ndefT4TReadAndParseCCFile(ndefContext *ctx);
 
 /*
@@ -157,31 +161,83 @@ static void ndefT4TInitializeIsoDepTxRxParam(ndefContext *ctx, rfalIsoDepApduTxR
 /*******************************************************************************/
 static ndefStatus ndefT4TTransceiveTxRx(ndefContext *ctx, rfalIsoDepApduTxRxParam *isoDepAPDU)
 {
-    ReturnCode               ret;
-
-    /* Initialize respAPDU */
-    ctx->subCtx.t4t.respAPDU.rApduBuf = &ctx->subCtx.t4t.rApduBuf;
-    isoDepAPDU->rxLen                 = &ctx->subCtx.t4t.respAPDU.rcvdLen;
+    return ndefT4TTransceiveSg(ctx, isoDepAPDU, NULL, 0U, ctx->subCtx.t4t.rApduBuf.apdu, (uint16_t)sizeof(ctx->subCtx.t4t.rApduBuf.apdu));
+}
 
-    ret = rfalIsoDepStartApduTransceive(*isoDepAPDU);
+/*******************************************************************************/
+static ndefStatus ndefT4TTransceiveSg(ndefContext *ctx, const rfalIsoDepApduTxRxParam *isoDepAPDU, const uint8_t *txData, uint8_t txDataLen, uint8_t *rxBuf, uint16_t rxBufLen)
+{
+    ReturnCode                ret;
+    rfalIsoDepSgSeg           txSeg[2];
+    rfalIsoDepSgApduTxRxParam sgAPDU;
+    uint16_t                  rcvdLen;
+
+    /* C-APDU header composed on cApduBuf, data (if any) sent straight from the caller's buffer */
+    txSeg[0].buf    = isoDepAPDU->txBuf->apdu;
+    txSeg[0].len    = isoDepAPDU->txBufLen;
+    txSeg[1].buf    = txData;
+    txSeg[1].len    = txDataLen;
+    
+    sgAPDU.txSeg    = txSeg;
+    sgAPDU.txSegCnt = (txDataLen > 0U) ? 2U : 1U;
+    sgAPDU.rxBuf    = rxBuf;
+    sgAPDU.rxBufLen = rxBufLen;
+    sgAPDU.rxLen    = &rcvdLen;
+    sgAPDU.tmpBuf   = isoDepAPDU->tmpBuf;
+    sgAPDU.FWT      = isoDepAPDU->FWT;
+    sgAPDU.dFWT     = isoDepAPDU->dFWT;
+    sgAPDU.FSx      = isoDepAPDU->FSx;
+    sgAPDU.ourFSx   = isoDepAPDU->ourFSx;
+    sgAPDU.DID      = isoDepAPDU->DID;
+
+    ret = rfalIsoDepStartSgApduTransceive(sgAPDU);
     if( ret == RFAL_ERR_NONE )
     {
         do {
             /* Blocking implementation, T4T may define rather long timeouts */
             rfalWorker();
-            ret = rfalIsoDepGetApduTransceiveStatus();
+            ret = rfalIsoDepGetSgApduTransceiveStatus();
         } while (ret == RFAL_ERR_BUSY);
     }
 
-    if (ret != RFAL_ERR_NONE)
+    ctx->subCtx.t4t.respAPDU.rApduBuf = &ctx->subCtx.t4t.rApduBuf;
+    ctx->subCtx.t4t.respAPDU.rcvdLen  = rcvdLen;
+    ctx->subCtx.t4t.rApduBodyLen      = 0U;
+
+    if( (ret != RFAL_ERR_NONE) || (rcvdLen < RFAL_T4T_MAX_RAPDU_SW1SW2_LEN) )
     {
         return ERR_REQUEST;
     }
 
-    ret = rfalT4TPollerParseRAPDU(&ctx->subCtx.t4t.respAPDU);
-    ctx->subCtx.t4t.rApduBodyLen = ctx->subCtx.t4t.respAPDU.rApduBodyLen;
+    /* R-APDU received in place, parse it where it is  T4T 1.0 5.1.3 */
+    ctx->subCtx.t4t.respAPDU.rApduBodyLen = (rcvdLen - (uint16_t)RFAL_T4T_MAX_RAPDU_SW1SW2_LEN);
+    ctx->subCtx.t4t.respAPDU.statusWord   = GETU16(&rxBuf[ctx->subCtx.t4t.respAPDU.rApduBodyLen]);
+    ctx->subCtx.t4t.rApduBodyLen          = ctx->subCtx.t4t.respAPDU.rApduBodyLen;
 
-    return (ret == RFAL_ERR_NONE ? ERR_NONE : ERR_REQUEST);
+    return ((ctx->subCtx.t4t.respAPDU.statusWord == RFAL_T4T_ISO7816_STATUS_COMPLETE) ? ERR_NONE : ERR_REQUEST);
+}
+
+/*******************************************************************************/
+static ndefStatus ndefT4TReadBinaryDirect(ndefContext *ctx, uint32_t offset, uint8_t len, uint8_t *rxBuf, uint16_t rxBufLen)
+{
+    rfalIsoDepApduTxRxParam  isoDepAPDU;
+
+    if( offset > NDEF_T4T_ODO_OFFSET_MAX )
+    {
+        return ERR_PARAM;
+    }
+
+    ndefT4TInitializeIsoDepTxRxParam(ctx, &isoDepAPDU);
+    if( offset > NDEF_T4T_MV2_MAX_OFSSET )
+    {
+        (void)rfalT4TPollerComposeReadDataODO(isoDepAPDU.txBuf, offset, len, &isoDepAPDU.txBufLen);
+    }
+    else
+    {
+        (void)rfalT4TPollerComposeReadData(isoDepAPDU.txBuf, (uint16_t)offset, len, &isoDepAPDU.txBufLen);
+    }
+    
+    return ndefT4TTransceiveSg(ctx, &isoDepAPDU, NULL, 0U, rxBuf, rxBufLen);
 }
 
 /*******************************************************************************/
@@ -451,6 +507,7 @@ ndefStatus ndefT4TPollerReadBytes(ndefContext *ctx, uint32_t offset, uint32_t le
     uint32_t             lvOffset = offset;
     uint32_t             lvLen    = len;
     uint8_t*             lvBuf    = buf;
+    bool                 direct;
 
     if( (ctx == NULL) || (ctx->type != NDEF_DEV_T4T) || (lvLen == 0U) )
     {
@@ -463,7 +520,15 @@ ndefStatus ndefT4TPollerReadBytes(ndefContext *ctx, uint32_t offset, uint32_t le
 
     do {
         le = ( lvLen > ctx->subCtx.t4t.curMLe ) ? ctx->subCtx.t4t.curMLe : (uint8_t)lvLen;
-        if( lvOffset > NDEF_T4T_MV2_MAX_OFSSET )
+        
+        /* Receive straight into the caller's buffer when the I-Block header fits over the data *
+         * already read and the SW1SW2 and CRC fit in the remaining space, bounce otherwise     */
+        direct = ( ((uint32_t)(lvBuf - buf) >= RFAL_ISODEP_PROLOGUE_SIZE) && ((lvLen - le) >= NDEF_T4T_DIRECT_RX_TAILROOM) );
+        if( direct )
+        {
+            ret = ndefT4TReadBinaryDirect(ctx, lvOffset, le, lvBuf, ((uint16_t)le + NDEF_T4T_DIRECT_RX_TAILROOM));
+        }
+        else if( lvOffset > NDEF_T4T_MV2_MAX_OFSSET )
         {
             ret = ndefT4TPollerReadBinaryODO(ctx, lvOffset, le);
         }
@@ -483,7 +548,10 @@ ndefStatus ndefT4TPollerReadBytes(ndefContext *ctx, uint32_t offset, uint32_t le
         {
             return ERR_SYSTEM;
         }
-        (void)ST_MEMCPY(lvBuf, ctx->subCtx.t4t.rApduBuf.apdu, ctx->subCtx.t4t.rApduBodyLen);
+        if( !direct )
+        {
+            (void)ST_MEMCPY(lvBuf, ctx->subCtx.t4t.rApduBuf.apdu, ctx->subCtx.t4t.rApduBodyLen);
+        }
         lvBuf     = &lvBuf[ctx->subCtx.t4t.rApduBodyLen];
         lvOffset += ctx->subCtx.t4t.rApduBodyLen;
         lvLen    -= ctx->subCtx.t4t.rApduBodyLen;
@@ -658,8 +726,17 @@ ndefStatus ndefT4TPollerWriteBinary(ndefContext *ctx, uint16_t offset, const uin
     }
 
     ndefT4TInitializeIsoDepTxRxParam(ctx, &isoDepAPDU);
-    (void)rfalT4TPollerComposeWriteData(isoDepAPDU.txBuf, offset, data, len, &isoDepAPDU.txBufLen);
-    ret = ndefT4TTransceiveTxRx(ctx, &isoDepAPDU);
+    if( (data == NULL) || (len == 0U) )
+    {
+        (void)rfalT4TPollerComposeWriteData(isoDepAPDU.txBuf, offset, data, len, &isoDepAPDU.txBufLen);
+        ret = ndefT4TTransceiveTxRx(ctx, &isoDepAPDU);
+    }
+    else
+    {
+        /* Data sent from the caller's buffer, not copied into the C-APDU */
+        (void)rfalT4TPollerComposeWriteDataHdr(isoDepAPDU.txBuf, offset, len, &isoDepAPDU.txBufLen);
+        ret = ndefT4TTransceiveSg(ctx, &isoDepAPDU, data, len, ctx->subCtx.t4t.rApduBuf.apdu, (uint16_t)sizeof(ctx->subCtx.t4t.rApduBuf.apdu));
+    }
    
     return ret;
 }
@@ -676,8 +753,20 @@ ndefStatus ndefT4TPollerWriteBinaryODO(ndefContext *ctx, uint32_t offset, const
     }
 
     ndefT4TInitializeIsoDepTxRxParam(ctx, &isoDepAPDU);
-    (void)rfalT4TPollerComposeWriteDataODO(isoDepAPDU.txBuf, offset, data, len, &isoDepAPDU.txBufLen);
-    ret = ndefT4TTransceiveTxRx(ctx, &isoDepAPDU);
+    if( (data == NULL) || (len == 0U) )
+    {
+        (void)rfalT4TPollerComposeWriteDataODO(isoDepAPDU.txBuf, offset, data, len, &isoDepAPDU.txBufLen);
+        ret = ndefT4TTransceiveTxRx(ctx, &isoDepAPDU);
+    }
+    else
+    {
+        /* Data sent from the caller's buffer, not copied into the C-APDU */
+        if( rfalT4TPollerComposeWriteDataODOHdr(isoDepAPDU.txBuf, offset, len, &isoDepAPDU.txBufLen) != RFAL_ERR_NONE )
+        {
+            return ERR_PARAM;
+        }
+        ret = ndefT4TTransceiveSg(ctx, &isoDepAPDU, data, len, ctx->subCtx.t4t.rApduBuf.apdu, (uint16_t)sizeof(ctx->subCtx.t4t.rApduBuf.apdu));
+    }
 
     return ret;
 }
@@ -249,6 +249,9 @@ ndefStatus ndefT5TPollerContextInitialization(ndefContext *ctx, const ndefDevice
     ctx->subCtx.t5t.blockLen      = 0U;
     ctx->subCtx.t5t.TlvNDEFOffset = 0U; /* Offset for TLV */
     ctx->subCtx.t5t.useMultipleBlockRead = false;
+    ctx->subCtx.t5t.writeMultipleMax     = 0U;
+
+    ndefPollerRetryInit(ctx, ndefT5TGetRetryPolicy());
 
     ndefT5TPollerAccessMode(ctx, dev, gAccessMode);
 
@@ -77,6 +77,12 @@
 
 #define NDEF_T5T_FLAG_LEN                     1U     /*!< Flag byte length                                  */
 
+#ifndef NDEF_T5T_WRITE_MULTIPLE_MAX
+#define NDEF_T5T_WRITE_MULTIPLE_MAX           4U     /*!< Max blocks per Write Multiple Blocks (ST25DV: 4)  */
+#endif /* NDEF_T5T_WRITE_MULTIPLE_MAX */
+
+#define NDEF_T5T_WRITE_MULTIPLE_HDR_LEN       6U     /*!< Ext Write Multiple: Flags, Cmd, BNo (2), NoB (2)  */
+
 
 /*
  *****************************************************************************
@@ -86,6 +92,8 @@
 
 #define NDEF_T5T_UID_MANUFACTURER_ID_POS       6U    /*!< Manufacturer ID Offset in UID buffer (reverse)    */
 #define NDEF_T5T_MANUFACTURER_ID_ST         0x02U    /*!< Manufacturer ID for ST                            */
+#define NDEF_T5T_ICREF_ST25DV04K            0x24U    /*!< IC Reference of ST25DV04K                         */
+#define NDEF_T5T_ICREF_ST25DV64K            0x26U    /*!< IC Reference of ST25DV16K and ST25DV64K           */
 
 
 /*
@@ -94,8 +102,6 @@
  ******************************************************************************
  */
 
-#define rfalT5TIsTransmissionError(err)      ( ((err) == RFAL_ERR_FRAMING) || ((err) == RFAL_ERR_CRC) || ((err) == RFAL_ERR_PAR) || ((err) == RFAL_ERR_TIMEOUT) )
-
 
 /*
  ******************************************************************************
@@ -103,6 +109,15 @@
  ******************************************************************************
  */
 
+/*! T5T default retry policy, indexed by ndefRetryClass */
+static const ndefRetryPolicy ndefT5TRetryPolicy[NDEF_RETRY_CLASS_NUM] =
+{
+    /* budget,                 session, backoff, backoffMax, action,                     actionFrom */
+    { NDEF_T5T_N_RETRY_ERROR,  16U,     0U,      0U,         NDEF_RETRY_ACTION_NONE,     0U },  /* TRANSMISSION */
+    { NDEF_T5T_N_RETRY_ERROR,  8U,      1U,      4U,         NDEF_RETRY_ACTION_RESELECT, 2U },  /* TIMEOUT      */
+    { 1U,                      2U,      1U,      1U,         NDEF_RETRY_ACTION_NONE,     0U },  /* COLLISION    */
+};
+
 /*
  ******************************************************************************
  * LOCAL FUNCTION PROTOTYPES
@@ -110,6 +125,7 @@
  */
 static ndefStatus ndefT5TPollerReadSingleBlock(ndefContext *ctx, uint16_t blockNum, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
 static ndefStatus ndefT5TPollerReadMultipleBlocks(ndefContext *ctx, uint16_t firstBlockNum, uint8_t numOfBlocks, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
+static bool ndefT5TPollerRetry(ndefContext *ctx, ReturnCode err);
 
 #if !defined NDEF_SKIP_T5T_SYS_INFO
 static ndefStatus ndefT5TGetSystemInformation(ndefContext *ctx, bool extended);
@@ -117,6 +133,7 @@ static ndefStatus ndefT5TGetSystemInformation(ndefContext *ctx, bool extended);
 
 #if NDEF_FEATURE_FULL_API
 static ndefStatus ndefT5TPollerWriteSingleBlock(ndefContext *ctx, uint16_t blockNum, const uint8_t* wrData);
+static ndefStatus ndefT5TPollerWriteMultipleBlocks(ndefContext *ctx, uint16_t firstBlockNum, uint8_t numOfBlocks, const uint8_t* wrData);
 static ndefStatus ndefT5TPollerLockSingleBlock(ndefContext *ctx, uint16_t blockNum);
 #endif /* NDEF_FEATURE_FULL_API */
 
@@ -139,6 +156,33 @@ bool ndefT5TisSTDevice(const ndefDevice *dev)
 }
 
 
+/*******************************************************************************/
+const ndefRetryPolicy* ndefT5TGetRetryPolicy(void)
+{
+    return ndefT5TRetryPolicy;
+}
+
+
+/*******************************************************************************/
+static bool ndefT5TPollerRetry(ndefContext *ctx, ReturnCode err)
+{
+    ndefRetryAction action;
+
+    if( !ndefPollerRetryCheck(ctx, err, &action) )
+    {
+        return false;
+    }
+
+    /* Re-select only applies to Selected mode: a tag that lost power is back to Ready state */
+    if( (action == NDEF_RETRY_ACTION_RESELECT) && ((ctx->subCtx.t5t.flags & (uint8_t)RFAL_NFCV_REQ_FLAG_SELECT) != 0U) )
+    {
+        (void)rfalNfcvPollerSelect((uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT, ctx->device.dev.nfcv.InvRes.UID);
+    }
+
+    return true;
+}
+
+
 /*******************************************************************************/
 bool ndefT5TisT5TDevice(const ndefDevice *dev)
 {
@@ -248,12 +292,21 @@ ndefStatus ndefT5TGetMemoryConfig(ndefContext *ctx)
         return ERR_PARAM;
     }
 
+    ctx->subCtx.t5t.writeMultipleMax = 0U;
+
     if( !ctx->subCtx.t5t.legacySTHighDensity )
     {
         /* Extended Get System Info */
         if( ndefT5TGetSystemInformation(ctx, true) == ERR_NONE )
         {
             ctx->subCtx.t5t.sysInfoSupported = true;
+
+            /* Write Multiple Blocks from the command list */
+            if( (ndefT5TSysInfoCmdListPresent(ctx->subCtx.t5t.sysInfo.infoFlags) != 0U) &&
+                (ndefT5TSysInfoWriteMultipleBlocksSupported(ctx->subCtx.t5t.sysInfo.supportedCmd) != 0U) )
+            {
+                ctx->subCtx.t5t.writeMultipleMax = NDEF_T5T_WRITE_MULTIPLE_MAX;
+            }
         }
     }
     if( !ctx->subCtx.t5t.sysInfoSupported )
@@ -262,6 +315,14 @@ ndefStatus ndefT5TGetMemoryConfig(ndefContext *ctx)
         if( ndefT5TGetSystemInformation(ctx, false) == ERR_NONE )
         {
             ctx->subCtx.t5t.sysInfoSupported = true;
+
+            /* No command list: Write Multiple Blocks from the IC reference */
+            if( ctx->subCtx.t5t.stDevice && !ctx->subCtx.t5t.legacySTHighDensity &&
+                (ndefT5TSysInfoICRefPresent(ctx->subCtx.t5t.sysInfo.infoFlags) != 0U) &&
+                ((ctx->subCtx.t5t.sysInfo.ICRef == NDEF_T5T_ICREF_ST25DV04K) || (ctx->subCtx.t5t.sysInfo.ICRef == NDEF_T5T_ICREF_ST25DV64K)) )
+            {
+                ctx->subCtx.t5t.writeMultipleMax = NDEF_T5T_WRITE_MULTIPLE_MAX;
+            }
         }
     }
 
@@ -498,7 +559,6 @@ static ndefStatus ndefT5TPollerReadSingleBlock(ndefContext *ctx, uint16_t blockN
     ReturnCode                ret;
     uint8_t                   flags;
     const uint8_t*            uid;
-    uint32_t                  retry;
 
     if( (ctx == NULL) || (ctx->type != NDEF_DEV_T5T) || (rxBuf == NULL) || (rcvLen == NULL) )
     {
@@ -517,7 +577,7 @@ static ndefStatus ndefT5TPollerReadSingleBlock(ndefContext *ctx, uint16_t blockN
     uid   = ctx->subCtx.t5t.uid;
     flags = ctx->subCtx.t5t.flags;
 
-    retry = NDEF_T5T_N_RETRY_ERROR;
+    ndefPollerRetryStart(ctx);
     do
     {
         if( ctx->subCtx.t5t.legacySTHighDensity )
@@ -540,7 +600,7 @@ static ndefStatus ndefT5TPollerReadSingleBlock(ndefContext *ctx, uint16_t blockN
             }
         }
     }
-    while( (retry-- != 0U) && rfalT5TIsTransmissionError(ret) );
+    while( ndefT5TPollerRetry(ctx, ret) );
 
     if( ret == RFAL_ERR_NONE )
     {
@@ -562,7 +622,6 @@ static ndefStatus ndefT5TPollerReadMultipleBlocks(ndefContext *ctx, uint16_t fir
     ReturnCode                ret;
     uint8_t                   flags;
     const uint8_t*            uid;
-    uint32_t                  retry;
 
     if( (ctx == NULL) || (ctx->type != NDEF_DEV_T5T) )
     {
@@ -575,7 +634,7 @@ static ndefStatus ndefT5TPollerReadMultipleBlocks(ndefContext *ctx, uint16_t fir
     /* 5.5 The number of data blocks returned by the Type 5 Tag in its response is (NB +1)
        e.g. NumOfBlocks = 0 means reading 1 block */
 
-    retry = NDEF_T5T_N_RETRY_ERROR;
+    ndefPollerRetryStart(ctx);
     do
     {
         if( ctx->subCtx.t5t.legacySTHighDensity )
@@ -598,7 +657,7 @@ static ndefStatus ndefT5TPollerReadMultipleBlocks(ndefContext *ctx, uint16_t fir
             }
         }
     }
-    while( (retry-- != 0U) && rfalT5TIsTransmissionError(ret) );
+    while( ndefT5TPollerRetry(ctx, ret) );
 
     return (ret == RFAL_ERR_NONE ? ERR_NONE : ERR_REQUEST);
 }
@@ -612,6 +671,7 @@ ndefStatus ndefT5TPollerWriteBytes(ndefContext *ctx, uint32_t offset, const uint
 {
     ndefStatus      res;
     uint16_t        nbRead;
+    uint16_t        nbBlocks;
     uint16_t        blockLen;
     uint16_t        startBlock;
     uint16_t        startAddr;
@@ -675,14 +735,28 @@ ndefStatus ndefT5TPollerWriteBytes(ndefContext *ctx, uint32_t offset, const uint
     }
     while (currentLen >= blockLen)
     {
-        res = ndefT5TPollerWriteSingleBlock(ctx, startBlock, wrbuf);
+        /* Whole blocks: Write Multiple Blocks when supported, not across a group of writeMultipleMax blocks */
+        nbBlocks = 1U;
+        if( ctx->subCtx.t5t.writeMultipleMax > 1U )
+        {
+            nbBlocks = (uint16_t)(ctx->subCtx.t5t.writeMultipleMax - (startBlock % ctx->subCtx.t5t.writeMultipleMax));
+            nbBlocks = (uint16_t)MIN( nbBlocks, currentLen / blockLen );
+        }
+        if( nbBlocks > 1U )
+        {
+            res = ndefT5TPollerWriteMultipleBlocks(ctx, startBlock, (uint8_t)nbBlocks, wrbuf);
+        }
+        else
+        {
+            res = ndefT5TPollerWriteSingleBlock(ctx, startBlock, wrbuf);
+        }
         if (res != ERR_NONE)
         {
             return res;
         }
-        currentLen -= blockLen;
-        wrbuf       = &wrbuf[blockLen];
-        startBlock++;
+        currentLen -= (uint32_t)nbBlocks * blockLen;
+        wrbuf       = &wrbuf[(uint32_t)nbBlocks * blockLen];
+        startBlock += nbBlocks;
     }
     if ( currentLen != 0U )
     {
@@ -754,7 +828,6 @@ static ndefStatus ndefT5TPollerWriteSingleBlock(ndefContext *ctx, uint16_t block
     ReturnCode                ret;
     uint8_t                   flags;
     const uint8_t*            uid;
-    uint32_t                  retry;
 
     if( (ctx == NULL) || (ctx->type != NDEF_DEV_T5T) )
     {
@@ -770,7 +843,7 @@ static ndefStatus ndefT5TPollerWriteSingleBlock(ndefContext *ctx, uint16_t block
 
     ndefT5TInvalidateCache(ctx);
 
-    retry = NDEF_T5T_N_RETRY_ERROR;
+    ndefPollerRetryStart(ctx);
     do
     {
         if( ctx->subCtx.t5t.legacySTHighDensity )
@@ -793,19 +866,86 @@ static ndefStatus ndefT5TPollerWriteSingleBlock(ndefContext *ctx, uint16_t block
             }
         }
     }
-    while( (retry-- != 0U) && rfalT5TIsTransmissionError(ret) );
+    while( ndefT5TPollerRetry(ctx, ret) );
 
     return (ret == RFAL_ERR_NONE ? ERR_NONE : ERR_REQUEST);
 }
 
 
+/*******************************************************************************/
+static ndefStatus ndefT5TPollerWriteMultipleBlocks(ndefContext *ctx, uint16_t firstBlockNum, uint8_t numOfBlocks, const uint8_t* wrData)
+{
+    ReturnCode                ret;
+    ndefStatus                res;
+    uint8_t                   flags;
+    const uint8_t*            uid;
+    uint16_t                  wrDataLen;
+    uint8_t                   i;
+
+    if( (ctx == NULL) || (ctx->type != NDEF_DEV_T5T) || (numOfBlocks == 0U) )
+    {
+        return ERR_PARAM;
+    }
+
+    uid       = ctx->subCtx.t5t.uid;
+    flags     = ctx->subCtx.t5t.flags;
+    wrDataLen = (uint16_t)((uint16_t)numOfBlocks * ctx->subCtx.t5t.blockLen);
+    if (ctx->cc.t5t.specialFrame)
+    {
+        flags |= (uint8_t)RFAL_NFCV_REQ_FLAG_OPTION;
+    }
+
+    ret = RFAL_ERR_NOTSUPP;
+    if( (NDEF_T5T_WRITE_MULTIPLE_HDR_LEN + RFAL_NFCV_UID_LEN + (uint32_t)wrDataLen) <= sizeof(ctx->subCtx.t5t.txrxBuf) )
+    {
+        ndefT5TInvalidateCache(ctx);
+
+        ndefPollerRetryStart(ctx);
+        do
+        {
+            if( ((uint32_t)firstBlockNum + numOfBlocks) <= NDEF_T5T_MAX_BLOCK_1_BYTE_ADDR )
+            {
+                ret = rfalNfcvPollerWriteMultipleBlocks(flags, uid, (uint8_t)firstBlockNum, numOfBlocks, ctx->subCtx.t5t.txrxBuf, (uint16_t)sizeof(ctx->subCtx.t5t.txrxBuf), ctx->subCtx.t5t.blockLen, wrData, wrDataLen);
+            }
+            else
+            {
+                ret = rfalNfcvPollerExtendedWriteMultipleBlocks(flags, uid, firstBlockNum, numOfBlocks, ctx->subCtx.t5t.txrxBuf, (uint16_t)sizeof(ctx->subCtx.t5t.txrxBuf), ctx->subCtx.t5t.blockLen, wrData, wrDataLen);
+            }
+        }
+        while( ndefT5TPollerRetry(ctx, ret) );
+    }
+
+    if( ret == RFAL_ERR_NONE )
+    {
+        return ERR_NONE;
+    }
+
+    /* Transport errors (timeout, CRC, framing, link loss) and write failures are not a rejection */
+    if( (ret != RFAL_ERR_NOTSUPP) && (ret != RFAL_ERR_PROTO) && (ret != RFAL_ERR_REQUEST) )
+    {
+        return ERR_REQUEST;
+    }
+
+    /* Rejected by the tag (error response): Write Single Block from now on, these blocks included */
+    ctx->subCtx.t5t.writeMultipleMax = 0U;
+    for( i = 0U; i < numOfBlocks; i++ )
+    {
+        res = ndefT5TPollerWriteSingleBlock(ctx, (uint16_t)(firstBlockNum + i), &wrData[(uint32_t)i * ctx->subCtx.t5t.blockLen]);
+        if( res != ERR_NONE )
+        {
+            return res;
+        }
+    }
+    return ERR_NONE;
+}
+
+
 /*******************************************************************************/
 static ndefStatus ndefT5TPollerLockSingleBlock(ndefContext *ctx, uint16_t blockNum)
 {
     ReturnCode                ret;
     uint8_t                   flags;
     const uint8_t*            uid;
-    uint32_t                  retry;
 
     if( (ctx == NULL) || (ctx->type != NDEF_DEV_T5T) )
     {
@@ -819,7 +959,7 @@ static ndefStatus ndefT5TPollerLockSingleBlock(ndefContext *ctx, uint16_t blockN
         flags |= (uint8_t)RFAL_NFCV_REQ_FLAG_OPTION;
     }
 
-    retry = NDEF_T5T_N_RETRY_ERROR;
+    ndefPollerRetryStart(ctx);
     do
     {
         if( blockNum < NDEF_T5T_MAX_BLOCK_1_BYTE_ADDR )
@@ -831,7 +971,7 @@ static ndefStatus ndefT5TPollerLockSingleBlock(ndefContext *ctx, uint16_t blockN
             ret = rfalNfcvPollerExtendedLockSingleBlock(flags, uid, blockNum);
         }
     }
-    while( (retry-- != 0U) && rfalT5TIsTransmissionError(ret) );
+    while( ndefT5TPollerRetry(ctx, ret) );
 
     return (ret == RFAL_ERR_NONE ? ERR_NONE : ERR_REQUEST);
 }
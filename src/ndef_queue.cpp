@@ -0,0 +1,56 @@
+/**
+ * @file ndef_queue.cpp
+ * 
+ * @brief Single-producer/single-consumer queue of raw NDEF messages.
+ */
+
+#include "ndef_queue.h"
+
+
+/*************************** Global (exported) functions implementation. */
+
+void ndef_queue_init(ndefQueue *q)
+{
+    q->head.store(0U, std::memory_order_relaxed);
+    q->tail.store(0U, std::memory_order_relaxed);
+    q->dropCnt.store(0U, std::memory_order_relaxed);
+}
+
+
+ndefQueueSlot *ndef_queue_acquire(ndefQueue *q)
+{
+    uint32_t head = q->head.load(std::memory_order_relaxed);
+
+    /* Acquire: the consumer is done with the slot before it is reused */
+    if ((head - q->tail.load(std::memory_order_acquire)) >= NDEF_QUEUE_SLOTS)
+    {
+        q->dropCnt.fetch_add(1U, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &q->slots[head & (NDEF_QUEUE_SLOTS - 1U)];
+}
+
+
+void ndef_queue_publish(ndefQueue *q)
+{
+    /* Release: the slot content is visible before the consumer sees it published */
+    q->head.store(q->head.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+}
+
+
+ndefQueueSlot *ndef_queue_peek(ndefQueue *q)
+{
+    uint32_t tail = q->tail.load(std::memory_order_relaxed);
+
+    if (tail == q->head.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    return &q->slots[tail & (NDEF_QUEUE_SLOTS - 1U)];
+}
+
+
+void ndef_queue_release(ndefQueue *q)
+{
+    q->tail.store(q->tail.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file ndef_queue.h
+ * 
+ * @brief Single-producer/single-consumer queue of raw NDEF messages, between the RF task and the decode task.
+ * 
+ * The queue owns a fixed set of slots, each holding one raw NDEF message and where it came from.
+ * The producer acquires the next free slot, reads the message straight into it and publishes it;
+ * the consumer takes the oldest published slot, decodes it in place and releases it. A slot is never
+ * copied: its ownership moves from producer to consumer and back.
+ * 
+ * Lock-free: the producer only writes 'head' and the consumer only writes 'tail', each published
+ * with release ordering and read with acquire ordering by the other side. Neither side ever waits;
+ * on a full queue the producer gets no slot and the message is dropped (and counted).
+ * 
+ * No platform dependency: the same code runs in a host (pthreads) build.
+ */
+
+#ifndef NDEF_QUEUE_H
+#define NDEF_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+
+#ifndef NDEF_QUEUE_SLOTS
+#define NDEF_QUEUE_SLOTS        4U          /* Slots on the queue, power of two */
+#endif
+
+#ifndef NDEF_QUEUE_SLOT_LEN
+#define NDEF_QUEUE_SLOT_LEN     8192U       /* Longest raw NDEF message held by a slot */
+#endif
+
+#define NDEF_QUEUE_UID_LEN      10U         /* Longest UID held by a slot (NFC-A triple size) */
+
+static_assert((NDEF_QUEUE_SLOTS & (NDEF_QUEUE_SLOTS - 1U)) == 0U, "NDEF_QUEUE_SLOTS must be a power of two");
+
+
+/** Raw NDEF message and its metadata. */
+typedef struct {
+    uint8_t     devType;                        /* Device type (rfalNfcDevType) */
+    uint8_t     uidLen;                         /* UID length */
+    uint8_t     uid[NDEF_QUEUE_UID_LEN];        /* UID, as on the device */
+    uint32_t    timestamp;                      /* Time the message was read [ms] */
+    uint32_t    readTime;                       /* Time the read took, NDEF detection included [ms] */
+    uint32_t    len;                            /* Raw NDEF message length */
+    uint8_t     data[NDEF_QUEUE_SLOT_LEN];      /* Raw NDEF message */
+} ndefQueueSlot;
+
+/** SPSC queue of raw NDEF messages. */
+typedef struct {
+    ndefQueueSlot           slots[NDEF_QUEUE_SLOTS];
+    std::atomic<uint32_t>   head;               /* Slots published, written by the producer only */
+    std::atomic<uint32_t>   tail;               /* Slots released, written by the consumer only */
+    std::atomic<uint32_t>   dropCnt;            /* Messages dropped on a full queue */
+} ndefQueue;
+
+
+/**
+ * @brief Empty the queue. Not to be called while a producer or consumer runs.
+ */
+void ndef_queue_init(ndefQueue *q);
+
+/**
+ * @brief Producer: take the next free slot, owned by the producer until published.
+ * 
+ * Calling it again before ndef_queue_publish() returns the same slot.
+ * 
+ * @return the slot, NULL if the queue is full (the message is counted as dropped)
+ */
+ndefQueueSlot *ndef_queue_acquire(ndefQueue *q);
+
+/**
+ * @brief Producer: hand the slot acquired over to the consumer.
+ */
+void ndef_queue_publish(ndefQueue *q);
+
+/**
+ * @brief Consumer: oldest published slot, owned by the consumer until released.
+ * 
+ * @return the slot, NULL if the queue is empty
+ */
+ndefQueueSlot *ndef_queue_peek(ndefQueue *q);
+
+/**
+ * @brief Consumer: give the slot peeked back to the producer.
+ */
+void ndef_queue_release(ndefQueue *q);
+
+#endif /* NDEF_QUEUE_H */
@@ -0,0 +1,316 @@
+/**
+ * @file rf_log.cpp
+ * 
+ * @brief Deferred binary log of the RF task.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <atomic>
+
+#include "rf_log.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#define RF_LOG_NOW()    ((uint32_t)micros())
+#else
+#include <chrono>
+#define RF_LOG_NOW()    ((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+#endif
+
+
+/************************************ LOCAL VARIABLES *****************************************/
+
+static rfLogEntry               logRing[RF_LOG_ENTRIES];
+static std::atomic<uint32_t>    logHead;        /* Entries written, by the producer only */
+static std::atomic<uint32_t>    logTail;        /* Entries read, by the consumer only */
+static std::atomic<uint32_t>    logOverflow;    /* Entries dropped */
+static uint32_t                 logLost;        /* Entries dropped, not logged yet (producer only) */
+
+/* Mirror rfLogTagKind, ndefState, ndefRetryClass and the ISO-DEP bit rates: kept here so that the host decoder needs no RFAL/NDEF header. */
+static const char * const tagKindDesc[] = {
+    "ISO14443A/Topaz (NFC-A T1T) TAG", "NFCA Passive ISO-DEP device", "NFCA Passive P2P device", "ISO14443A/NFC-A card",
+    "ISO14443B/NFC-B card", "NFCF Passive P2P device", "Felica/NFC-F card", "ISO15693/NFC-V card" };
+static const char * const ndefStateDesc[] = { "INVALID", "INITIALIZED", "READ/WRITE", "READ-ONLY" };
+static const char * const retryClassDesc[] = { "transmission", "timeout", "collision" };
+static const char * const rateDesc[] = { "106", "212", "424", "848" };
+
+#define RF_LOG_DESC(table, i)   (((i) < (sizeof(table) / sizeof((table)[0]))) ? (table)[(i)] : "?")
+
+
+/****************** Local function protos ****************/
+
+static bool rf_log_put(const rfLogEntry *entry);
+static size_t rf_log_printf(char *buf, size_t bufLen, size_t n, const char *fmt, ...);
+static size_t rf_log_format_bytes(const rfLogEntry *entry, char *buf, size_t bufLen, size_t n);
+
+
+/*************************** Local functions implementation. */
+
+static bool rf_log_put(const rfLogEntry *entry)
+{
+    uint32_t head = logHead.load(std::memory_order_relaxed);
+    uint32_t room = (RF_LOG_ENTRIES - (head - logTail.load(std::memory_order_acquire)));
+
+    /* Entries lost first, if there is room for them and this entry */
+    if ((logLost != 0U) && (room >= 2U))
+    {
+        rfLogEntry *lost = &logRing[head & (RF_LOG_ENTRIES - 1U)];
+
+        memset(lost, 0x00, sizeof(rfLogEntry));
+        lost->timestamp = entry->timestamp;
+        lost->id        = RF_LOG_EVT_OVERFLOW;
+        lost->arg[0]    = logLost;
+        logLost         = 0U;
+        head++;
+        room--;
+    }
+
+    if ((room == 0U) || (logLost != 0U))
+    {
+        logLost++;
+        logOverflow.fetch_add(1U, std::memory_order_relaxed);
+        return false;
+    }
+
+    logRing[head & (RF_LOG_ENTRIES - 1U)] = *entry;
+    logHead.store(head + 1U, std::memory_order_release);
+    return true;
+}
+
+
+/* Appends to the text at buf[n], truncating at the end of the buffer: returns the new length. */
+static size_t rf_log_printf(char *buf, size_t bufLen, size_t n, const char *fmt, ...)
+{
+    va_list args;
+    int     len;
+
+    if ((n + 1U) >= bufLen)
+    {
+        return n;
+    }
+
+    va_start(args, fmt);
+    len = vsnprintf(&buf[n], bufLen - n, fmt, args);
+    va_end(args);
+
+    if (len < 0)
+    {
+        return n;
+    }
+    return (((n + (size_t)len) < bufLen) ? (n + (size_t)len) : (bufLen - 1U));
+}
+
+
+static size_t rf_log_format_bytes(const rfLogEntry *entry, char *buf, size_t bufLen, size_t n)
+{
+    const uint8_t *bytes = (const uint8_t *)entry->arg;
+
+    for (uint16_t i = 0; (i < entry->len) && (i < RF_LOG_BYTES_MAX); i++)
+    {
+        n = rf_log_printf(buf, bufLen, n, "%02X", bytes[i]);
+    }
+    return n;
+}
+
+
+/*************************** Global (exported) functions implementation. */
+
+void rf_log_init(void)
+{
+    logHead.store(0U, std::memory_order_relaxed);
+    logTail.store(0U, std::memory_order_relaxed);
+    logOverflow.store(0U, std::memory_order_relaxed);
+    logLost = 0U;
+}
+
+
+void rf_log(rfLogEvt id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    rfLogEntry entry;
+
+    entry.timestamp = RF_LOG_NOW();
+    entry.id        = id;
+    entry.len       = 0U;
+    entry.arg[0]    = a0;
+    entry.arg[1]    = a1;
+    entry.arg[2]    = a2;
+    entry.arg[3]    = a3;
+    entry.arg[4]    = a4;
+    entry.arg[5]    = a5;
+
+    rf_log_put(&entry);
+}
+
+
+void rf_log_bytes(rfLogEvt id, const uint8_t *data, uint8_t len, uint32_t a3, uint32_t a4, uint32_t a5)
+{
+    rfLogEntry entry;
+
+    entry.timestamp = RF_LOG_NOW();
+    entry.id        = id;
+    entry.len       = ((len < RF_LOG_BYTES_MAX) ? len : RF_LOG_BYTES_MAX);
+    memset(entry.arg, 0x00, RF_LOG_BYTES_MAX);
+    memcpy(entry.arg, data, entry.len);
+    entry.arg[3]    = a3;
+    entry.arg[4]    = a4;
+    entry.arg[5]    = a5;
+
+    rf_log_put(&entry);
+}
+
+
+bool rf_log_read(rfLogEntry *entry)
+{
+    uint32_t tail = logTail.load(std::memory_order_relaxed);
+
+    if (tail == logHead.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    *entry = logRing[tail & (RF_LOG_ENTRIES - 1U)];
+    logTail.store(tail + 1U, std::memory_order_release);
+    return true;
+}
+
+
+uint32_t rf_log_overflow_count(void)
+{
+    return logOverflow.load(std::memory_order_relaxed);
+}
+
+
+size_t rf_log_format(const rfLogEntry *entry, char *buf, size_t bufLen)
+{
+    unsigned long a[RF_LOG_ARGS];
+    size_t        n;
+
+    if (bufLen == 0U)
+    {
+        return 0;
+    }
+    buf[0] = '\0';
+
+    for (uint8_t i = 0; i < RF_LOG_ARGS; i++)
+    {
+        a[i] = entry->arg[i];
+    }
+
+    n = rf_log_printf(buf, bufLen, 0, "[%10lu us] ", (unsigned long)entry->timestamp);
+
+    switch (entry->id)
+    {
+        case RF_LOG_EVT_OVERFLOW:
+            n = rf_log_printf(buf, bufLen, n, "RF log full: %lu entries lost", a[0]);
+            break;
+
+        case RF_LOG_EVT_TAG_FOUND:
+            n = rf_log_printf(buf, bufLen, n, "%s found. UID: ", RF_LOG_DESC(tagKindDesc, a[3]));
+            n = rf_log_format_bytes(entry, buf, bufLen, n);
+            break;
+
+        case RF_LOG_EVT_TAG_DONE:
+            n = rf_log_printf(buf, bufLen, n, "Operation completed, %lu tag(s) can be removed from the field", a[0]);
+            break;
+
+        case RF_LOG_EVT_TAG_ARRIVAL:
+        case RF_LOG_EVT_TAG_DEPARTURE:
+            n = rf_log_printf(buf, bufLen, n, "Tag ");
+            n = rf_log_format_bytes(entry, buf, bufLen, n);
+            if (entry->id == RF_LOG_EVT_TAG_ARRIVAL)
+            {
+                n = rf_log_printf(buf, bufLen, n, " arrived");
+            }
+            else
+            {
+                n = rf_log_printf(buf, bufLen, n, " left after %lums in the field (%lu presence checks)", a[3], a[4]);
+            }
+            break;
+
+        case RF_LOG_EVT_NDEF_INIT_ERR:
+            n = rf_log_printf(buf, bufLen, n, "NDEF NOT DETECTED (ndefPollerContextInitialization returns %lu)", a[0]);
+            break;
+
+        case RF_LOG_EVT_NDEF_DETECT_ERR:
+            n = rf_log_printf(buf, bufLen, n, "NDEF NOT DETECTED (ndefPollerNdefDetect returns %lu)", a[0]);
+            break;
+
+        case RF_LOG_EVT_NDEF_DETECTED:
+            n = rf_log_printf(buf, bufLen, n, "%s NDEF detected", RF_LOG_DESC(ndefStateDesc, a[0]));
+            break;
+
+        case RF_LOG_EVT_NDEF_READ_ERR:
+            n = rf_log_printf(buf, bufLen, n, "NDEF message cannot be read (ndefPollerReadRawMessage returns %lu)", a[0]);
+            break;
+
+        case RF_LOG_EVT_NDEF_READ:
+            n = rf_log_printf(buf, bufLen, n, "NDEF message read: %lu bytes in %lums", a[0], a[1]);
+            break;
+
+        case RF_LOG_EVT_NDEF_DROPPED:
+            n = rf_log_printf(buf, bufLen, n, "NDEF message dropped: decode queue full");
+            break;
+
+        case RF_LOG_EVT_NDEF_RETRY_CLASS:
+            n = rf_log_printf(buf, bufLen, n, "NDEF %s retries/errors: %lu/%lu", RF_LOG_DESC(retryClassDesc, a[0]), a[1], a[2]);
+            break;
+
+        case RF_LOG_EVT_NDEF_RETRY:
+            n = rf_log_printf(buf, bufLen, n, "NDEF retries: %lu recovered, %lu failed, %lu re-selects, %lums backoff", a[0], a[1], a[2], a[3]);
+            break;
+
+        case RF_LOG_EVT_POLL_SCHED:
+            n = rf_log_printf(buf, bufLen, n, "Mean time-to-detect: %lu ms (%lu detections in %lu poll cycles)", a[0], a[1], a[2]);
+            break;
+
+        case RF_LOG_EVT_WAKEUP_LATENCY:
+            n = rf_log_printf(buf, bufLen, n, "Wake-to-NDEF: %lu ms, mean wake-to-activation: %lu ms", a[0], a[1]);
+            break;
+
+        case RF_LOG_EVT_WAKEUP_DUTY:
+            n = rf_log_printf(buf, bufLen, n, "Field-on duty: %lu%% (%lu wake-ups, %lu rejected by card detection)", a[0], a[1], a[2]);
+            break;
+
+        case RF_LOG_EVT_DPO:
+            n = rf_log_printf(buf, bufLen, n, "DPO: level %lu, last measurement %lu, %lu errors in %lu frames, %lu steps up, %lu steps down", a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+
+        case RF_LOG_EVT_DPO_ENTRY:
+            n = rf_log_printf(buf, bufLen, n, "DPO table[%lu] inc/dec: %lu/%lu", a[0], a[1], a[2]);
+            break;
+
+        case RF_LOG_EVT_ISODEP_RATE:
+            n = rf_log_printf(buf, bufLen, n, "ISO-DEP @%skbps: %lu I-Blocks, %lu bytes in %lu ms, CRC errors: %lu, timeouts: %lu", RF_LOG_DESC(rateDesc, a[0]), a[1], a[2], a[3], a[4], a[5]);
+            break;
+
+        case RF_LOG_EVT_ISODEP_LINK:
+            n = rf_log_printf(buf, bufLen, n, "ISO-DEP FSD/FSC: %lu/%lu bytes, I-Blocks sent/received: %lu/%lu, round-trips: %lu", a[0], a[1], a[2], a[3], a[4]);
+            break;
+
+        case RF_LOG_EVT_ISODEP_BR:
+            n = rf_log_printf(buf, bufLen, n, "ISO-DEP max bit rate: %skbps (%lu down, %lu up)", RF_LOG_DESC(rateDesc, a[0]), a[1], a[2]);
+            break;
+
+        default:
+            n = rf_log_printf(buf, bufLen, n, "event 0x%04X: %lu %lu %lu %lu %lu %lu", entry->id, a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+    }
+
+    return n;
+}
+
+
+void rf_log_frame(const rfLogEntry *entry, uint8_t *frame)
+{
+    uint8_t sum = 0U;
+
+    frame[0] = RF_LOG_SYNC0;
+    frame[1] = RF_LOG_SYNC1;
+    memcpy(&frame[2], entry, sizeof(rfLogEntry));
+    for (size_t i = 0; i < sizeof(rfLogEntry); i++)
+    {
+        sum += frame[2U + i];
+    }
+    frame[RF_LOG_FRAME_LEN - 1U] = (uint8_t)(~sum);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file rf_log.h
+ * 
+ * @brief Deferred binary log of the RF task.
+ * 
+ * The RF task logs fixed-size binary entries (event id, timestamp, a few integer arguments) into
+ * a lock-free ring instead of printing: logging costs a few stores, no formatting, no heap, no UART.
+ * A low-priority task drains the ring, either formatting the entries as text or sending them as
+ * binary frames to be turned into text on the host by tools/rf_log_decode.cpp.
+ * 
+ * Single producer (the RF task) and single consumer (the drain task), same scheme as ndef_queue.h.
+ * On a full ring entries are dropped and counted; the count is logged as RF_LOG_EVT_OVERFLOW as
+ * soon as there is room again.
+ * 
+ * The formatting has no platform dependency: the host decoder links this same module.
+ */
+
+#ifndef RF_LOG_H
+#define RF_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+#ifndef RF_LOG_ENTRIES
+#define RF_LOG_ENTRIES          256U        /* Entries on the ring, power of two */
+#endif
+
+#define RF_LOG_ARGS             6U          /* Arguments per entry */
+#define RF_LOG_BYTES_MAX        12U         /* Bytes carried by a byte entry, on arg[0..2] */
+
+#define RF_LOG_SYNC0            0xA5U       /* Binary frame: sync bytes, entry, checksum */
+#define RF_LOG_SYNC1            0x5AU
+#define RF_LOG_FRAME_LEN        (2U + sizeof(rfLogEntry) + 1U)
+
+static_assert((RF_LOG_ENTRIES & (RF_LOG_ENTRIES - 1U)) == 0U, "RF_LOG_ENTRIES must be a power of two");
+
+
+/** Log events. Values are part of the binary format: append only. */
+typedef enum : uint16_t {
+    RF_LOG_EVT_OVERFLOW         = 0x0001,   /* arg0: entries lost */
+
+    RF_LOG_EVT_TAG_FOUND        = 0x0100,   /* bytes: UID, arg3: rfLogTagKind */
+    RF_LOG_EVT_TAG_DONE         = 0x0101,   /* arg0: tags left in the field */
+    RF_LOG_EVT_TAG_ARRIVAL      = 0x0102,   /* bytes: UID */
+    RF_LOG_EVT_TAG_DEPARTURE    = 0x0103,   /* bytes: UID, arg3: dwell [ms], arg4: presence checks */
+
+    RF_LOG_EVT_NDEF_INIT_ERR    = 0x0200,   /* arg0: ndefPollerContextInitialization() error */
+    RF_LOG_EVT_NDEF_DETECT_ERR  = 0x0201,   /* arg0: ndefPollerNdefDetect() error */
+    RF_LOG_EVT_NDEF_DETECTED    = 0x0202,   /* arg0: ndefState */
+    RF_LOG_EVT_NDEF_READ_ERR    = 0x0203,   /* arg0: ndefPollerReadRawMessage() error */
+    RF_LOG_EVT_NDEF_READ        = 0x0204,   /* arg0: length, arg1: read time [ms] */
+    RF_LOG_EVT_NDEF_DROPPED     = 0x0205,   /* Decode queue full */
+    RF_LOG_EVT_NDEF_RETRY_CLASS = 0x0206,   /* arg0: ndefRetryClass, arg1: retries, arg2: errors */
+    RF_LOG_EVT_NDEF_RETRY       = 0x0207,   /* arg0: recovered, arg1: failed, arg2: re-selects, arg3: backoff [ms] */
+
+    RF_LOG_EVT_POLL_SCHED       = 0x0300,   /* arg0: mean time-to-detect [ms], arg1: detections, arg2: poll cycles */
+    RF_LOG_EVT_WAKEUP_LATENCY   = 0x0301,   /* arg0: wake-to-NDEF [ms], arg1: mean wake-to-activation [ms] */
+    RF_LOG_EVT_WAKEUP_DUTY      = 0x0302,   /* Since the last report - arg0: field-on duty [%], arg1: wake-ups, arg2: rejected by card detection */
+    RF_LOG_EVT_DPO              = 0x0303,   /* arg0: level, arg1: last measurement, arg2: errors, arg3: frames, arg4: steps up, arg5: steps down */
+    RF_LOG_EVT_DPO_ENTRY        = 0x0304,   /* arg0: table index, arg1: inc, arg2: dec */
+
+    RF_LOG_EVT_ISODEP_RATE      = 0x0400,   /* arg0: bit rate (0: 106 .. 3: 848), arg1: I-Blocks, arg2: bytes, arg3: time [ms], arg4: CRC errors, arg5: timeouts */
+    RF_LOG_EVT_ISODEP_LINK      = 0x0401,   /* arg0: FSD, arg1: FSC, arg2: I-Blocks sent, arg3: received, arg4: round-trips */
+    RF_LOG_EVT_ISODEP_BR        = 0x0402,   /* arg0: max bit rate, arg1: steps down, arg2: steps up */
+} rfLogEvt;
+
+/** Kind of tag on RF_LOG_EVT_TAG_FOUND. Values are part of the binary format: append only. */
+typedef enum : uint8_t {
+    RF_LOG_TAG_NFCA_T1T,
+    RF_LOG_TAG_NFCA_ISODEP,
+    RF_LOG_TAG_NFCA_P2P,
+    RF_LOG_TAG_NFCA,
+    RF_LOG_TAG_NFCB,
+    RF_LOG_TAG_NFCF_P2P,
+    RF_LOG_TAG_NFCF,
+    RF_LOG_TAG_NFCV,
+} rfLogTagKind;
+
+/** Log entry, little endian in binary frames. */
+typedef struct {
+    uint32_t    timestamp;                  /* [us] */
+    uint16_t    id;                         /* rfLogEvt */
+    uint16_t    len;                        /* Bytes on arg[0..2] for byte entries, 0 otherwise */
+    uint32_t    arg[RF_LOG_ARGS];
+} rfLogEntry;
+
+
+/**
+ * @brief Empty the ring. Not to be called while the producer or consumer runs.
+ */
+void rf_log_init(void);
+
+/**
+ * @brief Producer: log an event with integer arguments.
+ */
+void rf_log(rfLogEvt id, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0, uint32_t a4 = 0, uint32_t a5 = 0);
+
+/**
+ * @brief Producer: log an event carrying up to RF_LOG_BYTES_MAX bytes (e.g. a UID) and integer arguments.
+ */
+void rf_log_bytes(rfLogEvt id, const uint8_t *data, uint8_t len, uint32_t a3 = 0, uint32_t a4 = 0, uint32_t a5 = 0);
+
+/**
+ * @brief Consumer: take the oldest entry.
+ * 
+ * @return false if the ring is empty
+ */
+bool rf_log_read(rfLogEntry *entry);
+
+/**
+ * @brief Entries dropped on a full ring since rf_log_init().
+ */
+uint32_t rf_log_overflow_count(void);
+
+/**
+ * @brief Format an entry as a text line (no line ending).
+ * 
+ * @return the text length
+ */
+size_t rf_log_format(const rfLogEntry *entry, char *buf, size_t bufLen);
+
+/**
+ * @brief Build the binary frame of an entry, RF_LOG_FRAME_LEN bytes.
+ */
+void rf_log_frame(const rfLogEntry *entry, uint8_t *frame);
+
+#endif /* RF_LOG_H */
@@ -122,7 +122,8 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalCdCtx gCd;
+static rfalCdCtx gCdInst[RFAL_FEATURE_INSTANCES];
+#define gCd     gCdInst[rfalInstance()]
 
 
 /*
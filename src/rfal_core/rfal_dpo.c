@@ -63,6 +63,24 @@
  */
 #define RFAL_DPO_ANALOGCONFIG_SHIFT       13U
 #define RFAL_DPO_ANALOGCONFIG_MASK        0x6000U
+#define RFAL_DPO_ERR_RATE_SHIFT           4U         /*!< Reliable: at most one error every 16 frames      */
+#define RFAL_DPO_CNT_MAX                  0xFFFFU    /*!< Bin counter max, both halved when reached        */
+
+#ifndef RFAL_FEATURE_DPO_WINDOW
+    #define RFAL_FEATURE_DPO_WINDOW       16U        /*!< Frames per error rate window                     */
+#endif
+
+#ifndef RFAL_FEATURE_DPO_UP_ERRS
+    #define RFAL_FEATURE_DPO_UP_ERRS      2U         /*!< Errors within a window to raise the power        */
+#endif
+
+#ifndef RFAL_FEATURE_DPO_DOWN_WINDOWS
+    #define RFAL_FEATURE_DPO_DOWN_WINDOWS 4U         /*!< Error free windows to lower the power            */
+#endif
+
+#ifndef RFAL_FEATURE_DPO_LEARN_MIN
+    #define RFAL_FEATURE_DPO_LEARN_MIN    8U         /*!< Frames on a measurement bin before it is trusted */
+#endif
     
 /*
  ******************************************************************************
@@ -70,6 +88,13 @@
  ******************************************************************************
  */
 
+/*! RFAL DPO measurement bin reliability                                                           */
+typedef enum{
+    RFAL_DPO_BIN_UNKNOWN,               /*!< Not enough frames on the bin                            */
+    RFAL_DPO_BIN_RELIABLE,              /*!< Error rate within target                                */
+    RFAL_DPO_BIN_UNRELIABLE             /*!< Error rate above target                                 */
+}rfalDpoBinState;
+
 /*! RFAL DPO instance                                                                                */
 typedef struct{
     bool                enabled;
@@ -80,6 +105,13 @@ typedef struct{
     rfalDpoMeasureFunc  measureCallback;
     rfalMode            curMode;
     rfalBitRate         curBR;
+    bool                monitor;        /*!< Frames accounted: a device is activated                 */
+    uint8_t             paused;         /*!< Nested pauses of the monitor: frames not accounted      */
+    uint8_t             winFrames;      /*!< Frames on the current window                            */
+    uint8_t             winErr;         /*!< Errors on the current window                            */
+    uint8_t             cleanWin;       /*!< Consecutive error free windows                          */
+    uint16_t            hold;           /*!< Frames the thresholds may not lower the power           */
+    rfalDpoStats        stats;          /*!< Closed loop statistics                                  */
 }rfalDpo;
 
 
@@ -89,7 +121,17 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalDpo gRfalDpo;
+static rfalDpo gRfalDpoInst[RFAL_FEATURE_INSTANCES];
+#define gRfalDpo  gRfalDpoInst[rfalInstance()]
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+static void rfalDpoApply( rfalMode mode, rfalBitRate br, uint8_t tableEntry );
+static void rfalDpoStep( bool up );
+static rfalDpoBinState rfalDpoGetBinState( uint8_t tableEntry, uint8_t bin );
 
 /*
  ******************************************************************************
@@ -103,6 +145,11 @@ void rfalDpoInitialize( void )
     gRfalDpo.tableEntry = 0;
     gRfalDpo.curMode    = RFAL_MODE_NONE;
     gRfalDpo.curBR      = RFAL_BR_KEEP;
+    gRfalDpo.monitor    = false;
+    gRfalDpo.paused     = 0U;
+    gRfalDpo.hold       = 0U;
+    
+    rfalDpoClearStats();
     
     
     /* Set default measurement */
@@ -179,7 +226,7 @@ ReturnCode rfalDpoTableRead( rfalDpoEntry* tblBuf, uint8_t tblBufEntries, uint8_
     }
         
     /* Copy the whole Table to the given buffer */
-    RFAL_MEMCPY( tblBuf, gRfalDpo.currentDpo, (tblBufEntries * RFAL_DPO_TABLE_PARAMETER) );
+    RFAL_MEMCPY( tblBuf, gRfalDpo.currentDpo, (gRfalDpo.tableEntries * RFAL_DPO_TABLE_PARAMETER) );
     *tableEntries = gRfalDpo.tableEntries;
     
     return RFAL_ERR_NONE;
@@ -190,7 +237,6 @@ ReturnCode rfalDpoTableRead( rfalDpoEntry* tblBuf, uint8_t tblBufEntries, uint8_
 ReturnCode rfalDpoAdjust( void )
 {
     uint8_t       refValue = 0;
-    uint16_t      modeID;
     rfalBitRate   br;
     rfalMode      mode;
     uint8_t       tableEntry;
@@ -224,6 +270,7 @@ ReturnCode rfalDpoAdjust( void )
     {
         return RFAL_ERR_IO;
     }
+    gRfalDpo.stats.lastMeas = refValue;
 
     
     if( refValue >= dpoTable[gRfalDpo.tableEntry].inc )
@@ -239,8 +286,8 @@ ReturnCode rfalDpoAdjust( void )
             tableEntry--;
         }
     }
-    else if(refValue <= dpoTable[gRfalDpo.tableEntry].dec)
-    {   /* Decrease the output power */
+    else if( (refValue <= dpoTable[gRfalDpo.tableEntry].dec) && (gRfalDpo.hold == 0U) )
+    {   /* Decrease the output power, unless just raised on link errors */
         /* The bottom is the highest possible value */
         if( (gRfalDpo.tableEntry + 1) >= gRfalDpo.tableEntries)
         {
@@ -261,25 +308,291 @@ ReturnCode rfalDpoAdjust( void )
     /* Apply new configs if there was a change on DPO level or RFAL mode|bitrate  */
     if( (mode != gRfalDpo.curMode) || (br != gRfalDpo.curBR) || (tableEntry != gRfalDpo.tableEntry) )
     {
-        /* Update local context */
-        gRfalDpo.curMode    = mode;
-        gRfalDpo.curBR      = br;
-        gRfalDpo.tableEntry = tableEntry;
+        rfalDpoApply( mode, br, tableEntry );
+    }
+    
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalDpoSetLinkMonitor( bool enable )
+{
+    /* Session over: learn the thresholds from what the link has shown */
+    if( gRfalDpo.monitor && (!enable) && gRfalDpo.enabled )
+    {
+        (void)rfalDpoTableLearn();
+    }
+    
+    gRfalDpo.monitor   = enable;
+    gRfalDpo.winFrames = 0U;
+    gRfalDpo.winErr    = 0U;
+    gRfalDpo.cleanWin  = 0U;
+}
+
+
+/*******************************************************************************/
+void rfalDpoPauseLinkMonitor( bool pause )
+{
+    if( pause )
+    {
+        gRfalDpo.paused = ((gRfalDpo.paused < 0xFFU) ? (gRfalDpo.paused + 1U) : gRfalDpo.paused);
+    }
+    else
+    {
+        gRfalDpo.paused = ((gRfalDpo.paused > 0U) ? (gRfalDpo.paused - 1U) : 0U);
+    }
+}
+
+
+/*******************************************************************************/
+void rfalDpoReportResult( ReturnCode err )
+{
+    rfalDpoEntryStats *eStats;
+    uint8_t           bin;
+    bool              isErr;
+    
+    if( (!gRfalDpo.enabled) || (!gRfalDpo.monitor) || (gRfalDpo.paused > 0U) || (gRfalDpo.currentDpo == NULL) || (!rfalIsModePassivePoll( gRfalDpo.curMode )) )
+    {
+        return;
+    }
+    
+    /* Only account outcomes reflecting the link quality (i.e. not a 4 bit ACK) */
+    if( err == RFAL_ERR_NONE )
+    {
+        isErr = false;
+    }
+    else if( (err == RFAL_ERR_CRC) || (err == RFAL_ERR_PAR) || (err == RFAL_ERR_FRAMING) || (err == RFAL_ERR_TIMEOUT) )
+    {
+        isErr = true;
+    }
+    else
+    {
+        return;
+    }
+    
+    bin    = (gRfalDpo.stats.lastMeas >> RFAL_DPO_MEAS_BIN_SHIFT);
+    eStats = &gRfalDpo.stats.entry[gRfalDpo.tableEntry];
+    
+    /* Age the bin keeping its error rate, recent frames weigh more */
+    if( (eStats->okCnt[bin] == RFAL_DPO_CNT_MAX) || (eStats->errCnt[bin] == RFAL_DPO_CNT_MAX) )
+    {
+        eStats->okCnt[bin]  >>= 1U;
+        eStats->errCnt[bin] >>= 1U;
+    }
+    
+    gRfalDpo.stats.frameCnt++;
+    if( gRfalDpo.hold > 0U )
+    {
+        gRfalDpo.hold--;
+    }
+    
+    if( isErr )
+    {
+        eStats->errCnt[bin]++;
+        gRfalDpo.stats.errCnt++;
+        gRfalDpo.cleanWin = 0U;
+        
+        if( ++gRfalDpo.winErr >= (uint8_t)RFAL_FEATURE_DPO_UP_ERRS )
+        {
+            gRfalDpo.winFrames = 0U;
+            gRfalDpo.winErr    = 0U;
+            rfalDpoStep( true );
+            return;
+        }
+    }
+    else
+    {
+        eStats->okCnt[bin]++;
+    }
+    
+    if( ++gRfalDpo.winFrames >= (uint8_t)RFAL_FEATURE_DPO_WINDOW )
+    {
+        gRfalDpo.cleanWin  = ((gRfalDpo.winErr == 0U) ? (gRfalDpo.cleanWin + 1U) : 0U);
+        gRfalDpo.winFrames = 0U;
+        gRfalDpo.winErr    = 0U;
+        
+        if( gRfalDpo.cleanWin >= (uint8_t)RFAL_FEATURE_DPO_DOWN_WINDOWS )
+        {
+            gRfalDpo.cleanWin = 0U;
+            rfalDpoStep( false );
+        }
+    }
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalDpoTableLearn( void )
+{
+    rfalDpoEntry    *dpoTable;
+    rfalDpoBinState binState;
+    uint8_t         entry;
+    uint8_t         bin;
+    uint8_t         inc;
+    uint8_t         dec;
+    bool            learnt;
+    
+    if( (gRfalDpo.currentDpo == NULL) || (gRfalDpo.tableEntries == 0U) || (gRfalDpo.tableEntries > RFAL_DPO_TABLE_ENTRIES_MAX) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /* The default table is constant: learn on the RAM copy */
+    if( gRfalDpo.currentDpo != gRfalDpo.table )
+    {
+        RFAL_MEMCPY( gRfalDpo.table, gRfalDpo.currentDpo, (gRfalDpo.tableEntries * RFAL_DPO_TABLE_PARAMETER) );
+        gRfalDpo.currentDpo = gRfalDpo.table;
+    }
+    dpoTable = (rfalDpoEntry*) gRfalDpo.currentDpo;
+    learnt   = false;
+    
+    for( entry = 0; entry < gRfalDpo.tableEntries; entry++ )
+    {
+        inc = dpoTable[entry].inc;
+        dec = dpoTable[entry].dec;
         
-        /* Get the new value for RFO resistance form the table and apply the new RFO resistance setting */ 
-        rfalChipSetRFO( dpoTable[gRfalDpo.tableEntry].rfoRes );
+        /* Increment threshold: first bin this entry fails on (the highest power has none) */
+        if( entry > 0U )
+        {
+            for( bin = 0; bin < RFAL_DPO_MEAS_BINS; bin++ )
+            {
+                if( rfalDpoGetBinState( entry, bin ) == RFAL_DPO_BIN_UNRELIABLE )
+                {
+                    inc    = (uint8_t)(bin << RFAL_DPO_MEAS_BIN_SHIFT);
+                    learnt = true;
+                    break;
+                }
+            }
+        }
         
-        /* Apply the DPO Analog Config according to this treshold */
-        /* Technology field is being extended for DPO: 2msb are used for treshold step (only 4 allowed) */
-        modeID  = rfalAnalogConfigGenModeID( gRfalDpo.curMode, gRfalDpo.curBR, RFAL_ANALOG_CONFIG_DPO ); /* Generate Analog Config mode ID  */
-        modeID |= ((gRfalDpo.tableEntry << RFAL_DPO_ANALOGCONFIG_SHIFT) & RFAL_DPO_ANALOGCONFIG_MASK);   /* Add DPO treshold step|level     */
-        rfalSetAnalogConfig( modeID );                                                                   /* Apply DPO Analog Config         */
+        /* Decrement threshold: middle of the last bin up to which the lower power entry holds */
+        if( (entry + 1U) < gRfalDpo.tableEntries )
+        {
+            for( bin = 0; bin < RFAL_DPO_MEAS_BINS; bin++ )
+            {
+                binState = rfalDpoGetBinState( (entry + 1U), bin );
+                if( binState == RFAL_DPO_BIN_UNRELIABLE )
+                {
+                    /* Never step down into a bin the lower power entry fails on */
+                    dec    = RFAL_MIN( dec, ((bin == 0U) ? 0U : (uint8_t)((bin << RFAL_DPO_MEAS_BIN_SHIFT) - (1U << (RFAL_DPO_MEAS_BIN_SHIFT - 1U)))) );
+                    learnt = true;
+                    break;
+                }
+                if( binState == RFAL_DPO_BIN_RELIABLE )
+                {
+                    dec    = (uint8_t)((bin << RFAL_DPO_MEAS_BIN_SHIFT) + (1U << (RFAL_DPO_MEAS_BIN_SHIFT - 1U)));
+                    learnt = true;
+                }
+            }
+        }
+        
+        dpoTable[entry].inc = inc;
+        dpoTable[entry].dec = RFAL_MIN( dec, inc );
+    }
+    
+    if( !learnt )
+    {
+        return RFAL_ERR_NOMSG;
+    }
+    
+    gRfalDpo.stats.learnCnt++;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalDpoGetStats( rfalDpoStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
     }
     
+    (*stats) = gRfalDpo.stats;
     return RFAL_ERR_NONE;
 }
 
 
+/*******************************************************************************/
+void rfalDpoClearStats( void )
+{
+    RFAL_MEMSET( &gRfalDpo.stats, 0x00, sizeof(rfalDpoStats) );
+    gRfalDpo.winFrames = 0U;
+    gRfalDpo.winErr    = 0U;
+    gRfalDpo.cleanWin  = 0U;
+}
+
+
+/*******************************************************************************/
+static void rfalDpoApply( rfalMode mode, rfalBitRate br, uint8_t tableEntry )
+{
+    uint16_t      modeID;
+    rfalDpoEntry* dpoTable = (rfalDpoEntry*) gRfalDpo.currentDpo;
+    
+    /* Update local context */
+    gRfalDpo.curMode    = mode;
+    gRfalDpo.curBR      = br;
+    gRfalDpo.tableEntry = tableEntry;
+    
+    /* Get the new value for RFO resistance form the table and apply the new RFO resistance setting */ 
+    rfalChipSetRFO( dpoTable[gRfalDpo.tableEntry].rfoRes );
+    
+    /* Apply the DPO Analog Config according to this treshold */
+    /* Technology field is being extended for DPO: 2msb are used for treshold step (only 4 allowed) */
+    modeID  = rfalAnalogConfigGenModeID( gRfalDpo.curMode, gRfalDpo.curBR, RFAL_ANALOG_CONFIG_DPO ); /* Generate Analog Config mode ID  */
+    modeID |= ((gRfalDpo.tableEntry << RFAL_DPO_ANALOGCONFIG_SHIFT) & RFAL_DPO_ANALOGCONFIG_MASK);   /* Add DPO treshold step|level     */
+    rfalSetAnalogConfig( modeID );                                                                   /* Apply DPO Analog Config         */
+}
+
+
+/*******************************************************************************/
+static void rfalDpoStep( bool up )
+{
+    uint8_t tableEntry = gRfalDpo.tableEntry;
+    
+    if( up )
+    {
+        /* The top of the table represents the highest power */
+        if( tableEntry == 0U )
+        {
+            return;
+        }
+        tableEntry--;
+        gRfalDpo.stats.stepUpCnt++;
+        gRfalDpo.hold = ((uint16_t)RFAL_FEATURE_DPO_WINDOW * (uint16_t)RFAL_FEATURE_DPO_DOWN_WINDOWS);
+    }
+    else
+    {
+        /* Lower the power only if not known to fail at the current measurement */
+        if( ((tableEntry + 1U) >= gRfalDpo.tableEntries) || (rfalDpoGetBinState( (tableEntry + 1U), (gRfalDpo.stats.lastMeas >> RFAL_DPO_MEAS_BIN_SHIFT) ) == RFAL_DPO_BIN_UNRELIABLE) )
+        {
+            return;
+        }
+        tableEntry++;
+        gRfalDpo.stats.stepDownCnt++;
+    }
+    
+    rfalDpoApply( gRfalDpo.curMode, gRfalDpo.curBR, tableEntry );
+}
+
+
+/*******************************************************************************/
+static rfalDpoBinState rfalDpoGetBinState( uint8_t tableEntry, uint8_t bin )
+{
+    uint32_t frames;
+    uint32_t errs;
+    
+    frames = ((uint32_t)gRfalDpo.stats.entry[tableEntry].okCnt[bin] + gRfalDpo.stats.entry[tableEntry].errCnt[bin]);
+    errs   = gRfalDpo.stats.entry[tableEntry].errCnt[bin];
+    
+    if( frames < (uint32_t)RFAL_FEATURE_DPO_LEARN_MIN )
+    {
+        return RFAL_DPO_BIN_UNKNOWN;
+    }
+    return (((errs << RFAL_DPO_ERR_RATE_SHIFT) <= frames) ? RFAL_DPO_BIN_RELIABLE : RFAL_DPO_BIN_UNRELIABLE);
+}
+
+
 /*******************************************************************************/
 rfalDpoEntry* rfalDpoGetCurrentTableEntry( void )
 {
@@ -37,6 +37,7 @@
 #include "rfal_iso15693_2.h"
 #include "rfal_crc.h"
 #include "rfal_utils.h"
+#include "rfal_rf.h"
 
 /*
  ******************************************************************************
@@ -87,7 +88,8 @@
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static rfalIso15693PhyConfig_t gIso15693PhyConfig; /*!< current phy configuration */
+static rfalIso15693PhyConfig_t gIso15693PhyConfigInst[RFAL_FEATURE_INSTANCES]; /*!< current phy configuration per instance */
+#define gIso15693PhyConfig   gIso15693PhyConfigInst[rfalInstance()]            /*!< current phy configuration              */
 
 /*
 ******************************************************************************
@@ -65,6 +65,18 @@
     #error " RFAL: Invalid ISO-DEP APDU Max length. Please change RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN. "
 #endif
 
+#ifndef RFAL_FEATURE_ISO_DEP_RATE_WINDOW
+    #define RFAL_FEATURE_ISO_DEP_RATE_WINDOW       16U        /*!< I-Block exchanges per error rate window          */
+#endif
+
+#ifndef RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS
+    #define RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS    3U         /*!< Errors within a window to lower the bit rate     */
+#endif
+
+#ifndef RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS
+    #define RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS   4U         /*!< Error free windows to raise the bit rate         */
+#endif
+
 /*
  ******************************************************************************
  * DEFINES
@@ -428,16 +440,51 @@ typedef struct{
   uint16_t                APDURxPos;        /*!< APDU Rx position               */
   bool                    isAPDURxChaining; /*!< APDU Transceive chaining flag  */
   
+#if RFAL_FEATURE_ISO_DEP_POLL
+  rfalIsoDepSgApduTxRxParam SGParam;        /*!< Scatter/gather APDU TxRx params        */
+  bool                    isSG;             /*!< Scatter/gather APDU TxRx ongoing       */
+  bool                    isAckPending;     /*!< R(ACK) deferred until Rx buffer moved  */
+  uint8_t                 SGTxSeg;          /*!< Current Tx segment                     */
+  uint16_t                SGTxSegPos;       /*!< Position within the current Tx segment */
+  uint16_t                SGBlkLen;         /*!< Received I-Block INF length            */
+  uint8_t                 SGHdrSave[RFAL_ISODEP_PROLOGUE_SIZE]; /*!< Rx bytes under the I-Block header */
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+  
 }rfalIsoDep;
 
 
+#if RFAL_FEATURE_ISO_DEP_POLL
+/*! ISO-DEP Poller link rate manager */
+typedef struct
+{
+    bool                enabled;       /*!< Adaptive bit rate enabled                            */
+    bool                isPending;     /*!< Link max bit rate changed, not yet applied           */
+    bool                isXchgOn;      /*!< I-Block exchange ongoing                             */
+    rfalBitRate         actvBR;        /*!< Max bit rate requested on activation                 */
+    rfalIsoDepDevice    *sParamDev;    /*!< Device whose bit rate was set with S(PARAMETERS)     */
+    uint8_t             winXchg;       /*!< Exchanges on the current window                      */
+    uint8_t             winErr;        /*!< Errors on the current window                         */
+    uint8_t             cleanWin;      /*!< Consecutive error free windows                       */
+    uint16_t            xchgTxLen;     /*!< INF length sent on the ongoing exchange              */
+    uint32_t            xchgStart;     /*!< Start of the ongoing exchange [ms]                   */
+    rfalIsoDepLinkStats stats;         /*!< Link statistics                                      */
+}rfalIsoDepLink;
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+
+
 /*
  ******************************************************************************
  * LOCAL VARIABLES
  ******************************************************************************
  */
 
-static rfalIsoDep gIsoDep;    /*!< ISO-DEP Module instance               */
+static rfalIsoDep gIsoDepInst[RFAL_FEATURE_INSTANCES];  /*!< ISO-DEP Module instances             */
+#define gIsoDep  gIsoDepInst[rfalInstance()]             /*!< Current ISO-DEP Module instance      */
+
+#if RFAL_FEATURE_ISO_DEP_POLL
+static rfalIsoDepLink gIsoDepLinkInst[RFAL_FEATURE_INSTANCES]; /*!< ISO-DEP link rate manager instances        */
+#define gIsoDepLink  gIsoDepLinkInst[rfalInstance()]           /*!< Current ISO-DEP link rate manager instance */
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
 
 /*
  ******************************************************************************
@@ -453,6 +500,14 @@ static void rfalIsoDepApdu2IBLockParam( rfalIsoDepApduTxRxParam apduParam, rfalI
     static ReturnCode rfalIsoDepDataExchangePCD( uint16_t *outActRxLen, bool *outIsChaining );
     static void rfalIsoDepCalcBitRate(rfalBitRate maxAllowedBR, uint8_t piccBRCapability, rfalBitRate *dsi, rfalBitRate *dri);
     static uint32_t rfalIsoDepSFGI2SFGT( uint8_t sfgi );
+    static rfalBitRate rfalIsoDepLinkCurBR( void );
+    static void rfalIsoDepLinkStart( rfalBitRate *maxBR );
+    static void rfalIsoDepLinkStep( bool up );
+    static void rfalIsoDepLinkError( ReturnCode err );
+    static void rfalIsoDepLinkXchgDone( ReturnCode ret );
+    static void rfalIsoDepLinkApply( void );
+    static void rfalIsoDepSgTxIBlock( rfalIsoDepTxRxParam *iBlockParam );
+    static void rfalIsoDepSgRxIBlock( void );
 
     #if RFAL_FEATURE_NFCA
         static ReturnCode rfalIsoDepStartRATS( rfalIsoDepFSxI FSDI, uint8_t DID, rfalIsoDepAts *ats, uint8_t *atsLen );
@@ -496,6 +551,7 @@ static ReturnCode rfalIsoDepTx( uint8_t pcb, const uint8_t* txBuf, uint8_t *infB
     uint8_t    *txBlock;
     uint16_t   txBufLen;
     uint8_t    computedPcb;
+    ReturnCode ret;
     rfalTransceiveContext    ctx;
 
     
@@ -541,10 +597,20 @@ static ReturnCode rfalIsoDepTx( uint8_t pcb, const uint8_t* txBuf, uint8_t *infB
     {
         return RFAL_ERR_NOTSUPP;
     }
-        
     
     rfalCreateByteFlagsTxRxContext( ctx, txBlock, txBufLen, gIsoDep.rxBuf, gIsoDep.rxBufLen, gIsoDep.rxLen, RFAL_TXRX_FLAGS_DEFAULT, ((gIsoDep.role == ISODEP_ROLE_PICC) ? RFAL_FWT_NONE : fwt ) );
-    return rfalStartTransceive( &ctx );
+    RFAL_EXIT_ON_ERR( ret, rfalStartTransceive( &ctx ) );
+    
+#if RFAL_FEATURE_ISO_DEP_POLL
+    /* Only blocks actually sent count, not a transceive refused e.g. with the field off */
+    if( gIsoDep.role == ISODEP_ROLE_PCD )
+    {
+        gIsoDepLink.stats.roundTripCnt++;
+        gIsoDepLink.stats.iBlockTxCnt += (rfalIsoDep_PCBisIBlock(computedPcb) ? 1U : 0U);
+    }
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+    
+    return RFAL_ERR_NONE;
 }
 
 /*******************************************************************************/
@@ -710,6 +776,11 @@ void rfalIsoDepInitialize( void )
     gIsoDep.APDUParam.rxBuf = NULL;
     gIsoDep.APDUParam.txBuf = NULL;
     
+#if RFAL_FEATURE_ISO_DEP_POLL
+    gIsoDep.isSG         = false;
+    gIsoDep.isAckPending = false;
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+    
     rfalIsoDepClearCounters();
     
     /* Destroy any ongoing WTX timer */
@@ -789,6 +860,14 @@ static ReturnCode rfalIsoDepDataExchangePCD( uint16_t *outActRxLen, bool *outIsC
         /*******************************************************************************/
         case ISODEP_ST_PCD_WAIT_DSL:   /*  PRQA S 2003 # MISRA 16.3 - Intentional fall through */
         case ISODEP_ST_PCD_RX:
+            
+            /* Send the R(ACK) deferred on scatter/gather PICC chaining, the Rx buffer is now past previous INF */
+            if( gIsoDep.isAckPending )
+            {
+                gIsoDep.isAckPending = false;
+                RFAL_EXIT_ON_ERR( ret, rfalIsoDepHandleControlMsg( ISODEP_R_ACK, RFAL_ISODEP_NO_PARAM ) );
+                return RFAL_ERR_BUSY;
+            }
                       
             ret = rfalGetTransceiveStatus();
             switch( ret )
@@ -800,6 +879,8 @@ static ReturnCode rfalIsoDepDataExchangePCD( uint16_t *outActRxLen, bool *outIsC
                 case RFAL_ERR_FRAMING:          /* added to handle test cases scenario TC_POL_NFCB_T4AT_BI_82_x_y & TC_POL_NFCB_T4BT_BI_82_x_y */
                 case RFAL_ERR_INCOMPLETE_BYTE:  /* added to handle test cases scenario TC_POL_NFCB_T4AT_BI_82_x_y & TC_POL_NFCB_T4BT_BI_82_x_y */
                     
+                    rfalIsoDepLinkError( ret );
+                    
                     if( gIsoDep.isRxChaining )
                     {   /* Rule 5 - In PICC chaining when a invalid/timeout occurs -> R-ACK */                        
                         RFAL_EXIT_ON_ERR( ret, rfalIsoDepHandleControlMsg( ISODEP_R_ACK, RFAL_ISODEP_NO_PARAM ) );
@@ -832,7 +913,7 @@ static ReturnCode rfalIsoDepDataExchangePCD( uint16_t *outActRxLen, bool *outIsC
             
             
             /* Check rcvd msg length, cannot be less then the expected header */
-            if( ((*outActRxLen) < gIsoDep.hdrLen) || ((*outActRxLen) >= gIsoDep.ourFsx) )
+            if( ((*outActRxLen) < gIsoDep.hdrLen) || ((*outActRxLen) > (gIsoDep.ourFsx - ISODEP_CRC_LEN)) )
             {
                 return RFAL_ERR_PROTO;
             }
@@ -941,6 +1022,8 @@ static ReturnCode rfalIsoDepDataExchangePCD( uint16_t *outActRxLen, bool *outIsC
             /*******************************************************************************/
             else if( rfalIsoDep_PCBisIBlock(rxPCB) )
             {
+                gIsoDepLink.stats.iBlockRxCnt++;
+                
                 /*******************************************************************************/
                 /* is PICC performing chaining                                                 */
                 if( rfalIsoDep_PCBisChaining(rxPCB) )
@@ -955,8 +1038,15 @@ static ReturnCode rfalIsoDepDataExchangePCD( uint16_t *outActRxLen, bool *outIsC
                         
                         rfalIsoDepClearCounters();  /* Clear counters in case R counter is already at max */
                         
-                        /* Rule 2 - Send ACK */
-                        RFAL_EXIT_ON_ERR( ret, rfalIsoDepHandleControlMsg( ISODEP_R_ACK, RFAL_ISODEP_NO_PARAM ) );
+                        /* Rule 2 - Send ACK. On scatter/gather the next I-Block lands after this one, ACK once Rx buffer moved */
+                        if( gIsoDep.isSG )
+                        {
+                            gIsoDep.isAckPending = true;
+                        }
+                        else
+                        {
+                            RFAL_EXIT_ON_ERR( ret, rfalIsoDepHandleControlMsg( ISODEP_R_ACK, RFAL_ISODEP_NO_PARAM ) );
+                        }
                         
                         /* Received I-Block with chaining, send current data to DH */
                         
@@ -1128,6 +1218,24 @@ uint16_t rfalIsoDepFSxI2FSx( uint8_t FSxI )
 }
 
 
+/*******************************************************************************/
+rfalIsoDepFSxI rfalIsoDepGetMaxFSxI( void )
+{
+    uint8_t fsi;
+    
+    /* Step up while the next Frame Size is larger (not clamped by compliance mode) and fits the I-Block buffers */
+    fsi = (uint8_t)RFAL_ISODEP_FSXI_16;
+    while( (fsi < (uint8_t)RFAL_ISODEP_FSXI_4096)                                                  && 
+           (rfalIsoDepFSxI2FSx( (fsi + 1U) ) > rfalIsoDepFSxI2FSx( fsi ))                             &&
+           (rfalIsoDepFSxI2FSx( (fsi + 1U) ) <= (uint16_t)RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN) )
+    {
+        fsi++;
+    }
+    
+    return (rfalIsoDepFSxI)fsi;      /* PRQA S 4342 # MISRA 10.5 - Bounded by RFAL_ISODEP_FSXI_4096, no invalid enum values are created */
+}
+
+
 #if RFAL_FEATURE_ISO_DEP_LISTEN
 
 /*******************************************************************************/
@@ -1481,6 +1589,10 @@ ReturnCode rfalIsoDepStartTransceive( rfalIsoDepTxRxParam param )
     gIsoDep.rxLen        = param.rxLen;
     gIsoDep.rxChaining   = param.isRxChaining;
     
+#if RFAL_FEATURE_ISO_DEP_POLL
+    gIsoDep.isAckPending = false;
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+    
     
     gIsoDep.fwt          = param.FWT;
     gIsoDep.dFwt         = param.dFWT;
@@ -1516,6 +1628,14 @@ ReturnCode rfalIsoDepStartTransceive( rfalIsoDepTxRxParam param )
        return RFAL_ERR_NONE;
     }
     
+#if RFAL_FEATURE_ISO_DEP_POLL
+    gIsoDepLink.isXchgOn  = true;
+    gIsoDepLink.xchgTxLen = gIsoDep.txBufLen;
+    gIsoDepLink.xchgStart = platformGetSysTick();
+    gIsoDepLink.stats.fsd = gIsoDep.ourFsx;
+    gIsoDepLink.stats.fsc = gIsoDep.fsx;
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+    
     gIsoDep.state = ISODEP_ST_PCD_TX;
     return RFAL_ERR_NONE;
 }
@@ -1535,7 +1655,14 @@ ReturnCode rfalIsoDepGetTransceiveStatus( void )
     else
     {
 #if RFAL_FEATURE_ISO_DEP_POLL
-        return rfalIsoDepDataExchangePCD( gIsoDep.rxLen, gIsoDep.rxChaining );
+        ReturnCode ret;
+        
+        ret = rfalIsoDepDataExchangePCD( gIsoDep.rxLen, gIsoDep.rxChaining );
+        if( ret != RFAL_ERR_BUSY )
+        {
+            rfalIsoDepLinkXchgDone( ret );
+        }
+        return ret;
 #else
         return RFAL_ERR_NOTSUPP;
 #endif /* RFAL_FEATURE_ISO_DEP_POLL */
@@ -2133,6 +2260,9 @@ ReturnCode rfalIsoDepPollAStartActivation( rfalIsoDepFSxI FSDI, uint8_t DID, rfa
     /* Enable EMD suppresssion|handling according to  Digital 2.1  4.1.1.1 ; EMVCo 3.0  4.9.2 ; ISO 14443-3  8.3 */
     rfalSetErrorHandling( RFAL_ERRORHANDLING_EMD );
     
+    /* Apply the link max bit rate to the PPS to be sent */
+    rfalIsoDepLinkStart( &maxBR );
+    
     /* Start RATS Transceive */
     RFAL_EXIT_ON_ERR( ret, rfalIsoDepStartRATS( FSDI, DID, &rfalIsoDepDev->activation.A.Listener.ATS, &rfalIsoDepDev->activation.A.Listener.ATSLen ) );
     
@@ -2383,7 +2513,8 @@ ReturnCode rfalIsoDepPollBStartActivation( rfalIsoDepFSxI FSDI, uint8_t DID, rfa
     }
     
     
-    /* Calculate max Bit Rate */
+    /* Calculate max Bit Rate, bounded by the link max bit rate */
+    rfalIsoDepLinkStart( &maxBR );
     rfalIsoDepCalcBitRate( maxBR, nfcbDev->sensbRes.protInfo.BRC, &rfalIsoDepDev->info.DSI, &rfalIsoDepDev->info.DRI );
     
     /***************************************************************************/
@@ -2484,6 +2615,13 @@ ReturnCode rfalIsoDepPollHandleSParameters( rfalIsoDepDevice *rfalIsoDepDev, rfa
         return RFAL_ERR_PARAM;
     }
     
+    /* Bound the bit rates to be selected by the link max bit rate */
+    if( gIsoDepLink.enabled )
+    {
+        maxTxBR = RFAL_MIN( maxTxBR, gIsoDepLink.stats.maxBR );
+        maxRxBR = RFAL_MIN( maxRxBR, gIsoDepLink.stats.maxBR );
+    }
+    
     it          = 0;
     supPICC2PCD = 0x00;
     supPCD2PICC = 0x00;
@@ -2584,6 +2722,10 @@ ReturnCode rfalIsoDepPollHandleSParameters( rfalIsoDepDevice *rfalIsoDepDev, rfa
     rfalIsoDepDev->info.DRI = txBR;
     rfalIsoDepDev->info.DSI = rxBR;
     
+    /* S(PARAMETERS) may be reissued during the session, link bit rate can follow the errors */
+    gIsoDepLink.sParamDev = rfalIsoDepDev;
+    gIsoDepLink.isPending = false;
+    
     return RFAL_ERR_NONE;
 }
 
@@ -2685,6 +2827,205 @@ static uint32_t rfalIsoDepSFGI2SFGT( uint8_t sfgi )
     return (rfalConv1fcToMs(sfgt) + 1U);
 }
 
+
+/*******************************************************************************/
+static rfalBitRate rfalIsoDepLinkCurBR( void )
+{
+    rfalBitRate txBR;
+    rfalBitRate rxBR;
+    
+    if( rfalGetBitRate( &txBR, &rxBR ) != RFAL_ERR_NONE )
+    {
+        return RFAL_BR_KEEP;
+    }
+    
+    /* The link is as fast as its fastest direction */
+    return RFAL_MAX( txBR, rxBR );
+}
+
+
+/*******************************************************************************/
+static void rfalIsoDepLinkStart( rfalBitRate *maxBR )
+{
+    gIsoDepLink.isPending = false;
+    gIsoDepLink.isXchgOn  = false;
+    gIsoDepLink.sParamDev = NULL;
+    gIsoDepLink.winXchg   = 0U;
+    gIsoDepLink.winErr    = 0U;
+    gIsoDepLink.cleanWin  = 0U;
+    gIsoDepLink.actvBR    = (*maxBR);
+    
+    /* Bound the bit rate to be negotiated by the link max bit rate */
+    if( gIsoDepLink.enabled && ((*maxBR) <= RFAL_BR_848) )
+    {
+        (*maxBR) = RFAL_MIN( (*maxBR), gIsoDepLink.stats.maxBR );
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalIsoDepLinkStep( bool up )
+{
+    rfalBitRate curBR;
+    
+    gIsoDepLink.winXchg  = 0U;
+    gIsoDepLink.winErr   = 0U;
+    gIsoDepLink.cleanWin = 0U;
+    
+    if( !gIsoDepLink.enabled )
+    {
+        return;
+    }
+    
+    if( up )
+    {
+        /* Raise the link max bit rate up to what was requested on activation */
+        if( (gIsoDepLink.actvBR <= RFAL_BR_848) && (gIsoDepLink.stats.maxBR < gIsoDepLink.actvBR) )
+        {
+            gIsoDepLink.stats.maxBR = (rfalBitRate)((uint8_t)gIsoDepLink.stats.maxBR + 1U); /* PRQA S 4342 # MISRA 10.5 - Bounded by actvBR, no invalid enum values are created */
+            gIsoDepLink.stats.stepUpCnt++;
+            gIsoDepLink.isPending = true;
+        }
+        return;
+    }
+    
+    /* Lower the link max bit rate one step below the current bit rate */
+    curBR = RFAL_MIN( rfalIsoDepLinkCurBR(), gIsoDepLink.stats.maxBR );
+    if( (curBR != RFAL_BR_106) && (curBR <= RFAL_BR_848) )
+    {
+        gIsoDepLink.stats.maxBR = (rfalBitRate)((uint8_t)curBR - 1U);               /* PRQA S 4342 # MISRA 10.5 - curBR within ]106 ; 848], no invalid enum values are created */
+        gIsoDepLink.stats.stepDownCnt++;
+        gIsoDepLink.isPending = true;
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalIsoDepLinkError( ReturnCode err )
+{
+    rfalBitRate curBR;
+    
+    if( !gIsoDepLink.isXchgOn )
+    {
+        return;
+    }
+    
+    curBR = rfalIsoDepLinkCurBR();
+    if( curBR < RFAL_ISODEP_LINK_RATES )
+    {
+        if( err == RFAL_ERR_TIMEOUT )
+        {
+            gIsoDepLink.stats.rate[curBR].toErrCnt++;
+        }
+        else
+        {
+            gIsoDepLink.stats.rate[curBR].crcErrCnt++;
+        }
+    }
+    
+    gIsoDepLink.cleanWin = 0U;
+    if( ++gIsoDepLink.winErr >= (uint8_t)RFAL_FEATURE_ISO_DEP_RATE_DOWN_ERRS )
+    {
+        rfalIsoDepLinkStep( false );
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalIsoDepLinkXchgDone( ReturnCode ret )
+{
+    rfalBitRate curBR;
+    
+    if( !gIsoDepLink.isXchgOn )
+    {
+        return;
+    }
+    
+    if( (ret != RFAL_ERR_NONE) && (ret != RFAL_ERR_AGAIN) )
+    {
+        /* Exchange failed even after the R(NAK) retransmissions */
+        gIsoDepLink.isXchgOn = false;
+        rfalIsoDepLinkStep( false );
+        return;
+    }
+    
+    curBR = rfalIsoDepLinkCurBR();
+    if( curBR < RFAL_ISODEP_LINK_RATES )
+    {
+        gIsoDepLink.stats.rate[curBR].txBytes  += gIsoDepLink.xchgTxLen;
+        gIsoDepLink.stats.rate[curBR].rxBytes  += (*gIsoDep.rxLen);
+        gIsoDepLink.stats.rate[curBR].xchgTime += (platformGetSysTick() - gIsoDepLink.xchgStart);
+        gIsoDepLink.stats.rate[curBR].xchgCnt++;
+    }
+    
+    /* On PICC chaining the exchange continues with the next I-Block */
+    gIsoDepLink.isXchgOn  = (ret == RFAL_ERR_AGAIN);
+    gIsoDepLink.xchgTxLen = 0U;
+    gIsoDepLink.xchgStart = platformGetSysTick();
+    
+    if( ++gIsoDepLink.winXchg >= (uint8_t)RFAL_FEATURE_ISO_DEP_RATE_WINDOW )
+    {
+        gIsoDepLink.cleanWin = ((gIsoDepLink.winErr == 0U) ? (gIsoDepLink.cleanWin + 1U) : 0U);
+        gIsoDepLink.winXchg  = 0U;
+        gIsoDepLink.winErr   = 0U;
+        
+        if( gIsoDepLink.cleanWin >= (uint8_t)RFAL_FEATURE_ISO_DEP_RATE_UP_WINDOWS )
+        {
+            rfalIsoDepLinkStep( true );
+        }
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalIsoDepLinkApply( void )
+{
+    /* Apply a pending link bit rate change before the APDU, only possible via S(PARAMETERS) */
+    if( gIsoDepLink.isPending && (gIsoDepLink.sParamDev != NULL) )
+    {
+        gIsoDepLink.isPending = false;
+        if( rfalIsoDepPollHandleSParameters( gIsoDepLink.sParamDev, gIsoDepLink.stats.maxBR, gIsoDepLink.stats.maxBR ) != RFAL_ERR_NONE )
+        {
+            /* PICC kept its bit rate, new link max bit rate only applies on next activation */
+            gIsoDepLink.sParamDev = NULL;
+        }
+    }
+}
+
+
+/*******************************************************************************/
+void rfalIsoDepPollSetAdaptiveBitRate( bool enable )
+{
+    /* When enabling start from the highest bit rate */
+    if( enable && (!gIsoDepLink.enabled) )
+    {
+        gIsoDepLink.stats.maxBR = RFAL_BR_848;
+    }
+    
+    gIsoDepLink.enabled = enable;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalIsoDepPollGetLinkStats( rfalIsoDepLinkStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    (*stats) = gIsoDepLink.stats;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalIsoDepPollClearLinkStats( void )
+{
+    RFAL_MEMSET( &gIsoDepLink.stats, 0x00, sizeof(rfalIsoDepLinkStats) );
+    gIsoDepLink.stats.maxBR = RFAL_BR_848;
+}
+
 #endif  /* RFAL_FEATURE_ISO_DEP_POLL */
  
 
@@ -2723,6 +3064,13 @@ ReturnCode rfalIsoDepStartApduTransceive( rfalIsoDepApduTxRxParam param )
 {
     rfalIsoDepTxRxParam txRxParam;
     
+#if RFAL_FEATURE_ISO_DEP_POLL
+    if( gIsoDep.role == ISODEP_ROLE_PCD )
+    {
+        rfalIsoDepLinkApply();
+    }
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+    
     /* Initialize and store APDU context */
     gIsoDep.APDUParam = param;
     gIsoDep.APDUTxPos = 0;
@@ -2817,4 +3165,187 @@ ReturnCode rfalIsoDepGetApduTransceiveStatus( void )
     return ret;
  }
 
+
+#if RFAL_FEATURE_ISO_DEP_POLL
+
+/*******************************************************************************/
+static void rfalIsoDepSgTxIBlock( rfalIsoDepTxRxParam *iBlockParam )
+{
+    const rfalIsoDepSgSeg *seg;
+    uint16_t              maxInfLen;
+    uint16_t              infLen;
+    uint16_t              segLen;
+    
+    /* Gather the next I-Block INF from the Tx segments. The I-Block header is   *
+     * prepended in place, which cannot be done on the caller's (const) segments */
+    maxInfLen = rfalIsoDepGetMaxInfLen();
+    infLen    = 0U;
+    
+    while( (infLen < maxInfLen) && (gIsoDep.SGTxSeg < gIsoDep.SGParam.txSegCnt) )
+    {
+        seg    = &gIsoDep.SGParam.txSeg[gIsoDep.SGTxSeg];
+        segLen = RFAL_MIN( (uint16_t)(seg->len - gIsoDep.SGTxSegPos), (uint16_t)(maxInfLen - infLen) );
+        
+        if( segLen > 0U )      /* MISRA 21.18 */
+        {
+            RFAL_MEMCPY( &gIsoDep.SGParam.tmpBuf->inf[infLen], &seg->buf[gIsoDep.SGTxSegPos], segLen );
+        }
+        
+        infLen             += segLen;
+        gIsoDep.SGTxSegPos += segLen;
+        
+        if( gIsoDep.SGTxSegPos >= seg->len )
+        {
+            gIsoDep.SGTxSeg++;
+            gIsoDep.SGTxSegPos = 0U;
+        }
+    }
+    
+    /* Skip trailing empty segments so that no empty chained I-Block is sent */
+    while( (gIsoDep.SGTxSeg < gIsoDep.SGParam.txSegCnt) && (gIsoDep.SGParam.txSeg[gIsoDep.SGTxSeg].len == 0U) )
+    {
+        gIsoDep.SGTxSeg++;
+    }
+    
+    gIsoDep.APDUTxPos += infLen;
+    
+    iBlockParam->DID          = gIsoDep.SGParam.DID;
+    iBlockParam->ourFSx       = gIsoDep.SGParam.ourFSx;
+    iBlockParam->FSx          = gIsoDep.SGParam.FSx;
+    iBlockParam->FWT          = gIsoDep.SGParam.FWT;
+    iBlockParam->dFWT         = gIsoDep.SGParam.dFWT;
+    iBlockParam->txBuf        = gIsoDep.SGParam.tmpBuf;
+    iBlockParam->txBufLen     = infLen;
+    iBlockParam->isTxChaining = (gIsoDep.SGTxSeg < gIsoDep.SGParam.txSegCnt);
+    iBlockParam->rxBuf        = gIsoDep.SGParam.tmpBuf;                  /* Replaced by the caller's Rx buffer on rfalIsoDepSgRxIBlock() */
+    iBlockParam->rxLen        = &gIsoDep.SGBlkLen;
+    iBlockParam->isRxChaining = &gIsoDep.isAPDURxChaining;
+}
+
+
+/*******************************************************************************/
+static void rfalIsoDepSgRxIBlock( void )
+{
+    uint8_t hdrLen;
+    
+    hdrLen = RFAL_ISODEP_PCB_LEN;
+    if( gIsoDep.did != RFAL_ISODEP_NO_DID )  { hdrLen += RFAL_ISODEP_DID_LEN; }
+    if( gIsoDep.nad != RFAL_ISODEP_NO_NAD )  { hdrLen += RFAL_ISODEP_NAD_LEN; }
+    
+    /* Receive the next I-Block straight into the caller's buffer, with its INF    *
+     * right after the data already received. The I-Block header overwrites the    *
+     * last bytes received (or the prologue), keep them to be restored afterwards  */
+    gIsoDep.rxBuf       = &gIsoDep.SGParam.rxBuf[gIsoDep.APDURxPos] - hdrLen;
+    gIsoDep.rxBufInfPos = hdrLen;
+    gIsoDep.rxBufLen    = ((uint16_t)hdrLen + (gIsoDep.SGParam.rxBufLen - gIsoDep.APDURxPos));
+    
+    RFAL_MEMCPY( gIsoDep.SGHdrSave, gIsoDep.rxBuf, hdrLen );
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalIsoDepStartSgApduTransceive( rfalIsoDepSgApduTxRxParam param )
+{
+    ReturnCode          ret;
+    rfalIsoDepTxRxParam txRxParam;
+    
+    if( ((param.txSeg == NULL) && (param.txSegCnt != 0U)) || (param.rxBuf == NULL) || (param.rxLen == NULL) || (param.tmpBuf == NULL) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /* Listen mode receives the C-APDU first, scatter/gather only supported as Poller */
+    if( gIsoDep.role != ISODEP_ROLE_PCD )
+    {
+        return RFAL_ERR_NOTSUPP;
+    }
+    
+    rfalIsoDepLinkApply();
+    
+    /* Initialize and store scatter/gather APDU context */
+    gIsoDep.SGParam    = param;
+    gIsoDep.SGTxSeg    = 0U;
+    gIsoDep.SGTxSegPos = 0U;
+    gIsoDep.APDUTxPos  = 0U;
+    gIsoDep.APDURxPos  = 0U;
+    *param.rxLen       = 0U;
+    
+    /* Assign current FSx to calculate INF length (only change the FSx from activation if no to Keep) */
+    gIsoDep.ourFsx = (( param.ourFSx != RFAL_ISODEP_FSX_KEEP ) ? param.ourFSx : gIsoDep.ourFsx);
+    gIsoDep.fsx    = param.FSx;
+    
+    rfalIsoDepSgTxIBlock( &txRxParam );
+    RFAL_EXIT_ON_ERR( ret, rfalIsoDepStartTransceive( txRxParam ) );
+    
+    gIsoDep.isSG = true;
+    rfalIsoDepSgRxIBlock();
+    
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalIsoDepGetSgApduTransceiveStatus( void )
+{
+    ReturnCode          ret;
+    rfalIsoDepTxRxParam txRxParam;
+    
+    if( !gIsoDep.isSG )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+    
+    ret = rfalIsoDepGetTransceiveStatus();
+    if( ret == RFAL_ERR_BUSY )
+    {
+        return RFAL_ERR_BUSY;
+    }
+    
+    /* Give back the bytes underneath the I-Block header */
+    RFAL_MEMCPY( gIsoDep.rxBuf, gIsoDep.SGHdrSave, gIsoDep.rxBufInfPos );
+    
+    switch( ret )
+    {
+        /*******************************************************************************/
+        case RFAL_ERR_NONE:
+            
+            /* Check if we are still doing chaining on Tx */
+            if( gIsoDep.isTxChaining )
+            {
+                rfalIsoDepSgTxIBlock( &txRxParam );
+                RFAL_EXIT_ON_ERR( ret, rfalIsoDepStartTransceive( txRxParam ) );
+                rfalIsoDepSgRxIBlock();
+                return RFAL_ERR_BUSY;
+            }
+            
+            /* APDU TxRx is done */
+            /* fall through */
+        
+        /*******************************************************************************/
+        case RFAL_ERR_AGAIN:        /*  PRQA S 2003 # MISRA 16.3 - Intentional fall through */
+            
+            /* INF already in place, only account for it */
+            gIsoDep.APDURxPos    += gIsoDep.SGBlkLen;
+            *gIsoDep.SGParam.rxLen = gIsoDep.APDURxPos;
+            
+            if( ret == RFAL_ERR_AGAIN )
+            {
+                /* Move Rx buffer past this INF, the deferred R(ACK) is sent next */
+                rfalIsoDepSgRxIBlock();
+                return RFAL_ERR_BUSY;
+            }
+            break;
+            
+        /*******************************************************************************/
+        default:
+            /* MISRA 16.4: no empty default statement (a comment being enough) */
+            break;
+    }
+    
+    gIsoDep.isSG = false;
+    return ret;
+}
+
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+
 #endif /* RFAL_FEATURE_ISO_DEP */
@@ -0,0 +1,1396 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_llcp.c
+ *
+ *  \brief Implementation of the LLCP link on top of NFC-DEP
+ *
+ *  Each rfalLlcpWorker() call performs a single NFC-DEP exchange carrying
+ *  one LLCP PDU each way. When more than one PDU is pending (e.g. several
+ *  I PDUs within the remote receive window, or an I PDU plus a CC) they are
+ *  aggregated on a single AGF PDU, up to the remote link MIU, so that the
+ *  window is filled on one exchange instead of one SYMM turn per PDU.
+ *
+ *  I PDUs are composed straight from the caller buffers, RR is only sent
+ *  when no I PDU can carry the acknowledge.
+ *
+ *  This implementation was based on the following specs:
+ *    - NFC Forum Logical Link Control Protocol 1.3  2016-01-06
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_llcp.h"
+#include "rfal_nfc.h"
+#include "rfal_rf.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#ifndef RFAL_FEATURE_LLCP
+    #define RFAL_FEATURE_LLCP   false    /* LLCP module configuration missing. Disabled by default */
+#endif
+
+#if RFAL_FEATURE_LLCP
+
+#if !RFAL_FEATURE_NFC_DEP
+    #error " RFAL: LLCP requires NFC-DEP. Please enable RFAL_FEATURE_NFC_DEP "
+#endif
+
+#if ( (RFAL_FEATURE_LLCP_MIU < RFAL_LLCP_MIU_DEFAULT) || (RFAL_FEATURE_LLCP_MIU > (RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN - 3U)) )
+    #error " RFAL: Invalid LLCP MIU. Must be at least 128 and fit a PDU on RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN "
+#endif
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_LLCP_MAGIC_LEN            3U       /*!< LLCP magic number length                      LLCP 1.3  6.2.3.1 */
+#define RFAL_LLCP_HDR_LEN              2U       /*!< DSAP | PTYPE | SSAP header length                              */
+#define RFAL_LLCP_SEQ_LEN              1U       /*!< N(S) | N(R) sequence field length                              */
+#define RFAL_LLCP_AGF_LEN_LEN          2U       /*!< Length field of each PDU on an AGF                             */
+#define RFAL_LLCP_TLV_HDR_LEN          2U       /*!< Parameter Type and Length                                      */
+
+#define RFAL_LLCP_VERSION              0x11U    /*!< LLCP version 1.1 (major 1)                                     */
+#define RFAL_LLCP_VERSION_MAJOR        0x01U    /*!< LLCP major version supported                                   */
+#define RFAL_LLCP_MIUX_MASK            0x07FFU  /*!< MIUX value mask                                                */
+#define RFAL_LLCP_RW_MASK              0x0FU    /*!< RW value mask                                                  */
+#define RFAL_LLCP_SEQ_MASK             0x0FU    /*!< Sequence numbers are modulo 16                                 */
+#define RFAL_LLCP_OPT_LSC_BOTH         0x03U    /*!< Link Service Class 3: connectionless and connection-oriented   */
+#define RFAL_LLCP_LTO_UNIT             10U      /*!< LTO unit [ms]                                                  */
+#define RFAL_LLCP_LTO_DEFAULT          100U     /*!< Default LTO [ms]                                               */
+#define RFAL_LLCP_RW_DEFAULT           1U       /*!< Default RW                                                     */
+
+#define RFAL_LLCP_SAP_LLC              0x00U    /*!< LLC Link Management SAP                                        */
+#define RFAL_LLCP_SAP_WKS_MAX          0x0FU    /*!< Last well-known SAP                                            */
+#define RFAL_LLCP_SAP_SDP_MAX          0x1FU    /*!< Last SAP assigned by the SDP to registered services            */
+#define RFAL_LLCP_SAP_OUT_FIRST        0x20U    /*!< First SAP for outgoing connections                             */
+#define RFAL_LLCP_SAP_MAX              0x3FU    /*!< Last SAP                                                       */
+
+#define RFAL_LLCP_SDRES_MAX            4U       /*!< Pending SNL responses                                          */
+#define RFAL_LLCP_SN_MAX_LEN           64U      /*!< Max service name length on an outgoing CONNECT                 */
+
+#define RFAL_LLCP_TXBUF_LEN            RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN  /*!< Largest PDU NFC-DEP carries     */
+
+/* PDU types   LLCP 1.3  Table 2 */
+#define RFAL_LLCP_PTYPE_SYMM           0x00U    /*!< Symmetry                                                       */
+#define RFAL_LLCP_PTYPE_PAX            0x01U    /*!< Parameter Exchange                                             */
+#define RFAL_LLCP_PTYPE_AGF            0x02U    /*!< Aggregated Frame                                               */
+#define RFAL_LLCP_PTYPE_UI             0x03U    /*!< Unnumbered Information                                         */
+#define RFAL_LLCP_PTYPE_CONNECT        0x04U    /*!< Connect                                                        */
+#define RFAL_LLCP_PTYPE_DISC           0x05U    /*!< Disconnect                                                     */
+#define RFAL_LLCP_PTYPE_CC             0x06U    /*!< Connection Complete                                            */
+#define RFAL_LLCP_PTYPE_DM             0x07U    /*!< Disconnected Mode                                              */
+#define RFAL_LLCP_PTYPE_FRMR           0x08U    /*!< Frame Reject                                                   */
+#define RFAL_LLCP_PTYPE_SNL            0x09U    /*!< Service Name Lookup                                            */
+#define RFAL_LLCP_PTYPE_I              0x0CU    /*!< Information                                                    */
+#define RFAL_LLCP_PTYPE_RR             0x0DU    /*!< Receive Ready                                                  */
+#define RFAL_LLCP_PTYPE_RNR            0x0EU    /*!< Receive Not Ready                                              */
+
+/* Parameter types   LLCP 1.3  Table 4 */
+#define RFAL_LLCP_PARAM_VERSION        0x01U    /*!< Version Number                                                 */
+#define RFAL_LLCP_PARAM_MIUX           0x02U    /*!< Maximum Information Unit Extension                             */
+#define RFAL_LLCP_PARAM_WKS            0x03U    /*!< Well-Known Service List                                        */
+#define RFAL_LLCP_PARAM_LTO            0x04U    /*!< Link Timeout                                                   */
+#define RFAL_LLCP_PARAM_RW             0x05U    /*!< Receive Window Size                                            */
+#define RFAL_LLCP_PARAM_SN             0x06U    /*!< Service Name                                                   */
+#define RFAL_LLCP_PARAM_OPT            0x07U    /*!< Option                                                         */
+#define RFAL_LLCP_PARAM_SDREQ          0x08U    /*!< Service Discovery Request                                      */
+#define RFAL_LLCP_PARAM_SDRES          0x09U    /*!< Service Discovery Response                                     */
+
+/* DM reasons   LLCP 1.3  Table 5 */
+#define RFAL_LLCP_DM_DISC_ACK          0x00U    /*!< Disconnect acknowledged                                        */
+#define RFAL_LLCP_DM_NO_CONN           0x01U    /*!< No active connection for the SAPs                              */
+#define RFAL_LLCP_DM_NO_SERVICE        0x02U    /*!< No service bound to the target SAP                             */
+#define RFAL_LLCP_DM_REJECTED          0x03U    /*!< CONNECT rejected by the service                                */
+#define RFAL_LLCP_DM_NO_RESOURCES      0x20U    /*!< No resources to accept the connection temporarily              */
+
+/*
+ ******************************************************************************
+ * GLOBAL MACROS
+ ******************************************************************************
+ */
+
+#define rfalLlcpHdr0( dsap, ptype )    (uint8_t)( ((dsap) << 2U) | ((ptype) >> 2U) )        /*!< First header byte  */
+#define rfalLlcpHdr1( ptype, ssap )    (uint8_t)( (((ptype) & 0x03U) << 6U) | (ssap) )      /*!< Second header byte */
+#define rfalLlcpSeqInc( n )            (uint8_t)( ((n) + 1U) & RFAL_LLCP_SEQ_MASK )         /*!< Next sequence number */
+#define rfalLlcpSeqDiff( a, b )        (uint8_t)( ((a) - (b)) & RFAL_LLCP_SEQ_MASK )        /*!< Sequence distance    */
+#define rfalLlcpIsLinkValid( l )       ( (l) < RFAL_FEATURE_LLCP_LINKS )                     /*!< Link handle check    */
+
+/*
+ ******************************************************************************
+ * LOCAL DATA TYPES
+ ******************************************************************************
+ */
+
+/*! LLCP data link */
+typedef struct
+{
+    rfalLlcpLinkState     state;        /*!< Data link state                                  */
+    uint8_t               lsap;         /*!< Local SAP                                        */
+    uint8_t               rsap;         /*!< Remote SAP                                       */
+    uint8_t               vs;           /*!< V(S)  Send state variable                        */
+    uint8_t               vsa;          /*!< V(SA) Send acknowledgement state variable        */
+    uint8_t               vr;           /*!< V(R)  Receive state variable                     */
+    uint8_t               vra;          /*!< V(RA) Receive acknowledgement state variable     */
+    uint16_t              miu;          /*!< Remote MIU for this data link                    */
+    uint8_t               rw;           /*!< Remote receive window                            */
+    bool                  remoteBusy;   /*!< Remote sent RNR                                  */
+    uint8_t               ctrl;         /*!< Pending control PDU (CONNECT/CC/DISC/DM) or SYMM */
+    uint8_t               dmReason;     /*!< Reason of the pending DM                         */
+    const char            *sn;          /*!< Service name to CONNECT to                       */
+    rfalLlcpRxCallback    rxCb;         /*!< Data received callback                           */
+    rfalLlcpStateCallback stateCb;      /*!< State change callback                            */
+    const uint8_t         *txHdr;       /*!< SDU first part                                   */
+    uint16_t              txHdrLen;     /*!< SDU first part length                            */
+    const uint8_t         *txData;      /*!< SDU second part                                  */
+    uint32_t              txLen;        /*!< SDU total length                                 */
+    uint32_t              txPos;        /*!< SDU bytes already sent                           */
+} rfalLlcpDataLink;
+
+
+/*! Pending SNL response */
+typedef struct
+{
+    uint8_t               tid;          /*!< Transaction ID of the SDREQ                      */
+    uint8_t               sap;          /*!< SAP found, 0 if none                             */
+} rfalLlcpSdRes;
+
+
+/*! LLCP module context */
+typedef struct
+{
+    bool                  active;                           /*!< LLCP link active                           */
+    bool                  isInitiator;                      /*!< Local device is the NFC-DEP Initiator      */
+    bool                  rxFirst;                          /*!< Target: receive before first send          */
+    uint16_t              remoteMIU;                        /*!< Remote link MIU                            */
+    uint16_t              remoteLTO;                        /*!< Remote link timeout [ms]                   */
+    uint8_t               lnkIt;                            /*!< Data link to serve first (round robin)     */
+
+    const rfalLlcpService *services[RFAL_FEATURE_LLCP_SERVICES];   /*!< Registered services                 */
+    rfalLlcpDataLink      links[RFAL_FEATURE_LLCP_LINKS];    /*!< Data links                                 */
+
+    uint8_t               dmDsap;                           /*!< Pending DM for an unknown connection: DSAP */
+    uint8_t               dmSsap;                           /*!< Pending DM for an unknown connection: SSAP */
+    uint8_t               dmReason;                         /*!< Pending DM reason                          */
+    bool                  dmPending;                        /*!< Pending DM for an unknown connection       */
+
+    rfalLlcpSdRes         sdRes[RFAL_LLCP_SDRES_MAX];       /*!< Pending SDRES                              */
+    uint8_t               sdResCnt;                         /*!< Pending SDRES count                        */
+
+    const uint8_t         *uiData;                          /*!< Pending UI information                     */
+    uint16_t              uiLen;                            /*!< Pending UI information length              */
+    uint8_t               uiDsap;                           /*!< Pending UI DSAP                            */
+    uint8_t               uiSsap;                           /*!< Pending UI SSAP                            */
+    bool                  uiPending;                        /*!< Pending UI                                 */
+
+    rfalLlcpStats         stats;                            /*!< Link statistics                            */
+    uint8_t               txBuf[RFAL_LLCP_TXBUF_LEN];       /*!< PDU (or AGF) being sent                    */
+} rfalLlcp;
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static rfalLlcp gLlcpInst[RFAL_FEATURE_INSTANCES];   /*!< LLCP Module instances        */
+#define gLlcp  gLlcpInst[rfalInstance()]             /*!< Current LLCP Module instance */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+static void rfalLlcpSetLinkState( uint8_t link, rfalLlcpLinkState state );
+static const rfalLlcpService* rfalLlcpFindServiceBySap( uint8_t sap );
+static const rfalLlcpService* rfalLlcpFindServiceBySn( const uint8_t *sn, uint8_t snLen );
+static uint8_t rfalLlcpFindLink( uint8_t lsap, uint8_t rsap );
+static uint8_t rfalLlcpAllocLink( void );
+static void rfalLlcpParseConnParams( rfalLlcpDataLink *lnk, const uint8_t *params, uint16_t paramsLen, const uint8_t **sn, uint8_t *snLen );
+static void rfalLlcpQueueDM( uint8_t dsap, uint8_t ssap, uint8_t reason );
+static void rfalLlcpProcessSNL( const uint8_t *params, uint16_t paramsLen );
+static void rfalLlcpProcessConnect( uint8_t dsap, uint8_t ssap, const uint8_t *params, uint16_t paramsLen );
+static void rfalLlcpProcessPdu( const uint8_t *pdu, uint16_t pduLen, bool inAgf );
+static uint16_t rfalLlcpComposeLinkCtrl( rfalLlcpDataLink *lnk, uint8_t *buf, uint16_t bufLen );
+static uint16_t rfalLlcpComposeI( rfalLlcpDataLink *lnk, uint8_t *buf, uint16_t bufLen );
+static uint16_t rfalLlcpComposePdu( uint8_t *buf, uint16_t bufLen );
+static uint16_t rfalLlcpComposeTurn( uint8_t **pdu );
+
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static void rfalLlcpSetLinkState( uint8_t link, rfalLlcpLinkState state )
+{
+    rfalLlcpDataLink *lnk = &gLlcp.links[link];
+
+    if( lnk->state == state )
+    {
+        return;
+    }
+
+    lnk->state = state;
+
+    if( state == RFAL_LLCP_LINK_CLOSED )
+    {
+        lnk->ctrl   = RFAL_LLCP_PTYPE_SYMM;
+        lnk->txLen  = 0U;
+        lnk->txPos  = 0U;
+    }
+
+    if( lnk->stateCb != NULL )
+    {
+        lnk->stateCb( link, state );
+    }
+}
+
+
+/*******************************************************************************/
+static const rfalLlcpService* rfalLlcpFindServiceBySap( uint8_t sap )
+{
+    uint8_t i;
+
+    for( i = 0; i < RFAL_FEATURE_LLCP_SERVICES; i++ )
+    {
+        if( (gLlcp.services[i] != NULL) && (gLlcp.services[i]->sap == sap) )
+        {
+            return gLlcp.services[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************/
+static const rfalLlcpService* rfalLlcpFindServiceBySn( const uint8_t *sn, uint8_t snLen )
+{
+    uint8_t i;
+
+    for( i = 0; i < RFAL_FEATURE_LLCP_SERVICES; i++ )
+    {
+        if( (gLlcp.services[i] != NULL) && (gLlcp.services[i]->sn != NULL) &&
+            (strlen(gLlcp.services[i]->sn) == snLen) && (RFAL_BYTECMP( gLlcp.services[i]->sn, sn, snLen ) == 0) )
+        {
+            return gLlcp.services[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************/
+static uint8_t rfalLlcpFindLink( uint8_t lsap, uint8_t rsap )
+{
+    uint8_t i;
+
+    for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+    {
+        if( (gLlcp.links[i].state != RFAL_LLCP_LINK_CLOSED) && (gLlcp.links[i].lsap == lsap) && (gLlcp.links[i].rsap == rsap) )
+        {
+            return i;
+        }
+    }
+    return RFAL_LLCP_LINK_INVALID;
+}
+
+
+/*******************************************************************************/
+static uint8_t rfalLlcpAllocLink( void )
+{
+    uint8_t i;
+
+    for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+    {
+        /* A closed link is only reused once its DM has been sent */
+        if( (gLlcp.links[i].state == RFAL_LLCP_LINK_CLOSED) && (gLlcp.links[i].ctrl == RFAL_LLCP_PTYPE_SYMM) )
+        {
+            RFAL_MEMSET( &gLlcp.links[i], 0x00, sizeof(rfalLlcpDataLink) );
+            gLlcp.links[i].miu = RFAL_LLCP_MIU_DEFAULT;
+            gLlcp.links[i].rw  = RFAL_LLCP_RW_DEFAULT;
+            return i;
+        }
+    }
+    return RFAL_LLCP_LINK_INVALID;
+}
+
+
+/*******************************************************************************/
+static void rfalLlcpParseConnParams( rfalLlcpDataLink *lnk, const uint8_t *params, uint16_t paramsLen, const uint8_t **sn, uint8_t *snLen )
+{
+    uint16_t it;
+    uint8_t  len;
+
+    for( it = 0; (it + RFAL_LLCP_TLV_HDR_LEN) <= paramsLen; it += (RFAL_LLCP_TLV_HDR_LEN + (uint16_t)len) )
+    {
+        len = params[it + 1U];
+        if( (it + RFAL_LLCP_TLV_HDR_LEN + len) > paramsLen )
+        {
+            break;
+        }
+
+        switch( params[it] )
+        {
+            case RFAL_LLCP_PARAM_MIUX:
+                if( len == 2U )
+                {
+                    lnk->miu = (uint16_t)(RFAL_LLCP_MIU_DEFAULT + (RFAL_LLCP_MIUX_MASK & (((uint16_t)params[it + 2U] << 8U) | params[it + 3U])));
+                }
+                break;
+
+            case RFAL_LLCP_PARAM_RW:
+                if( len == 1U )
+                {
+                    lnk->rw = (params[it + 2U] & RFAL_LLCP_RW_MASK);
+                }
+                break;
+
+            case RFAL_LLCP_PARAM_SN:
+                if( sn != NULL )
+                {
+                    *sn    = &params[it + 2U];
+                    *snLen = len;
+                }
+                break;
+
+            default:
+                /* Unknown parameters are ignored   LLCP 1.3  4.4 */
+                break;
+        }
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalLlcpQueueDM( uint8_t dsap, uint8_t ssap, uint8_t reason )
+{
+    /* Single slot: a newer DM for an unknown connection overrides a pending one */
+    gLlcp.dmDsap    = dsap;
+    gLlcp.dmSsap    = ssap;
+    gLlcp.dmReason  = reason;
+    gLlcp.dmPending = true;
+}
+
+
+/*******************************************************************************/
+static void rfalLlcpProcessSNL( const uint8_t *params, uint16_t paramsLen )
+{
+    const rfalLlcpService *srv;
+    uint16_t              it;
+    uint8_t               len;
+
+    for( it = 0; (it + RFAL_LLCP_TLV_HDR_LEN) <= paramsLen; it += (RFAL_LLCP_TLV_HDR_LEN + (uint16_t)len) )
+    {
+        len = params[it + 1U];
+        if( (it + RFAL_LLCP_TLV_HDR_LEN + len) > paramsLen )
+        {
+            break;
+        }
+
+        if( (params[it] == RFAL_LLCP_PARAM_SDREQ) && (len >= 1U) && (gLlcp.sdResCnt < RFAL_LLCP_SDRES_MAX) )
+        {
+            srv = rfalLlcpFindServiceBySn( &params[it + 3U], (len - 1U) );
+
+            gLlcp.sdRes[gLlcp.sdResCnt].tid = params[it + 2U];
+            gLlcp.sdRes[gLlcp.sdResCnt].sap = ((srv != NULL) ? srv->sap : RFAL_LLCP_SAP_LLC);
+            gLlcp.sdResCnt++;
+        }
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalLlcpProcessConnect( uint8_t dsap, uint8_t ssap, const uint8_t *params, uint16_t paramsLen )
+{
+    const rfalLlcpService *srv;
+    rfalLlcpDataLink      *lnk;
+    const uint8_t         *sn;
+    uint8_t               snLen;
+    uint8_t               link;
+
+    sn    = NULL;
+    snLen = 0U;
+
+    link = rfalLlcpAllocLink();
+    if( link == RFAL_LLCP_LINK_INVALID )
+    {
+        rfalLlcpQueueDM( ssap, dsap, RFAL_LLCP_DM_NO_RESOURCES );
+        return;
+    }
+    lnk = &gLlcp.links[link];
+
+    rfalLlcpParseConnParams( lnk, params, paramsLen, &sn, &snLen );
+
+    /* CONNECT to the SDP is a connect by service name   LLCP 1.3  4.5.6 */
+    if( dsap == RFAL_LLCP_SAP_SDP )
+    {
+        srv = ((sn != NULL) ? rfalLlcpFindServiceBySn( sn, snLen ) : NULL);
+    }
+    else
+    {
+        srv = rfalLlcpFindServiceBySap( dsap );
+    }
+
+    if( (srv == NULL) || (srv->connectCb == NULL) )
+    {
+        rfalLlcpQueueDM( ssap, dsap, RFAL_LLCP_DM_NO_SERVICE );
+        return;
+    }
+
+    lnk->lsap    = srv->sap;
+    lnk->rsap    = ssap;
+    lnk->rxCb    = srv->rxCb;
+    lnk->stateCb = srv->stateCb;
+    lnk->state   = RFAL_LLCP_LINK_CONNECTING;
+
+    if( !srv->connectCb( link ) )
+    {
+        lnk->state = RFAL_LLCP_LINK_CLOSED;
+        rfalLlcpQueueDM( ssap, dsap, RFAL_LLCP_DM_REJECTED );
+        return;
+    }
+
+    lnk->ctrl = RFAL_LLCP_PTYPE_CC;
+    rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_CONNECTED );
+}
+
+
+/*******************************************************************************/
+static void rfalLlcpProcessPdu( const uint8_t *pdu, uint16_t pduLen, bool inAgf )
+{
+    rfalLlcpDataLink      *lnk;
+    const rfalLlcpService *srv;
+    uint8_t               dsap;
+    uint8_t               ssap;
+    uint8_t               ptype;
+    uint8_t               link;
+    uint16_t              it;
+    uint16_t              len;
+
+    if( pduLen < RFAL_LLCP_HDR_LEN )
+    {
+        return;
+    }
+
+    dsap  = (pdu[0] >> 2U);
+    ptype = (uint8_t)(((pdu[0] & 0x03U) << 2U) | (pdu[1] >> 6U));
+    ssap  = (pdu[1] & RFAL_LLCP_SAP_MAX);
+    lnk   = NULL;
+
+    /* Sequenced PDUs are addressed to an existing data link */
+    if( (ptype == RFAL_LLCP_PTYPE_I) || (ptype == RFAL_LLCP_PTYPE_RR) || (ptype == RFAL_LLCP_PTYPE_RNR) || (ptype == RFAL_LLCP_PTYPE_DISC) )
+    {
+        link = rfalLlcpFindLink( dsap, ssap );
+
+        if( (link == RFAL_LLCP_LINK_INVALID) || (gLlcp.links[link].state != RFAL_LLCP_LINK_CONNECTED) )
+        {
+            if( (ptype == RFAL_LLCP_PTYPE_DISC) && (dsap == RFAL_LLCP_SAP_LLC) && (ssap == RFAL_LLCP_SAP_LLC) )
+            {
+                /* LLCP link deactivation   LLCP 1.3  5.3 */
+                rfalLlcpStop();
+            }
+            else if( ptype != RFAL_LLCP_PTYPE_DISC )
+            {
+                rfalLlcpQueueDM( ssap, dsap, RFAL_LLCP_DM_NO_CONN );
+            }
+            else
+            {
+                rfalLlcpQueueDM( ssap, dsap, RFAL_LLCP_DM_DISC_ACK );
+            }
+            return;
+        }
+        lnk = &gLlcp.links[link];
+
+        if( (ptype != RFAL_LLCP_PTYPE_DISC) && (pduLen < (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN)) )
+        {
+            return;
+        }
+    }
+    else
+    {
+        link = RFAL_LLCP_LINK_INVALID;
+    }
+
+    switch( ptype )
+    {
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_SYMM:
+        case RFAL_LLCP_PTYPE_PAX:
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_AGF:
+            if( inAgf )
+            {
+                break;                                       /* AGF are not nested   LLCP 1.3  4.3.3 */
+            }
+
+            for( it = RFAL_LLCP_HDR_LEN; (it + RFAL_LLCP_AGF_LEN_LEN) <= pduLen; it += (RFAL_LLCP_AGF_LEN_LEN + len) )
+            {
+                len = (uint16_t)(((uint16_t)pdu[it] << 8U) | pdu[it + 1U]);
+                if( (it + RFAL_LLCP_AGF_LEN_LEN + len) > pduLen )
+                {
+                    break;
+                }
+                rfalLlcpProcessPdu( &pdu[it + RFAL_LLCP_AGF_LEN_LEN], len, true );
+
+                if( !gLlcp.active )
+                {
+                    break;
+                }
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_UI:
+            srv = rfalLlcpFindServiceBySap( dsap );
+            if( (srv != NULL) && (srv->uiCb != NULL) )
+            {
+                gLlcp.stats.rxBytes += (uint32_t)(pduLen - RFAL_LLCP_HDR_LEN);
+                srv->uiCb( ssap, &pdu[RFAL_LLCP_HDR_LEN], (pduLen - RFAL_LLCP_HDR_LEN) );
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_CONNECT:
+            rfalLlcpProcessConnect( dsap, ssap, &pdu[RFAL_LLCP_HDR_LEN], (pduLen - RFAL_LLCP_HDR_LEN) );
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_CC:
+            for( link = 0; link < RFAL_FEATURE_LLCP_LINKS; link++ )
+            {
+                lnk = &gLlcp.links[link];
+                if( (lnk->state == RFAL_LLCP_LINK_CONNECTING) && (lnk->lsap == dsap) )
+                {
+                    lnk->rsap = ssap;               /* The remote SAP is known from CC when connected by name */
+                    rfalLlcpParseConnParams( lnk, &pdu[RFAL_LLCP_HDR_LEN], (pduLen - RFAL_LLCP_HDR_LEN), NULL, NULL );
+                    rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_CONNECTED );
+                    break;
+                }
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_DM:
+            for( link = 0; link < RFAL_FEATURE_LLCP_LINKS; link++ )
+            {
+                lnk = &gLlcp.links[link];
+                if( (lnk->state != RFAL_LLCP_LINK_CLOSED) && (lnk->lsap == dsap) && ((lnk->rsap == ssap) || (lnk->state == RFAL_LLCP_LINK_CONNECTING)) )
+                {
+                    rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_CLOSED );
+                    break;
+                }
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_FRMR:
+            link = rfalLlcpFindLink( dsap, ssap );
+            if( link != RFAL_LLCP_LINK_INVALID )
+            {
+                rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_CLOSED );
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_SNL:
+            if( dsap == RFAL_LLCP_SAP_SDP )
+            {
+                rfalLlcpProcessSNL( &pdu[RFAL_LLCP_HDR_LEN], (pduLen - RFAL_LLCP_HDR_LEN) );
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_DISC:
+            rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_CLOSED );
+            lnk->ctrl     = RFAL_LLCP_PTYPE_DM;
+            lnk->dmReason = RFAL_LLCP_DM_DISC_ACK;
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_I:
+            /* Out of sequence I PDUs cannot happen over NFC-DEP, N(S) is taken as is */
+            lnk->vr  = rfalLlcpSeqInc( (pdu[RFAL_LLCP_HDR_LEN] >> 4U) );
+            lnk->vsa = (pdu[RFAL_LLCP_HDR_LEN] & RFAL_LLCP_SEQ_MASK);
+
+            len = (pduLen - (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN));
+            gLlcp.stats.iRxCnt++;
+            gLlcp.stats.rxBytes += len;
+
+            if( lnk->rxCb != NULL )
+            {
+                lnk->rxCb( link, &pdu[RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN], len );
+            }
+            break;
+
+        /*******************************************************************************/
+        case RFAL_LLCP_PTYPE_RR:
+        case RFAL_LLCP_PTYPE_RNR:
+            lnk->vsa        = (pdu[RFAL_LLCP_HDR_LEN] & RFAL_LLCP_SEQ_MASK);
+            lnk->remoteBusy = (ptype == RFAL_LLCP_PTYPE_RNR);
+            break;
+
+        /*******************************************************************************/
+        default:
+            /* Unknown PTYPE on a connection shall be rejected, otherwise ignored */
+            break;
+    }
+}
+
+
+/*******************************************************************************/
+static uint16_t rfalLlcpComposeLinkCtrl( rfalLlcpDataLink *lnk, uint8_t *buf, uint16_t bufLen )
+{
+    uint16_t len;
+    uint16_t miux;
+    uint8_t  snLen;
+
+    snLen = (((lnk->ctrl == RFAL_LLCP_PTYPE_CONNECT) && (lnk->sn != NULL)) ? (uint8_t)strlen( lnk->sn ) : 0U);
+
+    /* Worst case: header, MIUX, RW and SN */
+    if( bufLen < (RFAL_LLCP_HDR_LEN + (3U * RFAL_LLCP_TLV_HDR_LEN) + 3U + snLen) )
+    {
+        return 0U;
+    }
+
+    len = RFAL_LLCP_HDR_LEN;
+    buf[0] = rfalLlcpHdr0( ((lnk->ctrl == RFAL_LLCP_PTYPE_CONNECT) && (lnk->sn != NULL)) ? RFAL_LLCP_SAP_SDP : lnk->rsap, lnk->ctrl );
+    buf[1] = rfalLlcpHdr1( lnk->ctrl, lnk->lsap );
+
+    switch( lnk->ctrl )
+    {
+        case RFAL_LLCP_PTYPE_CONNECT:
+        case RFAL_LLCP_PTYPE_CC:
+            miux = (RFAL_FEATURE_LLCP_MIU - RFAL_LLCP_MIU_DEFAULT);
+            buf[len++] = RFAL_LLCP_PARAM_MIUX;
+            buf[len++] = 2U;
+            buf[len++] = (uint8_t)(miux >> 8U);
+            buf[len++] = (uint8_t)(miux);
+            buf[len++] = RFAL_LLCP_PARAM_RW;
+            buf[len++] = 1U;
+            buf[len++] = RFAL_FEATURE_LLCP_RW;
+
+            if( snLen > 0U )
+            {
+                buf[len++] = RFAL_LLCP_PARAM_SN;
+                buf[len++] = snLen;
+                RFAL_MEMCPY( &buf[len], lnk->sn, snLen );
+                len += snLen;
+            }
+            break;
+
+        case RFAL_LLCP_PTYPE_DM:
+            buf[len++] = lnk->dmReason;
+            break;
+
+        default:
+            /* DISC: no information field */
+            break;
+    }
+
+    lnk->ctrl = RFAL_LLCP_PTYPE_SYMM;
+    return len;
+}
+
+
+/*******************************************************************************/
+static uint16_t rfalLlcpComposeI( rfalLlcpDataLink *lnk, uint8_t *buf, uint16_t bufLen )
+{
+    uint32_t segLen;
+    uint32_t pos;
+    uint32_t cpyLen;
+    uint16_t len;
+
+    if( bufLen <= (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN) )
+    {
+        return 0U;
+    }
+
+    segLen = RFAL_MIN( (lnk->txLen - lnk->txPos), (uint32_t)lnk->miu );
+    segLen = RFAL_MIN( segLen, (uint32_t)(bufLen - (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN)) );
+
+    buf[0] = rfalLlcpHdr0( lnk->rsap, RFAL_LLCP_PTYPE_I );
+    buf[1] = rfalLlcpHdr1( RFAL_LLCP_PTYPE_I, lnk->lsap );
+    buf[2] = (uint8_t)((lnk->vs << 4U) | lnk->vr);
+    len    = (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN);
+
+    /* Gather the segment from the SDU parts, no intermediate copy of the SDU */
+    pos = lnk->txPos;
+    if( pos < lnk->txHdrLen )
+    {
+        cpyLen = RFAL_MIN( segLen, (uint32_t)(lnk->txHdrLen - pos) );
+        RFAL_MEMCPY( &buf[len], &lnk->txHdr[pos], cpyLen );
+        len += (uint16_t)cpyLen;
+        pos += cpyLen;
+    }
+    cpyLen = (segLen - (pos - lnk->txPos));
+    if( cpyLen > 0U )
+    {
+        RFAL_MEMCPY( &buf[len], &lnk->txData[pos - lnk->txHdrLen], cpyLen );
+        len += (uint16_t)cpyLen;
+    }
+
+    lnk->txPos += segLen;
+    if( lnk->txPos >= lnk->txLen )
+    {
+        lnk->txLen = 0U;
+        lnk->txPos = 0U;
+    }
+
+    lnk->vs  = rfalLlcpSeqInc( lnk->vs );
+    lnk->vra = lnk->vr;                                      /* Acknowledge piggybacked on N(R) */
+
+    gLlcp.stats.iTxCnt++;
+    gLlcp.stats.txBytes += segLen;
+
+    return len;
+}
+
+
+/*******************************************************************************/
+static uint16_t rfalLlcpComposePdu( uint8_t *buf, uint16_t bufLen )
+{
+    rfalLlcpDataLink *lnk;
+    uint16_t         len;
+    uint8_t          i;
+    uint8_t          link;
+
+    /* Service discovery responses */
+    if( gLlcp.sdResCnt > 0U )
+    {
+        if( bufLen < (RFAL_LLCP_HDR_LEN + (gLlcp.sdResCnt * (RFAL_LLCP_TLV_HDR_LEN + 2U))) )
+        {
+            return 0U;
+        }
+
+        buf[0] = rfalLlcpHdr0( RFAL_LLCP_SAP_SDP, RFAL_LLCP_PTYPE_SNL );
+        buf[1] = rfalLlcpHdr1( RFAL_LLCP_PTYPE_SNL, RFAL_LLCP_SAP_SDP );
+        len    = RFAL_LLCP_HDR_LEN;
+
+        for( i = 0; i < gLlcp.sdResCnt; i++ )
+        {
+            buf[len++] = RFAL_LLCP_PARAM_SDRES;
+            buf[len++] = 2U;
+            buf[len++] = gLlcp.sdRes[i].tid;
+            buf[len++] = gLlcp.sdRes[i].sap;
+        }
+        gLlcp.sdResCnt = 0U;
+        return len;
+    }
+
+    /* DM for an unknown connection */
+    if( gLlcp.dmPending )
+    {
+        if( bufLen < (RFAL_LLCP_HDR_LEN + 1U) )
+        {
+            return 0U;
+        }
+
+        buf[0] = rfalLlcpHdr0( gLlcp.dmDsap, RFAL_LLCP_PTYPE_DM );
+        buf[1] = rfalLlcpHdr1( RFAL_LLCP_PTYPE_DM, gLlcp.dmSsap );
+        buf[2] = gLlcp.dmReason;
+        gLlcp.dmPending = false;
+        return (RFAL_LLCP_HDR_LEN + 1U);
+    }
+
+    /* Data link control PDUs */
+    for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+    {
+        if( gLlcp.links[i].ctrl != RFAL_LLCP_PTYPE_SYMM )
+        {
+            return rfalLlcpComposeLinkCtrl( &gLlcp.links[i], buf, bufLen );
+        }
+    }
+
+    /* I PDUs while the remote receive window is open, data links served round robin */
+    for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+    {
+        link = (uint8_t)((gLlcp.lnkIt + i) % RFAL_FEATURE_LLCP_LINKS);
+        lnk  = &gLlcp.links[link];
+
+        if( (lnk->state != RFAL_LLCP_LINK_CONNECTED) || (lnk->txLen == 0U) )
+        {
+            continue;
+        }
+
+        if( lnk->remoteBusy || (rfalLlcpSeqDiff( lnk->vs, lnk->vsa ) >= lnk->rw) )
+        {
+            continue;
+        }
+
+        len = rfalLlcpComposeI( lnk, buf, bufLen );
+        if( len > 0U )
+        {
+            gLlcp.lnkIt = (uint8_t)((link + 1U) % RFAL_FEATURE_LLCP_LINKS);
+        }
+        return len;
+    }
+
+    /* RR when no I PDU carried the acknowledge */
+    for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+    {
+        lnk = &gLlcp.links[i];
+
+        if( (lnk->state == RFAL_LLCP_LINK_CONNECTED) && (lnk->vr != lnk->vra) )
+        {
+            if( bufLen < (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN) )
+            {
+                return 0U;
+            }
+
+            buf[0]   = rfalLlcpHdr0( lnk->rsap, RFAL_LLCP_PTYPE_RR );
+            buf[1]   = rfalLlcpHdr1( RFAL_LLCP_PTYPE_RR, lnk->lsap );
+            buf[2]   = lnk->vr;
+            lnk->vra = lnk->vr;
+            gLlcp.stats.rrTxCnt++;
+            return (RFAL_LLCP_HDR_LEN + RFAL_LLCP_SEQ_LEN);
+        }
+    }
+
+    /* Connectionless data */
+    if( gLlcp.uiPending )
+    {
+        if( bufLen < (RFAL_LLCP_HDR_LEN + gLlcp.uiLen) )
+        {
+            return 0U;
+        }
+
+        buf[0] = rfalLlcpHdr0( gLlcp.uiDsap, RFAL_LLCP_PTYPE_UI );
+        buf[1] = rfalLlcpHdr1( RFAL_LLCP_PTYPE_UI, gLlcp.uiSsap );
+        if( gLlcp.uiLen > 0U )
+        {
+            RFAL_MEMCPY( &buf[RFAL_LLCP_HDR_LEN], gLlcp.uiData, gLlcp.uiLen );
+        }
+        gLlcp.uiPending = false;
+        gLlcp.stats.txBytes += gLlcp.uiLen;
+        return (RFAL_LLCP_HDR_LEN + gLlcp.uiLen);
+    }
+
+    return 0U;
+}
+
+
+/*******************************************************************************/
+static uint16_t rfalLlcpComposeTurn( uint8_t **pdu )
+{
+    uint16_t agfMax;
+    uint16_t pos;
+    uint16_t len;
+    uint16_t first;
+    uint8_t  i;
+
+    /* Compose the first PDU already in place for an AGF: header and length field ahead */
+    first = rfalLlcpComposePdu( &gLlcp.txBuf[RFAL_LLCP_HDR_LEN + RFAL_LLCP_AGF_LEN_LEN], (RFAL_LLCP_TXBUF_LEN - (RFAL_LLCP_HDR_LEN + RFAL_LLCP_AGF_LEN_LEN)) );
+
+    if( first == 0U )
+    {
+        for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+        {
+            if( (gLlcp.links[i].state == RFAL_LLCP_LINK_CONNECTED) && (gLlcp.links[i].txLen > 0U) )
+            {
+                gLlcp.stats.winFullCnt++;
+                break;
+            }
+        }
+
+        gLlcp.txBuf[0] = rfalLlcpHdr0( RFAL_LLCP_SAP_LLC, RFAL_LLCP_PTYPE_SYMM );
+        gLlcp.txBuf[1] = rfalLlcpHdr1( RFAL_LLCP_PTYPE_SYMM, RFAL_LLCP_SAP_LLC );
+        gLlcp.stats.symmTxCnt++;
+        *pdu = gLlcp.txBuf;
+        return RFAL_LLCP_HDR_LEN;
+    }
+
+    /* Aggregate further PDUs while the AGF information fits the remote link MIU */
+    agfMax = (uint16_t)RFAL_MIN( (uint32_t)gLlcp.remoteMIU + RFAL_LLCP_HDR_LEN, (uint32_t)RFAL_LLCP_TXBUF_LEN );
+    pos    = (RFAL_LLCP_HDR_LEN + RFAL_LLCP_AGF_LEN_LEN + first);
+
+    while( (pos + RFAL_LLCP_AGF_LEN_LEN + RFAL_LLCP_HDR_LEN) <= agfMax )
+    {
+        len = rfalLlcpComposePdu( &gLlcp.txBuf[pos + RFAL_LLCP_AGF_LEN_LEN], (agfMax - (pos + RFAL_LLCP_AGF_LEN_LEN)) );
+        if( len == 0U )
+        {
+            break;
+        }
+
+        gLlcp.txBuf[pos]      = (uint8_t)(len >> 8U);
+        gLlcp.txBuf[pos + 1U] = (uint8_t)(len);
+        pos += (RFAL_LLCP_AGF_LEN_LEN + len);
+    }
+
+    if( pos == (RFAL_LLCP_HDR_LEN + RFAL_LLCP_AGF_LEN_LEN + first) )
+    {
+        *pdu = &gLlcp.txBuf[RFAL_LLCP_HDR_LEN + RFAL_LLCP_AGF_LEN_LEN];
+        return first;
+    }
+
+    gLlcp.txBuf[0] = rfalLlcpHdr0( RFAL_LLCP_SAP_LLC, RFAL_LLCP_PTYPE_AGF );
+    gLlcp.txBuf[1] = rfalLlcpHdr1( RFAL_LLCP_PTYPE_AGF, RFAL_LLCP_SAP_LLC );
+    gLlcp.txBuf[2] = (uint8_t)(first >> 8U);
+    gLlcp.txBuf[3] = (uint8_t)(first);
+    *pdu = gLlcp.txBuf;
+    return pos;
+}
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+ReturnCode rfalLlcpGetGeneralBytes( uint8_t *gb, uint8_t *gbLen )
+{
+    uint16_t miux;
+    uint16_t wks;
+    uint8_t  len;
+    uint8_t  i;
+
+    if( (gb == NULL) || (gbLen == NULL) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    /* Announce the LLC link management, the SDP and every well-known service registered */
+    wks = (uint16_t)((1U << RFAL_LLCP_SAP_LLC) | (1U << RFAL_LLCP_SAP_SDP));
+    for( i = 0; i < RFAL_FEATURE_LLCP_SERVICES; i++ )
+    {
+        if( (gLlcp.services[i] != NULL) && (gLlcp.services[i]->sap <= RFAL_LLCP_SAP_WKS_MAX) )
+        {
+            wks |= (uint16_t)(1U << gLlcp.services[i]->sap);
+        }
+    }
+
+    miux = (RFAL_FEATURE_LLCP_MIU - RFAL_LLCP_MIU_DEFAULT);
+    len  = 0U;
+
+    gb[len++] = 0x46U;                                  /* LLCP magic number   LLCP 1.3  6.2.3.1 */
+    gb[len++] = 0x66U;
+    gb[len++] = 0x6DU;
+    gb[len++] = RFAL_LLCP_PARAM_VERSION;
+    gb[len++] = 1U;
+    gb[len++] = RFAL_LLCP_VERSION;
+    gb[len++] = RFAL_LLCP_PARAM_MIUX;
+    gb[len++] = 2U;
+    gb[len++] = (uint8_t)(miux >> 8U);
+    gb[len++] = (uint8_t)(miux);
+    gb[len++] = RFAL_LLCP_PARAM_WKS;
+    gb[len++] = 2U;
+    gb[len++] = (uint8_t)(wks >> 8U);
+    gb[len++] = (uint8_t)(wks);
+    gb[len++] = RFAL_LLCP_PARAM_LTO;
+    gb[len++] = 1U;
+    gb[len++] = (uint8_t)(RFAL_FEATURE_LLCP_LTO / RFAL_LLCP_LTO_UNIT);
+    gb[len++] = RFAL_LLCP_PARAM_OPT;
+    gb[len++] = 1U;
+    gb[len++] = RFAL_LLCP_OPT_LSC_BOTH;
+
+    *gbLen = len;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpRegisterService( const rfalLlcpService *service )
+{
+    uint8_t i;
+
+    if( (service == NULL) || (service->sap == RFAL_LLCP_SAP_LLC) || (service->sap == RFAL_LLCP_SAP_SDP) || (service->sap > RFAL_LLCP_SAP_SDP_MAX) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    for( i = 0; i < RFAL_FEATURE_LLCP_SERVICES; i++ )
+    {
+        if( (gLlcp.services[i] == NULL) || (gLlcp.services[i]->sap == service->sap) )
+        {
+            gLlcp.services[i] = service;
+            return RFAL_ERR_NONE;
+        }
+    }
+    return RFAL_ERR_NOMEM;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpStart( const uint8_t *remoteGB, uint8_t remoteGBLen, bool isInitiator )
+{
+    uint8_t it;
+    uint8_t len;
+
+    if( remoteGB == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    if( (remoteGBLen < RFAL_LLCP_MAGIC_LEN) || (remoteGB[0] != 0x46U) || (remoteGB[1] != 0x66U) || (remoteGB[2] != 0x6DU) )
+    {
+        return RFAL_ERR_PROTO;
+    }
+
+    gLlcp.remoteMIU = RFAL_LLCP_MIU_DEFAULT;
+    gLlcp.remoteLTO = RFAL_LLCP_LTO_DEFAULT;
+
+    /* Version parameter is mandatory   LLCP 1.3  6.2.3.2 */
+    len = 0U;
+    it  = RFAL_LLCP_MAGIC_LEN;
+    while( (it + RFAL_LLCP_TLV_HDR_LEN) <= remoteGBLen )
+    {
+        len = remoteGB[it + 1U];
+        if( (it + RFAL_LLCP_TLV_HDR_LEN + len) > remoteGBLen )
+        {
+            break;
+        }
+
+        switch( remoteGB[it] )
+        {
+            case RFAL_LLCP_PARAM_VERSION:
+                if( (len != 1U) || ((remoteGB[it + 2U] >> 4U) != RFAL_LLCP_VERSION_MAJOR) )
+                {
+                    return RFAL_ERR_PROTO;
+                }
+                break;
+
+            case RFAL_LLCP_PARAM_MIUX:
+                if( len == 2U )
+                {
+                    gLlcp.remoteMIU = (uint16_t)(RFAL_LLCP_MIU_DEFAULT + (RFAL_LLCP_MIUX_MASK & (((uint16_t)remoteGB[it + 2U] << 8U) | remoteGB[it + 3U])));
+                }
+                break;
+
+            case RFAL_LLCP_PARAM_LTO:
+                if( (len == 1U) && (remoteGB[it + 2U] != 0U) )
+                {
+                    gLlcp.remoteLTO = (uint16_t)((uint16_t)remoteGB[it + 2U] * RFAL_LLCP_LTO_UNIT);
+                }
+                break;
+
+            default:
+                /* WKS and OPT are not needed, unknown parameters are ignored */
+                break;
+        }
+
+        it = (uint8_t)(it + RFAL_LLCP_TLV_HDR_LEN + len);
+    }
+
+    RFAL_MEMSET( gLlcp.links, 0x00, sizeof(gLlcp.links) );
+    RFAL_MEMSET( &gLlcp.stats, 0x00, sizeof(gLlcp.stats) );
+
+    gLlcp.isInitiator     = isInitiator;
+    gLlcp.rxFirst         = !isInitiator;               /* Target receives the Initiator's first PDU */
+    gLlcp.lnkIt           = 0U;
+    gLlcp.dmPending       = false;
+    gLlcp.sdResCnt        = 0U;
+    gLlcp.uiPending       = false;
+    gLlcp.stats.remoteMIU = gLlcp.remoteMIU;
+    gLlcp.stats.remoteLTO = gLlcp.remoteLTO;
+    gLlcp.active          = true;
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalLlcpStop( void )
+{
+    uint8_t i;
+
+    gLlcp.active = false;
+
+    for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+    {
+        rfalLlcpSetLinkState( i, RFAL_LLCP_LINK_CLOSED );
+        gLlcp.links[i].ctrl = RFAL_LLCP_PTYPE_SYMM;
+    }
+
+    gLlcp.dmPending = false;
+    gLlcp.sdResCnt  = 0U;
+    gLlcp.uiPending = false;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpWorker( void )
+{
+    ReturnCode ret;
+    uint8_t    *txPdu;
+    uint16_t   txLen;
+    uint8_t    *rxData;
+    uint16_t   *rxLen;
+    uint32_t   ltoTmr;
+
+    if( !gLlcp.active )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+
+    txPdu = gLlcp.txBuf;
+    txLen = 0U;
+
+    if( gLlcp.rxFirst )
+    {
+        gLlcp.rxFirst = false;
+    }
+    else
+    {
+        txLen = rfalLlcpComposeTurn( &txPdu );
+    }
+
+    ret = rfalNfcDataExchangeStart( txPdu, txLen, &rxData, &rxLen, RFAL_FWT_NONE );
+    if( ret == RFAL_ERR_NONE )
+    {
+        /* The remote must send its next PDU within its announced LTO   LLCP 1.3  5.6.1 */
+        ltoTmr = (uint32_t)platformTimerCreate( gLlcp.remoteLTO );
+        do{
+            rfalNfcWorker();
+            ret = rfalNfcDataExchangeGetStatus();
+
+            if( (ret == RFAL_ERR_BUSY) && platformTimerIsExpired( ltoTmr ) )
+            {
+                gLlcp.stats.ltoExpCnt++;
+                ret = RFAL_ERR_LINK_LOSS;
+            }
+        }
+        while( ret == RFAL_ERR_BUSY );
+        platformTimerDestroy( ltoTmr );
+    }
+
+    if( ret != RFAL_ERR_NONE )
+    {
+        rfalLlcpStop();
+        return ret;
+    }
+
+    gLlcp.stats.xchgCnt++;
+    rfalLlcpProcessPdu( rxData, *rxLen, false );
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+bool rfalLlcpIsActive( void )
+{
+    return gLlcp.active;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpConnect( uint8_t dsap, const char *sn, rfalLlcpRxCallback rxCb, rfalLlcpStateCallback stateCb, uint8_t *link )
+{
+    rfalLlcpDataLink *lnk;
+    uint8_t          sap;
+    uint8_t          i;
+    uint8_t          l;
+    bool             used;
+
+    if( (link == NULL) || ((sn == NULL) && ((dsap == RFAL_LLCP_SAP_LLC) || (dsap > RFAL_LLCP_SAP_MAX))) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    if( (sn != NULL) && (strlen( sn ) > RFAL_LLCP_SN_MAX_LEN) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    if( !gLlcp.active )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+
+    /* Pick a free local SAP from the outgoing connections range */
+    for( sap = RFAL_LLCP_SAP_OUT_FIRST; sap <= RFAL_LLCP_SAP_MAX; sap++ )
+    {
+        used = false;
+        for( i = 0; i < RFAL_FEATURE_LLCP_LINKS; i++ )
+        {
+            if( (gLlcp.links[i].state != RFAL_LLCP_LINK_CLOSED) && (gLlcp.links[i].lsap == sap) )
+            {
+                used = true;
+            }
+        }
+        if( !used )
+        {
+            break;
+        }
+    }
+
+    l = rfalLlcpAllocLink();
+    if( (l == RFAL_LLCP_LINK_INVALID) || (sap > RFAL_LLCP_SAP_MAX) )
+    {
+        return RFAL_ERR_NOMEM;
+    }
+
+    lnk          = &gLlcp.links[l];
+    lnk->lsap    = sap;
+    lnk->rsap    = ((sn != NULL) ? RFAL_LLCP_SAP_SDP : dsap);
+    lnk->sn      = sn;
+    lnk->rxCb    = rxCb;
+    lnk->stateCb = stateCb;
+    lnk->ctrl    = RFAL_LLCP_PTYPE_CONNECT;
+    lnk->state   = RFAL_LLCP_LINK_CONNECTING;
+
+    *link = l;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpSend( uint8_t link, const uint8_t *hdr, uint16_t hdrLen, const uint8_t *data, uint32_t dataLen )
+{
+    rfalLlcpDataLink *lnk;
+
+    if( (!rfalLlcpIsLinkValid( link )) || ((hdr == NULL) && (hdrLen > 0U)) || ((data == NULL) && (dataLen > 0U)) || ((hdrLen + dataLen) == 0U) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    lnk = &gLlcp.links[link];
+
+    if( lnk->state != RFAL_LLCP_LINK_CONNECTED )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+
+    if( lnk->txLen > 0U )
+    {
+        return RFAL_ERR_BUSY;
+    }
+
+    lnk->txHdr    = hdr;
+    lnk->txHdrLen = hdrLen;
+    lnk->txData   = data;
+    lnk->txPos    = 0U;
+    lnk->txLen    = ((uint32_t)hdrLen + dataLen);
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+bool rfalLlcpIsSendDone( uint8_t link )
+{
+    if( !rfalLlcpIsLinkValid( link ) )
+    {
+        return true;
+    }
+    return (gLlcp.links[link].txLen == 0U);
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpSendUI( uint8_t dsap, uint8_t ssap, const uint8_t *data, uint16_t dataLen )
+{
+    if( (dsap > RFAL_LLCP_SAP_MAX) || (ssap > RFAL_LLCP_SAP_MAX) || ((data == NULL) && (dataLen > 0U)) || (dataLen > gLlcp.remoteMIU) ||
+        ((RFAL_LLCP_HDR_LEN + dataLen) > RFAL_LLCP_TXBUF_LEN) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    if( !gLlcp.active )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+
+    if( gLlcp.uiPending )
+    {
+        return RFAL_ERR_BUSY;
+    }
+
+    gLlcp.uiDsap    = dsap;
+    gLlcp.uiSsap    = ssap;
+    gLlcp.uiData    = data;
+    gLlcp.uiLen     = dataLen;
+    gLlcp.uiPending = true;
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpDisconnect( uint8_t link )
+{
+    rfalLlcpDataLink *lnk;
+
+    if( !rfalLlcpIsLinkValid( link ) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    lnk = &gLlcp.links[link];
+
+    if( lnk->state == RFAL_LLCP_LINK_CONNECTED )
+    {
+        lnk->txLen = 0U;
+        lnk->ctrl  = RFAL_LLCP_PTYPE_DISC;
+        rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_DISCONNECTING );
+    }
+    else if( lnk->state == RFAL_LLCP_LINK_CONNECTING )
+    {
+        /* CONNECT not answered yet: a later CC is ignored, data on it is answered with DM */
+        lnk->ctrl = RFAL_LLCP_PTYPE_SYMM;
+        rfalLlcpSetLinkState( link, RFAL_LLCP_LINK_CLOSED );
+    }
+    else
+    {
+        /* MISRA 15.7 - Empty else */
+    }
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+rfalLlcpLinkState rfalLlcpGetLinkState( uint8_t link )
+{
+    if( !rfalLlcpIsLinkValid( link ) )
+    {
+        return RFAL_LLCP_LINK_CLOSED;
+    }
+    return gLlcp.links[link].state;
+}
+
+
+/*******************************************************************************/
+uint16_t rfalLlcpGetLinkMIU( uint8_t link )
+{
+    if( !rfalLlcpIsLinkValid( link ) )
+    {
+        return RFAL_LLCP_MIU_DEFAULT;
+    }
+    return gLlcp.links[link].miu;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalLlcpGetStats( rfalLlcpStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    (*stats) = gLlcp.stats;
+    return RFAL_ERR_NONE;
+}
+
+#endif /* RFAL_FEATURE_LLCP */
@@ -38,6 +38,10 @@
 #include "rfal_nfc.h"
 #include "rfal_utils.h"
 #include "rfal_analogConfig.h"
+#include "rfal_cd.h"
+#include "rfal_dpo.h"
+#include "rfal_stats.h"
+#include "rfal_trace.h"
 
 
 /*
@@ -64,6 +68,9 @@
 #define rfalNfcpCbStartActivation()                    ((gNfcDev.disc.propNfc.rfalNfcpStartActivation != NULL) ? gNfcDev.disc.propNfc.rfalNfcpStartActivation() : RFAL_ERR_NOTSUPP )
 #define rfalNfcpCbGetActivationStatus()                ((gNfcDev.disc.propNfc.rfalNfcpGetActivationStatus != NULL) ? gNfcDev.disc.propNfc.rfalNfcpGetActivationStatus() : RFAL_ERR_NOTSUPP )
 
+#define rfalNfcSchedTechIdx( t )                       ( ((t) == RFAL_NFC_POLL_TECH_A) ? 0U : ( ((t) == RFAL_NFC_POLL_TECH_B) ? 1U : ( ((t) == RFAL_NFC_POLL_TECH_F) ? 2U : \
+                                                       ( ((t) == RFAL_NFC_POLL_TECH_V) ? 3U : ( ((t) == RFAL_NFC_POLL_TECH_ST25TB) ? 4U : 5U ) ) ) ) )
+
 #define rfalNfcHasPollerTechs()                        ((gNfcDev.disc.techs2Find & (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F | RFAL_NFC_POLL_TECH_V |  \
                                                                                    RFAL_NFC_POLL_TECH_AP2P | RFAL_NFC_POLL_TECH_ST25TB | RFAL_NFC_POLL_TECH_PROP)) != 0U)
     
@@ -80,6 +87,17 @@ typedef union{  /*PRQA S 0750 # MISRA 19.2 - Members of the union will not be us
 }rfalNfcTmpBuffer;
 
 
+/*! Technology Detection poll scheduler                                                              */
+typedef struct{
+    uint16_t                order[RFAL_NFC_SCHED_TECH_NUM];  /*!< Technologies poll order on current cycle */
+    uint8_t                 age[RFAL_NFC_SCHED_TECH_NUM];    /*!< Cycles since each tech was last polled   */
+    uint16_t                planned;            /*!< Technologies planned for the current cycle      */
+    uint32_t                cycleStart;         /*!< System tick at Technology Detection start       */
+    bool                    isDetected;         /*!< First detection of the cycle has been timed     */
+    rfalNfcPollSchedStats   stats;              /*!< Hit statistics and scores                       */
+}rfalNfcPollSched;
+
+
 /*! RFAL NFC instance                                                                                */
 typedef struct{
     rfalNfcState            state;              /*!< Main state                                      */
@@ -101,6 +119,17 @@ typedef struct{
     bool                    isTechInit;         /*!< Flag indicating technology has been set         */
     bool                    isOperOngoing;      /*!< Flag indicating operation is ongoing            */
     bool                    isDeactivating;     /*!< Flag indicating deactivation is ongoing         */
+    rfalNfcPollSched        sched;              /*!< Technology Detection poll scheduler             */
+    rfalNfcDevice           lastDev;            /*!< Last activated device, hot reacquire target     */
+    bool                    isLastDevValid;     /*!< Flag indicating lastDev may be reacquired       */
+    uint16_t                lastSysCode;        /*!< System Code to poll the last NFC-F device with  */
+    rfalNfcWakeUpStats      wuStats;            /*!< Low power Wake-Up statistics                    */
+    uint32_t                wuStatsStart;       /*!< System tick at Wake-Up statistics reset         */
+    uint32_t                wuStart;            /*!< System tick at Wake-Up mode start               */
+    bool                    isWoken;            /*!< Discovery running on a Wake-Up, not activated yet */
+#if RFAL_FEATURE_WAKEUP_MODE
+    rfalCdRes               cdRes;              /*!< Card Detection outcome confirming a Wake-Up     */
+#endif /* RFAL_FEATURE_WAKEUP_MODE */
 
     rfalNfcaSensRes         sensRes;            /*!< SENS_RES during card detection and activation   */
     rfalNfcbSensbRes        sensbRes;           /*!< SENSB_RES during card detection and activation  */
@@ -123,10 +152,15 @@ typedef struct{
  ******************************************************************************
  */
 #ifdef RFAL_TEST_MODE
-    rfalNfc gNfcDev;
+    rfalNfc gNfcDevInst[RFAL_FEATURE_INSTANCES];
 #else /* RFAL_TEST_MODE */
-    static rfalNfc gNfcDev;
+    static rfalNfc gNfcDevInst[RFAL_FEATURE_INSTANCES];
 #endif /* RFAL_TEST_MODE */
+#define gNfcDev  gNfcDevInst[rfalInstance()]        /*!< Current RFAL NFC instance */
+
+/*! Passive poll technologies handled by the scheduler, in the fixed Activity order */
+static const uint16_t gNfcSchedTechs[RFAL_NFC_SCHED_TECH_NUM] = { RFAL_NFC_POLL_TECH_A, RFAL_NFC_POLL_TECH_B, RFAL_NFC_POLL_TECH_F,
+                                                                  RFAL_NFC_POLL_TECH_V, RFAL_NFC_POLL_TECH_ST25TB, RFAL_NFC_POLL_TECH_PROP };
 
 /*
 ******************************************************************************
@@ -134,6 +168,21 @@ typedef struct{
 ******************************************************************************
 */
 static ReturnCode rfalNfcPollTechDetetection( void );
+static ReturnCode rfalNfcPollTechDetectA( void );
+static ReturnCode rfalNfcPollTechDetectB( void );
+static ReturnCode rfalNfcPollTechDetectF( void );
+static ReturnCode rfalNfcPollTechDetectV( void );
+static ReturnCode rfalNfcPollTechDetectST25TB( void );
+static ReturnCode rfalNfcPollTechDetectProp( void );
+static void rfalNfcSchedPlanCycle( void );
+static ReturnCode rfalNfcPollReacquire( void );
+static ReturnCode rfalNfcWakeUpStart( void );
+static void rfalNfcWakeUpDone( void );
+static void rfalNfcSaveLastDevice( void );
+#if RFAL_FEATURE_TRACE
+static void rfalNfcTraceDevice( void );
+#endif /* RFAL_FEATURE_TRACE */
+static void rfalNfcSchedEndCycle( void );
 static ReturnCode rfalNfcPollCollResolution( void );
 static ReturnCode rfalNfcPollActivation( uint8_t devIt );
 static ReturnCode rfalNfcDeactivation( void );
@@ -158,6 +207,8 @@ ReturnCode rfalNfcInitialize( void )
     RFAL_EXIT_ON_ERR( err, rfalInitialize() ); /* Initialize RFAL */
     
     RFAL_MEMSET( &gNfcDev, 0x00, sizeof(gNfcDev) );
+    rfalNfcResetPollSched();
+    rfalNfcResetWakeUpStats();
     
     gNfcDev.state = RFAL_NFC_STATE_IDLE;       /* Go to initialized */
     return RFAL_ERR_NONE;
@@ -220,6 +271,22 @@ ReturnCode rfalNfcDiscover( const rfalNfcDiscoverParam *disParams )
     gNfcDev.isDeactivating  = false;
     gNfcDev.disc            = *disParams;
     
+#if RFAL_FEATURE_ISO_DEP && RFAL_FEATURE_ISO_DEP_POLL
+    /* Announce the largest FSD the ISO-DEP buffers can take, never more than they can hold */
+    if( (gNfcDev.disc.isoDepFS == RFAL_ISODEP_FSXI_AUTO) || (gNfcDev.disc.isoDepFS > rfalIsoDepGetMaxFSxI()) )
+    {
+        gNfcDev.disc.isoDepFS = rfalIsoDepGetMaxFSxI();
+    }
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+
+#if RFAL_FEATURE_NFC_DEP
+    /* Negotiate the largest LR the NFC-DEP block buffers can take (LR 254 on the default config) */
+    if( (gNfcDev.disc.nfcDepLR == RFAL_NFCDEP_LR_AUTO) || (gNfcDev.disc.nfcDepLR > rfalNfcDepGetMaxLR()) )
+    {
+        gNfcDev.disc.nfcDepLR = rfalNfcDepGetMaxLR();
+    }
+#endif /* RFAL_FEATURE_NFC_DEP */
+    
     
     /* Calculate Listen Mask */
     gNfcDev.lmMask  = 0U;
@@ -261,6 +328,10 @@ ReturnCode rfalNfcDeactivate( rfalNfcDeactivateType deactType )
 
     gNfcDev.deactType = deactType;
     
+#if RFAL_FEATURE_DPO
+    rfalDpoSetLinkMonitor( false );                                           /* Session over: deactivation frames not accounted */
+#endif /* RFAL_FEATURE_DPO */
+    
     /* Check if Discovery is to continue afterwards or back to Select */
     if( (deactType == RFAL_NFC_DEACTIVATE_DISCOVERY) || (deactType == RFAL_NFC_DEACTIVATE_SLEEP) )
     {
@@ -346,6 +417,74 @@ ReturnCode rfalNfcGetActiveDevice( rfalNfcDevice **dev )
 }
 
 
+/*******************************************************************************/
+ReturnCode rfalNfcGetPollSchedStats( rfalNfcPollSchedStats *stats )
+{
+    /* Check valid parameter */
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    *stats = gNfcDev.sched.stats;
+    return RFAL_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode rfalNfcGetWakeUpStats( rfalNfcWakeUpStats *stats )
+{
+    uint32_t now;
+    
+    /* Check valid parameter */
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    now    = platformGetSysTick();
+    *stats = gNfcDev.wuStats;
+    stats->elapsed = (now - gNfcDev.wuStatsStart);
+    
+    if( gNfcDev.state == RFAL_NFC_STATE_WAKEUP_MODE )                 /* Account the ongoing Wake-Up period */
+    {
+        stats->wuTime += (now - gNfcDev.wuStart);
+    }
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalNfcResetWakeUpStats( void )
+{
+    RFAL_MEMSET( &gNfcDev.wuStats, 0x00, sizeof(gNfcDev.wuStats) );
+    gNfcDev.wuStatsStart = platformGetSysTick();
+    gNfcDev.wuStart      = gNfcDev.wuStatsStart;
+}
+
+
+/*******************************************************************************/
+void rfalNfcResetPollSched( void )
+{
+    uint8_t i;
+    
+    RFAL_MEMSET( &gNfcDev.sched, 0x00, sizeof(gNfcDev.sched) );
+    
+    for( i = 0; i < RFAL_NFC_SCHED_TECH_NUM; i++ )
+    {
+        gNfcDev.sched.order[i]       = gNfcSchedTechs[i];
+        gNfcDev.sched.stats.techs[i] = gNfcSchedTechs[i];
+        gNfcDev.sched.stats.score[i] = RFAL_NFC_SCHED_SCORE_MAX;     /* Unknown mix: assume every technology is present */
+    }
+}
+
+
+/*******************************************************************************/
+void rfalNfcForgetLastDevice( void )
+{
+    gNfcDev.isLastDevValid = false;
+}
+
+
 /*******************************************************************************/
 void rfalNfcWorker( void )
 {
@@ -353,6 +492,10 @@ void rfalNfcWorker( void )
    
     rfalWorker();                                                                     /* Execute RFAL process  */
     
+#if RFAL_FEATURE_STATS
+    rfalStatsNfcStateUpdate( (uint8_t)gNfcDev.state );                               /* Time the state changed outside the worker */
+#endif /* RFAL_FEATURE_STATS */
+    
     switch( gNfcDev.state )
     {   
         /*******************************************************************************/
@@ -370,29 +513,62 @@ void rfalNfcWorker( void )
             gNfcDev.techs2do       = gNfcDev.disc.techs2Find;
             gNfcDev.state          = RFAL_NFC_STATE_POLL_TECHDETECT;
             gNfcDev.isDeactivating = false;
+            
+            rfalNfcSchedPlanCycle();                                          /* Order/skip technologies based on hit statistics */
         
             /* Start total duration timer */
             platformTimerDestroy( gNfcDev.discTmr );
             gNfcDev.discTmr = (uint32_t)platformTimerCreate( gNfcDev.disc.totalDuration );
         
+            /* Check if the last activated device is to be reacquired, before Wake-Up or a full Technology Detection: */
+            /* a device left in the field does not change the Wake-Up measurement                                    */
+            if( (gNfcDev.disc.hotReacquire) && (gNfcDev.isLastDevValid) )
+            {
+                gNfcDev.isTechInit = false;
+                gNfcDev.state      = RFAL_NFC_STATE_POLL_REACQUIRE;
+            }
         #if RFAL_FEATURE_WAKEUP_MODE    
             /* Check if Low power Wake-Up is to be performed */
-            if( (gNfcDev.disc.wakeupEnabled) && ((gNfcDev.techDctCnt == 0U) || (gNfcDev.techDctCnt >= gNfcDev.disc.wakeupNPolls)) )
+            else if( (gNfcDev.disc.wakeupEnabled) && ((gNfcDev.techDctCnt == 0U) || (gNfcDev.techDctCnt >= gNfcDev.disc.wakeupNPolls)) )
             {
                 /* Initialize Low power Wake-up mode and wait */
-                err = rfalWakeUpModeStart( (gNfcDev.disc.wakeupConfigDefault ? NULL : &gNfcDev.disc.wakeupConfig) );
+                gNfcDev.isWoken = false;                                      /* Back to sleep: previous Wake-Up not activated */
+                err = rfalNfcWakeUpStart();
                 if( err == RFAL_ERR_NONE )
                 {
                     gNfcDev.state = RFAL_NFC_STATE_WAKEUP_MODE;
                 }
             }
+            else
+            {
+                /* MISRA 15.7 - Empty else */
+            }
             gNfcDev.techDctCnt++;
-            
         #endif /* RFAL_FEATURE_WAKEUP_MODE */
             
             rfalNfcNfcNotify( gNfcDev.state );                                /* Notify caller that WU or Technology Detection has started  */
             break;
         
+        /*******************************************************************************/
+        case RFAL_NFC_STATE_POLL_REACQUIRE:
+            
+            err = rfalNfcPollReacquire();                                             /* Targeted wake-up of the last device */
+            if( err != RFAL_ERR_BUSY )
+            {
+                gNfcDev.isTechInit = false;
+                
+                if( err == RFAL_ERR_NONE )                                            /* Same device still present: activate it */
+                {
+                    gNfcDev.selDevIdx = 0U;
+                    gNfcDev.state     = RFAL_NFC_STATE_POLL_ACTIVATION;
+                    break;
+                }
+                
+                gNfcDev.isLastDevValid = false;                                       /* Miss: forget it and run full discovery */
+                gNfcDev.state          = RFAL_NFC_STATE_POLL_TECHDETECT;
+            }
+            break;
+        
         /*******************************************************************************/
         case RFAL_NFC_STATE_WAKEUP_MODE:
             
@@ -401,25 +577,58 @@ void rfalNfcWorker( void )
             if( rfalWakeUpModeHasWoke() )
             {
                 rfalWakeUpModeStop();                                                 /* Disable Wake-up mode           */
-                gNfcDev.state      = RFAL_NFC_STATE_POLL_TECHDETECT;                  /* Go to Technology detection     */
-                gNfcDev.techDctCnt = 1;                                               /* Tech Detect counter (1 woke)   */
                 
-                /* (Re)Start total duration timer upon waking up */
-                platformTimerDestroy( gNfcDev.discTmr );
-                gNfcDev.discTmr = (uint32_t)platformTimerCreate( gNfcDev.disc.totalDuration );
+                gNfcDev.wuStats.wakeCnt++;
+                gNfcDev.wuStats.lastWake = platformGetSysTick();
+                gNfcDev.wuStats.wuTime  += (gNfcDev.wuStats.lastWake - gNfcDev.wuStart);
+                
+                /* A measurement change may be anything (metal, hand): confirm with a short Card Detection first */
+                if( (gNfcDev.disc.wakeupCdConfirm) && (rfalCdStartDetectCard( &gNfcDev.cdRes ) == RFAL_ERR_NONE) )
+                {
+                    gNfcDev.state = RFAL_NFC_STATE_WAKEUP_CD;
+                    break;
+                }
                 
-                rfalNfcNfcNotify( gNfcDev.state );                                    /* Notify caller that WU has woke */
+                rfalNfcWakeUpDone();
             }
     #endif /* RFAL_FEATURE_WAKEUP_MODE */
 
             break;
             
+        /*******************************************************************************/
+        case RFAL_NFC_STATE_WAKEUP_CD:
+            
+    #if RFAL_FEATURE_WAKEUP_MODE
+            err = rfalCdGetDetectCardStatus();
+            if( err == RFAL_ERR_BUSY )
+            {
+                break;
+            }
+            
+            /* Nothing in the field: back to Wake-Up, the auto reference tracks the new environment */
+            if( (err == RFAL_ERR_NONE) && (gNfcDev.cdRes.detType == RFAL_CD_NOT_FOUND) )
+            {
+                gNfcDev.wuStats.cdFalseCnt++;
+                if( rfalNfcWakeUpStart() == RFAL_ERR_NONE )
+                {
+                    gNfcDev.state = RFAL_NFC_STATE_WAKEUP_MODE;
+                    break;
+                }
+            }
+            
+            rfalNfcWakeUpDone();                                                      /* Card, phone or error: full discovery */
+    #endif /* RFAL_FEATURE_WAKEUP_MODE */
+            
+            break;
+            
         /*******************************************************************************/
         case RFAL_NFC_STATE_POLL_TECHDETECT:
         
             err = rfalNfcPollTechDetetection();                                       /* Perform Technology Detection                         */
             if( err != RFAL_ERR_BUSY )                                                /* Wait until all technologies are performed            */
             {
+                rfalNfcSchedEndCycle();                                               /* Learn from the technologies found on this cycle      */
+                
                 if( ( err != RFAL_ERR_NONE) || (gNfcDev.techsFound == RFAL_NFC_TECH_NONE) )/* Check if any error occurred or no techs were found   */
                 {
                     rfalFieldOff();
@@ -487,6 +696,24 @@ void rfalNfcWorker( void )
                     break;
                 }
                 
+                rfalNfcSaveLastDevice();                                              /* Keep it as hot reacquire target       */
+                
+            #if RFAL_FEATURE_TRACE
+                rfalNfcTraceDevice();                                                 /* Let a replay start from this device   */
+            #endif /* RFAL_FEATURE_TRACE */
+                
+                gNfcDev.wuStats.lastActWoken = gNfcDev.isWoken;                       /* Else lastWake is an older Wake-Up     */
+                if( gNfcDev.isWoken )                                                 /* Time Wake-Up to activation            */
+                {
+                    gNfcDev.isWoken = false;
+                    gNfcDev.wuStats.wakeActCnt++;
+                    gNfcDev.wuStats.wakeActTimeSum += (platformGetSysTick() - gNfcDev.wuStats.lastWake);
+                }
+                
+            #if RFAL_FEATURE_DPO
+                rfalDpoSetLinkMonitor( true );                                        /* Session frames drive the DPO loop     */
+            #endif /* RFAL_FEATURE_DPO */
+                
                 gNfcDev.state = RFAL_NFC_STATE_ACTIVATED;                             /* Device has been properly activated    */
                 rfalNfcNfcNotify( gNfcDev.state );                                    /* Inform upper layer that a device has been activated */
             }
@@ -613,8 +840,12 @@ void rfalNfcWorker( void )
         case RFAL_NFC_STATE_POLL_SELECT:
         case RFAL_NFC_STATE_DATAEXCHANGE_DONE:
         default:
-            return;
+            break;
     }
+    
+#if RFAL_FEATURE_STATS
+    rfalStatsNfcStateUpdate( (uint8_t)gNfcDev.state );                               /* Time the state reached by this step */
+#endif /* RFAL_FEATURE_STATS */
 }
 
 
@@ -673,7 +904,7 @@ ReturnCode rfalNfcDataExchangeStart( uint8_t *txData, uint16_t txDataLen, uint8_
                     return RFAL_ERR_NOMEM;
                 }
                 
-                if( txDataLen > 0U )
+                if( (txDataLen > 0U) && (txData != gNfcDev.txBuf.isoDepBuf.apdu) )     /* Skip the copy if composed in place */
                 {
                     RFAL_MEMCPY( (uint8_t*)gNfcDev.txBuf.isoDepBuf.apdu, txData, txDataLen );
                 }
@@ -709,7 +940,7 @@ ReturnCode rfalNfcDataExchangeStart( uint8_t *txData, uint16_t txDataLen, uint8_
                     return RFAL_ERR_NOMEM;
                 }
                 
-                if( txDataLen > 0U)
+                if( (txDataLen > 0U) && (txData != gNfcDev.txBuf.nfcDepBuf.pdu) )      /* Skip the copy if composed in place */
                 {
                     RFAL_MEMCPY( (uint8_t*)gNfcDev.txBuf.nfcDepBuf.pdu, txData, txDataLen );
                 }
@@ -838,6 +1069,46 @@ ReturnCode rfalNfcDataExchangeGetStatus( void )
     return gNfcDev.dataExErr;
 }
 
+
+/*******************************************************************************/
+ReturnCode rfalNfcDataExchangeGetTxBuf( uint8_t **txBuf, uint16_t *txBufLen )
+{
+    if( (txBuf == NULL) || (txBufLen == NULL) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    if( (gNfcDev.state < RFAL_NFC_STATE_ACTIVATED) || (gNfcDev.activeDev == NULL) )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+    
+    switch( gNfcDev.activeDev->rfInterface )
+    {
+    #if RFAL_FEATURE_ISO_DEP
+        /*******************************************************************************/
+        case RFAL_NFC_INTERFACE_ISODEP:
+            *txBuf    = (uint8_t*)gNfcDev.txBuf.isoDepBuf.apdu;
+            *txBufLen = (uint16_t)sizeof(gNfcDev.txBuf.isoDepBuf.apdu);
+            break;
+    #endif /* RFAL_FEATURE_ISO_DEP */
+    
+    #if RFAL_FEATURE_NFC_DEP
+        /*******************************************************************************/
+        case RFAL_NFC_INTERFACE_NFCDEP:
+            *txBuf    = (uint8_t*)gNfcDev.txBuf.nfcDepBuf.pdu;
+            *txBufLen = (uint16_t)sizeof(gNfcDev.txBuf.nfcDepBuf.pdu);
+            break;
+    #endif /* RFAL_FEATURE_NFC_DEP */
+    
+        /*******************************************************************************/
+        default:
+            return RFAL_ERR_NOTSUPP;
+    }
+    
+    return RFAL_ERR_NONE;
+}
+
 /*!
  ******************************************************************************
  * \brief Poller Technology Detection
@@ -854,6 +1125,8 @@ ReturnCode rfalNfcDataExchangeGetStatus( void )
 static ReturnCode rfalNfcPollTechDetetection( void )
 {
     ReturnCode err;
+    uint8_t    i;
+    uint16_t   tech;
     
     err = RFAL_ERR_NONE;
     
@@ -917,253 +1190,813 @@ static ReturnCode rfalNfcPollTechDetetection( void )
 
     
     /*******************************************************************************/
-    /* Passive NFC-A Technology Detection                                          */
+    /* Passive Technology Detection, in the order planned for this cycle           */
     /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_A) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_A) != 0U) )
+    for( i = 0; i < RFAL_NFC_SCHED_TECH_NUM; i++ )
     {
+        tech = gNfcDev.sched.order[i];
         
-    #if RFAL_FEATURE_NFCA
+        if( ((gNfcDev.disc.techs2Find & tech) == 0U) || ((gNfcDev.techs2do & tech) == 0U) )
+        {
+            continue;
+        }
         
-        if( !gNfcDev.isTechInit )
+        switch( tech )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcaPollerInitialize() );                       /* Initialize RFAL for NFC-A */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                          /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit    = true;
-            gNfcDev.isOperOngoing = false;                                             /* No operation currently ongoing  */
+            case RFAL_NFC_POLL_TECH_A:      err = rfalNfcPollTechDetectA();      break;
+            case RFAL_NFC_POLL_TECH_B:      err = rfalNfcPollTechDetectB();      break;
+            case RFAL_NFC_POLL_TECH_F:      err = rfalNfcPollTechDetectF();      break;
+            case RFAL_NFC_POLL_TECH_V:      err = rfalNfcPollTechDetectV();      break;
+            case RFAL_NFC_POLL_TECH_ST25TB: err = rfalNfcPollTechDetectST25TB(); break;
+            default:                        err = rfalNfcPollTechDetectProp();   break;
         }
         
-        if( rfalIsGTExpired() )                                                        /* Wait until Guard Time is fulfilled */
+        /* Time the first detection of this cycle */
+        if( (!gNfcDev.sched.isDetected) && (gNfcDev.techsFound != RFAL_NFC_TECH_NONE) )
         {
-            if( !gNfcDev.isOperOngoing )
-            {
-                rfalNfcaPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensRes );/* Poll for NFC-A devices */
-             
-                gNfcDev.isOperOngoing = true;
-                return RFAL_ERR_BUSY;
-            }
-            
-            err = rfalNfcaPollerGetTechnologyDetectionStatus();
-            if( err != RFAL_ERR_BUSY )
-            {
-                if( err == RFAL_ERR_NONE )
-                {
-                    gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_A;
-                }
-                
-                gNfcDev.isTechInit = false;
-                gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_A;
-            }
-            
-            /* Check if bail-out after NFC-A     Activity 2.1  9.2.3.21 */
-            if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_A) != 0U) && (gNfcDev.techsFound != 0U) )
-            {
-                return RFAL_ERR_NONE;
-            }
+            gNfcDev.sched.stats.detectTimeSum += (platformGetSysTick() - gNfcDev.sched.cycleStart);
+            gNfcDev.sched.stats.detectCnt++;
+            gNfcDev.sched.isDetected = true;
         }
+        
+        return err;
+    }
     
-        return RFAL_ERR_BUSY;
+    return RFAL_ERR_NONE;
+}
 
-    #endif /* RFAL_FEATURE_NFCA */
-    }
+/*!
+ ******************************************************************************
+ * \brief Poller Technology Detection NFC-A
+ * 
+ * This method performs the Technology Detection for NFC-A devices
+ * 
+ * \return  RFAL_ERR_NONE         : Bail-out after this technology
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or technology done
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectA( void )
+{
+    ReturnCode err;
     
+    err = RFAL_ERR_NONE;
     
-    /*******************************************************************************/
-    /* Passive NFC-B Technology Detection                                          */
-    /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_B) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_B) != 0U) )
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    
+#if RFAL_FEATURE_NFCA
+    
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_NFCB
-        
-        if( !gNfcDev.isTechInit )
+        RFAL_EXIT_ON_ERR( err, rfalNfcaPollerInitialize() );                       /* Initialize RFAL for NFC-A */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                          /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit    = true;
+        gNfcDev.isOperOngoing = false;                                             /* No operation currently ongoing  */
+    }
+    
+    if( rfalIsGTExpired() )                                                        /* Wait until Guard Time is fulfilled */
+    {
+        if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcbPollerInitialize() );                      /* Initialize RFAL for NFC-B */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit    = true;
-            gNfcDev.isOperOngoing = false;                                            /* No operation currently ongoing  */
+            rfalNfcaPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensRes );/* Poll for NFC-A devices */
+         
+            gNfcDev.isOperOngoing = true;
+            return RFAL_ERR_BUSY;
         }
         
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+        err = rfalNfcaPollerGetTechnologyDetectionStatus();
+        if( err != RFAL_ERR_BUSY )
         {
-            
-            if( !gNfcDev.isOperOngoing )
-            {
-                rfalNfcbPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensbRes, &gNfcDev.sensbResLen );/* Poll for NFC-B devices */
-             
-                gNfcDev.isOperOngoing = true;
-                return RFAL_ERR_BUSY;
-            }
-            
-            err = rfalNfcbPollerGetTechnologyDetectionStatus();
-            if( err != RFAL_ERR_BUSY )
+            if( err == RFAL_ERR_NONE )
             {
-                if( err == RFAL_ERR_NONE )
-                {
-                    gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_B;
-                }
-                
-                gNfcDev.isTechInit = false;
-                gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_B;
+                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_A;
             }
             
-            /* Check if bail-out after NFC-B     Activity 2.1  9.2.3.26 */
-            if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_B) != 0U) && (gNfcDev.techsFound != 0U) )
-            {
-                return RFAL_ERR_NONE;
-            }
-        }        
+            gNfcDev.isTechInit = false;
+            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_A;
+        }
         
-        return RFAL_ERR_BUSY;
+        /* Check if bail-out after NFC-A     Activity 2.1  9.2.3.21 */
+        if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_A) != 0U) && (gNfcDev.techsFound != 0U) )
+        {
+            return RFAL_ERR_NONE;
+        }
+    }
+
+    return RFAL_ERR_BUSY;
+
+#else
+
+    gNfcDev.techs2do &= ~RFAL_NFC_POLL_TECH_A;                              /* Technology not enabled, skip it */
+    return RFAL_ERR_BUSY;
+
+#endif /* RFAL_FEATURE_NFCA */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Technology Detection NFC-B
+ * 
+ * This method performs the Technology Detection for NFC-B devices
+ * 
+ * \return  RFAL_ERR_NONE         : Bail-out after this technology
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or technology done
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectB( void )
+{
+    ReturnCode err;
     
-    #endif /* RFAL_FEATURE_NFCB */
+    err = RFAL_ERR_NONE;
+    
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    
+#if RFAL_FEATURE_NFCB
+    
+    if( !gNfcDev.isTechInit )
+    {
+        RFAL_EXIT_ON_ERR( err, rfalNfcbPollerInitialize() );                      /* Initialize RFAL for NFC-B */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit    = true;
+        gNfcDev.isOperOngoing = false;                                            /* No operation currently ongoing  */
     }
     
-    /*******************************************************************************/
-    /* Passive NFC-F Technology Detection                                          */
-    /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_F) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_F) != 0U) )
+    if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
     {
-    #if RFAL_FEATURE_NFCF
-     
-        if( !gNfcDev.isTechInit )
+        
+        if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcfPollerInitialize( gNfcDev.disc.nfcfBR ) );/* Initialize RFAL for NFC-F */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                        /* As field is already On only starts GT timer */
-            
-            gNfcDev.isTechInit    = true;
-            gNfcDev.isOperOngoing = false;                                           /* No operation currently ongoing  */
+            rfalNfcbPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensbRes, &gNfcDev.sensbResLen );/* Poll for NFC-B devices */
+         
+            gNfcDev.isOperOngoing = true;
+            return RFAL_ERR_BUSY;
         }
-
-        if( rfalIsGTExpired() )                                                      /* Wait until Guard Time is fulfilled */
+        
+        err = rfalNfcbPollerGetTechnologyDetectionStatus();
+        if( err != RFAL_ERR_BUSY )
         {
-            
-            if( !gNfcDev.isOperOngoing )
-            {
-                rfalNfcfPollerStartCheckPresence();
-             
-                gNfcDev.isOperOngoing = true;
-                return RFAL_ERR_BUSY;
-            }
-            
-            err = rfalNfcfPollerGetCheckPresenceStatus();                            /* Poll for NFC-F devices */
-            if( err != RFAL_ERR_BUSY )
+            if( err == RFAL_ERR_NONE )
             {
-                if( err == RFAL_ERR_NONE )
-                {
-                    gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_F;
-                }
-                
-                gNfcDev.isTechInit = false;
-                gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_F;
+                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_B;
             }
             
-            /* Check if bail-out after NFC-F     Activity 2.1  9.2.3.31 */
-            if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_F) != 0U) && (gNfcDev.techsFound != 0U) )
-            {
-                return RFAL_ERR_NONE;
-            }
+            gNfcDev.isTechInit = false;
+            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_B;
         }
         
-        return RFAL_ERR_BUSY;
+        /* Check if bail-out after NFC-B     Activity 2.1  9.2.3.26 */
+        if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_B) != 0U) && (gNfcDev.techsFound != 0U) )
+        {
+            return RFAL_ERR_NONE;
+        }
+    }        
     
-    #endif /* RFAL_FEATURE_NFCF */
-    }
+    return RFAL_ERR_BUSY;
+
+#else
+
+    gNfcDev.techs2do &= ~RFAL_NFC_POLL_TECH_B;                              /* Technology not enabled, skip it */
+    return RFAL_ERR_BUSY;
+
+#endif /* RFAL_FEATURE_NFCB */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Technology Detection NFC-F
+ * 
+ * This method performs the Technology Detection for NFC-F devices
+ * 
+ * \return  RFAL_ERR_NONE         : Bail-out after this technology
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or technology done
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectF( void )
+{
+    ReturnCode err;
     
+    err = RFAL_ERR_NONE;
     
-    /*******************************************************************************/
-    /* Passive NFC-V Technology Detection                                          */
-    /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_V) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_V) != 0U) )
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    
+#if RFAL_FEATURE_NFCF
+ 
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_NFCV
+        RFAL_EXIT_ON_ERR( err, rfalNfcfPollerInitialize( gNfcDev.disc.nfcfBR ) );/* Initialize RFAL for NFC-F */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                        /* As field is already On only starts GT timer */
         
-        rfalNfcvInventoryRes invRes;
- 
-        if( !gNfcDev.isTechInit )
+        gNfcDev.isTechInit    = true;
+        gNfcDev.isOperOngoing = false;                                           /* No operation currently ongoing  */
+    }
+
+    if( rfalIsGTExpired() )                                                      /* Wait until Guard Time is fulfilled */
+    {
+        
+        if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcvPollerInitialize() );                      /* Initialize RFAL for NFC-V */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit = true;
+            rfalNfcfPollerStartCheckPresence();
+         
+            gNfcDev.isOperOngoing = true;
+            return RFAL_ERR_BUSY;
         }
-                
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+        
+        err = rfalNfcfPollerGetCheckPresenceStatus();                            /* Poll for NFC-F devices */
+        if( err != RFAL_ERR_BUSY )
         {
-            err = rfalNfcvPollerCheckPresence( &invRes );                             /* Poll for NFC-V devices */
             if( err == RFAL_ERR_NONE )
             {
-                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_V;
+                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_F;
             }
             
             gNfcDev.isTechInit = false;
-            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_V;
+            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_F;
         }
         
-        return RFAL_ERR_BUSY;
+        /* Check if bail-out after NFC-F     Activity 2.1  9.2.3.31 */
+        if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_F) != 0U) && (gNfcDev.techsFound != 0U) )
+        {
+            return RFAL_ERR_NONE;
+        }
+    }
     
-    #endif /* RFAL_FEATURE_NFCV */
+    return RFAL_ERR_BUSY;
+
+#else
+
+    gNfcDev.techs2do &= ~RFAL_NFC_POLL_TECH_F;                              /* Technology not enabled, skip it */
+    return RFAL_ERR_BUSY;
+
+#endif /* RFAL_FEATURE_NFCF */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Technology Detection NFC-V
+ * 
+ * This method performs the Technology Detection for NFC-V devices
+ * 
+ * \return  RFAL_ERR_NONE         : Bail-out after this technology
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or technology done
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectV( void )
+{
+    ReturnCode err;
+    
+    err = RFAL_ERR_NONE;
+    
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    
+#if RFAL_FEATURE_NFCV
+    
+    rfalNfcvInventoryRes invRes;
+
+    if( !gNfcDev.isTechInit )
+    {
+        RFAL_EXIT_ON_ERR( err, rfalNfcvPollerInitialize() );                      /* Initialize RFAL for NFC-V */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit = true;
     }
+            
+    if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+    {
+        err = rfalNfcvPollerCheckPresence( &invRes );                             /* Poll for NFC-V devices */
+        if( err == RFAL_ERR_NONE )
+        {
+            gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_V;
+        }
+        
+        gNfcDev.isTechInit = false;
+        gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_V;
+    }
+    
+    return RFAL_ERR_BUSY;
+
+#else
+
+    gNfcDev.techs2do &= ~RFAL_NFC_POLL_TECH_V;                              /* Technology not enabled, skip it */
+    return RFAL_ERR_BUSY;
+
+#endif /* RFAL_FEATURE_NFCV */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Technology Detection ST25TB
+ * 
+ * This method performs the Technology Detection for ST25TB devices
+ * 
+ * \return  RFAL_ERR_NONE         : Bail-out after this technology
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or technology done
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectST25TB( void )
+{
+    ReturnCode err;
     
+    err = RFAL_ERR_NONE;
     
-    /*******************************************************************************/
-    /* Passive Proprietary Technology ST25TB                                       */
-    /*******************************************************************************/  
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_ST25TB) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_ST25TB) != 0U) )
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    
+#if RFAL_FEATURE_ST25TB
+    
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_ST25TB
+        RFAL_EXIT_ON_ERR( err, rfalSt25tbPollerInitialize() );                    /* Initialize RFAL for NFC-V */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit = true;
+    }
+ 
+    if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+    {
+        err = rfalSt25tbPollerCheckPresence( NULL );                              /* Poll for ST25TB devices */
+        if( err == RFAL_ERR_NONE )
+        {
+            gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_ST25TB;
+        }
         
-        if( !gNfcDev.isTechInit )
+        gNfcDev.isTechInit = false;
+        gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_ST25TB;
+    }
+    
+    return RFAL_ERR_BUSY;
+    
+#else
+
+    gNfcDev.techs2do &= ~RFAL_NFC_POLL_TECH_ST25TB;                              /* Technology not enabled, skip it */
+    return RFAL_ERR_BUSY;
+
+#endif /* RFAL_FEATURE_ST25TB */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Technology Detection Proprietary NFC
+ * 
+ * This method performs the Technology Detection for Proprietary NFC devices
+ * 
+ * \return  RFAL_ERR_NONE         : Bail-out after this technology
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or technology done
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectProp( void )
+{
+    ReturnCode err;
+    
+    err = RFAL_ERR_NONE;
+    
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    
+    if( !gNfcDev.isTechInit )
+    {
+        RFAL_EXIT_ON_ERR( err, rfalNfcpCbPollerInitialize() );                    /* Initialize RFAL for Proprietary NFC */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field may already be On only starts GT timer */
+        gNfcDev.isTechInit = true;
+    }
+ 
+    if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+    {
+        err = rfalNfcpCbPollerTechnologyDetection();                              /* Poll for devices */
+        if( err == RFAL_ERR_NONE )
         {
-            RFAL_EXIT_ON_ERR( err, rfalSt25tbPollerInitialize() );                    /* Initialize RFAL for NFC-V */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit = true;
+            gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_PROP;
         }
-     
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+        
+        gNfcDev.isTechInit = false;
+        gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_PROP;
+    }
+    
+    return RFAL_ERR_BUSY;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Wake-Up Start
+ * 
+ * This method (re)starts the Low power Wake-Up mode. Started with the field 
+ * off, an auto reference is measured on the current environment.
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcWakeUpStart( void )
+{
+#if RFAL_FEATURE_WAKEUP_MODE
+    ReturnCode err;
+    
+    err = rfalWakeUpModeStart( (gNfcDev.disc.wakeupConfigDefault ? NULL : &gNfcDev.disc.wakeupConfig) );
+    if( err == RFAL_ERR_NONE )
+    {
+        gNfcDev.wuStart = platformGetSysTick();
+    }
+    return err;
+#else
+    return RFAL_ERR_DISABLED;
+#endif /* RFAL_FEATURE_WAKEUP_MODE */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Wake-Up Done
+ * 
+ * This method leaves the Wake-Up front end into Technology Detection and 
+ * restarts the discovery timers from the wake up.
+ * 
+ ******************************************************************************
+ */
+static void rfalNfcWakeUpDone( void )
+{
+    gNfcDev.isWoken    = true;
+    gNfcDev.state      = RFAL_NFC_STATE_POLL_TECHDETECT;                  /* Go to Technology detection     */
+    gNfcDev.techDctCnt = 1;                                               /* Tech Detect counter (1 woke)   */
+    gNfcDev.sched.cycleStart = platformGetSysTick();                      /* Time detection from waking up  */
+    
+    /* (Re)Start total duration timer upon waking up */
+    platformTimerDestroy( gNfcDev.discTmr );
+    gNfcDev.discTmr = (uint32_t)platformTimerCreate( gNfcDev.disc.totalDuration );
+    
+    rfalNfcNfcNotify( gNfcDev.state );                                    /* Notify caller that WU has woke */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poll Scheduler Plan Cycle
+ * 
+ * This method prepares the Technology Detection of a new discovery cycle 
+ * according to the configured policy: it orders the passive technologies 
+ * by hit score and, for the weighted policy, removes from techs2do the rare 
+ * technologies that have been polled recently. A rare technology is polled 
+ * at least every probePeriod cycles so that it is never starved.
+ * 
+ ******************************************************************************
+ */
+static void rfalNfcSchedPlanCycle( void )
+{
+    uint8_t  i;
+    uint8_t  j;
+    uint8_t  probePeriod;
+    uint8_t  minScore;
+    uint16_t tech;
+    
+    probePeriod = ( (gNfcDev.disc.pollSched.probePeriod == 0U) ? RFAL_NFC_SCHED_PROBE_PERIOD_DFLT : gNfcDev.disc.pollSched.probePeriod );
+    minScore    = ( (gNfcDev.disc.pollSched.minScore    == 0U) ? RFAL_NFC_SCHED_MIN_SCORE_DFLT    : gNfcDev.disc.pollSched.minScore    );
+    
+    for( i = 0; i < RFAL_NFC_SCHED_TECH_NUM; i++ )
+    {
+        gNfcDev.sched.order[i] = gNfcSchedTechs[i];
+        
+        /* Skip rare technologies unless they are due for a probe */
+        if( (gNfcDev.disc.pollSched.policy == RFAL_NFC_POLL_SCHED_WEIGHTED) && ((gNfcDev.techs2do & gNfcSchedTechs[i]) != 0U) )
         {
-            err = rfalSt25tbPollerCheckPresence( NULL );                              /* Poll for ST25TB devices */
-            if( err == RFAL_ERR_NONE )
+            if( (gNfcDev.sched.stats.score[i] < minScore) && ((gNfcDev.sched.age[i] + 1U) < probePeriod) )
             {
-                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_ST25TB;
+                gNfcDev.techs2do &= ~gNfcSchedTechs[i];
             }
+        }
+    }
+    
+    /* Order by descending hit score, equal scores keep the Activity order */
+    if( gNfcDev.disc.pollSched.policy != RFAL_NFC_POLL_SCHED_FIXED )
+    {
+        for( i = 1; i < RFAL_NFC_SCHED_TECH_NUM; i++ )
+        {
+            tech = gNfcDev.sched.order[i];
+            j    = i;
             
-            gNfcDev.isTechInit = false;
-            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_ST25TB;
+            while( (j > 0U) && (gNfcDev.sched.stats.score[rfalNfcSchedTechIdx(gNfcDev.sched.order[j - 1U])] < gNfcDev.sched.stats.score[rfalNfcSchedTechIdx(tech)]) )
+            {
+                gNfcDev.sched.order[j] = gNfcDev.sched.order[j - 1U];
+                j--;
+            }
+            gNfcDev.sched.order[j] = tech;
+        }
+    }
+    
+    gNfcDev.sched.planned    = gNfcDev.techs2do;
+    gNfcDev.sched.cycleStart = platformGetSysTick();
+    gNfcDev.sched.isDetected = false;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poll Scheduler End Cycle
+ * 
+ * This method updates the hit statistics once the Technology Detection 
+ * has concluded. Only the technologies effectively polled are accounted, 
+ * their score is an exponential moving average of the hits.
+ * 
+ ******************************************************************************
+ */
+static void rfalNfcSchedEndCycle( void )
+{
+    uint8_t  i;
+    uint16_t polled;
+    
+    polled = (gNfcDev.sched.planned & ~gNfcDev.techs2do);
+    
+    for( i = 0; i < RFAL_NFC_SCHED_TECH_NUM; i++ )
+    {
+        if( (gNfcDev.disc.techs2Find & gNfcSchedTechs[i]) == 0U )
+        {
+            continue;
         }
         
-        return RFAL_ERR_BUSY;
+        if( (polled & gNfcSchedTechs[i]) == 0U )
+        {
+            gNfcDev.sched.age[i] = (uint8_t)RFAL_MIN( (gNfcDev.sched.age[i] + 1U), 0xFFU );
+            continue;
+        }
         
-    #endif /* RFAL_FEATURE_ST25TB */
+        gNfcDev.sched.age[i] = 0U;
+        gNfcDev.sched.stats.polls[i]++;
+        gNfcDev.sched.stats.score[i] -= (gNfcDev.sched.stats.score[i] >> 2U);
+        
+        if( (gNfcDev.techsFound & gNfcSchedTechs[i]) != 0U )
+        {
+            gNfcDev.sched.stats.hits[i]++;
+            gNfcDev.sched.stats.score[i] += (RFAL_NFC_SCHED_SCORE_MAX >> 2U);
+        }
     }
     
-    /*******************************************************************************/
-    /* Passive Proprietary Technology                                              */
-    /*******************************************************************************/  
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_PROP) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_PROP) != 0U) )
+    gNfcDev.sched.stats.cycles++;
+    gNfcDev.sched.stats.pollTimeSum += (platformGetSysTick() - gNfcDev.sched.cycleStart);
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Save Last Device
+ * 
+ * This method keeps a copy of the device that has just been activated in 
+ * Poll mode so that it can be reacquired on the next discovery cycle.
+ * Only devices that can be addressed by their identifier are kept.
+ * 
+ ******************************************************************************
+ */
+static void rfalNfcSaveLastDevice( void )
+{
+    if( gNfcDev.activeDev == NULL )
     {
-        if( !gNfcDev.isTechInit )
+        return;
+    }
+    
+    switch( gNfcDev.activeDev->type )
+    {
+        case RFAL_NFC_LISTEN_TYPE_NFCA:
+            gNfcDev.isLastDevValid = (gNfcDev.activeDev->dev.nfca.type != RFAL_NFCA_T1T);     /* T1T has no SELECT by NFCID1 */
+            break;
+        
+        case RFAL_NFC_LISTEN_TYPE_NFCF:
+            if( (!gNfcDev.isLastDevValid) || (gNfcDev.lastDev.type != RFAL_NFC_LISTEN_TYPE_NFCF) || 
+                (RFAL_BYTECMP( gNfcDev.lastDev.dev.nfcf.sensfRes.NFCID2, gNfcDev.activeDev->dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN ) != 0) )
+            {
+                gNfcDev.lastSysCode = RFAL_NFCF_SYSTEMCODE;                          /* New device: System Code not yet known */
+            }
+            gNfcDev.isLastDevValid = true;
+            break;
+            
+        case RFAL_NFC_LISTEN_TYPE_NFCV:
+            gNfcDev.isLastDevValid = true;
+            break;
+        
+        default:
+            gNfcDev.isLastDevValid = false;
+            break;
+    }
+    
+    gNfcDev.lastDev = *gNfcDev.activeDev;
+}
+
+
+#if RFAL_FEATURE_TRACE
+/*!
+ ******************************************************************************
+ * \brief Trace Device
+ * 
+ * This method records the device that has just been activated in Poll mode
+ * on the frame capture, with what the upper layers take from it.
+ * 
+ ******************************************************************************
+ */
+static void rfalNfcTraceDevice( void )
+{
+    rfalTraceDevice dev;
+    
+    if( gNfcDev.activeDev == NULL )
+    {
+        return;
+    }
+    
+    RFAL_MEMSET( &dev, 0x00, sizeof(rfalTraceDevice) );
+    dev.type     = (uint8_t)gNfcDev.activeDev->type;
+    dev.subType  = ((gNfcDev.activeDev->type == RFAL_NFC_LISTEN_TYPE_NFCA) ? (uint8_t)gNfcDev.activeDev->dev.nfca.type : 0U);
+    dev.nfcidLen = RFAL_MIN( gNfcDev.activeDev->nfcidLen, (uint8_t)RFAL_TRACE_NFCID_MAX_LEN );
+    if( gNfcDev.activeDev->nfcid != NULL )
+    {
+        RFAL_MEMCPY( dev.nfcid, gNfcDev.activeDev->nfcid, dev.nfcidLen );
+    }
+    
+#if RFAL_FEATURE_ISO_DEP
+    if( gNfcDev.activeDev->rfInterface == RFAL_NFC_INTERFACE_ISODEP )
+    {
+        dev.DID  = gNfcDev.activeDev->proto.isoDep.info.DID;
+        dev.FSx  = gNfcDev.activeDev->proto.isoDep.info.FSx;
+        dev.FWT  = gNfcDev.activeDev->proto.isoDep.info.FWT;
+        dev.dFWT = gNfcDev.activeDev->proto.isoDep.info.dFWT;
+    }
+#endif /* RFAL_FEATURE_ISO_DEP */
+    
+    rfalTraceDev( &dev );
+}
+#endif /* RFAL_FEATURE_TRACE */
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Reacquire
+ * 
+ * This method tries to wake up and identify the last activated device 
+ * directly, skipping Technology Detection and Collision Resolution.
+ * On success the device is placed on the device list ready for activation.
+ * 
+ * \return  RFAL_ERR_NONE         : Last device is present
+ * \return  RFAL_ERR_BUSY         : Operation ongoing
+ * \return  RFAL_ERR_NOTFOUND     : A different device answered
+ * \return  RFAL_ERR_XXXX         : Last device not reacquired
+ * 
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollReacquire( void )
+{
+    ReturnCode     err;
+    rfalNfcDevice  *dev;
+    
+    err = RFAL_ERR_NOTSUPP;
+    dev = &gNfcDev.devList[0];
+    
+    /* Suppress warning when specific RFAL features have been disabled */
+    RFAL_NO_WARNING(err);
+    RFAL_NO_WARNING(dev);
+    
+    if( !gNfcDev.isTechInit )
+    {
+        switch( gNfcDev.lastDev.type )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcpCbPollerInitialize() );                    /* Initialize RFAL for Proprietary NFC */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field may already be On only starts GT timer */
-            gNfcDev.isTechInit = true;
+        #if RFAL_FEATURE_NFCA
+            case RFAL_NFC_LISTEN_TYPE_NFCA:
+                RFAL_EXIT_ON_ERR( err, rfalNfcaPollerInitialize() );                  /* Initialize RFAL for NFC-A */
+                break;
+        #endif /* RFAL_FEATURE_NFCA */
+        
+        #if RFAL_FEATURE_NFCF
+            case RFAL_NFC_LISTEN_TYPE_NFCF:
+                RFAL_EXIT_ON_ERR( err, rfalNfcfPollerInitialize( gNfcDev.disc.nfcfBR ) ); /* Initialize RFAL for NFC-F */
+                break;
+        #endif /* RFAL_FEATURE_NFCF */
+        
+        #if RFAL_FEATURE_NFCV
+            case RFAL_NFC_LISTEN_TYPE_NFCV:
+                RFAL_EXIT_ON_ERR( err, rfalNfcvPollerInitialize() );                  /* Initialize RFAL for NFC-V */
+                break;
+        #endif /* RFAL_FEATURE_NFCV */
+        
+            default:
+                return RFAL_ERR_NOTSUPP;
         }
-     
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+        
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                             /* Turns the Field On and starts GT timer */
+        gNfcDev.isFieldOn  = true;
+        gNfcDev.isTechInit = true;
+        return RFAL_ERR_BUSY;
+    }
+    
+    if( !rfalIsGTExpired() )                                                          /* Wait until Guard Time is fulfilled */
+    {
+        return RFAL_ERR_BUSY;
+    }
+    
+    *dev = gNfcDev.lastDev;
+    
+    switch( dev->type )
+    {
+    #if RFAL_FEATURE_NFCA
+        /*******************************************************************************/
+        case RFAL_NFC_LISTEN_TYPE_NFCA:
         {
-            err = rfalNfcpCbPollerTechnologyDetection();                              /* Poll for devices */
-            if( err == RFAL_ERR_NONE )
+            rfalNfcaSensRes sensRes;
+            
+            /* Wake up (HALT included) and select the cached NFCID1 directly, no anticollision */
+            RFAL_EXIT_ON_ERR( err, rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes ) );
+            RFAL_EXIT_ON_ERR( err, rfalNfcaPollerSelect( dev->dev.nfca.nfcId1, dev->dev.nfca.nfcId1Len, &dev->dev.nfca.selRes ) );
+            
+            /* Ensure the device still announces the same protocol */
+            if( dev->dev.nfca.selRes.sak != gNfcDev.lastDev.dev.nfca.selRes.sak )
             {
-                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_PROP;
+                return RFAL_ERR_NOTFOUND;
             }
             
-            gNfcDev.isTechInit = false;
-            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_PROP;
+            dev->dev.nfca.isSleep = false;
+            gNfcDev.techsFound    = RFAL_NFC_POLL_TECH_A;
+            break;
         }
+    #endif /* RFAL_FEATURE_NFCA */
         
-        return RFAL_ERR_BUSY;
+    #if RFAL_FEATURE_NFCF
+        /*******************************************************************************/
+        case RFAL_NFC_LISTEN_TYPE_NFCF:
+        {
+            rfalFeliCaPollRes  pollRes[1];
+            uint8_t            devCnt;
+            uint8_t            colCnt;
+            uint8_t            resLen;
+            
+            devCnt = 0;
+            colCnt = 0;
+            
+            /* Single slot SENSF_REQ for the cached System Code, also requesting it for the next reacquire */
+            RFAL_EXIT_ON_ERR( err, rfalNfcfPollerPoll( RFAL_FELICA_1_SLOT, gNfcDev.lastSysCode, (uint8_t)RFAL_FELICA_POLL_RC_SYSTEM_CODE, pollRes, &devCnt, &colCnt ) );
+            
+            resLen = pollRes[0][0];
+            if( (devCnt == 0U) || ((resLen - RFAL_NFCF_HEADER_LEN) < RFAL_NFCF_SENSF_RES_LEN_MIN) || ((resLen - RFAL_NFCF_HEADER_LEN) > RFAL_NFCF_SENSF_RES_LEN_MAX) )
+            {
+                return RFAL_ERR_NOTFOUND;
+            }
+            
+            if( RFAL_BYTECMP( &pollRes[0][RFAL_NFCF_HEADER_LEN], gNfcDev.lastDev.dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN ) != 0 )
+            {
+                return RFAL_ERR_NOTFOUND;
+            }
+            
+            dev->dev.nfcf.sensfResLen = (resLen - RFAL_NFCF_LENGTH_LEN);
+            RFAL_MEMCPY( &dev->dev.nfcf.sensfRes, &pollRes[0][RFAL_NFCF_LENGTH_LEN], dev->dev.nfcf.sensfResLen );
+            
+            /* Request Data holds the System Code when supplied */
+            if( dev->dev.nfcf.sensfResLen > RFAL_NFCF_SENSF_RES_LEN_MAX )
+            {
+                gNfcDev.lastSysCode = RFAL_GETU16( dev->dev.nfcf.sensfRes.RD );
+            }
+            
+            gNfcDev.techsFound = RFAL_NFC_POLL_TECH_F;
+            break;
+        }
+    #endif /* RFAL_FEATURE_NFCF */
+    
+    #if RFAL_FEATURE_NFCV
+        /*******************************************************************************/
+        case RFAL_NFC_LISTEN_TYPE_NFCV:
+        {
+            uint16_t rcvLen;
+            
+            /* Single slot INVENTORY masked with the full cached UID: only that VICC answers */
+            RFAL_EXIT_ON_ERR( err, rfalNfcvPollerInventory( RFAL_NFCV_NUM_SLOTS_1, (uint8_t)rfalConvBytesToBits(RFAL_NFCV_UID_LEN), gNfcDev.lastDev.dev.nfcv.InvRes.UID, &dev->dev.nfcv.InvRes, &rcvLen ) );
+            
+            if( RFAL_BYTECMP( dev->dev.nfcv.InvRes.UID, gNfcDev.lastDev.dev.nfcv.InvRes.UID, RFAL_NFCV_UID_LEN ) != 0 )
+            {
+                return RFAL_ERR_NOTFOUND;
+            }
+            
+            dev->dev.nfcv.isSleep = false;
+            gNfcDev.techsFound    = RFAL_NFC_POLL_TECH_V;
+            break;
+        }
+    #endif /* RFAL_FEATURE_NFCV */
+    
+        /*******************************************************************************/
+        default:
+            return RFAL_ERR_NOTSUPP;
     }
     
+    gNfcDev.devCnt = 1U;
     return RFAL_ERR_NONE;
 }
 
+
 /*!
  ******************************************************************************
  * \brief Poller Collision Resolution
@@ -353,6 +353,12 @@ typedef struct{
   uint16_t                PDUTxPos;          /*!< PDU Tx position                               */
   uint16_t                PDURxPos;          /*!< PDU Rx position                               */
   bool                    isPDURxChaining;   /*!< PDU Transceive chaining flag                  */
+  bool                    isPDURxInPlace;    /*!< PDU blocks being received on the PDU buffer   */
+  bool                    isPDURxSaved;      /*!< PDURxSave holds data to be restored           */
+  uint8_t                 PDURxSave[RFAL_NFCDEP_DEPREQ_HEADER_LEN]; /*!< PDU data overwritten by the next block header */
+  uint32_t                PDUStart;          /*!< PDU Transceive start tick                     */
+  
+  rfalNfcDepStats         stats;             /*!< Session statistics                            */
 }rfalNfcDep;
 
 
@@ -362,7 +368,8 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalNfcDep gNfcip;                    /*!< NFCIP module instance                         */
+static rfalNfcDep gNfcipInst[RFAL_FEATURE_INSTANCES];  /*!< NFCIP module instances                        */
+#define gNfcip  gNfcipInst[rfalInstance()]              /*!< Current NFCIP module instance                 */
 
 
 /*
@@ -374,6 +381,7 @@ static rfalNfcDep gNfcip;                    /*!< NFCIP module instance
 static ReturnCode nfcipTxRx( rfalNfcDepCmd cmd, uint8_t* txBuf, uint32_t fwt, uint8_t* paylBuf, uint8_t paylBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t *rxActLen );
 static ReturnCode nfcipTx( rfalNfcDepCmd cmd, uint8_t* txBuf, uint8_t *paylBuf, uint16_t paylLen, uint8_t pfbData, uint32_t fwt );
 static ReturnCode nfcipDEPControlMsg( uint8_t pfb, uint8_t RTOX  );
+static ReturnCode nfcipPduRxBlock( uint16_t blockLen, bool isChaining );
 static ReturnCode nfcipInitiatorHandleDEP( ReturnCode rxRes, uint16_t rxLen, uint16_t *outActRxLen, bool *outIsChaining );
 static ReturnCode nfcipTargetHandleRX( ReturnCode rxRes, uint16_t *outActRxLen, bool *outIsChaining );
 static ReturnCode nfcipTargetHandleActivation( rfalNfcDepDevice *nfcDepDev, uint8_t *outBRS );
@@ -563,8 +571,27 @@ static ReturnCode nfcipDEPControlMsg( uint8_t pfb, uint8_t RTOX  )
     const rfalNfcDepCmd depCmd = ((gNfcip.cfg.role == RFAL_NFCDEP_ROLE_TARGET) ? NFCIP_CMD_DEP_RES : NFCIP_CMD_DEP_REQ);
     fwt    = ((gNfcip.cfg.role == RFAL_NFCDEP_ROLE_TARGET) ? NFCIP_NO_FWT : (nfcip_PFBisSTO( pfb ) ? ( (RTOX*gNfcip.cfg.fwt) + gNfcip.cfg.dFwt) : (gNfcip.cfg.fwt + gNfcip.cfg.dFwt) ) );
     
+    if( nfcip_PFBisRACK( pfb ) )
+    {
+        gNfcip.stats.ackTxCnt++;
+    }
+    else if( nfcip_PFBisRNACK( pfb ) )
+    {
+        gNfcip.stats.nackTxCnt++;
+    }
+    else if( nfcip_PFBisSATN( pfb ) )
+    {
+        gNfcip.stats.atnCnt++;
+    }
+    else
+    {
+        /* MISRA 15.7 - Empty else */
+    }
+    
     if( nfcip_PFBisSTO( pfb ) )
     {
+        gNfcip.stats.rtoxCnt++;
+        
         ctrlMsg[RFAL_NFCDEP_DEPREQ_HEADER_LEN] = RTOX;
         return nfcipTx( depCmd, ctrlMsg, &ctrlMsg[RFAL_NFCDEP_DEPREQ_HEADER_LEN], sizeof(uint8_t), pfb, fwt );
     }
@@ -574,6 +601,45 @@ static ReturnCode nfcipDEPControlMsg( uint8_t pfb, uint8_t RTOX  )
     }
 }
 
+/*******************************************************************************/
+static ReturnCode nfcipPduRxBlock( uint16_t blockLen, bool isChaining )
+{
+    uint16_t pos;
+    
+    /* Block level Transceives keep their own rxBuf */
+    if( !gNfcip.isPDURxInPlace )
+    {
+        return RFAL_ERR_NONE;
+    }
+    
+    /* This block header was received over the tail of the previous block, restore it */
+    if( gNfcip.isPDURxSaved )
+    {
+        RFAL_MEMCPY( gNfcip.rxBuf, gNfcip.PDURxSave, RFAL_NFCDEP_DEPREQ_HEADER_LEN );
+        gNfcip.isPDURxSaved = false;
+    }
+    
+    if( !isChaining )
+    {
+        return RFAL_ERR_NONE;
+    }
+    
+    /* Receive the next block right after this one, before the ACK restarts the reception */
+    pos = (gNfcip.PDURxPos + blockLen);
+    if( pos >= (uint16_t)RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN )
+    {
+        return RFAL_ERR_NOMEM;
+    }
+    
+    gNfcip.rxBuf    = &((uint8_t*)gNfcip.PDUParam.rxBuf)[pos];     /* PRQA S 0310 # MISRA 11.3 - Intentional safe cast, prologue is followed by the pdu */
+    gNfcip.rxBufLen = (uint16_t)RFAL_MIN( sizeof(rfalNfcDepBufFormat), (sizeof(rfalNfcDepPduBufFormat) - pos) );
+    
+    RFAL_MEMCPY( gNfcip.PDURxSave, gNfcip.rxBuf, RFAL_NFCDEP_DEPREQ_HEADER_LEN );
+    gNfcip.isPDURxSaved = true;
+    
+    return RFAL_ERR_NONE;
+}
+
 /*******************************************************************************/
 static void nfcipClearCounters( void )
 {
@@ -791,6 +857,7 @@ static ReturnCode nfcipInitiatorHandleDEP( ReturnCode rxRes, uint16_t rxLen, uin
         if( nfcip_PFBisRACK( rxPFB ) )
         {
             nfcipLogI( " NFCIP(I) Rcvd ACK  \r\n" );
+            gNfcip.stats.ackRxCnt++;
             if( gNfcip.pni == nfcip_PBF_PNI( rxPFB ) )
             {
                 /* 14.12.3.3 R-ACK with correct PNI -> Increment */
@@ -937,6 +1004,9 @@ static ReturnCode nfcipInitiatorHandleDEP( ReturnCode rxRes, uint16_t rxLen, uin
         {
             RFAL_MEMMOVE( &gNfcip.rxBuf[gNfcip.rxBufPaylPos], &gNfcip.rxBuf[RFAL_NFCDEP_DEP_HEADER + optHdrLen], *outActRxLen );
         }
+        
+        gNfcip.stats.iRxCnt++;
+        RFAL_EXIT_ON_ERR( ret, nfcipPduRxBlock( *outActRxLen, nfcip_PFBisIMI( rxPFB ) ) );
 
         /*******************************************************************************/
         /* Check if target is indicating chaining MI                                   */
@@ -1167,6 +1237,7 @@ static ReturnCode nfcipTargetHandleRX( ReturnCode rxRes, uint16_t *outActRxLen,
         if( nfcip_PFBisRACK( rxPFB ) )
         {
             nfcipLogI( " NFCIP(T) Rcvd ACK  \r\n" );
+            gNfcip.stats.ackRxCnt++;
             if( gNfcip.pni == nfcip_PBF_PNI( rxPFB ) )
             {
                 /* R-ACK while not performing chaining -> Protocol error */
@@ -1207,6 +1278,7 @@ static ReturnCode nfcipTargetHandleRX( ReturnCode rxRes, uint16_t *outActRxLen,
         else if( nfcip_PFBisRNACK( rxPFB ) && (nfcip_PNIDec(gNfcip.pni) == nfcip_PBF_PNI( rxPFB ) ) )
         {
             nfcipLogI( " NFCIP(T) Rcvd NACK  \r\n" );
+            gNfcip.stats.nackRxCnt++;
             
             gNfcip.pni = nfcip_PNIDec( gNfcip.pni );   /* Dec so that has the prev PNI */
             
@@ -1337,6 +1409,9 @@ static ReturnCode nfcipTargetHandleRX( ReturnCode rxRes, uint16_t *outActRxLen,
             RFAL_MEMMOVE( &gNfcip.rxBuf[gNfcip.rxBufPaylPos], &gNfcip.rxBuf[RFAL_NFCDEP_DEP_HEADER + optHdrLen], *outActRxLen );
         }
         
+        gNfcip.stats.iRxCnt++;
+        RFAL_EXIT_ON_ERR( ret, nfcipPduRxBlock( *outActRxLen, nfcip_PFBisIMI( rxPFB ) ) );
+        
         
         /*******************************************************************************/
         /* Check if Initiator is indicating chaining MI                                */
@@ -1482,6 +1557,7 @@ static ReturnCode nfcipTx( rfalNfcDepCmd cmd, uint8_t* txBuf, uint8_t *paylBuf,
             if (gNfcip.cfg.did != RFAL_NFCDEP_DID_NO)                {   pfb |= NFCIP_PFB_DID_BIT;       }
             if (gNfcip.cfg.nad != RFAL_NFCDEP_NAD_NO)                {   pfb |= NFCIP_PFB_NAD_BIT;       }
             if ((gNfcip.isTxChaining) && (nfcip_PFBisIPDU(pfb)) )    {   pfb |= NFCIP_PFB_MI_BIT;        }
+            if (nfcip_PFBisIPDU(pfb))                                {   gNfcip.stats.iTxCnt++;          }
             
             /* Store PFB for future handling */
             gNfcip.lastPFB       = pfb;                                                  /* store PFB sent */
@@ -1749,6 +1825,10 @@ void rfalNfcDepInitialize( void )
     gNfcip.PDUParam.rxLen = NULL;
     gNfcip.PDUParam.rxBuf = NULL;
     gNfcip.PDUParam.txBuf = NULL;
+    gNfcip.isPDURxInPlace = false;
+    gNfcip.isPDURxSaved   = false;
+    
+    RFAL_MEMSET( &gNfcip.stats, 0x00, sizeof(rfalNfcDepStats) );
     
 
     nfcipClearCounters();
@@ -2551,6 +2631,8 @@ ReturnCode rfalNfcDepStartTransceive( const rfalNfcDepTxRxParam *param )
 {
     rfalNfcDepDEPParams nfcDepParams;
     
+    gNfcip.isPDURxInPlace     = false;
+    
     nfcDepParams.txBuf        = (uint8_t *)param->txBuf;
     nfcDepParams.txBufLen     = param->txBufLen;
     nfcDepParams.txChaining   = param->isTxChaining;
@@ -2597,7 +2679,6 @@ ReturnCode rfalNfcDepGetTransceiveStatus( void )
 {
     uint16_t maxInfLen;
     
-    RFAL_NO_WARNING(rxPos); /* Keep this param for future use */
 
     blockParam->DID    = pduParam.DID;
     blockParam->FSx    = pduParam.FSx;
@@ -2620,13 +2701,29 @@ ReturnCode rfalNfcDepGetTransceiveStatus( void )
         blockParam->txBufLen     = (pduParam.txBufLen - txPos);
     }
 
-    /* TxBuf is moved to the beginning for every Block */
-    blockParam->txBuf        = (rfalNfcDepBufFormat*)pduParam.txBuf;   /*  PRQA S 0310 # MISRA 11.3 - Intentional safe cast to avoiding large buffer duplication */
-    blockParam->rxBuf        = pduParam.tmpBuf;                        /* Simply using the pdu buffer is not possible because of current ACK handling */
+    /* Blocks are sent and received in place, their header placed over the preceding PDU bytes */
+    blockParam->txBuf        = (rfalNfcDepBufFormat*)&((uint8_t*)pduParam.txBuf)[txPos];   /*  PRQA S 0310 # MISRA 11.3 - Intentional safe cast to avoiding large buffer duplication */
+    blockParam->rxBuf        = (rfalNfcDepBufFormat*)&((uint8_t*)pduParam.rxBuf)[rxPos];   /*  PRQA S 0310 # MISRA 11.3 - Intentional safe cast to avoiding large buffer duplication */
     blockParam->isRxChaining = &gNfcip.isPDURxChaining;
     blockParam->rxLen        = pduParam.rxLen;
 }
  
+
+/*******************************************************************************/
+static ReturnCode rfalNfcDepStartPduBlock( const rfalNfcDepTxRxParam *param )
+{
+    ReturnCode ret;
+    
+    RFAL_EXIT_ON_ERR( ret, rfalNfcDepStartTransceive( param ) );
+    
+    /* Block is received on the PDU buffer, never beyond its end */
+    gNfcip.isPDURxInPlace = true;
+    gNfcip.isPDURxSaved   = false;
+    gNfcip.rxBufLen       = (uint16_t)RFAL_MIN( sizeof(rfalNfcDepBufFormat), (sizeof(rfalNfcDepPduBufFormat) - gNfcip.PDURxPos) );
+    
+    return RFAL_ERR_NONE;
+}
+
  
 /*******************************************************************************/
 ReturnCode rfalNfcDepStartPduTransceive( rfalNfcDepPduTxRxParam param )
@@ -2637,11 +2734,12 @@ ReturnCode rfalNfcDepStartPduTransceive( rfalNfcDepPduTxRxParam param )
     gNfcip.PDUParam = param;
     gNfcip.PDUTxPos = 0;
     gNfcip.PDURxPos = 0;
+    gNfcip.PDUStart = platformGetSysTick();
     
     /* Convert PDU TxRxParams to Block TxRxParams */
     rfalNfcDepPdu2BLockParam( gNfcip.PDUParam, &txRxParam, gNfcip.PDUTxPos, gNfcip.PDURxPos );
     
-    return rfalNfcDepStartTransceive( &txRxParam );
+    return rfalNfcDepStartPduBlock( &txRxParam );
 }
  
  
@@ -2663,16 +2761,10 @@ ReturnCode rfalNfcDepGetPduTransceiveStatus( void )
                 /* Add already Tx bytes */
                 gNfcip.PDUTxPos += gNfcip.txBufLen;
                 
-                /* Convert APDU TxRxParams to I-Block TxRxParams */
+                /* Convert APDU TxRxParams to I-Block TxRxParams, next Block is sent from its place on the PDU */
                 rfalNfcDepPdu2BLockParam( gNfcip.PDUParam, &txRxParam, gNfcip.PDUTxPos, gNfcip.PDURxPos );
                 
-                if( txRxParam.txBufLen > 0U )      /* MISRA 21.18 */
-                {
-                    /* Move next Block to beginning of APDU Tx buffer */
-                    RFAL_MEMCPY( gNfcip.PDUParam.txBuf->pdu, &gNfcip.PDUParam.txBuf->pdu[gNfcip.PDUTxPos], txRxParam.txBufLen );
-                }
-                
-                RFAL_EXIT_ON_ERR( ret, rfalNfcDepStartTransceive( &txRxParam ) );
+                RFAL_EXIT_ON_ERR( ret, rfalNfcDepStartPduBlock( &txRxParam ) );
                 return RFAL_ERR_BUSY;
             }
             
@@ -2697,24 +2789,36 @@ ReturnCode rfalNfcDepGetPduTransceiveStatus( void )
             }
             
             
-            if( (*gNfcip.PDUParam.rxLen) > 0U )    /* MISRA 21.18 */
+            /* Block has already been received in place, ensure it is within the PDU buffer */
+            if( (uint16_t)((uint16_t)gNfcip.PDURxPos + (*gNfcip.PDUParam.rxLen)) > RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN )
             {
-                /* Ensure that data in tmpBuf still fits into PDU buffer */
-                if( (uint16_t)((uint16_t)gNfcip.PDURxPos + (*gNfcip.PDUParam.rxLen)) > RFAL_FEATURE_NFC_DEP_PDU_MAX_LEN )
-                {
-                    return RFAL_ERR_NOMEM;
-                }
-                
-                /* Copy chained packet from tmp buffer to PDU buffer */
-                RFAL_MEMCPY( &gNfcip.PDUParam.rxBuf->pdu[gNfcip.PDURxPos], gNfcip.PDUParam.tmpBuf->inf, *gNfcip.PDUParam.rxLen );
-                gNfcip.PDURxPos += *gNfcip.PDUParam.rxLen;
+                return RFAL_ERR_NOMEM;
             }
+            gNfcip.PDURxPos += *gNfcip.PDUParam.rxLen;
             
             /* Update output param rxLen */
             *gNfcip.PDUParam.rxLen = gNfcip.PDURxPos;
             
-            /* Wait for following Block or PDU TxRx is done */
-            return ((ret == RFAL_ERR_AGAIN) ? RFAL_ERR_BUSY : RFAL_ERR_NONE);
+            /* Wait for following Block */
+            if( ret == RFAL_ERR_AGAIN )
+            {
+                return RFAL_ERR_BUSY;
+            }
+            
+            /* PDU TxRx is done, control PDUs until the next one are not to touch the PDU data */
+            gNfcip.isPDURxInPlace = false;
+            if( gNfcip.PDUParam.tmpBuf != NULL )
+            {
+                gNfcip.rxBuf    = (uint8_t*)gNfcip.PDUParam.tmpBuf;
+                gNfcip.rxBufLen = sizeof(rfalNfcDepBufFormat);
+            }
+            
+            gNfcip.stats.pduCnt++;
+            gNfcip.stats.txBytes  += gNfcip.PDUParam.txBufLen;
+            gNfcip.stats.rxBytes  += gNfcip.PDURxPos;
+            gNfcip.stats.xchgTime += (platformGetSysTick() - gNfcip.PDUStart);
+            
+            return RFAL_ERR_NONE;
         
         /*******************************************************************************/
         default:
@@ -2726,4 +2830,35 @@ ReturnCode rfalNfcDepGetPduTransceiveStatus( void )
  }
 
 
+/*******************************************************************************/
+uint8_t rfalNfcDepGetMaxLR( void )
+{
+    uint8_t lr;
+    
+    /* Step up while the next Frame Size fits the block buffers */
+    lr = RFAL_NFCDEP_LR_64;
+    while( (lr < RFAL_NFCDEP_LR_254) && (rfalNfcDepLR2FS( (lr + 1U) ) <= (uint16_t)RFAL_FEATURE_NFC_DEP_BLOCK_MAX_LEN) )
+    {
+        lr++;
+    }
+    
+    return lr;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalNfcDepGetStats( rfalNfcDepStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    *stats = gNfcip.stats;
+    stats->bytesPerSec = ( (stats->xchgTime > 0U) ? (uint32_t)( ((uint64_t)stats->txBytes + stats->rxBytes) * 1000U / stats->xchgTime ) : 0U );
+    
+    return RFAL_ERR_NONE;
+}
+
+
 #endif /* RFAL_FEATURE_NFC_DEP */
@@ -41,6 +41,7 @@
  ******************************************************************************
  */
 #include "rfal_nfca.h"
+#include "rfal_dpo.h"
 #include "rfal_utils.h"
 
 /*
@@ -82,6 +83,10 @@
 
 #define RFAL_NFCA_T_RETRANS         5U                    /*!< t RETRANSMISSION [3, 33]ms   EMVCo 2.6  A.5      */
 #define RFAL_NFCA_N_RETRANS         2U                    /*!< Number of retries            EMVCo 2.6  9.6.1.3  */
+
+#ifndef RFAL_FEATURE_NFCA_UID_CACHE_LEN
+    #define RFAL_FEATURE_NFCA_UID_CACHE_LEN   0U          /*!< UID prefix cache disabled by default             */
+#endif
  
 
 /*! SDD_REQ (Select) Cascade Levels  */
@@ -165,9 +170,23 @@ typedef struct{
     uint8_t               retries;          /*!< Retries to be performed upon a timeout error (Single CR)*/
     uint8_t               backtrackCnt;     /*!< Backtrack retries (Single CR)                           */
     bool                  doBacktrack;      /*!< Backtrack flag (Single CR)                              */
+    bool                  isSeeded;         /*!< SDD_REQ carries a cached UID (Single CR)                */
+    rfalNfcaSelReq        seedSelReq;       /*!< SDD_REQ before seeding, restored on a miss (Single CR)  */
+    uint8_t               seedBytes;        /*!< TxRx bytes before seeding (Single CR)                   */
+    uint8_t               seedBits;         /*!< TxRx bits before seeding (Single CR)                    */
+    uint8_t               seedIdx;          /*!< Cache entry used for seeding (Single CR)                */
+    bool                  isCollided;       /*!< Collision met on the current Cascade Level (Single CR)  */
 }rfalNfcaColResParams;
 
 
+/*! UID prefix cache entry */
+typedef struct{
+    uint8_t               cascadeLv;        /*!< Cascade Level of the entry                              */
+    uint8_t               nfcid1[RFAL_NFCA_CASCADE_1_UID_LEN]; /*!< NFCID1 CLn incl. Cascade Tag        */
+    bool                  isResolved;       /*!< Selected since the last ALL_REQ: active or asleep, not to be seeded */
+}rfalNfcaUidCacheEntry;
+
+
 /*! Colission Resolution context */
 typedef struct{
     
@@ -195,6 +214,12 @@ typedef struct{
     rfalNfcaSelParams     SEL;              /*!< Selection|Activation context                            */
     
     rfalNfcaSlpReq        slpReq;           /*!< SLP_REx buffer                                          */
+    
+    rfalNfcaColResStats   stats;            /*!< Collision Resolution statistics                         */
+#if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+    rfalNfcaUidCacheEntry uidCache[RFAL_FEATURE_NFCA_UID_CACHE_LEN]; /*!< UID prefix cache, most recent first */
+    uint8_t               uidCacheCnt;      /*!< Number of valid UID cache entries                       */
+#endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
 } rfalNfca;
 
 
@@ -203,7 +228,8 @@ typedef struct{
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static rfalNfca gNfca;  /*!< RFAL NFC-A instance  */
+static rfalNfca gNfcaInst[RFAL_FEATURE_INSTANCES];  /*!< RFAL NFC-A instances        */
+#define gNfca   gNfcaInst[rfalInstance()]           /*!< Current RFAL NFC-A instance  */
 
 /*
 ******************************************************************************
@@ -213,6 +239,12 @@ static rfalNfca gNfca;  /*!< RFAL NFC-A instance  */
 static uint8_t    rfalNfcaCalculateBcc( const uint8_t* buf, uint8_t bufLen );
 static ReturnCode rfalNfcaPollerStartSingleCollisionResolution( uint8_t devLimit, bool *collPending, rfalNfcaSelRes *selRes, uint8_t *nfcId1, uint8_t *nfcId1Len );
 static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void );
+#if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+static bool       rfalNfcaUidCacheSeed( void );
+static void       rfalNfcaUidCacheInsert( uint8_t cascadeLv, const uint8_t *nfcid1 );
+static void       rfalNfcaUidCacheRemove( uint8_t idx );
+static void       rfalNfcaUidCacheWake( void );
+#endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
 
 /*
  ******************************************************************************
@@ -236,6 +268,122 @@ static uint8_t rfalNfcaCalculateBcc( const uint8_t* buf, uint8_t bufLen )
     return BCC;
 }
 
+#if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+
+/*******************************************************************************/
+static bool rfalNfcaUidCacheSeed( void )
+{
+    uint8_t i;
+    uint8_t nBytes;
+    uint8_t mask;
+    
+    /* Bits received so far on this cascade level, before the collision position */
+    nBytes = (gNfca.CR.bytesTxRx - RFAL_NFCA_SDD_REQ_LEN);
+    mask   = (uint8_t)((1U << gNfca.CR.bitsTxRx) - 1U);
+    
+    for( i = 0; i < gNfca.uidCacheCnt; i++ )
+    {
+        if( (gNfca.uidCache[i].cascadeLv != gNfca.CR.cascadeLv) || gNfca.uidCache[i].isResolved )
+        {
+            continue;
+        }
+        
+        if( (nBytes > 0U) && (RFAL_BYTECMP( gNfca.uidCache[i].nfcid1, gNfca.CR.selReq.nfcid1, nBytes ) != 0) )
+        {
+            continue;
+        }
+        
+        if( (mask != 0U) && (((gNfca.uidCache[i].nfcid1[nBytes] ^ gNfca.CR.selReq.nfcid1[nBytes]) & mask) != 0U) )
+        {
+            continue;
+        }
+        
+        /* Known device shares the prefix: send its complete NFCID1 CLn, only that device answers with the BCC */
+        gNfca.CR.seedSelReq = gNfca.CR.selReq;
+        gNfca.CR.seedBytes  = gNfca.CR.bytesTxRx;
+        gNfca.CR.seedBits   = gNfca.CR.bitsTxRx;
+        gNfca.CR.seedIdx    = i;
+        gNfca.CR.isSeeded   = true;
+        
+        RFAL_MEMCPY( gNfca.CR.selReq.nfcid1, gNfca.uidCache[i].nfcid1, RFAL_NFCA_CASCADE_1_UID_LEN );
+        gNfca.CR.bytesTxRx = (RFAL_NFCA_SDD_REQ_LEN + RFAL_NFCA_CASCADE_1_UID_LEN);
+        gNfca.CR.bitsTxRx  = 0U;
+        
+        return true;
+    }
+    
+    return false;
+}
+
+
+/*******************************************************************************/
+static void rfalNfcaUidCacheInsert( uint8_t cascadeLv, const uint8_t *nfcid1 )
+{
+    uint8_t i;
+    
+    /* Look for an existing entry, otherwise drop the least recent one */
+    for( i = 0; i < gNfca.uidCacheCnt; i++ )
+    {
+        if( (gNfca.uidCache[i].cascadeLv == cascadeLv) && (RFAL_BYTECMP( gNfca.uidCache[i].nfcid1, nfcid1, RFAL_NFCA_CASCADE_1_UID_LEN ) == 0) )
+        {
+            break;
+        }
+    }
+    
+    if( i == gNfca.uidCacheCnt )
+    {
+        if( gNfca.uidCacheCnt < RFAL_FEATURE_NFCA_UID_CACHE_LEN )
+        {
+            gNfca.uidCacheCnt++;
+        }
+        i = (gNfca.uidCacheCnt - 1U);
+    }
+    
+    /* Move it to the front */
+    for( ; i > 0U; i-- )
+    {
+        gNfca.uidCache[i] = gNfca.uidCache[i - 1U];
+    }
+    
+    gNfca.uidCache[0].cascadeLv  = cascadeLv;
+    gNfca.uidCache[0].isResolved = true;
+    RFAL_MEMCPY( gNfca.uidCache[0].nfcid1, nfcid1, RFAL_NFCA_CASCADE_1_UID_LEN );
+}
+
+
+/*******************************************************************************/
+static void rfalNfcaUidCacheRemove( uint8_t idx )
+{
+    uint8_t i;
+    
+    if( idx >= gNfca.uidCacheCnt )
+    {
+        return;
+    }
+    
+    for( i = idx; i < (gNfca.uidCacheCnt - 1U); i++ )
+    {
+        gNfca.uidCache[i] = gNfca.uidCache[i + 1U];
+    }
+    gNfca.uidCacheCnt--;
+}
+
+
+/*******************************************************************************/
+static void rfalNfcaUidCacheWake( void )
+{
+    uint8_t i;
+    
+    /* ALL_REQ sent: devices asleep take part in the anticollision again */
+    for( i = 0; i < gNfca.uidCacheCnt; i++ )
+    {
+        gNfca.uidCache[i].isResolved = false;
+    }
+}
+
+#endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
+
+
 /*******************************************************************************/
 static ReturnCode rfalNfcaPollerStartSingleCollisionResolution( uint8_t devLimit, bool *collPending, rfalNfcaSelRes *selRes, uint8_t *nfcId1, uint8_t *nfcId1Len )
 {
@@ -266,6 +414,7 @@ static ReturnCode rfalNfcaPollerStartSingleCollisionResolution( uint8_t devLimit
    
     gNfca.CR.doBacktrack  = false;
     gNfca.CR.backtrackCnt = 3U;
+    gNfca.CR.isSeeded     = false;
     
     return RFAL_ERR_NONE;
 }
@@ -302,9 +451,10 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
             /* Initialize the SDD_REQ to send for the new cascade level */
             RFAL_MEMSET( (uint8_t*)&gNfca.CR.selReq, 0x00, sizeof(rfalNfcaSelReq) );
         
-            gNfca.CR.bytesTxRx = RFAL_NFCA_SDD_REQ_LEN;
-            gNfca.CR.bitsTxRx  = 0U;
-            gNfca.CR.state     = RFAL_NFCA_CR_SDD_TX;
+            gNfca.CR.bytesTxRx  = RFAL_NFCA_SDD_REQ_LEN;
+            gNfca.CR.bitsTxRx   = 0U;
+            gNfca.CR.isCollided = false;
+            gNfca.CR.state      = RFAL_NFCA_CR_SDD_TX;
         
             /* fall through */
         
@@ -317,6 +467,7 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
         
             /* Send SDD_REQ (Anticollision frame) */
             rfalISO14443AStartTransceiveAnticollisionFrame( (uint8_t*)&gNfca.CR.selReq, &gNfca.CR.bytesTxRx, &gNfca.CR.bitsTxRx, &gNfca.CR.rxLen, RFAL_NFCA_FDTMIN );
+            gNfca.stats.sddReqCnt++;
         
             gNfca.CR.state = RFAL_NFCA_CR_SDD;
             break;
@@ -341,6 +492,34 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
             /* Covert rxLen into bytes */
             gNfca.CR.rxLen = rfalConvBitsToBytes( gNfca.CR.rxLen );
             
+            /* Check the outcome of a SDD_REQ seeded from the UID cache */
+            if( gNfca.CR.isSeeded )
+            {
+                gNfca.CR.isSeeded = false;
+                
+                if( ret == RFAL_ERR_TIMEOUT )
+                {
+                    /* Cached device not present: forget it and resume from the collision position */
+                    gNfca.CR.selReq    = gNfca.CR.seedSelReq;
+                    gNfca.CR.bytesTxRx = gNfca.CR.seedBytes;
+                    gNfca.CR.bitsTxRx  = gNfca.CR.seedBits;
+                    gNfca.stats.seedMissCnt++;
+                #if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+                    rfalNfcaUidCacheRemove( gNfca.CR.seedIdx );
+                #endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
+                    
+                    ret = RFAL_ERR_RF_COLLISION;                         /* Collision bit is selected as usual below */
+                }
+                else if( ret == RFAL_ERR_NONE )
+                {
+                    gNfca.stats.seedHitCnt++;
+                }
+                else
+                {
+                    /* MISRA 15.7 - Empty else */
+                }
+            }
+            
             
             if( (ret == RFAL_ERR_TIMEOUT) && (gNfca.CR.backtrackCnt != 0U) && (!gNfca.CR.doBacktrack)
                 && (!((RFAL_NFCA_SDD_REQ_LEN == gNfca.CR.bytesTxRx) && (0U == gNfca.CR.bitsTxRx)))     )
@@ -397,7 +576,17 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
                     return RFAL_ERR_IGNORE;
                 }
                 
-                *gNfca.CR.collPend = true;
+                *gNfca.CR.collPend  = true;
+                gNfca.CR.isCollided = true;
+                
+            #if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+                /* Try a recently seen device sharing the bits received so far */
+                if( (!gNfca.CR.doBacktrack) && rfalNfcaUidCacheSeed() )
+                {
+                    gNfca.CR.state = RFAL_NFCA_CR_SDD_TX;
+                    break;
+                }
+            #endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
                 
                 /* Set and select the collision bit, with the number of bytes/bits successfully TxRx */
                 if (collBit != 0U)
@@ -455,6 +644,7 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
             
             /* Send SEL_REQ (Select command) - Retry upon timeout  EMVCo 2.6  9.6.1.3 */            
             rfalTransceiveBlockingTx( (uint8_t*)&gNfca.CR.selReq, sizeof(rfalNfcaSelReq), (uint8_t*)gNfca.CR.selRes, sizeof(rfalNfcaSelRes), &gNfca.CR.rxLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_NFCA_FDTMIN );        
+            gNfca.stats.selReqCnt++;
             gNfca.CR.state   = RFAL_NFCA_CR_SEL;
             break;
         
@@ -487,6 +677,14 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
                 return RFAL_ERR_PROTO;
             }
             
+        #if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+            /* Keep this cascade level to seed future anticollisions, if it had to be told apart from others */
+            if( gNfca.CR.isCollided )
+            {
+                rfalNfcaUidCacheInsert( gNfca.CR.cascadeLv, gNfca.CR.selReq.nfcid1 );
+            }
+        #endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
+            
             /*******************************************************************************/
             /* Check cascade byte, if cascade tag then go next cascade level */
             if( *gNfca.CR.selReq.nfcid1 == RFAL_NFCA_SDD_CT )
@@ -504,6 +702,7 @@ static ReturnCode rfalNfcaPollerGetSingleCollisionResolutionStatus( void )
                 /* UID Selection complete, Stop Cascade Level loop */
                 RFAL_MEMCPY( &gNfca.CR.nfcId1[*gNfca.CR.nfcId1Len], (uint8_t*)&gNfca.CR.selReq.nfcid1, RFAL_NFCA_CASCADE_1_UID_LEN );
                 *gNfca.CR.nfcId1Len += RFAL_NFCA_CASCADE_1_UID_LEN;
+                gNfca.stats.devCnt++;
                 
                 gNfca.CR.state = RFAL_NFCA_CR_DONE;
                 break;                             /* Only flag operation complete on the next execution */
@@ -553,6 +752,14 @@ ReturnCode rfalNfcaPollerCheckPresence( rfal14443AShortFrameCmd cmd, rfalNfcaSen
      *              MUST treat receipt of a Listen Frame at a time after FDT(Listen, min) as a Timeour Error */
     
     ret = rfalISO14443ATransceiveShortFrame(  cmd, (uint8_t*)sensRes, (uint8_t)rfalConvBytesToBits(sizeof(rfalNfcaSensRes)), &rcvLen, RFAL_NFCA_FDTMIN  );
+    
+#if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+    if( cmd == RFAL_14443A_SHORTFRAME_CMD_WUPA )
+    {
+        rfalNfcaUidCacheWake();
+    }
+#endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
+    
     if( (ret == RFAL_ERR_RF_COLLISION) || (ret == RFAL_ERR_CRC)  || (ret == RFAL_ERR_NOMEM) || (ret == RFAL_ERR_FRAMING) || (ret == RFAL_ERR_PAR) || (ret == RFAL_ERR_INCOMPLETE_BYTE) )
     {
        ret = RFAL_ERR_NONE;
@@ -639,6 +846,9 @@ ReturnCode rfalNfcaPollerStartFullCollisionResolution( rfalComplianceMode compMo
     if( compMode != RFAL_COMPLIANCE_MODE_ISO )
     {
         ret = rfalISO14443ATransceiveShortFrame( RFAL_14443A_SHORTFRAME_CMD_WUPA, (uint8_t*)&nfcaDevList->sensRes, (uint8_t)rfalConvBytesToBits(sizeof(rfalNfcaSensRes)), &rcvLen, RFAL_NFCA_FDTMIN  );
+    #if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+        rfalNfcaUidCacheWake();
+    #endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
         if(ret != RFAL_ERR_NONE)
         {
             if( (compMode == RFAL_COMPLIANCE_MODE_EMV) || ((ret != RFAL_ERR_RF_COLLISION) && (ret != RFAL_ERR_CRC) && (ret != RFAL_ERR_FRAMING) && (ret != RFAL_ERR_PAR) && (ret != RFAL_ERR_INCOMPLETE_BYTE)) )
@@ -867,6 +1077,89 @@ ReturnCode rfalNfcaPollerSleepFullCollisionResolution( uint8_t devLimit, rfalNfc
 }
 
 
+/*******************************************************************************/
+ReturnCode rfalNfcaPollerStreamCollisionResolution( rfalComplianceMode compMode, rfalNfcaDevFoundCb devFoundCb, uint16_t *devCnt )
+{
+    bool                 firstRound;
+    uint8_t              tmpDevCnt;
+    rfalNfcaListenDevice nfcaDev;
+    ReturnCode           ret;
+    
+    
+    if( (devFoundCb == NULL) || (devCnt == NULL) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /* Only use the given compliance mode (ALL_REQ) on the first round */
+    firstRound = true;
+    *devCnt    = 0;
+    RFAL_MEMSET( &nfcaDev, 0x00, sizeof(rfalNfcaListenDevice) );
+    
+    
+    /* Resolve one device at a time until no new device is found */
+    do
+    {
+        tmpDevCnt = 0;
+        ret = rfalNfcaPollerFullCollisionResolution( (firstRound ? compMode : RFAL_COMPLIANCE_MODE_ISO), 1U, &nfcaDev, &tmpDevCnt );
+        
+        if( (ret != RFAL_ERR_NONE) || (tmpDevCnt == 0U) )
+        {
+            break;
+        }
+        
+        (*devCnt)++;
+        
+        /* T1T doesn't support Anticollision, nothing else can be resolved */
+        if( nfcaDev.type == RFAL_NFCA_T1T )
+        {
+            (void)devFoundCb( &nfcaDev );
+            break;
+        }
+        
+        /* Set device to sleep so that it doesn't take part on the next round */
+        rfalNfcaPollerSleep();
+        nfcaDev.isSleep = true;
+        
+        if( !devFoundCb( &nfcaDev ) )
+        {
+            break;
+        }
+        
+        /* Check if any other device is present */
+        ret = rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_REQA, &nfcaDev.sensRes );
+        firstRound = false;
+    }
+    while( ret == RFAL_ERR_NONE );
+    
+    return ((*devCnt > 0U) ? RFAL_ERR_NONE : ret);
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalNfcaPollerGetColResStats( rfalNfcaColResStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    *stats = gNfca.stats;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalNfcaPollerClearUidCache( void )
+{
+#if RFAL_FEATURE_NFCA_UID_CACHE_LEN > 0U
+    gNfca.uidCacheCnt = 0;
+#endif /* RFAL_FEATURE_NFCA_UID_CACHE_LEN */
+    
+    RFAL_MEMSET( &gNfca.stats, 0x00, sizeof(rfalNfcaColResStats) );
+}
+
+
 /*******************************************************************************/
 ReturnCode rfalNfcaPollerSelect( const uint8_t *nfcid1, uint8_t nfcidLen, rfalNfcaSelRes *selRes )
 {
@@ -985,12 +1278,28 @@ ReturnCode rfalNfcaPollerSleep( void )
 ReturnCode rfalNfcaPollerStartSleep( void )
 {
     rfalTransceiveContext ctx;
+#if RFAL_FEATURE_DPO
+    ReturnCode            ret;
+#endif /* RFAL_FEATURE_DPO */
     
     gNfca.slpReq.frame[RFAL_NFCA_SLP_CMD_POS]   = RFAL_NFCA_SLP_CMD;
     gNfca.slpReq.frame[RFAL_NFCA_SLP_BYTE2_POS] = RFAL_NFCA_SLP_BYTE2;
     
     rfalCreateByteFlagsTxRxContext( ctx, (uint8_t*)&gNfca.slpReq, sizeof(rfalNfcaSlpReq), (uint8_t*)&gNfca.slpReq, sizeof(gNfca.slpReq), NULL, RFAL_TXRX_FLAGS_DEFAULT, RFAL_NFCA_SLP_FWT );
+    
+#if RFAL_FEATURE_DPO
+    /* SLP_REQ is never answered: its timeout is no link error */
+    rfalDpoPauseLinkMonitor( true );
+    
+    ret = rfalStartTransceive( &ctx );
+    if( ret != RFAL_ERR_NONE )
+    {
+        rfalDpoPauseLinkMonitor( false );
+    }
+    return ret;
+#else
     return rfalStartTransceive( &ctx );
+#endif /* RFAL_FEATURE_DPO */
 }
 
 
@@ -1005,6 +1314,10 @@ ReturnCode rfalNfcaPollerGetSleepStatus( void )
     */
     RFAL_EXIT_ON_BUSY( ret, rfalGetTransceiveStatus() );
     
+#if RFAL_FEATURE_DPO
+    rfalDpoPauseLinkMonitor( false );
+#endif /* RFAL_FEATURE_DPO */
+    
     return RFAL_ERR_NONE;
 }
 
@@ -180,7 +180,8 @@ static ReturnCode rfalNfcbPollerSleepTx( const uint8_t* nfcid0 );
 ******************************************************************************
 */
 
-static rfalNfcb gRfalNfcb; /*!< RFAL NFC-B Instance */
+static rfalNfcb gRfalNfcbInst[RFAL_FEATURE_INSTANCES]; /*!< RFAL NFC-B Instances        */
+#define gRfalNfcb  gRfalNfcbInst[rfalInstance()]        /*!< Current RFAL NFC-B Instance */
 
 
 /*
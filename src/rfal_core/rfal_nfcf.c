@@ -65,7 +65,6 @@
 #define RFAL_NFCF_CHECK_RES_MIN_LEN                11U    /*!< CHECK Response minimum length       T3T 1.0  Table 8  */
 #define RFAL_NFCF_UPDATE_RES_MIN_LEN               11U    /*!< UPDATE Response minimum length      T3T 1.0  Table 8  */
 
-#define RFAL_NFCF_CHECK_REQ_MAX_LEN                86U    /*!< Max length of a Check request        T3T 1.0  Table 7 */
 #define RFAL_NFCF_CHECK_REQ_MAX_SERV               15U    /*!< Max Services number on Check request T3T 1.0  5.4.1.5 */
 #define RFAL_NFCF_CHECK_REQ_MAX_BLOCK              15U    /*!< Max Blocks number on Check request  T3T 1.0  5.4.1.10 */
 #define RFAL_NFCF_UPDATE_REQ_MAX_SERV              15U    /*!< Max Services number Update request  T3T 1.0  5.4.1.5  */
@@ -77,6 +76,9 @@
 */
 #define RFAL_NFCF_MRT_CHECK_UPDATE   ((4096U * (8U + (15U * 8U)) * 64U ) + 16U)
 
+#define RFAL_NFCF_POLL_RES_TIME_US                 2417U  /*!< Time until the first Time Slot  512*64/fc  Digital 1.1  8.7.1 */
+#define RFAL_NFCF_POLL_SLOT_TIME_US                1208U  /*!< Time Slot duration             256*64/fc  Digital 1.1  8.7.1 */
+
 /*
  ******************************************************************************
  * GLOBAL MACROS
@@ -134,14 +136,25 @@ typedef struct{
     uint8_t*              devCnt;          /*!< Location of the device counter                          */
     bool                  collPending;     /*!< Collision pending flag                                  */
     bool                  nfcDepFound;
+    uint32_t              pollTimeLeft;    /*!< Poll time left to the SENSF_REQs of this CR [us]       */
     rfalNfcFColResState   state;            /*!< Single Collision Resolution state (Single CR)           */
 }rfalNfcfColResParams;
 
 
+/*! Adaptive Time Slots context */
+typedef struct{
+    bool                  enabled;         /*!< Adaptive Time Slots enabled flag                        */
+    uint16_t              maxPollTime;     /*!< Poll time cap of a Collision Resolution [us]            */
+    uint8_t               maxSlots;        /*!< Max number of Time Slots given the poll time cap        */
+    rfalNfcfPollStats     stats;           /*!< Polling statistics, incl. the slots for next SENSF_REQ  */
+}rfalNfcfAdaptSlotsParams;
+
+
 /*! RFAL NFC-F instance */
 typedef struct
 {
-    rfalNfcfColResParams CR;                 /*!< Collision Resolution */
+    rfalNfcfColResParams     CR;             /*!< Collision Resolution */
+    rfalNfcfAdaptSlotsParams AS;             /*!< Adaptive Time Slots  */
 } rfalNfcf;
 
 
@@ -150,7 +163,8 @@ typedef struct
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static rfalNfcf gNfcf;  /*!< RFAL NFC-F instance  */
+static rfalNfcf gNfcfInst[RFAL_FEATURE_INSTANCES];  /*!< RFAL NFC-F instances        */
+#define gNfcf   gNfcfInst[rfalInstance()]           /*!< Current RFAL NFC-F instance  */
 
 
 /*
@@ -159,6 +173,8 @@ static rfalNfcf gNfcf;  /*!< RFAL NFC-F instance  */
 ******************************************************************************
 */
 static void rfalNfcfComputeValidSENF( rfalNfcfListenDevice *outDevInfo, uint8_t *curDevIdx, uint8_t devLimit, bool overwrite, bool *nfcDepFound );
+static void rfalNfcfAdaptSlots( uint8_t found, uint8_t collisions );
+static uint16_t rfalNfcfComposeServBlockList( const uint8_t* nfcid2, uint8_t cmd, const rfalNfcfServBlockListParam *servBlock, uint8_t *txBuf );
 
 
 /*
@@ -242,6 +258,41 @@ static void rfalNfcfComputeValidSENF( rfalNfcfListenDevice *outDevInfo, uint8_t
     }
 }
 
+/*******************************************************************************/
+static void rfalNfcfAdaptSlots( uint8_t found, uint8_t collisions )
+{
+    uint8_t curSlots;
+    uint8_t newSlots;
+    
+    curSlots = rfalNfcfSlots2CardNum( gNfcf.AS.stats.slots );
+    
+    if( collisions > 0U )
+    {
+        /* The population is unknown: open the most slots at once rather than doubling over several SENSF_REQ */
+        newSlots = gNfcf.AS.maxSlots;
+    }
+    else
+    {
+        /* Every device answered alone: keep about two slots per device, one for a single card */
+        newSlots = 1U;
+        while( (((uint32_t)newSlots + 1U) < (2U * (uint32_t)found)) && (newSlots < gNfcf.AS.maxSlots) )
+        {
+            newSlots <<= 1U;
+        }
+        
+        if( newSlots < curSlots )
+        {
+            newSlots = (uint8_t)(curSlots >> 1U);           /* Shrink one step per SENSF_REQ              */
+        }
+    }
+    
+    newSlots = RFAL_MIN( newSlots, gNfcf.AS.maxSlots );
+    
+    /* PRQA S 4342 1 # MISRA 10.5 - Power of two up to 16 is always a valid TSN */
+    gNfcf.AS.stats.slots = (rfalFeliCaPollSlots)(newSlots - 1U);
+}
+
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
@@ -326,6 +377,12 @@ ReturnCode rfalNfcfPollerStartCollisionResolution( rfalComplianceMode compMode,
             
     *devCnt      = 0;
     
+    if( (gNfcf.AS.enabled) && ((gNfcf.CR.greedyF.pollFound > 0U) || (gNfcf.CR.greedyF.pollCollision > 0U)) )
+    {
+        /* Size the first SENSF_REQ from the Technology Detection poll */
+        rfalNfcfAdaptSlots( gNfcf.CR.greedyF.pollFound, gNfcf.CR.greedyF.pollCollision );
+    }
+    
     /*******************************************************************************************/
     /* ACTIVITY 1.0 - 9.3.6.3 Copy valid SENSF_RES in GRE_POLL_F into GRE_SENSF_RES            */
     /* ACTIVITY 1.0 - 9.3.6.6 The NFC Forum Device MUST remove all entries from GRE_SENSF_RES[]*/
@@ -343,13 +400,17 @@ ReturnCode rfalNfcfPollerStartCollisionResolution( rfalComplianceMode compMode,
     gNfcf.CR.devCnt      = devCnt;
     gNfcf.CR.state       = RFAL_NFCF_CR_POLL;
     
+    gNfcf.CR.pollTimeLeft = gNfcf.AS.maxPollTime;
+    
     return RFAL_ERR_NONE;
 }
 
 /*******************************************************************************/
 ReturnCode rfalNfcfPollerGetCollisionResolutionStatus( void )
 {
-    ReturnCode  ret;
+    ReturnCode          ret;
+    rfalFeliCaPollSlots slots;
+    uint32_t            pollTime;
     
     switch( gNfcf.CR.state )
     {
@@ -376,14 +437,41 @@ ReturnCode rfalNfcfPollerGetCollisionResolutionStatus( void )
                 *gNfcf.CR.devCnt = 0;
             }
 
-            RFAL_EXIT_ON_ERR( ret, rfalStartFeliCaPoll( RFAL_FELICA_16_SLOTS, 
+            if( !gNfcf.AS.enabled )
+            {
+                gNfcf.AS.stats.slots = RFAL_FELICA_16_SLOTS;
+                slots                = RFAL_FELICA_16_SLOTS;
+            }
+            else
+            {
+                /* The poll time cap holds for all the SENSF_REQs of the Collision Resolution */
+                slots    = gNfcf.AS.stats.slots;
+                pollTime = (RFAL_NFCF_POLL_RES_TIME_US + ((uint32_t)rfalNfcfSlots2CardNum( slots ) * RFAL_NFCF_POLL_SLOT_TIME_US));
+                while( (slots != RFAL_FELICA_1_SLOT) && (pollTime > gNfcf.CR.pollTimeLeft) )
+                {
+                    /* PRQA S 4342 1 # MISRA 10.5 - Halving a power of two TSN is always a valid TSN */
+                    slots    = (rfalFeliCaPollSlots)((uint8_t)slots >> 1U);
+                    pollTime = (RFAL_NFCF_POLL_RES_TIME_US + ((uint32_t)rfalNfcfSlots2CardNum( slots ) * RFAL_NFCF_POLL_SLOT_TIME_US));
+                }
+                
+                if( pollTime > gNfcf.CR.pollTimeLeft )
+                {
+                    break;                                  /* Poll time used up, e.g. no room for the RC=SC poll */
+                }
+                gNfcf.CR.pollTimeLeft -= pollTime;
+            }
+            
+            RFAL_EXIT_ON_ERR( ret, rfalStartFeliCaPoll( slots, 
                                                    RFAL_NFCF_SYSTEMCODE, 
                                                   (uint8_t)((gNfcf.CR.state == RFAL_NFCF_CR_POLL_SC) ? RFAL_FELICA_POLL_RC_SYSTEM_CODE : RFAL_FELICA_POLL_RC_NO_REQUEST), 
                                                   gNfcf.CR.greedyF.POLL_F, 
-                                                  rfalNfcfSlots2CardNum((uint8_t)RFAL_FELICA_16_SLOTS), 
+                                                  rfalNfcfSlots2CardNum((uint8_t)slots), 
                                                   &gNfcf.CR.greedyF.pollFound, 
                                                   &gNfcf.CR.greedyF.pollCollision ) );
             
+            gNfcf.AS.stats.pollCnt++;
+            gNfcf.AS.stats.slotCnt += rfalNfcfSlots2CardNum( slots );
+            
             gNfcf.CR.state = RFAL_NFCF_CR_PARSE;
             return RFAL_ERR_BUSY;
 
@@ -393,6 +481,15 @@ ReturnCode rfalNfcfPollerGetCollisionResolutionStatus( void )
             
             RFAL_EXIT_ON_BUSY( ret, rfalGetFeliCaPollStatus() );
             
+            gNfcf.AS.stats.resCnt  += gNfcf.CR.greedyF.pollFound;
+            gNfcf.AS.stats.collCnt += gNfcf.CR.greedyF.pollCollision;
+            
+            /* Size the next SENSF_REQ from what has just been observed */
+            if( gNfcf.AS.enabled )
+            {
+                rfalNfcfAdaptSlots( ((ret == RFAL_ERR_NONE) ? gNfcf.CR.greedyF.pollFound : 0U), gNfcf.CR.greedyF.pollCollision );
+            }
+            
             if( ret == RFAL_ERR_NONE )
             {
                 /* Activity 2.1  9.3.6.5 - Symbol 4 Update device list */
@@ -425,29 +522,57 @@ ReturnCode rfalNfcfPollerGetCollisionResolutionStatus( void )
 }
 
 /*******************************************************************************/
-ReturnCode rfalNfcfPollerCheck( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvdLen )
+ReturnCode rfalNfcfPollerSetAdaptiveSlots( bool enable, uint16_t maxPollTime )
 {
-    uint8_t       txBuf[RFAL_NFCF_CHECK_REQ_MAX_LEN];
-    uint8_t       msgIt;
-    uint8_t       i;
-    ReturnCode    ret;
-    const uint8_t *checkRes;
+    uint32_t maxSlots;
     
-    /* Check parameters */
-    if( (nfcid2 == NULL) || (rxBuf == NULL) || (servBlock == NULL)                           ||
-        (servBlock->numBlock == 0U) || (servBlock->numBlock > RFAL_NFCF_CHECK_REQ_MAX_BLOCK) ||
-        (servBlock->numServ == 0U) || (servBlock->numServ > RFAL_NFCF_CHECK_REQ_MAX_SERV)    ||
-        (rxBufLen < (RFAL_NFCF_LENGTH_LEN + RFAL_NFCF_CHECK_RES_MIN_LEN))                      )
+    if( maxPollTime < (RFAL_NFCF_POLL_RES_TIME_US + RFAL_NFCF_POLL_SLOT_TIME_US) )
     {
         return RFAL_ERR_PARAM;
     }
     
-    msgIt = 0;
+    /* Largest power of two number of slots fitting a single SENSF_REQ within the poll time cap */
+    maxSlots = ((uint32_t)maxPollTime - RFAL_NFCF_POLL_RES_TIME_US) / RFAL_NFCF_POLL_SLOT_TIME_US;
+    gNfcf.AS.maxSlots = 1U;
+    while( ((uint32_t)gNfcf.AS.maxSlots << 1U) <= RFAL_MIN( maxSlots, RFAL_NFCF_POLL_MAXCARDS ) )
+    {
+        gNfcf.AS.maxSlots <<= 1U;
+    }
     
-    /*******************************************************************************/
-    /* Compose CHECK command/request                                               */
+    gNfcf.AS.enabled     = enable;
+    gNfcf.AS.maxPollTime = maxPollTime;
+    gNfcf.AS.stats.slots = (enable ? RFAL_FELICA_1_SLOT : RFAL_FELICA_16_SLOTS);
+    
+    /* Forget the responses of an earlier poll: the next Collision Resolution is sized from fresh ones */
+    gNfcf.CR.greedyF.pollFound     = 0;
+    gNfcf.CR.greedyF.pollCollision = 0;
+    
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalNfcfPollerGetPollStats( rfalNfcfPollStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    *stats = gNfcf.AS.stats;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static uint16_t rfalNfcfComposeServBlockList( const uint8_t* nfcid2, uint8_t cmd, const rfalNfcfServBlockListParam *servBlock, uint8_t *txBuf )
+{
+    uint16_t msgIt;
+    uint8_t  i;
     
-    txBuf[msgIt++] = RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION;                               /* Command Code    */
+    msgIt = 0;
+    
+    txBuf[msgIt++] = cmd;                                                                 /* Command Code    */
     
     RFAL_MEMCPY( &txBuf[msgIt], nfcid2, RFAL_NFCF_NFCID2_LEN );                             /* NFCID2          */
     msgIt += RFAL_NFCF_NFCID2_LEN;
@@ -474,9 +599,94 @@ ReturnCode rfalNfcfPollerCheck( const uint8_t* nfcid2, const rfalNfcfServBlockLi
         }
     }
     
+    return msgIt;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalNfcfPollerComposeCheck( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock, uint8_t *txBuf, uint16_t txBufLen, uint16_t *txLen )
+{
+    /* Check parameters */
+    if( (nfcid2 == NULL) || (txBuf == NULL) || (txLen == NULL) || (servBlock == NULL)        ||
+        (servBlock->numBlock == 0U) || (servBlock->numBlock > RFAL_NFCF_CHECK_REQ_MAX_BLOCK) ||
+        (servBlock->numServ == 0U) || (servBlock->numServ > RFAL_NFCF_CHECK_REQ_MAX_SERV)    ||
+        (txBufLen < RFAL_NFCF_CHECK_REQ_MAX_LEN)                                               )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /*******************************************************************************/
+    /* Compose CHECK command/request                                               */
+    *txLen = rfalNfcfComposeServBlockList( nfcid2, (uint8_t)RFAL_NFCF_CMD_READ_WITHOUT_ENCRYPTION, servBlock, txBuf );
+    
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalNfcfPollerComposeUpdate( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock, const uint8_t *blockData, uint8_t *txBuf, uint16_t txBufLen, uint16_t *txLen )
+{
+    uint16_t msgIt;
+    uint16_t auxLen;
+    uint8_t  i;
+    
+    /* Check parameters */
+    if( (nfcid2 == NULL) || (txBuf == NULL) || (txLen == NULL) || (servBlock == NULL) || (blockData == NULL) ||
+        (servBlock->numBlock == 0U) || (servBlock->numBlock > RFAL_NFCF_UPDATE_REQ_MAX_BLOCK)                ||
+        (servBlock->numServ == 0U)   || (servBlock->numServ > RFAL_NFCF_UPDATE_REQ_MAX_SERV)                   )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /* Calculate required txBuffer lenth      T3T 1.0  Table 9 */
+    auxLen = (uint16_t)( RFAL_NFCF_CMD_LEN + RFAL_NFCF_NFCID2_LEN + RFAL_NFCF_NOS_LEN + ( servBlock->numServ * sizeof(rfalNfcfServ) ) + 
+              RFAL_NFCF_NOB_LEN + (uint16_t)((uint16_t)servBlock->numBlock * RFAL_NFCF_BLOCK_LEN) );
+    
+    for( i = 0; i < servBlock->numBlock; i++)
+    {
+        auxLen += ( ((servBlock->blockList[i].conf & RFAL_NFCF_BLOCKLISTELEM_LEN_BIT) != 0U) ? (RFAL_NFCF_BLOCKLISTELEM_MAX_LEN - 1U) : RFAL_NFCF_BLOCKLISTELEM_MAX_LEN );
+    }
+    
+    
+    /* Check whether the provided buffer is sufficient for this request */
+    if( txBufLen < auxLen )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /*******************************************************************************/
+    /* Compose UPDATE command/request                                              */
+    msgIt = rfalNfcfComposeServBlockList( nfcid2, (uint8_t)RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION, servBlock, txBuf );
+    
+    auxLen = ((uint16_t)servBlock->numBlock * RFAL_NFCF_BLOCK_LEN);
+    RFAL_MEMCPY( &txBuf[msgIt], blockData, auxLen );                                        /* Block Data      */
+    msgIt += auxLen;
+    
+    *txLen = msgIt;
+    
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalNfcfPollerCheck( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvdLen )
+{
+    uint8_t       txBuf[RFAL_NFCF_CHECK_REQ_MAX_LEN];
+    uint16_t      txLen;
+    ReturnCode    ret;
+    const uint8_t *checkRes;
+    
+    /* Check parameters */
+    if( (rxBuf == NULL) || (rxBufLen < (RFAL_NFCF_LENGTH_LEN + RFAL_NFCF_CHECK_RES_MIN_LEN)) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    RFAL_EXIT_ON_ERR( ret, rfalNfcfPollerComposeCheck( nfcid2, servBlock, txBuf, (uint16_t)sizeof(txBuf), &txLen ) );
+    
     /*******************************************************************************/
     /* Transceive CHECK command/request                                            */
-    ret = rfalTransceiveBlockingTxRx( txBuf, msgIt, rxBuf, rxBufLen, rcvdLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_NFCF_MRT_CHECK_UPDATE );
+    ret = rfalTransceiveBlockingTxRx( txBuf, txLen, rxBuf, rxBufLen, rcvdLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_NFCF_MRT_CHECK_UPDATE );
     
     if( ret == RFAL_ERR_NONE )
     {
@@ -515,73 +725,22 @@ ReturnCode rfalNfcfPollerCheck( const uint8_t* nfcid2, const rfalNfcfServBlockLi
 /*******************************************************************************/
 ReturnCode rfalNfcfPollerUpdate( const uint8_t* nfcid2, const rfalNfcfServBlockListParam *servBlock,  uint8_t *txBuf, uint16_t txBufLen, const uint8_t *blockData, uint8_t *rxBuf, uint16_t rxBufLen )
 {
-    uint8_t       i;
-    uint16_t      msgIt;
+    uint16_t      txLen;
     uint16_t      rcvdLen;
-    uint16_t      auxLen;
     const uint8_t *updateRes;
     ReturnCode    ret;
 
     /* Check parameters */
-    if( (nfcid2 == NULL) || (rxBuf == NULL) || (servBlock == NULL) || (txBuf == NULL)         ||
-        (servBlock->numBlock == 0U) || (servBlock->numBlock > RFAL_NFCF_UPDATE_REQ_MAX_BLOCK) ||
-        (servBlock->numServ == 0U)   || (servBlock->numServ > RFAL_NFCF_UPDATE_REQ_MAX_SERV)  ||
-        (rxBufLen < (RFAL_NFCF_LENGTH_LEN + RFAL_NFCF_UPDATE_RES_MIN_LEN))                      )
-    {
-        return RFAL_ERR_PARAM;
-    }
-    
-    /* Calculate required txBuffer lenth      T3T 1.0  Table 9 */
-    auxLen = (uint16_t)( RFAL_NFCF_CMD_LEN + RFAL_NFCF_NFCID2_LEN + RFAL_NFCF_NOS_LEN + ( servBlock->numServ * sizeof(rfalNfcfServ) ) + 
-              RFAL_NFCF_NOB_LEN + (uint16_t)((uint16_t)servBlock->numBlock * RFAL_NFCF_BLOCKLISTELEM_MAX_LEN) + (uint16_t)((uint16_t)servBlock->numBlock * RFAL_NFCF_BLOCK_LEN) );
-    
-    
-    /* Check whether the provided buffer is sufficient for this request */
-    if( txBufLen < auxLen )
+    if( (rxBuf == NULL) || (rxBufLen < (RFAL_NFCF_LENGTH_LEN + RFAL_NFCF_UPDATE_RES_MIN_LEN)) )
     {
         return RFAL_ERR_PARAM;
     }
-        
-    msgIt = 0;
-    
-    /*******************************************************************************/
-    /* Compose UPDATE command/request                                              */
-    
-    txBuf[msgIt++] = RFAL_NFCF_CMD_WRITE_WITHOUT_ENCRYPTION;                              /* Command Code    */
-    
-    RFAL_MEMCPY( &txBuf[msgIt], nfcid2, RFAL_NFCF_NFCID2_LEN );                             /* NFCID2          */
-    msgIt += RFAL_NFCF_NFCID2_LEN;
-    
-    txBuf[msgIt++] = servBlock->numServ;                                                  /* NoS             */
-    for( i = 0; i < servBlock->numServ; i++)
-    {
-        txBuf[msgIt++] = (uint8_t)((servBlock->servList[i] >> 0U) & 0xFFU);               /* Service Code    */
-        txBuf[msgIt++] = (uint8_t)((servBlock->servList[i] >> 8U) & 0xFFU);            
-    }
-    
-    txBuf[msgIt++] = servBlock->numBlock;                                                 /* NoB             */
-    for( i = 0; i < servBlock->numBlock; i++)
-    {
-        txBuf[msgIt++] = servBlock->blockList[i].conf;                                    /* Block list element conf (Flag|Access|Service) */
-        if( (servBlock->blockList[i].conf & RFAL_NFCF_BLOCKLISTELEM_LEN_BIT) != 0U )      /* Check if 2 or 3 byte block list element       */
-        {
-            txBuf[msgIt++] = (uint8_t)(servBlock->blockList[i].blockNum & 0xFFU);         /* 1byte Block Num */
-        }
-        else
-        {
-            txBuf[msgIt++] = (uint8_t)((servBlock->blockList[i].blockNum >> 0U) & 0xFFU); /* 2byte Block Num */
-            txBuf[msgIt++] = (uint8_t)((servBlock->blockList[i].blockNum >> 8U) & 0xFFU);
-        }
-    }
-    
-    auxLen = ((uint16_t)servBlock->numBlock * RFAL_NFCF_BLOCK_LEN);
-    RFAL_MEMCPY( &txBuf[msgIt], blockData, auxLen );                                        /* Block Data      */
-    msgIt += auxLen;
     
+    RFAL_EXIT_ON_ERR( ret, rfalNfcfPollerComposeUpdate( nfcid2, servBlock, blockData, txBuf, txBufLen, &txLen ) );
     
     /*******************************************************************************/
     /* Transceive UPDATE command/request                                           */
-    ret = rfalTransceiveBlockingTxRx( txBuf, msgIt, rxBuf, rxBufLen, &rcvdLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_NFCF_MRT_CHECK_UPDATE );
+    ret = rfalTransceiveBlockingTxRx( txBuf, txLen, rxBuf, rxBufLen, &rcvdLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_NFCF_MRT_CHECK_UPDATE );
     
     if( ret == RFAL_ERR_NONE )
     {
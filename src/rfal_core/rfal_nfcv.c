@@ -69,6 +69,7 @@
 #define RFAL_NFCV_INV_REQ_HEADER_LEN      3U     /*!< INVENTORY_REQ header length (INV_FLAG, CMD, MASK_LEN)             */
 #define RFAL_NFCV_INV_RES_LEN             10U    /*!< INVENTORY_RES length                                              */
 #define RFAL_NFCV_WR_MUL_REQ_HEADER_LEN   4U     /*!< Write Multiple header length (INV_FLAG, CMD, [UID], BNo, Bno)     */
+#define RFAL_NFCV_EXT_WR_MUL_REQ_HEADER_LEN 6U /*!< Ext Write Multiple header length (INV_FLAG, CMD, [UID], BNo, Bno)  */
 
 
 #define RFAL_NFCV_CMD_LEN                 1U     /*!< Commandbyte length                                                */
@@ -703,7 +704,7 @@ ReturnCode rfalNfcvPollerExtendedWriteMultipleBlocks( uint8_t flags, const uint8
     uint16_t           nBlocks;
 
     /* Calculate required buffer length */
-    reqLen = ((uid != NULL) ? (RFAL_NFCV_WR_MUL_REQ_HEADER_LEN + RFAL_NFCV_UID_LEN + wrDataLen) : (RFAL_NFCV_WR_MUL_REQ_HEADER_LEN + wrDataLen) );
+    reqLen = ((uid != NULL) ? (RFAL_NFCV_EXT_WR_MUL_REQ_HEADER_LEN + RFAL_NFCV_UID_LEN + wrDataLen) : (RFAL_NFCV_EXT_WR_MUL_REQ_HEADER_LEN + wrDataLen) );
   
     if( (reqLen > txBufLen) || (blockLen > (uint8_t)RFAL_NFCV_MAX_BLOCK_LEN) || (( (uint16_t)numOfBlocks * (uint16_t)blockLen) != wrDataLen) || (numOfBlocks == 0U) )
     {
@@ -0,0 +1,654 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_snep.c
+ *
+ *  \brief Implementation of the SNEP client and default server over LLCP
+ *
+ *  Messages are sent without copy: the SNEP header and the NDEF message are
+ *  handed to rfalLlcpSend() as two parts of the same SDU, which LLCP
+ *  segments on I PDUs of the data link MIU.
+ *
+ *  This implementation was based on the following specs:
+ *    - NFC Forum Simple NDEF Exchange Protocol 1.0  2011-08-31
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_snep.h"
+#include "rfal_rf.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#ifndef RFAL_FEATURE_LLCP
+    #define RFAL_FEATURE_LLCP   false    /* LLCP module configuration missing. Disabled by default */
+#endif
+
+#if RFAL_FEATURE_LLCP
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_SNEP_VERSION              0x10U    /*!< SNEP version 1.0                                  */
+#define RFAL_SNEP_VERSION_MAJOR        0x01U    /*!< SNEP major version supported                      */
+#define RFAL_SNEP_ACCEPT_LEN_LEN       4U       /*!< GET Acceptable Length field length                */
+
+#define RFAL_SNEP_REQ_CONTINUE         0x00U    /*!< Continue                          SNEP 1.0  Table 2 */
+#define RFAL_SNEP_REQ_GET              0x01U    /*!< Get                                                  */
+#define RFAL_SNEP_REQ_PUT              0x02U    /*!< Put                                                  */
+#define RFAL_SNEP_REQ_REJECT           0x7FU    /*!< Reject                                               */
+
+#define RFAL_SNEP_RSP_NONE             0x00U    /*!< No response received yet                             */
+
+/*
+ ******************************************************************************
+ * GLOBAL MACROS
+ ******************************************************************************
+ */
+
+#define rfalSnepGetLen( b )            ( ((uint32_t)(b)[0] << 24U) | ((uint32_t)(b)[1] << 16U) | ((uint32_t)(b)[2] << 8U) | (uint32_t)(b)[3] )  /*!< Big endian 32 bit field */
+
+/*
+ ******************************************************************************
+ * LOCAL DATA TYPES
+ ******************************************************************************
+ */
+
+/*! SNEP message being sent, fragmented on CONTINUE when larger than the data link MIU */
+typedef struct
+{
+    uint8_t               link;                                 /*!< LLCP data link                       */
+    uint8_t               hdr[RFAL_SNEP_HDR_LEN + RFAL_SNEP_ACCEPT_LEN_LEN]; /*!< Header (and Acceptable Length) */
+    uint16_t              hdrLen;                               /*!< Header length                        */
+    const uint8_t         *data;                                /*!< Information                          */
+    uint32_t              dataLen;                              /*!< Information length                   */
+    uint32_t              firstLen;                             /*!< Information on the first fragment    */
+    bool                  waitCont;                             /*!< Remaining fragments wait for CONTINUE */
+} rfalSnepTx;
+
+
+/*! SNEP message being received on a caller buffer */
+typedef struct
+{
+    uint8_t               *buf;                                 /*!< Reassembly buffer                    */
+    uint32_t              bufLen;                               /*!< Reassembly buffer length             */
+    uint32_t              len;                                  /*!< Information length announced         */
+    uint32_t              pos;                                  /*!< Information received                 */
+    uint8_t               code;                                 /*!< Request/Response being received      */
+    bool                  ongoing;                              /*!< Fragments still to be received       */
+} rfalSnepRx;
+
+
+/*! SNEP module context */
+typedef struct
+{
+    rfalLlcpService       srv;                                  /*!< Server LLCP service                  */
+    rfalSnepPutCallback   putCb;                                /*!< Server PUT callback                  */
+    rfalSnepGetCallback   getCb;                                /*!< Server GET callback                  */
+    uint8_t               srvLink;                              /*!< Server data link                     */
+    rfalSnepRx            srvRx;                                /*!< Server request reassembly            */
+    rfalSnepTx            srvTx;                                /*!< Server response                      */
+
+    uint8_t               cliLink;                              /*!< Client data link                     */
+    bool                  cliConnected;                         /*!< Client data link connected           */
+    rfalSnepRx            cliRx;                                /*!< Client response reassembly           */
+    rfalSnepTx            cliTx;                                /*!< Client request                       */
+    uint8_t               cliContHdr[RFAL_SNEP_HDR_LEN];        /*!< Client CONTINUE request              */
+    uint8_t               cliRsp;                               /*!< Client last response code            */
+    bool                  cliRspDone;                           /*!< Client response completely received  */
+
+    rfalSnepStats         stats;                                /*!< Statistics                           */
+} rfalSnep;
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static rfalSnep gSnepInst[RFAL_FEATURE_INSTANCES];   /*!< SNEP Module instances        */
+#define gSnep  gSnepInst[rfalInstance()]             /*!< Current SNEP Module instance */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+static uint16_t rfalSnepSetHdr( uint8_t *hdr, uint8_t code, uint32_t len );
+static ReturnCode rfalSnepSend( rfalSnepTx *tx );
+static ReturnCode rfalSnepSendRemaining( rfalSnepTx *tx );
+static bool rfalSnepRxFragment( rfalSnepRx *rx, const uint8_t *data, uint16_t dataLen );
+static void rfalSnepServerRespond( uint8_t code, const uint8_t *data, uint32_t dataLen );
+static void rfalSnepServerDispatch( void );
+static bool rfalSnepServerConnect( uint8_t link );
+static void rfalSnepServerState( uint8_t link, rfalLlcpLinkState state );
+static void rfalSnepServerRx( uint8_t link, const uint8_t *data, uint16_t dataLen );
+static void rfalSnepClientRx( uint8_t link, const uint8_t *data, uint16_t dataLen );
+static void rfalSnepClientState( uint8_t link, rfalLlcpLinkState state );
+static ReturnCode rfalSnepClientConnect( void );
+static ReturnCode rfalSnepClientTransceive( void );
+
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static uint16_t rfalSnepSetHdr( uint8_t *hdr, uint8_t code, uint32_t len )
+{
+    hdr[0] = RFAL_SNEP_VERSION;
+    hdr[1] = code;
+    hdr[2] = (uint8_t)(len >> 24U);
+    hdr[3] = (uint8_t)(len >> 16U);
+    hdr[4] = (uint8_t)(len >> 8U);
+    hdr[5] = (uint8_t)(len);
+
+    return RFAL_SNEP_HDR_LEN;
+}
+
+
+/*******************************************************************************/
+static ReturnCode rfalSnepSend( rfalSnepTx *tx )
+{
+    uint16_t miu;
+
+    miu          = rfalLlcpGetLinkMIU( tx->link );
+    tx->waitCont = false;
+    tx->firstLen = tx->dataLen;
+
+    /* Larger than one I PDU: send the first fragment only and wait for CONTINUE   SNEP 1.0  5.1 */
+    if( ((uint32_t)tx->hdrLen + tx->dataLen) > miu )
+    {
+        tx->firstLen = (uint32_t)(miu - tx->hdrLen);
+        tx->waitCont = true;
+        gSnep.stats.fragTxCnt++;
+    }
+
+    return rfalLlcpSend( tx->link, tx->hdr, tx->hdrLen, tx->data, tx->firstLen );
+}
+
+
+/*******************************************************************************/
+static ReturnCode rfalSnepSendRemaining( rfalSnepTx *tx )
+{
+    tx->waitCont = false;
+
+    /* All remaining fragments in one go, LLCP pipelines them within the remote receive window */
+    return rfalLlcpSend( tx->link, NULL, 0U, &tx->data[tx->firstLen], (tx->dataLen - tx->firstLen) );
+}
+
+
+/*******************************************************************************/
+static bool rfalSnepRxFragment( rfalSnepRx *rx, const uint8_t *data, uint16_t dataLen )
+{
+    uint32_t cpyLen;
+
+    cpyLen = RFAL_MIN( (uint32_t)dataLen, (rx->len - rx->pos) );
+    if( cpyLen > 0U )
+    {
+        RFAL_MEMCPY( &rx->buf[rx->pos], data, cpyLen );
+        rx->pos += cpyLen;
+    }
+
+    rx->ongoing = (rx->pos < rx->len);
+    return !rx->ongoing;
+}
+
+
+/*******************************************************************************/
+static void rfalSnepServerRespond( uint8_t code, const uint8_t *data, uint32_t dataLen )
+{
+    gSnep.srvTx.link    = gSnep.srvLink;
+    gSnep.srvTx.hdrLen  = rfalSnepSetHdr( gSnep.srvTx.hdr, code, dataLen );
+    gSnep.srvTx.data    = data;
+    gSnep.srvTx.dataLen = dataLen;
+
+    rfalSnepSend( &gSnep.srvTx );
+}
+
+
+/*******************************************************************************/
+static void rfalSnepServerDispatch( void )
+{
+    const uint8_t *rsp;
+    uint32_t      rspLen;
+    uint8_t       code;
+
+    if( gSnep.srvRx.code == RFAL_SNEP_REQ_PUT )
+    {
+        gSnep.stats.putCnt++;
+        if( gSnep.putCb != NULL )
+        {
+            gSnep.putCb( gSnep.srvRx.buf, gSnep.srvRx.len );
+        }
+        rfalSnepServerRespond( RFAL_SNEP_RSP_SUCCESS, NULL, 0U );
+        return;
+    }
+
+    /* GET: Acceptable Length followed by the NDEF request */
+    gSnep.stats.getCnt++;
+    rsp    = NULL;
+    rspLen = 0U;
+    code   = gSnep.getCb( &gSnep.srvRx.buf[RFAL_SNEP_ACCEPT_LEN_LEN], (gSnep.srvRx.len - RFAL_SNEP_ACCEPT_LEN_LEN), &rsp, &rspLen );
+
+    if( code != RFAL_SNEP_RSP_SUCCESS )
+    {
+        rfalSnepServerRespond( code, NULL, 0U );
+    }
+    else if( rspLen > rfalSnepGetLen( gSnep.srvRx.buf ) )
+    {
+        rfalSnepServerRespond( RFAL_SNEP_RSP_EXCESS_DATA, NULL, 0U );
+    }
+    else
+    {
+        rfalSnepServerRespond( RFAL_SNEP_RSP_SUCCESS, rsp, rspLen );
+    }
+}
+
+
+/*******************************************************************************/
+static bool rfalSnepServerConnect( uint8_t link )
+{
+    /* Single client at a time */
+    if( rfalLlcpGetLinkState( gSnep.srvLink ) != RFAL_LLCP_LINK_CLOSED )
+    {
+        return false;
+    }
+
+    gSnep.srvLink          = link;
+    gSnep.srvRx.ongoing    = false;
+    gSnep.srvTx.waitCont   = false;
+    return true;
+}
+
+
+/*******************************************************************************/
+static void rfalSnepServerState( uint8_t link, rfalLlcpLinkState state )
+{
+    if( (link == gSnep.srvLink) && (state == RFAL_LLCP_LINK_CLOSED) )
+    {
+        gSnep.srvLink        = RFAL_LLCP_LINK_INVALID;
+        gSnep.srvRx.ongoing  = false;
+        gSnep.srvTx.waitCont = false;
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalSnepServerRx( uint8_t link, const uint8_t *data, uint16_t dataLen )
+{
+    uint32_t len;
+
+    if( link != gSnep.srvLink )
+    {
+        return;
+    }
+
+    /* Fragmented response waiting for the client CONTINUE */
+    if( gSnep.srvTx.waitCont )
+    {
+        if( (dataLen >= RFAL_SNEP_HDR_LEN) && (data[1] == RFAL_SNEP_REQ_CONTINUE) )
+        {
+            rfalSnepSendRemaining( &gSnep.srvTx );
+        }
+        else
+        {
+            gSnep.srvTx.waitCont = false;                   /* REJECT: drop the remaining fragments */
+        }
+        return;
+    }
+
+    if( gSnep.srvRx.ongoing )
+    {
+        gSnep.stats.fragRxCnt++;
+        if( rfalSnepRxFragment( &gSnep.srvRx, data, dataLen ) )
+        {
+            rfalSnepServerDispatch();
+        }
+        return;
+    }
+
+    /*******************************************************************************/
+    /* New request                                                                 */
+    if( dataLen < RFAL_SNEP_HDR_LEN )
+    {
+        rfalSnepServerRespond( RFAL_SNEP_RSP_BAD_REQUEST, NULL, 0U );
+        return;
+    }
+
+    if( (data[0] >> 4U) != RFAL_SNEP_VERSION_MAJOR )
+    {
+        rfalSnepServerRespond( RFAL_SNEP_RSP_UNSUPPORTED_VER, NULL, 0U );
+        return;
+    }
+
+    len = rfalSnepGetLen( &data[2] );
+
+    switch( data[1] )
+    {
+        case RFAL_SNEP_REQ_PUT:
+            break;
+
+        case RFAL_SNEP_REQ_GET:
+            if( gSnep.getCb == NULL )
+            {
+                rfalSnepServerRespond( RFAL_SNEP_RSP_NOT_IMPLEMENTED, NULL, 0U );
+                return;
+            }
+            if( len < RFAL_SNEP_ACCEPT_LEN_LEN )
+            {
+                rfalSnepServerRespond( RFAL_SNEP_RSP_BAD_REQUEST, NULL, 0U );
+                return;
+            }
+            break;
+
+        default:
+            rfalSnepServerRespond( RFAL_SNEP_RSP_NOT_IMPLEMENTED, NULL, 0U );
+            return;
+    }
+
+    /* Request does not fit the server buffer: refuse it before any further fragment   SNEP 1.0  5.1 */
+    if( len > gSnep.srvRx.bufLen )
+    {
+        gSnep.stats.rejectCnt++;
+        rfalSnepServerRespond( RFAL_SNEP_RSP_REJECT, NULL, 0U );
+        return;
+    }
+
+    gSnep.srvRx.code = data[1];
+    gSnep.srvRx.len  = len;
+    gSnep.srvRx.pos  = 0U;
+
+    if( rfalSnepRxFragment( &gSnep.srvRx, &data[RFAL_SNEP_HDR_LEN], (dataLen - RFAL_SNEP_HDR_LEN) ) )
+    {
+        rfalSnepServerDispatch();
+    }
+    else
+    {
+        rfalSnepServerRespond( RFAL_SNEP_RSP_CONTINUE, NULL, 0U );
+    }
+}
+
+
+/*******************************************************************************/
+static void rfalSnepClientRx( uint8_t link, const uint8_t *data, uint16_t dataLen )
+{
+    uint32_t len;
+
+    if( (link != gSnep.cliLink) || gSnep.cliRspDone )
+    {
+        return;
+    }
+
+    if( gSnep.cliRx.ongoing )
+    {
+        gSnep.stats.fragRxCnt++;
+        gSnep.cliRspDone = rfalSnepRxFragment( &gSnep.cliRx, data, dataLen );
+        return;
+    }
+
+    if( dataLen < RFAL_SNEP_HDR_LEN )
+    {
+        gSnep.cliRsp     = RFAL_SNEP_RSP_BAD_REQUEST;
+        gSnep.cliRspDone = true;
+        return;
+    }
+
+    /* First fragment accepted, send the remaining ones */
+    if( (data[1] == RFAL_SNEP_RSP_CONTINUE) && gSnep.cliTx.waitCont )
+    {
+        rfalSnepSendRemaining( &gSnep.cliTx );
+        return;
+    }
+
+    gSnep.cliRsp         = data[1];
+    gSnep.cliTx.waitCont = false;
+    len                  = rfalSnepGetLen( &data[2] );
+
+    /* GET response carries the NDEF message */
+    if( (gSnep.cliRsp == RFAL_SNEP_RSP_SUCCESS) && (gSnep.cliRx.buf != NULL) )
+    {
+        if( len > gSnep.cliRx.bufLen )
+        {
+            gSnep.cliRsp     = RFAL_SNEP_RSP_EXCESS_DATA;
+            gSnep.cliRspDone = true;
+            return;
+        }
+
+        gSnep.cliRx.code = gSnep.cliRsp;
+        gSnep.cliRx.len  = len;
+        gSnep.cliRx.pos  = 0U;
+
+        if( !rfalSnepRxFragment( &gSnep.cliRx, &data[RFAL_SNEP_HDR_LEN], (dataLen - RFAL_SNEP_HDR_LEN) ) )
+        {
+            rfalLlcpSend( gSnep.cliLink, gSnep.cliContHdr, rfalSnepSetHdr( gSnep.cliContHdr, RFAL_SNEP_REQ_CONTINUE, 0U ), NULL, 0U );
+            return;
+        }
+    }
+
+    gSnep.cliRspDone = true;
+}
+
+
+/*******************************************************************************/
+static void rfalSnepClientState( uint8_t link, rfalLlcpLinkState state )
+{
+    /* Forget the data link once closed, its handle may be reused by the server */
+    if( (link == gSnep.cliLink) && (state == RFAL_LLCP_LINK_CLOSED) )
+    {
+        gSnep.cliLink      = RFAL_LLCP_LINK_INVALID;
+        gSnep.cliConnected = false;
+    }
+}
+
+
+/*******************************************************************************/
+static ReturnCode rfalSnepClientConnect( void )
+{
+    ReturnCode ret;
+    uint32_t   tmr;
+
+    if( gSnep.cliConnected )
+    {
+        return RFAL_ERR_NONE;
+    }
+
+    /* Connect by name, the remote SDP resolves the SNEP SAP */
+    RFAL_EXIT_ON_ERR( ret, rfalLlcpConnect( RFAL_LLCP_SAP_SNEP, RFAL_LLCP_SN_SNEP, rfalSnepClientRx, rfalSnepClientState, &gSnep.cliLink ) );
+
+    tmr = platformTimerCreate( RFAL_SNEP_RSP_TIMEOUT );
+    while( rfalLlcpGetLinkState( gSnep.cliLink ) == RFAL_LLCP_LINK_CONNECTING )
+    {
+        if( platformTimerIsExpired( tmr ) )
+        {
+            rfalLlcpDisconnect( gSnep.cliLink );
+            return RFAL_ERR_TIMEOUT;
+        }
+        RFAL_EXIT_ON_ERR( ret, rfalLlcpWorker() );
+    }
+    platformTimerDestroy( tmr );
+
+    /* DM: no SNEP server on the remote */
+    gSnep.cliConnected = (rfalLlcpGetLinkState( gSnep.cliLink ) == RFAL_LLCP_LINK_CONNECTED);
+    return (gSnep.cliConnected ? RFAL_ERR_NONE : RFAL_ERR_NOTFOUND);
+}
+
+
+/*******************************************************************************/
+static ReturnCode rfalSnepClientTransceive( void )
+{
+    ReturnCode ret;
+    uint32_t   tmr;
+
+    gSnep.cliRsp         = RFAL_SNEP_RSP_NONE;
+    gSnep.cliRspDone     = false;
+    gSnep.cliRx.ongoing  = false;
+    gSnep.cliTx.link     = gSnep.cliLink;
+
+    RFAL_EXIT_ON_ERR( ret, rfalSnepSend( &gSnep.cliTx ) );
+
+    tmr = platformTimerCreate( RFAL_SNEP_RSP_TIMEOUT );
+    while( !gSnep.cliRspDone )
+    {
+        if( !gSnep.cliConnected )
+        {
+            return RFAL_ERR_LINK_LOSS;
+        }
+        if( platformTimerIsExpired( tmr ) )
+        {
+            return RFAL_ERR_TIMEOUT;
+        }
+        RFAL_EXIT_ON_ERR( ret, rfalLlcpWorker() );
+    }
+    platformTimerDestroy( tmr );
+
+    return ((gSnep.cliRsp == RFAL_SNEP_RSP_SUCCESS) ? RFAL_ERR_NONE : RFAL_ERR_REQUEST);
+}
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+ReturnCode rfalSnepServerStart( uint8_t *buf, uint32_t bufLen, rfalSnepPutCallback putCb, rfalSnepGetCallback getCb )
+{
+    if( (buf == NULL) || (bufLen == 0U) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    gSnep.putCb         = putCb;
+    gSnep.getCb         = getCb;
+    gSnep.srvLink       = RFAL_LLCP_LINK_INVALID;
+    gSnep.cliLink       = RFAL_LLCP_LINK_INVALID;
+    gSnep.srvRx.buf     = buf;
+    gSnep.srvRx.bufLen  = bufLen;
+    gSnep.srvRx.ongoing = false;
+
+    gSnep.srv.sap       = RFAL_LLCP_SAP_SNEP;
+    gSnep.srv.sn        = RFAL_LLCP_SN_SNEP;
+    gSnep.srv.connectCb = rfalSnepServerConnect;
+    gSnep.srv.rxCb      = rfalSnepServerRx;
+    gSnep.srv.stateCb   = rfalSnepServerState;
+    gSnep.srv.uiCb      = NULL;
+
+    return rfalLlcpRegisterService( &gSnep.srv );
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalSnepClientPut( const uint8_t *ndef, uint32_t ndefLen )
+{
+    ReturnCode ret;
+
+    if( (ndef == NULL) || (ndefLen == 0U) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    if( !rfalLlcpIsActive() )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+
+    RFAL_EXIT_ON_ERR( ret, rfalSnepClientConnect() );
+
+    gSnep.cliTx.hdrLen  = rfalSnepSetHdr( gSnep.cliTx.hdr, RFAL_SNEP_REQ_PUT, ndefLen );
+    gSnep.cliTx.data    = ndef;
+    gSnep.cliTx.dataLen = ndefLen;
+    gSnep.cliRx.buf     = NULL;
+
+    return rfalSnepClientTransceive();
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalSnepClientGet( const uint8_t *ndefReq, uint32_t ndefReqLen, uint8_t *rxBuf, uint32_t rxBufLen, uint32_t *rcvdLen )
+{
+    ReturnCode ret;
+    uint8_t    *hdr;
+
+    if( (ndefReq == NULL) || (ndefReqLen == 0U) || (rxBuf == NULL) || (rcvdLen == NULL) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    if( !rfalLlcpIsActive() )
+    {
+        return RFAL_ERR_WRONG_STATE;
+    }
+
+    *rcvdLen = 0U;
+    RFAL_EXIT_ON_ERR( ret, rfalSnepClientConnect() );
+
+    /* Header followed by the Acceptable Length   SNEP 1.0  4.1 */
+    hdr = gSnep.cliTx.hdr;
+    gSnep.cliTx.hdrLen  = rfalSnepSetHdr( hdr, RFAL_SNEP_REQ_GET, (RFAL_SNEP_ACCEPT_LEN_LEN + ndefReqLen) );
+    hdr[gSnep.cliTx.hdrLen++] = (uint8_t)(rxBufLen >> 24U);
+    hdr[gSnep.cliTx.hdrLen++] = (uint8_t)(rxBufLen >> 16U);
+    hdr[gSnep.cliTx.hdrLen++] = (uint8_t)(rxBufLen >> 8U);
+    hdr[gSnep.cliTx.hdrLen++] = (uint8_t)(rxBufLen);
+    gSnep.cliTx.data    = ndefReq;
+    gSnep.cliTx.dataLen = ndefReqLen;
+    gSnep.cliRx.buf     = rxBuf;
+    gSnep.cliRx.bufLen  = rxBufLen;
+
+    RFAL_EXIT_ON_ERR( ret, rfalSnepClientTransceive() );
+
+    *rcvdLen = gSnep.cliRx.pos;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+uint8_t rfalSnepClientGetLastRsp( void )
+{
+    return gSnep.cliRsp;
+}
+
+
+/*******************************************************************************/
+void rfalSnepClientClose( void )
+{
+    if( gSnep.cliConnected )
+    {
+        rfalLlcpDisconnect( gSnep.cliLink );
+    }
+    gSnep.cliLink      = RFAL_LLCP_LINK_INVALID;
+    gSnep.cliConnected = false;
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalSnepGetStats( rfalSnepStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    (*stats) = gSnep.stats;
+    return RFAL_ERR_NONE;
+}
+
+#endif /* RFAL_FEATURE_LLCP */
@@ -0,0 +1,278 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_stats.c
+ *
+ *  \brief RF timing and throughput instrumentation
+ *
+ *  The hooks only update counters of the selected instance: a transceive
+ *  and a state stay are timed from two time stamps, the SPI hooks take
+ *  none. Hooks are called from the layer owning the event, so that no
+ *  hook needs to know about another layer.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_stats.h"
+#include "rfal_rf.h"
+
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#ifndef RFAL_FEATURE_STATS
+    #define RFAL_FEATURE_STATS   false    /* Instrumentation module configuration missing. Disabled by default */
+#endif
+
+#if RFAL_FEATURE_STATS
+
+/*
+ ******************************************************************************
+ * LOCAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_STATS_NFC_STATE_NONE    0xFFU  /*!< No state accounted yet */
+
+/*
+ ******************************************************************************
+ * LOCAL DATA TYPES
+ ******************************************************************************
+ */
+
+/*! Instrumentation instance */
+typedef struct{
+    rfalStats           stats;          /*!< Instrumentation block                                   */
+    uint8_t             nfcState;       /*!< rfalNfcState being timed                                */
+    uint32_t            nfcEnter;       /*!< Time stamp the state was entered [us]                   */
+    bool                txRxOn;         /*!< A transceive is being timed                             */
+    uint32_t            txRxStart;      /*!< Time stamp the transceive was started [us]              */
+}rfalStatsInst;
+
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static rfalStatsInst gRfalStatsInst[RFAL_FEATURE_INSTANCES];
+#define gRfalStats  gRfalStatsInst[rfalInstance()]
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+static rfalStatsErr rfalStatsErrType( ReturnCode err );
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+void rfalStatsInitialize( void )
+{
+    RFAL_MEMSET( &gRfalStats, 0x00, sizeof(rfalStatsInst) );
+    gRfalStats.nfcState    = RFAL_STATS_NFC_STATE_NONE;
+    gRfalStats.stats.since = platformGetSysTickUs();
+}
+
+
+/*******************************************************************************/
+void rfalStatsClear( void )
+{
+    /* Counters only: the state or transceive being timed is accounted on its end, to the new period */
+    RFAL_MEMSET( &gRfalStats.stats, 0x00, sizeof(rfalStats) );
+    gRfalStats.stats.since = platformGetSysTickUs();
+}
+
+
+/*******************************************************************************/
+ReturnCode rfalStatsGet( rfalStats *stats )
+{
+    if( stats == NULL )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    (*stats) = gRfalStats.stats;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalStatsNfcStateUpdate( uint8_t state )
+{
+    rfalStatsNfcState *st;
+    uint32_t           now;
+    uint32_t           stay;
+
+    if( state == gRfalStats.nfcState )
+    {
+        return;                                               /* Most calls: nothing changed, no time stamp taken */
+    }
+
+    now = platformGetSysTickUs();
+
+    /* Account the stay on the state left */
+    if( gRfalStats.nfcState < RFAL_STATS_NFC_STATES )
+    {
+        st            = &gRfalStats.stats.nfc[gRfalStats.nfcState];
+        stay          = (now - gRfalStats.nfcEnter);
+        st->time     += stay;
+        st->maxTime   = RFAL_MAX( st->maxTime, stay );
+    }
+
+    /* Time the state entered */
+    if( state < RFAL_STATS_NFC_STATES )
+    {
+        gRfalStats.stats.nfc[state].enterCnt++;
+    }
+    gRfalStats.nfcState = state;
+    gRfalStats.nfcEnter = now;
+}
+
+
+/*******************************************************************************/
+void rfalStatsTxRxStart( uint16_t txBytes )
+{
+    gRfalStats.stats.txRx.txBytes += txBytes;
+    gRfalStats.txRxStart           = platformGetSysTickUs();
+    gRfalStats.txRxOn              = true;
+}
+
+
+/*******************************************************************************/
+void rfalStatsTxRxEnd( ReturnCode status, uint16_t rxBytes )
+{
+    rfalStatsTxRx *txRx = &gRfalStats.stats.txRx;
+    uint32_t       time;
+
+    if( !gRfalStats.txRxOn )
+    {
+        return;
+    }
+    gRfalStats.txRxOn = false;
+
+    time           = (platformGetSysTickUs() - gRfalStats.txRxStart);
+    txRx->cnt++;
+    txRx->rxBytes += rxBytes;
+    txRx->time    += time;
+    txRx->maxTime  = RFAL_MAX( txRx->maxTime, time );
+
+    if( status != RFAL_ERR_NONE )
+    {
+        txRx->errCnt[rfalStatsErrType( status )]++;
+    }
+}
+
+
+/*******************************************************************************/
+void rfalStatsTxFifoRefill( void )
+{
+    gRfalStats.stats.txRx.txFifoRefills++;
+}
+
+
+/*******************************************************************************/
+void rfalStatsRxFifoRead( void )
+{
+    gRfalStats.stats.txRx.rxFifoReads++;
+}
+
+
+/*******************************************************************************/
+void rfalStatsComXfer( void )
+{
+    gRfalStats.stats.com.xferCnt++;
+}
+
+
+/*******************************************************************************/
+void rfalStatsComBytes( uint16_t len )
+{
+    gRfalStats.stats.com.bytes += len;
+}
+
+
+/*******************************************************************************/
+uint32_t rfalStatsOpStart( void )
+{
+    return platformGetSysTickUs();
+}
+
+
+/*******************************************************************************/
+void rfalStatsOpEnd( rfalStatsOp op, uint32_t start, bool ok )
+{
+    rfalStatsHist *hist;
+    uint32_t       time;
+    uint32_t       ms;
+    uint8_t        bucket;
+
+    if( op >= RFAL_STATS_OP_NUM )
+    {
+        return;
+    }
+
+    hist          = &gRfalStats.stats.op[op];
+    time          = (platformGetSysTickUs() - start);
+    hist->cnt++;
+    hist->time   += time;
+    hist->maxTime = RFAL_MAX( hist->maxTime, time );
+    if( !ok )
+    {
+        hist->errCnt++;
+    }
+
+    /* Bucket: 0 for less than 1ms, then one bucket per power of two ms */
+    ms     = (time / 1000U);
+    bucket = 0U;
+    while( (ms != 0U) && (bucket < (RFAL_STATS_HIST_BUCKETS - 1U)) )
+    {
+        ms >>= 1U;
+        bucket++;
+    }
+    hist->bucket[bucket]++;
+}
+
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+static rfalStatsErr rfalStatsErrType( ReturnCode err )
+{
+    switch( err )
+    {
+        case RFAL_ERR_TIMEOUT:          return RFAL_STATS_ERR_TIMEOUT;
+        case RFAL_ERR_CRC:              return RFAL_STATS_ERR_CRC;
+        case RFAL_ERR_PAR:              return RFAL_STATS_ERR_PAR;
+        case RFAL_ERR_FRAMING:          return RFAL_STATS_ERR_FRAMING;
+        case RFAL_ERR_RF_COLLISION:     return RFAL_STATS_ERR_COLLISION;
+        case RFAL_ERR_NOMEM:            return RFAL_STATS_ERR_NOMEM;
+        case RFAL_ERR_LINK_LOSS:        return RFAL_STATS_ERR_LINK_LOSS;
+        default:
+            /* Incomplete byte, with or without the number of bits received */
+            if( (err >= RFAL_ERR_INCOMPLETE_BYTE) && (err <= RFAL_ERR_INCOMPLETE_BYTE_07) )
+            {
+                return RFAL_STATS_ERR_FRAMING;
+            }
+            return RFAL_STATS_ERR_OTHER;
+    }
+}
+
+#endif /* RFAL_FEATURE_STATS */
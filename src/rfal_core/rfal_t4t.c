@@ -66,6 +66,7 @@
 #define RFAL_T4T_DATA_DO            0x53U        /*!< Tag value for data BER-TLV data object            */
 
 #define RFAL_T4T_MAX_LC             255U         /*!< Maximum Lc value for short Lc coding              */
+#define RFAL_T4T_ODO_HDR_LEN        7U           /*!< Offset and data BER-TLV headers length on ODO     */
  /*
 ******************************************************************************
 * GLOBAL TYPES
@@ -421,4 +422,66 @@ ReturnCode rfalT4TPollerComposeWriteDataODO( rfalIsoDepApduBufFormat *cApduBuf,
 }
 
 
+/*******************************************************************************/ 
+ReturnCode rfalT4TPollerComposeWriteDataHdr( rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, uint8_t dataLen, uint16_t *cApduLen )
+{
+    uint16_t msgIt;
+    
+    if( (cApduBuf == NULL) || (cApduLen == NULL) || (dataLen == 0U) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /* CLA INS P1  P2   Lc  | Data   Le  */
+    /* 00h D6h [Offset] len | (caller)  -   */
+    msgIt = 0U;
+    cApduBuf->apdu[msgIt++] = RFAL_T4T_CLA;
+    cApduBuf->apdu[msgIt++] = (uint8_t)RFAL_T4T_INS_UPDATEBINARY;
+    cApduBuf->apdu[msgIt++] = (uint8_t)((offset >> 8U) & 0xFFU);
+    cApduBuf->apdu[msgIt++] = (uint8_t)((offset >> 0U) & 0xFFU);
+    cApduBuf->apdu[msgIt++] = dataLen;
+    
+    *cApduLen = msgIt;
+    
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/ 
+ReturnCode rfalT4TPollerComposeWriteDataODOHdr( rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, uint8_t dataLen, uint16_t *cApduLen )
+{
+    uint16_t msgIt;
+    
+    if( (cApduBuf == NULL) || (cApduLen == NULL) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    if( ((uint32_t)dataLen + RFAL_T4T_ODO_HDR_LEN) >= RFAL_T4T_MAX_LC )
+    {
+        return RFAL_ERR_NOMEM;
+    }
+    
+    /* CLA INS P1  P2   Lc  Data                     | Data      Le  */
+    /* 00h D7h 00h 00h  len 54 03 xxyyzz 53 Ld       | (caller)  -   */
+    msgIt = 0U;
+    cApduBuf->apdu[msgIt++] = RFAL_T4T_CLA;
+    cApduBuf->apdu[msgIt++] = (uint8_t)RFAL_T4T_INS_UPDATEBINARY_ODO;
+    cApduBuf->apdu[msgIt++] = 0x00U;
+    cApduBuf->apdu[msgIt++] = 0x00U;
+    cApduBuf->apdu[msgIt++] = (uint8_t)(dataLen + RFAL_T4T_ODO_HDR_LEN);
+    cApduBuf->apdu[msgIt++] = RFAL_T4T_OFFSET_DO;
+    cApduBuf->apdu[msgIt++] = RFAL_T4T_LENGTH_DO;
+    cApduBuf->apdu[msgIt++] = (uint8_t)(offset >> 16U);
+    cApduBuf->apdu[msgIt++] = (uint8_t)(offset >> 8U);
+    cApduBuf->apdu[msgIt++] = (uint8_t)(offset);
+    cApduBuf->apdu[msgIt++] = RFAL_T4T_DATA_DO;
+    cApduBuf->apdu[msgIt++] = dataLen;
+    
+    *cApduLen = msgIt;
+    
+    return RFAL_ERR_NONE;
+}
+
+
 #endif /* RFAL_FEATURE_T4T */
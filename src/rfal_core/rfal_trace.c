@@ -0,0 +1,284 @@
+
+/*
+ *      PROJECT:   ST25R391x firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file rfal_trace.c
+ *
+ *  \brief RF frame capture
+ *
+ *  Entries are serialized byte by byte, little endian, straight onto the
+ *  application buffer: no packing or alignment is assumed on either side,
+ *  so the host tools read the trace with the same layout.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "rfal_trace.h"
+
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#ifndef RFAL_FEATURE_TRACE
+    #define RFAL_FEATURE_TRACE   false    /* Frame capture module configuration missing. Disabled by default */
+#endif
+
+#if RFAL_FEATURE_TRACE
+
+/*
+ ******************************************************************************
+ * LOCAL DATA TYPES
+ ******************************************************************************
+ */
+
+/*! Frame capture instance */
+typedef struct{
+    uint8_t             *buf;           /*!< Trace buffer, NULL if not recording                     */
+    uint32_t            bufLen;         /*!< Trace buffer length                                     */
+    uint32_t            len;            /*!< Trace length                                            */
+    uint32_t            dropped;        /*!< Entries not recorded                                    */
+    bool                full;           /*!< An entry did not fit, nothing is recorded anymore       */
+    bool                perDevice;      /*!< Trace restarted on each device activated                */
+    bool                txPending;      /*!< TX entry recorded, its RX entry is due                  */
+}rfalTraceInst;
+
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static rfalTraceInst gRfalTraceInst[RFAL_FEATURE_INSTANCES];
+#define gRfalTrace  gRfalTraceInst[rfalInstance()]
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ ******************************************************************************
+ */
+static bool rfalTraceReserve( uint32_t len );
+static void rfalTracePut8( uint8_t val );
+static void rfalTracePut16( uint16_t val );
+static void rfalTracePut32( uint32_t val );
+static void rfalTracePutBuf( const uint8_t *buf, uint16_t len );
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+ReturnCode rfalTraceStart( uint8_t *buf, uint32_t bufLen, bool perDevice )
+{
+    if( (buf == NULL) || (bufLen < RFAL_TRACE_HDR_LEN) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    RFAL_MEMSET( &gRfalTrace, 0x00, sizeof(rfalTraceInst) );
+    gRfalTrace.buf       = buf;
+    gRfalTrace.bufLen    = bufLen;
+    gRfalTrace.perDevice = perDevice;
+
+    /* Header: magic, version, reserved */
+    rfalTracePut8( (uint8_t)'R' );
+    rfalTracePut8( (uint8_t)'F' );
+    rfalTracePut8( (uint8_t)'T' );
+    rfalTracePut8( (uint8_t)'R' );
+    rfalTracePut8( RFAL_TRACE_VERSION );
+    rfalTracePut8( 0U );
+    rfalTracePut16( 0U );
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+uint32_t rfalTraceStop( uint32_t *dropped )
+{
+    uint32_t len;
+
+    if( dropped != NULL )
+    {
+        (*dropped) = gRfalTrace.dropped;
+    }
+
+    len = ((gRfalTrace.buf != NULL) ? gRfalTrace.len : 0U);
+    gRfalTrace.buf = NULL;
+
+    return len;
+}
+
+
+/*******************************************************************************/
+void rfalTraceTx( const rfalTransceiveContext *ctx )
+{
+    rfalBitRate txBR;
+    rfalBitRate rxBR;
+    uint16_t    lenBits;
+
+    gRfalTrace.txPending = false;
+
+    if( gRfalTrace.buf == NULL )
+    {
+        return;
+    }
+
+    lenBits = ((ctx->txBuf != NULL) ? ctx->txBufLen : 0U);
+    if( !rfalTraceReserve( (RFAL_TRACE_TX_HDR_LEN + rfalConvBitsToBytes( lenBits )) ) )
+    {
+        return;
+    }
+
+    (void)rfalGetBitRate( &txBR, &rxBR );
+
+    rfalTracePut8( RFAL_TRACE_ENTRY_TX );
+    rfalTracePut32( platformGetSysTickUs() );
+    rfalTracePut8( (uint8_t)rfalGetMode() );
+    rfalTracePut8( (uint8_t)txBR );
+    rfalTracePut8( (uint8_t)rxBR );
+    rfalTracePut32( ctx->flags );
+    rfalTracePut32( ctx->fwt );
+    rfalTracePut16( lenBits );
+    rfalTracePutBuf( ctx->txBuf, rfalConvBitsToBytes( lenBits ) );
+
+    gRfalTrace.txPending = true;
+}
+
+
+/*******************************************************************************/
+void rfalTraceRx( ReturnCode status, const rfalTransceiveContext *ctx )
+{
+    uint16_t lenBits;
+    uint16_t len;
+
+    if( (gRfalTrace.buf == NULL) || (!gRfalTrace.txPending) )
+    {
+        return;
+    }
+    gRfalTrace.txPending = false;
+
+    lenBits = ((ctx->rxRcvdLen != NULL) ? (*ctx->rxRcvdLen) : 0U);
+
+    /* Never read beyond the Rx buffer, whatever the length reported */
+    len = 0U;
+    if( ctx->rxBuf != NULL )
+    {
+        len = RFAL_MIN( rfalConvBitsToBytes( lenBits ), rfalConvBitsToBytes( ctx->rxBufLen ) );
+    }
+
+    if( !rfalTraceReserve( (RFAL_TRACE_RX_HDR_LEN + (uint32_t)len) ) )
+    {
+        return;
+    }
+
+    rfalTracePut8( RFAL_TRACE_ENTRY_RX );
+    rfalTracePut32( platformGetSysTickUs() );
+    rfalTracePut16( status );
+    rfalTracePut16( lenBits );
+    rfalTracePut16( len );
+    rfalTracePutBuf( ctx->rxBuf, len );
+}
+
+
+/*******************************************************************************/
+void rfalTraceDev( const rfalTraceDevice *dev )
+{
+    uint8_t nfcidLen;
+
+    if( gRfalTrace.buf == NULL )
+    {
+        return;
+    }
+
+    if( gRfalTrace.perDevice )
+    {
+        /* Discovery frames dropped, the session starts here */
+        gRfalTrace.len       = RFAL_TRACE_HDR_LEN;
+        gRfalTrace.dropped   = 0U;
+        gRfalTrace.full      = false;
+        gRfalTrace.txPending = false;
+    }
+
+    nfcidLen = RFAL_MIN( dev->nfcidLen, (uint8_t)RFAL_TRACE_NFCID_MAX_LEN );
+    if( !rfalTraceReserve( (RFAL_TRACE_DEVICE_HDR_LEN + (uint32_t)nfcidLen) ) )
+    {
+        return;
+    }
+
+    rfalTracePut8( RFAL_TRACE_ENTRY_DEVICE );
+    rfalTracePut32( platformGetSysTickUs() );
+    rfalTracePut8( dev->type );
+    rfalTracePut8( dev->subType );
+    rfalTracePut8( nfcidLen );
+    rfalTracePutBuf( dev->nfcid, nfcidLen );
+    rfalTracePut8( dev->DID );
+    rfalTracePut16( dev->FSx );
+    rfalTracePut32( dev->FWT );
+    rfalTracePut32( dev->dFWT );
+}
+
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+static bool rfalTraceReserve( uint32_t len )
+{
+    if( (!gRfalTrace.full) && (len <= (gRfalTrace.bufLen - gRfalTrace.len)) )
+    {
+        return true;
+    }
+
+    /* Keep the trace a consistent prefix: once an entry is lost, so are the following */
+    gRfalTrace.full = true;
+    gRfalTrace.dropped++;
+    return false;
+}
+
+
+/*******************************************************************************/
+static void rfalTracePut8( uint8_t val )
+{
+    gRfalTrace.buf[gRfalTrace.len++] = val;
+}
+
+
+/*******************************************************************************/
+static void rfalTracePut16( uint16_t val )
+{
+    rfalTracePut8( (uint8_t)(val >> 0U) );
+    rfalTracePut8( (uint8_t)(val >> 8U) );
+}
+
+
+/*******************************************************************************/
+static void rfalTracePut32( uint32_t val )
+{
+    rfalTracePut16( (uint16_t)(val >> 0U) );
+    rfalTracePut16( (uint16_t)(val >> 16U) );
+}
+
+
+/*******************************************************************************/
+static void rfalTracePutBuf( const uint8_t *buf, uint16_t len )
+{
+    if( (buf != NULL) && (len > 0U) )
+    {
+        RFAL_MEMCPY( &gRfalTrace.buf[gRfalTrace.len], buf, len );
+        gRfalTrace.len += len;
+    }
+}
+
+#endif /* RFAL_FEATURE_TRACE */
@@ -44,6 +44,9 @@
 #include "st25r3911_com.h"
 #include "st25r3911_interrupt.h"
 #include "../rfal_analogConfig.h"
+#include "../rfal_dpo.h"
+#include "../rfal_stats.h"
+#include "../rfal_trace.h"
 #include "../rfal_iso15693_2.h"
 
 /*
@@ -418,7 +421,12 @@ typedef enum
  ******************************************************************************
  */
 
-static rfal gRFAL;              /*!< RFAL module instance               */
+static rfal gRFALInst[RFAL_FEATURE_INSTANCES];  /*!< RFAL module instances         */
+#define gRFAL  gRFALInst[rfalInstance()]          /*!< Current RFAL module instance  */
+
+#if RFAL_FEATURE_INSTANCES > 1U
+uint8_t gRfalInstance;                           /*!< Selected RFAL instance, when not kept per thread by the platform */
+#endif /* RFAL_FEATURE_INSTANCES */
 
 /*
 ******************************************************************************
@@ -448,17 +456,41 @@ static bool rfalFIFOStatusIsIncompleteByte( void );
 static uint8_t rfalFIFOStatusGetNumBytes( void );
 static uint8_t rfalFIFOGetNumIncompleteBits( void );
 
+#if RFAL_FEATURE_TRACE
+static const rfalTransceiveContext* rfalTraceCallerCtx( void );
+#endif /* RFAL_FEATURE_TRACE */
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
 ******************************************************************************
 */
 
+/*******************************************************************************/
+ReturnCode rfalSelectInstance( uint8_t inst )
+{
+    if( inst >= RFAL_FEATURE_INSTANCES )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+#if RFAL_FEATURE_INSTANCES > 1U
+    platformSetInstance( inst );
+#endif /* RFAL_FEATURE_INSTANCES */
+    
+    return RFAL_ERR_NONE;
+}
+
+
 /*******************************************************************************/
 ReturnCode rfalInitialize( void )
 {
     ReturnCode err;
 
+#if RFAL_FEATURE_STATS
+    rfalStatsInitialize();
+#endif /* RFAL_FEATURE_STATS */
+
     /* Initialize chip */
     RFAL_EXIT_ON_ERR( err, st25r3911Initialize() );
     
@@ -1236,6 +1268,15 @@ ReturnCode rfalStartTransceive( const rfalTransceiveContext *ctx )
         
         gRFAL.TxRx.ctx = *ctx;
         
+    #if RFAL_FEATURE_DPO
+        /*******************************************************************************/
+        /* Adjust the output power to the reference measurement before each frame */
+        if( rfalDpoIsEnabled() && rfalIsModePassivePoll( gRFAL.mode ) )
+        {
+            (void)rfalDpoAdjust();
+        }
+    #endif /* RFAL_FEATURE_DPO */
+        
         /*******************************************************************************/
         if( gRFAL.timings.FDTListen != RFAL_TIMING_NONE )
         {
@@ -1295,6 +1336,14 @@ ReturnCode rfalStartTransceive( const rfalTransceiveContext *ctx )
         }
         
         
+    #if RFAL_FEATURE_STATS
+        rfalStatsTxRxStart( (uint16_t)rfalConvBitsToBytes( ctx->txBufLen ) );
+    #endif /* RFAL_FEATURE_STATS */
+        
+    #if RFAL_FEATURE_TRACE
+        rfalTraceTx( ctx );
+    #endif /* RFAL_FEATURE_TRACE */
+        
         gRFAL.state       = RFAL_STATE_TXRX;
         gRFAL.TxRx.state  = RFAL_TXRX_STATE_TX_IDLE;
         gRFAL.TxRx.status = RFAL_ERR_BUSY;
@@ -1457,12 +1506,51 @@ static ReturnCode rfalRunTransceiveWorker( void )
         if( rfalIsTransceiveInTx() )
         {
             rfalTransceiveTx();
+            
+        #if RFAL_FEATURE_STATS
+            /* Ended on Tx: transmission failed or nothing to receive */
+            if( gRFAL.TxRx.state == RFAL_TXRX_STATE_IDLE )
+            {
+                rfalStatsTxRxEnd( gRFAL.TxRx.status, 0U );
+            }
+        #endif /* RFAL_FEATURE_STATS */
+            
+        #if RFAL_FEATURE_TRACE
+            if( gRFAL.TxRx.state == RFAL_TXRX_STATE_IDLE )
+            {
+                rfalTraceRx( gRFAL.TxRx.status, rfalTraceCallerCtx() );
+            }
+        #endif /* RFAL_FEATURE_TRACE */
+            
             return rfalGetTransceiveStatus();
         }
         
         if( rfalIsTransceiveInRx() )
         {
             rfalTransceiveRx();
+            
+        #if RFAL_FEATURE_STATS
+            if( gRFAL.TxRx.state == RFAL_TXRX_STATE_IDLE )
+            {
+                rfalStatsTxRxEnd( gRFAL.TxRx.status, gRFAL.fifo.bytesTotal );
+            }
+        #endif /* RFAL_FEATURE_STATS */
+            
+        #if RFAL_FEATURE_TRACE
+            if( gRFAL.TxRx.state == RFAL_TXRX_STATE_IDLE )
+            {
+                rfalTraceRx( gRFAL.TxRx.status, rfalTraceCallerCtx() );
+            }
+        #endif /* RFAL_FEATURE_TRACE */
+            
+        #if RFAL_FEATURE_DPO
+            /* Feed the reception outcome to the DPO closed loop */
+            if( gRFAL.TxRx.state == RFAL_TXRX_STATE_IDLE )
+            {
+                rfalDpoReportResult( gRFAL.TxRx.status );
+            }
+        #endif /* RFAL_FEATURE_DPO */
+            
             return rfalGetTransceiveStatus();
         }
     }    
@@ -2001,6 +2089,10 @@ static void rfalTransceiveTx( void )
         /*******************************************************************************/
         case RFAL_TXRX_STATE_TX_RELOAD_FIFO:   /*  PRQA S 2003 # MISRA 16.3 - Intentional fall through */
             
+        #if RFAL_FEATURE_STATS
+            rfalStatsTxFifoRefill();
+        #endif /* RFAL_FEATURE_STATS */
+            
         #if RFAL_FEATURE_NFCV
             /*******************************************************************************/
             /* In NFC-V streaming mode, the FIFO needs to be loaded with the coded bits    */
@@ -2503,6 +2595,10 @@ static void rfalTransceiveRx( void )
             
         /*******************************************************************************/
         case RFAL_TXRX_STATE_RX_READ_FIFO:
+            
+        #if RFAL_FEATURE_STATS
+            rfalStatsRxFifoRead();
+        #endif /* RFAL_FEATURE_STATS */
         
             /*******************************************************************************/
             /* REMARK: Silicon workaround ST25R3911B Errata #1.1                           */
@@ -2669,6 +2765,25 @@ static uint8_t rfalFIFOGetNumIncompleteBits( void )
 }
 
 
+#if RFAL_FEATURE_TRACE
+
+/*******************************************************************************/
+static const rfalTransceiveContext* rfalTraceCallerCtx( void )
+{
+#if RFAL_FEATURE_NFCV
+    /* NFC-V runs on the coding buffer and restores the caller context on success only */
+    if( (RFAL_MODE_POLL_NFCV == gRFAL.mode) || (RFAL_MODE_POLL_PICOPASS == gRFAL.mode) )
+    {
+        return &gRFAL.nfcvData.origCtx;
+    }
+#endif /* RFAL_FEATURE_NFCV */
+    
+    return &gRFAL.TxRx.ctx;
+}
+
+#endif /* RFAL_FEATURE_TRACE */
+
+
 #if RFAL_FEATURE_NFCA
 
 /*******************************************************************************/
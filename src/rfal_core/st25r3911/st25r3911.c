@@ -40,6 +40,7 @@
 #include "st25r3911_com.h"
 #include "st25r3911_interrupt.h"
 #include "rfal_utils.h"
+#include "rfal_rf.h"
 
 
 /*
@@ -79,7 +80,8 @@
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static uint32_t st25r3911NoResponseTime_64fcs;
+static uint32_t st25r3911NoResponseTimeInst_64fcs[RFAL_FEATURE_INSTANCES];
+#define st25r3911NoResponseTime_64fcs   st25r3911NoResponseTimeInst_64fcs[rfalInstance()]
 
 /*
 ******************************************************************************
@@ -38,6 +38,8 @@
 #include "st25r3911_com.h"
 #include "st25r3911.h"
 #include "rfal_utils.h"
+#include "rfal_rf.h"
+#include "rfal_stats.h"
 
 
 /*
@@ -55,6 +57,14 @@
 #define ST25R3911_CMD_LEN     (1U)                           /*!< ST25R3911 CMD length                                           */
 #define ST25R3911_BUF_LEN     (ST25R3911_CMD_LEN+ST25R3911_FIFO_DEPTH)  /*!< ST25R3911 communication buffer: CMD + FIFO length   */
 
+#if RFAL_FEATURE_STATS
+    #define st25r3911SpiSelect()              do{ platformSpiSelect(); rfalStatsComXfer(); }while(0)                         /*!< SPI Chip Select, counted as one transaction */
+    #define st25r3911SpiTxRx( tx, rx, len )   do{ platformSpiTxRx( (tx), (rx), (len) ); rfalStatsComBytes( (uint16_t)(len) ); }while(0) /*!< SPI transceive, bytes counted */
+#else
+    #define st25r3911SpiSelect()              platformSpiSelect()                                                             /*!< SPI Chip Select             */
+    #define st25r3911SpiTxRx( tx, rx, len )   platformSpiTxRx( (tx), (rx), (len) )                                            /*!< SPI transceive              */
+#endif /* RFAL_FEATURE_STATS */
+
 /*
 ******************************************************************************
 * LOCAL VARIABLES
@@ -100,12 +110,12 @@ void st25r3911ReadRegister(uint8_t reg, uint8_t* value)
 #endif  /* ST25R_COM_SINGLETXRX */
   
     platformProtectST25RComm();
-    platformSpiSelect();
+    st25r3911SpiSelect();
   
     buf[0] = (reg | ST25R3911_READ_MODE);
     buf[1] = 0x00;
   
-    platformSpiTxRx(buf, buf, 2);
+    st25r3911SpiTxRx(buf, buf, 2);
   
     if(value != NULL)
     {
@@ -128,14 +138,14 @@ void st25r3911ReadMultipleRegisters(uint8_t reg, uint8_t* values, uint8_t length
     if (length > 0U)
     {
         platformProtectST25RComm();
-        platformSpiSelect();
+        st25r3911SpiSelect();
   
 #ifdef ST25R_COM_SINGLETXRX
   
         RFAL_MEMSET( comBuf, 0x00, RFAL_MIN( (ST25R3911_CMD_LEN + (uint32_t)length), ST25R3911_BUF_LEN ) );
         comBuf[0] = (reg | ST25R3911_READ_MODE);
         
-        platformSpiTxRx(comBuf, comBuf, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );               /* Transceive as a single SPI call                        */
+        st25r3911SpiTxRx(comBuf, comBuf, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );               /* Transceive as a single SPI call                        */
         RFAL_MEMCPY( values, &comBuf[ST25R3911_CMD_LEN], RFAL_MIN( length, ST25R3911_BUF_LEN - ST25R3911_CMD_LEN ) );  /* Copy from local buf to output buffer and skip cmd byte */
   
 #else  /* ST25R_COM_SINGLETXRX */
@@ -146,8 +156,8 @@ void st25r3911ReadMultipleRegisters(uint8_t reg, uint8_t* values, uint8_t length
         }
         
         /* Since the result comes one byte later, let's first transmit the adddress with discarding the result */
-        platformSpiTxRx(&cmd, NULL, ST25R3911_CMD_LEN);
-        platformSpiTxRx(NULL, values, length);  
+        st25r3911SpiTxRx(&cmd, NULL, ST25R3911_CMD_LEN);
+        st25r3911SpiTxRx(NULL, values, length);  
   
 #endif  /* ST25R_COM_SINGLETXRX */
 
@@ -168,13 +178,13 @@ void st25r3911ReadTestRegister(uint8_t reg, uint8_t* value)
 #endif  /* ST25R_COM_SINGLETXRX */
 
     platformProtectST25RComm();
-    platformSpiSelect();
+    st25r3911SpiSelect();
 
     buf[0] = ST25R3911_CMD_TEST_ACCESS;
     buf[1] = (reg | ST25R3911_READ_MODE);
     buf[2] = 0x00;
   
-    platformSpiTxRx(buf, buf, 3);
+    st25r3911SpiTxRx(buf, buf, 3);
     
     if(value != NULL)
     {
@@ -196,13 +206,13 @@ void st25r3911WriteTestRegister(uint8_t reg, uint8_t value)
 #endif  /* ST25R_COM_SINGLETXRX */
     
     platformProtectST25RComm();
-    platformSpiSelect();
+    st25r3911SpiSelect();
 
     buf[0] = ST25R3911_CMD_TEST_ACCESS;
     buf[1] = (reg | ST25R3911_WRITE_MODE);
     buf[2] = value;
   
-    platformSpiTxRx(buf, NULL, 3);
+    st25r3911SpiTxRx(buf, NULL, 3);
   
     platformSpiDeselect();
     platformUnprotectST25RComm();
@@ -224,12 +234,12 @@ void st25r3911WriteRegister(uint8_t reg, uint8_t value)
     }    
     
     platformProtectST25RComm();
-    platformSpiSelect();
+    st25r3911SpiSelect();
 
     buf[0] = reg | ST25R3911_WRITE_MODE;
     buf[1] = value;
     
-    platformSpiTxRx(buf, NULL, 2);
+    st25r3911SpiTxRx(buf, NULL, 2);
     
     platformSpiDeselect();
     platformUnprotectST25RComm();
@@ -313,19 +323,19 @@ void st25r3911WriteMultipleRegisters(uint8_t reg, const uint8_t* values, uint8_t
     {
         /* make this operation atomic */
         platformProtectST25RComm();
-        platformSpiSelect();
+        st25r3911SpiSelect();
     
 #ifdef ST25R_COM_SINGLETXRX
       
         comBuf[0] = (reg | ST25R3911_WRITE_MODE);
         RFAL_MEMCPY( &comBuf[ST25R3911_CMD_LEN], values, RFAL_MIN( length, ST25R3911_BUF_LEN - ST25R3911_CMD_LEN ) );
 
-        platformSpiTxRx( comBuf, NULL, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );
+        st25r3911SpiTxRx( comBuf, NULL, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );
       
 #else  /*ST25R_COM_SINGLETXRX*/    
     
-        platformSpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
-        platformSpiTxRx( values, NULL, length );
+        st25r3911SpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
+        st25r3911SpiTxRx( values, NULL, length );
     
 #endif  /*ST25R_COM_SINGLETXRX*/    
     
@@ -346,19 +356,19 @@ void st25r3911WriteFifo(const uint8_t* values, uint8_t length)
     if( (length > 0U) && (length <= ST25R3911_FIFO_DEPTH) )
     {
         platformProtectST25RComm();
-        platformSpiSelect();
+        st25r3911SpiSelect();
   
 #ifdef ST25R_COM_SINGLETXRX
   
         comBuf[0] = ST25R3911_FIFO_LOAD;
         RFAL_MEMCPY( &comBuf[ST25R3911_CMD_LEN], values, RFAL_MIN( length, ST25R3911_BUF_LEN - ST25R3911_CMD_LEN ) );
 
-        platformSpiTxRx( comBuf, NULL, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );
+        st25r3911SpiTxRx( comBuf, NULL, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );
   
 #else  /*ST25R_COM_SINGLETXRX*/
   
-        platformSpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
-        platformSpiTxRx( values, NULL, length );
+        st25r3911SpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
+        st25r3911SpiTxRx( values, NULL, length );
   
 #endif  /*ST25R_COM_SINGLETXRX*/
   
@@ -378,14 +388,14 @@ void st25r3911ReadFifo(uint8_t* buf, uint8_t length)
     if(length > 0U)
     {
         platformProtectST25RComm();
-        platformSpiSelect();
+        st25r3911SpiSelect();
 
 #ifdef ST25R_COM_SINGLETXRX
       
         RFAL_MEMSET( comBuf, 0x00, RFAL_MIN( (ST25R3911_CMD_LEN + (uint32_t)length), ST25R3911_BUF_LEN ) );
         comBuf[0] = ST25R3911_FIFO_READ;
       
-        platformSpiTxRx( comBuf, comBuf, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );          /* Transceive as a single SPI call                        */
+        st25r3911SpiTxRx( comBuf, comBuf, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );          /* Transceive as a single SPI call                        */
         RFAL_MEMCPY( buf, &comBuf[ST25R3911_CMD_LEN], RFAL_MIN( length, ST25R3911_BUF_LEN - ST25R3911_CMD_LEN ) ); /* Copy from local buf to output buffer and skip cmd byte */
   
 #else  /*ST25R_COM_SINGLETXRX*/
@@ -395,8 +405,8 @@ void st25r3911ReadFifo(uint8_t* buf, uint8_t length)
             RFAL_MEMSET( buf, 0x00, length );
         }
         
-        platformSpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
-        platformSpiTxRx( NULL, buf, length );
+        st25r3911SpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
+        st25r3911SpiTxRx( NULL, buf, length );
   
 #endif  /*ST25R_COM_SINGLETXRX*/
       
@@ -421,9 +431,9 @@ void st25r3911ExecuteCommand( uint8_t cmd )
     tmpCmd = (cmd | ST25R3911_CMD_MODE);
 
     platformProtectST25RComm();
-    platformSpiSelect();
+    st25r3911SpiSelect();
     
-    platformSpiTxRx( &tmpCmd, NULL, ST25R3911_CMD_LEN );
+    st25r3911SpiTxRx( &tmpCmd, NULL, ST25R3911_CMD_LEN );
     
     platformSpiDeselect();
     platformUnprotectST25RComm();
@@ -435,9 +445,9 @@ void st25r3911ExecuteCommand( uint8_t cmd )
 void st25r3911ExecuteCommands(const uint8_t *cmds, uint8_t length)
 {
     platformProtectST25RComm();
-    platformSpiSelect();
+    st25r3911SpiSelect();
     
-    platformSpiTxRx( cmds, NULL, length );
+    st25r3911SpiTxRx( cmds, NULL, length );
     
     platformSpiDeselect();
     platformUnprotectST25RComm();
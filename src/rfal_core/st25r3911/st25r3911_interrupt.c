@@ -39,6 +39,7 @@
 #include "st25r3911_com.h"
 #include "st25r3911.h"
 #include "rfal_utils.h"
+#include "rfal_rf.h"
 
 /*
 ******************************************************************************
@@ -71,11 +72,18 @@ typedef struct
 ******************************************************************************
 */
 
-static volatile t_st25r3911Interrupt st25r3911interrupt; /*!< Instance of ST25R3911 interrupt */
+static volatile t_st25r3911Interrupt st25r3911interruptInst[RFAL_FEATURE_INSTANCES]; /*!< Instances of ST25R3911 interrupt */
+#define st25r3911interrupt   st25r3911interruptInst[rfalInstance()]                     /*!< Current ST25R3911 interrupt    */
 
 
 static void st25r3911IRQCheck( uint32_t irqStatus );
 
+#if RFAL_FEATURE_INSTANCES > 1U
+static void st25r3911PollInterrupts( void );
+#else
+    #define st25r3911PollInterrupts()            /* IRQs are serviced by the ISR */
+#endif /* RFAL_FEATURE_INSTANCES */
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTIONS
@@ -188,6 +196,7 @@ uint32_t st25r3911WaitForInterruptsTimed(uint32_t mask, uint16_t tmo)
     tmr = platformTimerCreate(tmo);
     do 
     {
+        st25r3911PollInterrupts();
         status = (st25r3911interrupt.status & mask);
     } while( ( (!platformTimerIsExpired( tmr )) || (tmo == 0U)) && (status == 0U) );
 
@@ -206,6 +215,7 @@ uint32_t st25r3911GetInterrupt(uint32_t mask)
 {
     uint32_t irqs;
 
+    st25r3911PollInterrupts();
     irqs = (st25r3911interrupt.status & mask);
     if (irqs != ST25R3911_IRQ_MASK_NONE)
     {
@@ -251,6 +261,19 @@ void st25r3911IRQCallbackRestore( void )
 }
 
 
+#if RFAL_FEATURE_INSTANCES > 1U
+static void st25r3911PollInterrupts( void )
+{
+    /* Several readers share the MCU: the IRQ line of the selected instance is *
+     * polled from the thread driving it, instead of being serviced by an ISR  */
+    if( platformGpioIsHigh( ST25R_INT_PORT, ST25R_INT_PIN ) )
+    {
+        st25r3911Isr();
+    }
+}
+#endif /* RFAL_FEATURE_INSTANCES */
+
+
 static void st25r3911IRQCheck( uint32_t irqStatus )
 {
     /*******************************************************************************/
@@ -12,6 +12,9 @@
 
 static SemaphoreHandle_t rfal_irq_mtx;
 
+/* IRQ pin of each reader, in RFAL instance order */
+static const uint8_t pltf_irq_pins[] = READER_IRQ_PINS;
+
 /*
  ******************************************************************************
  * GLOBAL AND HELPER FUNCTIONS
@@ -21,7 +24,17 @@ static SemaphoreHandle_t rfal_irq_mtx;
 void interrupt_init()
 {
     rfal_irq_mtx = xSemaphoreCreateMutex();
-    pinMode(IRQ_PIN, INPUT);
+
+    for (uint8_t i = 0; i < sizeof(pltf_irq_pins); i++)
+    {
+        pinMode(pltf_irq_pins[i], INPUT);
+    }
+}
+
+
+uint8_t pltf_irq_pin(uint8_t inst)
+{
+    return pltf_irq_pins[inst];
 }
 
 void pltf_protect_interrupt_status(void)
@@ -26,6 +26,12 @@ const long spi_speed = 1000000;
 /* Lock to serialize SPI communication */
 static SemaphoreHandle_t rfal_spi_mtx;
 
+/* CS pin of each reader, in RFAL instance order */
+static const uint8_t pltf_ss_pins[] = READER_SS_PINS;
+
+/* Task that selected each RFAL instance, NULL if none did yet */
+static TaskHandle_t pltf_inst_task[sizeof(pltf_ss_pins)];
+
 /*
  ******************************************************************************
  * GLOBAL AND HELPER FUNCTIONS
@@ -36,7 +42,12 @@ void spi_init(void)
     rfal_spi_mtx = xSemaphoreCreateMutex();
     SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI);
     SPI.setFrequency(spi_speed);
-    pinMode(SPI_SS, OUTPUT);
+
+    for (uint8_t i = 0; i < sizeof(pltf_ss_pins); i++)
+    {
+        pinMode(pltf_ss_pins[i], OUTPUT);
+        digitalWrite(pltf_ss_pins[i], HIGH);
+    }
 }
 
 void spiTxRx(const uint8_t *txData, uint8_t *rxData, uint8_t length)
@@ -44,16 +55,16 @@ void spiTxRx(const uint8_t *txData, uint8_t *rxData, uint8_t length)
     SPI.transferBytes(txData, rxData, length);
 }
 
-void pltf_cs_select(void)
+void pltf_cs_select(uint8_t inst)
 {
     SPI.beginTransaction(SPISettings(spi_speed, MSBFIRST, SPI_MODE1));
-    digitalWrite(SPI_SS, LOW);
+    digitalWrite(pltf_ss_pins[inst], LOW);
 }
 
-void pltf_cs_deselect(void)
+void pltf_cs_deselect(uint8_t inst)
 {
     SPI.endTransaction();
-    digitalWrite(SPI_SS, HIGH);
+    digitalWrite(pltf_ss_pins[inst], HIGH);
 }
 
 void pltf_protect_com(void)
@@ -65,3 +76,35 @@ void pltf_unprotect_com(void)
 {
     xSemaphoreGive(rfal_spi_mtx); // exit critical section
 }
+
+
+void pltf_set_instance(uint8_t inst)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    // One instance per task: drop a previous selection of the calling task
+    for (uint8_t i = 0; i < sizeof(pltf_inst_task) / sizeof(pltf_inst_task[0]); i++)
+    {
+        if (pltf_inst_task[i] == task)
+        {
+            pltf_inst_task[i] = NULL;
+        }
+    }
+    pltf_inst_task[inst] = task;
+}
+
+
+uint8_t pltf_get_instance(void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    // A handful of readers: a scan is cheaper than thread-local storage, and leaves its slots to the app
+    for (uint8_t i = 0; i < sizeof(pltf_inst_task) / sizeof(pltf_inst_task[0]); i++)
+    {
+        if (pltf_inst_task[i] == task)
+        {
+            return i;
+        }
+    }
+    return 0; // Tasks that selected none drive the first reader
+}
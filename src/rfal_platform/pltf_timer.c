@@ -67,6 +67,15 @@ uint32_t platformGetSysTick_esp32() {
 }
 
 
+/****************************************************************************/
+
+uint32_t platformGetSysTickUs_esp32() {
+	struct timespec cur_ts;
+	clock_gettime(CLOCK_MONOTONIC, &cur_ts);
+	return ((cur_ts.tv_sec * (uint32_t)1000000) + (cur_ts.tv_nsec/1000));
+}
+
+
 /*******************************************************************************/
 uint32_t timerCalculateTimer( uint16_t time )
 {
@@ -0,0 +1,272 @@
+/**
+ * @file tag_session.cpp
+ * 
+ * @brief Tag session manager: follows the tags in the field from arrival to departure.
+ */
+
+#include <Arduino.h>
+
+#include "rfal_platform/rfal_platform.h"
+
+#include "tag_session.h"
+
+extern "C" {
+#include "utils.h"
+#include "rfal_utils.h"
+#include "rfal_dpo.h"
+}
+
+
+/************************************ LOCAL TYPES *********************************************/
+
+typedef struct {
+    bool                  used;             /* Slot holds a tag */
+    rfalNfcDevice         dev;              /* Tag */
+    uint32_t              arrival;          /* Activation time [ms] */
+    uint32_t              lastSeen;         /* Last time seen [ms] */
+    uint32_t              nextCheck;        /* Next presence check due [ms] */
+    uint32_t              checks;           /* Presence checks done */
+} tagSessionSlot;
+
+
+/************************************ LOCAL VARIABLES *****************************************/
+
+static tagSessionSlot     sessionSlots[TAG_SESSION_MAX_DEVICES];
+static tagSessionConfig   sessionConfig = { 50U, 150U };
+static tagSessionCallback sessionCb;
+static uint8_t            sessionNext;      /* Round robin over the slots */
+
+
+/****************** Local function protos ****************/
+
+static bool tag_session_is_present(const rfalNfcDevice *dev);
+static bool tag_session_same_tag(const rfalNfcDevice *a, const rfalNfcDevice *b);
+static void tag_session_notify(tagSessionEvtType type, const tagSessionSlot *slot);
+
+
+/*************************** Local functions implementation. */
+
+static bool tag_session_same_tag(const rfalNfcDevice *a, const rfalNfcDevice *b)
+{
+    return ( (a->type == b->type) && (a->nfcidLen == b->nfcidLen) && (ST_BYTECMP(a->nfcid, b->nfcid, a->nfcidLen) == 0) );
+}
+
+
+static void tag_session_notify(tagSessionEvtType type, const tagSessionSlot *slot)
+{
+    tagSessionEvent evt;
+
+    if (sessionCb == NULL)
+    {
+        return;
+    }
+
+    evt.type      = type;
+    evt.dev       = &slot->dev;
+    evt.timestamp = ((type == TAG_SESSION_EVT_ARRIVAL) ? slot->arrival : slot->lastSeen);
+    evt.dwell     = (slot->lastSeen - slot->arrival);
+    evt.checks    = slot->checks;
+
+    sessionCb(&evt);
+}
+
+
+/* One short exchange per technology - the same the blocking "wait until removed" loops used to repeat. */
+static bool tag_session_is_present(const rfalNfcDevice *dev)
+{
+    ReturnCode ret;
+
+    switch (dev->type)
+    {
+        case RFAL_NFC_LISTEN_TYPE_NFCA:
+        {
+            rfalNfcaSensRes sensRes;
+            rfalNfcaSelRes  selRes;
+
+            rfalNfcaPollerInitialize();
+            ret = rfalNfcaPollerCheckPresence(RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes);
+            if ((ret != RFAL_ERR_NONE) && (ret != RFAL_ERR_RF_COLLISION))   // Collision: other tags answer too, SELECT tells
+            {
+                return false;
+            }
+
+            if (dev->dev.nfca.type == RFAL_NFCA_T1T)
+            {
+                if ((ret != RFAL_ERR_NONE) || (!rfalNfcaIsSensResT1T(&sensRes)))
+                {
+                    return false;
+                }
+            }
+            else if (rfalNfcaPollerSelect(dev->dev.nfca.nfcId1, dev->dev.nfca.nfcId1Len, &selRes) != RFAL_ERR_NONE)
+            {
+                return false;
+            }
+            rfalNfcaPollerSleep();
+            return true;
+        }
+
+        case RFAL_NFC_LISTEN_TYPE_NFCB:
+        {
+            rfalNfcbSensbRes sensbRes;
+            uint8_t          sensbResLen;
+
+            rfalNfcbPollerInitialize();
+            ret = rfalNfcbPollerCheckPresence(RFAL_NFCB_SENS_CMD_ALLB_REQ, RFAL_NFCB_SLOT_NUM_1, &sensbRes, &sensbResLen);
+            if (ret == RFAL_ERR_RF_COLLISION)
+            {
+                return true;        // More than one tag: cannot tell, keep it
+            }
+            if ((ret != RFAL_ERR_NONE) || (ST_BYTECMP(sensbRes.nfcid0, dev->dev.nfcb.sensbRes.nfcid0, RFAL_NFCB_NFCID0_LEN) != 0))
+            {
+                return false;
+            }
+            rfalNfcbPollerSleep(dev->dev.nfcb.sensbRes.nfcid0);
+            return true;
+        }
+
+        case RFAL_NFC_LISTEN_TYPE_NFCF:
+        {
+            rfalFeliCaPollRes  cardList[1];
+            rfalNfcfSensfRes  *sensfRes;
+            uint8_t            devCnt = 1;
+            uint8_t            collisions = 0U;
+
+            rfalNfcfPollerInitialize(RFAL_BR_212);
+            ret = rfalNfcfPollerPoll(RFAL_FELICA_1_SLOT, RFAL_NFCF_SYSTEMCODE, RFAL_FELICA_POLL_RC_NO_REQUEST, cardList, &devCnt, &collisions);
+            if ((ret != RFAL_ERR_NONE) || (devCnt == 0U))
+            {
+                return (collisions != 0U);
+            }
+            /* Skip the length field byte */
+            sensfRes = (rfalNfcfSensfRes *) & ((uint8_t *)cardList)[1];
+            return (ST_BYTECMP(sensfRes->NFCID2, dev->dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN) == 0);
+        }
+
+        case RFAL_NFC_LISTEN_TYPE_NFCV:
+        {
+            rfalNfcvInventoryRes invRes;
+            uint16_t             rcvdLen;
+
+            /* Inventory masked with the whole UID: only this tag may answer */
+            rfalNfcvPollerInitialize();
+            return (rfalNfcvPollerInventory(RFAL_NFCV_NUM_SLOTS_1, RFAL_NFCV_UID_LEN * 8U, dev->dev.nfcv.InvRes.UID, &invRes, &rcvdLen) == RFAL_ERR_NONE);
+        }
+
+        default:
+            return false;
+    }
+}
+
+
+/*************************** Global (exported) functions implementation. */
+
+void tag_session_init(const tagSessionConfig *config, tagSessionCallback cb)
+{
+    if (config != NULL)
+    {
+        sessionConfig = *config;
+    }
+    sessionCb   = cb;
+    sessionNext = 0U;
+    ST_MEMSET(sessionSlots, 0x00, sizeof(sessionSlots));
+}
+
+
+bool tag_session_arrival(const rfalNfcDevice *dev)
+{
+    uint32_t        now = platformGetSysTick();
+    tagSessionSlot *freeSlot = NULL;
+
+    if ((dev == NULL) || (dev->type > RFAL_NFC_LISTEN_TYPE_NFCV))    // No presence check for ST25TB, AP2P and Listen mode peers
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < TAG_SESSION_MAX_DEVICES; i++)
+    {
+        if (!sessionSlots[i].used)
+        {
+            if (freeSlot == NULL)
+            {
+                freeSlot = &sessionSlots[i];
+            }
+        }
+        else if (tag_session_same_tag(&sessionSlots[i].dev, dev))
+        {
+            sessionSlots[i].lastSeen  = now;
+            sessionSlots[i].nextCheck = (now + sessionConfig.presenceInterval);
+            return true;
+        }
+    }
+
+    if (freeSlot == NULL)
+    {
+        return false;
+    }
+
+    freeSlot->used      = true;
+    freeSlot->dev       = *dev;
+    freeSlot->arrival   = now;
+    freeSlot->lastSeen  = now;
+    freeSlot->nextCheck = (now + sessionConfig.presenceInterval);
+    freeSlot->checks    = 0U;
+
+    tag_session_notify(TAG_SESSION_EVT_ARRIVAL, freeSlot);
+    return true;
+}
+
+
+void tag_session_service(void)
+{
+    uint32_t        now = platformGetSysTick();
+    tagSessionSlot *slot;
+    bool            present;
+
+    /* Next followed tag whose check is due, starting after the last one checked */
+    for (uint8_t n = 0; n < TAG_SESSION_MAX_DEVICES; n++)
+    {
+        slot        = &sessionSlots[sessionNext];
+        sessionNext = ((sessionNext + 1U) % TAG_SESSION_MAX_DEVICES);
+
+        if ((!slot->used) || ((int32_t)(now - slot->nextCheck) < 0))
+        {
+            continue;
+        }
+
+        slot->checks++;
+
+#if RFAL_FEATURE_DPO
+        /* WUPA/SELECT/SLP_REQ and a tag gone end in timeouts: not link errors for the DPO loop */
+        rfalDpoPauseLinkMonitor(true);
+        present = tag_session_is_present(&slot->dev);
+        rfalDpoPauseLinkMonitor(false);
+#else
+        present = tag_session_is_present(&slot->dev);
+#endif
+
+        if (present)
+        {
+            slot->lastSeen = platformGetSysTick();
+        }
+        else if ((now - slot->lastSeen) >= sessionConfig.debounce)
+        {
+            tag_session_notify(TAG_SESSION_EVT_DEPARTURE, slot);
+            slot->used = false;
+            return;
+        }
+        slot->nextCheck = (now + sessionConfig.presenceInterval);
+        return;
+    }
+}
+
+
+uint8_t tag_session_count(void)
+{
+    uint8_t cnt = 0U;
+
+    for (uint8_t i = 0; i < TAG_SESSION_MAX_DEVICES; i++)
+    {
+        cnt += (sessionSlots[i].used ? 1U : 0U);
+    }
+    return cnt;
+}
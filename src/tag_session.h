@@ -0,0 +1,81 @@
+/**
+ * @file tag_session.h
+ * 
+ * @brief Tag session manager: follows the tags in the field from arrival to departure.
+ * 
+ * Tags are registered on activation and then checked for presence one at a time, each
+ * check being a single short RF exchange (WUPA+SELECT, ALLB_REQ, POLLING, INVENTORY),
+ * so that the caller stays free between two checks. A tag departs once it has not been
+ * seen for the debounce time, and arrival/departure are reported through a callback
+ * carrying timestamps (ms) and the dwell time.
+ */
+
+#ifndef TAG_SESSION_H
+#define TAG_SESSION_H
+
+extern "C" {
+#include "rfal_nfc.h"
+}
+
+
+#define TAG_SESSION_MAX_DEVICES     4U      /* Tags followed at the same time */
+
+
+/** Tag session event type. */
+typedef enum {
+    TAG_SESSION_EVT_ARRIVAL,                /* Tag activated */
+    TAG_SESSION_EVT_DEPARTURE,              /* Tag not seen for the debounce time */
+} tagSessionEvtType;
+
+/** Tag session event. */
+typedef struct {
+    tagSessionEvtType     type;             /* Event type */
+    const rfalNfcDevice  *dev;              /* Tag (copy held by the session, valid during the callback) */
+    uint32_t              timestamp;        /* ARRIVAL: activation time, DEPARTURE: time last seen [ms] */
+    uint32_t              dwell;            /* DEPARTURE: time from activation to last seen [ms] */
+    uint32_t              checks;           /* DEPARTURE: presence checks done */
+} tagSessionEvent;
+
+/** Tag session event callback. */
+typedef void (*tagSessionCallback)(const tagSessionEvent *evt);
+
+/** Tag session configuration. */
+typedef struct {
+    uint16_t              presenceInterval; /* Time between two presence checks of a tag [ms] */
+    uint16_t              debounce;         /* Time a tag must stay unseen to depart [ms] */
+} tagSessionConfig;
+
+
+/**
+ * @brief Initialize the tag session, forgetting the tags followed.
+ * 
+ * @param config    presence interval and debounce time
+ * @param cb        event callback (NULL: no events)
+ */
+void tag_session_init(const tagSessionConfig *config, tagSessionCallback cb);
+
+/**
+ * @brief Register a tag just activated, reporting its ARRIVAL.
+ * 
+ * Tags already followed are only refreshed. Only NFC-A/B/F/V tags are followed: ST25TB,
+ * AP2P and the peers seen in Listen mode (Reader/Writer, P2P Initiator) are not.
+ * 
+ * @param dev       activated tag
+ * @return true if the tag is followed
+ */
+bool tag_session_arrival(const rfalNfcDevice *dev);
+
+/**
+ * @brief Check the presence of the next tag due, reporting its DEPARTURE once gone.
+ * 
+ * Does at most one presence check: to be called from the poll loop while tags are
+ * followed, with the field on (i.e. before rfalNfcDeactivate()).
+ */
+void tag_session_service(void);
+
+/**
+ * @brief Tags followed.
+ */
+uint8_t tag_session_count(void);
+
+#endif /* TAG_SESSION_H */
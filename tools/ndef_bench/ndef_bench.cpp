@@ -0,0 +1,470 @@
+/**
+ * @file ndef_bench.cpp
+ *
+ * @brief Host benchmark of end-to-end NDEF reads: the whole stack, on simulated tags (tools/tag_farm).
+ *
+ * For each tag model and size of the matrix below, and each message length that fits, a Text record
+ * message is loaded on the tag, then read as the demo reads a tap: rfalNfcDiscover() up to the
+ * activation, ndefPollerContextInitialization(), ndefPollerNdefDetect(), ndefPollerReadRawMessage()
+ * and ndefMessageDecode(), then rfalNfcDeactivate(). The message read must be the one loaded.
+ *
+ * One JSON line is printed per case, the costs of each phase averaged per read: transceives,
+ * timeouts, bytes sent and received, bytes on the SPI bus and air time (both modelled by the link,
+ * see tools/tag_farm/rfal_rf_sim.c) and host CPU time. The exit code is 1 if any case failed, so
+ * the matrix can gate a change of the stack and its numbers be compared across changes.
+ *
+ * The T4T models are then read again with each FSD the reader may announce (16..256 bytes), the
+ * largest message that fits on the tag: one JSON line per FSD with the ISO-DEP I-Blocks sent and
+ * received and the round-trips per read (rfalIsoDepPollGetLinkStats()), for the FSD to be chosen on
+ * numbers rather than on the buffer size alone.
+ *
+ * Build:  gcc -std=gnu99 -c -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 \
+ *             tools/tag_farm/tag_*.c tools/tag_farm/rfal_rf_sim.c src/rfal_platform/pltf_timer.c \
+ *             src/rfal_core/rfal_{nfc,isoDep,nfcDep,nfca,nfcb,nfcf,nfcv,t1t,t2t,t4t,st25xv,crc,stats,dpo,cd,analogConfig,trace}.c \
+ *             src/ndef/poller/ndef_*.c src/ndef/message/ndef_*.c
+ *         g++ -std=c++17 -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 tools/ndef_bench/ndef_bench.cpp *.o -o ndef_bench
+ * Usage:  ndef_bench [-n iterations] [-t model]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "rfal_nfc.h"
+#include "ndef_poller.h"
+#include "ndef_message.h"
+}
+
+#include "tag_farm.h"
+
+
+#define BENCH_MSG_BUF_LEN       8192    // Largest NDEF message read
+
+
+/*** Tag models of the matrix ***/
+typedef enum
+{
+    BENCH_T2T,
+    BENCH_T3T,
+    BENCH_T4T,
+    BENCH_T5T
+} benchType;
+
+typedef struct
+{
+    const char *model;
+    benchType   type;
+    uint16_t    a;                      // T2T: user memory, T3T: blocks, T4T: file size, T5T: blocks
+    uint16_t    b;                      // T3T: Nbr, T4T: MLe, T5T: block length
+    uint16_t    c;                      // T3T: Nbw, T4T: MLc, T5T: manufacturer code
+    uint8_t     features;               // T5T: TAG_T5T_ commands answered
+} benchTag;
+
+#define BENCH_ST25DV            (TAG_T5T_WRITE_MULTIPLE | TAG_T5T_FAST | TAG_T5T_MAILBOX)
+#define BENCH_ST25DV_EXT        (BENCH_ST25DV | TAG_T5T_EXTENDED)
+
+static const benchTag benchTags[] =
+{
+    { "NTAG210",          BENCH_T2T,   48U,   0U,    0U,                0U },
+    { "NTAG213",          BENCH_T2T,  144U,   0U,    0U,                0U },
+    { "NTAG215",          BENCH_T2T,  504U,   0U,    0U,                0U },
+    { "NTAG216",          BENCH_T2T,  888U,   0U,    0U,                0U },
+    { "FeliCa Lite-S",    BENCH_T3T,   13U,   4U,    1U,                0U },
+    { "T3T 1K",           BENCH_T3T,   64U,   8U,    4U,                0U },
+    { "T3T 4K",           BENCH_T3T,  256U,  12U,    8U,                0U },
+    { "T4T 128",          BENCH_T4T,  128U, 255U,  255U,                0U },
+    { "T4T 1K",           BENCH_T4T, 1024U, 255U,  255U,                0U },
+    { "T4T 8K",           BENCH_T4T, 8192U, 255U,  255U,                0U },
+    { "ICODE SLIX",       BENCH_T5T,   28U,   4U, 0x04U,                0U },
+    { "ST25DV04K",        BENCH_T5T,  128U,   4U, 0x02U, BENCH_ST25DV     },
+    { "ST25DV64K",        BENCH_T5T, 2048U,   4U, 0x02U, BENCH_ST25DV_EXT },
+};
+
+static const uint32_t benchMsgLens[] = { 16U, 64U, 128U, 480U, 1000U, 4000U, 8000U };
+
+static const rfalIsoDepFSxI benchFsdis[] = { RFAL_ISODEP_FSXI_16, RFAL_ISODEP_FSXI_24, RFAL_ISODEP_FSXI_32, RFAL_ISODEP_FSXI_40, RFAL_ISODEP_FSXI_48,
+                                             RFAL_ISODEP_FSXI_64, RFAL_ISODEP_FSXI_96, RFAL_ISODEP_FSXI_128, RFAL_ISODEP_FSXI_256 };
+
+
+/*** Phases of a read ***/
+typedef enum
+{
+    PHASE_DISCOVER,
+    PHASE_INIT,
+    PHASE_DETECT,
+    PHASE_READ,
+    PHASE_DECODE,
+    PHASE_NUM
+} benchPhase;
+
+static const char *phaseNames[PHASE_NUM] = { "discover", "init", "detect", "read", "decode" };
+
+typedef struct
+{
+    uint64_t txrx;
+    uint64_t timeouts;
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    uint64_t spiBytes;
+    uint64_t airUs;
+    uint64_t cpuUs;
+} benchCost;
+
+
+/*** LOCAL VARIABLES ***/
+
+static uint8_t              msgBuf[BENCH_MSG_BUF_LEN];
+static rfalNfcDiscoverParam discParam;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static void create_tag(const benchTag *bt, tagFarmTag *tag)
+{
+    switch (bt->type)
+    {
+        case BENCH_T2T: tag_t2t_init(tag, bt->model, bt->a); break;
+        case BENCH_T3T: tag_t3t_init(tag, bt->model, bt->a, (uint8_t)bt->b, (uint8_t)bt->c); break;
+        case BENCH_T4T: tag_t4t_init(tag, bt->model, bt->a, bt->b, bt->c); break;
+        default:        tag_t5t_init(tag, bt->model, (uint8_t)bt->c, bt->a, (uint8_t)bt->b, bt->features); break;
+    }
+}
+
+
+// NDEF message of one Text record ("en") of len bytes in total, short record up to 259 bytes.
+static std::vector<uint8_t> make_message(uint32_t len)
+{
+    std::vector<uint8_t> msg;
+    bool                 sr = (len <= 259U);
+    uint32_t             pl = (len - (sr ? 4U : 7U));
+    uint32_t             i;
+
+    msg.push_back(sr ? 0xD1U : 0xC1U);          // MB, ME, (SR), TNF well known
+    msg.push_back(0x01U);                       // Type length
+    if (sr)
+    {
+        msg.push_back((uint8_t)pl);
+    }
+    else
+    {
+        msg.push_back((uint8_t)(pl >> 24));
+        msg.push_back((uint8_t)(pl >> 16));
+        msg.push_back((uint8_t)(pl >> 8));
+        msg.push_back((uint8_t)pl);
+    }
+    msg.push_back('T');
+    msg.push_back(0x02U);                       // UTF-8, language code length
+    msg.push_back('e');
+    msg.push_back('n');
+    for (i = 3U; i < pl; i++)
+    {
+        msg.push_back((uint8_t)('a' + (i % 26U)));
+    }
+    return msg;
+}
+
+
+static void phase_start(tagFarmStats *s, uint32_t *cpu)
+{
+    tag_farm_get_stats(s);
+    *cpu = tag_farm_cpu_us();
+}
+
+
+static void phase_end(benchCost *cost, const tagFarmStats *s0, uint32_t cpu0)
+{
+    uint32_t     cpu = tag_farm_cpu_us();
+    tagFarmStats s;
+
+    tag_farm_get_stats(&s);
+    cost->txrx     += (s.txrx     - s0->txrx);
+    cost->timeouts += (s.timeouts - s0->timeouts);
+    cost->txBytes  += (s.txBytes  - s0->txBytes);
+    cost->rxBytes  += (s.rxBytes  - s0->rxBytes);
+    cost->spiBytes += (s.spiBytes - s0->spiBytes);
+    cost->airUs    += (s.airUs    - s0->airUs);
+    cost->cpuUs    += (cpu - cpu0);
+}
+
+
+// One read, as the demo does on a tap. Returns 0, or the step that failed (1 discover .. 5 decode, 6 content).
+static int bench_read(const std::vector<uint8_t> &msg, benchCost cost[PHASE_NUM], ndefStatus *err)
+{
+    rfalNfcDevice      *dev;
+    ndefContext         ctx;
+    ndefInfo            info;
+    ndefConstBuffer     bufMsg;
+    ndefMessage         message;
+    ndefMessageInfo     msgInfo;
+    uint32_t            msgLen = 0;
+    tagFarmStats        s;
+    uint32_t            cpu;
+    int                 step = 0;
+
+    *err = ERR_NONE;
+
+    phase_start(&s, &cpu);
+    bool found = tag_farm_discover(&discParam, &dev);
+    phase_end(&cost[PHASE_DISCOVER], &s, cpu);
+    if (!found)
+    {
+        step = 1;
+        goto deactivate;
+    }
+
+    phase_start(&s, &cpu);
+    *err = ndefPollerContextInitialization(&ctx, dev);
+    phase_end(&cost[PHASE_INIT], &s, cpu);
+    if (*err != ERR_NONE)
+    {
+        step = 2;
+        goto deactivate;
+    }
+
+    phase_start(&s, &cpu);
+    *err = ndefPollerNdefDetect(&ctx, &info);
+    phase_end(&cost[PHASE_DETECT], &s, cpu);
+    if ((*err != ERR_NONE) || (info.state == NDEF_STATE_INITIALIZED))
+    {
+        step = 3;
+        goto deactivate;
+    }
+
+    phase_start(&s, &cpu);
+    *err = ndefPollerReadRawMessage(&ctx, msgBuf, sizeof(msgBuf), &msgLen, true);
+    phase_end(&cost[PHASE_READ], &s, cpu);
+    if (*err != ERR_NONE)
+    {
+        step = 4;
+        goto deactivate;
+    }
+
+    phase_start(&s, &cpu);
+    bufMsg.buffer = msgBuf;
+    bufMsg.length = msgLen;
+    *err = ndefMessageDecode(&bufMsg, &message);
+    if (*err == ERR_NONE)
+    {
+        *err = ndefMessageGetInfo(&message, &msgInfo);
+    }
+    phase_end(&cost[PHASE_DECODE], &s, cpu);
+    if (*err != ERR_NONE)
+    {
+        step = 5;
+    }
+    else if ((msgLen != msg.size()) || (memcmp(msgBuf, msg.data(), msgLen) != 0) || (msgInfo.recordCount != 1U))
+    {
+        step = 6;
+    }
+
+deactivate:
+    rfalNfcDeactivate(RFAL_NFC_DEACTIVATE_IDLE);
+    return step;
+}
+
+
+static void print_cost(const char *name, const benchCost *c, unsigned iterations)
+{
+    printf("\"%s\":{\"txrx\":%llu,\"timeouts\":%llu,\"tx_bytes\":%llu,\"rx_bytes\":%llu,\"spi_bytes\":%llu,\"air_us\":%llu,\"cpu_us\":%llu}",
+           name,
+           (unsigned long long)(c->txrx / iterations), (unsigned long long)(c->timeouts / iterations),
+           (unsigned long long)(c->txBytes / iterations), (unsigned long long)(c->rxBytes / iterations),
+           (unsigned long long)(c->spiBytes / iterations), (unsigned long long)(c->airUs / iterations),
+           (unsigned long long)(c->cpuUs / iterations));
+}
+
+
+// Runs a case; returns false if a read failed.
+static bool bench_case(const benchTag *bt, tagFarmTag *tag, uint32_t msgLen, unsigned iterations)
+{
+    std::vector<uint8_t> msg = make_message(msgLen);
+    benchCost            cost[PHASE_NUM];
+    benchCost            total;
+    ndefStatus           err  = ERR_NONE;
+    int                  step = 0;
+    unsigned             i;
+    unsigned             p;
+
+    memset(cost, 0, sizeof(cost));
+    memset(&total, 0, sizeof(total));
+
+    for (i = 0; (i < iterations) && (step == 0); i++)
+    {
+        step = bench_read(msg, cost, &err);
+    }
+
+    for (p = 0; p < PHASE_NUM; p++)
+    {
+        total.txrx     += cost[p].txrx;
+        total.timeouts += cost[p].timeouts;
+        total.txBytes  += cost[p].txBytes;
+        total.rxBytes  += cost[p].rxBytes;
+        total.spiBytes += cost[p].spiBytes;
+        total.airUs    += cost[p].airUs;
+        total.cpuUs    += cost[p].cpuUs;
+    }
+
+    printf("{\"tag\":\"%s\",\"model\":\"%s\",\"mem\":%u,\"msg\":%u,\"iterations\":%u,\"status\":",
+           ((bt->type == BENCH_T2T) ? "T2T" : ((bt->type == BENCH_T3T) ? "T3T" : ((bt->type == BENCH_T4T) ? "T4T" : "T5T"))),
+           bt->model, (unsigned)tag->dataLen, (unsigned)msgLen, i);
+    if (step == 0)
+    {
+        printf("\"ok\"");
+    }
+    else
+    {
+        printf("\"failed\",\"failed_phase\":\"%s\",\"err\":%d", ((step <= PHASE_NUM) ? phaseNames[step - 1] : "content"), (int)err);
+    }
+    for (p = 0; p < PHASE_NUM; p++)
+    {
+        printf(",");
+        print_cost(phaseNames[p], &cost[p], i);
+    }
+    printf(",");
+    print_cost("total", &total, i);
+    printf("}\n");
+
+    return (step == 0);
+}
+
+
+// Reads a T4T with the given FSD announced; returns false if a read failed.
+static bool bench_fsd_case(const benchTag *bt, uint32_t msgLen, rfalIsoDepFSxI fsdi, unsigned iterations)
+{
+    std::vector<uint8_t> msg = make_message(msgLen);
+    benchCost            cost[PHASE_NUM];
+    rfalIsoDepLinkStats  link;
+    tagFarmStats         s0;
+    tagFarmStats         s;
+    ndefStatus           err  = ERR_NONE;
+    int                  step = 0;
+    unsigned             i;
+
+    memset(cost, 0, sizeof(cost));
+    discParam.isoDepFS = fsdi;
+    rfalIsoDepPollClearLinkStats();
+    tag_farm_get_stats(&s0);
+
+    for (i = 0; (i < iterations) && (step == 0); i++)
+    {
+        step = bench_read(msg, cost, &err);
+    }
+
+    tag_farm_get_stats(&s);
+    rfalIsoDepPollGetLinkStats(&link);
+    discParam.isoDepFS = RFAL_ISODEP_FSXI_AUTO;
+
+    printf("{\"sweep\":\"fsd\",\"model\":\"%s\",\"msg\":%u,\"fsd\":%u,\"iterations\":%u,\"status\":\"%s\","
+           "\"iblocks_tx\":%u,\"iblocks_rx\":%u,\"round_trips\":%u,\"txrx\":%llu,\"air_us\":%llu}\n",
+           bt->model, (unsigned)msgLen, (unsigned)rfalIsoDepFSxI2FSx((uint8_t)fsdi), i, ((step == 0) ? "ok" : "failed"),
+           (unsigned)(link.iBlockTxCnt / i), (unsigned)(link.iBlockRxCnt / i), (unsigned)(link.roundTripCnt / i),
+           (unsigned long long)((s.txrx - s0.txrx) / i), (unsigned long long)((s.airUs - s0.airUs) / i));
+
+    return (step == 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned    iterations = 10;
+    const char *filter     = NULL;
+    bool        ok         = true;
+    int         opt;
+    size_t      t;
+    size_t      m;
+
+    for (opt = 1; opt < argc; opt++)
+    {
+        if ((strcmp(argv[opt], "-n") == 0) && ((opt + 1) < argc))
+        {
+            iterations = (unsigned)strtoul(argv[++opt], NULL, 0);
+        }
+        else if ((strcmp(argv[opt], "-t") == 0) && ((opt + 1) < argc))
+        {
+            filter = argv[++opt];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n iterations] [-t model]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (iterations == 0U)
+    {
+        iterations = 1U;
+    }
+
+    if (rfalNfcInitialize() != RFAL_ERR_NONE)
+    {
+        fprintf(stderr, "rfalNfcInitialize failed\n");
+        return 2;
+    }
+    tag_farm_disc_params(&discParam, (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F | RFAL_NFC_POLL_TECH_V));
+
+    for (t = 0; t < (sizeof(benchTags) / sizeof(benchTags[0])); t++)
+    {
+        const benchTag *bt = &benchTags[t];
+        tagFarmTag      tag;
+
+        if ((filter != NULL) && (strstr(bt->model, filter) == NULL))
+        {
+            continue;
+        }
+
+        create_tag(bt, &tag);
+        tag_farm_place(&tag);
+        for (m = 0; m < (sizeof(benchMsgLens) / sizeof(benchMsgLens[0])); m++)
+        {
+            std::vector<uint8_t> msg = make_message(benchMsgLens[m]);
+
+            if (!tag.ops->load(&tag, msg.data(), (uint32_t)msg.size()))
+            {
+                continue;       // Does not fit
+            }
+            ok = (bench_case(bt, &tag, benchMsgLens[m], iterations) && ok);
+        }
+        tag_farm_place(NULL);
+        tag_farm_free(&tag);
+    }
+
+    // FSD sweep: each T4T model with the largest message of the matrix that fits
+    for (t = 0; t < (sizeof(benchTags) / sizeof(benchTags[0])); t++)
+    {
+        const benchTag *bt     = &benchTags[t];
+        uint32_t        msgLen = 0;
+        tagFarmTag      tag;
+
+        if ((bt->type != BENCH_T4T) || ((filter != NULL) && (strstr(bt->model, filter) == NULL)))
+        {
+            continue;
+        }
+
+        create_tag(bt, &tag);
+        tag_farm_place(&tag);
+        for (m = 0; m < (sizeof(benchMsgLens) / sizeof(benchMsgLens[0])); m++)
+        {
+            std::vector<uint8_t> msg = make_message(benchMsgLens[m]);
+
+            if (tag.ops->load(&tag, msg.data(), (uint32_t)msg.size()))
+            {
+                msgLen = benchMsgLens[m];
+            }
+        }
+        if (msgLen != 0U)
+        {
+            std::vector<uint8_t> msg = make_message(msgLen);
+
+            tag.ops->load(&tag, msg.data(), (uint32_t)msg.size());
+            for (m = 0; m < (sizeof(benchFsdis) / sizeof(benchFsdis[0])); m++)
+            {
+                ok = (bench_fsd_case(bt, msgLen, benchFsdis[m], iterations) && ok);
+            }
+        }
+        tag_farm_place(NULL);
+        tag_farm_free(&tag);
+    }
+
+    return (ok ? 0 : 1);
+}
@@ -0,0 +1,346 @@
+/**
+ * @file ndef_ce_test.cpp
+ *
+ * @brief Host test of the card emulation engines (src/ndef/ce): the NDEF pollers of the stack read and
+ *        write an emulated tag over the simulated link (tools/tag_farm), no RF involved.
+ *
+ * T4T: a Type 4A tag of the tag farm, its NDEF Tag Application replaced by ndefT4TCeProcess()
+ * (tag_t4t_set_applet()), so the C-APDUs are the ones the T4T NDEF Poller sends to a real tag, through
+ * ISO-DEP. Cases:
+ *  - write_read: ndefPollerWriteRawMessage() of a message, then ndefPollerNdefDetect() and
+ *    ndefPollerReadRawMessage(), for message lengths up to the NDEF file size;
+ *  - read_only:  the write refused by a read only NDEF file, the message read unchanged;
+ *  - unknown_aid: SELECT of another application refused.
+ *
+ * T3T: an NFC-F tag model answering through ndefT3TCeProcess(), activated by the link as any T3T, so
+ * the CHECK/UPDATE frames are the ones the T3T NDEF Poller sends. Cases:
+ *  - write_read, read_only: as for the T4T, message lengths up to the NDEF blocks of the image;
+ *  - out_of_range: CHECK of a block beyond the image refused;
+ *  - other_nfcid2: CHECK to another NFCID2 not answered.
+ *
+ * One JSON line is printed per case: the status, the commands processed by the engine and the
+ * transceives on the link. The exit code is 1 if any case failed.
+ *
+ * Build:  gcc -std=gnu99 -c -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 \
+ *             tools/tag_farm/tag_*.c tools/tag_farm/rfal_rf_sim.c src/rfal_platform/pltf_timer.c \
+ *             src/rfal_core/rfal_{nfc,isoDep,nfcDep,nfca,nfcb,nfcf,nfcv,t1t,t2t,t4t,st25xv,crc,stats,dpo,cd,analogConfig,trace}.c \
+ *             src/ndef/poller/ndef_*.c src/ndef/message/ndef_*.c src/ndef/ce/ndef_*.c
+ *         g++ -std=c++17 -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 tools/ndef_ce_test/ndef_ce_test.cpp *.o -o ndef_ce_test
+ * Usage:  ndef_ce_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "rfal_nfc.h"
+#include "rfal_t4t.h"
+#include "ndef_poller.h"
+#include "ndef_t4t_ce.h"
+#include "ndef_t3t_ce.h"
+}
+
+#include "tag_farm.h"
+
+
+#define CE_T4T_FILE_LEN         1024U   // Emulated T4T NDEF file size, NLEN included
+#define CE_T3T_BLOCKS             64U   // Emulated T3T blocks, AIB included
+#define CE_BUF_LEN              2048U   // Largest message written or read back
+
+
+/*** LOCAL VARIABLES ***/
+
+static const uint8_t        ceDefaultMessage[] = { 0xD1, 0x01, 0x07, 'U', 0x02, 's', 't', '.', 'c', 'o', 'm' };   // URI record "https://www.st.com"
+static const uint32_t       ceMsgLens[]        = { 11U, 200U, 255U, 256U, (CE_T4T_FILE_LEN - NDEF_T4T_CE_NLEN_LEN) };
+static const uint32_t       ceT3tMsgLens[]     = { 11U, 200U, ((CE_T3T_BLOCKS - 1U) * NDEF_T3T_CE_BLOCK_LEN) };
+static const uint8_t        ceFelica[]         = { 0x02, 0xFE };    // NFCID2 of an NFC-F tag: 02FEh
+
+static ndefT4tCeContext     t4tCe;
+static uint8_t              t4tCeFile[CE_T4T_FILE_LEN];
+static ndefT3tCeContext     t3tCe;
+static uint8_t              t3tCeImage[CE_T3T_BLOCKS * NDEF_T3T_CE_BLOCK_LEN];
+static uint8_t              msgBuf[CE_BUF_LEN];
+static uint8_t              readBuf[CE_BUF_LEN];
+static rfalNfcDiscoverParam discParam;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+// Message of len bytes: a single short/long MB ME record of an unknown type, payload pattern depending on len.
+static uint32_t make_message(uint32_t len)
+{
+    uint32_t hdr = ((len - 3U) <= 255U) ? 3U : 6U;
+    uint32_t pay = (len - hdr);
+    uint32_t i;
+
+    if (hdr == 3U)
+    {
+        msgBuf[0] = 0xD5;                       // MB ME SR, TNF unknown
+        msgBuf[2] = (uint8_t)pay;
+    }
+    else
+    {
+        msgBuf[0] = 0xC5;                       // MB ME, TNF unknown
+        msgBuf[2] = (uint8_t)(pay >> 24);
+        msgBuf[3] = (uint8_t)(pay >> 16);
+        msgBuf[4] = (uint8_t)(pay >> 8);
+        msgBuf[5] = (uint8_t)pay;
+    }
+    msgBuf[1] = 0x00;                           // Type length
+    for (i = 0; i < pay; i++)
+    {
+        msgBuf[hdr + i] = (uint8_t)((i * 7U) + len);
+    }
+    return len;
+}
+
+
+static uint16_t t4t_ce_applet(void *ctx, const uint8_t *capdu, uint16_t capduLen, uint8_t *rapdu, uint16_t rapduMax)
+{
+    uint16_t rapduLen = 0;
+
+    (void)ndefT4TCeProcess((ndefT4tCeContext *)ctx, capdu, capduLen, rapdu, rapduMax, &rapduLen);
+    return rapduLen;
+}
+
+
+// T3T model: the frame handed to the engine with its LEN byte, as the Listener receives it.
+static bool t3t_ce_command(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    uint8_t  frame[RFAL_NFCF_LENGTH_LEN + 255U];
+    uint16_t resLen = 0;
+
+    (void)tag;
+
+    if (reqLen > (sizeof(frame) - RFAL_NFCF_LENGTH_LEN))
+    {
+        return false;
+    }
+    frame[0] = (uint8_t)(reqLen + RFAL_NFCF_LENGTH_LEN);
+    memcpy(&frame[RFAL_NFCF_LENGTH_LEN], req, reqLen);
+
+    (void)ndefT3TCeProcess(&t3tCe, frame, (uint16_t)(reqLen + RFAL_NFCF_LENGTH_LEN), res, resMax, &resLen);
+    *resBits = (uint16_t)(resLen * 8U);
+    return (resLen != 0U);
+}
+
+
+static const tagFarmOps t3tCeOps = { t3t_ce_command, NULL, NULL, NULL };
+
+
+// Same frames the T3T NDEF Poller sends: one Service, consecutive blocks, 2 byte Block List Elements up to block FFh.
+static uint16_t t3t_frame(uint8_t *req, rfalNfcfServ serv, uint16_t blockNum, uint8_t nbBlocks, const uint8_t *nfcid2)
+{
+    rfalNfcfBlockListElem      listBlocks[NDEF_T3T_CE_NBR];
+    rfalNfcfServBlockListParam servBlock;
+    uint16_t                   txLen = 0;
+    uint8_t                    i;
+
+    for (i = 0U; i < nbBlocks; i++)
+    {
+        listBlocks[i].blockNum = (uint16_t)(blockNum + i);
+        listBlocks[i].conf     = ((listBlocks[i].blockNum > 0xFFU) ? 0U : RFAL_NFCF_BLOCKLISTELEM_LEN_BIT);
+    }
+    servBlock.numServ   = 1U;
+    servBlock.servList  = &serv;
+    servBlock.numBlock  = nbBlocks;
+    servBlock.blockList = listBlocks;
+
+    rfalNfcfPollerComposeCheck(nfcid2, &servBlock, &req[RFAL_NFCF_LENGTH_LEN], RFAL_NFCF_CHECK_REQ_MAX_LEN, &txLen);
+    req[0] = (uint8_t)(txLen + RFAL_NFCF_LENGTH_LEN);
+    return (uint16_t)(txLen + RFAL_NFCF_LENGTH_LEN);
+}
+
+
+static void print_case(const char *tag, const char *name, uint32_t msgLen, const char *fail, uint32_t cmds, const tagFarmStats *s)
+{
+    printf("{\"tag\":\"%s\",\"case\":\"%s\",\"msg\":%u,\"status\":", tag, name, (unsigned)msgLen);
+    if (fail == NULL)
+    {
+        printf("\"ok\"");
+    }
+    else
+    {
+        printf("\"failed\",\"failed_step\":\"%s\"", fail);
+    }
+    printf(",\"cmds\":%u,\"txrx\":%u,\"air_us\":%u}\n", (unsigned)cmds, (unsigned)s->txrx, (unsigned)s->airUs);
+}
+
+
+// Writes msgLen bytes then reads the message back. Returns the step that failed, NULL if none.
+static const char *write_read(uint32_t msgLen, bool writeRefused)
+{
+    rfalNfcDevice *dev;
+    ndefContext    ctx;
+    ndefInfo       info;
+    const uint8_t *expect    = msgBuf;
+    uint32_t       expectLen = msgLen;
+    uint32_t       readLen   = 0;
+    const char    *fail      = NULL;
+
+    if (!tag_farm_discover(&discParam, &dev))
+    {
+        fail = "discover";
+    }
+    else if ((ndefPollerContextInitialization(&ctx, dev) != ERR_NONE) || (ndefPollerNdefDetect(&ctx, &info) != ERR_NONE))
+    {
+        fail = "detect";
+    }
+    else if ((ndefPollerWriteRawMessage(&ctx, msgBuf, msgLen) == ERR_NONE) == writeRefused)
+    {
+        fail = "write";
+    }
+    else
+    {
+        if (writeRefused)
+        {
+            expect    = ceDefaultMessage;
+            expectLen = sizeof(ceDefaultMessage);
+        }
+        if ((ndefPollerNdefDetect(&ctx, &info) != ERR_NONE) ||
+            (ndefPollerReadRawMessage(&ctx, readBuf, sizeof(readBuf), &readLen, true) != ERR_NONE) ||
+            (readLen != expectLen) || (memcmp(readBuf, expect, readLen) != 0))
+        {
+            fail = "read";
+        }
+    }
+
+    rfalNfcDeactivate(RFAL_NFC_DEACTIVATE_IDLE);
+    return fail;
+}
+
+
+static bool t4t_case(const char *name, uint32_t msgLen, bool readOnly)
+{
+    static const uint8_t    aidOther[] = { 0xE1, 0x03 };
+    static rfalIsoDepApduBufFormat cApdu;
+    static uint8_t          rApdu[NDEF_T4T_CE_MLE + NDEF_T4T_CE_SW_LEN];
+    tagFarmTag              tag;
+    tagFarmStats            s;
+    uint16_t                cApduLen;
+    uint16_t                rApduLen;
+    const char             *fail = NULL;
+
+    // A read only image is written beforehand (e.g. in Flash), the engine then only reads it
+    ndefT4TCeInit(&t4tCe, t4tCeFile, sizeof(t4tCeFile), false);
+    ndefT4TCeSetMessage(&t4tCe, ceDefaultMessage, sizeof(ceDefaultMessage));
+    ndefT4TCeInit(&t4tCe, t4tCeFile, sizeof(t4tCeFile), readOnly);
+
+    tag_t4t_init(&tag, "T4T CE", CE_T4T_FILE_LEN, NDEF_T4T_CE_MLE, NDEF_T4T_CE_MLC);
+    tag_t4t_set_applet(&tag, t4t_ce_applet, &t4tCe);
+    tag_farm_place(&tag);
+    tag_farm_reset_stats();
+
+    if (msgLen != 0U)
+    {
+        fail = write_read(make_message(msgLen), readOnly);
+    }
+    else
+    {
+        // Not through the link: a C-APDU the T4T NDEF Poller does not send
+        rfalT4TPollerComposeSelectAppl(&cApdu, aidOther, sizeof(aidOther), &cApduLen);
+        rApduLen = t4t_ce_applet(&t4tCe, cApdu.apdu, cApduLen, rApdu, sizeof(rApdu));
+        if ((rApduLen != NDEF_T4T_CE_SW_LEN) || (((rApdu[0] << 8) | rApdu[1]) == RFAL_T4T_ISO7816_STATUS_COMPLETE))
+        {
+            fail = "select";
+        }
+    }
+
+    tag_farm_get_stats(&s);
+    tag_farm_place(NULL);
+    tag_farm_free(&tag);
+
+    print_case("T4T", name, msgLen, fail, t4tCe.stats.cmdCnt, &s);
+    return (fail == NULL);
+}
+
+
+// msgLen 0: frames the T3T NDEF Poller does not send, not through the link.
+static bool t3t_case(const char *name, uint32_t msgLen, bool readOnly)
+{
+    static uint8_t  req[RFAL_NFCF_LENGTH_LEN + RFAL_NFCF_CHECK_REQ_MAX_LEN];
+    static uint8_t  rsp[NDEF_T3T_CE_RSP_MAX_LEN];
+    const uint8_t   otherNfcid2[NDEF_T3T_CE_NFCID2_LEN] = { 0x02, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    tagFarmTag      tag;
+    tagFarmStats    s;
+    uint16_t        reqLen;
+    uint16_t        rspLen = 0;
+    const char     *fail   = NULL;
+
+    tag_farm_init(&tag, "T3T CE", TAG_FARM_TECH_NFCF, &t3tCeOps, ceFelica, sizeof(ceFelica), NDEF_T3T_CE_NFCID2_LEN, 0U);
+    tag.sysCode = 0x12FCU;
+
+    ndefT3TCeInit(&t3tCe, t3tCeImage, CE_T3T_BLOCKS, tag.uid, readOnly);
+    ndefT3TCeSetMessage(&t3tCe, ceDefaultMessage, sizeof(ceDefaultMessage));
+
+    tag_farm_place(&tag);
+    tag_farm_reset_stats();
+
+    if (msgLen != 0U)
+    {
+        fail = write_read(make_message(msgLen), readOnly);
+    }
+    else if (strcmp(name, "out_of_range") == 0)
+    {
+        reqLen = t3t_frame(req, RFAL_NFCF_SERVICECODE_RDONLY, CE_T3T_BLOCKS, 1U, tag.uid);
+        (void)ndefT3TCeProcess(&t3tCe, req, reqLen, rsp, sizeof(rsp), &rspLen);
+        if ((rspLen != NDEF_T3T_CE_HDR_LEN) || (rsp[RFAL_NFCF_CHECKUPDATE_RES_ST1_POS] == RFAL_NFCF_STATUS_FLAG_SUCCESS))
+        {
+            fail = "check";
+        }
+    }
+    else
+    {
+        reqLen = t3t_frame(req, RFAL_NFCF_SERVICECODE_RDONLY, 1U, 1U, otherNfcid2);
+        (void)ndefT3TCeProcess(&t3tCe, req, reqLen, rsp, sizeof(rsp), &rspLen);
+        if (rspLen != 0U)
+        {
+            fail = "check";
+        }
+    }
+
+    tag_farm_get_stats(&s);
+    tag_farm_place(NULL);
+    tag_farm_free(&tag);
+
+    print_case("T3T", name, msgLen, fail, t3tCe.stats.cmdCnt, &s);
+    return (fail == NULL);
+}
+
+
+int main(int argc, char *argv[])
+{
+    bool   ok = true;
+    size_t i;
+
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 2;
+    }
+
+    if (rfalNfcInitialize() != RFAL_ERR_NONE)
+    {
+        fprintf(stderr, "rfalNfcInitialize failed\n");
+        return 2;
+    }
+    tag_farm_disc_params(&discParam, (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_F));
+
+    for (i = 0; i < (sizeof(ceMsgLens) / sizeof(ceMsgLens[0])); i++)
+    {
+        ok = (t4t_case("write_read", ceMsgLens[i], false) && ok);
+    }
+    ok = (t4t_case("read_only", 200U, true) && ok);
+    ok = (t4t_case("unknown_aid", 0U, false) && ok);
+
+    for (i = 0; i < (sizeof(ceT3tMsgLens) / sizeof(ceT3tMsgLens[0])); i++)
+    {
+        ok = (t3t_case("write_read", ceT3tMsgLens[i], false) && ok);
+    }
+    ok = (t3t_case("read_only", 200U, true) && ok);
+    ok = (t3t_case("out_of_range", 0U, false) && ok);
+    ok = (t3t_case("other_nfcid2", 0U, false) && ok);
+
+    return (ok ? 0 : 1);
+}
@@ -0,0 +1,493 @@
+/**
+ * @file ndef_provision.cpp
+ *
+ * @brief Host simulation of a provisioning line: one templated NDEF message written to a batch of
+ *        simulated tags (tools/tag_farm), tags/minute per tag model.
+ *
+ * The message is an URI record carrying the UID of the tag ("https://example.com/t/<UID hex>") and
+ * a Text record carrying a serial number, padded to the message lengths below. Each tag of a batch
+ * is a new tag (new UID) placed in the field, then: rfalNfcDiscover() up to the activation,
+ * ndefPollerContextInitialization(), ndefPollerNdefDetect() and the write, in two modes:
+ *  - message: the records are built for the tag and written by ndefPollerWriteMessage(), as today;
+ *  - image:   the message is encoded once (ndefPollerProvisionInit()), the UID and serial patched
+ *             at the offsets of their placeholders, and ndefPollerProvisionWrite() streams it.
+ * And the update of a provisioned tag, its serial number incremented (tag provisioned before the
+ * case by ndefPollerWriteMessage(), outside of the costs), in three modes:
+ *  - rewrite:   the new message written in full by ndefPollerWriteRawMessage();
+ *  - diff:      ndefPollerWriteRawMessageDiff(), the current message known by the line (cached);
+ *  - diff_read: ndefPollerWriteRawMessageDiff(), the current message read from the tag.
+ * The message is read back after the write, outside of the costs, and must be the one expected.
+ *
+ * One JSON line is printed per case, the costs averaged per tag: transceives, timeouts, bytes sent
+ * and received, air time (modelled by the link, see tools/tag_farm/rfal_rf_sim.c), host CPU time,
+ * and the tags per minute that the air time allows (tag handling on the line excluded). The diff
+ * modes add the blocks of the message and the blocks written. The exit code is 1 if any tag failed.
+ *
+ * Build:  gcc -std=gnu99 -c -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 \
+ *             tools/tag_farm/tag_*.c tools/tag_farm/rfal_rf_sim.c src/rfal_platform/pltf_timer.c \
+ *             src/rfal_core/rfal_{nfc,isoDep,nfcDep,nfca,nfcb,nfcf,nfcv,t1t,t2t,t4t,st25xv,crc,stats,dpo,cd,analogConfig,trace}.c \
+ *             src/ndef/poller/ndef_*.c src/ndef/message/ndef_*.c
+ *         g++ -std=c++17 -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 tools/ndef_provision/ndef_provision.cpp *.o -o ndef_provision
+ * Usage:  ndef_provision [-n tags] [-t model]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+extern "C" {
+#include "rfal_nfc.h"
+#include "ndef_poller.h"
+#include "ndef_message.h"
+#include "ndef_record.h"
+#include "ndef_types.h"
+#include "ndef_type_uri.h"
+#include "ndef_type_text.h"
+}
+
+#include "tag_farm.h"
+
+
+#define PROV_BUF_LEN            2048    // Largest message written or read back
+#define PROV_UID_HEX              16U   // UID placeholder: 8 bytes in hex, left padded with '0'
+#define PROV_SERIAL_LEN            8U   // Serial placeholder: 8 decimal digits
+
+static const char provUidMark[]    = "################";
+static const char provSerialMark[] = "$$$$$$$$";
+
+
+/*** Tag models of the line ***/
+typedef enum
+{
+    PROV_T2T,
+    PROV_T3T,
+    PROV_T4T,
+    PROV_T5T
+} provType;
+
+typedef struct
+{
+    const char *model;
+    provType    type;
+    uint16_t    a;                      // T2T: user memory, T3T: blocks, T4T: file size, T5T: blocks
+    uint16_t    b;                      // T3T: Nbr, T4T: MLe, T5T: block length
+    uint16_t    c;                      // T3T: Nbw, T4T: MLc, T5T: manufacturer code
+    uint8_t     features;               // T5T: TAG_T5T_ commands answered
+} provTag;
+
+#define PROV_ST25DV             (TAG_T5T_WRITE_MULTIPLE | TAG_T5T_FAST | TAG_T5T_MAILBOX)
+#define PROV_ST25DV_EXT         (PROV_ST25DV | TAG_T5T_EXTENDED)
+
+static const provTag provTags[] =
+{
+    { "NTAG213",          PROV_T2T,  144U,   0U,    0U,               0U },
+    { "NTAG216",          PROV_T2T,  888U,   0U,    0U,               0U },
+    { "FeliCa Lite-S",    PROV_T3T,   13U,   4U,    1U,               0U },
+    { "T3T 1K",           PROV_T3T,   64U,   8U,    4U,               0U },
+    { "T4T 1K",           PROV_T4T, 1024U, 255U,  255U,               0U },
+    { "T4T 1K MLc 128",   PROV_T4T, 1024U, 255U,  128U,               0U },
+    { "ICODE SLIX",       PROV_T5T,   28U,   4U, 0x04U,               0U },
+    { "ST25DV04K",        PROV_T5T,  128U,   4U, 0x02U, PROV_ST25DV     },
+    { "ST25DV64K",        PROV_T5T, 2048U,   4U, 0x02U, PROV_ST25DV_EXT },
+};
+
+static const uint32_t provPadLens[] = { 0U, 64U, 400U };     // Text padding: message lengths of a case
+
+typedef enum
+{
+    MODE_MESSAGE,
+    MODE_IMAGE,
+    MODE_REWRITE,
+    MODE_DIFF,
+    MODE_DIFF_READ,
+    MODE_NUM
+} provMode;
+
+static const char *modeNames[MODE_NUM] = { "message", "image", "rewrite", "diff", "diff_read" };
+
+typedef struct
+{
+    std::string uri;
+    std::string txt;
+    ndefType    typeUri;
+    ndefType    typeTxt;
+    ndefRecord  recUri;
+    ndefRecord  recTxt;
+    ndefMessage message;
+} provMessage;
+
+typedef struct
+{
+    uint64_t txrx;
+    uint64_t timeouts;
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    uint64_t airUs;
+    uint64_t cpuUs;
+    uint64_t blocks;                    // Diff modes: blocks of the message
+    uint64_t written;                   // Diff modes: blocks written
+} provCost;
+
+
+/*** LOCAL VARIABLES ***/
+
+static uint8_t              imageBuf[PROV_BUF_LEN];
+static uint8_t              readBuf[PROV_BUF_LEN];
+static uint8_t              expectBuf[PROV_BUF_LEN];
+static uint8_t              msgBuf[PROV_BUF_LEN];
+static uint8_t              curBuf[PROV_BUF_LEN];
+static rfalNfcDiscoverParam discParam;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static void create_tag(const provTag *pt, tagFarmTag *tag)
+{
+    switch (pt->type)
+    {
+        case PROV_T2T: tag_t2t_init(tag, pt->model, pt->a); break;
+        case PROV_T3T: tag_t3t_init(tag, pt->model, pt->a, (uint8_t)pt->b, (uint8_t)pt->c); break;
+        case PROV_T4T: tag_t4t_init(tag, pt->model, pt->a, pt->b, pt->c); break;
+        default:       tag_t5t_init(tag, pt->model, (uint8_t)pt->c, pt->a, (uint8_t)pt->b, pt->features); break;
+    }
+}
+
+
+// Templated field values of a tag: UID in hex, serial in decimal.
+static std::string uid_field(const rfalNfcDevice *dev)
+{
+    char    hex[(2U * PROV_UID_HEX) + 1U];
+    uint8_t i;
+    size_t  len;
+
+    for (i = 0; i < dev->nfcidLen; i++)
+    {
+        snprintf(&hex[2U * i], 3U, "%02X", dev->nfcid[i]);
+    }
+    len = (2U * dev->nfcidLen);
+    return ((len < PROV_UID_HEX) ? (std::string(PROV_UID_HEX - len, '0') + std::string(hex, len)) : std::string(hex, PROV_UID_HEX));
+}
+
+
+static std::string serial_field(uint32_t serial)
+{
+    char dec[16];
+
+    snprintf(dec, sizeof(dec), "%0*u", (int)PROV_SERIAL_LEN, (unsigned)(serial % 100000000U));
+    return std::string(dec);
+}
+
+
+// Message of a tag: URI record, then Text record padded by pad bytes. The records point to the strings.
+static ndefStatus make_message(provMessage *pm, const std::string &uid, const std::string &serial, uint32_t pad)
+{
+    static const uint8_t lang[] = { 'e', 'n' };
+    ndefConstBuffer      bufUri;
+    ndefConstBuffer8     bufLang = { lang, sizeof(lang) };
+    ndefConstBuffer      bufTxt;
+    ndefStatus           err;
+
+    pm->uri       = "example.com/t/" + uid;
+    pm->txt       = "SN " + serial + std::string(pad, '.');
+    bufUri.buffer = (const uint8_t *)pm->uri.data();
+    bufUri.length = (uint32_t)pm->uri.size();
+    bufTxt.buffer = (const uint8_t *)pm->txt.data();
+    bufTxt.length = (uint32_t)pm->txt.size();
+
+    err = ndefRtdUriInit(&pm->typeUri, NDEF_URI_PREFIX_HTTPS, &bufUri);
+    err = ((err == ERR_NONE) ? ndefRtdUriToRecord(&pm->typeUri, &pm->recUri) : err);
+    err = ((err == ERR_NONE) ? ndefRtdTextInit(&pm->typeTxt, TEXT_ENCODING_UTF8, &bufLang, &bufTxt) : err);
+    err = ((err == ERR_NONE) ? ndefRtdTextToRecord(&pm->typeTxt, &pm->recTxt) : err);
+    err = ((err == ERR_NONE) ? ndefMessageInit(&pm->message) : err);
+    err = ((err == ERR_NONE) ? ndefMessageAppend(&pm->message, &pm->recUri) : err);
+    return ((err == ERR_NONE) ? ndefMessageAppend(&pm->message, &pm->recTxt) : err);
+}
+
+
+// Encoded message of a tag, as expected on the tag after the write.
+static ndefStatus encode_message(const std::string &uid, const std::string &serial, uint32_t pad, uint8_t *buf, uint32_t *len)
+{
+    provMessage pm;
+    ndefBuffer  bufOut = { buf, *len };
+    ndefStatus  err;
+
+    err  = make_message(&pm, uid, serial, pad);
+    err  = ((err == ERR_NONE) ? ndefMessageEncode(&pm.message, &bufOut) : err);
+    *len = bufOut.length;
+    return err;
+}
+
+
+static void cost_add(provCost *cost, const tagFarmStats *s0, uint32_t cpu0)
+{
+    uint32_t     cpu = tag_farm_cpu_us();
+    tagFarmStats s;
+
+    tag_farm_get_stats(&s);
+    cost->txrx     += (s.txrx     - s0->txrx);
+    cost->timeouts += (s.timeouts - s0->timeouts);
+    cost->txBytes  += (s.txBytes  - s0->txBytes);
+    cost->rxBytes  += (s.rxBytes  - s0->rxBytes);
+    cost->airUs    += (s.airUs    - s0->airUs);
+    cost->cpuUs    += (cpu - cpu0);
+}
+
+
+// Update modes: the new message written over the message of prevSerial.
+static ndefStatus update(ndefContext *ctx, provMode mode, const std::string &uid, uint32_t serial, uint32_t prevSerial,
+                         uint32_t pad, provCost *cost)
+{
+    ndefDiffStats ds;
+    uint32_t      msgLen = sizeof(msgBuf);
+    uint32_t      curLen = 0U;
+    ndefStatus    err;
+
+    err = encode_message(uid, serial_field(serial), pad, msgBuf, &msgLen);
+    if (err != ERR_NONE)
+    {
+        return err;
+    }
+    if (mode == MODE_REWRITE)
+    {
+        return ndefPollerWriteRawMessage(ctx, msgBuf, msgLen);
+    }
+    if (mode == MODE_DIFF)
+    {
+        curLen = sizeof(curBuf);
+        err    = encode_message(uid, serial_field(prevSerial), pad, curBuf, &curLen);
+    }
+    err = ((err == ERR_NONE) ? ndefPollerWriteRawMessageDiff(ctx, msgBuf, msgLen, ((mode == MODE_DIFF) ? curBuf : NULL), curLen, &ds) : err);
+    if (err == ERR_NONE)
+    {
+        cost->blocks  += ds.blocks;
+        cost->written += ds.written;
+    }
+    return err;
+}
+
+
+// Provisions the tag in the field. Returns 0, or the step that failed (1 discover .. 4 write, 5 content).
+static int provision(provMode mode, ndefProvisionImage *image, const uint32_t offsets[2], uint32_t serial, uint32_t prevSerial,
+                     uint32_t pad, provCost *cost, ndefStatus *err)
+{
+    rfalNfcDevice *dev;
+    ndefContext    ctx;
+    ndefInfo       info;
+    tagFarmStats   s;
+    uint32_t       cpu;
+    uint32_t       expectLen = sizeof(expectBuf);
+    uint32_t       readLen   = 0;
+    std::string    uid;
+    std::string    sn = serial_field(serial);
+    int            step = 0;
+
+    *err = ERR_NONE;
+    tag_farm_get_stats(&s);
+    cpu = tag_farm_cpu_us();
+
+    if (!tag_farm_discover(&discParam, &dev))
+    {
+        step = 1;
+        goto deactivate;
+    }
+    *err = ndefPollerContextInitialization(&ctx, dev);
+    if (*err != ERR_NONE)
+    {
+        step = 2;
+        goto deactivate;
+    }
+    *err = ndefPollerNdefDetect(&ctx, &info);
+    if (*err != ERR_NONE)
+    {
+        step = 3;
+        goto deactivate;
+    }
+
+    uid = uid_field(dev);
+    if (mode == MODE_IMAGE)
+    {
+        (void)ndefPollerProvisionPatch(image, offsets[0], (const uint8_t *)uid.data(), PROV_UID_HEX);
+        (void)ndefPollerProvisionPatch(image, offsets[1], (const uint8_t *)sn.data(), PROV_SERIAL_LEN);
+        *err = ndefPollerProvisionWrite(&ctx, image);
+    }
+    else if (mode != MODE_MESSAGE)
+    {
+        *err = update(&ctx, mode, uid, serial, prevSerial, pad, cost);
+    }
+    else
+    {
+        provMessage pm;
+
+        *err = make_message(&pm, uid, sn, pad);
+        *err = ((*err == ERR_NONE) ? ndefPollerWriteMessage(&ctx, &pm.message) : *err);
+    }
+    cost_add(cost, &s, cpu);
+    if (*err != ERR_NONE)
+    {
+        step = 4;
+        goto deactivate;
+    }
+
+    // Read back, outside of the costs
+    if ((encode_message(uid, sn, pad, expectBuf, &expectLen) != ERR_NONE) ||
+        (ndefPollerNdefDetect(&ctx, &info) != ERR_NONE) ||
+        (ndefPollerReadRawMessage(&ctx, readBuf, sizeof(readBuf), &readLen, true) != ERR_NONE) ||
+        (readLen != expectLen) || (memcmp(readBuf, expectBuf, readLen) != 0))
+    {
+        step = 5;
+    }
+
+deactivate:
+    rfalNfcDeactivate(RFAL_NFC_DEACTIVATE_IDLE);
+    return step;
+}
+
+
+// Runs a case: a batch of new tags of the model. Returns false if a tag failed.
+static bool prov_case(const provTag *pt, provMode mode, uint32_t pad, unsigned tags, uint32_t *serial)
+{
+    static const char  *stepNames[] = { "discover", "init", "detect", "write", "content" };
+    ndefProvisionImage  image;
+    uint32_t            offsets[2] = { 0U, 0U };
+    uint32_t            msgLen     = sizeof(expectBuf);
+    provCost            cost;
+    provCost            setup;
+    ndefStatus          err  = ERR_NONE;
+    int                 step = 0;
+    unsigned            i;
+
+    memset(&cost, 0, sizeof(cost));
+    memset(&setup, 0, sizeof(setup));
+
+    // Encoded once per batch, placeholders located once
+    if (mode == MODE_IMAGE)
+    {
+        provMessage pm;
+
+        if ((make_message(&pm, provUidMark, provSerialMark, pad) != ERR_NONE) ||
+            (ndefPollerProvisionInit(&image, imageBuf, sizeof(imageBuf), &pm.message) != ERR_NONE) ||
+            (ndefPollerProvisionFind(&image, (const uint8_t *)provUidMark, PROV_UID_HEX, &offsets[0]) != ERR_NONE) ||
+            (ndefPollerProvisionFind(&image, (const uint8_t *)provSerialMark, PROV_SERIAL_LEN, &offsets[1]) != ERR_NONE))
+        {
+            return false;
+        }
+    }
+    if (encode_message(provUidMark, provSerialMark, pad, expectBuf, &msgLen) != ERR_NONE)
+    {
+        return false;
+    }
+
+    for (i = 0; (i < tags) && (step == 0); i++)
+    {
+        tagFarmTag tag;
+
+        create_tag(pt, &tag);
+        tag_farm_place(&tag);
+        if (mode >= MODE_REWRITE)
+        {
+            // Provisioned tag, then its serial incremented
+            step = provision(MODE_MESSAGE, &image, offsets, *serial, 0U, pad, &setup, &err);
+            (*serial)++;
+        }
+        step = ((step == 0) ? provision(mode, &image, offsets, *serial, (*serial - 1U), pad, &cost, &err) : step);
+        (*serial)++;
+        tag_farm_place(NULL);
+        tag_farm_free(&tag);
+    }
+
+    printf("{\"tag\":\"%s\",\"model\":\"%s\",\"msg\":%u,\"mode\":\"%s\",\"tags\":%u,\"status\":",
+           ((pt->type == PROV_T2T) ? "T2T" : ((pt->type == PROV_T3T) ? "T3T" : ((pt->type == PROV_T4T) ? "T4T" : "T5T"))),
+           pt->model, (unsigned)msgLen, modeNames[mode], i);
+    if (step == 0)
+    {
+        printf("\"ok\"");
+    }
+    else
+    {
+        printf("\"failed\",\"failed_step\":\"%s\",\"err\":%d", stepNames[step - 1], (int)err);
+    }
+    printf(",\"txrx\":%llu,\"timeouts\":%llu,\"tx_bytes\":%llu,\"rx_bytes\":%llu,\"air_us\":%llu,\"cpu_us\":%llu,\"tags_per_min\":%.1f",
+           (unsigned long long)(cost.txrx / i), (unsigned long long)(cost.timeouts / i),
+           (unsigned long long)(cost.txBytes / i), (unsigned long long)(cost.rxBytes / i),
+           (unsigned long long)(cost.airUs / i), (unsigned long long)(cost.cpuUs / i),
+           ((cost.airUs != 0U) ? ((60000000.0 * i) / (double)cost.airUs) : 0.0));
+    if ((mode == MODE_DIFF) || (mode == MODE_DIFF_READ))
+    {
+        printf(",\"blocks\":%llu,\"blocks_written\":%llu", (unsigned long long)(cost.blocks / i), (unsigned long long)(cost.written / i));
+    }
+    printf("}\n");
+
+    return (step == 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned    tags   = 20;
+    const char *filter = NULL;
+    uint32_t    serial = 1U;
+    bool        ok     = true;
+    int         opt;
+    size_t      t;
+    size_t      p;
+    int         m;
+
+    for (opt = 1; opt < argc; opt++)
+    {
+        if ((strcmp(argv[opt], "-n") == 0) && ((opt + 1) < argc))
+        {
+            tags = (unsigned)strtoul(argv[++opt], NULL, 0);
+        }
+        else if ((strcmp(argv[opt], "-t") == 0) && ((opt + 1) < argc))
+        {
+            filter = argv[++opt];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n tags] [-t model]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (tags == 0U)
+    {
+        tags = 1U;
+    }
+
+    if (rfalNfcInitialize() != RFAL_ERR_NONE)
+    {
+        fprintf(stderr, "rfalNfcInitialize failed\n");
+        return 2;
+    }
+    tag_farm_disc_params(&discParam, (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F | RFAL_NFC_POLL_TECH_V));
+
+    for (t = 0; t < (sizeof(provTags) / sizeof(provTags[0])); t++)
+    {
+        const provTag *pt = &provTags[t];
+        tagFarmTag     probe;
+        uint32_t       msgLen;
+
+        if ((filter != NULL) && (strstr(pt->model, filter) == NULL))
+        {
+            continue;
+        }
+
+        create_tag(pt, &probe);
+        for (p = 0; p < (sizeof(provPadLens) / sizeof(provPadLens[0])); p++)
+        {
+            msgLen = sizeof(expectBuf);
+            if ((encode_message(provUidMark, provSerialMark, provPadLens[p], expectBuf, &msgLen) != ERR_NONE) ||
+                ((msgLen + 4U) > probe.dataLen))
+            {
+                continue;       // Does not fit
+            }
+            for (m = 0; m < MODE_NUM; m++)
+            {
+                ok = (prov_case(pt, (provMode)m, provPadLens[p], tags, &serial) && ok);
+            }
+        }
+        tag_farm_free(&probe);
+    }
+
+    return (ok ? 0 : 1);
+}
@@ -0,0 +1,258 @@
+/**
+ * @file ndef_queue_test.cpp
+ *
+ * @brief Host stress test of the RF task -> decode task queue (src/ndef_queue.h), on pthreads.
+ *
+ * A producer thread publishes numbered messages, a consumer thread takes them and checks that each
+ * one arrives once, in order, with its payload intact. The producer retries on a full queue, so
+ * nothing may be lost; every full queue it meets must be counted as a drop. The cases slow down one
+ * side or the other so that both the full and the empty queue are met under contention.
+ *
+ * One JSON line is printed per case. The exit code is 1 if any case failed.
+ *
+ * Build:  g++ -std=c++17 -O2 -pthread -Isrc tools/ndef_queue_test/ndef_queue_test.cpp src/ndef_queue.cpp -o ndef_queue_test
+ *         (add -fsanitize=thread to check the memory ordering as well)
+ * Usage:  ndef_queue_test [-n messages]
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ndef_queue.h"
+
+
+#define TEST_MESSAGES_DEFAULT   200000U     // Messages per contention case
+#define TEST_PAYLOAD_MAX        300U        // Longest payload, so that checking each byte stays cheap
+#define TEST_SLOW_EVERY         64U         // The slow side yields once every that many messages
+
+
+/*** LOCAL VARIABLES ***/
+
+typedef struct {
+    const char *name;
+    bool        slowProducer;               // Producer yields now and then: the consumer meets an empty queue
+    bool        slowConsumer;               // Consumer yields now and then: the producer meets a full queue
+} testCase;
+
+static const testCase testCases[] = {
+    { "balanced",      false, false },
+    { "slow_consumer", false, true  },
+    { "slow_producer", true,  false },
+};
+
+typedef struct {
+    ndefQueue   queue;
+    uint32_t    messages;
+    bool        slowProducer;
+    bool        slowConsumer;
+    uint32_t    fullCnt;                    // Full queues met by the producer
+    uint32_t    emptyCnt;                   // Empty queues met by the consumer
+    uint32_t    received;                   // Messages taken by the consumer
+    uint32_t    orderErrors;                // Messages out of sequence (lost or duplicated)
+    uint32_t    payloadErrors;              // Messages with a wrong length or payload
+} testRun;
+
+static testRun run;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static uint32_t payload_len(uint32_t seq)
+{
+    return (seq * 7U) % (TEST_PAYLOAD_MAX + 1U);
+}
+
+
+static uint8_t payload_byte(uint32_t seq, uint32_t i)
+{
+    return (uint8_t)((seq * 31U) + i);
+}
+
+
+static void *producer(void *arg)
+{
+    testRun       *r = (testRun *)arg;
+    ndefQueueSlot *slot;
+
+    for (uint32_t seq = 0; seq < r->messages; seq++)
+    {
+        while ((slot = ndef_queue_acquire(&r->queue)) == nullptr)
+        {
+            r->fullCnt++;
+            sched_yield();
+        }
+
+        // Calling acquire again before publishing hands out the same slot
+        if (ndef_queue_acquire(&r->queue) != slot)
+        {
+            r->payloadErrors++;
+        }
+
+        slot->timestamp = seq;
+        slot->len       = payload_len(seq);
+        for (uint32_t i = 0; i < slot->len; i++)
+        {
+            slot->data[i] = payload_byte(seq, i);
+        }
+        ndef_queue_publish(&r->queue);
+
+        if (r->slowProducer && ((seq % TEST_SLOW_EVERY) == 0U))
+        {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+
+static void *consumer(void *arg)
+{
+    testRun       *r = (testRun *)arg;
+    ndefQueueSlot *slot;
+
+    while (r->received < r->messages)
+    {
+        if ((slot = ndef_queue_peek(&r->queue)) == nullptr)
+        {
+            r->emptyCnt++;
+            sched_yield();
+            continue;
+        }
+
+        if (slot->timestamp != r->received)
+        {
+            r->orderErrors++;
+        }
+        if (slot->len != payload_len(slot->timestamp))
+        {
+            r->payloadErrors++;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < slot->len; i++)
+            {
+                if (slot->data[i] != payload_byte(slot->timestamp, i))
+                {
+                    r->payloadErrors++;
+                    break;
+                }
+            }
+        }
+
+        r->received++;
+        ndef_queue_release(&r->queue);
+
+        if (r->slowConsumer && ((r->received % TEST_SLOW_EVERY) == 0U))
+        {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+
+// Single thread: the queue holds NDEF_QUEUE_SLOTS messages, then refuses and counts the drop.
+static bool check_full_empty(void)
+{
+    ndefQueueSlot *slots[NDEF_QUEUE_SLOTS];
+    bool           ok = true;
+
+    ndef_queue_init(&run.queue);
+
+    ok &= (ndef_queue_peek(&run.queue) == nullptr);
+    for (uint32_t i = 0; i < NDEF_QUEUE_SLOTS; i++)
+    {
+        slots[i] = ndef_queue_acquire(&run.queue);
+        ok &= (slots[i] != nullptr);
+        ndef_queue_publish(&run.queue);
+    }
+    ok &= (ndef_queue_acquire(&run.queue) == nullptr);
+    ok &= (run.queue.dropCnt.load() == 1U);
+
+    for (uint32_t i = 0; i < NDEF_QUEUE_SLOTS; i++)
+    {
+        ok &= (ndef_queue_peek(&run.queue) == slots[i]);
+        ndef_queue_release(&run.queue);
+    }
+    ok &= (ndef_queue_peek(&run.queue) == nullptr);
+    ok &= (ndef_queue_acquire(&run.queue) == slots[0]);
+
+    printf("{\"case\":\"full_empty\",\"slots\":%u,\"drops\":%u,\"ok\":%s}\n",
+           (unsigned)NDEF_QUEUE_SLOTS, (unsigned)run.queue.dropCnt.load(), (ok ? "true" : "false"));
+    return ok;
+}
+
+
+static bool check_contention(const testCase *tc, uint32_t messages)
+{
+    pthread_t prod;
+    pthread_t cons;
+    bool      ok;
+
+    ndef_queue_init(&run.queue);
+    run.messages      = messages;
+    run.slowProducer  = tc->slowProducer;
+    run.slowConsumer  = tc->slowConsumer;
+    run.fullCnt       = 0;
+    run.emptyCnt      = 0;
+    run.received      = 0;
+    run.orderErrors   = 0;
+    run.payloadErrors = 0;
+
+    pthread_create(&cons, nullptr, consumer, &run);
+    pthread_create(&prod, nullptr, producer, &run);
+    pthread_join(prod, nullptr);
+    pthread_join(cons, nullptr);
+
+    // Nothing lost, nothing duplicated, each full queue met counted as a drop, queue left empty
+    ok = (run.received == messages) && (run.orderErrors == 0U) && (run.payloadErrors == 0U) &&
+         (run.queue.dropCnt.load() == run.fullCnt) && (ndef_queue_peek(&run.queue) == nullptr);
+
+    // Each slowed case must have met the queue state it is there for
+    if (tc->slowConsumer)
+    {
+        ok &= (run.fullCnt != 0U);
+    }
+    if (tc->slowProducer)
+    {
+        ok &= (run.emptyCnt != 0U);
+    }
+
+    printf("{\"case\":\"%s\",\"messages\":%u,\"received\":%u,\"order_errors\":%u,\"payload_errors\":%u,"
+           "\"full\":%u,\"empty\":%u,\"drops\":%u,\"ok\":%s}\n",
+           tc->name, (unsigned)messages, (unsigned)run.received, (unsigned)run.orderErrors,
+           (unsigned)run.payloadErrors, (unsigned)run.fullCnt, (unsigned)run.emptyCnt,
+           (unsigned)run.queue.dropCnt.load(), (ok ? "true" : "false"));
+    return ok;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t messages = TEST_MESSAGES_DEFAULT;
+    unsigned failures = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc))
+        {
+            messages = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n messages]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    failures += check_full_empty() ? 0U : 1U;
+    for (const testCase &tc : testCases)
+    {
+        failures += check_contention(&tc, messages) ? 0U : 1U;
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+/**
+ * @file nfca_anticoll.cpp
+ *
+ * @brief Host simulation of the NFC-A anticollision with many cards in the field, on simulated tags
+ *        (tools/tag_farm): SDD_REQ/SEL_REQ frames and air time per card count, with and without the
+ *        UID cache of rfal_nfca.c (RFAL_FEATURE_NFCA_UID_CACHE_LEN).
+ *
+ * Each round places a population of NTAG213 cards with random 7 byte UIDs in the field, then resolves
+ * them all as rfalNfcaPollerStreamCollisionResolution() does: one card at a time, set to sleep, until
+ * no other card answers. Every card must be found once. The UID cache is used in three modes:
+ *  - off:  emptied on each card found, so that it never seeds: as a build without the cache;
+ *  - cold: emptied before the round, the cards are new to the reader;
+ *  - warm: left by a round on the same cards just before, as cards kept on the reader polled again.
+ *
+ * One JSON line is printed per card count and mode, averaged per round: SDD_REQ and SEL_REQ sent,
+ * cache seeds answered and missed (rfalNfcaPollerGetColResStats()), transceives, timeouts and air
+ * time (modelled by the link, see tools/tag_farm/rfal_rf_sim.c), and the air time per card. The
+ * populations are drawn from a fixed seed, the same for each mode. The exit code is 1 if a round
+ * failed to find its cards.
+ *
+ * Build:  gcc -std=gnu99 -c -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 \
+ *             tools/tag_farm/tag_*.c tools/tag_farm/rfal_rf_sim.c src/rfal_platform/pltf_timer.c \
+ *             src/rfal_core/rfal_{nfc,isoDep,nfcDep,nfca,nfcb,nfcf,nfcv,t1t,t2t,t4t,st25xv,crc,stats,dpo,cd,analogConfig,trace}.c \
+ *             src/ndef/poller/ndef_*.c src/ndef/message/ndef_*.c
+ *         g++ -std=c++17 -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 tools/nfca_anticoll/nfca_anticoll.cpp *.o -o nfca_anticoll
+ * Usage:  nfca_anticoll [-n rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "rfal_rf.h"
+#include "rfal_nfca.h"
+}
+
+#include "tag_farm.h"
+
+
+#define ANTICOLL_ROUNDS_DEFAULT   20U   // Populations drawn per card count
+#define ANTICOLL_CARDS_MAX        50U
+#define ANTICOLL_SEED     0x2545F491U   // Seed of the UIDs drawn
+
+static const uint8_t anticollCards[] = { 2U, 3U, 4U, 6U, 8U, 12U, 16U, 24U, 32U, 40U, 50U };
+
+
+/*** UID cache modes ***/
+typedef enum
+{
+    CACHE_OFF,
+    CACHE_COLD,
+    CACHE_WARM,
+    CACHE_NUM
+} cacheMode;
+
+static const char *cacheNames[CACHE_NUM] = { "off", "cold", "warm" };
+
+
+/*** LOCAL VARIABLES ***/
+
+static tagFarmTag           cards[ANTICOLL_CARDS_MAX];
+static tagFarmTag          *field[ANTICOLL_CARDS_MAX];
+static uint8_t              cardCnt;
+static bool                 cardFound[ANTICOLL_CARDS_MAX];
+static uint32_t             foundErrors;    // Cards found twice, or not in the field
+static bool                 clearOnFound;   // CACHE_OFF: the cache emptied on each card found
+static rfalNfcaColResStats  colResAcc;      // Statistics of the round, across the cache clears
+static rfalNfcaColResStats  colResBase;     // Counters of rfal_nfca.c when last added
+static uint32_t             rngState;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static uint32_t rng_next(void)
+{
+    // xorshift32: the same populations on every host
+    rngState ^= (rngState << 13);
+    rngState ^= (rngState >> 17);
+    rngState ^= (rngState << 5);
+    return rngState;
+}
+
+
+// Draws count cards with distinct random UIDs, NXP manufacturer byte kept. UID3 may not be the
+// cascade tag (ISO14443-3): the reader would take the UID for a triple size one.
+static void draw_cards(uint8_t count)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t b;
+    bool    dup;
+
+    for (i = 0; i < count; i++)
+    {
+        do
+        {
+            for (b = 1; b < cards[i].uidLen; b++)
+            {
+                cards[i].uid[b] = (uint8_t)rng_next();
+            }
+
+            dup = (cards[i].uid[3] == 0x88U);
+            for (j = 0; j < i; j++)
+            {
+                dup |= (memcmp(cards[i].uid, cards[j].uid, cards[i].uidLen) == 0);
+            }
+        }
+        while (dup);
+    }
+    cardCnt = count;
+}
+
+
+// Adds the counters of rfal_nfca.c since the last call to the round.
+static void colres_add(void)
+{
+    rfalNfcaColResStats s;
+
+    rfalNfcaPollerGetColResStats(&s);
+    colResAcc.sddReqCnt   += (s.sddReqCnt   - colResBase.sddReqCnt);
+    colResAcc.selReqCnt   += (s.selReqCnt   - colResBase.selReqCnt);
+    colResAcc.seedHitCnt  += (s.seedHitCnt  - colResBase.seedHitCnt);
+    colResAcc.seedMissCnt += (s.seedMissCnt - colResBase.seedMissCnt);
+    colResAcc.devCnt      += (s.devCnt      - colResBase.devCnt);
+    colResBase = s;
+}
+
+
+static bool card_found(const rfalNfcaListenDevice *nfcaDev)
+{
+    uint8_t i;
+
+    for (i = 0; i < cardCnt; i++)
+    {
+        if ((nfcaDev->nfcId1Len == cards[i].uidLen) && (memcmp(nfcaDev->nfcId1, cards[i].uid, cards[i].uidLen) == 0))
+        {
+            break;
+        }
+    }
+    if ((i == cardCnt) || cardFound[i])
+    {
+        foundErrors++;
+    }
+    else
+    {
+        cardFound[i] = true;
+    }
+
+    // The counters are cleared with the cache: add them before
+    if (clearOnFound)
+    {
+        colres_add();
+        rfalNfcaPollerClearUidCache();
+        memset(&colResBase, 0, sizeof(colResBase));
+    }
+    return true;
+}
+
+
+// Resolves the cards in the field; returns false unless each one was found once.
+static bool run_round(void)
+{
+    uint16_t devCnt = 0;
+    uint8_t  i;
+
+    memset(cardFound, 0, sizeof(cardFound));
+    foundErrors = 0;
+
+    rfalNfcaPollerInitialize();
+    rfalFieldOnAndStartGT();
+    rfalNfcaPollerStreamCollisionResolution(RFAL_COMPLIANCE_MODE_NFC, card_found, &devCnt);
+    rfalFieldOff();
+    colres_add();
+
+    for (i = 0; i < cardCnt; i++)
+    {
+        foundErrors += (cardFound[i] ? 0U : 1U);
+    }
+    return ((foundErrors == 0U) && (devCnt == cardCnt));
+}
+
+
+// Rounds of count cards with the cache in mode; prints the line, returns false if a round failed.
+static bool anticoll_case(uint8_t count, cacheMode mode, unsigned rounds)
+{
+    rfalNfcaColResStats total;
+    tagFarmStats        s;
+    unsigned long long  txrx     = 0;
+    unsigned long long  timeouts = 0;
+    unsigned long long  airUs    = 0;
+    unsigned            failed   = 0;
+    unsigned            r;
+
+    memset(&total, 0, sizeof(total));
+    rngState     = (ANTICOLL_SEED + count);
+    clearOnFound = (mode == CACHE_OFF);
+
+    for (r = 0; r < rounds; r++)
+    {
+        draw_cards(count);
+        tag_farm_place_many(field, count);
+
+        rfalNfcaPollerClearUidCache();
+        memset(&colResBase, 0, sizeof(colResBase));
+        if (mode == CACHE_WARM)
+        {
+            failed += (run_round() ? 0U : 1U);      // Fills the cache, not counted
+        }
+
+        memset(&colResAcc, 0, sizeof(colResAcc));
+        tag_farm_reset_stats();
+        failed += (run_round() ? 0U : 1U);
+
+        tag_farm_get_stats(&s);
+        total.sddReqCnt   += colResAcc.sddReqCnt;
+        total.selReqCnt   += colResAcc.selReqCnt;
+        total.seedHitCnt  += colResAcc.seedHitCnt;
+        total.seedMissCnt += colResAcc.seedMissCnt;
+        txrx     += s.txrx;
+        timeouts += s.timeouts;
+        airUs    += s.airUs;
+    }
+    tag_farm_place(NULL);
+
+    printf("{\"cards\":%u,\"cache\":\"%s\",\"uid_cache_len\":%u,\"rounds\":%u,\"status\":\"%s\",\"sdd_req\":%llu,\"sel_req\":%llu,"
+           "\"seed_hits\":%llu,\"seed_misses\":%llu,\"txrx\":%llu,\"timeouts\":%llu,\"air_us\":%llu,\"air_us_per_card\":%llu}\n",
+           (unsigned)count, cacheNames[mode], (unsigned)RFAL_FEATURE_NFCA_UID_CACHE_LEN, rounds, ((failed == 0U) ? "ok" : "failed"),
+           (unsigned long long)(total.sddReqCnt / rounds), (unsigned long long)(total.selReqCnt / rounds),
+           (unsigned long long)(total.seedHitCnt / rounds), (unsigned long long)(total.seedMissCnt / rounds),
+           (txrx / rounds), (timeouts / rounds), (airUs / rounds), (airUs / ((unsigned long long)rounds * count)));
+
+    return (failed == 0U);
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned rounds = ANTICOLL_ROUNDS_DEFAULT;
+    bool     ok     = true;
+    int      opt;
+    size_t   c;
+    int      m;
+    uint8_t  i;
+
+    for (opt = 1; opt < argc; opt++)
+    {
+        if ((strcmp(argv[opt], "-n") == 0) && ((opt + 1) < argc))
+        {
+            rounds = (unsigned)strtoul(argv[++opt], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n rounds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rounds == 0U)
+    {
+        rounds = 1U;
+    }
+
+    rfalInitialize();
+    for (i = 0; i < ANTICOLL_CARDS_MAX; i++)
+    {
+        tag_t2t_init(&cards[i], "NTAG213", 144U);
+        field[i] = &cards[i];
+    }
+
+    for (c = 0; c < (sizeof(anticollCards) / sizeof(anticollCards[0])); c++)
+    {
+        for (m = 0; m < (int)CACHE_NUM; m++)
+        {
+            ok = (anticoll_case(anticollCards[c], (cacheMode)m, rounds) && ok);
+        }
+    }
+
+    for (i = 0; i < ANTICOLL_CARDS_MAX; i++)
+    {
+        tag_farm_free(&cards[i]);
+    }
+    return (ok ? 0 : 1);
+}
@@ -0,0 +1,283 @@
+/**
+ * @file nfcf_slots.cpp
+ *
+ * @brief Host benchmark of the FeliCa Polling time slots, on simulated NFC-F tags (tools/tag_farm):
+ *        fixed slot counts against the adaptive slots of rfal_nfcf.c (rfalNfcfPollerSetAdaptiveSlots()),
+ *        per card population.
+ *
+ * Each trial places a population of FeliCa Lite-S cards in the field, then runs the NFC-F discovery
+ * cycles of rfal_nfc.c, each card answering in a time slot drawn at random (see
+ * tools/tag_farm/rfal_rf_sim.c): the Technology Detection SENSF_REQ (4 slots), then the collision
+ * resolution SENSF_REQ, with:
+ *  - fixed N:  N slots (rfalNfcfPollerPoll()); fixed_16 is the collision resolution with the adaptive
+ *              slots disabled, the default;
+ *  - adaptive: the collision resolution with the adaptive slots, its poll time capped as in main.cpp
+ *              (43.5 ms: up to 16 slots), or at 13 ms (up to 8 slots).
+ * The reader runs cycles until every card has been received by a collision resolution (inventory),
+ * then SLOTS_WINDOW more cycles with the cards still there (steady state, as cards kept on the reader).
+ *
+ * One JSON line is printed per population and mode, averaged over the trials: the trials whose
+ * inventory completed within SLOTS_CYCLE_MAX cycles, the cycles and air time it took, then per cycle
+ * of the steady state the slots opened by the collision resolution, cards received, slots in collision
+ * and air time (modelled by the link, Technology Detection included). A fixed single slot never tells
+ * two cards apart: its inventory does not complete, as on a real reader. The exit code is 1 if an
+ * adaptive mode failed an inventory.
+ *
+ * Build:  gcc -std=gnu99 -c -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 \
+ *             tools/tag_farm/tag_*.c tools/tag_farm/rfal_rf_sim.c src/rfal_platform/pltf_timer.c \
+ *             src/rfal_core/rfal_{nfc,isoDep,nfcDep,nfca,nfcb,nfcf,nfcv,t1t,t2t,t4t,st25xv,crc,stats,dpo,cd,analogConfig,trace}.c \
+ *             src/ndef/poller/ndef_*.c src/ndef/message/ndef_*.c
+ *         g++ -std=c++17 -Itools/rf_replay/host -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 tools/nfcf_slots/nfcf_slots.cpp *.o -o nfcf_slots
+ * Usage:  nfcf_slots [-n trials]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "rfal_rf.h"
+#include "rfal_nfcf.h"
+}
+
+#include "tag_farm.h"
+
+
+#define SLOTS_TRIALS_DEFAULT     500U   // Trials per population and mode
+#define SLOTS_CARDS_MAX           16U   // RFAL_NFCF_POLL_MAXCARDS: SENSF_RES kept per SENSF_REQ
+#define SLOTS_CYCLE_MAX          256U   // Discovery cycles before an inventory is given up
+#define SLOTS_WINDOW              32U   // Discovery cycles of the steady state
+#define SLOTS_POLL_TIME_MAIN   43500U   // Poll time cap of main.cpp (DEMO_NFCF_POLL_TIME) [us]
+#define SLOTS_POLL_TIME_13MS   13000U   // Poll time cap allowing 8 slots [us]
+
+static const uint8_t slotsCards[] = { 1U, 2U, 3U, 4U, 6U, 8U, 12U, 16U };
+
+
+/*** Modes: fixed slot counts, then adaptive ***/
+typedef struct
+{
+    const char         *name;
+    bool                colRes;         // Collision resolution of rfal_nfcf.c, else rfalNfcfPollerPoll()
+    bool                adaptive;       // Collision resolution: adaptive slots
+    rfalFeliCaPollSlots slots;          // Fixed: slots of every SENSF_REQ
+    uint16_t            pollTime;       // Adaptive: poll time cap
+} slotsMode;
+
+static const slotsMode slotsModes[] =
+{
+    { "fixed_1",       false, false, RFAL_FELICA_1_SLOT,   0U                   },
+    { "fixed_2",       false, false, RFAL_FELICA_2_SLOTS,  0U                   },
+    { "fixed_4",       false, false, RFAL_FELICA_4_SLOTS,  0U                   },
+    { "fixed_8",       false, false, RFAL_FELICA_8_SLOTS,  0U                   },
+    { "fixed_16",      true,  false, RFAL_FELICA_16_SLOTS, SLOTS_POLL_TIME_MAIN },
+    { "adaptive",      true,  true,  RFAL_FELICA_1_SLOT,   SLOTS_POLL_TIME_MAIN },
+    { "adaptive_13ms", true,  true,  RFAL_FELICA_1_SLOT,   SLOTS_POLL_TIME_13MS },
+};
+
+
+/*** Costs of the discovery cycles of a phase ***/
+typedef struct
+{
+    unsigned long long cycles;
+    unsigned long long slots;
+    unsigned long long found;
+    unsigned long long collisions;
+    unsigned long long airUs;
+} slotsCost;
+
+
+/*** LOCAL VARIABLES ***/
+
+static tagFarmTag  cards[SLOTS_CARDS_MAX];
+static tagFarmTag *field[SLOTS_CARDS_MAX];
+static uint8_t     cardCnt;
+static bool        cardSeen[SLOTS_CARDS_MAX];
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static void card_seen(const uint8_t *nfcid2)
+{
+    uint8_t i;
+
+    for (i = 0; i < cardCnt; i++)
+    {
+        if (memcmp(nfcid2, cards[i].uid, RFAL_NFCF_NFCID2_LEN) == 0)
+        {
+            cardSeen[i] = true;
+        }
+    }
+}
+
+
+static bool all_seen(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < cardCnt; i++)
+    {
+        if (!cardSeen[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// One discovery cycle of the mode; its costs added to cost.
+static void cycle_once(const slotsMode *mode, slotsCost *cost)
+{
+    rfalFeliCaPollRes    pollRes[RFAL_NFCF_POLL_MAXCARDS];
+    rfalNfcfListenDevice devList[RFAL_NFCF_POLL_MAXCARDS];
+    rfalNfcfPollStats    before;
+    rfalNfcfPollStats    after;
+    tagFarmStats         s0;
+    tagFarmStats         s1;
+    uint8_t              devCnt = 0;
+    uint8_t              coll   = 0;
+    uint8_t              i;
+
+    tag_farm_get_stats(&s0);
+
+    // Technology Detection: the collision resolution starts from its responses, as in rfal_nfc.c
+    rfalNfcfPollerCheckPresence();
+
+    if (mode->colRes)
+    {
+        rfalNfcfPollerGetPollStats(&before);
+        rfalNfcfPollerCollisionResolution(RFAL_COMPLIANCE_MODE_ISO, RFAL_NFCF_POLL_MAXCARDS, devList, &devCnt);
+        rfalNfcfPollerGetPollStats(&after);
+
+        for (i = 0; i < devCnt; i++)
+        {
+            card_seen(devList[i].sensfRes.NFCID2);
+        }
+        cost->slots      += (after.slotCnt - before.slotCnt);
+        cost->collisions += (after.collCnt - before.collCnt);
+    }
+    else
+    {
+        rfalNfcfPollerPoll(mode->slots, RFAL_NFCF_SYSTEMCODE, RFAL_FELICA_POLL_RC_NO_REQUEST, pollRes, &devCnt, &coll);
+
+        for (i = 0; i < devCnt; i++)
+        {
+            card_seen(&pollRes[i][2]);      // LEN, 01h, NFCID2
+        }
+        cost->slots      += ((uint32_t)mode->slots + 1U);
+        cost->collisions += coll;
+    }
+    tag_farm_get_stats(&s1);
+
+    cost->cycles++;
+    cost->found += devCnt;
+    cost->airUs += (s1.airUs - s0.airUs);
+}
+
+
+// Trials of count cards in mode; prints the line, returns false if an adaptive inventory failed.
+static bool slots_case(uint8_t count, const slotsMode *mode, unsigned trials)
+{
+    slotsCost inventory;
+    slotsCost steady;
+    unsigned  complete = 0;
+    unsigned  t;
+    unsigned  p;
+
+    memset(&inventory, 0, sizeof(inventory));
+    memset(&steady, 0, sizeof(steady));
+    cardCnt = count;
+    tag_farm_place_many(field, count);
+
+    for (t = 0; t < trials; t++)
+    {
+        slotsCost inv;
+
+        memset(&inv, 0, sizeof(inv));
+        memset(cardSeen, 0, sizeof(cardSeen));
+
+        // A new arrival of the cards: the adaptive slots start again from 1
+        rfalNfcfPollerInitialize(RFAL_BR_212);
+        rfalFieldOnAndStartGT();
+        rfalNfcfPollerSetAdaptiveSlots(mode->adaptive, mode->pollTime);
+
+        for (p = 0; (p < SLOTS_CYCLE_MAX) && !all_seen(); p++)
+        {
+            cycle_once(mode, &inv);
+        }
+        if (all_seen())
+        {
+            complete++;
+            inventory.cycles += inv.cycles;
+            inventory.airUs  += inv.airUs;
+        }
+
+        for (p = 0; p < SLOTS_WINDOW; p++)
+        {
+            cycle_once(mode, &steady);
+        }
+        rfalFieldOff();
+    }
+    tag_farm_place(NULL);
+
+    printf("{\"cards\":%u,\"mode\":\"%s\",\"trials\":%u,\"complete\":%u,", (unsigned)count, mode->name, trials, complete);
+    if (complete > 0U)
+    {
+        printf("\"inventory\":{\"cycles\":%.1f,\"air_us\":%llu},",
+               ((double)inventory.cycles / complete), (inventory.airUs / complete));
+    }
+    printf("\"per_cycle\":{\"slots\":%.2f,\"found\":%.2f,\"collisions\":%.2f,\"air_us\":%llu}}\n",
+           ((double)steady.slots / steady.cycles), ((double)steady.found / steady.cycles),
+           ((double)steady.collisions / steady.cycles), (steady.airUs / steady.cycles));
+
+    return ((!mode->adaptive) || (complete == trials));
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned trials = SLOTS_TRIALS_DEFAULT;
+    bool     ok     = true;
+    int      opt;
+    size_t   c;
+    size_t   m;
+    uint8_t  i;
+
+    for (opt = 1; opt < argc; opt++)
+    {
+        if ((strcmp(argv[opt], "-n") == 0) && ((opt + 1) < argc))
+        {
+            trials = (unsigned)strtoul(argv[++opt], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n trials]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (trials == 0U)
+    {
+        trials = 1U;
+    }
+
+    rfalInitialize();
+    for (i = 0; i < SLOTS_CARDS_MAX; i++)
+    {
+        tag_t3t_init(&cards[i], "FeliCa Lite-S", 13U, 4U, 1U);
+        field[i] = &cards[i];
+    }
+
+    for (c = 0; c < (sizeof(slotsCards) / sizeof(slotsCards[0])); c++)
+    {
+        for (m = 0; m < (sizeof(slotsModes) / sizeof(slotsModes[0])); m++)
+        {
+            ok = (slots_case(slotsCards[c], &slotsModes[m], trials) && ok);
+        }
+    }
+
+    for (i = 0; i < SLOTS_CARDS_MAX; i++)
+    {
+        tag_farm_free(&cards[i]);
+    }
+    return (ok ? 0 : 1);
+}
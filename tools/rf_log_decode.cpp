@@ -0,0 +1,82 @@
+/**
+ * @file rf_log_decode.cpp
+ * 
+ * @brief Host decoder of the RF log binary frames (see src/rf_log.h).
+ * 
+ * Reads a capture of the serial output (file or stdin), turns each valid binary frame into its
+ * text line and passes everything else (the text printed by the firmware) through unchanged.
+ * 
+ * Build:  g++ -std=c++17 -Isrc tools/rf_log_decode.cpp src/rf_log.cpp -o rf_log_decode
+ * Usage:  rf_log_decode [capture.bin]
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rf_log.h"
+
+
+int main(int argc, char *argv[])
+{
+    FILE       *in = stdin;
+    uint8_t     win[RF_LOG_FRAME_LEN];
+    uint8_t     frame[RF_LOG_FRAME_LEN];
+    size_t      winLen = 0;
+    rfLogEntry  entry;
+    char        line[256];
+    unsigned    frames = 0;
+    unsigned    badFrames = 0;
+    int         c;
+
+    if (argc > 1)
+    {
+        in = fopen(argv[1], "rb");
+        if (in == NULL)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    /* Sliding window: a frame is taken once sync bytes and checksum match, other bytes are text */
+    while ((c = fgetc(in)) != EOF)
+    {
+        win[winLen++] = (uint8_t)c;
+
+        if ((win[0] != RF_LOG_SYNC0) || ((winLen > 1U) && (win[1] != RF_LOG_SYNC1)))
+        {
+            fputc(win[0], stdout);
+            memmove(win, &win[1], --winLen);
+            continue;
+        }
+        if (winLen < RF_LOG_FRAME_LEN)
+        {
+            continue;
+        }
+
+        memcpy(&entry, &win[2], sizeof(entry));
+        rf_log_frame(&entry, frame);
+        if (frame[RF_LOG_FRAME_LEN - 1U] == win[RF_LOG_FRAME_LEN - 1U])
+        {
+            rf_log_format(&entry, line, sizeof(line));
+            printf("%s\n", line);
+            frames++;
+            winLen = 0;
+        }
+        else
+        {
+            /* False sync: the first byte was text */
+            badFrames++;
+            fputc(win[0], stdout);
+            memmove(win, &win[1], --winLen);
+        }
+    }
+    fwrite(win, 1, winLen, stdout);
+
+    fprintf(stderr, "%u frames decoded, %u false syncs\n", frames, badFrames);
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+    return 0;
+}
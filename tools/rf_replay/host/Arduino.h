@@ -0,0 +1,14 @@
+/**
+ * @file Arduino.h
+ *
+ * @brief Host stand-in for the Arduino core header pulled in by rfal_platform.h: the replay needs none of it.
+ */
+
+#ifndef ARDUINO_H_HOST
+#define ARDUINO_H_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#endif /* ARDUINO_H_HOST */
@@ -0,0 +1,335 @@
+/**
+ * @file rf_replay.cpp
+ *
+ * @brief Host replay of RF frame captures (see include/rfal_trace.h) through the NDEF stack.
+ *
+ * Reads either a binary trace (one or more traces back to back) or a capture of the serial output
+ * of the demo built with DEMO_RF_TRACE, whose "T:" lines hold the trace of each tap in hex; other
+ * lines are ignored. Each trace is a session: from its DEVICE entry on, the NDEF pollers detect and
+ * read the tag and decode the message with the RF answered from the trace (rfal_rf_replay.c).
+ *
+ * Per session one line is printed: device, NDEF outcome, transceives, divergences from the trace,
+ * recorded RF time and host CPU time per read. The exit code is 1 if any session diverged, so a
+ * corpus of real sessions can gate a change of the stack.
+ *
+ * Build:  gcc -std=gnu99 -c -Itools/rf_replay/host -Itools/rf_replay -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 \
+ *             tools/rf_replay/rfal_rf_replay.c tools/tag_farm/tag_farm.c src/rfal_platform/pltf_timer.c src/rfal_core/rfal_{isoDep,nfca,nfcb,nfcf,nfcv,t1t,t2t,t4t,st25xv,crc,stats}.c \
+ *             src/ndef/poller/ndef_*.c src/ndef/message/ndef_*.c
+ *         g++ -std=c++17 -Itools/rf_replay/host -Itools/rf_replay -Itools/tag_farm -Isrc -Iinclude -Iinclude/rfal_platform -Iinclude/st25r3911 tools/rf_replay/rf_replay.cpp *.o -o rf_replay
+ * Usage:  rf_replay [-n iterations] [capture]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "rfal_nfc.h"
+#include "rfal_isoDep.h"
+#include "rfal_trace.h"
+#include "ndef_poller.h"
+#include "ndef_message.h"
+}
+
+#include "rf_replay.h"
+#include "tag_farm.h"
+
+
+#define REPLAY_MSG_BUF_LEN      8192    // Largest NDEF message read
+#define REPLAY_LINE_LEN         1024    // Longest serial output line
+
+
+/*** LOCAL VARIABLES ***/
+
+static const uint8_t traceMagic[] = { 'R', 'F', 'T', 'R' };
+static uint8_t       msgBuf[REPLAY_MSG_BUF_LEN];
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static bool is_trace_header(const uint8_t *p, size_t avail)
+{
+    return (avail >= RFAL_TRACE_HDR_LEN) && (memcmp(p, traceMagic, sizeof(traceMagic)) == 0) && (p[4] == RFAL_TRACE_VERSION);
+}
+
+
+static int hex_nibble(int c)
+{
+    if ((c >= '0') && (c <= '9')) return (c - '0');
+    if ((c >= 'A') && (c <= 'F')) return (c - 'A' + 10);
+    if ((c >= 'a') && (c <= 'f')) return (c - 'a' + 10);
+    return -1;
+}
+
+
+// Input as trace bytes: binary as is, serial output through its "T:" lines.
+static bool read_input(FILE *in, std::vector<uint8_t> &data)
+{
+    char   line[REPLAY_LINE_LEN];
+    int    c;
+
+    while ((c = fgetc(in)) != EOF)
+    {
+        data.push_back((uint8_t)c);
+    }
+    if (is_trace_header(data.data(), data.size()))
+    {
+        return true;
+    }
+
+    std::vector<uint8_t> text;
+    text.swap(data);
+    text.push_back('\0');
+
+    for (char *p = (char *)text.data(); *p != '\0'; )
+    {
+        size_t n = strcspn(p, "\r\n");
+        size_t l = ((n < (sizeof(line) - 1)) ? n : (sizeof(line) - 1));
+
+        memcpy(line, p, l);
+        line[l] = '\0';
+        p += n;
+        p += strspn(p, "\r\n");
+
+        if ((strncmp(line, "T:", 2) != 0) || (hex_nibble(line[2]) < 0))
+        {
+            continue;       // Firmware text, or the "T:dropped" count
+        }
+        for (char *h = &line[2]; (hex_nibble(h[0]) >= 0) && (hex_nibble(h[1]) >= 0); h += 2)
+        {
+            data.push_back((uint8_t)((hex_nibble(h[0]) << 4) | hex_nibble(h[1])));
+        }
+    }
+
+    return is_trace_header(data.data(), data.size());
+}
+
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+
+// Device as activated on the reader, from a DEVICE entry: what the NDEF pollers take from it.
+static void load_device(const uint8_t *e, rfalNfcDevice *dev)
+{
+    const uint8_t *nfcid    = &e[8];
+    uint8_t        nfcidLen = e[7];
+    const uint8_t *iso      = &nfcid[nfcidLen];
+
+    memset(dev, 0, sizeof(*dev));
+    dev->type     = (rfalNfcDevType)e[5];
+    dev->nfcidLen = nfcidLen;
+
+    switch (dev->type)
+    {
+        case RFAL_NFC_LISTEN_TYPE_NFCA:
+            dev->dev.nfca.type      = (rfalNfcaListenDeviceType)e[6];
+            dev->dev.nfca.nfcId1Len = RFAL_MIN(nfcidLen, (uint8_t)sizeof(dev->dev.nfca.nfcId1));
+            memcpy(dev->dev.nfca.nfcId1, nfcid, dev->dev.nfca.nfcId1Len);
+            dev->nfcid       = dev->dev.nfca.nfcId1;
+            dev->rfInterface = ((dev->dev.nfca.type == RFAL_NFCA_T4T) ? RFAL_NFC_INTERFACE_ISODEP : RFAL_NFC_INTERFACE_RF);
+            break;
+
+        case RFAL_NFC_LISTEN_TYPE_NFCB:
+            memcpy(dev->dev.nfcb.sensbRes.nfcid0, nfcid, RFAL_MIN(nfcidLen, (uint8_t)RFAL_NFCB_NFCID0_LEN));
+            dev->nfcid       = dev->dev.nfcb.sensbRes.nfcid0;
+            dev->rfInterface = RFAL_NFC_INTERFACE_ISODEP;
+            break;
+
+        case RFAL_NFC_LISTEN_TYPE_NFCF:
+            memcpy(dev->dev.nfcf.sensfRes.NFCID2, nfcid, RFAL_MIN(nfcidLen, (uint8_t)RFAL_NFCF_NFCID2_LEN));
+            dev->nfcid       = dev->dev.nfcf.sensfRes.NFCID2;
+            dev->rfInterface = RFAL_NFC_INTERFACE_RF;
+            break;
+
+        case RFAL_NFC_LISTEN_TYPE_NFCV:
+            memcpy(dev->dev.nfcv.InvRes.UID, nfcid, RFAL_MIN(nfcidLen, (uint8_t)RFAL_NFCV_UID_LEN));
+            dev->nfcid       = dev->dev.nfcv.InvRes.UID;
+            dev->rfInterface = RFAL_NFC_INTERFACE_RF;
+            break;
+
+        default:
+            dev->rfInterface = RFAL_NFC_INTERFACE_RF;
+            break;
+    }
+
+    dev->proto.isoDep.info.DID  = iso[0];
+    dev->proto.isoDep.info.FSx  = (uint16_t)(iso[1] | (iso[2] << 8));
+    dev->proto.isoDep.info.FWT  = get32(&iso[3]);
+    dev->proto.isoDep.info.dFWT = get32(&iso[7]);
+}
+
+
+// One read as the demo does it: context, detect, read, decode. Returns the NDEF outcome.
+static ndefStatus replay_read(const rfalNfcDevice *dev, uint32_t *msgLen, uint32_t *records)
+{
+    ndefContext         ctx;
+    ndefInfo            info;
+    ndefConstBuffer     bufMsg;
+    ndefMessage         message;
+    ndefMessageInfo     msgInfo;
+    ndefStatus          err;
+
+    *msgLen  = 0;
+    *records = 0;
+
+    if (dev->rfInterface == RFAL_NFC_INTERFACE_ISODEP)
+    {
+        rfalIsoDepInitialize();     // ISO-DEP as left by the activation: block number 0
+    }
+
+    err = ndefPollerContextInitialization(&ctx, dev);
+    if (err != ERR_NONE)
+    {
+        return err;
+    }
+    err = ndefPollerNdefDetect(&ctx, &info);
+    if ((err != ERR_NONE) || (info.state == NDEF_STATE_INITIALIZED))
+    {
+        return err;
+    }
+    err = ndefPollerReadRawMessage(&ctx, msgBuf, sizeof(msgBuf), msgLen, true);
+    if (err != ERR_NONE)
+    {
+        return err;
+    }
+
+    bufMsg.buffer = msgBuf;
+    bufMsg.length = *msgLen;
+    err = ndefMessageDecode(&bufMsg, &message);
+    if ((err == ERR_NONE) && (ndefMessageGetInfo(&message, &msgInfo) == ERR_NONE))
+    {
+        *records = msgInfo.recordCount;
+    }
+    return err;
+}
+
+
+static const char *dev_type_name(const rfalNfcDevice *dev)
+{
+    switch (dev->type)
+    {
+        case RFAL_NFC_LISTEN_TYPE_NFCA:
+            switch (dev->dev.nfca.type)
+            {
+                case RFAL_NFCA_T1T: return "T1T";
+                case RFAL_NFCA_T2T: return "T2T";
+                case RFAL_NFCA_T4T: return "T4T-A";
+                default:            return "NFC-A";
+            }
+        case RFAL_NFC_LISTEN_TYPE_NFCB: return "T4T-B";
+        case RFAL_NFC_LISTEN_TYPE_NFCF: return "T3T";
+        case RFAL_NFC_LISTEN_TYPE_NFCV: return "T5T";
+        default:                        return "other";
+    }
+}
+
+
+// Replays one trace; returns false if the stack diverged from it.
+static bool replay_session(unsigned num, const uint8_t *trace, uint32_t len, unsigned iterations)
+{
+    rfalNfcDevice   dev;
+    rfReplayStats   stats;
+    ndefStatus      err = ERR_NONE;
+    uint32_t        msgLen = 0;
+    uint32_t        records = 0;
+    uint32_t        pos = RFAL_TRACE_HDR_LEN;
+    uint32_t        eLen;
+    uint32_t        start;
+    uint32_t        cpu;
+
+    /* Session starts at the DEVICE entry: discovery and activation frames are skipped */
+    while ((pos < len) && ((eLen = rf_replay_entry_len(&trace[pos], (len - pos))) != 0U) && (trace[pos] != RFAL_TRACE_ENTRY_DEVICE))
+    {
+        pos += eLen;
+    }
+    if ((pos >= len) || (trace[pos] != RFAL_TRACE_ENTRY_DEVICE))
+    {
+        printf("session=%u device=none\n", num);
+        return true;
+    }
+    load_device(&trace[pos], &dev);
+    pos += rf_replay_entry_len(&trace[pos], (len - pos));
+
+    start = tag_farm_cpu_us();
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        rf_replay_begin(&trace[pos], (len - pos));
+        err = replay_read(&dev, &msgLen, &records);
+    }
+    cpu = ((tag_farm_cpu_us() - start) / iterations);
+    rf_replay_get_stats(&stats);
+
+    printf("session=%u device=%s uid=", num, dev_type_name(&dev));
+    for (uint8_t i = 0; i < dev.nfcidLen; i++)
+    {
+        printf("%02X", dev.nfcid[i]);
+    }
+    printf(" ndef_err=%d ndef_len=%u records=%u txrx=%u tx_bytes=%u rx_bytes=%u diverged=%u first_diverged=%u beyond_trace=%u rf_us=%u cpu_us=%u\n",
+           err, msgLen, records, stats.frames, stats.txBytes, stats.rxBytes, stats.diverged, stats.firstDiverged, stats.beyondTrace, stats.rfTime, cpu);
+
+    return ((stats.diverged == 0U) && (stats.beyondTrace == 0U));
+}
+
+
+int main(int argc, char *argv[])
+{
+    FILE                 *in = stdin;
+    std::vector<uint8_t>  data;
+    unsigned              iterations = 1;
+    unsigned              sessions = 0;
+    unsigned              diverged = 0;
+    size_t                start;
+    size_t                pos;
+    uint32_t              eLen;
+    int                   arg = 1;
+
+    if ((argc > 2) && (strcmp(argv[1], "-n") == 0))
+    {
+        iterations = (unsigned)atoi(argv[2]);
+        iterations = ((iterations == 0) ? 1 : iterations);
+        arg = 3;
+    }
+    if (argc > arg)
+    {
+        in = fopen(argv[arg], "rb");
+        if (in == NULL)
+        {
+            perror(argv[arg]);
+            return 2;
+        }
+    }
+
+    if (!read_input(in, data))
+    {
+        fprintf(stderr, "no RF trace found\n");
+        return 2;
+    }
+
+    /* Traces back to back: each one runs up to the next header, or up to an entry cut short */
+    for (start = 0; is_trace_header((data.data() + start), (data.size() - start)); start = pos)
+    {
+        pos = start + RFAL_TRACE_HDR_LEN;
+        while ((pos < data.size()) && ((eLen = rf_replay_entry_len(&data[pos], (uint32_t)(data.size() - pos))) != 0U))
+        {
+            pos += eLen;
+        }
+
+        if (!replay_session(++sessions, &data[start], (uint32_t)(pos - start), iterations))
+        {
+            diverged++;
+        }
+
+        /* Resynchronize on the next header after a damaged entry */
+        while ((pos < data.size()) && (!is_trace_header((data.data() + pos), (data.size() - pos))))
+        {
+            pos++;
+        }
+    }
+
+    fprintf(stderr, "%u sessions replayed, %u diverged\n", sessions, diverged);
+    return ((diverged != 0) ? 1 : 0);
+}
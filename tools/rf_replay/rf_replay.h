@@ -0,0 +1,59 @@
+/**
+ * @file rf_replay.h
+ *
+ * @brief Host RF backend replaying a frame capture (see include/rfal_trace.h) to the RFAL/NDEF stack.
+ *
+ * rfal_rf_replay.c implements, in place of the ST25R3911 driver, the rfal_rf.h functions the NDEF
+ * pollers and the RFAL protocol layers above rfal_rf.h link against. Each frame the stack transmits
+ * is checked against the next TX entry of the trace and answered with the status and frame of the
+ * RX entry after it, so a session runs on the host exactly as it ran on the reader, for as long as
+ * the stack sends the same frames.
+ *
+ * Discovery and activation are not replayed: a session starts from its DEVICE entry.
+ */
+
+#ifndef RF_REPLAY_H
+#define RF_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*** Replay statistics ***/
+typedef struct
+{
+    uint32_t frames;            // Transceives answered from the trace
+    uint32_t diverged;          // Frames transmitted that differ from the trace (frame, flags or FWT)
+    uint32_t firstDiverged;     // Transceive number of the first divergence, 0 if none
+    uint32_t beyondTrace;       // Transceives past the end of the trace, answered with a timeout
+    uint32_t txBytes;           // Bytes transmitted
+    uint32_t rxBytes;           // Bytes received
+    uint32_t rfTime;            // Recorded time from each TX to its RX entry [us]
+} rfReplayStats;
+
+
+/**
+ * @brief Returns the length of the trace entry at p, 0 if it is not a complete entry.
+ */
+uint32_t rf_replay_entry_len(const uint8_t *p, uint32_t avail);
+
+/**
+ * @brief Starts replaying the entries at frames (the ones following a DEVICE entry). Kept until the next call.
+ */
+void rf_replay_begin(const uint8_t *frames, uint32_t len);
+
+/**
+ * @brief Copies the statistics of the replay begun last.
+ */
+void rf_replay_get_stats(rfReplayStats *stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RF_REPLAY_H */
@@ -0,0 +1,354 @@
+/**
+ * @file rfal_rf_replay.c
+ *
+ * @brief rfal_rf.h on a frame capture: the transceives of the stack are answered from the trace.
+ *
+ * A transceive is complete as soon as it is started: rfalStartTransceive() takes the next TX entry,
+ * compares it with the frame the stack sends, and places the RX entry after it (status, length in
+ * bits, frame) on the caller context, as the ST25R3911 driver would once the frame is received.
+ * A divergence is counted but the recorded answer is still given, so the stack goes on as far as
+ * the trace lets it and the first divergence points at the layer that behaves differently.
+ *
+ * Setting functions only keep their value. Discovery commands (anticollision, short frames,
+ * FeliCa polling) are not replayed and return RFAL_ERR_NOTSUPP.
+ */
+
+#include <string.h>
+
+#include "rfal_rf.h"
+#include "rfal_dpo.h"
+#include "rfal_trace.h"
+#include "rfal_iso15693_2.h"
+#include "rf_replay.h"
+
+
+/*** LOCAL VARIABLES ***/
+
+static const uint8_t *replayPos;            // Next entry to be replayed
+static const uint8_t *replayEnd;            // End of the trace
+static rfReplayStats  replayStats;
+static ReturnCode     replayStatus = RFAL_ERR_NONE;   // Outcome of the transceive started last
+static bool           replayRx;             // Transceive started last expects a response
+
+static rfalMode       replayMode = RFAL_MODE_NONE;
+static rfalBitRate    replayTxBR = RFAL_BR_106;
+static rfalBitRate    replayRxBR = RFAL_BR_106;
+static uint32_t       replayFDTPoll;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)get16(p) | ((uint32_t)get16(&p[2]) << 16));
+}
+
+
+static void replay_transceive(const rfalTransceiveContext *ctx)
+{
+    const uint8_t *tx;
+    const uint8_t *rx;
+    uint32_t       txLen;
+    uint32_t       rxLen;
+    uint16_t       lenBits;
+    uint16_t       ctxBits;
+    uint16_t       len;
+
+    replayRx = (ctx->rxBuf != NULL);
+    replayStats.frames++;
+
+    /* The next entry must be the TX of this transceive, followed by its RX */
+    while ((replayPos < replayEnd) && (replayPos[0] == RFAL_TRACE_ENTRY_DEVICE))
+    {
+        replayPos += rf_replay_entry_len(replayPos, (uint32_t)(replayEnd - replayPos));
+    }
+    tx    = replayPos;
+    txLen = ((tx < replayEnd) ? rf_replay_entry_len(tx, (uint32_t)(replayEnd - tx)) : 0U);
+    if ((txLen == 0U) || (tx[0] != RFAL_TRACE_ENTRY_TX))
+    {
+        replayStats.beyondTrace++;
+        replayStatus = RFAL_ERR_TIMEOUT;
+        replayPos    = replayEnd;
+        return;
+    }
+    replayPos += txLen;
+
+    /* Same frame, same framing options and timeout as recorded */
+    lenBits = get16(&tx[16]);
+    ctxBits = ((ctx->txBuf != NULL) ? ctx->txBufLen : 0U);
+    if ((lenBits != ctxBits) || (get32(&tx[8]) != ctx->flags) || (get32(&tx[12]) != ctx->fwt) ||
+        ((lenBits != 0U) && (memcmp(&tx[RFAL_TRACE_TX_HDR_LEN], ctx->txBuf, rfalConvBitsToBytes(lenBits)) != 0)))
+    {
+        replayStats.diverged++;
+        if (replayStats.firstDiverged == 0U)
+        {
+            replayStats.firstDiverged = replayStats.frames;
+        }
+    }
+    replayStats.txBytes += rfalConvBitsToBytes(ctxBits);
+
+    rx    = replayPos;
+    rxLen = ((rx < replayEnd) ? rf_replay_entry_len(rx, (uint32_t)(replayEnd - rx)) : 0U);
+    if ((rxLen == 0U) || (rx[0] != RFAL_TRACE_ENTRY_RX))
+    {
+        replayStatus = RFAL_ERR_TIMEOUT;      // Transceive aborted on the reader: no answer recorded
+        return;
+    }
+    replayPos += rxLen;
+
+    replayStatus        = (ReturnCode)get16(&rx[5]);
+    lenBits             = get16(&rx[7]);
+    replayStats.rfTime += (get32(&rx[1]) - get32(&tx[1]));
+
+    if (ctx->rxRcvdLen != NULL)
+    {
+        (*ctx->rxRcvdLen) = lenBits;
+    }
+    if (ctx->rxBuf != NULL)
+    {
+        len = RFAL_MIN(get16(&rx[9]), rfalConvBitsToBytes(ctx->rxBufLen));
+        memcpy(ctx->rxBuf, &rx[RFAL_TRACE_RX_HDR_LEN], len);
+        replayStats.rxBytes += len;
+    }
+}
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+uint32_t rf_replay_entry_len(const uint8_t *p, uint32_t avail)
+{
+    uint32_t len;
+
+    if (avail == 0U)
+    {
+        return 0U;
+    }
+
+    switch (p[0])
+    {
+        case RFAL_TRACE_ENTRY_TX:
+            len = ((avail >= RFAL_TRACE_TX_HDR_LEN) ? (RFAL_TRACE_TX_HDR_LEN + rfalConvBitsToBytes(get16(&p[16]))) : 0U);
+            break;
+
+        case RFAL_TRACE_ENTRY_RX:
+            len = ((avail >= RFAL_TRACE_RX_HDR_LEN) ? (RFAL_TRACE_RX_HDR_LEN + get16(&p[9])) : 0U);
+            break;
+
+        case RFAL_TRACE_ENTRY_DEVICE:
+            len = ((avail >= RFAL_TRACE_DEVICE_HDR_LEN) ? (RFAL_TRACE_DEVICE_HDR_LEN + p[7]) : 0U);
+            break;
+
+        default:
+            len = 0U;
+            break;
+    }
+
+    return ((len <= avail) ? len : 0U);
+}
+
+
+void rf_replay_begin(const uint8_t *frames, uint32_t len)
+{
+    replayPos    = frames;
+    replayEnd    = &frames[len];
+    replayStatus = RFAL_ERR_NONE;
+    replayRx     = false;
+    memset(&replayStats, 0, sizeof(replayStats));
+}
+
+
+void rf_replay_get_stats(rfReplayStats *stats)
+{
+    (*stats) = replayStats;
+}
+
+
+/*** rfal_rf.h ***/
+
+ReturnCode rfalSetMode(rfalMode mode, rfalBitRate txBR, rfalBitRate rxBR)
+{
+    replayMode = mode;
+    replayTxBR = txBR;
+    replayRxBR = rxBR;
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalSetBitRate(rfalBitRate txBR, rfalBitRate rxBR)
+{
+    replayTxBR = ((txBR != RFAL_BR_KEEP) ? txBR : replayTxBR);
+    replayRxBR = ((rxBR != RFAL_BR_KEEP) ? rxBR : replayRxBR);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalGetBitRate(rfalBitRate *txBR, rfalBitRate *rxBR)
+{
+    if ((txBR == NULL) || (rxBR == NULL))
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    (*txBR) = replayTxBR;
+    (*rxBR) = replayRxBR;
+    return RFAL_ERR_NONE;
+}
+
+
+rfalMode rfalGetMode(void)
+{
+    return replayMode;
+}
+
+
+void rfalSetErrorHandling(rfalEHandling eHandling)  { (void)eHandling; }
+void rfalSetFDTListen(uint32_t FDTListen)           { (void)FDTListen; }
+void rfalSetFDTPoll(uint32_t FDTPoll)               { replayFDTPoll = FDTPoll; }
+uint32_t rfalGetFDTPoll(void)                       { return replayFDTPoll; }
+void rfalSetGT(uint32_t GT)                         { (void)GT; }
+ReturnCode rfalFieldOnAndStartGT(void)              { return RFAL_ERR_NONE; }
+void rfalWorker(void)                               { }
+
+
+ReturnCode rfalStartTransceive(const rfalTransceiveContext *ctx)
+{
+    if (ctx == NULL)
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    replay_transceive(ctx);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalGetTransceiveStatus(void)
+{
+    return replayStatus;
+}
+
+
+ReturnCode rfalTransceiveBlockingTx(uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt)
+{
+    rfalTransceiveContext ctx;
+
+    rfalCreateByteFlagsTxRxContext(ctx, txBuf, txBufLen, rxBuf, rxBufLen, actLen, flags, fwt);
+    replay_transceive(&ctx);
+
+    /* As the driver: once the frame is out, a response still to come is no error yet */
+    return (replayRx ? RFAL_ERR_NONE : replayStatus);
+}
+
+
+ReturnCode rfalTransceiveBlockingTxRx(uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt)
+{
+    rfalTransceiveContext ctx;
+
+    rfalCreateByteFlagsTxRxContext(ctx, txBuf, txBufLen, rxBuf, rxBufLen, actLen, flags, fwt);
+    replay_transceive(&ctx);
+
+    if (actLen != NULL)
+    {
+        *actLen = rfalConvBitsToBytes(*actLen);
+    }
+    return replayStatus;
+}
+
+
+ReturnCode rfalISO15693TransceiveEOF(uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *actLen)
+{
+    uint8_t dummy;
+
+    return rfalTransceiveBlockingTxRx(&dummy, 0, rxBuf, rxBufLen, actLen,
+                                      ((uint32_t)RFAL_TXRX_FLAGS_CRC_TX_MANUAL | (uint32_t)RFAL_TXRX_FLAGS_CRC_RX_KEEP | (uint32_t)RFAL_TXRX_FLAGS_AGC_ON),
+                                      rfalConv64fcTo1fc(ISO15693_FWT));
+}
+
+
+/*** Discovery: not replayed ***/
+
+ReturnCode rfalISO14443ATransceiveShortFrame(rfal14443AShortFrameCmd txCmd, uint8_t* rxBuf, uint8_t rxBufLen, uint16_t* rxRcvdLen, uint32_t fwt)
+{
+    (void)txCmd;
+    (void)rxBuf;
+    (void)rxBufLen;
+    (void)rxRcvdLen;
+    (void)fwt;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalISO14443AStartTransceiveAnticollisionFrame(uint8_t *buf, uint8_t *bytesToSend, uint8_t *bitsToSend, uint16_t *rxLength, uint32_t fwt)
+{
+    (void)buf;
+    (void)bytesToSend;
+    (void)bitsToSend;
+    (void)rxLength;
+    (void)fwt;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalISO14443AGetTransceiveAnticollisionFrameStatus(void)
+{
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalISO15693TransceiveAnticollisionFrame(uint8_t *txBuf, uint8_t txBufLen, uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    (void)txBuf;
+    (void)txBufLen;
+    (void)rxBuf;
+    (void)rxBufLen;
+    (void)actLen;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalISO15693TransceiveEOFAnticollision(uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    (void)rxBuf;
+    (void)rxBufLen;
+    (void)actLen;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalFeliCaPoll(rfalFeliCaPollSlots slots, uint16_t sysCode, uint8_t reqCode, rfalFeliCaPollRes* pollResList, uint8_t pollResListSize, uint8_t *devicesDetected, uint8_t *collisionsDetected)
+{
+    (void)slots;
+    (void)sysCode;
+    (void)reqCode;
+    (void)pollResList;
+    (void)pollResListSize;
+    (void)devicesDetected;
+    (void)collisionsDetected;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalStartFeliCaPoll(rfalFeliCaPollSlots slots, uint16_t sysCode, uint8_t reqCode, rfalFeliCaPollRes* pollResList, uint8_t pollResListSize, uint8_t *devicesDetected, uint8_t *collisionsDetected)
+{
+    (void)slots;
+    (void)sysCode;
+    (void)reqCode;
+    (void)pollResList;
+    (void)pollResListSize;
+    (void)devicesDetected;
+    (void)collisionsDetected;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalGetFeliCaPollStatus(void)
+{
+    return RFAL_ERR_NOTSUPP;
+}
+
+
+/*** rfal_dpo.h: no field to regulate in a replay, the SLP_REQ of rfal_nfca.c pauses no monitor ***/
+
+void rfalDpoPauseLinkMonitor(bool pause)
+{
+    (void)pause;
+}
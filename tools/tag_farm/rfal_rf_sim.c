@@ -0,0 +1,1103 @@
+/**
+ * @file rfal_rf_sim.c
+ *
+ * @brief rfal_rf.h on a simulated RF link: the frames of the stack are answered by the tag in the field.
+ *
+ * A transceive is complete as soon as it is started, its outcome placed on the caller context as
+ * the ST25R3911 driver would once the frame is received: CRC removed (kept with CRC_RX_KEEP),
+ * NFC-F LEN byte included, length in bits, RFAL_ERR_INCOMPLETE_BYTE for a 4 bit ACK/NACK.
+ *
+ * Cost model, per transceive:
+ *  - air time: guard time on each field on/GT start, the frame transmitted, the tag response time
+ *    (tag latencyUs, or FDT of the technology, plus the programming time of a write) and the frame
+ *    received, the FDT Poll of the reader before its next frame. A tag that keeps silent, or would
+ *    answer after the FWT, costs the FWT of the transceive. Frame lengths include CRC, SoF/EoF and,
+ *    for NFC-F, preamble and sync; NFC-A counts a parity bit per byte; NFC-V assumes the 1 out of 4
+ *    coding and the high data rate, one subcarrier, twice as fast on an ST fast command response.
+ *  - SPI bytes: set-up (clear FIFO, bytes to send, IRQ masks, transmit) and FIFO load, one read of
+ *    the IRQ registers per interrupt (TXE, RXS, RXE, or NRE on a timeout), FIFO status and FIFO
+ *    read; frames beyond the 96 byte FIFO add a water level interrupt every 64 bytes. NFC-V frames
+ *    go through the FIFO coded by the RFAL (4 bytes per byte sent, 2 per byte received). Setting a
+ *    mode or bit rate costs the register writes of an analog configuration.
+ *
+ * Errors injected (tag_farm_inject()) apply to the frames given to the tag model only.
+ *
+ * Several tags may be in the field (tag_farm_place_many()). The NFC-A tags all answer REQA/WUPA and
+ * the SDD_REQ of their cascade level: their answers are ORed on the air, the first bit they differ
+ * on reported as the collision, as the chip would; SEL_REQ then selects one of them, the other READY
+ * ones going back to IDLE. Each tag counts once on the air time, a single answer being heard.
+ * The NFC-F tags each answer a FeliCa Polling in a time slot drawn at random: a slot answered by
+ * more than one tag is a collision, reported as the chip reports a reception error.
+ */
+
+#include <string.h>
+
+#include "rfal_rf.h"
+#include "rfal_chip.h"
+#include "rfal_crc.h"
+#include "rfal_st25tb.h"
+#include "rfal_iso15693_2.h"
+#include "tag_farm.h"
+
+
+/*** Cost model ***/
+
+#define SIM_SPI_TX_SETUP        10U     // Clear FIFO, number of bytes to send, IRQ masks, transmit command
+#define SIM_SPI_IRQ              4U     // Read of the 3 IRQ status registers
+#define SIM_SPI_FIFO_STATUS      3U     // Read of the 2 FIFO status registers
+#define SIM_SPI_FIFO_CMD         1U     // FIFO load/read command byte
+#define SIM_SPI_MODE            32U     // Analog configuration of a mode or bit rate (~10 register writes)
+#define SIM_FIFO_LEN            96U     // ST25R3911 FIFO
+#define SIM_FIFO_WL             64U     // FIFO bytes moved per water level interrupt
+
+#define SIM_NFCV_TX_CODING       4U     // FIFO bytes per byte sent, NFC-V 1 out of 4
+#define SIM_NFCV_RX_CODING       2U     // FIFO bytes per byte received, NFC-V Manchester
+
+#define SIM_FC_PER_BIT_106     128U     // Bit duration at 106 kbps [1/fc], halved at each higher bit rate
+#define SIM_NFCV_FC_PER_BYTE  4096U     // NFC-V byte: 4 symbols of 1024/fc (VCD) or 8 bits of 512/fc (VICC)
+#define SIM_NFCV_FC_SOF_EOF   1536U     // NFC-V SoF + EoF
+#define SIM_NFCF_POLL_DELAY  32768U     // FeliCa Polling: 512 x 64/fc before the first time slot
+#define SIM_NFCF_POLL_SLOT   16384U     // FeliCa Polling: 256 x 64/fc per time slot
+
+#define SIM_FDT_NFCF_US       1000U     // FeliCa response time, when the tag gives none
+#define SIM_FDT_NFCV          4352U     // NFC-V t1 [1/fc]
+
+#define SIM_FC_TO_US(fc)        ((uint32_t)(((uint64_t)(fc) * 1000U) / 13560U))
+
+
+/*** LOCAL VARIABLES ***/
+
+static tagFarmTag    *simField[TAG_FARM_FIELD_MAX];     // Tags in the field
+static uint8_t        simFieldCnt;
+static tagFarmTag    *simTag;               // Tag answering the frame being handled
+static tagFarmStats   simStats;
+static ReturnCode     simStatus = RFAL_ERR_NONE;    // Outcome of the transceive started last
+static bool           simRx;                // Transceive started last expects a response
+static bool           simFieldOn;
+
+static rfalMode       simMode = RFAL_MODE_NONE;
+static rfalBitRate    simTxBR = RFAL_BR_106;
+static rfalBitRate    simRxBR = RFAL_BR_106;
+static uint32_t       simFDTPoll;
+static uint32_t       simGT;
+
+static uint8_t        simRes[1024];         // Response of the tag, room for CRC and LEN
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static tagFarmTech sim_mode_tech(bool *valid)
+{
+    *valid = true;
+    switch (simMode)
+    {
+        case RFAL_MODE_POLL_NFCA:
+        case RFAL_MODE_POLL_NFCA_T1T:
+            return TAG_FARM_TECH_NFCA;
+        case RFAL_MODE_POLL_NFCF:
+            return TAG_FARM_TECH_NFCF;
+        case RFAL_MODE_POLL_NFCV:
+            return TAG_FARM_TECH_NFCV;
+        default:
+            *valid = false;
+            return TAG_FARM_TECH_NFCA;
+    }
+}
+
+
+// A tag in the field hears the current mode and is powered.
+static bool sim_hears(const tagFarmTag *tag)
+{
+    bool        valid;
+    tagFarmTech tech = sim_mode_tech(&valid);
+
+    return (valid && (tag->tech == tech) && (tag->state != TAG_FARM_STATE_OFF));
+}
+
+
+// First tag of the field hearing the current mode, NULL if none.
+static tagFarmTag *sim_first_hearing(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < simFieldCnt; i++)
+    {
+        if (sim_hears(simField[i]))
+        {
+            return simField[i];
+        }
+    }
+    return NULL;
+}
+
+
+// Tag a frame for the models goes to: the NFC-A tag selected, the NFC-F tag of the NFCID2 sent,
+// otherwise the first tag hearing it.
+static tagFarmTag *sim_addressed(const uint8_t *req, uint16_t reqLen)
+{
+    tagFarmTag *tag;
+    uint8_t     i;
+
+    for (i = 0; i < simFieldCnt; i++)
+    {
+        tag = simField[i];
+        if (!sim_hears(tag))
+        {
+            continue;
+        }
+
+        if (tag->tech == TAG_FARM_TECH_NFCA)
+        {
+            if (tag->state == TAG_FARM_STATE_ACTIVE)
+            {
+                return tag;
+            }
+        }
+        else if ((tag->tech != TAG_FARM_TECH_NFCF) || (reqLen < 9U) || (memcmp(&req[1], tag->uid, 8U) == 0))
+        {
+            return tag;
+        }
+    }
+    return NULL;
+}
+
+
+// Duration of a frame of bits (CRC, LEN included) at the current mode and bit rate [1/fc].
+static uint32_t sim_frame_fc(uint32_t bits, bool tx)
+{
+    uint32_t    br     = (uint32_t)(tx ? simTxBR : simRxBR);
+    uint32_t    bitFc  = (SIM_FC_PER_BIT_106 >> ((br <= (uint32_t)RFAL_BR_848) ? br : 0U));
+    uint32_t    bytes  = (bits / 8U);
+    uint32_t    extra  = (bits % 8U);
+
+    switch (simMode)
+    {
+        case RFAL_MODE_POLL_NFCA:
+        case RFAL_MODE_POLL_NFCA_T1T:
+            return ((((bytes * 9U) + extra) + 2U) * bitFc);                 // Parity bit per byte, SoF/EoF
+
+        case RFAL_MODE_POLL_NFCB:
+            return ((((bytes * 10U) + extra) + 22U) * bitFc);               // Start/stop bits, SoF/EoF
+
+        case RFAL_MODE_POLL_NFCF:
+            return (((48U + 16U) + bits) * bitFc);                          // Preamble and sync
+
+        case RFAL_MODE_POLL_NFCV:
+            return (SIM_NFCV_FC_SOF_EOF + ((rfalConvBitsToBytes(bits) * SIM_NFCV_FC_PER_BYTE) >> (((!tx) && (simRxBR == RFAL_BR_52p97)) ? 1U : 0U)));
+
+        default:
+            return (bits * bitFc);
+    }
+}
+
+
+// Bytes through the FIFO for a frame of n bytes (CRC and LEN added by the chip, except for NFC-V).
+static uint32_t sim_fifo_bytes(uint32_t n, bool tx)
+{
+    if (simMode == RFAL_MODE_POLL_NFCV)
+    {
+        return ((n + RFAL_CRC_LEN) * (tx ? SIM_NFCV_TX_CODING : SIM_NFCV_RX_CODING));
+    }
+    return n;
+}
+
+
+static uint32_t sim_wl_irqs(uint32_t fifoBytes)
+{
+    return ((fifoBytes > SIM_FIFO_LEN) ? (((fifoBytes - SIM_FIFO_LEN) + (SIM_FIFO_WL - 1U)) / SIM_FIFO_WL) : 0U);
+}
+
+
+static uint32_t sim_crc_fc_bits(void)
+{
+    return rfalConvBytesToBits(RFAL_CRC_LEN);
+}
+
+
+// Frame sent by the reader: air time and SPI bytes.
+static void sim_account_tx(uint32_t bits, bool crc)
+{
+    uint32_t fifo = sim_fifo_bytes(rfalConvBitsToBytes(bits), true);
+
+    simStats.txrx++;
+    simStats.txBytes  += rfalConvBitsToBytes(bits);
+    simStats.airUs    += SIM_FC_TO_US(sim_frame_fc((bits + (crc ? sim_crc_fc_bits() : 0U) + ((simMode == RFAL_MODE_POLL_NFCF) ? 8U : 0U)), true));
+    simStats.spiBytes += (SIM_SPI_TX_SETUP + SIM_SPI_FIFO_CMD + fifo + SIM_SPI_IRQ + (sim_wl_irqs(fifo) * (SIM_SPI_IRQ + SIM_SPI_FIFO_CMD)));
+}
+
+
+// Response time of the tag: its latency, or the FDT of the technology, and the programming time.
+static uint32_t sim_response_us(void)
+{
+    uint32_t fdtUs = simTag->latencyUs;
+
+    if (fdtUs == 0U)
+    {
+        fdtUs = ((simTag->tech == TAG_FARM_TECH_NFCA) ? SIM_FC_TO_US(RFAL_FDT_LISTEN_NFCA_POLLER) :
+                 ((simTag->tech == TAG_FARM_TECH_NFCF) ? SIM_FDT_NFCF_US : SIM_FC_TO_US(SIM_FDT_NFCV)));
+    }
+    return (fdtUs + simTag->busyUs);
+}
+
+
+// Response of the tag: its response time, the frame, then the FDT Poll of the reader.
+static void sim_account_rx(uint32_t bits, bool crc)
+{
+    uint32_t fdtUs = sim_response_us();
+    uint32_t fifo  = sim_fifo_bytes(rfalConvBitsToBytes(bits), false);
+
+    simTag->busyUs     = 0U;
+    simStats.rxBytes  += rfalConvBitsToBytes(bits);
+    simStats.airUs    += (fdtUs + SIM_FC_TO_US(sim_frame_fc((bits + (crc ? sim_crc_fc_bits() : 0U)), false)) + SIM_FC_TO_US(simFDTPoll));
+    simStats.spiBytes += ((2U * SIM_SPI_IRQ) + SIM_SPI_FIFO_STATUS + SIM_SPI_FIFO_CMD + fifo + (sim_wl_irqs(fifo) * (SIM_SPI_IRQ + SIM_SPI_FIFO_STATUS + SIM_SPI_FIFO_CMD)));
+}
+
+
+// No response: the reader waits for the FWT.
+static void sim_account_timeout(uint32_t fwt)
+{
+    simStats.timeouts++;
+    simStats.airUs    += SIM_FC_TO_US((fwt != RFAL_FWT_NONE) ? fwt : 0U);
+    simStats.spiBytes += SIM_SPI_IRQ;
+}
+
+
+// Appends the CRC a chip configured to keep it would deliver.
+static uint16_t sim_append_crc(uint8_t *res, uint16_t len)
+{
+    uint16_t crc;
+
+    switch (simTag->tech)
+    {
+        case TAG_FARM_TECH_NFCA:
+            crc = rfalCrcCalculateCcitt(0x6363U, res, len);
+            res[len]      = (uint8_t)crc;
+            res[len + 1U] = (uint8_t)(crc >> 8);
+            break;
+
+        case TAG_FARM_TECH_NFCV:
+            crc = (uint16_t)~rfalCrcCalculateCcitt(0xFFFFU, res, len);
+            res[len]      = (uint8_t)crc;
+            res[len + 1U] = (uint8_t)(crc >> 8);
+            break;
+
+        default:
+            crc = rfalCrcCalculateCcitt(0x0000U, res, len);
+            res[len]      = (uint8_t)(crc >> 8);
+            res[len + 1U] = (uint8_t)crc;
+            break;
+    }
+
+    return (uint16_t)(len + RFAL_CRC_LEN);
+}
+
+
+// NFC-A cascade level cl (0..2) of the UID: 4 bytes (cascade tag first if more follow) and BCC.
+static bool sim_nfca_cl(const tagFarmTag *tag, uint8_t cl, uint8_t *out)
+{
+    uint8_t levels = ((tag->uidLen == 4U) ? 1U : ((tag->uidLen == 7U) ? 2U : 3U));
+    uint8_t pos    = (uint8_t)(cl * 3U);
+
+    if (cl >= levels)
+    {
+        return false;
+    }
+
+    if ((cl + 1U) < levels)
+    {
+        out[0] = 0x88U;                                 // Cascade tag
+        memcpy(&out[1], &tag->uid[pos], 3U);
+    }
+    else
+    {
+        memcpy(out, &tag->uid[pos], 4U);
+    }
+    out[4] = (uint8_t)(out[0] ^ out[1] ^ out[2] ^ out[3]);
+    return true;
+}
+
+
+// NFC-A frames handled by the link: SEL_REQ and HLTA. Returns true if the frame was one of them.
+static bool sim_nfca_activation(const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t *resBits, bool *answered)
+{
+    uint8_t     cl[5];
+    uint8_t     level;
+    uint8_t     i;
+    tagFarmTag *tag;
+
+    *answered = false;
+
+    if ((reqLen == 2U) && (req[0] == 0x50U) && (req[1] == 0x00U))
+    {
+        // HLTA: never answered, halts the tag selected, sends a READY one back to IDLE
+        for (i = 0; i < simFieldCnt; i++)
+        {
+            tag = simField[i];
+            if (sim_hears(tag) && ((tag->state == TAG_FARM_STATE_ACTIVE) || (tag->state == TAG_FARM_STATE_READY)))
+            {
+                tag->state = ((tag->state == TAG_FARM_STATE_ACTIVE) ? TAG_FARM_STATE_HALT : TAG_FARM_STATE_IDLE);
+            }
+        }
+        return true;
+    }
+
+    if ((reqLen == 7U) && ((req[0] == 0x93U) || (req[0] == 0x95U) || (req[0] == 0x97U)) && (req[1] == 0x70U))
+    {
+        level = (uint8_t)((req[0] - 0x93U) / 2U);
+        for (i = 0; i < simFieldCnt; i++)
+        {
+            tag = simField[i];
+            if (!sim_hears(tag) || (tag->state != TAG_FARM_STATE_READY) || (tag->cascadeLevel != level))
+            {
+                continue;
+            }
+            if (!sim_nfca_cl(tag, level, cl) || (memcmp(&req[2], cl, sizeof(cl)) != 0))
+            {
+                tag->state = TAG_FARM_STATE_IDLE;       // Another tag selected
+                continue;
+            }
+
+            simTag            = tag;
+            tag->cascadeLevel = (uint8_t)(level + 1U);
+            if (sim_nfca_cl(tag, tag->cascadeLevel, cl))
+            {
+                res[0] = 0x04U;                         // UID not complete
+            }
+            else
+            {
+                res[0]     = tag->sak;
+                tag->state = TAG_FARM_STATE_ACTIVE;
+            }
+            *resBits  = 8U;
+            *answered = true;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+
+// Error injected on the command given to the model now, if any.
+static tagFarmErr sim_injected(void)
+{
+    uint32_t n = simTag->commands++;
+
+    if ((simTag->errType == TAG_FARM_ERR_NONE) || (n < simTag->errFirst) || (((n - simTag->errFirst) % simTag->errPeriod) != 0U) ||
+        ((simTag->errCount != 0U) && (((n - simTag->errFirst) / simTag->errPeriod) >= simTag->errCount)))
+    {
+        return TAG_FARM_ERR_NONE;
+    }
+
+    simStats.injected++;
+    return simTag->errType;
+}
+
+
+// Command given to the model, the error injected on it applied.
+static bool sim_command(const uint8_t *req, uint16_t reqLen, uint16_t *resBits, uint32_t fwt, tagFarmErr *err)
+{
+    uint16_t resMax = (uint16_t)(sizeof(simRes) - RFAL_CRC_LEN - 1U);
+    bool     answered;
+
+    *err = sim_injected();
+    switch (*err)
+    {
+        case TAG_FARM_ERR_SILENT:
+            answered = false;
+            break;
+
+        case TAG_FARM_ERR_NACK:
+            answered = ((simTag->ops->nack != NULL) && simTag->ops->nack(simTag, req, reqLen, simRes, resMax, resBits));
+            break;
+
+        default:
+            answered = simTag->ops->command(simTag, req, reqLen, simRes, resMax, resBits);
+            break;
+    }
+
+    /* A response lost, or too late for the reader, is a timeout */
+    if (answered && ((*err == TAG_FARM_ERR_LOST) || ((fwt != RFAL_FWT_NONE) && (sim_response_us() > SIM_FC_TO_US(fwt)))))
+    {
+        answered = false;
+    }
+    if (!answered)
+    {
+        simTag->busyUs = 0U;
+    }
+    return answered;
+}
+
+
+static void sim_transceive(const rfalTransceiveContext *ctx)
+{
+    const uint8_t *req     = ctx->txBuf;
+    uint16_t       reqBits = ((ctx->txBuf != NULL) ? ctx->txBufLen : 0U);
+    uint16_t       reqLen  = rfalConvBitsToBytes(reqBits);
+    uint16_t       resBits = 0U;
+    uint16_t       resLen;
+    uint16_t       len;
+    bool           answered = false;
+    tagFarmErr     err      = TAG_FARM_ERR_NONE;
+    bool           crcKeep  = ((ctx->flags & (uint32_t)RFAL_TXRX_FLAGS_CRC_RX_KEEP) != 0U);
+    bool           crcTx    = ((ctx->flags & (uint32_t)RFAL_TXRX_FLAGS_CRC_TX_MANUAL) == 0U);
+    bool           valid;
+    bool           nfca     = ((sim_mode_tech(&valid) == TAG_FARM_TECH_NFCA) && valid);
+
+    simRx = (ctx->rxBuf != NULL);
+    sim_account_tx(reqBits, crcTx);
+
+    simTag = NULL;
+    if (!nfca || !sim_nfca_activation(req, reqLen, simRes, &resBits, &answered))
+    {
+        simTag = sim_addressed(req, reqLen);
+        if (simTag != NULL)
+        {
+            answered = sim_command(req, reqLen, &resBits, ctx->fwt, &err);
+        }
+    }
+
+    if (!answered)
+    {
+        sim_account_timeout(ctx->fwt);
+        simStatus = RFAL_ERR_TIMEOUT;
+        if (ctx->rxRcvdLen != NULL)
+        {
+            *ctx->rxRcvdLen = 0U;
+        }
+        return;
+    }
+
+    sim_account_rx(resBits, ((resBits % 8U) == 0U));
+
+    /* As delivered by the chip: LEN byte of NFC-F, CRC if kept */
+    resLen = rfalConvBitsToBytes(resBits);
+    if (simTag->tech == TAG_FARM_TECH_NFCF)
+    {
+        memmove(&simRes[1], simRes, resLen);
+        simRes[0] = (uint8_t)(resLen + 1U);
+        resLen++;
+        resBits = (uint16_t)rfalConvBytesToBits(resLen);
+    }
+    if (crcKeep && ((resBits % 8U) == 0U))
+    {
+        resLen  = sim_append_crc(simRes, resLen);
+        resBits = (uint16_t)rfalConvBytesToBits(resLen);
+    }
+
+    simStatus = ((err == TAG_FARM_ERR_CRC) ? RFAL_ERR_CRC : (((resBits % 8U) != 0U) ? RFAL_ERR_INCOMPLETE_BYTE : RFAL_ERR_NONE));
+    len       = resLen;
+    if ((ctx->rxBuf == NULL) || (resLen > rfalConvBitsToBytes(ctx->rxBufLen)))
+    {
+        len       = ((ctx->rxBuf != NULL) ? rfalConvBitsToBytes(ctx->rxBufLen) : 0U);
+        resBits   = (uint16_t)rfalConvBytesToBits(len);
+        simStatus = RFAL_ERR_NOMEM;
+    }
+    if (len > 0U)
+    {
+        memcpy(ctx->rxBuf, simRes, len);
+    }
+    if (ctx->rxRcvdLen != NULL)
+    {
+        *ctx->rxRcvdLen = resBits;
+    }
+}
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+void tag_farm_place(tagFarmTag *tag)
+{
+    tag_farm_place_many(&tag, ((tag != NULL) ? 1U : 0U));
+}
+
+
+void tag_farm_place_many(tagFarmTag *const *tags, uint8_t count)
+{
+    uint8_t i;
+
+    for (i = 0; i < simFieldCnt; i++)
+    {
+        if (simField[i]->ops->reset != NULL)
+        {
+            simField[i]->ops->reset(simField[i]);
+        }
+        simField[i]->state = TAG_FARM_STATE_OFF;
+    }
+
+    simTag      = NULL;
+    simFieldCnt = ((count <= TAG_FARM_FIELD_MAX) ? count : TAG_FARM_FIELD_MAX);
+    for (i = 0; i < simFieldCnt; i++)
+    {
+        simField[i]        = tags[i];
+        simField[i]->state = (simFieldOn ? TAG_FARM_STATE_IDLE : TAG_FARM_STATE_OFF);
+    }
+}
+
+
+void tag_farm_get_stats(tagFarmStats *stats)
+{
+    (*stats) = simStats;
+}
+
+
+void tag_farm_reset_stats(void)
+{
+    memset(&simStats, 0, sizeof(simStats));
+}
+
+
+void tag_farm_disc_params(rfalNfcDiscoverParam *param, uint16_t techs)
+{
+    rfalNfcDefaultDiscParams(param);
+    param->techs2Find    = techs;
+    param->maxBR         = RFAL_BR_848;
+    param->nfcfBR        = RFAL_BR_212;
+    param->totalDuration = TAG_FARM_DISC_DURATION;
+}
+
+
+bool tag_farm_discover(const rfalNfcDiscoverParam *param, rfalNfcDevice **dev)
+{
+    unsigned n;
+
+    if (rfalNfcDiscover(param) != RFAL_ERR_NONE)
+    {
+        return false;
+    }
+    for (n = 0; n < TAG_FARM_WORKER_MAX; n++)
+    {
+        rfalNfcWorker();
+        if (rfalNfcIsDevActivated(rfalNfcGetState()))
+        {
+            return (rfalNfcGetActiveDevice(dev) == RFAL_ERR_NONE);
+        }
+    }
+    return false;
+}
+
+
+/*** rfal_rf.h ***/
+
+ReturnCode rfalInitialize(void)
+{
+    simMode    = RFAL_MODE_NONE;
+    simFieldOn = false;
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalSetMode(rfalMode mode, rfalBitRate txBR, rfalBitRate rxBR)
+{
+    simMode  = mode;
+    simTxBR  = txBR;
+    simRxBR  = rxBR;
+    simStats.spiBytes += SIM_SPI_MODE;
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalSetBitRate(rfalBitRate txBR, rfalBitRate rxBR)
+{
+    simTxBR = ((txBR != RFAL_BR_KEEP) ? txBR : simTxBR);
+    simRxBR = ((rxBR != RFAL_BR_KEEP) ? rxBR : simRxBR);
+    simStats.spiBytes += SIM_SPI_MODE;
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalGetBitRate(rfalBitRate *txBR, rfalBitRate *rxBR)
+{
+    if ((txBR == NULL) || (rxBR == NULL))
+    {
+        return RFAL_ERR_PARAM;
+    }
+
+    (*txBR) = simTxBR;
+    (*rxBR) = simRxBR;
+    return RFAL_ERR_NONE;
+}
+
+
+rfalMode rfalGetMode(void)
+{
+    return simMode;
+}
+
+
+void rfalSetErrorHandling(rfalEHandling eHandling)  { (void)eHandling; }
+void rfalSetFDTListen(uint32_t FDTListen)           { (void)FDTListen; }
+void rfalSetFDTPoll(uint32_t FDTPoll)               { simFDTPoll = FDTPoll; }
+uint32_t rfalGetFDTPoll(void)                       { return simFDTPoll; }
+void rfalSetGT(uint32_t GT)                         { simGT = GT; }
+bool rfalIsGTExpired(void)                          { return true; }
+void rfalWorker(void)                               { }
+
+
+ReturnCode rfalFieldOnAndStartGT(void)
+{
+    uint8_t i;
+
+    for (i = 0; (!simFieldOn) && (i < simFieldCnt); i++)
+    {
+        simField[i]->state = TAG_FARM_STATE_IDLE;   // Tags powered
+    }
+    simFieldOn = true;
+
+    /* The GT timer is started on each call, field already on or not */
+    simStats.airUs += SIM_FC_TO_US((simGT != RFAL_GT_NONE) ? simGT : 0U);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalFieldOff(void)
+{
+    uint8_t i;
+
+    simFieldOn = false;
+    for (i = 0; i < simFieldCnt; i++)
+    {
+        if (simField[i]->ops->reset != NULL)
+        {
+            simField[i]->ops->reset(simField[i]);
+        }
+        simField[i]->state = TAG_FARM_STATE_OFF;
+    }
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalStartTransceive(const rfalTransceiveContext *ctx)
+{
+    if (ctx == NULL)
+    {
+        return RFAL_ERR_PARAM;
+    }
+    if (!simFieldOn && (ctx->txBuf != NULL))
+    {
+        return RFAL_ERR_WRONG_STATE;            // As the driver: no frame sent with the field off
+    }
+
+    sim_transceive(ctx);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalGetTransceiveStatus(void)
+{
+    return simStatus;
+}
+
+
+ReturnCode rfalTransceiveBlockingTx(uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt)
+{
+    rfalTransceiveContext ctx;
+    ReturnCode            ret;
+
+    rfalCreateByteFlagsTxRxContext(ctx, txBuf, txBufLen, rxBuf, rxBufLen, actLen, flags, fwt);
+    RFAL_EXIT_ON_ERR(ret, rfalStartTransceive(&ctx));
+
+    /* As the driver: once the frame is out, a response still to come is no error yet */
+    return (simRx ? RFAL_ERR_NONE : simStatus);
+}
+
+
+ReturnCode rfalTransceiveBlockingRx(void)
+{
+    return simStatus;
+}
+
+
+ReturnCode rfalTransceiveBlockingTxRx(uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt)
+{
+    rfalTransceiveContext ctx;
+    ReturnCode            ret;
+
+    rfalCreateByteFlagsTxRxContext(ctx, txBuf, txBufLen, rxBuf, rxBufLen, actLen, flags, fwt);
+    RFAL_EXIT_ON_ERR(ret, rfalStartTransceive(&ctx));
+
+    if (actLen != NULL)
+    {
+        *actLen = rfalConvBitsToBytes(*actLen);
+    }
+    return simStatus;
+}
+
+
+ReturnCode rfalISO15693TransceiveEOF(uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *actLen)
+{
+    uint8_t dummy;
+
+    return rfalTransceiveBlockingTxRx(&dummy, 0, rxBuf, rxBufLen, actLen,
+                                      ((uint32_t)RFAL_TXRX_FLAGS_CRC_TX_MANUAL | (uint32_t)RFAL_TXRX_FLAGS_CRC_RX_KEEP | (uint32_t)RFAL_TXRX_FLAGS_AGC_ON),
+                                      rfalConv64fcTo1fc(ISO15693_FWT));
+}
+
+
+/*** Activation ***/
+
+ReturnCode rfalISO14443ATransceiveShortFrame(rfal14443AShortFrameCmd txCmd, uint8_t* rxBuf, uint8_t rxBufLen, uint16_t* rxRcvdLen, uint32_t fwt)
+{
+    tagFarmTag *tag;
+    bool        coll = false;
+    uint8_t     i;
+
+    sim_account_tx(7U, false);
+
+    /* Every tag not selected answers, a halted one to WUPA only; ATQAs that differ collide */
+    simTag = NULL;
+    for (i = 0; (rxBuf != NULL) && (rxBufLen >= 16U) && (i < simFieldCnt); i++)
+    {
+        tag = simField[i];
+        if (!sim_hears(tag) || (tag->state == TAG_FARM_STATE_ACTIVE) ||
+            ((tag->state == TAG_FARM_STATE_HALT) && (txCmd != RFAL_14443A_SHORTFRAME_CMD_WUPA)))
+        {
+            continue;
+        }
+
+        if (simTag == NULL)
+        {
+            simTag   = tag;
+            rxBuf[0] = 0x00U;
+            rxBuf[1] = 0x00U;
+        }
+        coll |= ((tag->atqa[0] != simTag->atqa[0]) || (tag->atqa[1] != simTag->atqa[1]));
+        rxBuf[0] |= tag->atqa[0];
+        rxBuf[1] |= tag->atqa[1];
+
+        tag->state        = TAG_FARM_STATE_READY;
+        tag->cascadeLevel = 0U;
+    }
+    if (simTag == NULL)
+    {
+        sim_account_timeout(fwt);
+        *rxRcvdLen = 0U;
+        return RFAL_ERR_TIMEOUT;
+    }
+
+    *rxRcvdLen = 16U;
+    sim_account_rx(16U, false);
+    return (coll ? RFAL_ERR_RF_COLLISION : RFAL_ERR_NONE);
+}
+
+
+ReturnCode rfalISO14443AStartTransceiveAnticollisionFrame(uint8_t *buf, uint8_t *bytesToSend, uint8_t *bitsToSend, uint16_t *rxLength, uint32_t fwt)
+{
+    uint8_t     cl[5];
+    uint8_t     ref[5];
+    uint8_t     known = (uint8_t)(*bytesToSend - 2U);   // SDD_REQ bytes of the UID already sent
+    uint8_t     mask  = (uint8_t)((1U << *bitsToSend) - 1U);
+    uint32_t    bits  = (rfalConvBytesToBits(*bytesToSend) + *bitsToSend);
+    uint32_t    sent  = (rfalConvBytesToBits(known) + *bitsToSend);     // UID bits sent by the reader
+    uint32_t    coll  = rfalConvBytesToBits(sizeof(cl));                // First UID bit the answers differ on
+    uint32_t    pos;
+    tagFarmTag *tag;
+    uint8_t     i;
+
+    sim_account_tx(bits, false);
+
+    /* Every READY tag of the cascade level answers if the bits sent so far are its own */
+    simTag = NULL;
+    for (i = 0; (known <= sizeof(cl)) && (i < simFieldCnt); i++)
+    {
+        tag = simField[i];
+        if (!sim_hears(tag) || (tag->state != TAG_FARM_STATE_READY) || (buf[0] != (uint8_t)(0x93U + (2U * tag->cascadeLevel))) ||
+            !sim_nfca_cl(tag, tag->cascadeLevel, cl) ||
+            (memcmp(&buf[2], cl, known) != 0) || ((*bitsToSend != 0U) && ((buf[*bytesToSend] & mask) != (cl[known] & mask))))
+        {
+            continue;
+        }
+
+        if (simTag == NULL)
+        {
+            simTag = tag;
+            memcpy(ref, cl, sizeof(ref));
+            continue;
+        }
+        for (pos = sent; pos < coll; pos++)
+        {
+            if ((((ref[pos / 8U] ^ cl[pos / 8U]) >> (pos % 8U)) & 1U) != 0U)
+            {
+                coll = pos;
+                break;
+            }
+        }
+    }
+    if (simTag == NULL)
+    {
+        sim_account_timeout(fwt);
+        *rxLength = 0U;
+        simStatus = RFAL_ERR_TIMEOUT;
+        return RFAL_ERR_NONE;
+    }
+
+    /* The tags answer up to the BCC; the bits received are those before the collision, if any */
+    memcpy(&buf[2], ref, sizeof(ref));
+    simStatus = RFAL_ERR_NONE;
+    *rxLength = (uint16_t)(coll - sent);
+    if (coll < rfalConvBytesToBits(sizeof(ref)))
+    {
+        buf[2U + (coll / 8U)] &= (uint8_t)((1U << (coll % 8U)) - 1U);
+        memset(&buf[3U + (coll / 8U)], 0, ((sizeof(ref) - 1U) - (coll / 8U)));
+        *bytesToSend = (uint8_t)(2U + (coll / 8U));
+        *bitsToSend  = (uint8_t)(coll % 8U);
+        simStatus    = RFAL_ERR_RF_COLLISION;
+    }
+
+    sim_account_rx((rfalConvBytesToBits(sizeof(ref)) - sent), false);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalISO14443AGetTransceiveAnticollisionFrameStatus(void)
+{
+    return simStatus;
+}
+
+
+ReturnCode rfalISO15693TransceiveAnticollisionFrame(uint8_t *txBuf, uint8_t txBufLen, uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    uint8_t  maskLen = ((txBufLen >= 3U) ? txBuf[2] : 0U);
+    uint8_t  i;
+    uint16_t len;
+
+    sim_account_tx(rfalConvBytesToBits(txBufLen), (txBufLen != 0U));
+
+    /* INVENTORY, 1 slot: answered by the first tag whose UID (LSB first) the mask matches */
+    simTag = sim_first_hearing();
+    bool answer = ((simTag != NULL) && (txBufLen >= 3U) && (txBuf[1] == 0x01U) && (maskLen <= 64U) && (txBufLen >= (3U + rfalConvBitsToBytes(maskLen))));
+    for (i = 0; answer && (i < maskLen); i++)
+    {
+        answer = ((((txBuf[3U + (i / 8U)] ^ simTag->uid[i / 8U]) >> (i % 8U)) & 1U) == 0U);
+    }
+    if (!answer)
+    {
+        sim_account_timeout(rfalConv64fcTo1fc(ISO15693_FWT));
+        *actLen = 0U;
+        return RFAL_ERR_TIMEOUT;
+    }
+
+    simTag->state = TAG_FARM_STATE_ACTIVE;
+    simRes[0] = 0x00U;
+    simRes[1] = simTag->dsfid;
+    memcpy(&simRes[2], simTag->uid, 8U);
+    len = sim_append_crc(simRes, 10U);                 // CRC kept on anticollision
+
+    memcpy(rxBuf, simRes, RFAL_MIN(len, (uint16_t)rxBufLen));
+    *actLen = (uint16_t)rfalConvBytesToBits(RFAL_MIN(len, (uint16_t)rxBufLen));
+
+    sim_account_rx(rfalConvBytesToBits(10U), true);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalISO15693TransceiveEOFAnticollision(uint8_t *rxBuf, uint8_t rxBufLen, uint16_t *actLen)
+{
+    (void)rxBuf;
+    (void)rxBufLen;
+
+    /* Next slot of a 16 slot INVENTORY: a single tag already answered in slot 0 */
+    sim_account_tx(0U, false);
+    sim_account_timeout(rfalConv64fcTo1fc(ISO15693_FWT));
+    *actLen = 0U;
+    return RFAL_ERR_TIMEOUT;
+}
+
+
+static ReturnCode simFeliCaStatus = RFAL_ERR_TIMEOUT;
+static uint32_t   simSlotRng      = 0x9E3779B9U;    // Time Slots drawn by the NFC-F tags, the same on every run
+
+
+// SENSF_RES of a tag: LEN, 01h, NFCID2, PAD, RD (system code) if requested.
+static void sim_sensf_res(const tagFarmTag *tag, uint8_t reqCode, uint8_t *res)
+{
+    memset(res, 0, RFAL_FELICA_POLL_RES_LEN);
+    res[0] = ((reqCode == (uint8_t)RFAL_FELICA_POLL_RC_SYSTEM_CODE) ? 20U : 18U);
+    res[1] = 0x01U;
+    memcpy(&res[2], tag->uid, 8U);
+    res[10 + 4] = 0x10U;                                // PAD0/PAD1
+    res[10 + 5] = 0x0BU;                                // MRTIcheck
+    res[10 + 6] = 0x0BU;                                // MRTIupdate
+    if (reqCode == (uint8_t)RFAL_FELICA_POLL_RC_SYSTEM_CODE)
+    {
+        res[18] = (uint8_t)(tag->sysCode >> 8);
+        res[19] = (uint8_t)tag->sysCode;
+    }
+}
+
+
+ReturnCode rfalStartFeliCaPoll(rfalFeliCaPollSlots slots, uint16_t sysCode, uint8_t reqCode, rfalFeliCaPollRes* pollResList, uint8_t pollResListSize, uint8_t *devicesDetected, uint8_t *collisionsDetected)
+{
+    tagFarmTag *slotTag[RFAL_FELICA_POLL_MAX_SLOTS];
+    uint8_t     slotCnt[RFAL_FELICA_POLL_MAX_SLOTS];
+    uint8_t     numSlots = (uint8_t)RFAL_MIN(((uint32_t)slots + 1U), RFAL_FELICA_POLL_MAX_SLOTS);
+    uint8_t     found    = 0U;
+    uint8_t     coll     = 0U;
+    uint8_t     slot;
+    uint8_t     i;
+    tagFarmTag *tag;
+
+    sim_account_tx(rfalConvBytesToBits(5U), true);
+
+    /* The reader listens up to the end of the last time slot, whether answered or not */
+    simStats.airUs += SIM_FC_TO_US(SIM_NFCF_POLL_DELAY + (((uint32_t)slots + 1U) * SIM_NFCF_POLL_SLOT));
+
+    /* Each tag of the system code answers in a time slot of its own choice: alone it is received,
+     * with others the slot is a collision. A single tag is always received. */
+    memset(slotCnt, 0, sizeof(slotCnt));
+    for (i = 0; i < simFieldCnt; i++)
+    {
+        tag = simField[i];
+        if (!sim_hears(tag) ||
+            !((((sysCode >> 8) == 0xFFU) || ((sysCode >> 8) == (tag->sysCode >> 8))) &&
+              (((sysCode & 0xFFU) == 0xFFU) || ((sysCode & 0xFFU) == (tag->sysCode & 0xFFU)))))
+        {
+            continue;
+        }
+
+        simSlotRng ^= (simSlotRng << 13);
+        simSlotRng ^= (simSlotRng >> 17);
+        simSlotRng ^= (simSlotRng << 5);
+        slot = (uint8_t)(simSlotRng % numSlots);
+
+        slotTag[slot] = tag;
+        slotCnt[slot]++;
+    }
+
+    for (slot = 0; slot < numSlots; slot++)
+    {
+        if (slotCnt[slot] == 1U)
+        {
+            tag = slotTag[slot];
+            if ((pollResList != NULL) && (found < pollResListSize))
+            {
+                sim_sensf_res(tag, reqCode, pollResList[found]);
+            }
+            found++;
+
+            simTag     = tag;
+            tag->state = TAG_FARM_STATE_ACTIVE;
+            simStats.rxBytes  += ((reqCode == (uint8_t)RFAL_FELICA_POLL_RC_SYSTEM_CODE) ? 19U : 17U);
+            simStats.spiBytes += ((2U * SIM_SPI_IRQ) + SIM_SPI_FIFO_STATUS + SIM_SPI_FIFO_CMD + RFAL_FELICA_POLL_RES_LEN);
+        }
+        else if (slotCnt[slot] > 1U)
+        {
+            coll++;
+            simStats.spiBytes += ((2U * SIM_SPI_IRQ) + SIM_SPI_FIFO_STATUS);   // Reception in error
+        }
+        else
+        {
+            /* Empty slot */
+        }
+    }
+
+    if (devicesDetected != NULL)
+    {
+        *devicesDetected = found;
+    }
+    if (collisionsDetected != NULL)
+    {
+        *collisionsDetected = coll;
+    }
+    if ((found == 0U) && (coll == 0U))
+    {
+        simStats.timeouts++;
+        simStats.spiBytes += SIM_SPI_IRQ;
+    }
+
+    simFeliCaStatus = (((found != 0U) || (coll != 0U)) ? RFAL_ERR_NONE : RFAL_ERR_TIMEOUT);
+    return RFAL_ERR_NONE;
+}
+
+
+ReturnCode rfalGetFeliCaPollStatus(void)
+{
+    return simFeliCaStatus;
+}
+
+
+ReturnCode rfalFeliCaPoll(rfalFeliCaPollSlots slots, uint16_t sysCode, uint8_t reqCode, rfalFeliCaPollRes* pollResList, uint8_t pollResListSize, uint8_t *devicesDetected, uint8_t *collisionsDetected)
+{
+    RFAL_NO_WARNING(rfalStartFeliCaPoll(slots, sysCode, reqCode, pollResList, pollResListSize, devicesDetected, collisionsDetected));
+    return rfalGetFeliCaPollStatus();
+}
+
+
+/*** Not simulated: the chip itself, listen and wake-up modes, ST25TB ***/
+
+ReturnCode rfalChipChangeRegBits(uint16_t reg, uint8_t valueMask, uint8_t value)
+{
+    (void)reg;
+    (void)valueMask;
+    (void)value;
+    return RFAL_ERR_NONE;
+}
+
+ReturnCode rfalChipChangeTestRegBits(uint16_t reg, uint8_t valueMask, uint8_t value)
+{
+    (void)reg;
+    (void)valueMask;
+    (void)value;
+    return RFAL_ERR_NONE;
+}
+
+ReturnCode rfalChipSetRFO(uint8_t rfo)
+{
+    (void)rfo;
+    return RFAL_ERR_NONE;
+}
+
+ReturnCode rfalChipMeasureAmplitude(uint8_t* result)                                      { *result = 0U; return RFAL_ERR_NONE; }
+
+ReturnCode rfalListenStart(uint32_t lmMask, const rfalLmConfPA *confA, const rfalLmConfPB *confB, const rfalLmConfPF *confF, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rxLen)
+{
+    (void)lmMask;
+    (void)confA;
+    (void)confB;
+    (void)confF;
+    (void)rxBuf;
+    (void)rxBufLen;
+    (void)rxLen;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalListenSleepStart(rfalLmState sleepSt, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rxLen)
+{
+    (void)sleepSt;
+    (void)rxBuf;
+    (void)rxBufLen;
+    (void)rxLen;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalListenStop(void)                                                           { return rfalFieldOff(); }
+
+rfalLmState rfalListenGetState(bool *dataFlag, rfalBitRate *lastBR)
+{
+    (void)dataFlag;
+    (void)lastBR;
+    return RFAL_LM_STATE_NOT_INIT;
+}
+
+ReturnCode rfalListenSetState(rfalLmState newSt)
+{
+    (void)newSt;
+    return RFAL_ERR_NOTSUPP;
+}
+
+ReturnCode rfalWakeUpModeStart(const rfalWakeUpConfig *config)
+{
+    (void)config;
+    return RFAL_ERR_NOTSUPP;
+}
+
+bool rfalWakeUpModeHasWoke(void)                                                          { return false; }
+ReturnCode rfalWakeUpModeStop(void)                                                       { return RFAL_ERR_NONE; }
+
+ReturnCode rfalSt25tbPollerInitialize(void)                                               { return RFAL_ERR_NOTSUPP; }
+
+ReturnCode rfalSt25tbPollerCheckPresence(uint8_t *chipId)
+{
+    (void)chipId;
+    return RFAL_ERR_TIMEOUT;
+}
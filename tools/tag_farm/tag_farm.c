@@ -0,0 +1,86 @@
+/**
+ * @file tag_farm.c
+ *
+ * @brief Common part of the tag models, and the host CPU timer of the tools.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tag_farm.h"
+
+
+/*** LOCAL VARIABLES ***/
+
+static uint32_t tagSerial = 0x00A5C300U;    // UID serial part, one per tag created
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+void tag_farm_init(tagFarmTag *tag, const char *name, tagFarmTech tech, const tagFarmOps *ops,
+                   const uint8_t *uidPrefix, uint8_t prefixLen, uint8_t uidLen, uint32_t memLen)
+{
+    uint8_t i;
+
+    memset(tag, 0, sizeof(*tag));
+    tag->name  = name;
+    tag->tech  = tech;
+    tag->ops   = ops;
+    tag->state = TAG_FARM_STATE_OFF;
+
+    tagSerial++;
+    tag->uidLen = uidLen;
+    if (prefixLen > 0U)
+    {
+        memcpy(tag->uid, uidPrefix, prefixLen);
+    }
+    for (i = prefixLen; i < uidLen; i++)
+    {
+        tag->uid[i] = (uint8_t)(tagSerial >> (8U * ((i - prefixLen) % 4U)));
+    }
+
+    tag->mem    = (uint8_t *)calloc(memLen, 1U);
+    tag->memLen = memLen;
+}
+
+
+void tag_farm_free(tagFarmTag *tag)
+{
+    free(tag->mem);
+    free(tag->priv);
+    tag->mem    = NULL;
+    tag->priv   = NULL;
+    tag->memLen = 0U;
+}
+
+
+bool tag_farm_set_image(tagFarmTag *tag, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if ((offset > tag->memLen) || (len > (tag->memLen - offset)))
+    {
+        return false;
+    }
+
+    memcpy(&tag->mem[offset], data, len);
+    return true;
+}
+
+
+void tag_farm_inject(tagFarmTag *tag, tagFarmErr type, uint32_t first, uint32_t period, uint32_t count)
+{
+    tag->errType   = type;
+    tag->errFirst  = first;
+    tag->errPeriod = ((period != 0U) ? period : 1U);
+    tag->errCount  = count;
+    tag->commands  = 0U;
+}
+
+
+uint32_t tag_farm_cpu_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint32_t)((ts.tv_sec * 1000000UL) + (ts.tv_nsec / 1000));
+}
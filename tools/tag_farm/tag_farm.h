@@ -0,0 +1,280 @@
+/**
+ * @file tag_farm.h
+ *
+ * @brief Software NFC tags behind a simulated RF link, for running the RFAL/NDEF stack on a host.
+ *
+ * rfal_rf_sim.c implements, in place of the ST25R3911 driver, the rfal_rf.h functions the RFAL
+ * protocol layers, rfal_nfc.c and the NDEF pollers link against. Each frame the stack transmits is
+ * handed to the tags placed in the field, which answer it as the real tags would:
+ *  - activation is done by the link for every tag of a technology: NFC-A ATQA/anticollision/SAK/
+ *    HLTA, NFC-F polling, NFC-V inventory; several NFC-A tags collide bit by bit, NFC-F tags in
+ *    the time slots of a Polling, as on the air;
+ *  - every other frame goes to the tag model (tag_t2t.c, tag_t3t.c, tag_t4t.c, tag_t5t.c), CRC
+ *    and NFC-F LEN byte removed, as the reader chip delivers them.
+ *
+ * A tag is configured through its memory image (tag_farm_set_image(), or load of an NDEF message),
+ * its response time (latencyUs, writeUs) and the errors injected on its commands (tag_farm_inject()):
+ * a run is deterministic, the same commands getting the same responses and the same errors.
+ *
+ * The link counts what a transceive costs on the reader: exchanges, bytes over the air, bytes on
+ * the SPI bus of the ST25R3911 and the air time, from a cost model documented in rfal_rf_sim.c.
+ * Only the frames are simulated: no time passes on the host while a frame is in the air.
+ *
+ * The tools running the stack on the farm share its discovery up to the activation of a tag
+ * (tag_farm_disc_params(), tag_farm_discover()) and the host CPU timer (tag_farm_cpu_us()).
+ */
+
+#ifndef TAG_FARM_H
+#define TAG_FARM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rfal_nfc.h"
+
+
+#define TAG_FARM_UID_MAX_LEN    10U     // Longest UID/NFCID of a tag (NFCID1 triple size)
+#define TAG_FARM_FIELD_MAX      64U     // Tags in the field at once
+#define TAG_FARM_WORKER_MAX  10000U     // rfalNfcWorker() calls up to the activation
+#define TAG_FARM_DISC_DURATION  10U     // Discovery total duration [ms]
+
+
+/*** Technology of a tag, selecting the activation done by the link ***/
+typedef enum
+{
+    TAG_FARM_TECH_NFCA,                 // ISO14443A: T2T, T4T
+    TAG_FARM_TECH_NFCF,                 // FeliCa: T3T
+    TAG_FARM_TECH_NFCV                  // ISO15693: T5T
+} tagFarmTech;
+
+
+/*** Tag state, as in the activity state machines (NFC-F/V tags go straight to ACTIVE) ***/
+typedef enum
+{
+    TAG_FARM_STATE_OFF,                 // Out of the field, or field off
+    TAG_FARM_STATE_IDLE,                // Powered, waiting for REQA/WUPA
+    TAG_FARM_STATE_READY,               // NFC-A anticollision ongoing
+    TAG_FARM_STATE_ACTIVE,              // Selected: protocol commands answered
+    TAG_FARM_STATE_HALT                 // NFC-A halted, woken by WUPA only
+} tagFarmState;
+
+
+/*** Error injected on a command of the tag model ***/
+typedef enum
+{
+    TAG_FARM_ERR_NONE,
+    TAG_FARM_ERR_SILENT,                // Command not received: no response, not executed
+    TAG_FARM_ERR_NACK,                  // Command refused: error response of the protocol, not executed
+    TAG_FARM_ERR_CRC,                   // Command executed, response received with a CRC error
+    TAG_FARM_ERR_LOST                   // Command executed, response lost: the reader times out
+} tagFarmErr;
+
+
+typedef struct tagFarmTag tagFarmTag;
+
+
+/*** Operations of a tag model ***/
+typedef struct
+{
+    /**
+     * @brief Answers a command received in ACTIVE state.
+     *
+     * @param[in]  req     : command as received, CRC and LEN byte removed
+     * @param[in]  reqLen  : command length in bytes
+     * @param[out] res     : response, CRC and LEN byte to be added by the link
+     * @param[in]  resMax  : response buffer length
+     * @param[out] resBits : response length in bits (4 for a T2T ACK/NACK)
+     *
+     * @return true if the tag answers, false if it keeps silent
+     */
+    bool (*command)(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits);
+
+    /**
+     * @brief Answers a command with the error response of the protocol, without executing it
+     *        (TAG_FARM_ERR_NACK). Parameters as command().
+     */
+    bool (*nack)(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits);
+
+    /**
+     * @brief Tag powered down: volatile state lost, memory kept.
+     */
+    void (*reset)(tagFarmTag *tag);
+
+    /**
+     * @brief Writes an NDEF message onto the formatted memory, as a reader would leave it.
+     *
+     * @return false if the message does not fit
+     */
+    bool (*load)(tagFarmTag *tag, const uint8_t *msg, uint32_t msgLen);
+} tagFarmOps;
+
+
+/*** A tag: what the link needs to activate it, and its model ***/
+struct tagFarmTag
+{
+    const char         *name;           // Product name, e.g. "NTAG215"
+    tagFarmTech         tech;
+    const tagFarmOps   *ops;
+    tagFarmState        state;
+
+    uint8_t             uid[TAG_FARM_UID_MAX_LEN];  // NFCID1, NFCID2 or UID (NFC-V: LSB first, as on air)
+    uint8_t             uidLen;
+    uint8_t             atqa[2];        // NFC-A SENS_RES
+    uint8_t             sak;            // NFC-A SEL_RES of the last cascade level
+    uint8_t             cascadeLevel;   // NFC-A: cascade level being resolved
+    uint16_t            sysCode;        // NFC-F system code (0x12FC for NDEF)
+    uint8_t             dsfid;          // NFC-V DSFID
+
+    uint32_t            latencyUs;      // Response time of the tag: from the end of a command to its response
+    uint32_t            writeUs;        // Programming time of a block/page written, added to the response time
+    uint32_t            busyUs;         // Set by the model: programming time of the command being answered
+
+    tagFarmErr          errType;        // Errors injected, see tag_farm_inject()
+    uint32_t            errFirst;
+    uint32_t            errPeriod;
+    uint32_t            errCount;
+    uint32_t            commands;       // Commands given to the model since the injection was set
+
+    uint8_t            *mem;            // Memory image (owned by the model)
+    uint32_t            memLen;
+    uint32_t            dataLen;        // NDEF area / file size
+    void               *priv;           // Model state
+};
+
+
+/*** Cost of the transceives done on the simulated link ***/
+typedef struct
+{
+    uint32_t txrx;                      // Transceives (frames sent by the reader)
+    uint32_t timeouts;                  // Transceives with no response
+    uint32_t txBytes;                   // Bytes sent, CRC excluded
+    uint32_t rxBytes;                   // Bytes received, CRC excluded
+    uint32_t spiBytes;                  // Bytes on the ST25R3911 SPI bus (modelled)
+    uint32_t airUs;                     // Air time: guard times, frames, FDTs and timeouts (modelled)
+    uint32_t injected;                  // Errors injected
+} tagFarmStats;
+
+
+/**
+ * @brief Places a tag in the field (NULL: empty field). The tag is powered on the next field on.
+ */
+void tag_farm_place(tagFarmTag *tag);
+
+/**
+ * @brief Places count tags in the field at once (up to TAG_FARM_FIELD_MAX), in place of those there.
+ *        The NFC-A tags are told apart by the anticollision; an NFC-F command goes to the tag of the
+ *        NFCID2 it carries; any other frame to the first tag hearing it.
+ */
+void tag_farm_place_many(tagFarmTag *const *tags, uint8_t count);
+
+/**
+ * @brief Copies the costs accumulated since the last reset.
+ */
+void tag_farm_get_stats(tagFarmStats *stats);
+
+/**
+ * @brief Clears the accumulated costs.
+ */
+void tag_farm_reset_stats(void);
+
+/**
+ * @brief Copies len bytes into the memory image of a tag at offset (T3T: block 0 the Attribute
+ *        Information Block; T4T: the CC file, then the NDEF file).
+ *
+ * @return false if out of the memory
+ */
+bool tag_farm_set_image(tagFarmTag *tag, uint32_t offset, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Injects errors on the commands given to the tag model (activation frames excluded),
+ *        counted from 0 from now: on command first, then every period commands, count times
+ *        (0: without end). TAG_FARM_ERR_NONE stops the injection.
+ */
+void tag_farm_inject(tagFarmTag *tag, tagFarmErr type, uint32_t first, uint32_t period, uint32_t count);
+
+
+/**
+ * @brief Discovery parameters of the tools: polling of the technologies techs as the demo, but a
+ *        single poll per discovery (no wake-up mode, no reacquire of the last tag). The deactivation
+ *        keeps the field off up to the end of the total duration: shortened to TAG_FARM_DISC_DURATION,
+ *        as host time is not air time.
+ */
+void tag_farm_disc_params(rfalNfcDiscoverParam *param, uint16_t techs);
+
+/**
+ * @brief Discovery up to the activation of the tag in the field, in at most TAG_FARM_WORKER_MAX
+ *        rfalNfcWorker() calls.
+ *
+ * @return false if no tag was activated
+ */
+bool tag_farm_discover(const rfalNfcDiscoverParam *param, rfalNfcDevice **dev);
+
+/**
+ * @brief CPU time of the host process [us], wrapping at 32 bits.
+ */
+uint32_t tag_farm_cpu_us(void);
+
+
+/**
+ * @brief NXP NTAG21x style T2T: 7 byte UID, dataLen bytes of user memory (NTAG213: 144, NTAG215: 504, NTAG216: 888).
+ *        Beyond 1 KB of memory, sectors of 256 blocks are reached by SECTOR SELECT.
+ */
+void tag_t2t_init(tagFarmTag *tag, const char *name, uint16_t dataLen);
+
+/**
+ * @brief FeliCa T3T: NDEF area of numBlocks 16 byte blocks, Nbr/Nbw blocks per CHECK/UPDATE (FeliCa Lite-S: 13, 4, 1).
+ */
+void tag_t3t_init(tagFarmTag *tag, const char *name, uint16_t numBlocks, uint8_t nbr, uint8_t nbw);
+
+/**
+ * @brief Type 4A tag with the NDEF Tag Application: NDEF file of fileLen bytes, MLe/MLc announced in the CC file.
+ */
+void tag_t4t_init(tagFarmTag *tag, const char *name, uint16_t fileLen, uint16_t mle, uint16_t mlc);
+
+/**
+ * @brief Applet of a T4T: answers a C-APDU, returns the R-APDU length (status word included).
+ */
+typedef uint16_t (*tagT4tApplet)(void *ctx, const uint8_t *capdu, uint16_t capduLen, uint8_t *rapdu, uint16_t rapduMax);
+
+/**
+ * @brief Replaces the NDEF Tag Application of a T4T by applet (NULL: back to the model's own),
+ *        ISO-DEP still done by the model. The CC file and NDEF file of the model are then unused.
+ */
+void tag_t4t_set_applet(tagFarmTag *tag, tagT4tApplet applet, void *ctx);
+
+#define TAG_T5T_EXTENDED        0x01U   // Extended commands (required beyond 256 blocks)
+#define TAG_T5T_WRITE_MULTIPLE  0x02U   // (EXTENDED) WRITE MULTIPLE BLOCKS, up to 4 blocks
+#define TAG_T5T_FAST            0x04U   // ST FAST READ SINGLE/MULTIPLE and FAST EXTENDED READ (mfgCode 0x02)
+#define TAG_T5T_MAILBOX         0x08U   // ST25DV fast transfer mode mailbox (mfgCode 0x02)
+
+/**
+ * @brief T5T of numBlocks blocks of blockLen bytes. mfgCode 0x02 (ST) or 0x04 (NXP); features the
+ *        TAG_T5T_ commands answered on top of READ/WRITE SINGLE BLOCK and READ MULTIPLE BLOCKS.
+ */
+void tag_t5t_init(tagFarmTag *tag, const char *name, uint8_t mfgCode, uint16_t numBlocks, uint8_t blockLen, uint8_t features);
+
+/**
+ * @brief Releases the memory of a tag model.
+ */
+void tag_farm_free(tagFarmTag *tag);
+
+
+/*** For the tag models ***/
+
+/**
+ * @brief Common part of a model constructor: name, technology, operations, a serial UID of uidLen
+ *        bytes after the manufacturer byte(s) given, memory of memLen bytes cleared.
+ */
+void tag_farm_init(tagFarmTag *tag, const char *name, tagFarmTech tech, const tagFarmOps *ops,
+                   const uint8_t *uidPrefix, uint8_t prefixLen, uint8_t uidLen, uint32_t memLen);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TAG_FARM_H */
@@ -0,0 +1,258 @@
+/**
+ * @file tag_t2t.c
+ *
+ * @brief NFC Forum Type 2 Tag, as the NXP NTAG21x: 7 byte UID, CC in block 3, NDEF area from block 4.
+ *
+ * Commands: READ, FAST_READ, WRITE, GET_VERSION and SECTOR SELECT.
+ *
+ * Memory: blocks 0-2 UID, BCCs and static lock bytes, block 3 the CC (one time programmable), then
+ * dataLen bytes of user memory, then the dynamic lock and configuration pages. READ answers 4
+ * blocks, rolling over to block 0 past the last block; an address beyond the memory is NACKed.
+ * Beyond 1 KB, the memory is split in sectors of 256 blocks, addressed in the sector selected.
+ * A WRITE takes writeUs (NTAG21x: 4.1 ms).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tag_farm.h"
+
+
+#define T2T_BLOCK_LEN           4U
+#define T2T_READ_LEN           16U      // READ: 4 blocks
+#define T2T_AREA_OFFSET        16U      // User memory from block 4
+#define T2T_CFG_LEN            20U      // Dynamic lock and configuration pages (NTAG21x: 5 pages)
+
+#define T2T_SECTOR_LEN       1024U      // 256 blocks
+#define T2T_CC_BLOCK            3U
+#define T2T_WRITE_US         4100U
+
+#define T2T_CMD_GET_VERSION  0x60U
+#define T2T_CMD_READ         0x30U
+#define T2T_CMD_FAST_READ    0x3AU
+#define T2T_CMD_WRITE        0xA2U
+#define T2T_CMD_SECTOR_SEL   0xC2U
+
+#define T2T_ACK              0x0AU
+#define T2T_NACK_INVALID     0x00U      // Invalid argument
+#define T2T_NACK_CRC         0x01U      // Parity or CRC error
+
+
+/*** Model state ***/
+typedef struct
+{
+    uint8_t  sector;                    // Sector selected
+    bool     sectorSelect;              // SECTOR SELECT packet 1 acknowledged: packet 2 expected
+} t2tPriv;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+// 4 bit ACK or NACK.
+static bool t2t_ack_nack(uint8_t code, uint8_t *res, uint16_t *resBits)
+{
+    res[0]   = code;
+    *resBits = 4U;
+    return true;
+}
+
+
+// Memory address of a block of the sector selected.
+static uint32_t t2t_addr(const tagFarmTag *tag, uint8_t block)
+{
+    return ((((const t2tPriv *)tag->priv)->sector * T2T_SECTOR_LEN) + ((uint32_t)block * T2T_BLOCK_LEN));
+}
+
+
+// GET_VERSION: NTAG21x, storage size byte 2 x log2(dataLen), + 1 if not a power of 2.
+static bool t2t_version(const tagFarmTag *tag, uint8_t *res, uint16_t *resBits)
+{
+    uint8_t n = 0U;
+
+    while ((2UL << n) <= tag->dataLen)
+    {
+        n++;
+    }
+
+    res[0] = 0x00U;                             // Fixed header
+    res[1] = 0x04U;                             // NXP
+    res[2] = 0x04U;                             // NTAG
+    res[3] = 0x02U;                             // 50 pF
+    res[4] = 0x01U;                             // Version 1.0
+    res[5] = 0x00U;
+    res[6] = (uint8_t)((2U * n) + (((1UL << n) != tag->dataLen) ? 1U : 0U));
+    res[7] = 0x03U;                             // ISO14443-3
+    *resBits = (8U * 8U);
+    return true;
+}
+
+
+static bool t2t_command(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    t2tPriv *p = (t2tPriv *)tag->priv;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t i;
+
+    /* SECTOR SELECT packet 2: passive ACK, no response if the sector exists */
+    if (p->sectorSelect)
+    {
+        p->sectorSelect = false;
+        if ((reqLen != 4U) || (((uint32_t)req[0] * T2T_SECTOR_LEN) >= tag->memLen))
+        {
+            return t2t_ack_nack(T2T_NACK_INVALID, res, resBits);
+        }
+        p->sector = req[0];
+        return false;
+    }
+
+    if ((reqLen == 2U) && (req[0] == T2T_CMD_READ))
+    {
+        addr = t2t_addr(tag, req[1]);
+        if ((addr >= tag->memLen) || (resMax < T2T_READ_LEN))
+        {
+            return t2t_ack_nack(T2T_NACK_INVALID, res, resBits);
+        }
+        for (i = 0; i < T2T_READ_LEN; i++)
+        {
+            res[i] = tag->mem[(addr + i) % tag->memLen];
+        }
+        *resBits = (T2T_READ_LEN * 8U);
+        return true;
+    }
+
+    if ((reqLen == 3U) && (req[0] == T2T_CMD_FAST_READ))
+    {
+        addr = t2t_addr(tag, req[1]);
+        len  = ((req[2] >= req[1]) ? (((uint32_t)(req[2] - req[1]) + 1U) * T2T_BLOCK_LEN) : 0U);
+        if ((len == 0U) || ((addr + len) > tag->memLen) || (len > resMax))
+        {
+            return t2t_ack_nack(T2T_NACK_INVALID, res, resBits);
+        }
+        memcpy(res, &tag->mem[addr], len);
+        *resBits = (uint16_t)(len * 8U);
+        return true;
+    }
+
+    if ((reqLen == 6U) && (req[0] == T2T_CMD_WRITE))
+    {
+        addr = t2t_addr(tag, req[1]);
+        if ((addr < (2U * T2T_BLOCK_LEN)) || ((addr + T2T_BLOCK_LEN) > tag->memLen))
+        {
+            return t2t_ack_nack(T2T_NACK_INVALID, res, resBits);
+        }
+        for (i = 0; i < T2T_BLOCK_LEN; i++)
+        {
+            /* The CC bits can be set, never cleared */
+            tag->mem[addr + i] = ((addr == (T2T_CC_BLOCK * T2T_BLOCK_LEN)) ? (uint8_t)(tag->mem[addr + i] | req[2U + i]) : req[2U + i]);
+        }
+        tag->busyUs = tag->writeUs;
+        return t2t_ack_nack(T2T_ACK, res, resBits);
+    }
+
+    if ((reqLen == 1U) && (req[0] == T2T_CMD_GET_VERSION))
+    {
+        return t2t_version(tag, res, resBits);
+    }
+
+    if ((reqLen == 2U) && (req[0] == T2T_CMD_SECTOR_SEL) && (req[1] == 0xFFU))
+    {
+        if (tag->memLen <= T2T_SECTOR_LEN)
+        {
+            return t2t_ack_nack(T2T_NACK_INVALID, res, resBits);
+        }
+        p->sectorSelect = true;
+        return t2t_ack_nack(T2T_ACK, res, resBits);
+    }
+
+    /* Unknown command: the tag goes IDLE silently */
+    tag->state = TAG_FARM_STATE_IDLE;
+    return false;
+}
+
+
+static bool t2t_error(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    (void)req;
+    (void)reqLen;
+    (void)resMax;
+
+    ((t2tPriv *)tag->priv)->sectorSelect = false;
+    return t2t_ack_nack(T2T_NACK_CRC, res, resBits);
+}
+
+
+static void t2t_reset(tagFarmTag *tag)
+{
+    t2tPriv *p = (t2tPriv *)tag->priv;
+
+    p->sector       = 0U;
+    p->sectorSelect = false;
+}
+
+
+static bool t2t_load(tagFarmTag *tag, const uint8_t *msg, uint32_t msgLen)
+{
+    uint8_t *p   = &tag->mem[T2T_AREA_OFFSET];
+    uint32_t tlv = (msgLen + ((msgLen < 0xFFU) ? 2U : 4U));
+
+    if ((tlv + ((tlv < tag->dataLen) ? 1U : 0U)) > tag->dataLen)
+    {
+        return false;
+    }
+
+    memset(p, 0, tag->dataLen);
+    *p++ = 0x03U;                               // NDEF Message TLV
+    if (msgLen < 0xFFU)
+    {
+        *p++ = (uint8_t)msgLen;
+    }
+    else
+    {
+        *p++ = 0xFFU;
+        *p++ = (uint8_t)(msgLen >> 8);
+        *p++ = (uint8_t)msgLen;
+    }
+    memcpy(p, msg, msgLen);
+    if (tlv < tag->dataLen)
+    {
+        p[msgLen] = 0xFEU;                      // Terminator TLV
+    }
+    return true;
+}
+
+
+static const tagFarmOps t2tOps = { t2t_command, t2t_error, t2t_reset, t2t_load };
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+void tag_t2t_init(tagFarmTag *tag, const char *name, uint16_t dataLen)
+{
+    static const uint8_t nxp[] = { 0x04U };
+    uint8_t             *m;
+
+    tag_farm_init(tag, name, TAG_FARM_TECH_NFCA, &t2tOps, nxp, sizeof(nxp), 7U, (T2T_AREA_OFFSET + dataLen + T2T_CFG_LEN));
+    tag->atqa[0]  = 0x44U;
+    tag->atqa[1]  = 0x00U;
+    tag->sak      = 0x00U;
+    tag->dataLen  = dataLen;
+    tag->writeUs  = T2T_WRITE_US;
+    tag->priv     = calloc(1U, sizeof(t2tPriv));
+
+    /* UID0-2, BCC0, UID3-6, BCC1, internal, static lock bytes, CC */
+    m = tag->mem;
+    memcpy(&m[0], &tag->uid[0], 3U);
+    m[3] = (uint8_t)(0x88U ^ m[0] ^ m[1] ^ m[2]);
+    memcpy(&m[4], &tag->uid[3], 4U);
+    m[8]  = (uint8_t)(m[4] ^ m[5] ^ m[6] ^ m[7]);
+    m[9]  = 0x48U;
+    m[12] = 0xE1U;                              // CC: magic, version 1.0, size / 8, read/write access
+    m[13] = 0x10U;
+    m[14] = (uint8_t)(dataLen / 8U);
+    m[15] = 0x00U;
+
+    /* Initialised: empty NDEF Message TLV */
+    m[T2T_AREA_OFFSET]      = 0x03U;
+    m[T2T_AREA_OFFSET + 2U] = 0xFEU;
+}
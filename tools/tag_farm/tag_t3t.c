@@ -0,0 +1,316 @@
+/**
+ * @file tag_t3t.c
+ *
+ * @brief NFC Forum Type 3 Tag: FeliCa with system code 12FCh, the NDEF services 000Bh (read only)
+ *        and 0009h (read/write).
+ *
+ * Memory: block 0 the Attribute Information Block, then numBlocks blocks of NDEF area. CHECK
+ * answers up to Nbr blocks of the NDEF services, in the order of the block list; UPDATE writes up
+ * to Nbw blocks of the read/write service, writeUs per block.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tag_farm.h"
+
+
+#define T3T_BLOCK_LEN           16U
+#define T3T_SERVICE_RO      0x000BU     // NDEF service, read without encryption
+#define T3T_SERVICE_RW      0x0009U     // NDEF service, read/write without encryption
+#define T3T_WRITE_US         1000U
+
+#define T3T_CMD_CHECK         0x06U
+#define T3T_RES_CHECK         0x07U
+#define T3T_CMD_UPDATE        0x08U
+#define T3T_RES_UPDATE        0x09U
+
+#define T3T_ST1_ERROR         0x01U     // Status flag 1: error in the block list
+#define T3T_ST1_FAIL          0xFFU     // Status flag 1: error not specific to a block
+#define T3T_ST2_MEMORY        0x70U     // Status flag 2: memory error
+#define T3T_ST2_BLOCK         0xA2U     // Status flag 2: block count out of range
+#define T3T_ST2_SERVICE       0xA6U     // Status flag 2: service code
+
+
+/*** Model state ***/
+typedef struct
+{
+    uint8_t nbr;                        // Blocks per CHECK
+    uint8_t nbw;                        // Blocks per UPDATE
+} t3tPriv;
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static void t3t_attribute(tagFarmTag *tag, uint32_t ln)
+{
+    const t3tPriv *p   = (const t3tPriv *)tag->priv;
+    uint8_t       *a   = tag->mem;
+    uint16_t       sum = 0U;
+    uint8_t        i;
+
+    memset(a, 0, T3T_BLOCK_LEN);
+    a[0]  = 0x10U;                              // Version 1.0
+    a[1]  = p->nbr;
+    a[2]  = p->nbw;
+    a[3]  = (uint8_t)((tag->dataLen / T3T_BLOCK_LEN) >> 8);     // Nmaxb
+    a[4]  = (uint8_t)(tag->dataLen / T3T_BLOCK_LEN);
+    a[9]  = 0x00U;                              // WriteFlag OFF
+    a[10] = 0x01U;                              // RWFlag: read/write
+    a[11] = (uint8_t)(ln >> 16);
+    a[12] = (uint8_t)(ln >> 8);
+    a[13] = (uint8_t)ln;
+    for (i = 0; i < 14U; i++)
+    {
+        sum = (uint16_t)(sum + a[i]);
+    }
+    a[14] = (uint8_t)(sum >> 8);
+    a[15] = (uint8_t)sum;
+}
+
+
+// Service codes of a CHECK/UPDATE: false if one is not an NDEF service (read/write only if write).
+static bool t3t_services(const uint8_t *req, uint8_t nos, bool write)
+{
+    uint16_t svc;
+    uint8_t  i;
+
+    for (i = 0; i < nos; i++)
+    {
+        svc = (uint16_t)(req[10U + (2U * i)] | (req[11U + (2U * i)] << 8));
+        if ((svc != T3T_SERVICE_RW) && (write || (svc != T3T_SERVICE_RO)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Block list element at pos: 2 bytes (80h | service, block) or 3 bytes (service, block LE).
+static bool t3t_block(const uint8_t *req, uint16_t reqLen, uint16_t *pos, uint16_t *blk)
+{
+    if ((*pos < reqLen) && ((req[*pos] & 0x80U) != 0U) && ((*pos + 1U) < reqLen))
+    {
+        *blk  = req[*pos + 1U];
+        *pos += 2U;
+        return true;
+    }
+    if ((*pos + 2U) < reqLen)
+    {
+        *blk  = (uint16_t)(req[*pos + 1U] | (req[*pos + 2U] << 8));
+        *pos += 3U;
+        return true;
+    }
+    return false;
+}
+
+
+// CHECK: [06h, NFCID2, NoS, service codes, NoB, block list] -> [07h, NFCID2, ST1, ST2, NoB, blocks]
+static bool t3t_check(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    const t3tPriv *p   = (const t3tPriv *)tag->priv;
+    uint16_t       pos;
+    uint16_t       blk;
+    uint8_t        nos;
+    uint8_t        nob;
+    uint8_t        i;
+    uint8_t        st1 = 0x00U;
+    uint8_t        st2 = 0x00U;
+
+    if ((reqLen < 11U) || (memcmp(&req[1], tag->uid, 8U) != 0))
+    {
+        return false;
+    }
+
+    nos = req[9];
+    pos = (uint16_t)(10U + (2U * nos));
+    if ((nos == 0U) || (reqLen < (pos + 1U)))
+    {
+        return false;
+    }
+    if (!t3t_services(req, nos, false))
+    {
+        st1 = T3T_ST1_ERROR;
+        st2 = T3T_ST2_SERVICE;
+    }
+
+    nob = req[pos++];
+    if ((nob == 0U) || (nob > p->nbr) || ((uint16_t)(12U + (nob * T3T_BLOCK_LEN)) > resMax))
+    {
+        st1 = T3T_ST1_ERROR;
+        st2 = T3T_ST2_BLOCK;
+    }
+
+    res[0] = T3T_RES_CHECK;
+    memcpy(&res[1], tag->uid, 8U);
+    for (i = 0; (st1 == 0x00U) && (i < nob); i++)
+    {
+        if (!t3t_block(req, reqLen, &pos, &blk))
+        {
+            return false;
+        }
+
+        if (((uint32_t)(blk + 1U) * T3T_BLOCK_LEN) > tag->memLen)
+        {
+            st1 = T3T_ST1_ERROR;
+            st2 = T3T_ST2_BLOCK;
+            break;
+        }
+        memcpy(&res[12U + (i * T3T_BLOCK_LEN)], &tag->mem[blk * T3T_BLOCK_LEN], T3T_BLOCK_LEN);
+    }
+
+    res[9]  = st1;
+    res[10] = st2;
+    if (st1 != 0x00U)
+    {
+        *resBits = (11U * 8U);                  // No block data on an error
+        return true;
+    }
+    res[11]  = nob;
+    *resBits = (uint16_t)((12U + (nob * T3T_BLOCK_LEN)) * 8U);
+    return true;
+}
+
+
+// UPDATE: [08h, NFCID2, NoS, service codes, NoB, block list, blocks] -> [09h, NFCID2, ST1, ST2]
+static bool t3t_update(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t *resBits)
+{
+    const t3tPriv *p   = (const t3tPriv *)tag->priv;
+    uint16_t       blks[UINT8_MAX];
+    uint16_t       pos;
+    uint8_t        nos;
+    uint8_t        nob;
+    uint8_t        i;
+    uint8_t        st1 = 0x00U;
+    uint8_t        st2 = 0x00U;
+
+    if ((reqLen < 11U) || (memcmp(&req[1], tag->uid, 8U) != 0))
+    {
+        return false;
+    }
+
+    nos = req[9];
+    pos = (uint16_t)(10U + (2U * nos));
+    if ((nos == 0U) || (reqLen < (pos + 1U)))
+    {
+        return false;
+    }
+    nob = req[pos++];
+    for (i = 0; i < nob; i++)
+    {
+        if (!t3t_block(req, reqLen, &pos, &blks[i]))
+        {
+            return false;
+        }
+    }
+    if ((uint32_t)(pos + (nob * T3T_BLOCK_LEN)) > reqLen)
+    {
+        return false;
+    }
+
+    if (!t3t_services(req, nos, true))
+    {
+        st1 = T3T_ST1_ERROR;
+        st2 = T3T_ST2_SERVICE;
+    }
+    else if ((nob == 0U) || (nob > p->nbw))
+    {
+        st1 = T3T_ST1_ERROR;
+        st2 = T3T_ST2_BLOCK;
+    }
+    for (i = 0; (st1 == 0x00U) && (i < nob); i++)
+    {
+        if (((uint32_t)(blks[i] + 1U) * T3T_BLOCK_LEN) > tag->memLen)
+        {
+            st1 = T3T_ST1_ERROR;
+            st2 = T3T_ST2_BLOCK;
+        }
+    }
+    for (i = 0; (st1 == 0x00U) && (i < nob); i++)
+    {
+        memcpy(&tag->mem[blks[i] * T3T_BLOCK_LEN], &req[pos + (i * T3T_BLOCK_LEN)], T3T_BLOCK_LEN);
+    }
+    if (st1 == 0x00U)
+    {
+        tag->busyUs = (tag->writeUs * nob);
+    }
+
+    res[0] = T3T_RES_UPDATE;
+    memcpy(&res[1], tag->uid, 8U);
+    res[9]   = st1;
+    res[10]  = st2;
+    *resBits = (11U * 8U);
+    return true;
+}
+
+
+static bool t3t_command(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    if ((reqLen > 0U) && (req[0] == T3T_CMD_CHECK))
+    {
+        return t3t_check(tag, req, reqLen, res, resMax, resBits);
+    }
+    if ((reqLen > 0U) && (req[0] == T3T_CMD_UPDATE))
+    {
+        return t3t_update(tag, req, reqLen, res, resBits);
+    }
+    return false;
+}
+
+
+// CHECK/UPDATE answered with a memory error.
+static bool t3t_error(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    (void)resMax;
+
+    if ((reqLen < 9U) || ((req[0] != T3T_CMD_CHECK) && (req[0] != T3T_CMD_UPDATE)) || (memcmp(&req[1], tag->uid, 8U) != 0))
+    {
+        return false;
+    }
+
+    res[0] = (uint8_t)(req[0] + 1U);
+    memcpy(&res[1], tag->uid, 8U);
+    res[9]   = T3T_ST1_FAIL;
+    res[10]  = T3T_ST2_MEMORY;
+    *resBits = (11U * 8U);
+    return true;
+}
+
+
+static bool t3t_load(tagFarmTag *tag, const uint8_t *msg, uint32_t msgLen)
+{
+    if (msgLen > tag->dataLen)
+    {
+        return false;
+    }
+
+    memset(&tag->mem[T3T_BLOCK_LEN], 0, tag->dataLen);
+    memcpy(&tag->mem[T3T_BLOCK_LEN], msg, msgLen);
+    t3t_attribute(tag, msgLen);
+    return true;
+}
+
+
+static const tagFarmOps t3tOps = { t3t_command, t3t_error, NULL, t3t_load };
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+void tag_t3t_init(tagFarmTag *tag, const char *name, uint16_t numBlocks, uint8_t nbr, uint8_t nbw)
+{
+    static const uint8_t felica[] = { 0x02U, 0xFEU };      // NFCID2 of an NFC-F tag: 02FEh
+    t3tPriv             *p;
+
+    tag_farm_init(tag, name, TAG_FARM_TECH_NFCF, &t3tOps, felica, sizeof(felica), 8U, ((uint32_t)(numBlocks + 1U) * T3T_BLOCK_LEN));
+    tag->sysCode = 0x12FCU;
+    tag->dataLen = ((uint32_t)numBlocks * T3T_BLOCK_LEN);
+    tag->writeUs = T3T_WRITE_US;
+
+    p = (t3tPriv *)calloc(1U, sizeof(t3tPriv));
+    p->nbr    = nbr;
+    p->nbw    = nbw;
+    tag->priv = p;
+
+    t3t_attribute(tag, 0U);
+}
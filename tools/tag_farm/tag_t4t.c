@@ -0,0 +1,426 @@
+/**
+ * @file tag_t4t.c
+ *
+ * @brief NFC Forum Type 4A Tag: ISO-DEP listener and the NDEF Tag Application, mapping version 2.0.
+ *
+ * ISO-DEP: RATS answered with ATS 05 78 80 70 00 (FSC 256, 106 kbps only, FWI 7, no CID/NAD), then
+ * I-blocks, chained both ways when beyond FSD/FSC, R(ACK), R(NAK) (last block sent again, or R(ACK)
+ * if the block of the reader was not received) and S(DESELECT). Applet: SELECT of the
+ * NDEF application and of the CC (E103h) and NDEF (E104h) files, READ BINARY on the file selected
+ * and UPDATE BINARY on the NDEF file, Le beyond MLe or Lc beyond MLc refused.
+ *
+ * Memory: the 15 byte CC file, then the NDEF file of dataLen bytes (NLEN included). An UPDATE
+ * BINARY takes writeUs per 16 bytes page written.
+ *
+ * The applet can be replaced (tag_t4t_set_applet()): the C-APDUs reassembled by the ISO-DEP
+ * listener are then answered by another implementation, e.g. a card emulation engine.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tag_farm.h"
+
+
+#define T4T_CC_LEN              15U
+#define T4T_FID_CC          0xE103U
+#define T4T_FID_NDEF        0xE104U
+#define T4T_APDU_MAX           512U     // Longest C-APDU received / R-APDU sent
+#define T4T_PAGE_LEN            16U     // EEPROM page
+#define T4T_WRITE_US          1000U
+
+#define T4T_PCB_I             0x02U     // I-block
+#define T4T_PCB_R             0xA2U     // R-block (ACK)
+#define T4T_PCB_S_DESELECT    0xC2U
+#define T4T_PCB_CHAINING      0x10U
+#define T4T_PCB_NAK           0x10U
+#define T4T_PCB_BN            0x01U
+
+#define T4T_SW_OK           0x9000U
+#define T4T_SW_WRONG_LENGTH 0x6700U
+#define T4T_SW_MEMORY       0x6581U
+#define T4T_SW_SECURITY     0x6982U
+#define T4T_SW_NOT_FOUND    0x6A82U
+#define T4T_SW_WRONG_P1P2   0x6B00U
+#define T4T_SW_NO_FILE      0x6986U
+#define T4T_SW_INS          0x6D00U
+#define T4T_SW_CLA          0x6E00U
+
+
+/*** Model state ***/
+typedef struct
+{
+    bool     ats;                       // RATS answered: ISO-DEP blocks expected
+    bool     appSelected;               // NDEF Tag Application selected
+    uint16_t file;                      // File selected, 0 if none
+    uint16_t fsd;                       // Frame size of the reader
+    uint16_t mle;                       // MLe/MLc announced in the CC file
+    uint16_t mlc;
+
+    uint8_t  capdu[T4T_APDU_MAX];       // C-APDU being received (chaining)
+    uint16_t capduLen;
+    uint8_t  rapdu[T4T_APDU_MAX + 2U];  // R-APDU being sent (chaining)
+    uint16_t rapduLen;
+    uint16_t rapduPos;
+    uint8_t  bn;                        // Block number of the last block received
+    uint8_t  last[256];                 // Last block sent, again on R(NAK)
+    uint16_t lastBits;
+
+    tagT4tApplet applet;                // Applet replacing the NDEF Tag Application, NULL if none
+    void        *appletCtx;
+} t4tPriv;
+
+
+/*** LOCAL VARIABLES ***/
+
+static const uint16_t fsdTable[] = { 16U, 24U, 32U, 40U, 48U, 64U, 96U, 128U, 256U };
+static const uint8_t  aidNdef[]  = { 0xD2U, 0x76U, 0x00U, 0x00U, 0x85U, 0x01U, 0x01U };
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static uint16_t t4t_sw(t4tPriv *p, uint16_t sw)
+{
+    p->rapdu[p->rapduLen++] = (uint8_t)(sw >> 8);
+    p->rapdu[p->rapduLen++] = (uint8_t)sw;
+    return p->rapduLen;
+}
+
+
+static void t4t_apdu(tagFarmTag *tag, t4tPriv *p)
+{
+    const uint8_t *c   = p->capdu;
+    uint16_t       len = p->capduLen;
+    uint32_t       off;
+    uint32_t       fileLen;
+    const uint8_t *file;
+    uint16_t       le;
+
+    p->rapduLen = 0U;
+    p->rapduPos = 0U;
+
+    if (p->applet != NULL)
+    {
+        p->rapduLen = p->applet(p->appletCtx, c, len, p->rapdu, (uint16_t)sizeof(p->rapdu));
+        return;
+    }
+
+    if ((len < 4U) || (c[0] != 0x00U))
+    {
+        t4t_sw(p, T4T_SW_CLA);
+        return;
+    }
+
+    switch (c[1])
+    {
+        case 0xA4:                              // SELECT
+            if ((c[2] == 0x04U) && (len >= 5U) && (c[4] == sizeof(aidNdef)) && (len >= (5U + sizeof(aidNdef))) &&
+                (memcmp(&c[5], aidNdef, sizeof(aidNdef)) == 0))
+            {
+                p->appSelected = true;
+                p->file        = 0U;
+                t4t_sw(p, T4T_SW_OK);
+            }
+            else if ((c[2] == 0x00U) && (c[3] == 0x0CU) && (len >= 7U) && (c[4] == 2U) && p->appSelected &&
+                     ((((c[5] << 8) | c[6]) == T4T_FID_CC) || (((c[5] << 8) | c[6]) == T4T_FID_NDEF)))
+            {
+                p->file = (uint16_t)((c[5] << 8) | c[6]);
+                t4t_sw(p, T4T_SW_OK);
+            }
+            else
+            {
+                t4t_sw(p, T4T_SW_NOT_FOUND);
+            }
+            break;
+
+        case 0xB0:                              // READ BINARY, short Le
+            if (p->file == 0U)
+            {
+                t4t_sw(p, T4T_SW_NO_FILE);
+                break;
+            }
+            file    = ((p->file == T4T_FID_CC) ? tag->mem : &tag->mem[T4T_CC_LEN]);
+            fileLen = ((p->file == T4T_FID_CC) ? T4T_CC_LEN : tag->dataLen);
+            off     = (uint32_t)((c[2] << 8) | c[3]);
+            le      = ((len >= 5U) ? ((c[4] == 0U) ? 256U : c[4]) : 256U);
+            if (off > fileLen)
+            {
+                t4t_sw(p, T4T_SW_WRONG_P1P2);
+                break;
+            }
+            if ((len >= 5U) && (le > p->mle))
+            {
+                t4t_sw(p, T4T_SW_WRONG_LENGTH);
+                break;
+            }
+            le = (uint16_t)(((fileLen - off) < le) ? (fileLen - off) : le);
+            memcpy(p->rapdu, &file[off], le);
+            p->rapduLen = le;
+            t4t_sw(p, T4T_SW_OK);
+            break;
+
+        case 0xD6:                              // UPDATE BINARY, short Lc
+            if (p->file == 0U)
+            {
+                t4t_sw(p, T4T_SW_NO_FILE);
+                break;
+            }
+            if (p->file == T4T_FID_CC)
+            {
+                t4t_sw(p, T4T_SW_SECURITY);     // CC file read only
+                break;
+            }
+            off = (uint32_t)((c[2] << 8) | c[3]);
+            if ((len < 5U) || (c[4] == 0U) || (c[4] > p->mlc) || (len < (5U + c[4])))
+            {
+                t4t_sw(p, T4T_SW_WRONG_LENGTH);
+                break;
+            }
+            if ((off + c[4]) > tag->dataLen)
+            {
+                t4t_sw(p, T4T_SW_WRONG_P1P2);
+                break;
+            }
+            memcpy(&tag->mem[T4T_CC_LEN + off], &c[5], c[4]);
+            tag->busyUs = (tag->writeUs * ((((off % T4T_PAGE_LEN) + c[4]) + (T4T_PAGE_LEN - 1U)) / T4T_PAGE_LEN));
+            t4t_sw(p, T4T_SW_OK);
+            break;
+
+        default:
+            t4t_sw(p, T4T_SW_INS);
+            break;
+    }
+}
+
+
+// Next I-block of the R-APDU, chained if it does not fit the FSD.
+static bool t4t_send(t4tPriv *p, uint8_t bn, uint8_t *res, uint16_t *resBits)
+{
+    uint16_t room = (uint16_t)(p->fsd - 3U);    // PCB and CRC
+    uint16_t n    = (uint16_t)(p->rapduLen - p->rapduPos);
+    bool     more = (n > room);
+
+    if (more)
+    {
+        n = room;
+    }
+
+    res[0] = (uint8_t)(T4T_PCB_I | bn | (more ? T4T_PCB_CHAINING : 0U));
+    memcpy(&res[1], &p->rapdu[p->rapduPos], n);
+    p->rapduPos = (uint16_t)(p->rapduPos + n);
+    *resBits    = (uint16_t)((n + 1U) * 8U);
+    return true;
+}
+
+
+static bool t4t_block(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    t4tPriv *p = (t4tPriv *)tag->priv;
+    uint8_t  pcb;
+    uint8_t  fsdi;
+
+    (void)resMax;
+
+    if (reqLen == 0U)
+    {
+        return false;
+    }
+
+    if (!p->ats)
+    {
+        if ((reqLen != 2U) || (req[0] != 0xE0U))
+        {
+            return false;
+        }
+        fsdi   = (uint8_t)(req[1] >> 4);
+        p->fsd = ((fsdi < (sizeof(fsdTable) / sizeof(fsdTable[0]))) ? fsdTable[fsdi] : 256U);
+        p->ats = true;
+        p->bn  = 1U;                            // PICC block number initialised to 1
+
+        res[0] = 0x05U;                         // TL
+        res[1] = 0x78U;                         // T0: TA, TB, TC present, FSCI 8
+        res[2] = 0x80U;                         // TA: same bit rate both ways, 106 kbps only
+        res[3] = 0x70U;                         // TB: FWI 7, SFGI 0
+        res[4] = 0x00U;                         // TC: no CID, no NAD
+        *resBits = (5U * 8U);
+        return true;
+    }
+
+    pcb = req[0];
+    if ((pcb & 0xE2U) == T4T_PCB_I)
+    {
+        if ((p->capduLen + (reqLen - 1U)) > sizeof(p->capdu))
+        {
+            return false;
+        }
+        memcpy(&p->capdu[p->capduLen], &req[1], (reqLen - 1U));
+        p->capduLen = (uint16_t)(p->capduLen + (reqLen - 1U));
+
+        if ((pcb & T4T_PCB_CHAINING) != 0U)
+        {
+            res[0]   = (uint8_t)(T4T_PCB_R | (pcb & T4T_PCB_BN));    // R(ACK): next block of the C-APDU
+            *resBits = 8U;
+            return true;
+        }
+
+        t4t_apdu(tag, p);
+        p->capduLen = 0U;
+        return t4t_send(p, (uint8_t)(pcb & T4T_PCB_BN), res, resBits);
+    }
+
+    if (((pcb & 0xE6U) == T4T_PCB_R) && ((pcb & T4T_PCB_NAK) == 0U) && (p->rapduPos < p->rapduLen))
+    {
+        return t4t_send(p, (uint8_t)(pcb & T4T_PCB_BN), res, resBits);
+    }
+
+    if (pcb == T4T_PCB_S_DESELECT)
+    {
+        res[0]     = T4T_PCB_S_DESELECT;
+        *resBits   = 8U;
+        tag->state = TAG_FARM_STATE_HALT;       // Deselected: as halted
+        p->ats     = false;
+        return true;
+    }
+
+    return false;
+}
+
+
+static bool t4t_command(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    t4tPriv *p = (t4tPriv *)tag->priv;
+
+    /* R(NAK): the last block sent again if the reader's block was received, else R(ACK) */
+    if (p->ats && (reqLen == 1U) && ((req[0] & 0xE6U) == T4T_PCB_R) && ((req[0] & T4T_PCB_NAK) != 0U))
+    {
+        if (((req[0] & T4T_PCB_BN) == p->bn) && (p->lastBits != 0U))
+        {
+            memcpy(res, p->last, (p->lastBits / 8U));
+            *resBits = p->lastBits;
+        }
+        else
+        {
+            res[0]   = (uint8_t)(T4T_PCB_R | p->bn);
+            *resBits = 8U;
+        }
+        return true;
+    }
+
+    if (!t4t_block(tag, req, reqLen, res, resMax, resBits))
+    {
+        return false;
+    }
+    if (p->ats && (reqLen > 0U) && (((req[0] & 0xE2U) == T4T_PCB_I) || ((req[0] & 0xE6U) == T4T_PCB_R)))
+    {
+        p->bn = (uint8_t)(req[0] & T4T_PCB_BN);
+    }
+    memcpy(p->last, res, (*resBits / 8U));     // Blocks of FSD bytes at most
+    p->lastBits = *resBits;
+    return true;
+}
+
+
+// I-block answered with a memory failure, the C-APDU not executed.
+static bool t4t_error(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    t4tPriv *p = (t4tPriv *)tag->priv;
+
+    (void)resMax;
+
+    if (!p->ats || (reqLen == 0U) || ((req[0] & 0xE2U) != T4T_PCB_I))
+    {
+        return false;
+    }
+
+    p->capduLen = 0U;
+    p->rapduLen = 0U;
+    p->rapduPos = 0U;
+    t4t_sw(p, T4T_SW_MEMORY);
+    t4t_send(p, (uint8_t)(req[0] & T4T_PCB_BN), res, resBits);
+    memcpy(p->last, res, (*resBits / 8U));
+    p->lastBits = *resBits;
+    return true;
+}
+
+
+static void t4t_reset(tagFarmTag *tag)
+{
+    t4tPriv *p = (t4tPriv *)tag->priv;
+
+    p->ats         = false;
+    p->appSelected = false;
+    p->file        = 0U;
+    p->capduLen    = 0U;
+    p->rapduLen    = 0U;
+    p->rapduPos    = 0U;
+    p->lastBits    = 0U;
+}
+
+
+static bool t4t_load(tagFarmTag *tag, const uint8_t *msg, uint32_t msgLen)
+{
+    uint8_t *f = &tag->mem[T4T_CC_LEN];
+
+    if ((msgLen + 2U) > tag->dataLen)
+    {
+        return false;
+    }
+
+    memset(f, 0, tag->dataLen);
+    f[0] = (uint8_t)(msgLen >> 8);              // NLEN
+    f[1] = (uint8_t)msgLen;
+    memcpy(&f[2], msg, msgLen);
+    return true;
+}
+
+
+static const tagFarmOps t4tOps = { t4t_command, t4t_error, t4t_reset, t4t_load };
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+void tag_t4t_init(tagFarmTag *tag, const char *name, uint16_t fileLen, uint16_t mle, uint16_t mlc)
+{
+    static const uint8_t nxp[] = { 0x04U };
+    t4tPriv             *p;
+    uint8_t             *cc;
+
+    tag_farm_init(tag, name, TAG_FARM_TECH_NFCA, &t4tOps, nxp, sizeof(nxp), 7U, ((uint32_t)T4T_CC_LEN + fileLen));
+    tag->atqa[0] = 0x44U;
+    tag->atqa[1] = 0x03U;
+    tag->sak     = 0x20U;                       // ISO-DEP
+    tag->dataLen = fileLen;
+    tag->writeUs = T4T_WRITE_US;
+
+    p = (t4tPriv *)calloc(1U, sizeof(t4tPriv));
+    p->mle    = mle;
+    p->mlc    = mlc;
+    tag->priv = p;
+
+    /* CC file: CCLEN, mapping version 2.0, MLe, MLc, NDEF File Control TLV (E104h, size, read/write free) */
+    cc = tag->mem;
+    cc[0]  = 0x00U;
+    cc[1]  = T4T_CC_LEN;
+    cc[2]  = 0x20U;
+    cc[3]  = (uint8_t)(mle >> 8);
+    cc[4]  = (uint8_t)mle;
+    cc[5]  = (uint8_t)(mlc >> 8);
+    cc[6]  = (uint8_t)mlc;
+    cc[7]  = 0x04U;
+    cc[8]  = 0x06U;
+    cc[9]  = (uint8_t)(T4T_FID_NDEF >> 8);
+    cc[10] = (uint8_t)T4T_FID_NDEF;
+    cc[11] = (uint8_t)(fileLen >> 8);
+    cc[12] = (uint8_t)fileLen;
+    cc[13] = 0x00U;
+    cc[14] = 0x00U;
+}
+
+
+void tag_t4t_set_applet(tagFarmTag *tag, tagT4tApplet applet, void *ctx)
+{
+    t4tPriv *p = (t4tPriv *)tag->priv;
+
+    p->applet    = applet;
+    p->appletCtx = ctx;
+}
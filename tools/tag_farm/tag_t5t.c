@@ -0,0 +1,540 @@
+/**
+ * @file tag_t5t.c
+ *
+ * @brief NFC Forum Type 5 Tag: ISO15693 VICC, as the NXP ICODE SLIX or ST ST25DV.
+ *
+ * Commands: SELECT, GET SYSTEM INFO, READ SINGLE/MULTIPLE BLOCKS, WRITE SINGLE BLOCK and, with the
+ * features of the tag (TAG_T5T_):
+ *  - EXTENDED: EXTENDED GET SYSTEM INFO, EXTENDED READ SINGLE/MULTIPLE, EXTENDED WRITE SINGLE;
+ *  - WRITE_MULTIPLE: WRITE MULTIPLE BLOCKS, EXTENDED WRITE MULTIPLE BLOCKS if extended, 4 blocks max;
+ *  - FAST: ST FAST READ SINGLE/MULTIPLE BLOCKS, FAST EXTENDED READ SINGLE/MULTIPLE if extended;
+ *  - MAILBOX: ST25DV fast transfer mode, (FAST) WRITE/READ MESSAGE, READ MESSAGE LENGTH, READ/WRITE
+ *    DYNAMIC CONFIGURATION of MB_CTRL_Dyn. The host side is not modelled: a message written by RF
+ *    is released once read back up to its last byte.
+ * Requests are answered in addressed, selected or non-addressed mode; an unsupported request gets
+ * error 01h, a custom command of another manufacturer no response. A write with the option flag
+ * set is answered on the EOF that follows.
+ *
+ * Memory: numBlocks blocks of blockLen bytes, writeUs per block written. The CC is 4 bytes (E1h)
+ * up to 2040 bytes of memory, 8 bytes (E2h) beyond.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tag_farm.h"
+
+
+#define T5T_REQ_FLAG_SELECT     0x10U
+#define T5T_REQ_FLAG_ADDRESS    0x20U
+#define T5T_REQ_FLAG_OPTION     0x40U
+
+#define T5T_CMD_READ_SINGLE     0x20U
+#define T5T_CMD_WRITE_SINGLE    0x21U
+#define T5T_CMD_READ_MULTIPLE   0x23U
+#define T5T_CMD_WRITE_MULTIPLE  0x24U
+#define T5T_CMD_SELECT          0x25U
+#define T5T_CMD_GET_SYSINFO     0x2BU
+#define T5T_CMD_EXT_READ_SINGLE 0x30U
+#define T5T_CMD_EXT_WRITE_SINGLE 0x31U
+#define T5T_CMD_EXT_READ_MULTI  0x33U
+#define T5T_CMD_EXT_WRITE_MULTI 0x34U
+#define T5T_CMD_EXT_GET_SYSINFO 0x3BU
+#define T5T_CMD_CUSTOM          0xA0U   // First custom command: IC manufacturer code parameter
+#define T5T_CMD_WRITE_MSG       0xAAU
+#define T5T_CMD_READ_MSG_LEN    0xABU
+#define T5T_CMD_READ_MSG        0xACU
+#define T5T_CMD_READ_DYN        0xADU
+#define T5T_CMD_WRITE_DYN       0xAEU
+#define T5T_CMD_FAST_READ_SINGLE 0xC0U
+#define T5T_CMD_FAST_READ_MULTI 0xC3U
+#define T5T_CMD_FAST_EXT_READ_SINGLE 0xC4U
+#define T5T_CMD_FAST_EXT_READ_MULTI  0xC5U
+#define T5T_CMD_FAST            0x20U   // Fast mailbox command: regular command + 20h
+
+#define T5T_ERR_NOT_SUPPORTED   0x01U
+#define T5T_ERR_FORMAT          0x02U
+#define T5T_ERR_UNKNOWN         0x0FU
+#define T5T_ERR_BLOCK           0x10U   // Block not available
+
+#define T5T_CC4_MAX_MEM         2040U   // Largest memory described by a 4 byte CC (MLEN FFh)
+#define T5T_WRITE_MULTIPLE_MAX     4U
+#define T5T_WRITE_US            4000U
+
+#define T5T_MB_LEN               256U
+#define T5T_DYN_LEN               16U
+#define T5T_DYN_MB_CTRL         0x0DU
+#define T5T_MB_EN               0x01U   // MB_CTRL_Dyn: mailbox enabled
+#define T5T_MB_RF_PUT_MSG       0x04U   // MB_CTRL_Dyn: message written by RF
+
+
+/*** Model state ***/
+typedef struct
+{
+    uint8_t  features;                  // TAG_T5T_
+    bool     selected;                  // In Selected state
+    uint16_t numBlocks;
+    uint8_t  blockLen;
+    uint8_t  icRef;
+    uint8_t  ccLen;
+
+    uint8_t  eofRes[2];                 // Response of a write with the option flag, sent on the EOF
+    uint8_t  eofResLen;
+
+    uint8_t  dyn[T5T_DYN_LEN];          // Dynamic registers
+    uint8_t  mb[T5T_MB_LEN];            // Mailbox
+    uint16_t mbLen;                     // Message length, 0 if none
+} t5tPriv;
+
+#define T5T_HAS(p, f)           (((p)->features & (f)) != 0U)
+
+
+/*** LOCAL FUNCTIONS ***/
+
+static bool t5t_error(uint8_t code, uint8_t *res, uint16_t *resBits)
+{
+    res[0]   = 0x01U;
+    res[1]   = code;
+    *resBits = (2U * 8U);
+    return true;
+}
+
+
+static bool t5t_read(tagFarmTag *tag, uint32_t first, uint32_t count, bool option, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    const t5tPriv *p   = (const t5tPriv *)tag->priv;
+    uint16_t       len = 1U;
+    uint32_t       b;
+
+    if (((first + count) > p->numBlocks) || ((1U + (count * (p->blockLen + (option ? 1U : 0U)))) > resMax))
+    {
+        return t5t_error(T5T_ERR_BLOCK, res, resBits);
+    }
+
+    res[0] = 0x00U;
+    for (b = first; b < (first + count); b++)
+    {
+        if (option)
+        {
+            res[len++] = 0x00U;                 // Block security status: not locked
+        }
+        memcpy(&res[len], &tag->mem[b * p->blockLen], p->blockLen);
+        len = (uint16_t)(len + p->blockLen);
+    }
+    *resBits = (uint16_t)(len * 8U);
+    return true;
+}
+
+
+static bool t5t_write(tagFarmTag *tag, uint32_t first, uint32_t count, const uint8_t *data, uint16_t dataLen, uint8_t *res, uint16_t *resBits)
+{
+    const t5tPriv *p = (const t5tPriv *)tag->priv;
+
+    if ((first + count) > p->numBlocks)
+    {
+        return t5t_error(T5T_ERR_BLOCK, res, resBits);
+    }
+    if ((count > T5T_WRITE_MULTIPLE_MAX) || (dataLen != (count * p->blockLen)))
+    {
+        return t5t_error(T5T_ERR_FORMAT, res, resBits);
+    }
+
+    memcpy(&tag->mem[first * p->blockLen], data, dataLen);
+    tag->busyUs = (tag->writeUs * count);
+    res[0]   = 0x00U;
+    *resBits = 8U;
+    return true;
+}
+
+
+// Mailbox commands, cmd the regular (not fast) code.
+static bool t5t_mailbox(tagFarmTag *tag, uint8_t cmd, const uint8_t *d, uint16_t dLen, uint8_t *res, uint16_t *resBits)
+{
+    t5tPriv *p       = (t5tPriv *)tag->priv;
+    uint8_t *mbCtrl  = &p->dyn[T5T_DYN_MB_CTRL];
+    bool     enabled = ((*mbCtrl & T5T_MB_EN) != 0U);
+    uint16_t n;
+
+    res[0] = 0x00U;
+    switch (cmd)
+    {
+        case T5T_CMD_WRITE_MSG:
+            if ((dLen < 1U) || (dLen != (d[0] + 2U)))
+            {
+                return t5t_error(T5T_ERR_FORMAT, res, resBits);
+            }
+            if (!enabled || (p->mbLen != 0U))
+            {
+                return t5t_error(T5T_ERR_UNKNOWN, res, resBits);
+            }
+            p->mbLen = (uint16_t)(d[0] + 1U);
+            memcpy(p->mb, &d[1], p->mbLen);
+            *mbCtrl |= T5T_MB_RF_PUT_MSG;
+            *resBits = 8U;
+            return true;
+
+        case T5T_CMD_READ_MSG_LEN:
+            res[1]   = (uint8_t)((p->mbLen != 0U) ? (p->mbLen - 1U) : 0U);
+            *resBits = (2U * 8U);
+            return true;
+
+        case T5T_CMD_READ_MSG:
+            if (dLen < 2U)
+            {
+                return t5t_error(T5T_ERR_FORMAT, res, resBits);
+            }
+            n = (((d[0] == 0U) && (d[1] == 0U)) ? p->mbLen : (uint16_t)(d[1] + 1U));
+            if (!enabled || (p->mbLen == 0U) || ((d[0] + n) > p->mbLen))
+            {
+                return t5t_error(T5T_ERR_UNKNOWN, res, resBits);
+            }
+            memcpy(&res[1], &p->mb[d[0]], n);
+            *resBits = (uint16_t)((1U + n) * 8U);
+            if ((d[0] + n) == p->mbLen)
+            {
+                p->mbLen = 0U;                  // Read up to its last byte: released
+                *mbCtrl &= (uint8_t)~T5T_MB_RF_PUT_MSG;
+            }
+            return true;
+
+        case T5T_CMD_READ_DYN:
+            if ((dLen < 1U) || (d[0] >= T5T_DYN_LEN))
+            {
+                return t5t_error(((dLen < 1U) ? T5T_ERR_FORMAT : T5T_ERR_BLOCK), res, resBits);
+            }
+            res[1]   = p->dyn[d[0]];
+            *resBits = (2U * 8U);
+            return true;
+
+        case T5T_CMD_WRITE_DYN:
+            if (dLen < 2U)
+            {
+                return t5t_error(T5T_ERR_FORMAT, res, resBits);
+            }
+            if (d[0] != T5T_DYN_MB_CTRL)
+            {
+                return t5t_error(T5T_ERR_BLOCK, res, resBits);
+            }
+            *mbCtrl = (uint8_t)((*mbCtrl & (uint8_t)~T5T_MB_EN) | (d[1] & T5T_MB_EN));
+            if ((*mbCtrl & T5T_MB_EN) == 0U)
+            {
+                *mbCtrl  = 0x00U;               // Disabled: mailbox emptied
+                p->mbLen = 0U;
+            }
+            *resBits = 8U;
+            return true;
+
+        default:
+            return t5t_error(T5T_ERR_NOT_SUPPORTED, res, resBits);
+    }
+}
+
+
+static bool t5t_sysinfo(tagFarmTag *tag, bool extended, uint8_t *res, uint16_t *resBits)
+{
+    const t5tPriv *p   = (const t5tPriv *)tag->priv;
+    uint16_t       len = 0U;
+
+    res[len++] = 0x00U;
+    res[len++] = (extended ? 0x2FU : 0x0FU);    // DSFID, AFI, memory size, IC reference (command list)
+    memcpy(&res[len], tag->uid, 8U);
+    len += 8U;
+    res[len++] = tag->dsfid;
+    res[len++] = 0x00U;                         // AFI
+    res[len++] = (uint8_t)(p->numBlocks - 1U);
+    if (extended)
+    {
+        res[len++] = (uint8_t)((p->numBlocks - 1U) >> 8);
+    }
+    res[len++] = (uint8_t)(p->blockLen - 1U);
+    res[len++] = p->icRef;
+    if (extended)
+    {
+        /* Command list: READ SINGLE/MULTIPLE, WRITE SINGLE, SELECT, GET SYSTEM INFO, EXTENDED READ
+           SINGLE/MULTIPLE, EXTENDED WRITE SINGLE, then those of the features */
+        res[len++] = (uint8_t)(0x2BU | (T5T_HAS(p, TAG_T5T_WRITE_MULTIPLE) ? 0x10U : 0x00U));
+        res[len++] = (uint8_t)(0x10U | (T5T_HAS(p, (TAG_T5T_FAST | TAG_T5T_MAILBOX)) ? 0x20U : 0x00U) | (T5T_HAS(p, TAG_T5T_FAST) ? 0x80U : 0x00U));
+        res[len++] = (uint8_t)(0x0BU | (T5T_HAS(p, TAG_T5T_WRITE_MULTIPLE) ? 0x10U : 0x00U) | (T5T_HAS(p, TAG_T5T_FAST) ? 0x40U : 0x00U));
+        res[len++] = 0x00U;
+    }
+    *resBits = (uint16_t)(len * 8U);
+    return true;
+}
+
+
+static bool t5t_command(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    t5tPriv       *p = (t5tPriv *)tag->priv;
+    const uint8_t *d;
+    uint16_t       dLen;
+    uint8_t        flags;
+    uint8_t        cmd;
+    uint8_t        param = 0U;
+    bool           option;
+    bool           ext;
+    bool           answered;
+
+    /* EOF after a write with the option flag: its response */
+    if (reqLen == 0U)
+    {
+        if (p->eofResLen == 0U)
+        {
+            return false;
+        }
+        memcpy(res, p->eofRes, p->eofResLen);
+        *resBits     = (uint16_t)(p->eofResLen * 8U);
+        p->eofResLen = 0U;
+        return true;
+    }
+    if (reqLen < 2U)
+    {
+        return false;
+    }
+    flags  = req[0];
+    cmd    = req[1];
+    d      = &req[2];
+    dLen   = (uint16_t)(reqLen - 2U);
+    option = ((flags & T5T_REQ_FLAG_OPTION) != 0U);
+    ext    = T5T_HAS(p, TAG_T5T_EXTENDED);
+
+    /* [flags][cmd][param][UID][data]: the parameter on EXTENDED GET SYSTEM INFO and custom commands */
+    if ((cmd == T5T_CMD_EXT_GET_SYSINFO) || (cmd >= T5T_CMD_CUSTOM))
+    {
+        if (dLen < 1U)
+        {
+            return false;
+        }
+        param = d[0];
+        d++;
+        dLen--;
+        if ((cmd >= T5T_CMD_CUSTOM) && (param != tag->uid[6]))
+        {
+            return false;                       // Custom command of another manufacturer
+        }
+    }
+    if ((flags & T5T_REQ_FLAG_ADDRESS) != 0U)
+    {
+        if ((dLen < 8U) || (memcmp(d, tag->uid, 8U) != 0))
+        {
+            return false;                       // Addressed to another VICC
+        }
+        d    += 8U;
+        dLen -= 8U;
+    }
+    else if (((flags & T5T_REQ_FLAG_SELECT) != 0U) && !p->selected)
+    {
+        return false;
+    }
+
+    switch (cmd)
+    {
+        case T5T_CMD_SELECT:
+            p->selected = ((flags & T5T_REQ_FLAG_ADDRESS) != 0U);
+            res[0]   = 0x00U;
+            *resBits = 8U;
+            return true;
+
+        case T5T_CMD_GET_SYSINFO:
+            return t5t_sysinfo(tag, false, res, resBits);
+
+        case T5T_CMD_READ_SINGLE:
+            return ((dLen < 1U) ? t5t_error(T5T_ERR_FORMAT, res, resBits) :
+                    t5t_read(tag, d[0], 1U, option, res, resMax, resBits));
+
+        case T5T_CMD_READ_MULTIPLE:
+            return ((dLen < 2U) ? t5t_error(T5T_ERR_FORMAT, res, resBits) :
+                    t5t_read(tag, d[0], (d[1] + 1U), option, res, resMax, resBits));
+
+        case T5T_CMD_EXT_GET_SYSINFO:
+            return (ext ? t5t_sysinfo(tag, ((param & 0x20U) != 0U), res, resBits) : t5t_error(T5T_ERR_NOT_SUPPORTED, res, resBits));
+
+        case T5T_CMD_EXT_READ_SINGLE:
+            if (!ext || (dLen < 2U))
+            {
+                return t5t_error((ext ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            return t5t_read(tag, (uint32_t)(d[0] | (d[1] << 8)), 1U, option, res, resMax, resBits);
+
+        case T5T_CMD_EXT_READ_MULTI:
+            if (!ext || (dLen < 4U))
+            {
+                return t5t_error((ext ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            return t5t_read(tag, (uint32_t)(d[0] | (d[1] << 8)), ((uint32_t)(d[2] | (d[3] << 8)) + 1U), option, res, resMax, resBits);
+
+        case T5T_CMD_WRITE_SINGLE:
+            answered = ((dLen < 1U) ? t5t_error(T5T_ERR_FORMAT, res, resBits) :
+                        t5t_write(tag, d[0], 1U, &d[1], (uint16_t)(dLen - 1U), res, resBits));
+            break;
+
+        case T5T_CMD_WRITE_MULTIPLE:
+            if (!T5T_HAS(p, TAG_T5T_WRITE_MULTIPLE) || (dLen < 2U))
+            {
+                return t5t_error((T5T_HAS(p, TAG_T5T_WRITE_MULTIPLE) ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            answered = t5t_write(tag, d[0], (d[1] + 1U), &d[2], (uint16_t)(dLen - 2U), res, resBits);
+            break;
+
+        case T5T_CMD_EXT_WRITE_SINGLE:
+            if (!ext || (dLen < 2U))
+            {
+                return t5t_error((ext ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            answered = t5t_write(tag, (uint32_t)(d[0] | (d[1] << 8)), 1U, &d[2], (uint16_t)(dLen - 2U), res, resBits);
+            break;
+
+        case T5T_CMD_EXT_WRITE_MULTI:
+            if (!ext || !T5T_HAS(p, TAG_T5T_WRITE_MULTIPLE) || (dLen < 4U))
+            {
+                return t5t_error(((ext && T5T_HAS(p, TAG_T5T_WRITE_MULTIPLE)) ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            answered = t5t_write(tag, (uint32_t)(d[0] | (d[1] << 8)), ((uint32_t)(d[2] | (d[3] << 8)) + 1U), &d[4], (uint16_t)(dLen - 4U), res, resBits);
+            break;
+
+        case T5T_CMD_FAST_READ_SINGLE:
+        case T5T_CMD_FAST_READ_MULTI:
+            if (!T5T_HAS(p, TAG_T5T_FAST) || (dLen < ((cmd == T5T_CMD_FAST_READ_SINGLE) ? 1U : 2U)))
+            {
+                return t5t_error((T5T_HAS(p, TAG_T5T_FAST) ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            return t5t_read(tag, d[0], ((cmd == T5T_CMD_FAST_READ_SINGLE) ? 1U : (d[1] + 1U)), option, res, resMax, resBits);
+
+        case T5T_CMD_FAST_EXT_READ_SINGLE:
+        case T5T_CMD_FAST_EXT_READ_MULTI:
+            if (!T5T_HAS(p, TAG_T5T_FAST) || !ext || (dLen < ((cmd == T5T_CMD_FAST_EXT_READ_SINGLE) ? 2U : 4U)))
+            {
+                return t5t_error(((T5T_HAS(p, TAG_T5T_FAST) && ext) ? T5T_ERR_FORMAT : T5T_ERR_NOT_SUPPORTED), res, resBits);
+            }
+            return t5t_read(tag, (uint32_t)(d[0] | (d[1] << 8)), ((cmd == T5T_CMD_FAST_EXT_READ_SINGLE) ? 1U : ((uint32_t)(d[2] | (d[3] << 8)) + 1U)),
+                            option, res, resMax, resBits);
+
+        case T5T_CMD_WRITE_MSG:
+        case T5T_CMD_READ_MSG_LEN:
+        case T5T_CMD_READ_MSG:
+        case T5T_CMD_READ_DYN:
+        case T5T_CMD_WRITE_DYN:
+        case (T5T_CMD_WRITE_MSG + T5T_CMD_FAST):
+        case (T5T_CMD_READ_MSG_LEN + T5T_CMD_FAST):
+        case (T5T_CMD_READ_MSG + T5T_CMD_FAST):
+        case (T5T_CMD_READ_DYN + T5T_CMD_FAST):
+        case (T5T_CMD_WRITE_DYN + T5T_CMD_FAST):
+            if (!T5T_HAS(p, TAG_T5T_MAILBOX))
+            {
+                return t5t_error(T5T_ERR_NOT_SUPPORTED, res, resBits);
+            }
+            return t5t_mailbox(tag, ((cmd > T5T_CMD_WRITE_DYN) ? (uint8_t)(cmd - T5T_CMD_FAST) : cmd), d, dLen, res, resBits);
+
+        default:
+            return t5t_error(T5T_ERR_NOT_SUPPORTED, res, resBits);
+    }
+
+    /* Write with the option flag: the response waits for the EOF, the programming time with it */
+    if (answered && option)
+    {
+        memcpy(p->eofRes, res, (*resBits / 8U));
+        p->eofResLen = (uint8_t)(*resBits / 8U);
+        tag->busyUs  = 0U;
+        return false;
+    }
+    return answered;
+}
+
+
+// Error response, the request not executed.
+static bool t5t_nack(tagFarmTag *tag, const uint8_t *req, uint16_t reqLen, uint8_t *res, uint16_t resMax, uint16_t *resBits)
+{
+    (void)tag;
+    (void)req;
+    (void)reqLen;
+    (void)resMax;
+    return t5t_error(T5T_ERR_UNKNOWN, res, resBits);
+}
+
+
+static void t5t_reset(tagFarmTag *tag)
+{
+    t5tPriv *p = (t5tPriv *)tag->priv;
+
+    p->selected  = false;
+    p->eofResLen = 0U;
+    p->mbLen     = 0U;                          // Volatile: mailbox and dynamic registers lost
+    memset(p->dyn, 0, sizeof(p->dyn));
+}
+
+
+static bool t5t_load(tagFarmTag *tag, const uint8_t *msg, uint32_t msgLen)
+{
+    const t5tPriv *p    = (const t5tPriv *)tag->priv;
+    uint8_t       *a    = &tag->mem[p->ccLen];
+    uint32_t       area = (tag->memLen - p->ccLen);
+    uint32_t       tlv  = (msgLen + ((msgLen < 0xFFU) ? 2U : 4U));
+
+    if ((tlv + ((tlv < area) ? 1U : 0U)) > area)
+    {
+        return false;
+    }
+
+    memset(a, 0, area);
+    *a++ = 0x03U;                               // NDEF Message TLV
+    if (msgLen < 0xFFU)
+    {
+        *a++ = (uint8_t)msgLen;
+    }
+    else
+    {
+        *a++ = 0xFFU;
+        *a++ = (uint8_t)(msgLen >> 8);
+        *a++ = (uint8_t)msgLen;
+    }
+    memcpy(a, msg, msgLen);
+    if (tlv < area)
+    {
+        a[msgLen] = 0xFEU;                      // Terminator TLV
+    }
+    return true;
+}
+
+
+static const tagFarmOps t5tOps = { t5t_command, t5t_nack, t5t_reset, t5t_load };
+
+
+/*** GLOBAL FUNCTIONS ***/
+
+void tag_t5t_init(tagFarmTag *tag, const char *name, uint8_t mfgCode, uint16_t numBlocks, uint8_t blockLen, uint8_t features)
+{
+    t5tPriv  *p;
+    uint32_t  memLen = ((uint32_t)numBlocks * blockLen);
+    uint16_t  mlen   = (uint16_t)(memLen / 8U);
+    uint8_t  *cc;
+
+    tag_farm_init(tag, name, TAG_FARM_TECH_NFCV, &t5tOps, NULL, 0U, 8U, memLen);
+    tag->uid[5]  = ((mfgCode == 0x02U) ? 0x26U : 0x01U);   // Product code
+    tag->uid[6]  = mfgCode;
+    tag->uid[7]  = 0xE0U;
+    tag->dataLen = memLen;
+    tag->writeUs = T5T_WRITE_US;
+
+    p = (t5tPriv *)calloc(1U, sizeof(t5tPriv));
+    p->features  = (uint8_t)((mfgCode == 0x02U) ? features : (features & (TAG_T5T_EXTENDED | TAG_T5T_WRITE_MULTIPLE)));
+    p->numBlocks = numBlocks;
+    p->blockLen  = blockLen;
+    p->icRef     = tag->uid[5];
+    p->ccLen     = ((memLen <= T5T_CC4_MAX_MEM) ? 4U : 8U);
+    tag->priv    = p;
+
+    /* CC: magic, version 1.0 read/write always, MLEN, MBREAD; MLEN on bytes 6-7 for an 8 byte CC */
+    cc = tag->mem;
+    cc[0] = ((p->ccLen == 4U) ? 0xE1U : 0xE2U);
+    cc[1] = 0x40U;
+    cc[2] = ((p->ccLen == 4U) ? (uint8_t)mlen : 0x00U);
+    cc[3] = 0x01U;
+    if (p->ccLen == 8U)
+    {
+        cc[6] = (uint8_t)(mlen >> 8);
+        cc[7] = (uint8_t)mlen;
+    }
+
+    /* Initialised: empty NDEF Message TLV */
+    cc[p->ccLen]      = 0x03U;
+    cc[p->ccLen + 2U] = 0xFEU;
+}